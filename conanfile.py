@@ -17,14 +17,20 @@ class BilibiliPlayerConan(ConanFile):
         "fmt/12.0.0",
         "magic_enum/0.9.7",
         "catch2/3.11.0",
-        "taglib/2.0"
+        "taglib/2.0",
+        "sqlite3/3.46.1",
+        "xxhash/0.8.2"
     )
 
     # Default options reflecting conanfile.txt
     default_options = {
-        "ffmpeg/*:with_opus": False,
+        # libopus encodes the audio cache, see src/audio/cache_transcoder.h
+        "ffmpeg/*:with_opus": True,
         "ffmpeg/*:shared": True,
         "cpp-httplib/*:with_openssl": True,
+        # gzip/br for API responses, see src/network/http_compression.h
+        "cpp-httplib/*:with_zlib": True,
+        "cpp-httplib/*:with_brotli": True,
         "spdlog/*:shared": True,
         "fmt/*:shared": True,
     }
@@ -1,9 +1,8 @@
 #include "audio_event_processor.h"
 #include <log/log_manager.h>
-#include <QDateTime>
-#include <queue>
-#include "audio_event_processor.h"
-#include <log/log_manager.h>
+#include <util/idle_mode.h>
+#include <util/thread_priority.h>
+#include <util/trace.h>
 
 namespace audio {
 
@@ -19,40 +18,135 @@ AudioEventProcessor::~AudioEventProcessor()
     LOG_DEBUG(" AudioEventProcessor destroyed");
 }
 
-void AudioEventProcessor::postEvent(PlayerEventType eventType, const QVariantHash& eventData)
+qint64 AudioEventProcessor::Event::seekPositionMs() const
+{
+    if (const auto* seek = std::get_if<SeekRequest>(&payload)) {
+        return seek->positionMs;
+    }
+    if (const auto* hash = std::get_if<QVariantHash>(&payload)) {
+        return hash->value(QStringLiteral("positionMs")).toLongLong();
+    }
+    return 0;
+}
+
+QString AudioEventProcessor::Event::errorMessage() const
+{
+    if (const auto* error = std::get_if<ErrorInfo>(&payload)) {
+        return error->message;
+    }
+    if (const auto* hash = std::get_if<QVariantHash>(&payload)) {
+        return hash->value(QStringLiteral("error")).toString();
+    }
+    return QString();
+}
+
+QVariantHash AudioEventProcessor::Event::toVariantHash() const
+{
+    if (const auto* seek = std::get_if<SeekRequest>(&payload)) {
+        return QVariantHash{{QStringLiteral("positionMs"), QVariant(seek->positionMs)}};
+    }
+    if (const auto* error = std::get_if<ErrorInfo>(&payload)) {
+        QVariantHash data{{QStringLiteral("error"), QVariant(error->message)}};
+        if (error->code != 0) {
+            data.insert(QStringLiteral("code"), QVariant(error->code));
+        }
+        return data;
+    }
+    if (const auto* hash = std::get_if<QVariantHash>(&payload)) {
+        return *hash;
+    }
+    return QVariantHash();
+}
+
+void AudioEventProcessor::postEvent(PlayerEventType eventType, Payload payload)
 {
     std::unique_lock<std::mutex> locker(m_queueMutex);
 
-    m_eventQueue.push_back(std::make_unique<PlaybackEvent>(eventType, eventData));
+    const quint64 sequence = sequenceEventUnsafe(eventType);
+    if (m_ringSize < EVENT_RING_CAPACITY && m_overflowQueue.empty()) {
+        Event& slot = m_eventRing[(m_ringHead + m_ringSize) % EVENT_RING_CAPACITY];
+        slot.type = eventType;
+        slot.payload = std::move(payload);
+        slot.sequence = sequence;
+        ++m_ringSize;
+    } else {
+        m_overflowQueue.push_back(Event{eventType, std::move(payload), sequence});
+    }
     LOG_DEBUG(" Posted event: {} (queue size: {})",
-                magic_enum::enum_name(eventType).data(), m_eventQueue.size());
-    LOG_DEBUG(" Scheduled processing after posting event, queue size: {}", m_eventQueue.size());
+                magic_enum::enum_name(eventType).data(), m_ringSize + m_overflowQueue.size());
     m_queueCondition.notify_one();
     locker.unlock();
 }
     
-void AudioEventProcessor::postHighPriorityEvent(PlayerEventType eventType, const QVariantHash& eventData)
+void AudioEventProcessor::postHighPriorityEvent(PlayerEventType eventType, Payload payload)
 {
     std::unique_lock<std::mutex> locker(m_queueMutex);
 
-    m_highPriorityQueue.push_back(std::make_unique<PlaybackEvent>(eventType, eventData));
+    const quint64 sequence = sequenceEventUnsafe(eventType);
+    m_highPriorityQueue.push_back(Event{eventType, std::move(payload), sequence});
     LOG_DEBUG(" Posted high-priority event: {} (high-priority queue size: {})",
                 magic_enum::enum_name(eventType).data(), m_highPriorityQueue.size());
-    LOG_DEBUG(" Scheduled processing after posting high-priority event, queue size: {}", m_highPriorityQueue.size());
     m_queueCondition.notify_one();
     locker.unlock();
 }
 
-void AudioEventProcessor::setEventHandler(PlayerEventType type, std::function<void(const QVariantHash&)> handler)
+quint32 AudioEventProcessor::supersededTypes(PlayerEventType eventType)
 {
-    m_eventHandlers[type] = handler;
+    static_assert(EVENT_TYPE_COUNT <= 32, "supersededTypes() needs a wider mask");
+    constexpr auto bit = [](PlayerEventType type) { return quint32(1) << type; };
+    switch (eventType) {
+    case PLAY:
+        // PLAY starts or resumes the current song whatever came before; a PAUSE before it
+        // changes nothing. Not STOP: PLAY does nothing while playing, and next() relies
+        // on STOP tearing the old song down first
+        return bit(PLAY) | bit(PAUSE);
+    case PAUSE:
+        return bit(PAUSE);
+    case STOP:
+        // Whatever these would have started or moved is torn down again
+        return bit(PLAY) | bit(PAUSE) | bit(STOP) | bit(SEEK);
+    case SEEK:
+        return bit(SEEK);       // Only the latest position matters
+    default:
+        return 0;
+    }
+}
+
+quint64 AudioEventProcessor::sequenceEventUnsafe(PlayerEventType eventType)
+{
+    const quint64 sequence = ++m_lastSequence;
+    const quint32 superseded = supersededTypes(eventType);
+    for (size_t type = 0; type < EVENT_TYPE_COUNT; ++type) {
+        if (superseded & (quint32(1) << type)) {
+            m_supersededBefore[type].store(sequence, std::memory_order_release);
+        }
+    }
+    return sequence;
+}
+
+bool AudioEventProcessor::isSuperseded(const Event& event) const
+{
+    return event.sequence != 0
+        && event.sequence < m_supersededBefore[static_cast<size_t>(event.type)].load(std::memory_order_acquire);
+}
+
+void AudioEventProcessor::setEventHandler(PlayerEventType type, EventHandler handler)
+{
+    m_eventHandlers[static_cast<size_t>(type)] = std::move(handler);
     LOG_DEBUG(" Event handler registered, event type: {}", magic_enum::enum_name(type).data());
 }
 
+void AudioEventProcessor::setEventHandler(PlayerEventType type, VariantHandler handler)
+{
+    setEventHandler(type, EventHandler([handler = std::move(handler)](const Event& event) {
+        handler(event.toVariantHash());
+    }));
+}
+
 int AudioEventProcessor::pendingEventCount() const
 {
     std::scoped_lock locker(m_queueMutex);
-    return m_eventQueue.size() + m_highPriorityQueue.size();
+    return static_cast<int>(m_ringSize + m_overflowQueue.size() + m_highPriorityQueue.size());
 }
 
 void AudioEventProcessor::start()
@@ -74,59 +168,84 @@ void AudioEventProcessor::stop()
     }
     // Clear pending events
     std::scoped_lock locker(m_queueMutex);
-    int clearedEvents = m_eventQueue.size() + m_highPriorityQueue.size();
-    m_eventQueue.clear();
+    size_t clearedEvents = m_ringSize + m_overflowQueue.size() + m_highPriorityQueue.size();
+    for (size_t i = 0; i < m_ringSize; ++i) {
+        m_eventRing[(m_ringHead + i) % EVENT_RING_CAPACITY].payload = std::monostate();
+    }
+    m_ringHead = 0;
+    m_ringSize = 0;
+    m_overflowQueue.clear();
     m_highPriorityQueue.clear();
     
     LOG_INFO(" AudioEventProcessor stopped, cleared {} pending events", clearedEvents);
 }
 
-void AudioEventProcessor::processEventUnsafe(std::unique_ptr<PlaybackEvent> event)
+bool AudioEventProcessor::takeEventUnsafe(Event& event)
 {
-    if (!event) return;
-    
-    auto handlerIt = m_eventHandlers.find(event->getType());
-    if (handlerIt != m_eventHandlers.end()) {
+    if (!m_highPriorityQueue.empty()) {
+        event = std::move(m_highPriorityQueue.front());
+        m_highPriorityQueue.pop_front();
+        return true;
+    }
+    if (m_ringSize > 0) {
+        Event& slot = m_eventRing[m_ringHead];
+        event.type = slot.type;
+        event.payload = std::move(slot.payload);
+        event.sequence = slot.sequence;
+        slot.payload = std::monostate();    // Don't keep strings alive in the ring
+        m_ringHead = (m_ringHead + 1) % EVENT_RING_CAPACITY;
+        --m_ringSize;
+        // Refill the ring from the overflow, keeping posting order
+        if (!m_overflowQueue.empty()) {
+            Event& tail = m_eventRing[(m_ringHead + m_ringSize) % EVENT_RING_CAPACITY];
+            tail = std::move(m_overflowQueue.front());
+            m_overflowQueue.pop_front();
+            ++m_ringSize;
+        }
+        return true;
+    }
+    return false;
+}
+
+void AudioEventProcessor::processEventUnsafe(const Event& event)
+{
+    if (isSuperseded(event)) {
+        LOG_DEBUG("Dropped superseded event: {}", magic_enum::enum_name(event.type).data());
+        return;
+    }
+    const EventHandler& handler = m_eventHandlers[static_cast<size_t>(event.type)];
+    if (handler) {
+        // enum_name views a static null-terminated name, as the trace needs
+        TRACE_SCOPE("audio event", magic_enum::enum_name(event.type).data());
         try {
-            handlerIt->second(event->getData());
-            LOG_DEBUG("Processed event: {}", event->toString().toStdString());
+            handler(event);
+            LOG_DEBUG("Processed event: {}", magic_enum::enum_name(event.type).data());
         } catch (const std::exception& e) {
             LOG_ERROR("Error in event handler: {}", e.what());
             emit processingError(QString::fromStdString(e.what()));
         }
     } else {
-        LOG_WARN(" No handler for event type: {}", static_cast<int>(event->getType()));
+        LOG_WARN(" No handler for event type: {}", static_cast<int>(event.type));
     }
 }
 
 void AudioEventProcessor::processEventFunc()
 {
+    // Seek/play/stop requests should not queue up behind desktop load
+    util::ScopedThreadPriority priority(util::ThreadRole::AudioWorker);
+    util::Tracer::setThreadName("Audio events");
     try {
-        // Process high-priority events first
+        // Taken one at a time, so a high-priority event overtakes the rest of the queue
+        Event event;
         while (m_active.load()) {
-            std::queue<std::unique_ptr<PlaybackEvent>> eventsToProcess;
-            while (m_active.load()) {
+            {
                 std::unique_lock<std::mutex> locker(m_queueMutex);
-                while (!m_highPriorityQueue.empty()) {
-                    eventsToProcess.push(std::move(m_highPriorityQueue.front()));
-                    m_highPriorityQueue.pop_front();
-                }
-                while (!m_eventQueue.empty()) {
-                    eventsToProcess.push(std::move(m_eventQueue.front()));
-                    m_eventQueue.pop_front();
-                }
-                if (eventsToProcess.empty()) {
-                    m_queueCondition.wait(locker);
-                } else {
-                    break;
-                }
+                m_queueCondition.wait(locker, [&]() { return !m_active.load() || takeEventUnsafe(event); });
             }
             if (!m_active.load()) break;
-            while (!eventsToProcess.empty() && m_active.load()) {
-                auto event = std::move(eventsToProcess.front());
-                eventsToProcess.pop();
-                processEventUnsafe(std::move(event));
-            }
+            util::IdleMode::recordWakeup();
+            processEventUnsafe(event);
+            event.payload = std::monostate();
         }
     } catch (const std::exception& e) {
         LOG_ERROR("Error processing events: {}", e.what());
@@ -1,15 +1,19 @@
 #pragma once
 
 #include <QObject>
+#include <array>
 #include <deque>
 #include <thread>
 #include <atomic>
 #include <functional>
 #include <QHash>
 #include <memory>
+#include <QString>
+#include <QtGlobal>
 #include <QVariantHash>
 #include <condition_variable>
 #include <mutex>
+#include <variant>
 // magic_enum provides compile-time enum to string conversion (header-only)
 #include <magic_enum/magic_enum.hpp>
 
@@ -19,6 +23,16 @@ namespace audio {
  * AudioEventProcessor
  * Centralized event processing for audio player operations
  * Serializes all commands through Qt's event loop to prevent deadlocks
+ *
+ * Events carry a small typed payload and wait in a preallocated ring, so posting
+ * one allocates nothing; each type has one handler in a fixed array. A QVariantHash
+ * payload and hash handlers remain for rare events and older code.
+ *
+ * Some events make earlier ones of certain types pointless, e.g. a STOP makes a PLAY
+ * still waiting redundant (see supersededTypes()). Those earlier events are dropped
+ * before their handler starts, so skipping through songs quickly opens one stream
+ * rather than one per press. Handlers that defer their work, e.g. to another thread,
+ * should check isSuperseded() again before running it.
  */
 
 class AudioEventProcessor : public QObject
@@ -31,83 +45,107 @@ public:
         PAUSE,
         STOP,
         PLAYBACK_COMPLETE,
-        PLAYBACK_ERROR,
+        PLAYBACK_ERROR,     // ErrorInfo
+        SEEK,               // SeekRequest
         
         // Error Handling Events
         STREAM_READ_COMPLETED,
-        STREAM_READ_ERROR,
+        STREAM_READ_ERROR,  // ErrorInfo
         DECODING_FINISHED,
-        DECODING_ERROR,
+        DECODING_ERROR,     // ErrorInfo
         FRAME_TRANSMISSION_COMPLETED,
-        FRAME_TRANSMISSION_ERROR,
+        FRAME_TRANSMISSION_ERROR,   // ErrorInfo
+
+        // Gapless playback: the output switched to the prepared next track
+        NEXT_TRACK_STARTED,
         
         // State Change Events
         // SetVolume,
         // SetPlayMode,
         // UpdatePosition,
     };
+    static constexpr size_t EVENT_TYPE_COUNT = magic_enum::enum_count<PlayerEventType>();
+    // Events the ring holds before posting falls back to a growing queue
+    static constexpr size_t EVENT_RING_CAPACITY = 64;
+
+    struct SeekRequest {
+        qint64 positionMs = 0;
+    };
+    struct ErrorInfo {
+        QString message;
+        int code = 0;       // e.g. the FFmpeg error code; 0 if none
+    };
+    // QVariantHash for code still posting the old way
+    using Payload = std::variant<std::monostate, SeekRequest, ErrorInfo, QVariantHash>;
+
+    struct Event {
+        PlayerEventType type = PLAY;
+        Payload payload;
+        quint64 sequence = 0;   // Posting order, from 1; 0 if never posted
+
+        // The SEEK position, also from a hash payload's "positionMs"
+        qint64 seekPositionMs() const;
+        // The error message, also from a hash payload's "error"
+        QString errorMessage() const;
+        // The payload as the old handlers expect it
+        QVariantHash toVariantHash() const;
+    };
+    using EventHandler = std::function<void(const Event&)>;
+    using VariantHandler = std::function<void(const QVariantHash&)>;
+
 public:
     explicit AudioEventProcessor(QObject* parent = nullptr);
     ~AudioEventProcessor();
     
     // Event queue management
-    void postEvent(PlayerEventType eventType, const QVariantHash& eventData = {});
+    void postEvent(PlayerEventType eventType, Payload payload = {});
     
     // High-priority events (processed immediately)
-    void postHighPriorityEvent(PlayerEventType eventType, const QVariantHash& eventData = {});
+    void postHighPriorityEvent(PlayerEventType eventType, Payload payload = {});
 
-    // Event handler registration
-    void setEventHandler(PlayerEventType type, std::function<void(const QVariantHash&)> handler);
+    // Event handler registration; set before start()
+    void setEventHandler(PlayerEventType type, EventHandler handler);
+    // Compatibility: the handler gets the payload converted to a QVariantHash
+    void setEventHandler(PlayerEventType type, VariantHandler handler);
     
-    // Queue status
+    // Queue status; superseded events count until they are dropped
     int pendingEventCount() const;
+
+    // Whether an event posted after this one made it redundant
+    bool isSuperseded(const Event& event) const;
+    // Bit i set: posting eventType supersedes pending events of type i
+    static quint32 supersededTypes(PlayerEventType eventType);
     
     // Control
     void start();
     void stop();
 private:
-    class PlaybackEvent;
-    void processEventUnsafe(std::unique_ptr<PlaybackEvent> event);
+    void processEventUnsafe(const Event& event);
     void processEventFunc();
+    // Take the next event, high priority first; callers hold m_queueMutex
+    bool takeEventUnsafe(Event& event);
+    // Stamp the next sequence and supersede what it replaces; callers hold m_queueMutex
+    quint64 sequenceEventUnsafe(PlayerEventType eventType);
 signals:
     void processingError(const QString& error);
     
 private:
     mutable std::condition_variable m_queueCondition;
     mutable std::mutex m_queueMutex;
-    std::deque<std::unique_ptr<PlaybackEvent>> m_eventQueue;
-    std::deque<std::unique_ptr<PlaybackEvent>> m_highPriorityQueue;
+    std::array<Event, EVENT_RING_CAPACITY> m_eventRing;
+    size_t m_ringHead = 0;      // Oldest event
+    size_t m_ringSize = 0;
+    // Events past a full ring, delivered after it so order holds
+    std::deque<Event> m_overflowQueue;
+    std::deque<Event> m_highPriorityQueue;
     
     std::unique_ptr<std::thread> m_processingThread;
-    std::unordered_map<PlayerEventType, std::function<void(const QVariantHash&)>> m_eventHandlers;
+    std::array<EventHandler, EVENT_TYPE_COUNT> m_eventHandlers;
+    quint64 m_lastSequence = 0;     // Guarded by m_queueMutex
+    // Events of type i with a sequence below entry i are superseded
+    std::array<std::atomic<quint64>, EVENT_TYPE_COUNT> m_supersededBefore{};
     
     std::atomic<bool> m_active{true};
 };
 
-class AudioEventProcessor::PlaybackEvent 
-{
-public:
-    // Disable default constructor, copy constructor, and assignment operator
-    PlaybackEvent() = delete;
-    PlaybackEvent(const PlaybackEvent&) = delete;
-    PlaybackEvent& operator=(const PlaybackEvent&) = delete;
-
-    explicit PlaybackEvent(PlayerEventType eventType, const QVariantHash& eventData = {})
-        : type(eventType), data(eventData) {}
-    virtual ~PlaybackEvent() = default;
-    PlayerEventType getType() const { return type; }
-    QVariantHash getData() const { return data; }
-    virtual QString toString() const {
-        // Use magic_enum to get the enum identifier name (e.g. "PLAY", "PAUSE")
-        auto name = magic_enum::enum_name(type);
-        QString name_q = QString::fromUtf8(name.data(), static_cast<int>(name.size()));
-        return QString("PlaybackEvent(Type=%1, DataKeys=[%2])")
-            .arg(name_q)
-            .arg(data.keys().join(", "));
-    }
-private:
-    PlayerEventType type;
-    QVariantHash data;
-};
-
 } // namespace audio
\ No newline at end of file
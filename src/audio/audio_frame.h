@@ -1,9 +1,13 @@
 #pragma once
 
 #include <vector>
-#include <util/safe_queue.hpp>
+#include <util/spsc_ring_queue.hpp>
 #include <memory>
 #include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 struct AudioFrame {
     std::vector<uint8_t> data;
@@ -11,6 +15,10 @@ struct AudioFrame {
     int channels;
     int bits_per_sample{16};
     int64_t pts;
+    // Presentation time of the first sample, in samples per channel at sample_rate; -1 if unknown
+    int64_t pts_samples{-1};
+    // First frame decoded after a seek; frames queued before it belong to the old position
+    bool discontinuity{false};
     
     AudioFrame(size_t size) : data(size) {}
     
@@ -39,6 +47,140 @@ struct AudioFormat {
     int bits_per_sample;
     
     constexpr bool isValid() const { return sample_rate > 0 && channels > 0 && bits_per_sample > 0; }
+    constexpr bool operator==(const AudioFormat& other) const {
+        return sample_rate == other.sample_rate && channels == other.channels
+            && bits_per_sample == other.bits_per_sample;
+    }
+    constexpr bool operator!=(const AudioFormat& other) const { return !(*this == other); }
 };
 
-typedef SafeQueue<std::shared_ptr<AudioFrame>> AudioFrameQueue;
\ No newline at end of file
+constexpr size_t AUDIO_FRAME_QUEUE_CAPACITY = 256;
+// Default decode-ahead window: how much PCM the decoder keeps queued ahead of the output
+constexpr int64_t DEFAULT_MIN_DECODE_AHEAD_MS = 300;
+constexpr int64_t DEFAULT_MAX_DECODE_AHEAD_MS = 2000;
+
+// Decoder -> output hand-off. One producer (decoder thread), one consumer (frame transmission thread).
+// Backpressure is measured in queued playback time rather than frame count, since frame sizes vary
+// widely between codecs: push() blocks once maxAheadMs of audio is queued and resumes after the
+// consumer has drained it to minAheadMs. The frame-count watermarks of the ring remain as an upper
+// bound. The decoder closes the queue when it stops producing so the consumer can tell end-of-stream
+// from starvation.
+class AudioFrameQueue : public util::SpscRingQueue<std::shared_ptr<AudioFrame>> {
+    using Base = util::SpscRingQueue<std::shared_ptr<AudioFrame>>;
+public:
+    explicit AudioFrameQueue(size_t capacity = AUDIO_FRAME_QUEUE_CAPACITY,
+                             int64_t minAheadMs = DEFAULT_MIN_DECODE_AHEAD_MS,
+                             int64_t maxAheadMs = DEFAULT_MAX_DECODE_AHEAD_MS)
+        : Base(capacity) {
+        setDecodeAheadWindow(minAheadMs, maxAheadMs);
+    }
+
+    ~AudioFrameQueue() {
+        close();
+    }
+
+    // May be called from any thread; a producer blocked on the old window re-checks the new one.
+    void setDecodeAheadWindow(int64_t minAheadMs, int64_t maxAheadMs) {
+        maxAheadUs_.store(std::max<int64_t>(1, maxAheadMs) * 1000, std::memory_order_relaxed);
+        minAheadUs_.store(std::clamp<int64_t>(minAheadMs, 0, std::max<int64_t>(0, maxAheadMs - 1)) * 1000,
+                          std::memory_order_relaxed);
+        notifyProducer();
+    }
+
+    // Producer side: enqueue, blocking while maxAheadMs or more of audio is queued.
+    // Returns false if the queue was closed before the frame could be stored.
+    bool push(std::shared_ptr<AudioFrame> frame) {
+        if (queuedUs_.load(std::memory_order_acquire) >= maxAheadUs_.load(std::memory_order_relaxed)) {
+            std::unique_lock<std::mutex> lock(durationMutex_);
+            producerWaiting_.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            durationCv_.wait(lock, [this]() {
+                return queuedUs_.load(std::memory_order_acquire) <= minAheadUs_.load(std::memory_order_relaxed)
+                    || closed();
+            });
+            producerWaiting_.store(false, std::memory_order_relaxed);
+        }
+        const int64_t us = frameUs(frame);
+        // Account before publishing so the consumer never subtracts a frame that wasn't added
+        queuedUs_.fetch_add(us, std::memory_order_acq_rel);
+        if (!Base::push(std::move(frame))) {
+            queuedUs_.fetch_sub(us, std::memory_order_acq_rel);
+            return false;
+        }
+        return true;
+    }
+
+    bool tryPush(std::shared_ptr<AudioFrame> frame) {
+        const int64_t us = frameUs(frame);
+        queuedUs_.fetch_add(us, std::memory_order_acq_rel);
+        if (!Base::tryPush(std::move(frame))) {
+            queuedUs_.fetch_sub(us, std::memory_order_acq_rel);
+            return false;
+        }
+        return true;
+    }
+
+    bool tryPop(std::shared_ptr<AudioFrame>& frame) {
+        if (!Base::tryPop(frame)) return false;
+        onPopped(frame);
+        return true;
+    }
+
+    bool waitPop(std::shared_ptr<AudioFrame>& frame) {
+        if (!Base::waitPop(frame)) return false;
+        onPopped(frame);
+        return true;
+    }
+
+    void close() {
+        Base::close();
+        std::lock_guard<std::mutex> lock(durationMutex_);
+        durationCv_.notify_all();
+    }
+
+    void clean() {
+        std::shared_ptr<AudioFrame> frame;
+        while (tryPop(frame)) {
+        }
+    }
+
+    // Playback time currently queued, in milliseconds
+    int64_t queuedDurationMs() const {
+        return queuedUs_.load(std::memory_order_acquire) / 1000;
+    }
+    int64_t minAheadMs() const { return minAheadUs_.load(std::memory_order_relaxed) / 1000; }
+    int64_t maxAheadMs() const { return maxAheadUs_.load(std::memory_order_relaxed) / 1000; }
+
+    // Linear gain the output applies to this track's frames (loudness normalization); 1 = unchanged
+    void setTrackGain(float gain) { trackGain_.store(gain, std::memory_order_relaxed); }
+    float trackGain() const { return trackGain_.load(std::memory_order_relaxed); }
+
+private:
+    static int64_t frameUs(const std::shared_ptr<AudioFrame>& frame) {
+        return frame ? static_cast<int64_t>(frame->durationSeconds() * 1000000.0) : 0;
+    }
+
+    void onPopped(const std::shared_ptr<AudioFrame>& frame) {
+        const int64_t us = frameUs(frame);
+        const int64_t remaining = queuedUs_.fetch_sub(us, std::memory_order_acq_rel) - us;
+        if (remaining <= minAheadUs_.load(std::memory_order_relaxed)) {
+            notifyProducer();
+        }
+    }
+
+    void notifyProducer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting_.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(durationMutex_);
+            durationCv_.notify_one();
+        }
+    }
+
+    std::atomic<int64_t> queuedUs_{0};
+    std::atomic<int64_t> minAheadUs_{0};
+    std::atomic<int64_t> maxAheadUs_{0};
+    std::atomic<bool> producerWaiting_{false};
+    std::atomic<float> trackGain_{1.0f};
+    std::mutex durationMutex_;
+    std::condition_variable durationCv_;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include "audio_frame.h"
+
+/**
+ * @brief Recycling pool of AudioFrame buffers owned by the decoder
+ *
+ * Frames are handed out as ordinary std::shared_ptr<AudioFrame>. The pool keeps
+ * one reference to every frame it created; once the consumer (queue + output)
+ * drops its references the frame is free again and is reused by the next
+ * acquire(), together with its shared_ptr control block and PCM storage.
+ * In steady state decoding therefore performs no heap allocation at all.
+ *
+ * acquire() must only be called from a single thread (the decoder thread).
+ * Statistics may be read from any thread.
+ */
+class AudioFramePool {
+public:
+    struct Stats {
+        uint64_t hits = 0;      // acquire() served by a recycled frame with enough capacity
+        uint64_t misses = 0;    // acquire() had to allocate a frame or grow its buffer
+        size_t pooled = 0;      // frames currently owned by the pool
+    };
+
+    /**
+     * @param maxFrames Upper bound of frames retained by the pool. When all of them are
+     *                  in flight, acquire() falls back to an un-pooled allocation.
+     */
+    explicit AudioFramePool(size_t maxFrames = AUDIO_FRAME_QUEUE_CAPACITY + 16)
+        : maxFrames_(maxFrames) {
+        frames_.reserve(maxFrames_);
+    }
+
+    AudioFramePool(const AudioFramePool&) = delete;
+    AudioFramePool& operator=(const AudioFramePool&) = delete;
+
+    // Get a frame whose data holds exactly `size` bytes (contents unspecified).
+    std::shared_ptr<AudioFrame> acquire(size_t size) {
+        const size_t count = frames_.size();
+        for (size_t i = 0; i < count; ++i) {
+            // Frames are consumed in FIFO order, so the slot after the last one
+            // handed out is almost always the first one to become free again.
+            size_t index = (cursor_ + i) % count;
+            auto& frame = frames_[index];
+            if (frame.use_count() != 1) {
+                continue;
+            }
+            // Pairs with the consumer's release when it dropped the last reference.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            cursor_ = (index + 1) % count;
+            if (frame->data.capacity() >= size) {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                misses_.fetch_add(1, std::memory_order_relaxed);
+            }
+            frame->data.resize(size);
+            return frame;
+        }
+
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        auto frame = std::make_shared<AudioFrame>(size);
+        if (frames_.size() < maxFrames_) {
+            frames_.push_back(frame);
+            pooledCount_.store(frames_.size(), std::memory_order_relaxed);
+        }
+        return frame;
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.hits = hits_.load(std::memory_order_relaxed);
+        s.misses = misses_.load(std::memory_order_relaxed);
+        s.pooled = pooledCount_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    size_t maxFrames_;
+    size_t cursor_ = 0;
+    std::vector<std::shared_ptr<AudioFrame>> frames_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<size_t> pooledCount_{0};
+};
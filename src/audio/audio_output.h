@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "audio_frame.h"
+#include "playback_telemetry.h"
+#include "spectrum_tap.h"
+
+/**
+ * IAudioOutput - sink the controller hands decoded PCM to.
+ *
+ * Implementations: WASAPIAudioOutputUnsafe (the default render endpoint), and the headless
+ * NullAudioOutput / WavFileAudioOutput which consume frames as fast as they are produced.
+ * None of them is thread-safe unless a method says otherwise.
+ *
+ * Two render modes are supported:
+ * - Push: the caller feeds PCM through playAudioData() and polls getAvailableCacheBytes().
+ * - EventDriven: the output runs its own render thread that pulls PCM from the frame source
+ *   set by setFrameSource(). playAudioData() must not be used in this mode.
+ */
+class IAudioOutput
+{
+public:
+    enum class RenderMode {
+        Push = 0,
+        EventDriven = 1
+    };
+
+    virtual ~IAudioOutput() = default;
+
+    // bits_per_sample is 16 (signed integer samples) or 32 (float samples)
+    virtual bool initialize(int sample_rate, int channels, int bits_per_sample = 16,
+                            RenderMode mode = RenderMode::Push) = 0;
+    // Push mode: pts_samples is AudioFrame::pts_samples of the data, used to anchor position reporting
+    virtual void playAudioData(const uint8_t* data, int size, int64_t pts_samples = -1) = 0;
+    virtual bool isInitialized() const = 0;
+    virtual RenderMode renderMode() const = 0;
+
+    /**
+     * EventDriven mode only: queue the render thread pulls frames from.
+     * @param source Frame queue; the render thread becomes its only consumer
+     * @param onDrained Called once from the render thread after the source is closed
+     *                  and every queued frame has been rendered
+     */
+    virtual void setFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained) = 0;
+
+    /**
+     * EventDriven mode only, thread-safe: frame source to continue with once the current
+     * one is closed and drained. The render thread switches without a gap and without
+     * re-initializing the output. Frames must have the same format as the current source.
+     * @param onDrained Replaces the current drained callback after the switch
+     * @param onStarted Called once from the render thread right after the switch
+     */
+    virtual void setNextFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained,
+                                    std::function<void()> onStarted) = 0;
+    // Drop a pending next source; returns false if the render thread already switched to it
+    virtual bool clearNextFrameSource() = 0;
+    // EventDriven mode only, thread-safe: overlap the end of the current source with the start
+    // of the next one by this many milliseconds (see audio::CrossfadeMixer); 0 = plain gapless
+    virtual void setCrossfadeDuration(int ms) = 0;
+
+    virtual bool start() = 0;
+    virtual bool pause() = 0;
+    virtual bool stop() = 0;
+    virtual bool isPlaying() const = 0;
+    // Push mode: bytes of input PCM the output can take right now
+    virtual int getAvailableCacheBytes() const = 0;
+    // Device frames buffered but not played yet
+    virtual int getCurrentFrames() const = 0;
+    // Current track position in milliseconds. Lock-free; safe to call from any thread
+    // while the object is alive.
+    virtual int64_t getCurrentPositionMs() const = 0;
+    // Track position of the first frame written after start (playback started mid-track)
+    virtual void setPositionOffsetMs(int64_t positionMs) = 0;
+    /**
+     * Drop everything buffered for a seek; playback continues if it was running.
+     * In EventDriven mode frames popped from the source are discarded until one carries
+     * AudioFrame::discontinuity, so call this before asking the decoder to seek.
+     * @param positionMs Track position reported once the new frames play
+     */
+    virtual bool flushForSeek(int64_t positionMs) = 0;
+    virtual void setVolume(float volume) = 0; // Volume: 0.0 - 1.0
+    // Glitch counters updated by every write; set before start()
+    virtual void setTelemetry(std::shared_ptr<audio::PlaybackTelemetry> telemetry) = 0;
+    // Visualizer copy of every block sent to the device; set before start()
+    virtual void setSpectrumTap(std::shared_ptr<audio::SpectrumTap> tap) = 0;
+};
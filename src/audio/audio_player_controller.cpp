@@ -5,22 +5,35 @@
 #include <log/log_manager.h>
 #include <network/network_manager.h>
 #include <playlist/playlist_manager.h>
+#include <util/audio_cache_store.h>
 #include <util/md5.h>
+#include <util/idle_mode.h>
+#include <util/memory_budget.h>
+#include <util/thread_priority.h>
+#include <util/trace.h>
 #include <QDir>
 #include <QFileInfo>
 #include <QThread>
 #include <QTimer>
 #include <QPointer>
+#include <algorithm>
 #include <chrono>
 #include <fmt/format.h>
 #include <fstream>
 #include <memory>
 #include <magic_enum/magic_enum.hpp>
+#include "audio_workers.h"
 #include "ffmpeg_decoder.h"
 #include "wasapi_audio_output.h"
+#include "sample_convert.h"
 
 namespace audio {
 
+namespace {
+    // How long before the end of the current track the next one starts being prepared
+    constexpr qint64 GAPLESS_PREPARE_LEAD_MS = 10000;
+}
+
 AudioPlayerController::AudioPlayerController(QObject *parent)
     : QObject(parent)
     , m_eventProcessor(std::make_unique<audio::AudioEventProcessor>(this))
@@ -32,6 +45,10 @@ AudioPlayerController::AudioPlayerController(QObject *parent)
     // Frame transmission thread (consumes frames from decoder and sends to audio output)
     , m_frameQueue(std::make_shared<AudioFrameQueue>())
     , m_frameTransmissionActive(false)
+    , m_discardUntilDiscontinuity(false)
+    , m_decodeAheadMinMs(static_cast<int>(DEFAULT_MIN_DECODE_AHEAD_MS))
+    , m_decodeAheadMaxMs(static_cast<int>(DEFAULT_MAX_DECODE_AHEAD_MS))
+    , m_crossfadeMs(0)
 
     // Playlist data
     , m_currentPlaylistId(QUuid())
@@ -44,52 +61,90 @@ AudioPlayerController::AudioPlayerController(QObject *parent)
     , m_volume(0.8f)
     // Position timer
     , m_positionTimer(new QTimer(this))
-    , m_randomGenerator(m_randomDevice())
-    , m_randomIndex(0)
+    , m_telemetry(std::make_shared<PlaybackTelemetry>())
+    , m_telemetryLogTimer(new QTimer(this))
+    , m_pcmCache(std::make_shared<DecodedPcmCache>())
+    , m_loudnessNormalization(true)
+    , m_loudnessAnalyzer(std::make_shared<LoudnessAnalyzer>(
+          [this](const std::string& key, double gainDb) { this->onLoudnessAnalyzed(key, gainDb); }))
+    , m_spectrumTap(std::make_shared<SpectrumTap>())
+    , m_spectrumAnalyzer(new SpectrumAnalyzer(m_spectrumTap, this))
+    , m_nextTrackPreparing(false)
+    , m_playGeneration(1)
+    , m_prepareAttemptGeneration(0)
+    , m_outputFormat{0, 0, 0}
 {
     // Setup event processor
     registerEventHandlers();
     m_eventProcessor->start();
     m_positionTimer->setInterval(500); // Update position every 500 ms
+    m_pcmCache->attachBudget(util::MemoryBudget::instance());
     
     LOG_INFO(" AudioPlayerController initialized with event-driven architecture");
     connect(m_positionTimer, &QTimer::timeout, this, &AudioPlayerController::onPositionTimerTimeout);
+    connect(m_telemetryLogTimer, &QTimer::timeout, this, &AudioPlayerController::onTelemetryLogTimerTimeout);
     connect(PLAYLIST_MANAGER, &PlaylistManager::playlistSongsChanged, this, &AudioPlayerController::onPlaylistChanged);
 }
 
 AudioPlayerController::~AudioPlayerController()
 {
+    // Joins the analysis worker, so no result arrives during teardown
+    m_loudnessAnalyzer.reset();
+    m_spectrumAnalyzer->stop();
+    // Let an in-flight next track preparation finish; it discards its result on a generation change.
+    m_playGeneration.fetch_add(1);
+    m_nextTrackPrepareJob.wait();
+    util::WorkerThreads::Job warmStart;
+    {
+        std::scoped_lock locker(m_stateMutex);
+        warmStart = m_warmStartJob;
+    }
+    warmStart.wait();
+    // Before taking m_componentMutex below: the watcher locks it on every check.
+    m_playbackWatcherExitFlag.store(true);
+    m_playbackWatcherJob.wait();
+
     // Stop sending frame into audio player.
-    m_frameTransmissionActive.store(false);
-    // Clean frame queue.
+    {
+        std::scoped_lock locker(m_stateMutex);
+        m_frameTransmissionActive.store(false);
+    }
+    m_transmissionResumed.notify_all();
+    // Close frame queue to wake both the decoder and the transmission thread.
+    m_frameQueue->close();
+    m_frameTransmissionJob.wait();
     m_frameQueue->clean();
-    if (m_frameTransmissionThread && m_frameTransmissionThread->joinable()) {
-        m_frameTransmissionThread->join();
+
+    // Stop the audio player outside the lock: its render thread may be waiting
+    // on m_componentMutex in onFrameSourceDrained().
+    std::shared_ptr<IAudioOutput> audioOutput;
+    {
+        std::unique_lock<std::mutex> locker(m_componentMutex);
+        audioOutput = std::move(m_audioOutput);
+        std::atomic_store(&m_positionOutput, std::shared_ptr<IAudioOutput>());
+    }
+    if (audioOutput) {
+        audioOutput->stop();
+        audioOutput.reset();
     }
 
     std::unique_lock<std::mutex> locker(m_componentMutex);
-    // Free audio player
-    if (m_audioOutput) {
-        m_audioOutput->stop();
-        m_audioOutput.reset();
-    }
 
     // Free decoder
     if (m_decoder) {
         m_decoder->pauseDecoding();
         m_decoder.reset();
     }
+    if (m_preparedTrack) {
+        m_preparedTrack->frameQueue->close();
+        m_preparedTrack.reset();
+    }
     // Free input stream
     if (m_currentStream) {
         m_currentStream->clear();
         m_currentStream.reset();
     }
 
-    if (m_playbackWatcherThread && m_playbackWatcherThread->joinable()) {
-        m_playbackWatcherExitFlag.store(true);
-        m_playbackWatcherThread->join();
-    }
-    
     LOG_INFO(" AudioPlayerController destroyed");
 }
 
@@ -121,6 +176,24 @@ void AudioPlayerController::loadConfig()
     QUuid playlistId(playlistIdStr);
     int audioIndex = CONFIG_MANAGER->getCurrentAudioIndex();
     setCurrentPlaylist(playlistId, audioIndex);
+
+    int minAheadMs = std::max(0, CONFIG_MANAGER->getDecodeAheadMinMs());
+    int maxAheadMs = std::max(minAheadMs + 1, CONFIG_MANAGER->getDecodeAheadMaxMs());
+    // The crossfade can only overlap what is still queued when the decoder reaches EOF
+    int crossfadeMs = std::max(0, CONFIG_MANAGER->getCrossfadeMs());
+    if (crossfadeMs > minAheadMs) {
+        maxAheadMs += crossfadeMs - minAheadMs;
+        minAheadMs = crossfadeMs;
+    }
+    setCrossfadeDuration(crossfadeMs);
+    setTelemetryLogInterval(CONFIG_MANAGER->getTelemetryLogInterval());
+    m_pcmCache->setBudgetBytes(static_cast<size_t>(std::max(0, CONFIG_MANAGER->getPcmCacheBudgetMb())) * 1024 * 1024);
+    setLoudnessNormalization(CONFIG_MANAGER->getLoudnessNormalization());
+
+    m_decodeAheadMinMs = minAheadMs;
+    m_decodeAheadMaxMs = maxAheadMs;
+    std::lock_guard<std::mutex> lock(m_componentMutex);
+    m_frameQueue->setDecodeAheadWindow(minAheadMs, maxAheadMs);
 }
 
 void AudioPlayerController::playPlaylist(const QUuid& playlistId, int startIndex)
@@ -131,7 +204,7 @@ void AudioPlayerController::playPlaylist(const QUuid& playlistId, int startIndex
     }
     
     // Get playlist songs
-    auto songs = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistId, [](const playlist::SongInfo&) { return true; });
+    auto songs = PLAYLIST_MANAGER->songsSnapshot(playlistId);
     if (songs.isEmpty()) {
         emit playbackError("Playlist is empty");
         return;
@@ -148,13 +221,6 @@ void AudioPlayerController::playPlaylist(const QUuid& playlistId, int startIndex
         m_currentPlaylist = songs;
         m_currentIndex = startIndex;
 
-        // Setup random order if needed (create shuffled copy while holding lock)
-        if (m_playMode == playlist::PlayMode::Random) {
-            if (m_randomPlayOrder.size() != m_currentPlaylist.size()) {
-                setupRandomGenerator();
-            }
-        }
-
         // Capture a local copy for safe emission outside the lock
         if (m_currentIndex >= 0 && m_currentIndex < m_currentPlaylist.size()) {
             songCopy = m_currentPlaylist[m_currentIndex];
@@ -166,13 +232,14 @@ void AudioPlayerController::playPlaylist(const QUuid& playlistId, int startIndex
     }
 
     LOG_INFO(" Starting playlist playback with {} songs, starting at index {}", songs.size(), startIndex);
+    queueLoudnessAnalysis(songs);
     if (songIndex >= 0) {
         emit currentSongChanged(songCopy, songIndex);
     } else {
         emit currentSongChanged(playlist::SongInfo(), -1);
     }
     // Send Start event to event processor
-    if (isPlaying()) {
+    if (!isStopped()) {
         m_eventProcessor->postEvent(audio::AudioEventProcessor::STOP);
     }
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAY);
@@ -186,7 +253,7 @@ void AudioPlayerController::playPlaylistFromSong(const QUuid& playlistId, const
     }
     
     // Get playlist songs
-    auto songs = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistId, [](const playlist::SongInfo&) { return true; });
+    auto songs = PLAYLIST_MANAGER->songsSnapshot(playlistId);
     if (songs.isEmpty()) {
         emit playbackError("Playlist is empty");
         return;
@@ -210,19 +277,14 @@ void AudioPlayerController::playPlaylistFromSong(const QUuid& playlistId, const
         m_currentPlaylistId = playlistId;
         m_currentPlaylist = songs;
         m_currentIndex = startIndex;
-        // Setup random order if needed (create shuffled copy while holding lock)
-        if (m_playMode == playlist::PlayMode::Random) {
-            if (m_randomPlayOrder.size() != m_currentPlaylist.size()) {
-                setupRandomGenerator();
-            }
-        }
     }
 
     LOG_INFO(" Starting playlist playback with {} songs, starting at index {}", songs.size(), startIndex);
+    queueLoudnessAnalysis(songs);
     emit currentSongChanged(m_currentPlaylist[m_currentIndex], m_currentIndex);
     // Send Start event to event processor
     
-    if (m_currentState == PlaybackState::Playing) {
+    if (!isStopped()) {
         m_eventProcessor->postEvent(audio::AudioEventProcessor::STOP);
     }
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAY);
@@ -236,7 +298,8 @@ void AudioPlayerController::setCurrentPlaylist(const QUuid &playlistId, const in
     }
     
     // Get playlist songs
-    auto songs = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistId, [](const playlist::SongInfo&) { return true; });
+    auto songs = PLAYLIST_MANAGER->songsSnapshot(playlistId);
+    queueLoudnessAnalysis(songs);
     
     std::scoped_lock locker(m_stateMutex);
     if (songs.isEmpty()) {
@@ -273,7 +336,6 @@ void AudioPlayerController::clearPlaylist()
     m_currentPlaylistId = QUuid();
     m_currentPlaylist.clear();
     m_currentIndex = -1;
-    m_randomPlayOrder.clear();
 
     m_eventProcessor->postEvent(audio::AudioEventProcessor::STOP);
     emit currentSongChanged(playlist::SongInfo(), -1);
@@ -297,12 +359,13 @@ void AudioPlayerController::stop()
 void AudioPlayerController::next()
 {
     std::unique_lock<std::mutex> locker(m_stateMutex);
-    if (m_currentState == PlaybackState::Playing) {
+    // Paused too: PLAY would resume the old song instead of opening this one
+    if (m_currentState != PlaybackState::Stopped) {
         m_eventProcessor->postEvent(audio::AudioEventProcessor::STOP);
     }
     if (m_currentPlaylist.isEmpty()) {
-        m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, QVariantHash{
-            {"error", "Failed to play next song: Playlist is empty"}
+        m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, audio::AudioEventProcessor::ErrorInfo{
+            QStringLiteral("Failed to play next song: Playlist is empty")
         });
         return;
     }
@@ -313,15 +376,17 @@ void AudioPlayerController::next()
     case playlist::PlayMode::PlaylistLoop:
         m_currentIndex = (m_currentIndex + 1) % m_currentPlaylist.size();
         break;
-    case playlist::PlayMode::Random:
-        if (m_randomPlayOrder.isEmpty()) {
-            m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, QVariantHash{
-                {"error", "Failed to play next song: Random play order is empty"}
+    case playlist::PlayMode::Random: {
+        const int index = shuffledIndex(true);
+        if (index < 0) {
+            m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, audio::AudioEventProcessor::ErrorInfo{
+                QStringLiteral("Failed to play next song: No song in the shuffle order")
             });
             return;
         }
+        m_currentIndex = index;
         break;
-        m_randomIndex = (m_randomIndex + 1) % m_randomPlayOrder.size();
+    }
     }
     emit currentSongChanged(m_currentPlaylist[m_currentIndex], m_currentIndex);
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAY);
@@ -330,12 +395,12 @@ void AudioPlayerController::next()
 void AudioPlayerController::previous()
 {
     std::unique_lock<std::mutex> locker(m_stateMutex);
-    if (m_currentState == PlaybackState::Playing) {
+    if (m_currentState != PlaybackState::Stopped) {
         m_eventProcessor->postEvent(audio::AudioEventProcessor::STOP);
     }
     if (m_currentPlaylist.isEmpty()) {
-        m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, QVariantHash{
-            {"error", "Failed to play previous song: Playlist is empty"}
+        m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, audio::AudioEventProcessor::ErrorInfo{
+            QStringLiteral("Failed to play previous song: Playlist is empty")
         });
         return;
     }
@@ -345,32 +410,81 @@ void AudioPlayerController::previous()
         break;
     case playlist::PlayMode::PlaylistLoop:
         m_currentIndex = (m_currentIndex - 1 + m_currentPlaylist.size()) % m_currentPlaylist.size();
-        
-    case playlist::PlayMode::Random:
-        if (m_randomPlayOrder.isEmpty()) {
-            m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, QVariantHash{
-                {"error", "Failed to play previous song: Random play order is empty"}
+        break;
+    case playlist::PlayMode::Random: {
+        const int index = shuffledIndex(false);
+        if (index < 0) {
+            m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR, audio::AudioEventProcessor::ErrorInfo{
+                QStringLiteral("Failed to play previous song: No song in the shuffle order")
             });
             return;
         }
-        m_randomIndex = (m_randomIndex - 1 + m_randomPlayOrder.size()) % m_randomPlayOrder.size();
+        m_currentIndex = index;
         break;
     }
+    }
     
     emit currentSongChanged(m_currentPlaylist[m_currentIndex], m_currentIndex);
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAY);
 }
 
-// void AudioPlayerController::seekTo(qint64 positionMs)
-// {
-//     // TODO: Implement seeking functionality in new decoder API
-//     // The new FFmpegStreamDecoder doesn't yet support seeking
-// }
+void AudioPlayerController::prepareCurrentSong()
+{
+    std::scoped_lock locker(m_stateMutex);
+    if (m_currentState != PlaybackState::Stopped || m_songOpening
+        || m_currentIndex < 0 || m_currentIndex >= m_currentPlaylist.size()) {
+        return;
+    }
+    const playlist::SongInfo song = m_currentPlaylist[m_currentIndex];
+    const int index = m_currentIndex;
+    // Claimed and the job published under one lock, so PLAY either sees neither or both.
+    // The job only starts running the open, which takes the lock later
+    m_songOpening = true;
+    LOG_INFO(" Warm starting {}", song.title.toStdString());
+    m_warmStartJob = audioWorkers().run([this, song, index]() {
+        PlayOperationResult result{PlayOperationResult::Success, QString{}};
+        try {
+            result = playCurrentSongUnsafe(song, index, 0, true);
+        } catch (const std::exception& e) {
+            LOG_ERROR(" Warm start threw exception: {}", e.what());
+            result = PlayOperationResult{PlayOperationResult::PlaybackError, QString::fromUtf8(e.what())};
+        } catch (...) {
+            LOG_ERROR(" Warm start threw unknown exception");
+            result = PlayOperationResult{PlayOperationResult::PlaybackError, QString{}};
+        }
+        {
+            std::scoped_lock locker(m_stateMutex, m_componentMutex);
+            if (result.kind != PlayOperationResult::Success && result.kind != PlayOperationResult::Superseded) {
+                // Quietly: the error is reported if the user presses play
+                LOG_WARN(" Warm start failed: {}", result.message.toStdString());
+                // Drop frames decoded before the failure, PLAY expects an empty queue. Nothing
+                // was committed, and nothing else opened a song while this one was opening
+                if (m_currentState == PlaybackState::Stopped && !m_decoder && !m_frameQueue->empty()) {
+                    m_frameQueue->close();
+                    m_frameQueue = makeFrameQueue();
+                }
+            }
+            m_songOpening = false;
+        }
+        if (result.kind == PlayOperationResult::Success) {
+            emit playbackStateChanged(PlaybackState::Paused);
+        }
+    });
+}
+
+void AudioPlayerController::seekTo(qint64 positionMs)
+{
+    m_eventProcessor->postEvent(audio::AudioEventProcessor::SEEK, audio::AudioEventProcessor::SeekRequest{positionMs});
+}
 
 void AudioPlayerController::setPlayMode(playlist::PlayMode mode)
 {
-    std::scoped_lock locker(m_stateMutex);
-    m_playMode = mode;
+    {
+        std::scoped_lock locker(m_stateMutex);
+        m_playMode = mode;
+    }
+    // The prepared next track was chosen with the previous mode
+    discardPreparedTrack();
     emit playModeChanged(mode);
 }
 
@@ -417,6 +531,16 @@ bool AudioPlayerController::isStopped() const
     return m_currentState == PlaybackState::Stopped;
 }
 
+qint64 AudioPlayerController::getCurrentPositionMs() const
+{
+    if (auto output = std::atomic_load(&m_positionOutput)) {
+        if (output->isInitialized()) {
+            return output->getCurrentPositionMs();
+        }
+    }
+    return m_currentPosition.load();
+}
+
 void AudioPlayerController::setVolume(float volume)
 {
     std::unique_lock<std::mutex> locker(m_stateMutex);
@@ -433,38 +557,93 @@ float AudioPlayerController::getVolume() const
     return m_volume;
 }
 
+void AudioPlayerController::setCrossfadeDuration(int ms)
+{
+    m_crossfadeMs = std::max(0, ms);
+    std::lock_guard<std::mutex> lock(m_componentMutex);
+    if (m_audioOutput) {
+        m_audioOutput->setCrossfadeDuration(m_crossfadeMs.load());
+    }
+}
+
+int AudioPlayerController::getCrossfadeDuration() const
+{
+    return m_crossfadeMs.load();
+}
+
+void AudioPlayerController::setLoudnessNormalization(bool enabled)
+{
+    m_loudnessNormalization.store(enabled);
+    LOG_INFO(" Loudness normalization {}", enabled ? "enabled" : "disabled");
+}
+
+bool AudioPlayerController::isLoudnessNormalizationEnabled() const
+{
+    return m_loudnessNormalization.load();
+}
+
+PlaybackTelemetry::Snapshot AudioPlayerController::getPlaybackTelemetry() const
+{
+    auto snapshot = m_telemetry->snapshot();
+    snapshot.wakeupsPerSecond = util::IdleMode::wakeupsPerSecond();
+    return snapshot;
+}
+
+void AudioPlayerController::resetPlaybackTelemetry()
+{
+    m_telemetry->reset();
+}
+
+void AudioPlayerController::setTelemetryLogInterval(int seconds)
+{
+    if (seconds <= 0) {
+        m_telemetryLogTimer->stop();
+        return;
+    }
+    m_telemetryLogTimer->start(seconds * 1000);
+}
+
+void AudioPlayerController::onTelemetryLogTimerTimeout()
+{
+    util::IdleMode::recordWakeup();
+    auto t = getPlaybackTelemetry();
+    LOG_INFO(" Playback telemetry: underruns {}, late writes {}, frames queued {}, max queue depth {} frames / {} ms, "
+             "decoder stall {} ms, network wait {} ms, wake-ups {:.1f}/s",
+             t.bufferUnderruns, t.lateWrites, t.framesQueued, t.maxQueueDepthFrames, t.maxQueueDepthMs,
+             t.decoderStallUs / 1000, t.networkWaitUs / 1000, t.wakeupsPerSecond);
+}
+
 void AudioPlayerController::onPositionTimerTimeout()
 {
-    // Update playback position using audio output's device clock (IAudioClock)
-    std::scoped_lock locker(m_stateMutex, m_componentMutex);
-    if (m_audioOutput && m_audioOutput->isInitialized() && m_audioOutput->isPlaying()) {
-        int64_t posMs = m_audioOutput->getCurrentPositionMs();
-        // Only update and emit if changed to avoid excessive signals
-        if (posMs != m_currentPosition) {
-            m_currentPosition = posMs;
-            emit positionChanged(m_currentPosition);
-        }
-    } else {
-        // Fallback: emit current cached position
-        emit positionChanged(m_currentPosition);
+    util::IdleMode::recordWakeup();
+    // No controller locks: the output derives the position from its device clock on demand
+    qint64 posMs = getCurrentPositionMs();
+    if (m_currentPosition.exchange(posMs) != posMs) {
+        emit positionChanged(posMs);
     }
+    maybePrepareNextTrack();
 }
 
 void AudioPlayerController::onPlaylistChanged(const QUuid &playlistId)
 {
+    if (playlistId == getCurrentPlaylistId()) {
+        // The next song may have moved or been removed
+        discardPreparedTrack();
+    }
+
     std::scoped_lock locker(m_stateMutex);
     if (playlistId != m_currentPlaylistId) {
         return;
     }
     if (m_currentPlaylist.isEmpty()) {
         m_currentPlaylistId = playlistId;
-        m_currentPlaylist = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistId, [](const playlist::SongInfo&) { return true; });
+        m_currentPlaylist = PLAYLIST_MANAGER->songsSnapshot(playlistId);
         m_currentIndex = m_currentPlaylist.isEmpty() ? -1 : 0;
         return;
     }
 
     auto song = m_currentPlaylist[m_currentIndex];
-    m_currentPlaylist = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistId, [](const playlist::SongInfo&) { return true; });
+    m_currentPlaylist = PLAYLIST_MANAGER->songsSnapshot(playlistId);
     // Try to find the previous song in the updated playlist
     m_currentIndex = -1;
     for (int i = 0; i < m_currentPlaylist.size(); ++i) {
@@ -479,8 +658,8 @@ void AudioPlayerController::registerEventHandlers()
 {
 
     // Helper to wrap handlers with a thread-check (reduces repeated lambda boilerplate)
-    auto makeThreadCheckedHandler = [this](std::function<void(const QVariantHash&)> handler) {
-        return [this, handler](const QVariantHash& data) {
+    auto makeThreadCheckedHandler = [this](std::function<void(const AudioEventProcessor::Event&)> handler) {
+        return AudioEventProcessor::EventHandler([this, handler](const AudioEventProcessor::Event& data) {
             QThread* objThread = this->thread();
             QThread* currentThread = QThread::currentThread();
             if (objThread != currentThread) {
@@ -493,86 +672,122 @@ void AudioPlayerController::registerEventHandlers()
                 QPointer<AudioPlayerController> self(this);
                 if (self) {
                     // Use QMetaObject::invokeMethod overload that accepts a functor (Qt 5.10+/Qt6) to post to the object's thread.
-                    QMetaObject::invokeMethod(self.data(), [handler, data]() mutable {
+                    QMetaObject::invokeMethod(self.data(), [this, handler, data]() mutable {
+                        // A later event may have made this one redundant while it was queued
+                        if (m_eventProcessor->isSuperseded(data)) {
+                            return;
+                        }
                         handler(data);
                     }, Qt::QueuedConnection);
                 }
                 return;
             }
             handler(data);
-        };
+        });
     };
 
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::PLAY,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onPlayEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onPlayEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::PAUSE,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onPauseEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onPauseEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::STOP,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onStopEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onStopEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::PLAYBACK_COMPLETE,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onPlayFinishedEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onPlayFinishedEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::PLAYBACK_ERROR,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onPlayErrorEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onPlayErrorEvent(data); }));
     // Additional event handlers (also marshaled where needed)
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::STREAM_READ_COMPLETED,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onInputStreamReadCompletedEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onInputStreamReadCompletedEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::STREAM_READ_ERROR,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onInputStreamReadErrorEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onInputStreamReadErrorEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::DECODING_FINISHED,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onDecodingFinishedEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onDecodingFinishedEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::DECODING_ERROR,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onDecodingErrorEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onDecodingErrorEvent(data); }));
     // Frame transmission events are marshaled to ensure they run on the desired thread;
     // wrap the marshaled handler in the same thread-checked helper to keep diagnostics consistent.
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::FRAME_TRANSMISSION_COMPLETED,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onFrameTransmissionFinishedEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onFrameTransmissionFinishedEvent(data); }));
     m_eventProcessor->setEventHandler(audio::AudioEventProcessor::FRAME_TRANSMISSION_ERROR,
-        makeThreadCheckedHandler([this](const QVariantHash& data){ onFrameTransmissionErrorEvent(data); }));
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onFrameTransmissionErrorEvent(data); }));
+    m_eventProcessor->setEventHandler(audio::AudioEventProcessor::NEXT_TRACK_STARTED,
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onNextTrackStartedEvent(data); }));
+    m_eventProcessor->setEventHandler(audio::AudioEventProcessor::SEEK,
+        makeThreadCheckedHandler([this](const AudioEventProcessor::Event& data){ onSeekEvent(data); }));
 }
 
-bool AudioPlayerController::isLocalFileAvailable(const playlist::SongInfo& song) const
+bool AudioPlayerController::isLocalFileAvailable(const playlist::SongInfo& song, bool markUsed) const
 {
     if (song.filepath.isEmpty()) {
         return false;
     }
     
+    util::AudioCacheStore* store = AUDIO_CACHE_STORE;
+    const std::string path = song.filepath.toStdString();
+    if (store && store->manages(path)) {
+        return markUsed ? store->open(path) : store->contains(path);
+    }
+    
     QFileInfo fileInfo(song.filepath);
     return fileInfo.exists() && fileInfo.isFile() && fileInfo.isReadable();
 }
 
-void AudioPlayerController::setupRandomGenerator()
+QString AudioPlayerController::waveformPathFor(const playlist::SongInfo& song) const
 {
-    if (m_currentPlaylist.isEmpty()) {
-        return;
+    if (song.uuid.isNull() || !CONFIG_MANAGER) {
+        return QString();
     }
-    
-    // Create shuffled order of indices
-    m_randomPlayOrder.clear();
-    for (int i = 0; i < m_currentPlaylist.size(); ++i) {
-        m_randomPlayOrder.append(i);
+    // A subdirectory, so CoverCache's scan of its own files doesn't see these
+    return QDir(CONFIG_MANAGER->getCoverCacheDirectory()).filePath(
+        QStringLiteral("waveforms/%1%2").arg(song.uuid.toString(QUuid::WithoutBraces),
+                                             QString::fromLatin1(WaveformOverview::FILE_EXTENSION)));
+}
+
+void AudioPlayerController::emitWaveform(const QUuid& songId, const WaveformOverview& overview)
+{
+    emit waveformReady(songId,
+                       QByteArray(reinterpret_cast<const char*>(overview.peaks.data()), static_cast<qsizetype>(overview.peaks.size())),
+                       QByteArray(reinterpret_cast<const char*>(overview.rms.data()), static_cast<qsizetype>(overview.rms.size())));
+}
+
+int AudioPlayerController::shuffledIndex(bool forward) const
+{
+    // Caller holds m_stateMutex
+    if (m_currentIndex < 0 || m_currentIndex >= m_currentPlaylist.size()) {
+        return m_currentPlaylist.isEmpty() ? -1 : 0;
     }
-    
-    // Shuffle using modern C++ random
-    std::shuffle(m_randomPlayOrder.begin(), m_randomPlayOrder.end(), m_randomGenerator);
-    
-    // Set current position in random order
-    m_randomIndex = 0;
-    if (m_currentIndex >= 0) {
-        // Find current song in random order
-        for (int i = 0; i < m_randomPlayOrder.size(); ++i) {
-            if (m_randomPlayOrder[i] == m_currentIndex) {
-                m_randomIndex = i;
-                break;
-            }
+    if (!PLAYLIST_MANAGER) {
+        return -1;
+    }
+    const QUuid currentSongId = m_currentPlaylist[m_currentIndex].uuid;
+    auto songId = forward
+        ? PLAYLIST_MANAGER->getNextSong(currentSongId, m_currentPlaylistId, playlist::PlayMode::Random)
+        : PLAYLIST_MANAGER->getPreviousSong(currentSongId, m_currentPlaylistId, playlist::PlayMode::Random);
+    if (!songId.has_value()) {
+        return -1;
+    }
+    for (int i = 0; i < m_currentPlaylist.size(); ++i) {
+        if (m_currentPlaylist[i].uuid == *songId) {
+            return i;
         }
     }
-    
-    LOG_INFO(" Random play order generated with {} songs", m_randomPlayOrder.size());
+    return -1;
 }
 
 void AudioPlayerController::frameTransmissionLoop()
 {
-    LOG_INFO(" Frame transmission thread started");
+    util::ScopedThreadPriority priority(util::ThreadRole::RealtimeAudio);
+    LOG_INFO(" Frame transmission thread started (MMCSS Pro Audio: {})", priority.mmcss());
+    // Also sets up the trace buffer now rather than on the first span in the loop
+    util::Tracer::setThreadName("Frame transmission");
+
+    // Hold our own reference: cleanPlayResources swaps m_frameQueue while this thread may be draining.
+    std::shared_ptr<AudioFrameQueue> frameQueue;
+    {
+        std::unique_lock<std::mutex> comMutex(m_componentMutex);
+        frameQueue = m_frameQueue;
+    }
     
     while (m_frameTransmissionActive.load()) {
         {
@@ -590,41 +805,41 @@ void AudioPlayerController::frameTransmissionLoop()
             if (!m_frameTransmissionActive.load()) {
                 break;
             }
-            if (m_frameQueue->empty()) {
-                if (m_decoder == nullptr || m_decoder->isCompleted()) // Decoder has been destroyed, exit loop
-                {
-                    LOG_DEBUG(" Decoder is null, exiting transmission loop");
-                    std::unique_lock<std::mutex> comMutex(m_componentMutex);
-                    
-                    if (m_playbackWatcherThread) {
-                        LOG_ERROR(" try start new playbackWatcherThread while existing one present, exiting");
-                        m_eventProcessor->postEvent(AudioEventProcessor::FRAME_TRANSMISSION_ERROR,  QVariantHash{
-                                {"error", "Playback watcher thread already exists"}
-                            });
-                        break;
-                    }
-                    m_playbackWatcherExitFlag.store(false);
-                    m_playbackWatcherThread = std::make_unique<std::thread>([this]() { 
-                        try { this->playbackWatcherFunc(); } 
-                        catch (...) { 
-                            LOG_ERROR(" Exception in playbackWatcherFunc"); 
-                        }
-                    });
-                    m_eventProcessor->postEvent(AudioEventProcessor::FRAME_TRANSMISSION_COMPLETED);
+            m_telemetry->recordQueueDepth(frameQueue->size(), frameQueue->queuedDurationMs());
+            // Blocks until the decoder hands over a frame; fails once the queue is closed and drained.
+            bool popped;
+            {
+                TRACE_SCOPE("audio", "frame queue wait");
+                popped = frameQueue->waitPop(frame);
+            }
+            if (!popped) {
+                if (!m_frameTransmissionActive.load()) {
                     break;
                 }
-                // Wait for new frames to be available
+                LOG_DEBUG(" Frame queue closed and drained, exiting transmission loop");
+                onFrameSourceDrained(frameQueue);
+                break;
             }
-            m_frameQueue->waitAndDequeue(frame);
         }
         
+        if (frame && m_discardUntilDiscontinuity.load()) {
+            if (!frame->discontinuity) {
+                continue;  // Decoded before the seek
+            }
+            m_discardUntilDiscontinuity.store(false);
+        }
+
         // If no frame available, and no frames in audioPlayer buffer, consider playback complete
         if (frame && !frame->data.empty()) {
+            const float gain = frameQueue->trackGain();
+            if (gain != 1.0f) {
+                SampleConverter::applyGain(frame->data.data(), frame->data.size(), frame->bits_per_sample, gain);
+            }
             // Calculate frame size in samples
             int bytesPerSample = frame->bits_per_sample / 8; 
             int samplesInFrame = frame->data.size() / (frame->channels * bytesPerSample);
-            // LOG_DEBUG(" Preparing to transmit audio frame: PTS {}, size {} bytes, samples {}, duration {:.2f} ms", 
-            //           frame->pts, frame->data.size(), samplesInFrame, frame->durationSeconds());
+            LOG_TRACE_RATE_LIMITED(1000, " Preparing to transmit audio frame: PTS {}, size {} bytes, samples {}, duration {:.2f} ms",
+                                   frame->pts, frame->data.size(), samplesInFrame, frame->durationSeconds() * 1000.0);
             
             // Wait for sufficient buffer space before sending
             bool success = false;
@@ -633,9 +848,18 @@ void AudioPlayerController::frameTransmissionLoop()
             
             while (!success && retryCount < maxRetries && m_frameTransmissionActive.load()) {
                 if (!m_audioOutput->isInitialized() || !m_audioOutput->isPlaying()) {
-                    // Audio worker not ready, wait a bit
-                    LOG_DEBUG(" Audio output not ready in frame transmission loop, isInitialized: {}, isPlaying: {}. Retrying...", 
-                              m_audioOutput->isInitialized(), m_audioOutput->isPlaying());
+                    {
+                        // Paused: sleep until resumed or stopped rather than polling the output
+                        std::unique_lock<std::mutex> stateLock(m_stateMutex);
+                        if (m_currentState == PlaybackState::Paused) {
+                            m_transmissionResumed.wait(stateLock, [this]() {
+                                return m_currentState != PlaybackState::Paused || !m_frameTransmissionActive.load();
+                            });
+                            continue;
+                        }
+                    }
+                    // Audio worker not ready yet, wait a bit
+                    util::IdleMode::recordWakeup();
                     std::this_thread::sleep_for(std::chrono::milliseconds(5));
                     retryCount++;
                     continue;
@@ -645,17 +869,24 @@ void AudioPlayerController::frameTransmissionLoop()
                 int availableBytes = m_audioOutput->getAvailableCacheBytes();
                 if (availableBytes >= static_cast<int>(frame->data.size())) {
                     // Buffer has space, send the frame
+                    TRACE_SCOPE("audio", "output write");
                     std::unique_lock<std::mutex> comMutex(m_componentMutex);
-                    m_audioOutput->playAudioData(frame->data.data(), static_cast<int>(frame->data.size()));
+                    // A seek flushed the output while this frame waited for space
+                    if (!m_discardUntilDiscontinuity.load()) {
+                        m_audioOutput->playAudioData(frame->data.data(), static_cast<int>(frame->data.size()),
+                                                     frame->pts_samples);
+                    }
                     success = true;
-                    // LOG_DEBUG("Transmitted audio frame: PTS {}, size {} bytes, samples {}, buffer space {}", 
-                    //           frame->pts, frame->data.size(), samplesInFrame, availableFrames);
+                    LOG_DEBUG_RATE_LIMITED(1000, "Transmitted audio frame: PTS {}, size {} bytes, samples {}, buffer space {}",
+                                           frame->pts, frame->data.size(), samplesInFrame, availableBytes);
                 } else {
                     // Buffer is full, wait for consumption
                     // Wait time based on how long it takes to consume remaining buffer
                     double frameDuratimeSec = static_cast<double>(samplesInFrame) / frame->sample_rate;
                     int waitMs = static_cast<int>(frameDuratimeSec*500);
-                    // LOG_DEBUG(" Audio output buffer full (available frames: {}), waiting {} ms before retrying", availableBytes, waitMs);
+                    LOG_DEBUG_RATE_LIMITED(1000, " Audio output buffer full (available bytes: {}), waiting {} ms before retrying", availableBytes, waitMs);
+                    TRACE_SCOPE("audio", "output buffer full wait");
+                    util::IdleMode::recordWakeup();
                     std::this_thread::sleep_for(std::chrono::milliseconds(waitMs));
                     retryCount++;
                 }
@@ -682,9 +913,36 @@ void AudioPlayerController::frameTransmissionLoop()
     
 }
 
+void AudioPlayerController::onFrameSourceDrained(const std::shared_ptr<AudioFrameQueue>& drainedQueue)
+{
+    // Every decoded frame has reached the device buffer; watch it play out.
+    std::unique_lock<std::mutex> comMutex(m_componentMutex);
+    if (drainedQueue != m_frameQueue) {
+        // Playback was stopped or switched meanwhile; the queue was closed by cleanPlayResources.
+        LOG_DEBUG(" Ignoring drain notification of a stale frame queue");
+        return;
+    }
+    if (m_playbackWatcherJob.valid()) {
+        LOG_ERROR(" try start new playback watcher while existing one present, exiting");
+        m_eventProcessor->postEvent(AudioEventProcessor::FRAME_TRANSMISSION_ERROR, audio::AudioEventProcessor::ErrorInfo{
+            QStringLiteral("Playback watcher already exists")
+        });
+        return;
+    }
+    m_playbackWatcherExitFlag.store(false);
+    m_playbackWatcherJob = audioWorkers().run([this]() {
+        try { this->playbackWatcherFunc(); } 
+        catch (...) { 
+            LOG_ERROR(" Exception in playbackWatcherFunc"); 
+        }
+    });
+    m_eventProcessor->postEvent(AudioEventProcessor::FRAME_TRANSMISSION_COMPLETED);
+}
+
 void AudioPlayerController::playbackWatcherFunc()
 {
-    LOG_DEBUG(" Playback watcher thread started");
+    util::Tracer::setThreadName("Playback watcher");
+    LOG_DEBUG(" Playback watcher started");
     while(m_playbackWatcherExitFlag.load() == false) {
         LOG_DEBUG(" Playback watcher checking audio player state");
         int currentFrames = 0;
@@ -698,6 +956,7 @@ void AudioPlayerController::playbackWatcherFunc()
             currentFrames = m_audioOutput->getCurrentFrames();
         }
         LOG_DEBUG(" Playback watcher found current frames in audio player buffer: {}", currentFrames);   
+        util::IdleMode::recordWakeup();
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         if (currentFrames == 0) {
             LOG_INFO(" Playback watcher detected audio player buffer empty, signaling playback complete");
@@ -705,6 +964,220 @@ void AudioPlayerController::playbackWatcherFunc()
             break;
         }
     }
-    LOG_DEBUG(" Playback watcher thread exiting");
+    LOG_DEBUG(" Playback watcher exiting");
+}
+void AudioPlayerController::prefetchNextStreamUrl(const playlist::SongInfo& current)
+{
+    if (!PLAYLIST_MANAGER || !NETWORK_MANAGER || current.uuid.isNull()) {
+        return;
+    }
+    QUuid playlistId;
+    playlist::PlayMode mode;
+    {
+        std::scoped_lock locker(m_stateMutex);
+        playlistId = m_currentPlaylistId;
+        mode = m_playMode;
+    }
+    // A random pick made now would not be the one made at the track change
+    if (mode == playlist::PlayMode::Random) {
+        NETWORK_MANAGER->schedulePrefetch({});
+        return;
+    }
+    // Upcoming songs in play order, stopping where the order comes back around
+    const int wanted = std::max(1, NETWORK_MANAGER->prefetchTrackCount());
+    std::vector<playlist::SongInfo> upcoming;
+    QUuid songId = current.uuid;
+    for (int i = 0; i < wanted; ++i) {
+        auto nextSongId = PLAYLIST_MANAGER->getNextSong(songId, playlistId, mode);
+        if (!nextSongId.has_value() || *nextSongId == current.uuid) {
+            break;
+        }
+        std::scoped_lock locker(m_stateMutex);
+        auto it = std::find_if(m_currentPlaylist.begin(), m_currentPlaylist.end(),
+                               [&](const playlist::SongInfo& song) { return song.uuid == *nextSongId; });
+        if (it == m_currentPlaylist.end()) {
+            break;
+        }
+        upcoming.push_back(*it);
+        songId = *nextSongId;
+    }
+
+    std::vector<network::NetworkManager::PrefetchTrack> tracks;
+    for (size_t i = 0; i < upcoming.size(); ++i) {
+        const playlist::SongInfo& song = upcoming[i];
+        if (song.args.isEmpty() || isLocalFileAvailable(song)) {
+            continue;
+        }
+        const auto platform = static_cast<network::PlatformType>(song.platform);
+        if (i == 0) {
+            NETWORK_MANAGER->prefetchStreamUrl(platform, song.args);
+        }
+        if (!song.filepath.isEmpty()) {
+            tracks.push_back({ platform, song.args, song.filepath });
+        }
+    }
+    // Also clears the plan when nothing is left to fetch
+    NETWORK_MANAGER->schedulePrefetch(tracks);
+}
+
+void AudioPlayerController::maybePrepareNextTrack()
+{
+    if (!PLAYLIST_MANAGER || m_nextTrackPreparing.load()) {
+        return;
+    }
+
+    playlist::SongInfo currentSong;
+    QUuid playlistId;
+    playlist::PlayMode mode;
+    AudioFormat format;
+    uint64_t generation = 0;
+    {
+        std::scoped_lock locker(m_stateMutex, m_componentMutex);
+        generation = m_playGeneration.load();
+        if (m_currentState != PlaybackState::Playing || !m_audioOutput
+            || m_audioOutput->renderMode() != IAudioOutput::RenderMode::EventDriven
+            || m_preparedTrack || m_prepareAttemptGeneration.load() == generation) {
+            return;
+        }
+        if (m_currentIndex < 0 || m_currentIndex >= m_currentPlaylist.size()) {
+            return;
+        }
+        currentSong = m_currentPlaylist[m_currentIndex];
+        // Without a known duration, start once the current decoder has consumed its whole input
+        qint64 durationMs = static_cast<qint64>(currentSong.duration) * 1000;
+        bool nearEnd = durationMs > 0 ? durationMs - m_currentPosition <= GAPLESS_PREPARE_LEAD_MS + m_crossfadeMs.load()
+                                      : m_decoder == nullptr;
+        if (!nearEnd) {
+            return;
+        }
+        playlistId = m_currentPlaylistId;
+        mode = m_playMode;
+        format = m_outputFormat;
+        m_prepareAttemptGeneration.store(generation);
+    }
+
+    auto nextSongId = PLAYLIST_MANAGER->getNextSong(currentSong.uuid, playlistId, mode);
+    if (!nextSongId.has_value()) {
+        return;
+    }
+    playlist::SongInfo nextSong;
+    int nextIndex = -1;
+    {
+        std::scoped_lock locker(m_stateMutex);
+        for (int i = 0; i < m_currentPlaylist.size(); ++i) {
+            if (m_currentPlaylist[i].uuid == *nextSongId) {
+                nextSong = m_currentPlaylist[i];
+                nextIndex = i;
+                break;
+            }
+        }
+    }
+    if (nextIndex < 0) {
+        return;
+    }
+
+    // The previous preparation finished (m_nextTrackPreparing is false), this returns at once
+    m_nextTrackPrepareJob.wait();
+    LOG_INFO(" Preparing next track for gapless playback: {}", nextSong.title.toStdString());
+    m_nextTrackPreparing.store(true);
+    m_nextTrackPrepareJob = audioWorkers().run([this, nextSong, nextIndex, format, generation]() {
+        util::Tracer::setThreadName("Next track preparation");
+        try {
+            this->nextTrackPrepareFunc(nextSong, nextIndex, format, generation);
+        } catch (const std::exception& e) {
+            LOG_ERROR(" nextTrackPrepareFunc threw exception: {}", e.what());
+        } catch (...) {
+            LOG_ERROR(" nextTrackPrepareFunc threw unknown exception");
+        }
+        m_nextTrackPreparing.store(false);
+    });
+}
+
+void AudioPlayerController::nextTrackPrepareFunc(playlist::SongInfo song, int index, AudioFormat format, uint64_t generation)
+{
+    // Attached to the event processor only once promoted (onNextTrackStartedEvent); until then
+    // the decoder holds its events, which would otherwise be taken for the current track's.
+    auto decoder = std::make_unique<FFmpegStreamDecoder>();
+    auto frameQueue = makeFrameQueue();
+    std::shared_ptr<std::istream> stream;
+    uint64_t expectedSize = 0;
+
+    // Same PCM layout as the running output, so its frames can be spliced in unchanged
+    PlayOperationResult result = openSongDecoder(song, frameQueue, *decoder, format, stream, expectedSize);
+    bool ready = result.kind == PlayOperationResult::Success;
+    frameQueue->setTrackGain(trackGainFor(song));
+    if (ready) {
+        ready = decoder->startDecoding(expectedSize);
+    }
+    if (ready) {
+        AudioFormat fmt = decoder->getAudioFormatAsync().get();
+        ready = fmt.sample_rate == format.sample_rate && fmt.channels == format.channels
+            && fmt.bits_per_sample == format.bits_per_sample;
+    }
+
+    if (!ready) {
+        LOG_WARN(" Failed to prepare next track {}, it will start after a gap: {}",
+                 song.title.toStdString(), result.message.toStdString());
+    } else {
+        std::unique_lock<std::mutex> comMutex(m_componentMutex);
+        if (generation == m_playGeneration.load() && m_audioOutput && !m_preparedTrack) {
+            m_preparedTrack = std::make_unique<PreparedTrack>();
+            m_preparedTrack->song = song;
+            m_preparedTrack->index = index;
+            m_preparedTrack->decoder = std::move(decoder);
+            m_preparedTrack->stream = stream;
+            m_preparedTrack->frameQueue = frameQueue;
+            m_audioOutput->setNextFrameSource(frameQueue,
+                [this, frameQueue]() { this->onFrameSourceDrained(frameQueue); },
+                [this, frameQueue]() { this->onNextTrackSpliced(frameQueue); });
+            LOG_INFO(" Next track ready for gapless playback: {}", song.title.toStdString());
+            return;
+        }
+        LOG_DEBUG(" Discarding prepared next track, playback changed meanwhile");
+    }
+
+    // Failed or stale: tear down outside the lock
+    frameQueue->close();
+    decoder->pauseDecoding();
+    decoder.reset();
+}
+
+void AudioPlayerController::onNextTrackSpliced(const std::shared_ptr<AudioFrameQueue>& nextQueue)
+{
+    {
+        std::unique_lock<std::mutex> comMutex(m_componentMutex);
+        if (!m_preparedTrack || m_preparedTrack->frameQueue != nextQueue) {
+            LOG_DEBUG(" Ignoring splice notification of a discarded track");
+            return;
+        }
+        // From now on drain notifications refer to the new track's queue
+        m_frameQueue = nextQueue;
+    }
+    m_eventProcessor->postEvent(AudioEventProcessor::NEXT_TRACK_STARTED);
+}
+
+void AudioPlayerController::discardPreparedTrack()
+{
+    std::unique_ptr<PreparedTrack> discarded;
+    {
+        std::unique_lock<std::mutex> comMutex(m_componentMutex);
+        // Also invalidates a preparation still in flight
+        m_playGeneration.fetch_add(1);
+        if (!m_preparedTrack) {
+            return;
+        }
+        if (m_audioOutput && !m_audioOutput->clearNextFrameSource()) {
+            // Already spliced into the output; onNextTrackStartedEvent promotes it
+            return;
+        }
+        discarded = std::move(m_preparedTrack);
+    }
+
+    discarded->frameQueue->close();
+    if (discarded->decoder) {
+        discarded->decoder->pauseDecoding();
+    }
+    discarded.reset();
+    LOG_DEBUG(" Discarded prepared next track");
 }
-} // namespace audio
\ No newline at end of file
+} // namespace audio
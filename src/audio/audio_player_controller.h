@@ -8,15 +8,19 @@ class QTimer;
 #include <mutex>
 #include <memory>
 #include <atomic>
-#include <random>
 #include <thread>
 #include <condition_variable>
 #include <playlist/playlist.h>
 #include <util/safe_queue.hpp>
+#include <util/worker_threads.h>
 #include "audio_frame.h"
 #include "audio_event_processor.h"
 #include "ffmpeg_decoder.h"
 #include "wasapi_audio_output.h"
+#include "playback_telemetry.h"
+#include "decoded_pcm_cache.h"
+#include "loudness_analyzer.h"
+#include "spectrum_analyzer.h"
 
 // Forward declarations
 class WASAPIAudioOutputUnsafe;
@@ -47,7 +51,8 @@ struct PlayOperationResult {
     enum Kind {
         Success = 0,
         SongLoadError = 1,
-        PlaybackError = 2
+        PlaybackError = 2,
+        Superseded = 3      // A warm start outdated by a newer request; nothing committed
     } kind = Success;
     QString message;
 };
@@ -77,7 +82,12 @@ public:
     void stop();
     void next();
     void previous();
-    // void seekTo(qint64 positionMs); // TODO: Implement in new decoder API
+    // Seek within the current song; ignored when stopped or the input can't be repositioned
+    void seekTo(qint64 positionMs);
+    // Warm start: open the current song paused on an audio worker (stream URL resolved,
+    // input probed, first seconds decoded, output initialized), so the next play() only
+    // starts the device. Does nothing unless stopped; a newer request wins over it.
+    void prepareCurrentSong();
 
     // Play mode control
     void setPlayMode(playlist::PlayMode mode);
@@ -88,10 +98,27 @@ public:
     bool isPlaying() const;
     bool isPaused() const;
     bool isStopped() const;
+    // Playback position from the output's device clock; lock-free, callable from any thread
+    // (lyrics, visualizers) at any rate
+    qint64 getCurrentPositionMs() const;
 
     // Volume control
     void setVolume(float volume); // 0.0 to 1.0
     float getVolume() const;
+    // Overlap between consecutive tracks in milliseconds, 0 = plain gapless. Event-driven output only.
+    void setCrossfadeDuration(int ms);
+    int getCrossfadeDuration() const;
+    // Apply each analyzed song's loudness gain; takes effect from the next track
+    void setLoudnessNormalization(bool enabled);
+    bool isLoudnessNormalizationEnabled() const;
+
+    // Glitch telemetry accumulated across tracks; lock-free, callable from any thread
+    PlaybackTelemetry::Snapshot getPlaybackTelemetry() const;
+    void resetPlaybackTelemetry();
+    // Periodically log the telemetry counters; 0 disables. Call from the controller's thread.
+    void setTelemetryLogInterval(int seconds);
+    // Spectrum of what is playing, for visualizers: start() it and connect to spectrumUpdated
+    SpectrumAnalyzer* spectrumAnalyzer() const { return m_spectrumAnalyzer; }
 
 signals:
     // Playback state signals
@@ -107,8 +134,13 @@ signals:
     void playbackError(const QString& message);
     void songLoadError(const playlist::SongInfo& song, const QString& message);
 
+    // Seek bar outline of a song, 0..255 per bucket (WaveformOverview); from the cache when
+    // the song is opened, else once its first full decode ends. May arrive from any thread
+    void waveformReady(const QUuid& songId, const QByteArray& peaks, const QByteArray& rms);
+
 private slots:
     void onPositionTimerTimeout();
+    void onTelemetryLogTimerTimeout();
     void onPlaylistChanged(const QUuid& playlistId);
 
 private:
@@ -116,31 +148,63 @@ private:
 
     // File and streaming management
     QString generateStreamingFilepath(const playlist::SongInfo& song) const;
-    bool isLocalFileAvailable(const playlist::SongInfo& song) const;
-    void setupRandomGenerator();
-    PlayOperationResult playCurrentSongUnsafe(const playlist::SongInfo& song, int index);
+    // {cover cache}/waveforms/{uuid}.wave; empty for songs without an identity
+    QString waveformPathFor(const playlist::SongInfo& song) const;
+    void emitWaveform(const QUuid& songId, const WaveformOverview& overview);
+    // Files in the audio cache are checked against its index; markUsed counts as a play
+    // for its eviction order
+    bool isLocalFileAvailable(const playlist::SongInfo& song, bool markUsed = false) const;
+    // Index of the song after (before) the current one in the playlist's shuffle order,
+    // -1 if none. Caller holds m_stateMutex
+    int shuffledIndex(bool forward) const;
+    // startPaused: commit as Paused with the output not started, only if song is still the
+    // current one and nothing else was opened meanwhile (else Superseded); errors aren't posted
+    PlayOperationResult playCurrentSongUnsafe(const playlist::SongInfo& song, int index, qint64 startPositionMs = 0,
+                                              bool startPaused = false);
     PlayOperationResult cleanPlayResources();
+    // Open the song's input (local file or network stream) and initialize `decoder` on it,
+    // decoding to outputFormat (invalid = source layout). A track found in m_pcmCache in that
+    // format is replayed from memory instead; otherwise the decode is recorded into the cache.
+    // Blocks on network requests; never call it while holding controller locks.
+    PlayOperationResult openSongDecoder(const playlist::SongInfo& song,
+                                        const std::shared_ptr<AudioFrameQueue>& frameQueue,
+                                        FFmpegStreamDecoder& decoder,
+                                        const AudioFormat& outputFormat,
+                                        std::shared_ptr<std::istream>& stream,
+                                        uint64_t& expectedSize);
+    // New decoder -> output queue using the configured decode-ahead window
+    std::shared_ptr<AudioFrameQueue> makeFrameQueue() const;
+    // Linear gain for a song's frames: its analyzed loudness gain when normalization is on, else 1
+    float trackGainFor(const playlist::SongInfo& song) const;
+    // Queue local songs that have no loudness result yet for background analysis
+    void queueLoudnessAnalysis(const QList<playlist::SongInfo>& songs);
+    // Analyzer thread: store a result in the playlists and in the current song list
+    void onLoudnessAnalyzed(const std::string& key, double gainDb);
     
 
 private: // Event handlers (serialized execution)
-    void onPlayEvent(const QVariantHash&);
-    void onPauseEvent(const QVariantHash&);
-    void onStopEvent(const QVariantHash&);
-    void onPlayFinishedEvent(const QVariantHash&);
-    void onPlayErrorEvent(const QVariantHash&);
-    void onInputStreamReadCompletedEvent(const QVariantHash&);
-    void onInputStreamReadErrorEvent(const QVariantHash&);
-    void onDecodingFinishedEvent(const QVariantHash&);
-    void onDecodingErrorEvent(const QVariantHash&);
-    void onFrameTransmissionFinishedEvent(const QVariantHash&);
-    void onFrameTransmissionErrorEvent(const QVariantHash&);
+    void onPlayEvent(const AudioEventProcessor::Event&);
+    void onPauseEvent(const AudioEventProcessor::Event&);
+    void onStopEvent(const AudioEventProcessor::Event&);
+    void onPlayFinishedEvent(const AudioEventProcessor::Event&);
+    void onPlayErrorEvent(const AudioEventProcessor::Event&);
+    void onInputStreamReadCompletedEvent(const AudioEventProcessor::Event&);
+    void onInputStreamReadErrorEvent(const AudioEventProcessor::Event&);
+    void onDecodingFinishedEvent(const AudioEventProcessor::Event&);
+    void onDecodingErrorEvent(const AudioEventProcessor::Event&);
+    void onFrameTransmissionFinishedEvent(const AudioEventProcessor::Event&);
+    void onFrameTransmissionErrorEvent(const AudioEventProcessor::Event&);
+    void onNextTrackStartedEvent(const AudioEventProcessor::Event&);
+    void onSeekEvent(const AudioEventProcessor::Event&);
 private:
     // Event system
     std::shared_ptr<audio::AudioEventProcessor> m_eventProcessor;
 
     // Audio components
     mutable std::mutex m_componentMutex;
-    std::shared_ptr<WASAPIAudioOutputUnsafe> m_audioOutput;
+    std::shared_ptr<IAudioOutput> m_audioOutput;
+    // Copy of m_audioOutput for lock-free position queries; accessed with std::atomic_load/store only
+    std::shared_ptr<IAudioOutput> m_positionOutput;
     std::unique_ptr<FFmpegStreamDecoder> m_decoder;
     std::shared_ptr<std::istream> m_currentStream;
 
@@ -148,10 +212,19 @@ private:
     //  if u wanna access the frame queue content, pls use the mutex INSIDE AudioFrameQueue struct.
     std::shared_ptr<AudioFrameQueue> m_frameQueue;
     
-    // Frame transmission thread (consumes frames from decoder and sends to audio output)
-    std::shared_ptr<std::thread> m_frameTransmissionThread;
+    // Frame transmission job on audioWorkers() (consumes frames from decoder and sends to audio output)
+    util::WorkerThreads::Job m_frameTransmissionJob;
     std::atomic<bool> m_frameTransmissionActive;
+    // Wakes a transmission job waiting out a pause; used with m_stateMutex
+    std::condition_variable m_transmissionResumed;
+    // Push mode: drop frames decoded before a seek until the decoder marks a discontinuity
+    std::atomic<bool> m_discardUntilDiscontinuity;
+    std::atomic<int> m_decodeAheadMinMs;
+    std::atomic<int> m_decodeAheadMaxMs;
+    std::atomic<int> m_crossfadeMs;
     void frameTransmissionLoop();
+    // Called once the decoder closed the frame queue and all frames reached the output
+    void onFrameSourceDrained(const std::shared_ptr<AudioFrameQueue>& drainedQueue);
 
     // Playlist data
     // Thread safety: protect controller state with a standard mutex
@@ -162,20 +235,59 @@ private:
     // Playback state
     PlaybackState m_currentState;
     playlist::PlayMode m_playMode;
-    qint64 m_currentPosition;
+    std::atomic<qint64> m_currentPosition;  // Last reported position; live value via getCurrentPositionMs()
     qint64 m_totalDuration;
     float m_volume;
 
     // Position Timer
     QTimer* m_positionTimer;
-    std::shared_ptr<std::thread> m_playbackWatcherThread;
+    // Shared by every decoder and output the controller creates
+    const std::shared_ptr<PlaybackTelemetry> m_telemetry;
+    QTimer* m_telemetryLogTimer;
+    // Fully decoded recent tracks; instant SingleLoop repeats and "previous"
+    const std::shared_ptr<DecodedPcmCache> m_pcmCache;
+    std::atomic<bool> m_loudnessNormalization;
+    // Low-priority measurement of songs without a stored loudness gain
+    std::shared_ptr<LoudnessAnalyzer> m_loudnessAnalyzer;
+    // Render path -> visualizer; every output writes to the same tap
+    const std::shared_ptr<SpectrumTap> m_spectrumTap;
+    SpectrumAnalyzer* m_spectrumAnalyzer;
+    util::WorkerThreads::Job m_playbackWatcherJob;
     void playbackWatcherFunc();
     std::atomic<bool> m_playbackWatcherExitFlag;
 
-    // Random playback
-    std::random_device m_randomDevice;
-    std::mt19937 m_randomGenerator;
-    QList<int> m_randomPlayOrder;
-    int m_randomIndex;
+    // Gapless playback (event-driven output only): shortly before the current track ends the
+    // next one is opened and decoded on an audio worker, then the output's render thread
+    // splices its frame queue in without re-creating the audio client.
+    struct PreparedTrack {
+        playlist::SongInfo song;
+        int index = -1;
+        std::unique_ptr<FFmpegStreamDecoder> decoder;
+        std::shared_ptr<std::istream> stream;
+        std::shared_ptr<AudioFrameQueue> frameQueue;
+    };
+    std::unique_ptr<PreparedTrack> m_preparedTrack;         // Guarded by m_componentMutex
+    util::WorkerThreads::Job m_nextTrackPrepareJob;
+    std::atomic<bool> m_nextTrackPreparing;
+    // Bumped whenever a prepared track would no longer be the right continuation
+    std::atomic<uint64_t> m_playGeneration;
+    std::atomic<uint64_t> m_prepareAttemptGeneration;       // One preparation attempt per generation
+    // prepareCurrentSong() in flight; PLAY waits for it rather than opening the song twice.
+    // Guarded by m_stateMutex: copy it under the lock before waiting
+    util::WorkerThreads::Job m_warmStartJob;
+    // A song is being opened (by PLAY or a warm start) while the state is still Stopped;
+    // the other path doesn't open one meanwhile, so m_frameQueue has one producer. Guarded
+    // by m_stateMutex
+    bool m_songOpening = false;
+    AudioFormat m_outputFormat;                             // PCM format the current output was opened with
+    void maybePrepareNextTrack();
+    void nextTrackPrepareFunc(playlist::SongInfo song, int index, AudioFormat format, uint64_t generation);
+    // Render thread: the output switched to nextQueue
+    void onNextTrackSpliced(const std::shared_ptr<AudioFrameQueue>& nextQueue);
+    void discardPreparedTrack();
+    // Warm the network URL cache for the song expected after `current`, so starting it
+    // (gapless or not) skips the playurl round-trip, and hand the songs after it to the
+    // background prefetcher so they play from disk. Never call it while holding controller locks.
+    void prefetchNextStreamUrl(const playlist::SongInfo& current);
 };
 }
\ No newline at end of file
@@ -4,12 +4,15 @@
 #include <playlist/playlist_manager.h>
 #include <network/network_manager.h>
 #include <log/log_manager.h>
+#include "audio_workers.h"
 #include <QTimer>
+#include <QFileInfo>
 #include <iostream>
 #include <fstream>
+#include <cmath>
 
 namespace audio {
-void AudioPlayerController::onPlayEvent(const QVariantHash&)
+void AudioPlayerController::onPlayEvent(const AudioEventProcessor::Event& event)
 {
     // Handle quick transitions under lock, then perform the heavy work and emission outside.
     PlayOperationResult opResult{PlayOperationResult::Success, QString{}};
@@ -18,6 +21,7 @@ void AudioPlayerController::onPlayEvent(const QVariantHash&)
     playlist::SongInfo songCopy;
     int songIndex = -1;
     bool shouldStartPlayback = false;
+    util::WorkerThreads::Job warmStart;
 
     // Scoped checks: perform only quick checks while holding locks, capture song/index to operate on.
     {
@@ -35,6 +39,7 @@ void AudioPlayerController::onPlayEvent(const QVariantHash&)
                 m_audioOutput->start();
                 m_currentState = PlaybackState::Playing;
                 m_positionTimer->start();
+                m_transmissionResumed.notify_all();
                 LOG_INFO(" Playback resumed");
                 stateCopy = m_currentState;
             } else {
@@ -43,6 +48,12 @@ void AudioPlayerController::onPlayEvent(const QVariantHash&)
             }
             break;
         case PlaybackState::Stopped:
+            if (m_songOpening) {
+                // A warm start is opening the song; it is nearer done than a fresh open, and
+                // once it committed this resumes it
+                warmStart = m_warmStartJob;
+                break;
+            }
             if (m_currentPlaylist.isEmpty()) {
                 LOG_WARN(" Play event received but playlist is empty");
             }
@@ -59,9 +70,9 @@ void AudioPlayerController::onPlayEvent(const QVariantHash&)
                     success = false;
                     LOG_ERROR(" Frame queue is not empty before starting new playback");
                 }
-                if (m_playbackWatcherThread) {
+                if (m_playbackWatcherJob.valid()) {
                     success = false;
-                    LOG_ERROR(" Playback watcher thread is still running before starting new playback");
+                    LOG_ERROR(" Playback watcher is still running before starting new playback");
                 }
                 if (m_audioOutput) {
                     success = false;
@@ -86,16 +97,30 @@ void AudioPlayerController::onPlayEvent(const QVariantHash&)
             songCopy = m_currentPlaylist[m_currentIndex];
             songIndex = m_currentIndex;
             shouldStartPlayback = true;
+            m_songOpening = true;
             break;
         default:
             LOG_ERROR(" Unknown playback state: {}", magic_enum::enum_name(m_currentState));
         }
     }
 
+    if (warmStart.valid()) {
+        warmStart.wait();
+        onPlayEvent(event);
+        return;
+    }
+
     // If we need to start playback, do it now outside the controller locks
     if (shouldStartPlayback) {
-        opResult = playCurrentSongUnsafe(songCopy, songIndex);
+        try {
+            opResult = playCurrentSongUnsafe(songCopy, songIndex);
+        } catch (...) {
+            std::scoped_lock locker(m_stateMutex);
+            m_songOpening = false;
+            throw;
+        }
         std::scoped_lock locker(m_stateMutex);
+        m_songOpening = false;
         stateCopy = m_currentState;
     }
 
@@ -103,18 +128,18 @@ void AudioPlayerController::onPlayEvent(const QVariantHash&)
     if (opResult.kind == PlayOperationResult::SongLoadError) {
         emit songLoadError(songCopy, opResult.message);
         m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                    QVariantHash{{QStringLiteral("error"), QVariant(opResult.message)}});
+                                    audio::AudioEventProcessor::ErrorInfo{opResult.message});
     } else if (opResult.kind == PlayOperationResult::PlaybackError) {
         emit playbackError(opResult.message);
         m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                    QVariantHash{{QStringLiteral("error"), QVariant(opResult.message)}});
+                                    audio::AudioEventProcessor::ErrorInfo{opResult.message});
     }
 
     // Emit state change (if any)
     emit playbackStateChanged(stateCopy);
 }
 
-void AudioPlayerController::onPauseEvent(const QVariantHash&)
+void AudioPlayerController::onPauseEvent(const AudioEventProcessor::Event&)
 {
     PlaybackState stateCopy;
     {
@@ -151,7 +176,7 @@ void AudioPlayerController::onPauseEvent(const QVariantHash&)
     emit playbackStateChanged(stateCopy);
 }
 
-void AudioPlayerController::onStopEvent(const QVariantHash&)
+void AudioPlayerController::onStopEvent(const AudioEventProcessor::Event&)
 {
     // Call cleanup outside locks. cleanPlayResourcesUnsafe will acquire locks internally as needed.
     PlayOperationResult res = cleanPlayResources();
@@ -174,7 +199,7 @@ void AudioPlayerController::onStopEvent(const QVariantHash&)
     }
 }
 
-void AudioPlayerController::onPlayFinishedEvent(const QVariantHash &)
+void AudioPlayerController::onPlayFinishedEvent(const AudioEventProcessor::Event&)
 {
     // Perform cleanup outside locks
     PlayOperationResult res = cleanPlayResources();
@@ -197,33 +222,33 @@ void AudioPlayerController::onPlayFinishedEvent(const QVariantHash &)
     next();
 }
 
-void AudioPlayerController::onPlayErrorEvent(const QVariantHash & args)
+void AudioPlayerController::onPlayErrorEvent(const AudioEventProcessor::Event& event)
 {
     // Handle play error event
     emit playbackError("Play error");
-    QString errMsg = args.value("error").toString();
+    QString errMsg = event.errorMessage();
     LOG_ERROR("Playback error, details: {}", errMsg.toStdString());
     m_eventProcessor->postEvent(audio::AudioEventProcessor::STOP);
 }
 
-void AudioPlayerController::onInputStreamReadCompletedEvent(const QVariantHash&)
+void AudioPlayerController::onInputStreamReadCompletedEvent(const AudioEventProcessor::Event&)
 {
     // Clean up current stream
     std::scoped_lock locker(m_componentMutex);
     m_currentStream.reset();
 }
 
-void AudioPlayerController::onInputStreamReadErrorEvent(const QVariantHash& args)
+void AudioPlayerController::onInputStreamReadErrorEvent(const AudioEventProcessor::Event& event)
 {
     // Handle input stream read error
-    QString errMsg = args.value("error").toString();
+    QString errMsg = event.errorMessage();
     LOG_ERROR("Input stream read error, details: {}", errMsg.toStdString());
     emit playbackError("Input stream read error");
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                QVariantHash{{QString("error"), QVariant(QString("Input stream read error"))}});
+                                audio::AudioEventProcessor::ErrorInfo{QString("Input stream read error")});
 }
 
-void AudioPlayerController::onDecodingFinishedEvent(const QVariantHash&)
+void AudioPlayerController::onDecodingFinishedEvent(const AudioEventProcessor::Event&)
 {
     // Handle decoding finished event
     LOG_INFO(" Decoding finished");
@@ -235,52 +260,215 @@ void AudioPlayerController::onDecodingFinishedEvent(const QVariantHash&)
     }
 }
 
-void AudioPlayerController::onDecodingErrorEvent(const QVariantHash& args)
+void AudioPlayerController::onDecodingErrorEvent(const AudioEventProcessor::Event& event)
 {
     // Handle decoding error
-    QString errMsg = args.value("error").toString();
+    QString errMsg = event.errorMessage();
     LOG_ERROR(" Decoding error, details: {}", errMsg.toStdString());
     emit playbackError("Decoding error");
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                QVariantHash{{QString("error"), QVariant(QString("Decoding error"))}});
+                                audio::AudioEventProcessor::ErrorInfo{QString("Decoding error")});
 }
 
-void AudioPlayerController::onFrameTransmissionFinishedEvent(const QVariantHash&)
+void AudioPlayerController::onFrameTransmissionFinishedEvent(const AudioEventProcessor::Event&)
 {
     LOG_INFO(" Frame transmission finished");
 }
 
-void AudioPlayerController::onFrameTransmissionErrorEvent(const QVariantHash& args)
+void AudioPlayerController::onNextTrackStartedEvent(const AudioEventProcessor::Event&)
+{
+    // The render thread already plays the prepared track; promote its resources.
+    std::unique_ptr<PreparedTrack> promoted;
+    std::unique_ptr<FFmpegStreamDecoder> finishedDecoder;
+    std::shared_ptr<std::istream> finishedStream;
+    playlist::SongInfo songCopy;
+    int indexCopy = -1;
+    {
+        std::scoped_lock locker(m_stateMutex, m_componentMutex);
+        if (!m_preparedTrack || m_preparedTrack->frameQueue != m_frameQueue) {
+            LOG_DEBUG(" Ignoring stale next track notification");
+            return;
+        }
+        promoted = std::move(m_preparedTrack);
+        finishedDecoder = std::move(m_decoder);
+        finishedStream = std::move(m_currentStream);
+        m_decoder = std::move(promoted->decoder);
+        m_currentStream = std::move(promoted->stream);
+        // Its events were held until now; from here on they are the current track's
+        m_decoder->setEventProcessor(m_eventProcessor);
+
+        // The playlist may have been reloaded since preparation; resolve by uuid first
+        m_currentIndex = promoted->index;
+        for (int i = 0; i < m_currentPlaylist.size(); ++i) {
+            if (m_currentPlaylist[i].uuid == promoted->song.uuid) {
+                m_currentIndex = i;
+                break;
+            }
+        }
+        m_currentPosition = 0;
+        m_playGeneration.fetch_add(1);
+        songCopy = promoted->song;
+        indexCopy = m_currentIndex;
+    }
+
+    if (finishedDecoder) {
+        finishedDecoder->pauseDecoding();
+        finishedDecoder.reset();
+    }
+    finishedStream.reset();
+
+    LOG_INFO(" Gapless transition to: {} by {}", songCopy.title.toStdString(), songCopy.uploader.toStdString());
+    emit playbackCompleted();
+    emit currentSongChanged(songCopy, indexCopy);
+    prefetchNextStreamUrl(songCopy);
+}
+
+void AudioPlayerController::onFrameTransmissionErrorEvent(const AudioEventProcessor::Event& event)
 {
     // Handle frame transmission error
-    QString errMsg = args.value("error").toString();
+    QString errMsg = event.errorMessage();
     LOG_ERROR("Frame transmission error, details: {}", errMsg.toStdString());
     emit playbackError("Frame transmission error");
     m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                QVariantHash{{QString("error"), QVariant(QString("Frame transmission error"))}});
+                                audio::AudioEventProcessor::ErrorInfo{QString("Frame transmission error")});
+}
+
+void AudioPlayerController::onSeekEvent(const AudioEventProcessor::Event& event)
+{
+    qint64 positionMs = std::max<qint64>(0, event.seekPositionMs());
+    playlist::SongInfo songCopy;
+    int songIndex = -1;
+    bool wasPaused = false;
+    bool seekInPlace = false;
+    std::shared_ptr<IAudioOutput> eventDrivenOutput;
+    {
+        std::scoped_lock locker(m_stateMutex, m_componentMutex);
+        if (m_currentState == PlaybackState::Stopped
+            || m_currentIndex < 0 || m_currentIndex >= m_currentPlaylist.size()) {
+            LOG_WARN(" Seek event received but playback is stopped");
+            return;
+        }
+        wasPaused = m_currentState == PlaybackState::Paused;
+        songCopy = m_currentPlaylist[m_currentIndex];
+        songIndex = m_currentIndex;
+        seekInPlace = m_decoder && m_audioOutput && m_decoder->isSeekable() && !m_decoder->isCompleted();
+        if (seekInPlace) {
+            if (m_audioOutput->renderMode() == IAudioOutput::RenderMode::EventDriven) {
+                // The render thread takes m_componentMutex, so it is stopped outside the lock below
+                eventDrivenOutput = m_audioOutput;
+            } else {
+                m_discardUntilDiscontinuity.store(true);
+                m_audioOutput->flushForSeek(positionMs);
+            }
+        }
+    }
+
+    if (seekInPlace) {
+        if (eventDrivenOutput) {
+            eventDrivenOutput->flushForSeek(positionMs);
+        }
+        std::scoped_lock locker(m_stateMutex, m_componentMutex);
+        // Handlers are serialized, so m_decoder is still the one checked above; it may have
+        // reached EOF in between though, in which case the pipeline is restarted instead
+        seekInPlace = m_decoder && m_decoder->seek(static_cast<double>(positionMs) / 1000.0);
+        if (seekInPlace) {
+            m_currentPosition = positionMs;
+            LOG_INFO(" Seeked to {} ms", positionMs);
+        }
+    }
+
+    if (!seekInPlace) {
+        // Decoding already finished (or never started): reopen the song at the requested position
+        LOG_INFO(" Restarting playback at {} ms", positionMs);
+        cleanPlayResources();
+        PlayOperationResult res = playCurrentSongUnsafe(songCopy, songIndex, positionMs);
+        if (res.kind != PlayOperationResult::Success) {
+            emit playbackError(res.message);
+            m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
+                                        audio::AudioEventProcessor::ErrorInfo{res.message});
+            return;
+        }
+        if (wasPaused) {
+            onPauseEvent(AudioEventProcessor::Event{AudioEventProcessor::PAUSE, {}});
+        }
+    }
+
+    qint64 posCopy = 0;
+    {
+        std::scoped_lock locker(m_stateMutex);
+        posCopy = m_currentPosition;
+    }
+    emit positionChanged(posCopy);
 }
 
-// Only can be called from onPlayEvent; expects caller to have captured song/index and calls this outside locks.
-PlayOperationResult AudioPlayerController::playCurrentSongUnsafe(const playlist::SongInfo& song, int index)
+PlayOperationResult AudioPlayerController::openSongDecoder(const playlist::SongInfo& song,
+                                                         const std::shared_ptr<AudioFrameQueue>& frameQueue,
+                                                         FFmpegStreamDecoder& decoder,
+                                                         const AudioFormat& outputFormat,
+                                                         std::shared_ptr<std::istream>& stream,
+                                                         uint64_t& expectedSize)
 {
-    LOG_INFO(" Playing song: {} by {}", song.title.toStdString(), song.uploader.toStdString());
+    decoder.setTelemetry(m_telemetry);
+    // Seek bar outline: read back when an earlier decode computed it, else built by this one
+    const QString waveformPath = waveformPathFor(song);
+    if (!waveformPath.isEmpty()) {
+        if (auto overview = WaveformOverview::load(waveformPath.toStdString())) {
+            emitWaveform(song.uuid, *overview);
+        } else {
+            decoder.recordWaveform([this, songId = song.uuid, path = waveformPath.toStdString()](WaveformOverview overview) {
+                if (overview.empty()) {
+                    return;
+                }
+                if (!overview.save(path)) {
+                    LOG_WARN(" Failed to save waveform overview to {}", path);
+                }
+                emitWaveform(songId, overview);
+            });
+        }
+    }
+    const std::string cacheKey = song.uuid.toString().toStdString();
+    // Songs without an identity can't be told apart in the cache
+    const size_t cacheBudget = song.uuid.isNull() ? 0 : m_pcmCache->budgetBytes();
+    if (cacheBudget > 0) {
+        auto cached = m_pcmCache->find(cacheKey);
+        if (cached && (!outputFormat.isValid() || cached->format == outputFormat)
+            && decoder.initializeFromPcm(cached, frameQueue)) {
+            LOG_INFO(" Playing {} from the decoded PCM cache", song.title.toStdString());
+            if (!song.loudnessAnalyzed) {
+                m_loudnessAnalyzer->analyzeTrack(cacheKey, cached);
+            }
+            stream.reset();
+            expectedSize = cached->pcm.size();
+            return PlayOperationResult{PlayOperationResult::Success, QString{}};
+        }
+        // Keep this decode for the next replay; the cache outlives any decoder
+        std::weak_ptr<DecodedPcmCache> cache = m_pcmCache;
+        // The finished decode is measured too, so streamed songs get a loudness result
+        std::weak_ptr<LoudnessAnalyzer> analyzer;
+        if (!song.loudnessAnalyzed) {
+            analyzer = m_loudnessAnalyzer;
+        }
+        decoder.recordDecodedPcm(cacheBudget, [cache, analyzer, cacheKey](std::shared_ptr<const DecodedTrack> track) {
+            if (auto sharedAnalyzer = analyzer.lock()) {
+                sharedAnalyzer->analyzeTrack(cacheKey, track);
+            }
+            if (auto shared = cache.lock()) {
+                shared->insert(cacheKey, std::move(track));
+            }
+        });
+    }
+    if (outputFormat.isValid()) {
+        decoder.setOutputFormat(outputFormat);
+    }
 
     QString filepath = song.filepath;
     bool useStreaming = false;
-    uint64_t expectedSize = 0;
-    if (filepath.isEmpty() || !isLocalFileAvailable(song)) {
+    expectedSize = 0;
+    if (filepath.isEmpty() || !isLocalFileAvailable(song, true)) {
         useStreaming = true;
         LOG_INFO(" Using streaming for song: {}", song.title.toStdString());
     }
 
-    // Create local instances for heavy resources so we don't hold controller locks while initializing them.
-    std::unique_ptr<FFmpegStreamDecoder> newDecoder = std::make_unique<FFmpegStreamDecoder>();
-    if (newDecoder && m_eventProcessor) {
-        newDecoder->setEventProcessor(m_eventProcessor);
-    }
-    std::shared_ptr<std::istream> newStream;
-    std::shared_ptr<WASAPIAudioOutputUnsafe> newAudioOutput;
-
     bool opened = false;
     try {
         if (useStreaming) {
@@ -295,36 +483,128 @@ PlayOperationResult AudioPlayerController::playCurrentSongUnsafe(const playlist:
                 expectedSize = 0;
             }
 
-            newStream = streamFuture.get();
-            if (!newStream) {
+            stream = streamFuture.get();
+            if (!stream) {
                 throw std::runtime_error("Failed to acquire streaming input");
             }
-            opened = newDecoder->initialize(newStream, m_frameQueue);
+            opened = decoder.initialize(stream, frameQueue);
+        } else if (decoder.initializeFromFile(filepath.toStdString(), frameQueue)) {
+            // Memory-mapped: FFmpeg reads the file directly, no input stream involved
+            opened = true;
+            stream.reset();
+            expectedSize = QFileInfo(filepath).size();
         } else {
+            LOG_WARN(" Memory mapping unavailable for {}, reading through a file stream", filepath.toStdString());
             auto fs = std::make_shared<std::ifstream>(filepath.toStdString(), std::ios::binary);
             if (!fs->is_open()) {
                 throw std::runtime_error("Failed to open local file");
             }
             expectedSize = fs->seekg(0, std::ios::end).tellg();
             fs->seekg(0, std::ios::beg);
-            opened = newDecoder->initialize(fs, m_frameQueue);
-            newStream = fs;
+            opened = decoder.initialize(fs, frameQueue);
+            stream = fs;
         }
     } catch (const std::exception& e) {
         QString error = QString("Stream open error: %1").arg(e.what());
-        m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                    QVariantHash{{QStringLiteral("error"), QVariant(error)}});
         return PlayOperationResult{PlayOperationResult::SongLoadError, error};
     }
 
     if (!opened) {
         QString error = QString("Failed to open audio stream for: %1").arg(filepath);
-        m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
-                                    QVariantHash{{QStringLiteral("error"), QVariant(error)}});
         return PlayOperationResult{PlayOperationResult::SongLoadError, error};
     }
+    return PlayOperationResult{PlayOperationResult::Success, QString{}};
+}
+
+std::shared_ptr<AudioFrameQueue> AudioPlayerController::makeFrameQueue() const
+{
+    return std::make_shared<AudioFrameQueue>(AUDIO_FRAME_QUEUE_CAPACITY,
+                                             m_decodeAheadMinMs.load(), m_decodeAheadMaxMs.load());
+}
+
+float AudioPlayerController::trackGainFor(const playlist::SongInfo& song) const
+{
+    if (!m_loudnessNormalization.load() || !song.loudnessAnalyzed) {
+        return 1.0f;
+    }
+    return static_cast<float>(std::pow(10.0, song.loudnessGainDb / 20.0));
+}
+
+void AudioPlayerController::queueLoudnessAnalysis(const QList<playlist::SongInfo>& songs)
+{
+    for (const playlist::SongInfo& song : songs) {
+        if (!song.loudnessAnalyzed && !song.uuid.isNull() && isLocalFileAvailable(song)) {
+            m_loudnessAnalyzer->analyzeFile(song.uuid.toString().toStdString(), song.filepath.toStdString());
+        }
+    }
+}
+
+void AudioPlayerController::onLoudnessAnalyzed(const std::string& key, double gainDb)
+{
+    const QUuid songId = QUuid::fromString(QString::fromStdString(key));
+    const float gain = static_cast<float>(gainDb);
+    {
+        // Songs already in the play order pick the result up at their next start
+        std::scoped_lock locker(m_stateMutex);
+        for (auto& song : m_currentPlaylist) {
+            if (song.uuid == songId) {
+                song.loudnessGainDb = gain;
+                song.loudnessAnalyzed = true;
+            }
+        }
+    }
+    if (PLAYLIST_MANAGER) {
+        PLAYLIST_MANAGER->setSongLoudness(songId, gain);
+    }
+}
+
+// Only can be called from onPlayEvent, or with startPaused from prepareCurrentSong's job; expects caller
+// to have captured song/index and calls this outside locks.
+PlayOperationResult AudioPlayerController::playCurrentSongUnsafe(const playlist::SongInfo& song, int index,
+                                                                  qint64 startPositionMs, bool startPaused)
+{
+    LOG_INFO(" {} song: {} by {}", startPaused ? "Warm starting" : "Playing",
+             song.title.toStdString(), song.uploader.toStdString());
+    // A stop while this runs bumps the generation
+    const uint64_t generation = m_playGeneration.load();
+    std::shared_ptr<AudioFrameQueue> frameQueue;
+    {
+        std::scoped_lock locker(m_componentMutex);
+        frameQueue = m_frameQueue;
+    }
+
+    // Create local instances for heavy resources so we don't hold controller locks while initializing them.
+    std::unique_ptr<FFmpegStreamDecoder> newDecoder = std::make_unique<FFmpegStreamDecoder>();
+    if (newDecoder && m_eventProcessor) {
+        newDecoder->setEventProcessor(m_eventProcessor);
+    }
+    std::shared_ptr<std::istream> newStream;
+    std::shared_ptr<IAudioOutput> newAudioOutput;
+    uint64_t expectedSize = 0;
+
+    // Let libswresample produce the device mix format so the output only copies PCM
+    AudioFormat mixFormat = WASAPIAudioOutputUnsafe::queryMixFormat();
+    if (!mixFormat.isValid()) {
+        LOG_WARN(" Device mix format unavailable, output will convert decoded PCM");
+    }
+    PlayOperationResult openResult = openSongDecoder(song, frameQueue, *newDecoder, mixFormat, newStream, expectedSize);
+    if (openResult.kind != PlayOperationResult::Success) {
+        if (!startPaused) {
+            m_eventProcessor->postEvent(audio::AudioEventProcessor::PLAYBACK_ERROR,
+                                        audio::AudioEventProcessor::ErrorInfo{openResult.message});
+        }
+        return openResult;
+    }
+    frameQueue->setTrackGain(trackGainFor(song));
 
     LOG_DEBUG(" Created new decoder instance for new song");
+    bool startsMidTrack = false;
+    if (startPositionMs > 0) {
+        startsMidTrack = newDecoder->seek(static_cast<double>(startPositionMs) / 1000.0);
+        if (!startsMidTrack) {
+            LOG_WARN(" Input can't be repositioned, starting from the beginning instead of {} ms", startPositionMs);
+        }
+    }
     if (!newDecoder->startDecoding(expectedSize)) {
         QString error = QStringLiteral("Failed to start decoder");
         return PlayOperationResult{PlayOperationResult::PlaybackError, error};
@@ -339,37 +619,86 @@ PlayOperationResult AudioPlayerController::playCurrentSongUnsafe(const playlist:
     LOG_INFO(" Audio format: {} Hz, {} channels, {} bits per sample",
              fmt.sample_rate, fmt.channels, fmt.bits_per_sample);
 
+    // Prefer event-driven rendering (device wakes us once per period); fall back to
+    // the push/poll path if the endpoint refuses AUDCLNT_STREAMFLAGS_EVENTCALLBACK.
     newAudioOutput = std::make_shared<WASAPIAudioOutputUnsafe>();
-    if (!newAudioOutput->initialize(fmt.sample_rate, fmt.channels, fmt.bits_per_sample)) {
-        QString error = QStringLiteral("Failed to initialize WASAPI audio player");
-        return PlayOperationResult{PlayOperationResult::PlaybackError, error};
+    if (!newAudioOutput->initialize(fmt.sample_rate, fmt.channels, fmt.bits_per_sample,
+                                    IAudioOutput::RenderMode::EventDriven)) {
+        LOG_WARN(" Event-driven WASAPI render unavailable, falling back to push mode");
+        newAudioOutput = std::make_shared<WASAPIAudioOutputUnsafe>();
+        if (!newAudioOutput->initialize(fmt.sample_rate, fmt.channels, fmt.bits_per_sample)) {
+            QString error = QStringLiteral("Failed to initialize WASAPI audio player");
+            return PlayOperationResult{PlayOperationResult::PlaybackError, error};
+        }
     }
+    newAudioOutput->setTelemetry(m_telemetry);
+    newAudioOutput->setSpectrumTap(m_spectrumTap);
+    newAudioOutput->setCrossfadeDuration(m_crossfadeMs.load());
 
     // Commit initialized resources into controller state under lock, then start runtime threads.
     {
         std::scoped_lock locker(m_stateMutex, m_componentMutex);
+        if (startPaused) {
+            const bool current = m_currentIndex == index && index < m_currentPlaylist.size()
+                                 && m_currentPlaylist[index].uuid == song.uuid;
+            if (!current || generation != m_playGeneration.load() || m_currentState != PlaybackState::Stopped
+                || m_decoder || m_audioOutput || frameQueue != m_frameQueue) {
+                LOG_INFO(" Warm start of {} superseded, discarding it", song.title.toStdString());
+                // Frees the decoder if it waits on backpressure; PLAY expects an empty queue.
+                // m_songOpening keeps other opens out, but a queue a committed track plays
+                // from is never closed
+                const bool committed = frameQueue == m_frameQueue && (m_decoder || m_audioOutput);
+                if (!committed) {
+                    frameQueue->close();
+                    if (frameQueue == m_frameQueue) {
+                        m_frameQueue = makeFrameQueue();
+                    }
+                }
+                return PlayOperationResult{PlayOperationResult::Superseded, QString{}};
+            }
+        }
         m_decoder = std::move(newDecoder);
         m_currentStream = newStream;
         m_audioOutput = std::move(newAudioOutput);
-        m_currentState = PlaybackState::Playing;
-        m_currentPosition = 0;
-        m_frameTransmissionActive.store(true);
-        m_audioOutput->start();
-        m_positionTimer->start();
-        // Start frame transmission thread now that members are in place
-        m_frameTransmissionThread = std::make_shared<std::thread>([this]() {
-            try {
-                this->frameTransmissionLoop();
-            } catch (const std::exception& e) {
-                LOG_ERROR(" frameTransmissionLoop threw exception: {}", e.what());
-                std::terminate();
-            } catch (...) {
-                LOG_ERROR(" frameTransmissionLoop threw unknown exception");
-                std::terminate();
+        std::atomic_store(&m_positionOutput, m_audioOutput);
+        m_outputFormat = fmt;
+        // Paused: the decoder fills the frame queue up to its high watermark and waits there;
+        // resuming starts the device and the position timer
+        m_currentState = startPaused ? PlaybackState::Paused : PlaybackState::Playing;
+        m_currentPosition = startsMidTrack ? startPositionMs : 0;
+        m_audioOutput->setPositionOffsetMs(m_currentPosition);
+        if (!startPaused) {
+            m_positionTimer->start();
+        }
+        if (m_audioOutput->renderMode() == IAudioOutput::RenderMode::EventDriven) {
+            // The output's render thread consumes m_frameQueue directly, no transmission thread needed.
+            m_audioOutput->setFrameSource(m_frameQueue, [this, queue = m_frameQueue]() {
+                this->onFrameSourceDrained(queue);
+            });
+            if (!startPaused) {
+                m_audioOutput->start();
             }
-        });
+        } else {
+            m_frameTransmissionActive.store(true);
+            if (!startPaused) {
+                m_audioOutput->start();
+            }
+            // Hand frame transmission to an audio worker now that members are in place
+            m_frameTransmissionJob = audioWorkers().run([this]() {
+                try {
+                    this->frameTransmissionLoop();
+                } catch (const std::exception& e) {
+                    LOG_ERROR(" frameTransmissionLoop threw exception: {}", e.what());
+                    std::terminate();
+                } catch (...) {
+                    LOG_ERROR(" frameTransmissionLoop threw unknown exception");
+                    std::terminate();
+                }
+            });
+        }
     }
 
+    prefetchNextStreamUrl(song);
     // Notify success to any monitoring systems via event processor if needed
     return PlayOperationResult{PlayOperationResult::Success, QString{}};
 }
@@ -380,63 +709,89 @@ PlayOperationResult AudioPlayerController::cleanPlayResources()
     LOG_DEBUG(" Stopping current song playback");
 
     // Snapshot and clear controller-owned resources under lock, then perform blocking cleanup outside lock.
-    std::shared_ptr<std::thread> playbackWatcherThreadLocal;
-    std::shared_ptr<std::thread> frameTransmissionThreadLocal;
+    util::WorkerThreads::Job playbackWatcherJobLocal;
+    util::WorkerThreads::Job frameTransmissionJobLocal;
     std::shared_ptr<std::istream> currentStreamLocal;
     std::shared_ptr<AudioFrameQueue> frameQueueLocal;
-    std::shared_ptr<WASAPIAudioOutputUnsafe> audioOutputLocal;
+    std::shared_ptr<IAudioOutput> audioOutputLocal;
     std::unique_ptr<FFmpegStreamDecoder> decoderLocal;
+    std::unique_ptr<PreparedTrack> preparedTrackLocal;
 
     {
         std::scoped_lock locker(m_stateMutex, m_componentMutex);
         m_frameTransmissionActive.store(false);
+        m_discardUntilDiscontinuity.store(false);
         m_playbackWatcherExitFlag.store(true);
+        // Drops both the prepared next track and any preparation still in flight
+        m_playGeneration.fetch_add(1);
+        preparedTrackLocal = std::move(m_preparedTrack);
 
-        playbackWatcherThreadLocal = std::move(m_playbackWatcherThread);
-        frameTransmissionThreadLocal = std::move(m_frameTransmissionThread);
+        playbackWatcherJobLocal = std::move(m_playbackWatcherJob);
+        frameTransmissionJobLocal = std::move(m_frameTransmissionJob);
         currentStreamLocal = std::move(m_currentStream);
         audioOutputLocal = std::move(m_audioOutput);
+        std::atomic_store(&m_positionOutput, std::shared_ptr<IAudioOutput>());
         decoderLocal = std::move(m_decoder);
         frameQueueLocal = m_frameQueue;
 
-        m_frameQueue = std::make_shared<AudioFrameQueue>();
+        m_frameQueue = makeFrameQueue();
         m_currentPosition = 0;
         m_currentState = PlaybackState::Stopped;
     }
-
-    // Perform blocking operations outside the lock
-    if (playbackWatcherThreadLocal && playbackWatcherThreadLocal->joinable()) {
-        playbackWatcherThreadLocal->join();
-        LOG_DEBUG(" Joined playback watcher thread during stop");
+    // A transmission job waiting out a pause returns
+    m_transmissionResumed.notify_all();
+
+    // Perform blocking operations outside the lock; the worker threads themselves stay
+    // alive and pick up the next track's jobs
+    if (playbackWatcherJobLocal.valid()) {
+        playbackWatcherJobLocal.wait();
+        LOG_DEBUG(" Playback watcher finished during stop");
     }
 
     if (frameQueueLocal) {
-        frameQueueLocal->clean();
-        LOG_DEBUG(" Cleared frame queue during stop");
+        // Wakes the transmission thread and a decoder blocked on backpressure.
+        frameQueueLocal->close();
+        LOG_DEBUG(" Closed frame queue during stop");
     }
 
-    if (frameTransmissionThreadLocal && frameTransmissionThreadLocal->joinable()) {
-        frameTransmissionThreadLocal->join();
-        LOG_DEBUG(" Joined frame transmission thread during stop");
-    }
-
-    if (currentStreamLocal) {
-        currentStreamLocal.reset();
-        LOG_DEBUG(" Released current stream reference during stop");
+    if (frameTransmissionJobLocal.valid()) {
+        frameTransmissionJobLocal.wait();
+        LOG_DEBUG(" Frame transmission finished during stop");
     }
 
+    // In event-driven mode the render thread pops the queue itself; stop it before clean()
+    // so the queue never has two consumers
     if (audioOutputLocal) {
         audioOutputLocal->stop();
         audioOutputLocal.reset();
         LOG_DEBUG(" Released audio worker instance during stop");
     }
 
+    if (frameQueueLocal) {
+        frameQueueLocal->clean();
+        LOG_DEBUG(" Cleared frame queue during stop");
+    }
+
+    if (currentStreamLocal) {
+        currentStreamLocal.reset();
+        LOG_DEBUG(" Released current stream reference during stop");
+    }
+
     if (decoderLocal) {
         decoderLocal->pauseDecoding();
         decoderLocal.reset();
         LOG_DEBUG(" Released decoder instance during stop");
     }
 
+    if (preparedTrackLocal) {
+        preparedTrackLocal->frameQueue->close();
+        if (preparedTrackLocal->decoder) {
+            preparedTrackLocal->decoder->pauseDecoding();
+        }
+        preparedTrackLocal.reset();
+        LOG_DEBUG(" Released prepared next track during stop");
+    }
+
     if (m_positionTimer) {
         m_positionTimer->stop();
     }
@@ -444,12 +799,12 @@ PlayOperationResult AudioPlayerController::cleanPlayResources()
     LOG_INFO(" Playback stopped");
     return PlayOperationResult{PlayOperationResult::Success, QString{}};
 }
-// void AudioPlayerController::onSetVolumeEvent(const QVariantHash&){
+// void AudioPlayerController::onSetVolumeEvent(const AudioEventProcessor::Event&){
 // }
 
-// void AudioPlayerController::onSetPlayModeEvent(const QVariantHash&){
+// void AudioPlayerController::onSetPlayModeEvent(const AudioEventProcessor::Event&){
 // }
 
-// void AudioPlayerController::onUpdatePositionEvent(const QVariantHash&){
+// void AudioPlayerController::onUpdatePositionEvent(const AudioEventProcessor::Event&){
 // }
 } // namespace audio
\ No newline at end of file
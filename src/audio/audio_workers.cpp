@@ -0,0 +1,10 @@
+#include "audio_workers.h"
+
+namespace audio
+{
+    util::WorkerThreads& audioWorkers()
+    {
+        static util::WorkerThreads* workers = new util::WorkerThreads();
+        return *workers;
+    }
+} // namespace audio
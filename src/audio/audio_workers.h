@@ -0,0 +1,17 @@
+#pragma once
+
+#include <util/worker_threads.h>
+
+namespace audio
+{
+    /**
+     * @brief Threads shared by the playback pipeline for work that lasts a track: the
+     * decoders' stream reader and decode loops, push-mode frame transmission, the playback
+     * watcher and next track preparation. A track change hands new jobs to the threads the
+     * previous track used instead of starting and joining threads.
+     *
+     * Created on first use and intentionally never destroyed, so jobs still running at
+     * exit can't touch destroyed threads.
+     */
+    util::WorkerThreads& audioWorkers();
+} // namespace audio
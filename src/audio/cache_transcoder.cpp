@@ -0,0 +1,438 @@
+#include "cache_transcoder.h"
+#include <log/log_manager.h>
+#include <util/idle_mode.h>
+#include <util/thread_priority.h>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/audio_fifo.h>
+#include <libavutil/channel_layout.h>
+#include <libswresample/swresample.h>
+}
+
+namespace fs = std::filesystem;
+
+namespace audio {
+
+namespace {
+    constexpr const char* OPUS_ENCODER = "libopus";
+    constexpr int OPUS_SAMPLE_RATE = 48000;
+    constexpr int OPUS_FRAME_SIZE = 960;        // 20 ms, libopus' default
+    // Next to the cache file; not a FILE_EXTENSION, so an index rebuild ignores leftovers
+    constexpr const char* TEMP_SUFFIX = ".opus.tmp";
+
+    using Result = CacheTranscoder::Result;
+
+    // FFmpeg state of one transcode; everything is released in the destructor
+    struct Transcode {
+        AVFormatContext* input = nullptr;
+        AVCodecContext* decoder = nullptr;
+        AVFormatContext* output = nullptr;
+        AVCodecContext* encoder = nullptr;
+        SwrContext* resampler = nullptr;
+        AVAudioFifo* fifo = nullptr;
+        AVPacket* packet = nullptr;
+        AVPacket* encodedPacket = nullptr;
+        AVFrame* decoded = nullptr;
+        AVFrame* encoded = nullptr;
+        uint8_t** converted = nullptr;
+        int convertedCapacity = 0;
+        int streamIndex = -1;
+        int frameSize = OPUS_FRAME_SIZE;
+        int64_t nextPts = 0;
+
+        ~Transcode()
+        {
+            if (converted) {
+                av_freep(&converted[0]);
+                av_freep(&converted);
+            }
+            av_frame_free(&encoded);
+            av_frame_free(&decoded);
+            av_packet_free(&encodedPacket);
+            av_packet_free(&packet);
+            if (fifo) {
+                av_audio_fifo_free(fifo);
+            }
+            swr_free(&resampler);
+            avcodec_free_context(&encoder);
+            avcodec_free_context(&decoder);
+            if (output) {
+                avio_closep(&output->pb);
+                avformat_free_context(output);
+            }
+            avformat_close_input(&input);
+        }
+
+        Result run(const std::string& inputPath, const std::string& outputPath, int bitrateKbps,
+                   const std::atomic<bool>& stop)
+        {
+            if (avformat_open_input(&input, inputPath.c_str(), nullptr, nullptr) < 0
+                || avformat_find_stream_info(input, nullptr) < 0) {
+                LOG_WARN("Can't open {} for transcoding", inputPath);
+                return Result::Failed;
+            }
+            const AVCodec* decoderCodec = nullptr;
+            streamIndex = av_find_best_stream(input, AVMEDIA_TYPE_AUDIO, -1, -1, &decoderCodec, 0);
+            if (streamIndex < 0) {
+                LOG_WARN("No audio stream to transcode in {}", inputPath);
+                return Result::Failed;
+            }
+            if (!worthTranscoding(input->streams[streamIndex]->codecpar, bitrateKbps)) {
+                return Result::Skipped;
+            }
+            if (!openDecoder(decoderCodec) || !openOutput(outputPath, bitrateKbps) || !openBuffers()) {
+                LOG_WARN("Can't set up transcoding of {}", inputPath);
+                return Result::Failed;
+            }
+
+            int ret = 0;
+            while ((ret = av_read_frame(input, packet)) >= 0) {
+                if (stop.load()) {
+                    av_packet_unref(packet);
+                    return Result::Stopped;
+                }
+                const bool ok = packet->stream_index != streamIndex || decode(packet);
+                av_packet_unref(packet);
+                if (!ok) {
+                    LOG_WARN("Transcoding {} failed while decoding", inputPath);
+                    return Result::Failed;
+                }
+            }
+            // A read error short of the end would leave the copy truncated
+            if (ret != AVERROR_EOF || !decode(nullptr) || !resample(nullptr, 0) || !encodeFifo(true)
+                || !encode(nullptr) || av_write_trailer(output) < 0) {
+                LOG_WARN("Transcoding {} failed at the end of the stream", inputPath);
+                return Result::Failed;
+            }
+            return Result::Transcoded;
+        }
+
+    private:
+        bool worthTranscoding(const AVCodecParameters* params, int bitrateKbps) const
+        {
+            if (params->codec_id == AV_CODEC_ID_OPUS) {
+                return false;
+            }
+            // Lossless tiers always shrink; lossy ones only when well above the target
+            const AVCodecDescriptor* descriptor = avcodec_descriptor_get(params->codec_id);
+            if (descriptor && (descriptor->props & AV_CODEC_PROP_LOSSLESS) && !(descriptor->props & AV_CODEC_PROP_LOSSY)) {
+                return true;
+            }
+            const int64_t bitRate = params->bit_rate > 0 ? params->bit_rate : input->bit_rate;
+            if (bitRate <= 0) {
+                return true;    // Unknown; the size check after encoding decides
+            }
+            return static_cast<double>(bitRate) >= bitrateKbps * 1000.0 * CacheTranscoder::MIN_SAVING_RATIO;
+        }
+
+        bool openDecoder(const AVCodec* codec)
+        {
+            decoder = avcodec_alloc_context3(codec);
+            if (!decoder || avcodec_parameters_to_context(decoder, input->streams[streamIndex]->codecpar) < 0
+                || avcodec_open2(decoder, codec, nullptr) < 0) {
+                return false;
+            }
+            if (decoder->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+                // e.g. WAV without a channel mask; the resampler needs a layout
+                const int channels = decoder->ch_layout.nb_channels;
+                av_channel_layout_uninit(&decoder->ch_layout);
+                av_channel_layout_default(&decoder->ch_layout, channels);
+            }
+            return decoder->ch_layout.nb_channels > 0 && decoder->sample_rate > 0;
+        }
+
+        bool openOutput(const std::string& outputPath, int bitrateKbps)
+        {
+            const AVCodec* codec = avcodec_find_encoder_by_name(OPUS_ENCODER);
+            encoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+            if (!encoder || avformat_alloc_output_context2(&output, nullptr, "ogg", outputPath.c_str()) < 0) {
+                return false;
+            }
+            encoder->sample_rate = OPUS_SAMPLE_RATE;
+            encoder->sample_fmt = AV_SAMPLE_FMT_FLT;
+            av_channel_layout_default(&encoder->ch_layout, std::min(decoder->ch_layout.nb_channels, 2));
+            encoder->bit_rate = static_cast<int64_t>(bitrateKbps) * 1000;
+            encoder->time_base = AVRational{1, OPUS_SAMPLE_RATE};
+            if (output->oformat->flags & AVFMT_GLOBALHEADER) {
+                encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+            }
+            if (avcodec_open2(encoder, codec, nullptr) < 0) {
+                return false;
+            }
+            if (encoder->frame_size > 0) {
+                frameSize = encoder->frame_size;
+            }
+
+            AVStream* stream = avformat_new_stream(output, nullptr);
+            if (!stream || avcodec_parameters_from_context(stream->codecpar, encoder) < 0) {
+                return false;
+            }
+            stream->time_base = encoder->time_base;
+            // The Ogg muxer keeps tags but has no attached pictures
+            av_dict_copy(&output->metadata, input->metadata, 0);
+            av_dict_copy(&stream->metadata, input->streams[streamIndex]->metadata, 0);
+            return avio_open(&output->pb, outputPath.c_str(), AVIO_FLAG_WRITE) >= 0
+                   && avformat_write_header(output, nullptr) >= 0;
+        }
+
+        bool openBuffers()
+        {
+            if (swr_alloc_set_opts2(&resampler, &encoder->ch_layout, encoder->sample_fmt, encoder->sample_rate,
+                                    &decoder->ch_layout, decoder->sample_fmt, decoder->sample_rate, 0, nullptr) < 0
+                || swr_init(resampler) < 0) {
+                return false;
+            }
+            fifo = av_audio_fifo_alloc(encoder->sample_fmt, encoder->ch_layout.nb_channels, frameSize);
+            packet = av_packet_alloc();
+            encodedPacket = av_packet_alloc();
+            decoded = av_frame_alloc();
+            encoded = av_frame_alloc();
+            if (!fifo || !packet || !encodedPacket || !decoded || !encoded) {
+                return false;
+            }
+            encoded->nb_samples = frameSize;
+            encoded->format = encoder->sample_fmt;
+            encoded->sample_rate = encoder->sample_rate;
+            return av_channel_layout_copy(&encoded->ch_layout, &encoder->ch_layout) >= 0
+                   && av_frame_get_buffer(encoded, 0) >= 0;
+        }
+
+        // Send packet (nullptr flushes) and feed every frame it yields through to the encoder
+        bool decode(const AVPacket* source)
+        {
+            int ret = avcodec_send_packet(decoder, source);
+            if (ret < 0) {
+                return false;
+            }
+            while ((ret = avcodec_receive_frame(decoder, decoded)) >= 0) {
+                const bool ok = resample(const_cast<const uint8_t**>(decoded->extended_data), decoded->nb_samples)
+                                && encodeFifo(false);
+                av_frame_unref(decoded);
+                if (!ok) {
+                    return false;
+                }
+            }
+            return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+        }
+
+        // Convert samples into the FIFO; nullptr drains the resampler
+        bool resample(const uint8_t** samples, int count)
+        {
+            const int needed = swr_get_out_samples(resampler, count);
+            if (needed <= 0) {
+                return needed == 0;
+            }
+            if (needed > convertedCapacity) {
+                if (converted) {
+                    av_freep(&converted[0]);
+                    av_freep(&converted);
+                }
+                convertedCapacity = 0;
+                if (av_samples_alloc_array_and_samples(&converted, nullptr, encoder->ch_layout.nb_channels,
+                                                       needed, encoder->sample_fmt, 0) < 0) {
+                    return false;
+                }
+                convertedCapacity = needed;
+            }
+            const int got = swr_convert(resampler, converted, needed, samples, count);
+            return got == 0 || (got > 0 && av_audio_fifo_write(fifo, reinterpret_cast<void**>(converted), got) == got);
+        }
+
+        // Encode whole frames from the FIFO; at the end the rest as a shorter last frame
+        bool encodeFifo(bool last)
+        {
+            while (av_audio_fifo_size(fifo) >= frameSize || (last && av_audio_fifo_size(fifo) > 0)) {
+                const int count = std::min(av_audio_fifo_size(fifo), frameSize);
+                if (av_frame_make_writable(encoded) < 0) {
+                    return false;
+                }
+                encoded->nb_samples = count;
+                if (av_audio_fifo_read(fifo, reinterpret_cast<void**>(encoded->data), count) < count) {
+                    return false;
+                }
+                encoded->pts = nextPts;
+                nextPts += count;
+                if (!encode(encoded)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Send frame (nullptr flushes) and write the packets it yields
+        bool encode(const AVFrame* frame)
+        {
+            int ret = avcodec_send_frame(encoder, frame);
+            if (ret < 0) {
+                return false;
+            }
+            while ((ret = avcodec_receive_packet(encoder, encodedPacket)) >= 0) {
+                av_packet_rescale_ts(encodedPacket, encoder->time_base, output->streams[0]->time_base);
+                encodedPacket->stream_index = 0;
+                if (av_interleaved_write_frame(output, encodedPacket) < 0) {
+                    return false;
+                }
+            }
+            return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+        }
+    };
+}
+
+CacheTranscoder::CacheTranscoder(std::shared_ptr<util::AudioCacheStore> store, bool enabled, int bitrateKbps)
+    : store_(std::move(store))
+    , enabled_(enabled)
+    , bitrateKbps_(std::clamp(bitrateKbps, MIN_BITRATE_KBPS, MAX_BITRATE_KBPS))
+{
+    worker_ = std::thread([this]() { workerLoop(); });
+}
+
+CacheTranscoder::~CacheTranscoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true);
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void CacheTranscoder::setEnabled(bool enabled)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled_ = enabled;
+    }
+    wake_.notify_all();
+}
+
+void CacheTranscoder::setBitrateKbps(int kbps)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bitrateKbps_ = std::clamp(kbps, MIN_BITRATE_KBPS, MAX_BITRATE_KBPS);
+}
+
+CacheTranscoder::Stats CacheTranscoder::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool CacheTranscoder::encoderAvailable()
+{
+    return avcodec_find_encoder_by_name(OPUS_ENCODER) != nullptr;
+}
+
+CacheTranscoder::Result CacheTranscoder::compactEntry(util::AudioCacheStore& store,
+    const util::AudioCacheStore::ColdEntry& entry, int bitrateKbps, const std::atomic<bool>& stop)
+{
+    const std::string tempPath = entry.path + TEMP_SUFFIX;
+    const Result result = transcodeFile(entry.path, tempPath, bitrateKbps, stop);
+    if (result == Result::Stopped) {
+        return result;
+    }
+    if (result != Result::Transcoded) {
+        store.markCompacted(entry.path);
+        return result;
+    }
+
+    std::error_code ec;
+    const uint64_t size = fs::file_size(fs::u8path(tempPath), ec);
+    if (ec || size >= entry.size) {
+        fs::remove(fs::u8path(tempPath), ec);
+        store.markCompacted(entry.path);
+        return Result::Skipped;
+    }
+    if (!store.replace(entry, tempPath)) {
+        return Result::Failed;
+    }
+    LOG_INFO("Transcoded cached {} to Opus at {} kbps: {} -> {} bytes", entry.path, bitrateKbps, entry.size, size);
+    return Result::Transcoded;
+}
+
+CacheTranscoder::Result CacheTranscoder::transcodeFile(const std::string& inputPath, const std::string& outputPath,
+                                                       int bitrateKbps, const std::atomic<bool>& stop)
+{
+    Result result;
+    {
+        Transcode transcode;
+        result = transcode.run(inputPath, outputPath, bitrateKbps, stop);
+    }
+    if (result != Result::Transcoded) {
+        std::error_code ec;
+        fs::remove(fs::u8path(outputPath), ec);
+    }
+    return result;
+}
+
+/*************** Private Methods ***************/
+void CacheTranscoder::workerLoop()
+{
+    util::ScopedThreadPriority priority(util::ThreadRole::Background);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Disabled: sleep until enabled; enabled: a pass every PASS_INTERVAL
+        wake_.wait(lock, [this]() { return stopping_.load() || enabled_; });
+        wake_.wait_for(lock, PASS_INTERVAL, [this]() { return stopping_.load() || !enabled_; });
+        if (stopping_.load()) {
+            return;
+        }
+        if (!enabled_) {
+            continue;
+        }
+        const int bitrateKbps = bitrateKbps_;
+        lock.unlock();
+        util::IdleMode::recordWakeup();
+        runPass(bitrateKbps);
+        lock.lock();
+    }
+}
+
+void CacheTranscoder::runPass(int bitrateKbps)
+{
+    if (!encoderAvailable()) {
+        if (!warnedUnavailable_) {
+            LOG_WARN("Audio cache transcoding is on, but FFmpeg has no {} encoder", OPUS_ENCODER);
+            warnedUnavailable_ = true;
+        }
+        return;
+    }
+
+    Stats pass;
+    for (const auto& entry : store_->coldEntries(COLD_AFTER, FILES_PER_PASS)) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_.load() || !enabled_) {
+                break;
+            }
+        }
+        const Result result = compactEntry(*store_, entry, bitrateKbps, stopping_);
+        if (result == Result::Transcoded) {
+            std::error_code ec;
+            const uint64_t size = fs::file_size(fs::u8path(entry.path), ec);
+            ++pass.transcoded;
+            pass.bytesSaved += ec || size >= entry.size ? 0 : entry.size - size;
+        } else if (result == Result::Skipped || result == Result::Failed) {
+            ++pass.kept;
+        }
+    }
+    if (pass.transcoded == 0 && pass.kept == 0) {
+        return;
+    }
+    // Marks are written like touches; don't redo them after a crash
+    store_->flush();
+    LOG_INFO("Audio cache transcoding pass: {} transcoded, {} kept as they are, {} bytes saved",
+             pass.transcoded, pass.kept, pass.bytesSaved);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.transcoded += pass.transcoded;
+    stats_.kept += pass.kept;
+    stats_.bytesSaved += pass.bytesSaved;
+}
+
+}
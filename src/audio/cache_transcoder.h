@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <util/audio_cache_store.h>
+
+namespace audio {
+
+/**
+ * @brief Background compaction of the audio cache: files not played for a while are
+ * transcoded to Opus, so the same disk budget holds several times more songs.
+ *
+ * While enabled, a worker thread at ThreadRole::Background wakes every PASS_INTERVAL and
+ * takes up to FILES_PER_PASS files not opened within COLD_AFTER, least recently played
+ * first (AudioCacheStore::coldEntries). Each is decoded and encoded to Ogg/Opus (libopus)
+ * into a sibling temporary file, which AudioCacheStore::replace() swaps in under the
+ * index lock. The result keeps its `.audio` name; FFmpegStreamDecoder probes the
+ * container, so it plays like any other cached file.
+ *
+ * Files already in Opus, or lossy ones under MIN_SAVING_RATIO times the target bitrate
+ * (a second lossy generation for little space), are marked compacted and kept as they
+ * are; so are files that fail to decode and results that come out no smaller. Disabling
+ * lets the file in progress finish; destruction stops it.
+ */
+class CacheTranscoder {
+public:
+    static constexpr int DEFAULT_BITRATE_KBPS = 96;
+    static constexpr int MIN_BITRATE_KBPS = 32;
+    static constexpr int MAX_BITRATE_KBPS = 256;
+    static constexpr std::chrono::hours COLD_AFTER{24 * 7};
+    static constexpr std::chrono::minutes PASS_INTERVAL{10};
+    static constexpr size_t FILES_PER_PASS = 8;
+    static constexpr double MIN_SAVING_RATIO = 1.25;
+
+    enum class Result {
+        Transcoded,     // Output written (compactEntry: and swapped in)
+        Skipped,        // Not worth transcoding; nothing written
+        Failed,         // Can't decode or encode (compactEntry: or can't swap in yet)
+        Stopped,        // `stop` was set; nothing written
+    };
+
+    struct Stats {
+        uint64_t transcoded = 0;
+        uint64_t kept = 0;          // Marked compacted as they are, failures included
+        uint64_t bytesSaved = 0;
+    };
+
+    CacheTranscoder(std::shared_ptr<util::AudioCacheStore> store, bool enabled,
+                    int bitrateKbps = DEFAULT_BITRATE_KBPS);
+    ~CacheTranscoder();
+
+    CacheTranscoder(const CacheTranscoder&) = delete;
+    CacheTranscoder& operator=(const CacheTranscoder&) = delete;
+
+    void setEnabled(bool enabled);
+    // Clamped to MIN_BITRATE_KBPS..MAX_BITRATE_KBPS; applies from the next pass
+    void setBitrateKbps(int kbps);
+    Stats stats() const;
+
+    // Whether FFmpeg has the libopus encoder; without it passes do nothing
+    static bool encoderAvailable();
+
+    /**
+     * @brief Transcode one cache entry in place, as the worker does.
+     *
+     * transcodeFile() into a sibling temporary file, then replace() the entry with it, or
+     * markCompacted() the entry when the file is kept as it is. An entry that changed or
+     * is in use meanwhile is left for a later pass.
+     */
+    static Result compactEntry(util::AudioCacheStore& store, const util::AudioCacheStore::ColdEntry& entry,
+                               int bitrateKbps, const std::atomic<bool>& stop);
+
+    // Decode inputPath and write it to outputPath as Ogg/Opus at 48 kHz, mono or stereo.
+    // Tags are copied, embedded pictures aren't. outputPath is removed unless Transcoded
+    static Result transcodeFile(const std::string& inputPath, const std::string& outputPath,
+                                int bitrateKbps, const std::atomic<bool>& stop);
+
+private:
+    void workerLoop();
+    void runPass(int bitrateKbps);
+
+    std::shared_ptr<util::AudioCacheStore> store_;
+    mutable std::mutex mutex_;          // Guards the settings and stats_
+    std::condition_variable wake_;
+    bool enabled_;
+    int bitrateKbps_;
+    Stats stats_;
+    bool warnedUnavailable_ = false;    // Worker only
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+};
+
+}
@@ -0,0 +1,158 @@
+#include "crossfade_mixer.h"
+#include "sample_convert.h"
+#include <algorithm>
+
+namespace audio {
+
+void CrossfadeMixer::configure(int sampleRate, int channels, int bitsPerSample)
+{
+    sample_rate_ = sampleRate;
+    channels_ = channels;
+    bits_per_sample_ = bitsPerSample;
+    if (bits_per_sample_ == 16) {
+        from_scratch_.assign(SCRATCH_SAMPLES, 0.0f);
+        to_scratch_.assign(SCRATCH_SAMPLES, 0.0f);
+    } else {
+        std::vector<float>().swap(from_scratch_);
+        std::vector<float>().swap(to_scratch_);
+    }
+    reset();
+}
+
+void CrossfadeMixer::setDurationMs(int ms)
+{
+    duration_ms_.store(std::max(0, ms), std::memory_order_relaxed);
+}
+
+bool CrossfadeMixer::process(AudioFrame& frame, const AudioFrameQueue& outgoing, AudioFrameQueue* incoming)
+{
+    if (!incoming) {
+        reset();
+        return false;
+    }
+    // Only same-layout float or 16-bit PCM can be mixed sample by sample
+    if (sample_rate_ <= 0 || (bits_per_sample_ != 32 && bits_per_sample_ != 16)
+        || frame.channels != channels_ || frame.bits_per_sample != bits_per_sample_) {
+        return false;
+    }
+    const size_t bytesPerSample = static_cast<size_t>(bits_per_sample_ / 8);
+    const size_t bytesPerFrame = bytesPerSample * channels_;
+    const uint64_t frameFrames = frame.data.size() / bytesPerFrame;
+
+    if (!active_) {
+        const int durationMs = duration_ms_.load(std::memory_order_relaxed);
+        if (durationMs <= 0 || !outgoing.closed()) {
+            return false;
+        }
+        const uint64_t remaining = static_cast<uint64_t>(outgoing.queuedDurationMs()) * sample_rate_ / 1000
+                                   + frameFrames;
+        if (remaining > static_cast<uint64_t>(durationMs) * sample_rate_ / 1000) {
+            return false;
+        }
+        active_ = true;
+        fade_frames_ = std::max<uint64_t>(remaining, 1);
+        fade_pos_ = 0;
+    }
+
+    size_t done = 0;  // Sample-frames of `frame` mixed so far
+    while (done < frameFrames) {
+        if (carry_ && carry_offset_ >= carry_->data.size()) {
+            carry_.reset();
+            carry_offset_ = 0;
+        }
+        if (!carry_ && incoming->tryPop(carry_)) {
+            carry_offset_ = 0;
+            // The render loop never sees frames consumed here; apply the incoming track's gain
+            const float gain = incoming->trackGain();
+            if (gain != 1.0f) {
+                SampleConverter::applyGain(carry_->data.data(), carry_->data.size(), carry_->bits_per_sample, gain);
+            }
+        }
+        // A frame in another layout can't be mixed; it is kept for after the switch
+        const bool mixable = carry_ && carry_->channels == channels_ && carry_->bits_per_sample == bits_per_sample_;
+        size_t frames = frameFrames - done;
+        const uint8_t* src = nullptr;
+        if (mixable) {
+            frames = std::min(frames, (carry_->data.size() - carry_offset_) / bytesPerFrame);
+            src = carry_->data.data() + carry_offset_;
+        }
+        if (frames == 0) {
+            carry_offset_ = carry_->data.size();  // Trailing partial sample-frame
+            continue;
+        }
+        mixBlock(frame.data.data() + done * bytesPerFrame, src, frames * channels_);
+        if (mixable) {
+            carry_offset_ += frames * bytesPerFrame;
+        }
+        done += frames;
+        fade_pos_ += frames;
+        if (!mixable) {
+            break;  // Rest of this frame faded out against silence
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<AudioFrame> CrossfadeMixer::takeCarryOver(size_t& offset)
+{
+    std::shared_ptr<AudioFrame> carry;
+    offset = 0;
+    if (active_ && carry_ && carry_offset_ < carry_->data.size()) {
+        carry = std::move(carry_);
+        offset = carry_offset_;
+    }
+    reset();
+    return carry;
+}
+
+void CrossfadeMixer::reset()
+{
+    active_ = false;
+    fade_frames_ = 0;
+    fade_pos_ = 0;
+    carry_.reset();
+    carry_offset_ = 0;
+}
+
+/*************** Private Methods ***************/
+void CrossfadeMixer::mixBlock(uint8_t* dst, const uint8_t* src, size_t samples)
+{
+    // The queued duration is only known to the millisecond, so the outgoing source may run
+    // slightly past the ramp; anything after it is held at full fade
+    const size_t rampSamples = fade_pos_ < fade_frames_
+        ? static_cast<size_t>(std::min<uint64_t>(samples, (fade_frames_ - fade_pos_) * channels_)) : 0;
+    // Ramp in samples: the channels of one sample-frame differ by less than one frame's step
+    const float step = 1.0f / static_cast<float>(fade_frames_ * channels_);
+    const float gain = static_cast<float>(fade_pos_) / static_cast<float>(fade_frames_);
+    const size_t bytesPerSample = static_cast<size_t>(bits_per_sample_ / 8);
+    mixRamp(dst, src, rampSamples, gain, step);
+    mixRamp(dst + rampSamples * bytesPerSample, src ? src + rampSamples * bytesPerSample : nullptr,
+            samples - rampSamples, 1.0f, 0.0f);
+}
+
+void CrossfadeMixer::mixRamp(uint8_t* dst, const uint8_t* src, size_t samples, float gain, float step)
+{
+    if (samples == 0) return;
+    if (bits_per_sample_ == 32) {
+        float* out = reinterpret_cast<float*>(dst);
+        const float* to = reinterpret_cast<const float*>(src);
+        SampleConverter::crossfadeF32(out, to, out, samples, gain, step);
+        return;
+    }
+    int16_t* out = reinterpret_cast<int16_t*>(dst);
+    const int16_t* to = reinterpret_cast<const int16_t*>(src);
+    for (size_t done = 0; done < samples; ) {
+        size_t n = std::min(SCRATCH_SAMPLES, samples - done);
+        SampleConverter::s16ToF32(out + done, from_scratch_.data(), n);
+        if (to) {
+            SampleConverter::s16ToF32(to + done, to_scratch_.data(), n);
+        }
+        SampleConverter::crossfadeF32(from_scratch_.data(), to ? to_scratch_.data() : nullptr,
+                                      from_scratch_.data(), n, gain, step);
+        SampleConverter::f32ToS16(from_scratch_.data(), out + done, n);
+        done += n;
+        gain += static_cast<float>(n) * step;
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "audio_frame.h"
+
+namespace audio {
+
+/**
+ * @brief Crossfade stage between the outgoing and incoming frame sources of a gapless switch.
+ *
+ * Runs on the output's render thread: every frame popped from the outgoing source goes
+ * through process(). Once that source is closed and no more than the crossfade length is
+ * left in it, the head of the incoming source is mixed into the outgoing frames in place,
+ * with complementary linear gain ramps (SampleConverter::crossfadeF32). When the outgoing
+ * source has drained the output switches to the incoming one and resumes with
+ * takeCarryOver(), the part of the last incoming frame that was not mixed yet.
+ *
+ * Both sources must carry the format given to configure(). Nothing is allocated after
+ * configure(): float frames are mixed directly and 16-bit frames go through fixed
+ * scratch buffers. Apart from setDurationMs()/durationMs(), methods are called by the
+ * thread that renders (or while it is stopped).
+ */
+class CrossfadeMixer {
+public:
+    // Samples converted per step when mixing 16-bit PCM
+    static constexpr size_t SCRATCH_SAMPLES = 4096;
+
+    // Allocates the scratch buffers; call from initialize(), never from the render thread
+    void configure(int sampleRate, int channels, int bitsPerSample);
+    // 0 disables crossfading; takes effect at the next transition. Thread-safe.
+    void setDurationMs(int ms);
+    int durationMs() const { return duration_ms_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Fade `incoming` into `frame`, a frame just popped from `outgoing`.
+     * Starts a transition when `outgoing` is closed and its remaining audio (queued plus
+     * this frame) fits in the crossfade length; the ramp spans exactly that remainder.
+     * Incoming frames that aren't decoded yet count as silence. A null `incoming` (no
+     * next track, or it was cleared) cancels a running transition.
+     * @return true if the frame was modified
+     */
+    bool process(AudioFrame& frame, const AudioFrameQueue& outgoing, AudioFrameQueue* incoming);
+    bool active() const { return active_; }
+
+    // On the switch to the incoming source: its frame the fade stopped in (nullptr if none)
+    // and the bytes of it already mixed. Ends the transition.
+    std::shared_ptr<AudioFrame> takeCarryOver(size_t& offset);
+    // Drop any transition state (seek, stop, new frame source)
+    void reset();
+
+private:
+    // Mix `samples` samples of incoming PCM (or silence) into dst at the current ramp position
+    void mixBlock(uint8_t* dst, const uint8_t* src, size_t samples);
+    void mixRamp(uint8_t* dst, const uint8_t* src, size_t samples, float gain, float step);
+
+    std::atomic<int> duration_ms_{0};
+    int sample_rate_ = 0;
+    int channels_ = 0;
+    int bits_per_sample_ = 0;
+
+    bool active_ = false;
+    uint64_t fade_frames_ = 0;       // Length of the running ramp in sample-frames
+    uint64_t fade_pos_ = 0;          // Sample-frames of the ramp already mixed
+    std::shared_ptr<AudioFrame> carry_;
+    size_t carry_offset_ = 0;
+    std::vector<float> from_scratch_;
+    std::vector<float> to_scratch_;
+};
+
+} // namespace audio
@@ -0,0 +1,116 @@
+#include "decoded_pcm_cache.h"
+
+namespace audio {
+
+DecodedPcmCache::DecodedPcmCache(size_t budgetBytes)
+    : budget_(budgetBytes)
+{
+}
+
+std::shared_ptr<const DecodedTrack> DecodedPcmCache::find(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->second;
+}
+
+bool DecodedPcmCache::insert(const std::string& key, std::shared_ptr<const DecodedTrack> track)
+{
+    if (!track) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            eraseEntry_unsafe(it->second);
+        }
+        const size_t bytes = track->pcm.size();
+        if (bytes == 0 || bytes > budget_) {
+            return false;
+        }
+        lru_.emplace_front(key, std::move(track));
+        index_[key] = lru_.begin();
+        used_ += bytes;
+        evict_unsafe();
+    }
+    // Unlocked: the shared budget reads usedBytes() and may call trim()
+    budgetRegistration_.grew();
+    return true;
+}
+
+void DecodedPcmCache::erase(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        eraseEntry_unsafe(it->second);
+    }
+}
+
+void DecodedPcmCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    used_ = 0;
+}
+
+size_t DecodedPcmCache::trim(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t before = used_;
+    while (before - used_ < bytes && !lru_.empty()) {
+        eraseEntry_unsafe(std::prev(lru_.end()));
+    }
+    return before - used_;
+}
+
+void DecodedPcmCache::attachBudget(util::MemoryBudget& budget)
+{
+    budgetRegistration_ = budget.add("decoded PCM", util::MemoryBudget::Priority::Normal,
+                                     [this]() { return usedBytes(); },
+                                     [this](size_t bytes) { return trim(bytes); });
+}
+
+void DecodedPcmCache::setBudgetBytes(size_t budgetBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budgetBytes;
+    evict_unsafe();
+}
+
+size_t DecodedPcmCache::budgetBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+size_t DecodedPcmCache::usedBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+}
+
+size_t DecodedPcmCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+/*************** Private Methods ***************/
+void DecodedPcmCache::eraseEntry_unsafe(std::list<Entry>::iterator it)
+{
+    used_ -= it->second->pcm.size();
+    index_.erase(it->first);
+    lru_.erase(it);
+}
+
+void DecodedPcmCache::evict_unsafe()
+{
+    while (used_ > budget_ && !lru_.empty()) {
+        eraseEntry_unsafe(std::prev(lru_.end()));
+    }
+}
+
+} // namespace audio
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <util/memory_budget.h>
+#include "audio_frame.h"
+
+namespace audio {
+
+// A whole track decoded to PCM, as the decoder delivered it to the output
+struct DecodedTrack {
+    AudioFormat format{0, 0, 0};
+    std::vector<uint8_t> pcm;   // Interleaved samples in `format`, from the start of the track
+
+    size_t bytesPerFrame() const {
+        return format.isValid() ? static_cast<size_t>(format.channels) * (format.bits_per_sample / 8) : 0;
+    }
+    uint64_t frames() const {
+        size_t bpf = bytesPerFrame();
+        return bpf ? pcm.size() / bpf : 0;
+    }
+    double durationSeconds() const {
+        return format.sample_rate > 0 ? static_cast<double>(frames()) / format.sample_rate : 0.0;
+    }
+};
+
+/**
+ * @brief Memory-budgeted LRU cache of fully decoded tracks, keyed by song UUID.
+ *
+ * Replaying a cached track (SingleLoop, "previous") skips the network and the decoder
+ * entirely. Tracks stay alive while a reader holds the returned shared_ptr, so eviction
+ * never pulls PCM out from under a running replay; the budget only counts tracks the
+ * cache itself still owns. All methods are thread-safe.
+ */
+class DecodedPcmCache {
+public:
+    static constexpr size_t DEFAULT_BUDGET_BYTES = 256ull * 1024 * 1024;
+
+    explicit DecodedPcmCache(size_t budgetBytes = DEFAULT_BUDGET_BYTES);
+
+    DecodedPcmCache(const DecodedPcmCache&) = delete;
+    DecodedPcmCache& operator=(const DecodedPcmCache&) = delete;
+
+    // Cached track for key, marked most recently used; nullptr if absent
+    std::shared_ptr<const DecodedTrack> find(const std::string& key);
+    /**
+     * @brief Store a track, replacing any previous entry for key and evicting the least
+     * recently used tracks until the cache fits its budget.
+     * @return false if the track alone exceeds the budget (it is not stored)
+     */
+    bool insert(const std::string& key, std::shared_ptr<const DecodedTrack> track);
+    void erase(const std::string& key);
+    void clear();
+
+    // Evict least recently used tracks until at least `bytes` are freed; returns bytes freed
+    size_t trim(size_t bytes);
+    // Count against the shared memory cap, which may evict tracks (Normal priority)
+    void attachBudget(util::MemoryBudget& budget);
+
+    // Shrinking the budget evicts immediately; 0 disables the cache
+    void setBudgetBytes(size_t budgetBytes);
+    size_t budgetBytes() const;
+    size_t usedBytes() const;
+    size_t size() const;
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const DecodedTrack>>;
+
+    void eraseEntry_unsafe(std::list<Entry>::iterator it);
+    void evict_unsafe();
+
+    mutable std::mutex mutex_;
+    size_t budget_;
+    size_t used_ = 0;
+    std::list<Entry> lru_;          // Front is the most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    util::MemoryBudget::Registration budgetRegistration_;   // Last: unregistered before the rest goes
+};
+
+} // namespace audio
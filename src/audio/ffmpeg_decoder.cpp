@@ -1,12 +1,25 @@
 #include "ffmpeg_decoder.h"
 #include "ffmpeg_log.h"
+#include "audio_workers.h"
+#include <algorithm>
+#include <cstring>
 
 #include <log/log_manager.h>
+#include <util/thread_priority.h>
+#include <util/trace.h>
 #include "audio_event_processor.h"
-#include <QVariantHash>
 #include <QString>
 
 namespace audio {
+namespace {
+    // An event for FFmpegStreamDecoder::postEvent
+    std::function<void(AudioEventProcessor&)> makeEvent(AudioEventProcessor::PlayerEventType type,
+                                                        AudioEventProcessor::Payload payload = {})
+    {
+        return [type, payload = std::move(payload)](AudioEventProcessor& proc) { proc.postEvent(type, payload); };
+    }
+}
+
 FFmpegStreamDecoder::FFmpegStreamDecoder(QObject* parent)
     : QObject(parent)
         , format_ctx_(nullptr)
@@ -31,7 +44,28 @@ FFmpegStreamDecoder::FFmpegStreamDecoder(QObject* parent)
 
 void FFmpegStreamDecoder::setEventProcessor(std::shared_ptr<AudioEventProcessor> processor)
 {
-    m_eventProcessor = processor;
+    std::vector<std::function<void(AudioEventProcessor&)>> held;
+    {
+        std::lock_guard<std::mutex> lock(eventProcessorMutex_);
+        m_eventProcessor = processor;
+        eventProcessorAttached_ = true;
+        held.swap(heldEvents_);
+    }
+    for (auto& post : held) {
+        if (processor) {
+            post(*processor);
+        }
+    }
+}
+
+void FFmpegStreamDecoder::setTelemetry(std::shared_ptr<PlaybackTelemetry> telemetry)
+{
+    telemetry_ = std::move(telemetry);
+}
+
+void FFmpegStreamDecoder::setThreadRole(util::ThreadRole role)
+{
+    threadRole_ = role;
 }
 
 FFmpegStreamDecoder::~FFmpegStreamDecoder()
@@ -43,16 +77,15 @@ FFmpegStreamDecoder::~FFmpegStreamDecoder()
     decodeCondition.notify_all();
     decodeStateCondition.notify_all();
     audioFormatCondition_.notify_all();
+    // Release a decode thread blocked on queue backpressure; nothing is produced after this point.
+    if (auto sharedQueue = outputFrameQueue.lock()) {
+        sharedQueue->close();
+    }
     outputFrameQueue.reset();
     
-    if (consumeAudioStreamThread.joinable())
-    {
-        consumeAudioStreamThread.join();
-    }
-    if (decodeAudioBytesThread.joinable())
-    {
-        decodeAudioBytesThread.join();
-    }
+    // The worker threads stay alive for the next decoder
+    consumeAudioStreamJob.wait();
+    decodeAudioBytesJob.wait();
 
     // Clean up FFmpeg resources
     if (swr_ctx_) {
@@ -97,6 +130,10 @@ bool FFmpegStreamDecoder::initialize(std::shared_ptr<std::istream> inputAudioStr
 
         this->inputAudioStream = inputAudioStream;
         this->outputFrameQueue = outputFrameQueue;
+        // tellg only succeeds on streams that can be repositioned (files, cached network streams)
+        std::streampos start = inputAudioStream ? inputAudioStream->tellg() : std::streampos(-1);
+        this->inputSeekable_ = start != std::streampos(-1);
+        this->cacheStreamOffset_ = this->inputSeekable_ ? static_cast<uint64_t>(start) : 0;
     }
     
 
@@ -113,6 +150,89 @@ bool FFmpegStreamDecoder::initialize(std::shared_ptr<std::istream> inputAudioStr
 
     return true;
 }
+
+bool FFmpegStreamDecoder::initializeFromFile(const std::string& filepath,
+    std::weak_ptr<AudioFrameQueue> outputFrameQueue)
+{
+    {
+        std::scoped_lock lock(audioCacheMutex);
+        if (this->hasInit)
+        {
+            return false;
+        }
+        if (!mappedInput_.open(filepath)) {
+            LOG_WARN("Failed to memory-map {}", filepath);
+            return false;
+        }
+        this->hasInit = true;
+        this->outputFrameQueue = outputFrameQueue;
+        this->inputSeekable_ = true;
+        this->mappedPos_ = 0;
+    }
+
+    avformat_network_init();
+    {
+        std::scoped_lock lock(ffmpegMutex_);
+        if (!setupCustomIO())
+        {
+            LOG_ERROR("Failed to setup custom IO for FFmpegStreamDecoder.");
+            return false;
+        }
+    }
+    LOG_INFO("Decoding memory-mapped file {} ({} bytes)", filepath, mappedInput_.size());
+    return true;
+}
+
+bool FFmpegStreamDecoder::initializeFromPcm(std::shared_ptr<const DecodedTrack> track,
+    std::weak_ptr<AudioFrameQueue> outputFrameQueue)
+{
+    if (!track || !track->format.isValid() || track->frames() == 0) {
+        LOG_WARN("Refusing to replay an empty or invalid decoded track");
+        return false;
+    }
+    {
+        std::scoped_lock lock(audioCacheMutex);
+        if (this->hasInit)
+        {
+            return false;
+        }
+        this->hasInit = true;
+        this->outputFrameQueue = outputFrameQueue;
+        this->inputSeekable_ = true;
+        this->pcmSource_ = std::move(track);
+    }
+    {
+        // The format is known up front, so getAudioFormatAsync returns immediately
+        std::scoped_lock lock(audioFormatMutex_);
+        audio_format_ = pcmSource_->format;
+        audio_format_verified_.store(true);
+    }
+    audioFormatCondition_.notify_all();
+    LOG_INFO("Replaying {:.1f} s of cached PCM ({} bytes)", pcmSource_->durationSeconds(), pcmSource_->pcm.size());
+    return true;
+}
+
+void FFmpegStreamDecoder::recordDecodedPcm(size_t maxBytes,
+    std::function<void(std::shared_ptr<const DecodedTrack>)> onComplete)
+{
+    recordingPcm_ = maxBytes > 0 && onComplete != nullptr && !pcmSource_;
+    pcmRecordLimit_ = maxBytes;
+    onPcmRecorded_ = std::move(onComplete);
+}
+
+void FFmpegStreamDecoder::recordWaveform(std::function<void(WaveformOverview)> onComplete)
+{
+    recordingWaveform_ = onComplete != nullptr && !pcmSource_;
+    waveform_.reset();
+    onWaveformRecorded_ = std::move(onComplete);
+}
+
+void FFmpegStreamDecoder::setOutputFormat(const AudioFormat& format)
+{
+    std::scoped_lock lock(audioFormatMutex_);
+    requested_format_ = format;
+}
+
 // Notice: This function will block if bytes in audioCache is less than min_buffer_size(60*1024)!
 bool FFmpegStreamDecoder::startDecoding(uint64_t lenFullStream)
 {
@@ -126,22 +246,36 @@ bool FFmpegStreamDecoder::startDecoding(uint64_t lenFullStream)
     lenFullSize = lenFullStream;
     playing_.store(true);
     decodeCompleted_.store(false);
-    streamConsumptionFinished_.store(false);
-    // Start stream reader thread to fill buffer (wrap entry to catch exceptions)
-    consumeAudioStreamThread = std::thread([this]() {
-        try {
-            this->consumeAudioStreamFunc();
-        } catch (const std::exception& e) {
-            LOG_ERROR("FFmpegStreamDecoder::consumeAudioStreamFunc threw: {}", e.what());
-            std::terminate();
-        } catch (...) {
-            LOG_ERROR("FFmpegStreamDecoder::consumeAudioStreamFunc threw unknown exception");
-            std::terminate();
-        }
-    });
-    // Start decode and playback threads; perform FFmpeg setup inside decoding thread
-    LOG_INFO("FFmpegStreamDecoder starting consumer and decoder threads (setup performed in decoder thread).");
-    decodeAudioBytesThread = std::thread([this]() {
+    if (pcmSource_) {
+        // Frames come from memory; there is nothing to consume
+        lenFullSize = pcmSource_->pcm.size();
+        streamConsumptionFinished_.store(true);
+    } else if (mappedInput_.isOpen()) {
+        // FFmpeg reads the mapping directly; there is nothing to consume
+        lenFullSize = mappedInput_.size();
+        streamConsumptionFinished_.store(true);
+    } else {
+        streamConsumptionFinished_.store(false);
+        // Start stream reader job to fill buffer (wrap entry to catch exceptions)
+        consumeAudioStreamJob = audioWorkers().run([this]() {
+            util::ScopedThreadPriority priority(threadRole_);
+            util::Tracer::setThreadName("Stream reader");
+            try {
+                this->consumeAudioStreamFunc();
+            } catch (const std::exception& e) {
+                LOG_ERROR("FFmpegStreamDecoder::consumeAudioStreamFunc threw: {}", e.what());
+                std::terminate();
+            } catch (...) {
+                LOG_ERROR("FFmpegStreamDecoder::consumeAudioStreamFunc threw unknown exception");
+                std::terminate();
+            }
+        });
+    }
+    // Start decode job; perform FFmpeg setup on the decoding thread
+    LOG_INFO("FFmpegStreamDecoder starting consumer and decoder jobs (setup performed on decoder thread).");
+    decodeAudioBytesJob = audioWorkers().run([this]() {
+        util::ScopedThreadPriority priority(threadRole_);
+        util::Tracer::setThreadName("Decoder");
         try {
             this->decodeAudioBytesFunc();
         } catch (const std::exception& e) {
@@ -177,6 +311,27 @@ bool FFmpegStreamDecoder::resumeDecoding()
     return false;
 }
 
+bool FFmpegStreamDecoder::seek(double position_seconds)
+{
+    if (!isSeekable()) {
+        LOG_WARN("Seek requested but the input stream does not support repositioning");
+        return false;
+    }
+    if (decodeCompleted_.load() || destroying_.load()) {
+        return false;
+    }
+    int64_t positionMs = std::max<int64_t>(0, static_cast<int64_t>(position_seconds * 1000.0));
+    seekRequestMs_.store(positionMs);
+    decodeStateCondition.notify_all();
+    return true;
+}
+
+bool FFmpegStreamDecoder::isSeekable() const
+{
+    std::scoped_lock lock(audioCacheMutex);
+    return inputSeekable_;
+}
+
 bool FFmpegStreamDecoder::isDecoding() const
 {
     return playing_.load();
@@ -205,6 +360,11 @@ std::future<AudioFormat> FFmpegStreamDecoder::getAudioFormatAsync(std::chrono::m
 std::future<double> FFmpegStreamDecoder::getDurationAsync() const
 {
     // Run asynchronously on a background thread to avoid blocking the caller
+    if (pcmSource_) {
+        std::promise<double> known;
+        known.set_value(pcmSource_->durationSeconds());
+        return known.get_future();
+    }
     return std::async(std::launch::async, [this]() {
         std::unique_lock<std::mutex> lock(this->ffmpegMutex_);
         // Wait until format context is available
@@ -225,44 +385,89 @@ std::future<double> FFmpegStreamDecoder::getDurationAsync() const
     });
 }
 
+AudioFramePool::Stats FFmpegStreamDecoder::getFramePoolStats() const
+{
+    return framePool_.stats();
+}
+
 void FFmpegStreamDecoder::consumeAudioStreamFunc()
 {
-    char buffer[4096];
+    bool readCompletedNotified = false;
     while (playing_.load() && !destroying_.load()) {
         std::unique_lock lock(audioCacheMutex);
-        size_t toWrite = std::min(audioCache.capacity() - audioCache.size(), sizeof(buffer));
+        if (streamSeekPending_) {
+            // The AVIO seek callback dropped audioCache; continue reading at the new offset
+            uint64_t target = cacheStreamOffset_;
+            streamSeekPending_ = false;
+            lock.unlock();
+            inputAudioStream->clear();
+            inputAudioStream->seekg(static_cast<std::streamoff>(target));
+            if (inputAudioStream->fail()) {
+                QString reason = QStringLiteral("Failed to reposition input stream");
+                LOG_ERROR("Failed to seek input stream to offset {}.", target);
+                emit readError(reason);
+                postEvent(makeEvent(AudioEventProcessor::STREAM_READ_ERROR, AudioEventProcessor::ErrorInfo{reason}));
+                break;
+            }
+            LOG_DEBUG("Input stream repositioned to offset {}", target);
+            continue;
+        }
+        auto span = audioCache.writableSpan();
+        size_t toWrite = std::min(span.second, ioChunkSize_.load());
         if (toWrite == 0) {
             // Buffer full, wait until space is available
-            // LOG_DEBUG("Audio cache full ({} bytes), waiting for space to become available.", audioCache.size());
+            LOG_DEBUG_RATE_LIMITED(1000, "Audio cache full ({} bytes), waiting for space to become available.", audioCache.size());
             decodeCondition.wait(lock, [this]() {
-                return audioCache.size() < audioCache.capacity() || destroying_.load();
+                return audioCache.size() < audioCache.capacity() || streamSeekPending_ || destroying_.load();
             });
-            // LOG_DEBUG("Audio cache has space available ({} bytes), resuming consumption.", audioCache.size());
             continue;
         }
         // Possible situation: stream has less data than requested,
         //  which would cause blocking here with lock held.
         lock.unlock();
-        inputAudioStream->read(buffer, toWrite);
-        std::streamsize bytesRead = inputAudioStream->gcount();
+        // Read straight into audioCache: this thread is its only writer and readPacket never
+        // looks past committed bytes, so the free region can be filled without the lock
+        auto readStart = PlaybackTelemetry::Clock::now();
+        std::streamsize bytesRead;
+        {
+            TRACE_SCOPE("audio", "input stream read");
+            inputAudioStream->read(reinterpret_cast<char*>(span.first), static_cast<std::streamsize>(toWrite));
+            bytesRead = inputAudioStream->gcount();
+        }
+        if (telemetry_) {
+            telemetry_->addNetworkWait(PlaybackTelemetry::Clock::now() - readStart);
+        }
         if (!playing_.load() || destroying_.load()) {
             break;
         }
+        // Reheld lock to write to audioCache
+        lock.lock();
+        if (streamSeekPending_) {
+            // Bytes from before a seek; the next iteration repositions the stream
+            continue;
+        }
         if (bytesRead > 0) {
-            // Reheld lock to write to audioCache
-            lock.lock();
-            audioCache.write(reinterpret_cast<const uint8_t*>(buffer), static_cast<size_t>(bytesRead));
-            // LOG_DEBUG("Consumed {} bytes from input stream, audioCache size: {}", bytesRead, audioCache.size());
+            audioCache.commit(static_cast<size_t>(bytesRead));
+            LOG_TRACE_RATE_LIMITED(1000, "Consumed {} bytes from input stream, audioCache size: {}", bytesRead, audioCache.size());
             decodeCondition.notify_all();
         } else {
             // Could be EOF or read error. Distinguish using stream state.
             if (inputAudioStream->eof()) {
                 LOG_INFO("Stream consumption finished - no more data from input stream.");
                 LOG_DEBUG("audioCache size at end of stream: {}", audioCache.size());
-                emit readCompleted();
-                if (auto proc = m_eventProcessor.lock()) {
-                    QVariantHash data{};
-                    proc->postEvent(AudioEventProcessor::STREAM_READ_COMPLETED, data);
+                if (!readCompletedNotified) {
+                    readCompletedNotified = true;
+                    emit readCompleted();
+                    postEvent(makeEvent(AudioEventProcessor::STREAM_READ_COMPLETED));
+                }
+                if (inputSeekable_) {
+                    // Keep the input open: a later seek may need earlier bytes again
+                    streamConsumptionFinished_.store(true);
+                    decodeCondition.notify_all();
+                    decodeCondition.wait(lock, [this]() {
+                        return streamSeekPending_ || destroying_.load() || !playing_.load();
+                    });
+                    continue;
                 }
                 break;
             } else {
@@ -270,10 +475,7 @@ void FFmpegStreamDecoder::consumeAudioStreamFunc()
                 QString reason = QStringLiteral("Failed to read from input stream");
                 LOG_ERROR("Stream read error while consuming input stream.");
                 emit readError(reason);
-                if (auto proc = m_eventProcessor.lock()) {
-                    QVariantHash data{{QStringLiteral("error"), QVariant(reason)}};
-                    proc->postEvent(AudioEventProcessor::STREAM_READ_ERROR, data);
-                }
+                postEvent(makeEvent(AudioEventProcessor::STREAM_READ_ERROR, AudioEventProcessor::ErrorInfo{reason}));
                 break;
             }
         }
@@ -288,15 +490,16 @@ void FFmpegStreamDecoder::consumeAudioStreamFunc()
 
 void FFmpegStreamDecoder::decodeAudioBytesFunc()
 {
+    if (pcmSource_) {
+        replayPcmFunc();
+        return;
+    }
     AVPacket* packet = av_packet_alloc();
     if (!packet) {
         LOG_ERROR("Failed to allocate AVPacket for decoding.");
         QString reason = QStringLiteral("Failed to allocate AVPacket for decoding.");
         emit decodingError(reason);
-        if (auto proc = m_eventProcessor.lock()) {
-            QVariantHash data{{QStringLiteral("error"), QVariant(reason)}};
-            proc->postEvent(AudioEventProcessor::DECODING_ERROR, data);
-        }
+        postEvent(makeEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{reason}));
         return;
     }
 
@@ -306,10 +509,7 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
         av_packet_free(&packet);
         QString reason = QStringLiteral("Failed to allocate AVFrame for decoding.");
         emit decodingError(reason);
-        if (auto proc = m_eventProcessor.lock()) {
-            QVariantHash data{{QStringLiteral("error"), QVariant(reason)}};
-            proc->postEvent(AudioEventProcessor::DECODING_ERROR, data);
-        }
+        postEvent(makeEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{reason}));
         return;
     }
     
@@ -331,6 +531,8 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
             return;
         }
 
+        updateIoChunkSize();
+
         // Find audio stream
         const AVCodec* codec = nullptr;
         audioStreamIndex = av_find_best_stream(format_ctx_, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
@@ -372,9 +574,13 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
         // positives when FFmpeg misdetects formats on truncated or corrupt input.
         {
             std::scoped_lock lock(audioFormatMutex_);
-            audio_format_.sample_rate = codec_ctx_->sample_rate;
-            audio_format_.channels = codec_ctx_->ch_layout.nb_channels;
-            audio_format_.bits_per_sample = 16;
+            if (requested_format_.isValid()) {
+                audio_format_ = requested_format_;
+            } else {
+                audio_format_.sample_rate = codec_ctx_->sample_rate;
+                audio_format_.channels = codec_ctx_->ch_layout.nb_channels;
+                audio_format_.bits_per_sample = 16;
+            }
             // do not notify waiters yet; wait until a successful frame conversion
         }
 
@@ -394,12 +600,24 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
         av_opt_set_int(swr_ctx_, "in_sample_rate", codec_ctx_->sample_rate, 0);
         av_opt_set_sample_fmt(swr_ctx_, "in_sample_fmt", codec_ctx_->sample_fmt, 0);
         
-        // Set output parameters (preserve sample rate and channels, but convert to 16-bit)
+        // Set output parameters: the negotiated output format when one was requested,
+        // otherwise preserve sample rate and channels and convert to 16-bit
         AVChannelLayout out_ch_layout;
-        av_channel_layout_copy(&out_ch_layout, &codec_ctx_->ch_layout);
+        if (audio_format_.channels == codec_ctx_->ch_layout.nb_channels) {
+            av_channel_layout_copy(&out_ch_layout, &codec_ctx_->ch_layout);
+        } else {
+            av_channel_layout_default(&out_ch_layout, audio_format_.channels);
+        }
+        AVSampleFormat out_sample_fmt = audio_format_.bits_per_sample == 32 ? AV_SAMPLE_FMT_FLT : AV_SAMPLE_FMT_S16;
         av_opt_set_chlayout(swr_ctx_, "out_chlayout", &out_ch_layout, 0);
-        av_opt_set_int(swr_ctx_, "out_sample_rate", codec_ctx_->sample_rate, 0);
-        av_opt_set_sample_fmt(swr_ctx_, "out_sample_fmt", AV_SAMPLE_FMT_S16, 0);
+        av_opt_set_int(swr_ctx_, "out_sample_rate", audio_format_.sample_rate, 0);
+        av_opt_set_sample_fmt(swr_ctx_, "out_sample_fmt", out_sample_fmt, 0);
+        av_channel_layout_uninit(&out_ch_layout);
+        LOG_INFO("Resampler: {} Hz/{} ch/{} -> {} Hz/{} ch/{}",
+                 codec_ctx_->sample_rate, codec_ctx_->ch_layout.nb_channels,
+                 av_get_sample_fmt_name(codec_ctx_->sample_fmt),
+                 audio_format_.sample_rate, audio_format_.channels,
+                 av_get_sample_fmt_name(out_sample_fmt));
         
         // Initialize resampler
         if (swr_init(swr_ctx_) < 0) {
@@ -409,6 +627,25 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
             return;
         }
 
+        if (recordingPcm_) {
+            // Reserve the whole track up front so recording doesn't reallocate while decoding
+            const int64_t bytesPerSecond = static_cast<int64_t>(audio_format_.sample_rate)
+                                           * audio_format_.channels * (audio_format_.bits_per_sample / 8);
+            if (format_ctx_->duration == AV_NOPTS_VALUE || format_ctx_->duration <= 0) {
+                abandonRecording();
+            } else {
+                // One second of slack for containers that report a short duration
+                size_t expected = static_cast<size_t>(
+                    av_rescale(format_ctx_->duration, bytesPerSecond, AV_TIME_BASE) + bytesPerSecond);
+                if (expected > pcmRecordLimit_ + static_cast<size_t>(bytesPerSecond)) {
+                    LOG_DEBUG("Track too large for the PCM cache ({} bytes), not recording", expected);
+                    abandonRecording();
+                } else {
+                    pcmRecording_.reserve(std::min(expected, pcmRecordLimit_));
+                }
+            }
+        }
+
         // Signal that FFmpeg setup is complete
         ffmpegCondition_.notify_all();
     }
@@ -425,18 +662,36 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
             }
         }
 
+        int64_t seekMs = seekRequestMs_.exchange(-1);
+        if (seekMs >= 0) {
+            performSeek(seekMs);
+        }
+
         // Call av_read_frame - blocking for data is handled in readPacket callback
-        int ret = av_read_frame(format_ctx_, packet);
+        int ret;
+        {
+            TRACE_SCOPE("audio", "av_read_frame");
+            ret = av_read_frame(format_ctx_, packet);
+        }
         if (ret < 0) {
             if (ret == AVERROR_EOF) {
                 // At this point, we should have sufficient data or stream is truly finished
                 decodeCompleted_.store(true);
                 LOG_INFO("Decoding completed - av_read_frame returned EOF");
-                emit decodingFinished();
-                if (auto proc = m_eventProcessor.lock()) {
-                    QVariantHash data{};
-                    proc->postEvent(AudioEventProcessor::DECODING_FINISHED, data);
+                if (recordingPcm_ && !pcmRecording_.empty()) {
+                    auto track = std::make_shared<DecodedTrack>();
+                    track->format = audio_format_;
+                    track->pcm = std::move(pcmRecording_);
+                    recordingPcm_ = false;
+                    onPcmRecorded_(std::move(track));
                 }
+                if (recordingWaveform_ && waveform_) {
+                    recordingWaveform_ = false;
+                    onWaveformRecorded_(waveform_->finish());
+                    waveform_.reset();
+                }
+                emit decodingFinished();
+                postEvent(makeEvent(AudioEventProcessor::DECODING_FINISHED));
                 // Log cumulative decoded duration for diagnostics
                 {
                     int64_t samples = m_decoded_samples.load(std::memory_order_relaxed);
@@ -445,16 +700,15 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
                         approx_seconds = static_cast<double>(samples) / static_cast<double>(audio_format_.sample_rate);
                     }
                     LOG_INFO("Decoding summary: decoded_samples={}, approx_seconds={} (sample_rate={})", samples, approx_seconds, audio_format_.sample_rate);
+                    auto poolStats = framePool_.stats();
+                    LOG_INFO("Frame pool summary: hits={}, misses={}, pooled={}", poolStats.hits, poolStats.misses, poolStats.pooled);
                 }
                 break;
             } else {
                 LOG_ERROR("Error reading frame: {}", ret);
                 QString reason = QStringLiteral("Error reading frame");
                 emit decodingError(reason);
-                if (auto proc = m_eventProcessor.lock()) {
-                    QVariantHash data{{QStringLiteral("code"), QVariant(ret)}, {QStringLiteral("error"), QVariant(reason)}};
-                    proc->postEvent(AudioEventProcessor::DECODING_ERROR, data);
-                }
+                postEvent(makeEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{reason, ret}));
                 continue;
             }
         }
@@ -465,17 +719,17 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
         }
 
         // Send packet to decoder
+        {
+            TRACE_SCOPE("audio", "avcodec_send_packet");
             ret = avcodec_send_packet(codec_ctx_, packet);
-            if (ret < 0) {
+        }
+        if (ret < 0) {
             LOG_ERROR("Error sending packet to decoder: {}", ret);
             av_packet_unref(packet);
             {
                 QString reason = QStringLiteral("Error sending packet to decoder");
                 emit decodingError(reason);
-                if (auto proc = m_eventProcessor.lock()) {
-                    QVariantHash data{{QStringLiteral("code"), QVariant(ret)}, {QStringLiteral("error"), QVariant(reason)}};
-                    proc->postEvent(AudioEventProcessor::DECODING_ERROR, data);
-                }
+                postEvent(makeEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{reason, ret}));
             }
             continue;
         }
@@ -483,16 +737,17 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
         // Receive frames
         int lastRet = 0;
         while (ret >= 0 && playing_.load() && !destroying_.load()) {
-            ret = avcodec_receive_frame(codec_ctx_, frame);
+            {
+                TRACE_SCOPE("audio", "avcodec_receive_frame");
+                ret = avcodec_receive_frame(codec_ctx_, frame);
+            }
             if (ret == AVERROR(EAGAIN)){
-                // if (lastRet != ret) {
-                //     LOG_DEBUG("avcodec_receive_frame returned EAGAIN, continuing...");
-                // }
+                if (lastRet != ret) {
+                    LOG_TRACE_RATE_LIMITED(1000, "avcodec_receive_frame returned EAGAIN, continuing...");
+                }
                 continue;
             } else if (ret == AVERROR_EOF) {
-                if (outputFrameQueue.expired() == false) {
-                    auto sharedQueue = outputFrameQueue.lock();
-                    sharedQueue->clean();
+                if (auto sharedQueue = outputFrameQueue.lock()) {
                     LOG_DEBUG("avcodec_receive_frame returned EOF, ending frame reception loop, frameQueue size: {}", sharedQueue->size());
                 }
                 
@@ -502,10 +757,7 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
                 {
                     QString reason = QStringLiteral("Error receiving frame from decoder");
                     emit decodingError(reason);
-                    if (auto proc = m_eventProcessor.lock()) {
-                        QVariantHash data{{QStringLiteral("code"), QVariant(ret)}, {QStringLiteral("error"), QVariant(reason)}};
-                        proc->postEvent(AudioEventProcessor::DECODING_ERROR, data);
-                    }
+                    postEvent(makeEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{reason, ret}));
                 }
                 break;
             }
@@ -520,24 +772,41 @@ void FFmpegStreamDecoder::decodeAudioBytesFunc()
                     audio_format_verified_.store(true);
                     audioFormatCondition_.notify_all();
                 }
-                // Add to queue
-                if (outputFrameQueue.expired() == false) {
-                    auto sharedQueue = outputFrameQueue.lock();
-                    sharedQueue->enqueue(audio_frame);
-                    // LOG_DEBUG("Decoded and queued an audio frame with PTS {}", frame->pts);
+                if (recordingPcm_) {
+                    recordFrame(*audio_frame);
+                }
+                if (recordingWaveform_) {
+                    recordWaveformFrame(*audio_frame);
+                }
+                // Add to queue, blocking here while the consumer is above the high watermark
+                if (auto sharedQueue = outputFrameQueue.lock()) {
+                    TRACE_SCOPE("audio", "frame queue push");
+                    if (!sharedQueue->push(std::move(audio_frame))) {
+                        LOG_DEBUG("Output frame queue closed, dropping frame with PTS {}", frame->pts);
+                        break;
+                    }
+                    LOG_TRACE_EVERY_N(500, "Decoded and queued an audio frame with PTS {}", frame->pts);
                 } else {
                     LOG_ERROR("Failed to push decoded frame to output queue - queue expired, PTS {}", frame->pts);
-                    if (auto proc = m_eventProcessor.lock()) {
-                        QVariantHash data{{QStringLiteral("error"), QVariant(QStringLiteral("Output frame queue expired"))}};
-                        proc->postEvent(AudioEventProcessor::DECODING_ERROR, data);
-                    }
+                    postEvent(makeEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{QStringLiteral("Output frame queue expired")}));
                     break;
                 }
             }
         }
         av_packet_unref(packet);
+        // Consumer side has shut the queue (stop/track change); stop decoding instead of spinning.
+        auto sharedQueue = outputFrameQueue.lock();
+        if (sharedQueue && sharedQueue->closed()) {
+            break;
+        }
     }
     LOG_DEBUG("Decoding thread exiting, reason: playing_={}, destroying_={}", playing_.load(), destroying_.load());
+    // No more frames will follow: let the consumer drain what is queued and then see end-of-stream.
+    if (decodeCompleted_.load() || destroying_.load()) {
+        if (auto sharedQueue = outputFrameQueue.lock()) {
+            sharedQueue->close();
+        }
+    }
 
     // free frame and packet resources
     if (frame) {
@@ -554,16 +823,29 @@ std::shared_ptr<AudioFrame> FFmpegStreamDecoder::decodeFrame(AVFrame* frame) {
     // Calculate output buffer size
     int out_samples = swr_get_out_samples(swr_ctx_, frame->nb_samples);
     int out_channels = audio_format_.channels;
-    int bytes_per_sample = 2; // 16-bit
+    int bytes_per_sample = audio_format_.bits_per_sample / 8;
     int buffer_size = out_samples * out_channels * bytes_per_sample;
     
-    auto audio_frame = std::make_shared<AudioFrame>(buffer_size);
+    auto audio_frame = framePool_.acquire(static_cast<size_t>(buffer_size));
     audio_frame->sample_rate = audio_format_.sample_rate;
     audio_frame->channels = out_channels;
     audio_frame->bits_per_sample = bytes_per_sample * 8;
     audio_frame->pts = frame->pts;
+    audio_frame->pts_samples = -1;
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE && audioStreamIndex >= 0) {
+        const AVStream* stream = format_ctx_->streams[audioStreamIndex];
+        int64_t ts = frame->best_effort_timestamp;
+        if (stream->start_time != AV_NOPTS_VALUE) {
+            ts -= stream->start_time;
+        }
+        // Samples still buffered in the resampler come out ahead of this frame's samples
+        int64_t first = av_rescale_q(ts, stream->time_base, AVRational{1, audio_format_.sample_rate})
+                        - swr_get_delay(swr_ctx_, audio_format_.sample_rate);
+        audio_frame->pts_samples = std::max<int64_t>(first, 0);
+    }
     
     // Convert audio
+    TRACE_SCOPE("audio", "swr_convert");
     uint8_t* output_data = audio_frame->data.data();
     int converted_samples = swr_convert(swr_ctx_,
                                        &output_data, out_samples,
@@ -577,6 +859,8 @@ std::shared_ptr<AudioFrame> FFmpegStreamDecoder::decodeFrame(AVFrame* frame) {
     // Resize buffer to actual size
     int actual_size = converted_samples * out_channels * bytes_per_sample;
     audio_frame->data.resize(actual_size);
+    audio_frame->discontinuity = markDiscontinuity_;
+    markDiscontinuity_ = false;
     
     // Update diagnostic counter: converted_samples is samples per channel
     m_decoded_samples.fetch_add(static_cast<int64_t>(converted_samples), std::memory_order_relaxed);
@@ -584,12 +868,192 @@ std::shared_ptr<AudioFrame> FFmpegStreamDecoder::decodeFrame(AVFrame* frame) {
     return audio_frame;
 }
 
+void FFmpegStreamDecoder::performSeek(int64_t position_ms)
+{
+    int64_t target = av_rescale(position_ms, AV_TIME_BASE, 1000);
+    int ret = avformat_seek_file(format_ctx_, -1, INT64_MIN, target, target, 0);
+    if (ret < 0) {
+        LOG_ERROR("Seek to {} ms failed: {}", position_ms, ret);
+    } else {
+        avcodec_flush_buffers(codec_ctx_);
+        // Drop samples still buffered inside the resampler
+        swr_close(swr_ctx_);
+        if (swr_init(swr_ctx_) < 0) {
+            LOG_ERROR("Failed to reinitialize resampler after seek.");
+        }
+        LOG_INFO("Decoder seeked to {} ms", position_ms);
+    }
+    // Consumers already dropped what they had queued, so even a failed seek resumes
+    // from here as a new segment
+    markDiscontinuity_ = true;
+    // The recordings would now have a hole in them
+    abandonRecording();
+    recordingWaveform_ = false;
+    waveform_.reset();
+}
+
+void FFmpegStreamDecoder::replayPcmFunc()
+{
+    const DecodedTrack& track = *pcmSource_;
+    const size_t bytesPerFrame = track.bytesPerFrame();
+    const uint64_t totalFrames = track.frames();
+    uint64_t position = 0;
+
+    while (playing_.load() && !destroying_.load()) {
+        int64_t seekMs = seekRequestMs_.exchange(-1);
+        if (seekMs >= 0) {
+            position = std::min<uint64_t>(totalFrames,
+                static_cast<uint64_t>(seekMs) * track.format.sample_rate / 1000);
+            markDiscontinuity_ = true;
+            LOG_INFO("Cached PCM replay seeked to {} ms", seekMs);
+        }
+        if (position >= totalFrames) {
+            decodeCompleted_.store(true);
+            LOG_INFO("Cached PCM replay completed");
+            emit decodingFinished();
+            postEvent(makeEvent(AudioEventProcessor::DECODING_FINISHED));
+            break;
+        }
+
+        const size_t frames = static_cast<size_t>(std::min<uint64_t>(PCM_REPLAY_FRAME_SAMPLES, totalFrames - position));
+        auto audio_frame = framePool_.acquire(frames * bytesPerFrame);
+        std::memcpy(audio_frame->data.data(), track.pcm.data() + position * bytesPerFrame, frames * bytesPerFrame);
+        audio_frame->sample_rate = track.format.sample_rate;
+        audio_frame->channels = track.format.channels;
+        audio_frame->bits_per_sample = track.format.bits_per_sample;
+        audio_frame->pts = static_cast<int64_t>(position);
+        audio_frame->pts_samples = static_cast<int64_t>(position);
+        audio_frame->discontinuity = markDiscontinuity_;
+        markDiscontinuity_ = false;
+        m_decoded_samples.fetch_add(static_cast<int64_t>(frames), std::memory_order_relaxed);
+        position += frames;
+
+        auto sharedQueue = outputFrameQueue.lock();
+        if (!sharedQueue) {
+            LOG_ERROR("Failed to push replayed frame to output queue - queue expired");
+            break;
+        }
+        if (!sharedQueue->push(std::move(audio_frame))) {
+            LOG_DEBUG("Output frame queue closed, stopping cached PCM replay");
+            break;
+        }
+    }
+    // Same end-of-stream contract as decodeAudioBytesFunc
+    if (decodeCompleted_.load() || destroying_.load()) {
+        if (auto sharedQueue = outputFrameQueue.lock()) {
+            sharedQueue->close();
+        }
+    }
+}
+
+void FFmpegStreamDecoder::recordFrame(const AudioFrame& frame)
+{
+    if (pcmRecording_.size() + frame.data.size() > pcmRecordLimit_) {
+        LOG_DEBUG("Decoded track exceeds the PCM cache budget, not recording");
+        abandonRecording();
+        return;
+    }
+    pcmRecording_.insert(pcmRecording_.end(), frame.data.begin(), frame.data.end());
+}
+
+void FFmpegStreamDecoder::postEvent(std::function<void(AudioEventProcessor&)> post)
+{
+    std::unique_lock<std::mutex> lock(eventProcessorMutex_);
+    if (!eventProcessorAttached_) {
+        heldEvents_.push_back(std::move(post));
+    } else if (auto proc = m_eventProcessor.lock()) {
+        lock.unlock();
+        post(*proc);
+    }
+}
+
+void FFmpegStreamDecoder::abandonRecording()
+{
+    recordingPcm_ = false;
+    std::vector<uint8_t>().swap(pcmRecording_);
+}
+
+void FFmpegStreamDecoder::recordWaveformFrame(const AudioFrame& frame)
+{
+    if (frame.channels <= 0) {
+        return;
+    }
+    if (!waveform_) {
+        waveform_.emplace(frame.channels);
+    }
+    if (frame.bits_per_sample == 32) {
+        waveform_->addFloat(reinterpret_cast<const float*>(frame.data.data()),
+                            frame.data.size() / (sizeof(float) * frame.channels));
+    } else {
+        waveform_->addS16(reinterpret_cast<const int16_t*>(frame.data.data()),
+                          frame.data.size() / (sizeof(int16_t) * frame.channels));
+    }
+}
+
+void FFmpegStreamDecoder::updateIoChunkSize()
+{
+    int64_t bitRate = format_ctx_->bit_rate;
+    if (bitRate <= 0 && format_ctx_->duration > 0 && lenFullSize > 0) {
+        bitRate = av_rescale(static_cast<int64_t>(lenFullSize) * 8, AV_TIME_BASE, format_ctx_->duration);
+    }
+    if (bitRate <= 0) {
+        LOG_DEBUG("Bitrate unknown, keeping {} byte IO chunks", ioChunkSize_.load());
+        return;
+    }
+    // About a quarter second of input per chunk: 4 KB for 128 kbps AAC, ~44 KB for CD-quality FLAC
+    size_t chunk = std::clamp<size_t>(static_cast<size_t>(bitRate / 8 / 4), MIN_IO_CHUNK, AVIO_BUFFER_SIZE);
+    ioChunkSize_.store(chunk);
+    LOG_INFO("IO chunk size {} bytes for {} at {} bps", chunk,
+             format_ctx_->iformat ? format_ctx_->iformat->name : "unknown", bitRate);
+}
+
 int64_t FFmpegStreamDecoder::seek(void* opaque, int64_t offset, int whence) {
     auto* decoder = static_cast<FFmpegStreamDecoder*>(opaque);
+    if (!decoder) {
+        return -1;
+    }
+    whence &= ~AVSEEK_FORCE;
     if (whence == AVSEEK_SIZE) {
-        return decoder ? decoder->lenFullSize : -1;
+        return decoder->lenFullSize;
+    }
+
+    std::unique_lock<std::mutex> lock(decoder->audioCacheMutex);
+    const int64_t current = static_cast<int64_t>(decoder->cacheStreamOffset_);
+    int64_t target = 0;
+    switch (whence) {
+    case SEEK_SET: target = offset; break;
+    case SEEK_CUR: target = current + offset; break;
+    case SEEK_END:
+        if (decoder->lenFullSize == 0) return -1;
+        target = static_cast<int64_t>(decoder->lenFullSize) + offset;
+        break;
+    default:
+        return -1;
+    }
+    if (target < 0 || (decoder->lenFullSize > 0 && target > static_cast<int64_t>(decoder->lenFullSize))) {
+        return -1;
+    }
+
+    // Short forward seeks (probing, skipping atoms) are served from bytes already buffered
+    const int64_t bufferedEnd = current + static_cast<int64_t>(decoder->audioCache.size());
+    if (!decoder->streamSeekPending_ && target >= current && target <= bufferedEnd) {
+        decoder->audioCache.discard(static_cast<size_t>(target - current));
+        decoder->cacheStreamOffset_ = static_cast<uint64_t>(target);
+        decoder->decodeCondition.notify_all();
+        return target;
+    }
+    if (!decoder->inputSeekable_) {
+        return -1;
     }
-    return -1;
+
+    // Anything else repositions the input; readPacket waits for the consume thread to refill
+    decoder->audioCache.clear();
+    decoder->cacheStreamOffset_ = static_cast<uint64_t>(target);
+    decoder->streamSeekPending_ = true;
+    decoder->streamConsumptionFinished_.store(false);
+    decoder->decodeCondition.notify_all();
+    LOG_DEBUG("AVIO seek to offset {} (from {})", target, current);
+    return target;
 }
 
 int FFmpegStreamDecoder::readPacket(void *opaque, uint8_t *buf, int buf_size)
@@ -608,7 +1072,7 @@ int FFmpegStreamDecoder::readPacket(void *opaque, uint8_t *buf, int buf_size)
     }
     
     // Wait until we have sufficient data OR stream consumption is finished
-    const size_t min_available = std::min(static_cast<size_t>(buf_size), static_cast<size_t>(8192));
+    const size_t min_available = std::min(static_cast<size_t>(buf_size), decoder->ioChunkSize_.load());
     
     // Block until enough data is available, or input stream is finished
     while (decoder->audioCache.size() < min_available && 
@@ -619,19 +1083,20 @@ int FFmpegStreamDecoder::readPacket(void *opaque, uint8_t *buf, int buf_size)
         LOG_DEBUG("readPacket: Cache has {} bytes, need at least {}, waiting for more data", 
                  decoder->audioCache.size(), min_available);
         
+        TRACE_SCOPE("audio", "readPacket wait for input");
+        auto stallStart = PlaybackTelemetry::Clock::now();
         decoder->decodeCondition.wait(lock, [decoder, min_available]() {
             return decoder->audioCache.size() >= min_available || 
                    decoder->streamConsumptionFinished_.load() || 
                    decoder->destroying_.load() || 
                    !decoder->playing_.load();
         });
+        if (decoder->telemetry_) {
+            decoder->telemetry_->addDecoderStall(PlaybackTelemetry::Clock::now() - stallStart);
+        }
         LOG_DEBUG("readPacket: Woke up, cache has {} bytes", decoder->audioCache.size());
     }
 
-    // if (decoder->streamConsumptionFinished_.load()) {
-    //     LOG_DEBUG("readPacket: Stream consumption finished with {} bytes in cache", decoder->audioCache.size());
-    // }
-    
     // Check exit conditions
     if (decoder->destroying_.load() || !decoder->playing_.load()) {
         LOG_INFO("readPacket: Decoder stopping, returning EOF");
@@ -654,15 +1119,58 @@ int FFmpegStreamDecoder::readPacket(void *opaque, uint8_t *buf, int buf_size)
     
     size_t to_read = std::min(available, static_cast<size_t>(buf_size));
     decoder->audioCache.read(buf, to_read);
+    decoder->cacheStreamOffset_ += to_read;
     // Notify producer that space is available
-    // LOG_DEBUG("readPacket: Provided {} bytes from audio cache({}) to FFmpeg", to_read, available - to_read);
+    LOG_TRACE_RATE_LIMITED(1000, "readPacket: Provided {} bytes from audio cache({}) to FFmpeg", to_read, available - to_read);
     decoder->decodeCondition.notify_all();
     return static_cast<int>(to_read);
 }
 
+int FFmpegStreamDecoder::readMapped(void* opaque, uint8_t* buf, int buf_size)
+{
+    auto* decoder = static_cast<FFmpegStreamDecoder*>(opaque);
+    if (!decoder || buf_size <= 0) {
+        return AVERROR(EINVAL);
+    }
+    if (decoder->destroying_.load()) {
+        return AVERROR_EOF;
+    }
+    const uint64_t size = decoder->mappedInput_.size();
+    if (decoder->mappedPos_ >= size) {
+        return AVERROR_EOF;
+    }
+    size_t to_read = static_cast<size_t>(std::min<uint64_t>(size - decoder->mappedPos_, static_cast<uint64_t>(buf_size)));
+    std::memcpy(buf, decoder->mappedInput_.data() + decoder->mappedPos_, to_read);
+    decoder->mappedPos_ += to_read;
+    return static_cast<int>(to_read);
+}
+
+int64_t FFmpegStreamDecoder::seekMapped(void* opaque, int64_t offset, int whence)
+{
+    auto* decoder = static_cast<FFmpegStreamDecoder*>(opaque);
+    if (!decoder) {
+        return -1;
+    }
+    const int64_t size = static_cast<int64_t>(decoder->mappedInput_.size());
+    int64_t target = 0;
+    switch (whence & ~AVSEEK_FORCE) {
+    case AVSEEK_SIZE: return size;
+    case SEEK_SET: target = offset; break;
+    case SEEK_CUR: target = static_cast<int64_t>(decoder->mappedPos_) + offset; break;
+    case SEEK_END: target = size + offset; break;
+    default: return -1;
+    }
+    if (target < 0 || target > size) {
+        return -1;
+    }
+    decoder->mappedPos_ = static_cast<uint64_t>(target);
+    return target;
+}
+
 /***************Private Methods ***************/
 bool FFmpegStreamDecoder::setupCustomIO() {
-    if (!inputAudioStream) return false;
+    const bool mapped = mappedInput_.isOpen();
+    if (!inputAudioStream && !mapped) return false;
     
     // Allocate AVIO buffer
     avio_buffer_ = static_cast<uint8_t*>(av_malloc(AVIO_BUFFER_SIZE));
@@ -672,7 +1180,9 @@ bool FFmpegStreamDecoder::setupCustomIO() {
     }
     
     // Create custom AVIO context
-    avio_ctx_ = avio_alloc_context(avio_buffer_, AVIO_BUFFER_SIZE, 0, this, readPacket, nullptr, seek);
+    avio_ctx_ = mapped
+        ? avio_alloc_context(avio_buffer_, AVIO_BUFFER_SIZE, 0, this, readMapped, nullptr, seekMapped)
+        : avio_alloc_context(avio_buffer_, AVIO_BUFFER_SIZE, 0, this, readPacket, nullptr, seek);
     if (!avio_ctx_) {
         LOG_ERROR("Failed to allocate AVIO context.");
         av_free(avio_buffer_);
@@ -6,14 +6,21 @@
 #include <iostream>
 #include <future>
 #include <vector>
-#include <util/circular_buffer.hpp>
+#include <optional>
+#include <util/ring_buffer.hpp>
+#include <util/mapped_file.h>
+#include <util/thread_priority.h>
+#include <util/worker_threads.h>
 #include <atomic>
 #include <thread>
 #include <condition_variable>
 #include <QObject>
 #include <queue>
-#include <util/safe_queue.hpp>
 #include "audio_frame.h"
+#include "audio_frame_pool.h"
+#include "playback_telemetry.h"
+#include "decoded_pcm_cache.h"
+#include "waveform_overview.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -47,6 +54,40 @@ public:
      */
     bool initialize(std::shared_ptr<std::istream> inputAudioStream, 
         std::weak_ptr<AudioFrameQueue> outputFrameQueue);
+
+    /**
+     * Initialize the decoder on a local file, which is memory-mapped and handed to FFmpeg
+     * directly: no stream consume thread, no audioCache, and seeks are plain offset changes.
+     * Can't be combined with initialize().
+     * @param filepath UTF-8 path of the file
+     * @return false if the file can't be mapped; the caller may fall back to initialize()
+     */
+    bool initializeFromFile(const std::string& filepath,
+        std::weak_ptr<AudioFrameQueue> outputFrameQueue);
+
+    /**
+     * Initialize the decoder on a track decoded earlier (see DecodedPcmCache): frames are
+     * cut straight from memory, with no FFmpeg and no consume thread, and seeks are plain
+     * offset changes. The track's own format is used; setOutputFormat() has no effect.
+     * Can't be combined with the other initializers.
+     */
+    bool initializeFromPcm(std::shared_ptr<const DecodedTrack> track,
+        std::weak_ptr<AudioFrameQueue> outputFrameQueue);
+
+    /**
+     * Keep a copy of every decoded sample and hand the complete track to onComplete
+     * (called on the decode thread) once decoding reaches the end of the stream.
+     * Recording is abandoned after a seek, or as soon as the track would exceed maxBytes.
+     * Must be called before startDecoding.
+     */
+    void recordDecodedPcm(size_t maxBytes, std::function<void(std::shared_ptr<const DecodedTrack>)> onComplete);
+
+    /**
+     * Build a WaveformOverview of the decoded samples as they go by and hand it to
+     * onComplete (called on the decode thread) once decoding reaches the end of the stream.
+     * Abandoned after a seek, like recordDecodedPcm. Must be called before startDecoding.
+     */
+    void recordWaveform(std::function<void(WaveformOverview)> onComplete);
     
     /**
      * Start decoding process.
@@ -54,6 +95,15 @@ public:
      * @return true on success, false on failure
      */
     bool startDecoding(uint64_t lenFullStream);
+
+    /**
+     * Request the PCM layout decoded frames are converted to, normally the output
+     * device's mix format, so the output layer can copy frames as-is.
+     * 32 bits per sample means float samples, 16 means signed 16-bit samples.
+     * Must be called before startDecoding; an invalid format keeps the source
+     * sample rate and channel count and converts to 16-bit.
+     */
+    void setOutputFormat(const AudioFormat& format);
     bool pauseDecoding();
     bool resumeDecoding();
     bool isDecoding() const;
@@ -68,14 +118,31 @@ public:
     // std::future<std::string> getCodecNameAsync() const;
     
     std::future<double> getDurationAsync() const;
+
+    // Hit/miss counters of the decoder-owned frame pool; misses should stay flat during playback.
+    AudioFramePool::Stats getFramePoolStats() const;
     
-    // Todo seek specified position in seconds
-    // bool seek(double position_seconds);
-    // double getCurrentPosition() const;
+    /**
+     * Request a jump to position_seconds; may be called before startDecoding.
+     * The decode thread seeks the demuxer (repositioning the input stream through
+     * the AVIO seek callback) and flushes codec and resampler state. The next frame
+     * it queues is flagged AudioFrame::discontinuity so consumers can drop frames
+     * queued before the seek.
+     * @return false if the input stream can't seek or decoding already finished
+     */
+    bool seek(double position_seconds);
+    // Whether the input stream supports repositioning (local files, cached streams)
+    bool isSeekable() const;
 
     // Attach an AudioEventProcessor via shared_ptr; stored as weak_ptr to avoid
     // ownership cycles. The decoder will lock the weak_ptr when posting events.
+    // May be called while decoding; events posted before the first call are held
+    // and posted to the processor when it is attached.
     void setEventProcessor(std::shared_ptr<AudioEventProcessor> processor);
+    // Counters for time spent waiting on input; set before startDecoding
+    void setTelemetry(std::shared_ptr<PlaybackTelemetry> telemetry);
+    // Scheduling class of the consume and decode threads (default AudioWorker); set before startDecoding
+    void setThreadRole(util::ThreadRole role);
 
 signals:
     void readCompleted();
@@ -86,13 +153,17 @@ signals:
     void frameTransmissionError(const QString& error);
     void playbackComplete();
 protected:
-    /** 
-     * Custom seek function for AVIO, only support AVSEEK_SIZE and
-     *  return the value that startDecoding gets, no matter whether
-     * inputAudioStream support seeking.
+    /**
+     * Custom seek function for AVIO. AVSEEK_SIZE returns the length given to
+     * startDecoding. Forward seeks within audioCache skip buffered bytes; other
+     * targets drop audioCache and have the consume thread seek inputAudioStream,
+     * which only works if it supports seekg (see isSeekable).
     */
     static int64_t seek(void* opaque, int64_t offset, int whence);
     static int readPacket(void *opaque, uint8_t *buf, int buf_size);
+    // AVIO callbacks used instead of the two above for a memory-mapped input
+    static int readMapped(void *opaque, uint8_t *buf, int buf_size);
+    static int64_t seekMapped(void* opaque, int64_t offset, int whence);
 
 private:
     // Setup custom AVIO context for FFmpeg to read from inputAudioStream
@@ -102,6 +173,19 @@ private:
     // Decode audio bytes from internal buffer and push to outputFrameQueue
     void decodeAudioBytesFunc();
     std::shared_ptr<AudioFrame> decodeFrame(AVFrame* frame);
+    // Run a pending seek() request on the decode thread
+    void performSeek(int64_t position_ms);
+    // Decode thread body for initializeFromPcm: cut pcmSource_ into pooled frames
+    void replayPcmFunc();
+    // Append a decoded frame to pcmRecording_, abandoning the recording if it outgrows its budget
+    void recordFrame(const AudioFrame& frame);
+    void abandonRecording();
+    // Post through m_eventProcessor, or hold the event until one is attached
+    void postEvent(std::function<void(AudioEventProcessor&)> post);
+    // Feed a decoded frame to waveform_
+    void recordWaveformFrame(const AudioFrame& frame);
+    // Size ioChunkSize_ from the bitrate found by avformat_find_stream_info
+    void updateIoChunkSize();
 private:
     // Used for getDurationAsync and getCodecNameAsync
     mutable std::mutex ffmpegMutex_;
@@ -116,12 +200,19 @@ private:
     mutable std::mutex audioFormatMutex_;
     mutable std::condition_variable audioFormatCondition_;
     AudioFormat audio_format_;
+    AudioFormat requested_format_{0, 0, 0};
     std::atomic<bool> audio_format_verified_{false};
     
     // Custom AVIO
     AVIOContext* avio_ctx_;
     uint8_t* avio_buffer_;
-    static const size_t AVIO_BUFFER_SIZE = 4096;
+    // Allocated at the largest size; how much each readPacket call waits for is adaptive
+    static const size_t AVIO_BUFFER_SIZE = 64 * 1024;
+    static const size_t MIN_IO_CHUNK = 4096;
+    // Bytes moved per istream read and per readPacket call. Starts small for probing and
+    // grows with the bitrate once the container is known, so high-bitrate streams (FLAC,
+    // WAV) need fewer callbacks and thread wake-ups per second of audio.
+    std::atomic<size_t> ioChunkSize_{MIN_IO_CHUNK};
 
     bool hasInit;
     uint64_t lenFullSize;
@@ -129,10 +220,40 @@ private:
     mutable std::mutex audioCacheMutex;
     std::shared_ptr<std::istream> inputAudioStream;
     std::weak_ptr<AudioFrameQueue> outputFrameQueue;
-    util::CircularBuffer<uint8_t> audioCache;
+    // Only ever filled into free space, so a full cache rejects rather than overwrites
+    util::RingBuffer<uint8_t, util::OverflowPolicy::Reject> audioCache;
+    // Input stream repositioning, guarded by audioCacheMutex
+    bool inputSeekable_ = false;
+    uint64_t cacheStreamOffset_ = 0;    // Input offset of the first byte in audioCache
+    bool streamSeekPending_ = false;    // Consume thread must seekg to cacheStreamOffset_
+    // Pending seek() target in milliseconds, -1 if none
+    std::atomic<int64_t> seekRequestMs_{-1};
+    bool markDiscontinuity_ = false;    // Decode thread only
+    // Memory-mapped local input (initializeFromFile); read position is used by the decode thread only
+    util::MappedFile mappedInput_;
+    uint64_t mappedPos_ = 0;
+    // In-memory source (initializeFromPcm)
+    std::shared_ptr<const DecodedTrack> pcmSource_;
+    // Decoded PCM kept for DecodedPcmCache (recordDecodedPcm); used by the decode thread only
+    static const size_t PCM_REPLAY_FRAME_SAMPLES = 1024;   // Sample-frames per replayed AudioFrame
+    bool recordingPcm_ = false;
+    size_t pcmRecordLimit_ = 0;
+    std::vector<uint8_t> pcmRecording_;
+    std::function<void(std::shared_ptr<const DecodedTrack>)> onPcmRecorded_;
+    // Seek bar outline (recordWaveform); used by the decode thread only, built from the first frame
+    bool recordingWaveform_ = false;
+    std::optional<WaveformBuilder> waveform_;
+    std::function<void(WaveformOverview)> onWaveformRecorded_;
+    // Recycled PCM blocks handed to outputFrameQueue (used by the decode thread only)
+    AudioFramePool framePool_;
+    std::shared_ptr<PlaybackTelemetry> telemetry_;
+    util::ThreadRole threadRole_ = util::ThreadRole::AudioWorker;
 
-    // Weak reference to the event processor (non-owning)
+    // Weak reference to the event processor (non-owning), guarded by eventProcessorMutex_
+    std::mutex eventProcessorMutex_;
     std::weak_ptr<AudioEventProcessor> m_eventProcessor;
+    bool eventProcessorAttached_ = false;
+    std::vector<std::function<void(AudioEventProcessor&)>> heldEvents_;
 
     std::atomic<bool> playing_;
     std::atomic<bool> destroying_;
@@ -144,7 +265,8 @@ private:
     // Used to notify the waiting decodeThread.
     mutable std::mutex decodeStateMutex;
     mutable std::condition_variable decodeStateCondition;
-    std::thread consumeAudioStreamThread;
-    std::thread decodeAudioBytesThread;
+    // Stream reader and decode loops, run on audioWorkers()
+    util::WorkerThreads::Job consumeAudioStreamJob;
+    util::WorkerThreads::Job decodeAudioBytesJob;
 };
 } // namespace audio
\ No newline at end of file
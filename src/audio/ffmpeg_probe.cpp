@@ -1,7 +1,11 @@
 #include "ffmpeg_probe.h"
 #include <log/log_manager.h>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <climits>
+#include <mutex>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -29,7 +33,52 @@ namespace audio
         return fmtCtx;
     }
 
+    namespace {
+        struct CachedProbe {
+            qint64 size;
+            qint64 modifiedMs;
+            AudioMetadata metadata;
+        };
+
+        // Local files probed, by path; an entry stands while the file's size and mtime do
+        constexpr int MAX_CACHED_PROBES = 8192;
+        std::mutex probeCacheMutex;
+        QHash<QString, CachedProbe> probeCache;
+    }
+
     AudioMetadata FFmpegProbe::probeMetadata(const QString& path)
+    {
+        const QFileInfo file(path);
+        if (!file.isFile()) {
+            return probeUncached(path);     // A URL, or nothing there
+        }
+        const QString key = file.absoluteFilePath();
+        const qint64 size = file.size();
+        const qint64 modifiedMs = file.lastModified().toMSecsSinceEpoch();
+        {
+            std::lock_guard<std::mutex> lock(probeCacheMutex);
+            auto it = probeCache.constFind(key);
+            if (it != probeCache.constEnd() && it->size == size && it->modifiedMs == modifiedMs) {
+                return it->metadata;
+            }
+        }
+
+        AudioMetadata metadata = probeUncached(path);
+        std::lock_guard<std::mutex> lock(probeCacheMutex);
+        if (probeCache.size() >= MAX_CACHED_PROBES) {
+            probeCache.clear();
+        }
+        probeCache.insert(key, CachedProbe{ size, modifiedMs, metadata });
+        return metadata;
+    }
+
+    void FFmpegProbe::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(probeCacheMutex);
+        probeCache.clear();
+    }
+
+    AudioMetadata FFmpegProbe::probeUncached(const QString& path)
     {
         std::string pathStr = path.toStdString();
         AudioMetadata metadata;
@@ -40,23 +89,17 @@ namespace audio
             return metadata;  // Return empty metadata
         }
 
-        // Probe duration
+        // Sample rate and channels from the audio stream, and its duration if the container has none
+        int audioStreamIndex = av_find_best_stream(fmtCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+        AVStream* stream = audioStreamIndex >= 0 ? fmtCtx->streams[audioStreamIndex] : nullptr;
+        if (stream) {
+            metadata.sampleRate = stream->codecpar->sample_rate;
+            metadata.channels = stream->codecpar->ch_layout.nb_channels;
+        }
         if (fmtCtx->duration != AV_NOPTS_VALUE) {
             metadata.durationMs = (fmtCtx->duration * 1000) / AV_TIME_BASE;
-        } else {
-            // Try to get duration from first audio stream
-            int audioStreamIndex = av_find_best_stream(fmtCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-            if (audioStreamIndex >= 0) {
-                AVStream* stream = fmtCtx->streams[audioStreamIndex];
-                if (stream->duration != AV_NOPTS_VALUE) {
-                    metadata.durationMs = static_cast<int64_t>(stream->duration * av_q2d(stream->time_base) * 1000);
-                } else {
-                    metadata.durationMs = INT_MAX;
-                }
-                // Extract sample rate and channels from audio stream
-                metadata.sampleRate = stream->codecpar->sample_rate;
-                metadata.channels = stream->codecpar->ch_layout.nb_channels;
-            }
+        } else if (stream && stream->duration != AV_NOPTS_VALUE) {
+            metadata.durationMs = static_cast<int64_t>(stream->duration * av_q2d(stream->time_base) * 1000);
         }
 
         // Probe metadata tags: artist, title, album
@@ -106,141 +149,26 @@ namespace audio
         return metadata;
     }
 
+    // The single values below share probeMetadata()'s one open and its cache
+
     int64_t FFmpegProbe::probeDuration(const QString& path)
     {
-        std::string pathStr = path.toStdString();
-        
-        // Strategy 1: Check file metadata (Q_UNUSED if not using Qt metadata)
-        // (Skipped here as FFmpeg will handle all cases uniformly)
-        
-        // Strategy 2: FFmpeg format context probe
-        AVFormatContext* fmtCtx = openFormatContext(path);
-        if (!fmtCtx) {
-            LOG_DEBUG("FFmpegProbe: Could not open format context for: {}", pathStr);
-            // Fallback to INT_MAX on probe failure
-            return static_cast<int64_t>(INT_MAX);
-        }
-
-        int64_t duration = INT_MAX;  // Default fallback
-
-        if (fmtCtx->duration != AV_NOPTS_VALUE) {
-            // Convert from AV_TIME_BASE units (microseconds) to milliseconds
-            duration = (fmtCtx->duration * 1000) / AV_TIME_BASE;
-            LOG_DEBUG("FFmpegProbe: Probed duration for {}: {} ms", pathStr, duration);
-        } else {
-            // Try to get duration from first audio stream
-            int audioStreamIndex = av_find_best_stream(fmtCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-            if (audioStreamIndex >= 0) {
-                AVStream* stream = fmtCtx->streams[audioStreamIndex];
-                if (stream->duration != AV_NOPTS_VALUE) {
-                    duration = static_cast<int64_t>(stream->duration * av_q2d(stream->time_base) * 1000);
-                    LOG_DEBUG("FFmpegProbe: Probed duration from audio stream for {}: {} ms", pathStr, duration);
-                } else {
-                    LOG_DEBUG("FFmpegProbe: No duration in audio stream for: {}", pathStr);
-                }
-            } else {
-                LOG_DEBUG("FFmpegProbe: No audio stream found for: {}", pathStr);
-            }
-        }
-
-        avformat_close_input(&fmtCtx);
-        return duration;
+        return probeMetadata(path).durationMs;
     }
 
     int FFmpegProbe::probeSampleRate(const QString& path)
     {
-        AVFormatContext* fmtCtx = openFormatContext(path);
-        if (!fmtCtx) {
-            return 0;
-        }
-
-        int sampleRate = 0;
-
-        // Find the first audio stream
-        for (unsigned int i = 0; i < fmtCtx->nb_streams; i++) {
-            if (fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-                sampleRate = fmtCtx->streams[i]->codecpar->sample_rate;
-                LOG_DEBUG("FFmpegProbe: Probed sample rate for {}: {} Hz", 
-                         path.toStdString(), sampleRate);
-                break;
-            }
-        }
-
-        avformat_close_input(&fmtCtx);
-        return sampleRate;
+        return probeMetadata(path).sampleRate;
     }
 
     int FFmpegProbe::probeChannelCount(const QString& path)
     {
-        AVFormatContext* fmtCtx = openFormatContext(path);
-        if (!fmtCtx) {
-            return 0;
-        }
-
-        int channelCount = 0;
-
-        // Find the first audio stream
-        for (unsigned int i = 0; i < fmtCtx->nb_streams; i++) {
-            if (fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
-                channelCount = fmtCtx->streams[i]->codecpar->ch_layout.nb_channels;
-                LOG_DEBUG("FFmpegProbe: Probed channel count for {}: {}", 
-                         path.toStdString(), channelCount);
-                break;
-            }
-        }
-
-        avformat_close_input(&fmtCtx);
-        return channelCount;
+        return probeMetadata(path).channels;
     }
 
     QString FFmpegProbe::probeArtist(const QString& path)
     {
-        AVFormatContext* fmtCtx = openFormatContext(path);
-        if (!fmtCtx) {
-            return "";
-        }
-
-        QString artist;
-
-        // Try to extract artist from format metadata
-        if (fmtCtx->metadata) {
-            // Try common artist tags in order of preference
-            const char* artistTags[] = {"artist", "Artist", "ARTIST", "TPE1", "TP1", nullptr};
-            
-            for (int i = 0; artistTags[i] != nullptr; ++i) {
-                AVDictionaryEntry* entry = av_dict_get(fmtCtx->metadata, artistTags[i], nullptr, 0);
-                if (entry && entry->value) {
-                    artist = QString::fromUtf8(entry->value);
-                    LOG_DEBUG("FFmpegProbe: Found artist tag '{}' for {}: '{}'", 
-                             artistTags[i], path.toStdString(), artist.toStdString());
-                    break;
-                }
-            }
-
-            // Fallback to album artist if artist not found
-            if (artist.isEmpty()) {
-                const char* albumArtistTags[] = {"album_artist", "Album Artist", "ALBUM_ARTIST", "TPE2", nullptr};
-                
-                for (int i = 0; albumArtistTags[i] != nullptr; ++i) {
-                    AVDictionaryEntry* entry = av_dict_get(fmtCtx->metadata, albumArtistTags[i], nullptr, 0);
-                    if (entry && entry->value) {
-                        artist = QString::fromUtf8(entry->value);
-                        LOG_DEBUG("FFmpegProbe: Found album artist tag '{}' for {}: '{}'", 
-                                 albumArtistTags[i], path.toStdString(), artist.toStdString());
-                        break;
-                    }
-                }
-            }
-        }
-
-        avformat_close_input(&fmtCtx);
-        
-        if (artist.isEmpty()) {
-            LOG_DEBUG("FFmpegProbe: No artist metadata found for: {}", path.toStdString());
-        }
-        
-        return artist;
+        return probeMetadata(path).artist;
     }
 
 }
-
@@ -40,7 +40,10 @@ namespace audio
      * Strategy:
      * - For duration: try metadata first → FFmpeg probe → fallback to INT_MAX
      * - For artist: check common tags (artist, album_artist) with fallback to empty
-     * - Avoids redundant probes by checking file metadata before opening format context
+     * - Every probe opens the file once and reads all of it; the single-value probes
+     *   return one field of probeMetadata()
+     * - Local files' results are cached in memory by (path, size, mtime), so asking
+     *   again about an unchanged file doesn't touch it
      * - Used primarily by PlaylistManager for local media metadata updates
      */
     class FFmpegProbe
@@ -62,25 +65,30 @@ namespace audio
          */
         static AudioMetadata probeMetadata(const QString& path);
 
+        /**
+         * @brief Forget the cached probe results
+         */
+        static void clearCache();
+
         /**
          * @brief Synchronously probe audio file duration with fallback strategy
          * 
-         * Tries duration from file metadata first; if unavailable, opens FFmpeg 
-         * format context for header-based duration; if still unavailable, returns INT_MAX.
+         * Tries duration from file metadata first; if unavailable, the audio stream's
+         * header-based duration; if still unavailable, returns INT_MAX.
          * 
          * @param path Absolute path to audio file (local file path or file:// URL)
          * @return Duration in milliseconds: 
          *         - metadata duration if available
          *         - FFmpeg-probed duration if header contains it
-         *         - INT_MAX if no duration available (allows UI to show "Unknown")
-         *         - -1 if file cannot be opened
+         *         - INT_MAX if no duration available or the file cannot be opened
+         *           (allows UI to show "Unknown")
          */
         static int64_t probeDuration(const QString& path);
 
         /**
          * @brief Synchronously probe sample rate from file header
          * 
-         * Opens FFmpeg format context briefly to extract sample rate.
+         * Sample rate of the best audio stream, as probeMetadata() reads it.
          * 
          * @param path Absolute path to audio file
          * @return Sample rate in Hz, or 0 if probe fails
@@ -90,7 +98,7 @@ namespace audio
         /**
          * @brief Synchronously probe channel count from file header
          * 
-         * Opens FFmpeg format context briefly to extract channel layout.
+         * Channel count of the best audio stream, as probeMetadata() reads it.
          * 
          * @param path Absolute path to audio file
          * @return Number of channels, or 0 if probe fails
@@ -110,6 +118,9 @@ namespace audio
         static QString probeArtist(const QString& path);
 
     private:
+        // probeMetadata() without the cache
+        static AudioMetadata probeUncached(const QString& path);
+
         /**
          * @brief Internal helper for opening AVFormatContext
          * 
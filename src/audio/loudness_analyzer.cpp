@@ -0,0 +1,177 @@
+#include "loudness_analyzer.h"
+#include "loudness_meter.h"
+#include "ffmpeg_decoder.h"
+#include <log/log_manager.h>
+#include <util/thread_priority.h>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <system_error>
+
+namespace audio {
+
+namespace {
+    // The analysis decoder may run far ahead of the meter; only the ring bounds it
+    constexpr int64_t ANALYSIS_DECODE_AHEAD_MS = 10000;
+
+    void measureFrame(std::optional<LoudnessMeter>& meter, const AudioFrame& frame)
+    {
+        if (frame.channels <= 0 || frame.sample_rate <= 0) return;
+        if (!meter) {
+            meter.emplace(frame.sample_rate, frame.channels);
+        }
+        const size_t bytesPerFrame = static_cast<size_t>(frame.channels) * (frame.bits_per_sample / 8);
+        if (bytesPerFrame == 0) return;
+        const size_t frames = frame.data.size() / bytesPerFrame;
+        if (frame.bits_per_sample == 32) {
+            meter->addFloat(reinterpret_cast<const float*>(frame.data.data()), frames);
+        } else if (frame.bits_per_sample == 16) {
+            meter->addS16(reinterpret_cast<const int16_t*>(frame.data.data()), frames);
+        }
+    }
+}
+
+LoudnessAnalyzer::LoudnessAnalyzer(ResultCallback onResult)
+    : onResult_(std::move(onResult))
+{
+    worker_ = std::thread([this]() { workerLoop(); });
+}
+
+LoudnessAnalyzer::~LoudnessAnalyzer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_.store(true);
+        jobs_.clear();
+        queuedKeys_.clear();
+    }
+    jobAvailable_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void LoudnessAnalyzer::analyzeFile(const std::string& key, const std::string& filepath)
+{
+    enqueue(Job{key, filepath, nullptr});
+}
+
+void LoudnessAnalyzer::analyzeTrack(const std::string& key, std::shared_ptr<const DecodedTrack> track)
+{
+    if (!track) return;
+    enqueue(Job{key, std::string(), std::move(track)});
+}
+
+void LoudnessAnalyzer::cancelPending()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.clear();
+    queuedKeys_.clear();
+}
+
+size_t LoudnessAnalyzer::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+bool LoudnessAnalyzer::measureTrack(const DecodedTrack& track, double& gainDb)
+{
+    const AudioFormat& format = track.format;
+    const uint64_t frames = track.frames();
+    if (frames == 0 || (format.bits_per_sample != 16 && format.bits_per_sample != 32)) {
+        return false;
+    }
+    LoudnessMeter meter(format.sample_rate, format.channels);
+    if (format.bits_per_sample == 32) {
+        meter.addFloat(reinterpret_cast<const float*>(track.pcm.data()), static_cast<size_t>(frames));
+    } else {
+        meter.addS16(reinterpret_cast<const int16_t*>(track.pcm.data()), static_cast<size_t>(frames));
+    }
+    gainDb = meter.gainDb();
+    return true;
+}
+
+bool LoudnessAnalyzer::measureFile(const std::string& filepath, double& gainDb, const std::atomic<bool>& stop)
+{
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(std::filesystem::u8path(filepath), ec);
+    if (ec || size == 0) {
+        LOG_WARN("Loudness analysis skipped, can't stat {}", filepath);
+        return false;
+    }
+
+    auto queue = std::make_shared<AudioFrameQueue>(AUDIO_FRAME_QUEUE_CAPACITY,
+                                                   ANALYSIS_DECODE_AHEAD_MS / 2, ANALYSIS_DECODE_AHEAD_MS);
+    FFmpegStreamDecoder decoder;
+    decoder.setThreadRole(util::ThreadRole::Background);
+    // Setup failures don't close the queue themselves
+    QObject::connect(&decoder, &FFmpegStreamDecoder::decodingError, [queue](const QString&) {
+        queue->close();
+    });
+    if (!decoder.initializeFromFile(filepath, queue) || !decoder.startDecoding(size)) {
+        LOG_WARN("Loudness analysis can't decode {}", filepath);
+        return false;
+    }
+
+    std::optional<LoudnessMeter> meter;
+    std::shared_ptr<AudioFrame> frame;
+    while (!stop.load() && queue->waitPop(frame)) {
+        if (frame) {
+            measureFrame(meter, *frame);
+        }
+    }
+    queue->close();
+    if (stop.load() || !meter || !decoder.isCompleted()) {
+        return false;
+    }
+    gainDb = meter->gainDb();
+    return true;
+}
+
+/*************** Private Methods ***************/
+void LoudnessAnalyzer::enqueue(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_.load() || job.key.empty() || !queuedKeys_.insert(job.key).second) {
+            return;
+        }
+        jobs_.push_back(std::move(job));
+    }
+    jobAvailable_.notify_one();
+}
+
+void LoudnessAnalyzer::workerLoop()
+{
+    util::ScopedThreadPriority priority(util::ThreadRole::Background);
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobAvailable_.wait(lock, [this]() { return stopping_.load() || !jobs_.empty(); });
+            if (stopping_.load()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            queuedKeys_.erase(job.key);
+        }
+
+        double gainDb = 0.0;
+        bool ok = job.track ? measureTrack(*job.track, gainDb) : measureFile(job.filepath, gainDb, stopping_);
+        job.track.reset();
+        if (!ok) {
+            if (!stopping_.load()) {
+                LOG_WARN("Loudness analysis failed for {}", job.key);
+            }
+            continue;
+        }
+        LOG_DEBUG("Loudness analysis of {}: {:.2f} dB", job.key, gainDb);
+        if (onResult_ && !stopping_.load()) {
+            onResult_(job.key, gainDb);
+        }
+    }
+}
+
+}
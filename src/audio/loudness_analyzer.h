@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include "decoded_pcm_cache.h"
+
+namespace audio {
+
+/**
+ * @brief Background loudness analysis of whole tracks, off the playback path.
+ *
+ * Jobs are measured one at a time on a worker thread running at ThreadRole::Background:
+ * a local file is decoded by its own FFmpegStreamDecoder (also at background priority),
+ * and a track already decoded for playback (DecodedPcmCache) is measured straight from
+ * memory. Each result is handed to the callback on the worker thread as the gain that
+ * brings the track to LoudnessMeter::REFERENCE_LUFS without clipping. Keys already
+ * queued are ignored; failed jobs are logged and produce no result.
+ */
+class LoudnessAnalyzer {
+public:
+    using ResultCallback = std::function<void(const std::string& key, double gainDb)>;
+
+    explicit LoudnessAnalyzer(ResultCallback onResult);
+    ~LoudnessAnalyzer();
+
+    LoudnessAnalyzer(const LoudnessAnalyzer&) = delete;
+    LoudnessAnalyzer& operator=(const LoudnessAnalyzer&) = delete;
+
+    // Queue a local audio file (UTF-8 path)
+    void analyzeFile(const std::string& key, const std::string& filepath);
+    // Queue a track decoded earlier; only a reference is kept
+    void analyzeTrack(const std::string& key, std::shared_ptr<const DecodedTrack> track);
+    // Drop queued jobs; a job already running finishes
+    void cancelPending();
+    size_t pendingCount() const;
+
+    // Synchronous measurement, used by the worker; false if the track can't be measured
+    static bool measureTrack(const DecodedTrack& track, double& gainDb);
+    // Stops early (returning false) once `stop` becomes true
+    static bool measureFile(const std::string& filepath, double& gainDb, const std::atomic<bool>& stop);
+
+private:
+    struct Job {
+        std::string key;
+        std::string filepath;
+        std::shared_ptr<const DecodedTrack> track;
+    };
+
+    void enqueue(Job job);
+    void workerLoop();
+
+    ResultCallback onResult_;
+    mutable std::mutex mutex_;
+    std::condition_variable jobAvailable_;
+    std::deque<Job> jobs_;
+    std::unordered_set<std::string> queuedKeys_;
+    std::atomic<bool> stopping_{false};
+    std::thread worker_;
+};
+
+}
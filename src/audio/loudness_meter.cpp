@@ -0,0 +1,148 @@
+#include "loudness_meter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace audio {
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+
+    // Mean square energy of a block at the given loudness
+    double energyAt(double lufs) { return std::pow(10.0, (lufs + 0.691) / 10.0); }
+    double loudnessOf(double energy) { return -0.691 + 10.0 * std::log10(energy); }
+}
+
+LoudnessMeter::LoudnessMeter(int sampleRate, int channels)
+    : sample_rate_(std::max(1, sampleRate))
+    , channels_(std::max(1, channels))
+    , state_(static_cast<size_t>(channels_))
+    , weights_(static_cast<size_t>(channels_), 1.0)
+    , hop_frames_(static_cast<size_t>(std::max(1, sample_rate_ / 10)))
+{
+    // K-weighting filter, designed for the actual sample rate (as in libebur128)
+    const double rate = static_cast<double>(sample_rate_);
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(PI * f0 / rate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        stages_[0] = { (vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0,
+                       (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+                       (1.0 - k / q + k * k) / a0 };
+    }
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(PI * f0 / rate);
+        const double a0 = 1.0 + k / q + k * k;
+        stages_[1] = { 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+    }
+
+    // 5.1 in FFmpeg order (FL FR FC LFE SL SR): LFE is ignored, surrounds weigh +1.5 dB
+    if (channels_ == 6) {
+        weights_[3] = 0.0;
+        weights_[4] = 1.41;
+        weights_[5] = 1.41;
+    }
+}
+
+void LoudnessMeter::addFloat(const float* samples, size_t frames)
+{
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t c = 0; c < static_cast<size_t>(channels_); ++c) {
+            addSample(c, static_cast<double>(*samples++));
+        }
+        finishFrame();
+    }
+}
+
+void LoudnessMeter::addS16(const int16_t* samples, size_t frames)
+{
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t c = 0; c < static_cast<size_t>(channels_); ++c) {
+            addSample(c, static_cast<double>(*samples++) / 32768.0);
+        }
+        finishFrame();
+    }
+}
+
+double LoudnessMeter::integratedLoudness() const
+{
+    const double absoluteGate = energyAt(SILENCE_LUFS);
+    double sum = 0.0;
+    size_t count = 0;
+    for (double block : blocks_) {
+        if (block > absoluteGate) {
+            sum += block;
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return SILENCE_LUFS;
+    }
+
+    const double relativeGate = energyAt(loudnessOf(sum / count) - 10.0);
+    double gatedSum = 0.0;
+    size_t gatedCount = 0;
+    for (double block : blocks_) {
+        if (block > absoluteGate && block > relativeGate) {
+            gatedSum += block;
+            ++gatedCount;
+        }
+    }
+    return gatedCount ? loudnessOf(gatedSum / gatedCount) : SILENCE_LUFS;
+}
+
+double LoudnessMeter::gainDb(double targetLufs) const
+{
+    const double loudness = integratedLoudness();
+    if (loudness <= SILENCE_LUFS) {
+        return 0.0;
+    }
+    double gain = targetLufs - loudness;
+    if (peak_ > 0.0) {
+        gain = std::min(gain, -20.0 * std::log10(peak_));
+    }
+    return gain;
+}
+
+/*************** Private Methods ***************/
+void LoudnessMeter::addSample(size_t channel, double value)
+{
+    peak_ = std::max(peak_, std::fabs(value));
+
+    ChannelState& st = state_[channel];
+    double y = value;
+    for (size_t s = 0; s < stages_.size(); ++s) {
+        const Biquad& f = stages_[s];
+        double out = f.b0 * y + st.z[s][0];
+        st.z[s][0] = f.b1 * y - f.a1 * out + st.z[s][1];
+        st.z[s][1] = f.b2 * y - f.a2 * out;
+        y = out;
+    }
+    hop_energy_ += weights_[channel] * y * y;
+}
+
+void LoudnessMeter::finishFrame()
+{
+    if (++hop_position_ < hop_frames_) {
+        return;
+    }
+    recent_hops_[hops_seen_ % recent_hops_.size()] = hop_energy_;
+    ++hops_seen_;
+    hop_position_ = 0;
+    hop_energy_ = 0.0;
+
+    if (hops_seen_ >= recent_hops_.size()) {
+        double block = 0.0;
+        for (double hop : recent_hops_) {
+            block += hop;
+        }
+        blocks_.push_back(block / static_cast<double>(hop_frames_ * recent_hops_.size()));
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio {
+
+/**
+ * @brief Integrated loudness (ITU-R BS.1770 / EBU R128) and sample peak of a PCM track.
+ *
+ * Samples are K-weighted per channel, summed into 400 ms gating blocks with a 100 ms hop,
+ * and the integrated loudness is the energy mean of the blocks above the absolute
+ * (-70 LUFS) and relative (-10 LU) gates. Feed the whole track through addFloat() or
+ * addS16() in interleaved order, then read the result. Not thread-safe; one meter per track.
+ */
+class LoudnessMeter {
+public:
+    // Loudness reported for tracks with no block above the absolute gate
+    static constexpr double SILENCE_LUFS = -70.0;
+    // Target loudness of normalized playback (ReplayGain 2.0 reference level)
+    static constexpr double REFERENCE_LUFS = -18.0;
+
+    LoudnessMeter(int sampleRate, int channels);
+
+    void addFloat(const float* samples, size_t frames);
+    void addS16(const int16_t* samples, size_t frames);
+
+    // Integrated loudness in LUFS; SILENCE_LUFS if nothing exceeded the absolute gate
+    double integratedLoudness() const;
+    // Largest absolute sample value seen, 1.0 = full scale
+    double samplePeak() const { return peak_; }
+
+    /**
+     * @brief Gain in dB that brings the track to targetLufs, reduced where needed so the
+     * amplified sample peak stays at or below full scale. 0 for silent tracks.
+     */
+    double gainDb(double targetLufs = REFERENCE_LUFS) const;
+
+private:
+    struct Biquad {
+        double b0, b1, b2, a1, a2;
+    };
+    struct ChannelState {
+        double z[2][2] = {{0.0, 0.0}, {0.0, 0.0}};   // direct form II transposed, per stage
+    };
+
+    void addSample(size_t channel, double value);
+    void finishFrame();
+
+    int sample_rate_;
+    int channels_;
+    std::array<Biquad, 2> stages_{};              // high shelf, then high pass
+    std::vector<ChannelState> state_;
+    std::vector<double> weights_;                 // BS.1770 channel weights
+    size_t hop_frames_;                           // 100 ms
+    size_t hop_position_ = 0;
+    double hop_energy_ = 0.0;                     // weighted sum over the current hop
+    std::array<double, 4> recent_hops_{};         // last four hops form one 400 ms block
+    size_t hops_seen_ = 0;
+    std::vector<double> blocks_;                  // mean square of every gating block
+    double peak_ = 0.0;
+};
+
+}
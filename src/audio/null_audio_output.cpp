@@ -0,0 +1,313 @@
+#include "null_audio_output.h"
+#include "sample_convert.h"
+#include <log/log_manager.h>
+
+namespace {
+    // How long the render thread sleeps when the source is empty or playback is paused
+    constexpr auto IDLE_WAIT = std::chrono::milliseconds(1);
+    // Reported free space in push mode: larger than any decoded frame
+    constexpr int PUSH_CAPACITY_BYTES = 1 << 24;
+}
+
+NullAudioOutput::NullAudioOutput() = default;
+
+NullAudioOutput::~NullAudioOutput()
+{
+    stopRenderThread();
+}
+
+bool NullAudioOutput::initialize(int sample_rate, int channels, int bits_per_sample, RenderMode mode)
+{
+    if (sample_rate <= 0 || channels <= 0 || (bits_per_sample != 16 && bits_per_sample != 32)) {
+        LOG_ERROR("NullAudioOutput: unsupported format {} Hz/{} ch/{} bit", sample_rate, channels, bits_per_sample);
+        return false;
+    }
+    stopRenderThread();
+    sample_rate_ = sample_rate;
+    channels_ = channels;
+    bits_per_sample_ = bits_per_sample;
+    render_mode_ = mode;
+    crossfade_.configure(sample_rate, channels, bits_per_sample);
+    frames_consumed_.store(0);
+    initialized_ = true;
+    return true;
+}
+
+void NullAudioOutput::playAudioData(const uint8_t* data, int size, int64_t pts_samples)
+{
+    if (!initialized_ || !playing_.load() || size <= 0) return;
+    if (render_mode_ == RenderMode::EventDriven) {
+        LOG_ERROR("NullAudioOutput: playAudioData is not available in event-driven render mode");
+        return;
+    }
+    consumeBlock(data, static_cast<size_t>(size), pts_samples);
+}
+
+bool NullAudioOutput::isInitialized() const
+{
+    return initialized_;
+}
+
+IAudioOutput::RenderMode NullAudioOutput::renderMode() const
+{
+    return render_mode_;
+}
+
+void NullAudioOutput::setFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained)
+{
+    stopRenderThread();
+    frame_source_ = std::move(source);
+    on_drained_ = std::move(onDrained);
+    drained_notified_ = false;
+    discard_until_discontinuity_ = false;
+    crossfade_.reset();
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    drained_ = false;
+}
+
+void NullAudioOutput::setNextFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained,
+                                         std::function<void()> onStarted)
+{
+    std::lock_guard<std::mutex> lock(next_source_mutex_);
+    next_frame_source_ = std::move(source);
+    next_on_drained_ = std::move(onDrained);
+    next_on_started_ = std::move(onStarted);
+}
+
+bool NullAudioOutput::clearNextFrameSource()
+{
+    std::lock_guard<std::mutex> lock(next_source_mutex_);
+    bool pending = next_frame_source_ != nullptr;
+    next_frame_source_.reset();
+    next_on_drained_ = nullptr;
+    next_on_started_ = nullptr;
+    return pending;
+}
+
+void NullAudioOutput::setCrossfadeDuration(int ms)
+{
+    crossfade_.setDurationMs(ms);
+}
+
+bool NullAudioOutput::start()
+{
+    if (!initialized_) return false;
+    playing_.store(true);
+    if (render_mode_ == RenderMode::EventDriven && !render_thread_.joinable()) {
+        render_thread_ = std::thread([this]() { this->renderThreadFunc(); });
+    }
+    return true;
+}
+
+bool NullAudioOutput::pause()
+{
+    if (!initialized_) return false;
+    playing_.store(false);
+    return true;
+}
+
+bool NullAudioOutput::stop()
+{
+    if (!initialized_) return false;
+    stopRenderThread();
+    playing_.store(false);
+    crossfade_.reset();
+    return true;
+}
+
+bool NullAudioOutput::isPlaying() const
+{
+    return playing_.load();
+}
+
+int NullAudioOutput::getAvailableCacheBytes() const
+{
+    return initialized_ ? PUSH_CAPACITY_BYTES : 0;
+}
+
+int NullAudioOutput::getCurrentFrames() const
+{
+    return 0;
+}
+
+int64_t NullAudioOutput::getCurrentPositionMs() const
+{
+    return position_ms_.load();
+}
+
+void NullAudioOutput::setPositionOffsetMs(int64_t positionMs)
+{
+    position_base_ms_ = positionMs;
+    track_frames_ = 0;
+    position_ms_.store(positionMs);
+}
+
+bool NullAudioOutput::flushForSeek(int64_t positionMs)
+{
+    if (!initialized_) return false;
+    const bool restart = render_thread_.joinable();
+    stopRenderThread();
+    if (render_mode_ == RenderMode::EventDriven) {
+        discard_until_discontinuity_ = true;
+    }
+    crossfade_.reset();
+    setPositionOffsetMs(positionMs);
+    if (restart) {
+        render_thread_ = std::thread([this]() { this->renderThreadFunc(); });
+    }
+    return true;
+}
+
+void NullAudioOutput::setVolume(float)
+{
+    // Output is discarded (or written bit-exact by subclasses), volume has no effect
+}
+
+void NullAudioOutput::setTelemetry(std::shared_ptr<audio::PlaybackTelemetry> telemetry)
+{
+    telemetry_ = std::move(telemetry);
+}
+
+void NullAudioOutput::setSpectrumTap(std::shared_ptr<audio::SpectrumTap> tap)
+{
+    spectrum_tap_ = std::move(tap);
+}
+
+double NullAudioOutput::secondsConsumed() const
+{
+    return sample_rate_ > 0 ? static_cast<double>(frames_consumed_.load()) / sample_rate_ : 0.0;
+}
+
+bool NullAudioOutput::waitForDrain(std::chrono::milliseconds timeout)
+{
+    std::unique_lock<std::mutex> lock(drain_mutex_);
+    return drain_cv_.wait_for(lock, timeout, [this]() { return drained_; });
+}
+
+void NullAudioOutput::consume(const uint8_t*, size_t)
+{
+}
+
+void NullAudioOutput::stopRenderThread()
+{
+    if (!render_thread_.joinable()) return;
+    render_exit_.store(true);
+    render_thread_.join();
+    render_exit_.store(false);
+}
+
+/*************** Private Methods ***************/
+void NullAudioOutput::renderThreadFunc()
+{
+    while (!render_exit_.load()) {
+        if (!consumeNextFrame()) {
+            std::this_thread::sleep_for(IDLE_WAIT);
+        }
+    }
+}
+
+bool NullAudioOutput::consumeNextFrame()
+{
+    if (!playing_.load() || !frame_source_) return false;
+
+    if (telemetry_) {
+        telemetry_->recordQueueDepth(frame_source_->size(), frame_source_->queuedDurationMs());
+    }
+    std::shared_ptr<AudioFrame> frame;
+    if (!frame_source_->tryPop(frame)) {
+        if (!frame_source_->closed() || !frame_source_->empty()) {
+            return false;  // Decoder hasn't caught up
+        }
+        if (switchToNextSource()) {
+            return true;
+        }
+        if (!drained_notified_) {
+            drained_notified_ = true;
+            if (on_drained_) {
+                on_drained_();
+            }
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            drained_ = true;
+            drain_cv_.notify_all();
+        }
+        return false;
+    }
+
+    if (discard_until_discontinuity_) {
+        if (!frame->discontinuity) {
+            return true;  // Decoded before the seek
+        }
+        discard_until_discontinuity_ = false;
+    }
+    const float gain = frame_source_->trackGain();
+    if (gain != 1.0f) {
+        audio::SampleConverter::applyGain(frame->data.data(), frame->data.size(), frame->bits_per_sample, gain);
+    }
+    if (crossfade_.durationMs() > 0 || crossfade_.active()) {
+        std::shared_ptr<AudioFrameQueue> next;
+        if (frame_source_->closed()) {
+            std::lock_guard<std::mutex> lock(next_source_mutex_);
+            next = next_frame_source_;
+        }
+        crossfade_.process(*frame, *frame_source_, next.get());
+    }
+    consumeBlock(frame->data.data(), frame->data.size(), frame->pts_samples);
+    return true;
+}
+
+void NullAudioOutput::consumeBlock(const uint8_t* data, size_t size, int64_t pts_samples)
+{
+    const size_t bytesPerFrame = static_cast<size_t>(channels_) * (bits_per_sample_ / 8);
+    const int64_t frames = static_cast<int64_t>(size / bytesPerFrame);
+    if (frames <= 0) return;
+
+    consume(data, size);
+    if (spectrum_tap_) {
+        spectrum_tap_->write(data, size, channels_, bits_per_sample_, sample_rate_);
+    }
+    frames_consumed_.fetch_add(static_cast<uint64_t>(frames));
+    if (telemetry_) {
+        // Never underruns: only the frame count is meaningful
+        telemetry_->recordDeviceWrite(0, 0, static_cast<uint64_t>(frames), false);
+    }
+
+    if (pts_samples >= 0) {
+        // PTS is relative to the track start, independent of any offset
+        position_base_ms_ = 0;
+        track_frames_ = pts_samples + frames;
+    } else {
+        track_frames_ += frames;
+    }
+    position_ms_.store(position_base_ms_ + track_frames_ * 1000 / sample_rate_);
+}
+
+bool NullAudioOutput::switchToNextSource()
+{
+    std::function<void()> onStarted;
+    {
+        std::lock_guard<std::mutex> lock(next_source_mutex_);
+        if (!next_frame_source_) return false;
+        frame_source_ = std::move(next_frame_source_);
+        on_drained_ = std::move(next_on_drained_);
+        onStarted = std::move(next_on_started_);
+        next_frame_source_.reset();
+        next_on_drained_ = nullptr;
+        next_on_started_ = nullptr;
+    }
+    drained_notified_ = false;
+    discard_until_discontinuity_ = false;
+    position_base_ms_ = 0;
+    track_frames_ = 0;
+    position_ms_.store(0);
+    if (onStarted) {
+        onStarted();
+    }
+    // The part of the next track the crossfade already overlapped has been consumed
+    size_t offset = 0;
+    if (auto carry = crossfade_.takeCarryOver(offset)) {
+        const size_t bytesPerFrame = static_cast<size_t>(channels_) * (bits_per_sample_ / 8);
+        int64_t pts = carry->pts_samples >= 0 ? carry->pts_samples + static_cast<int64_t>(offset / bytesPerFrame) : -1;
+        consumeBlock(carry->data.data() + offset, carry->data.size() - offset, pts);
+    }
+    return true;
+}
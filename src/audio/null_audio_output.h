@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "audio_output.h"
+#include "crossfade_mixer.h"
+
+/**
+ * NullAudioOutput - headless IAudioOutput that discards PCM as fast as it arrives.
+ *
+ * There is no device clock: a frame counts as played as soon as it has been consumed, so
+ * the pipeline runs faster than realtime. Used to measure decoder and pipeline throughput
+ * and to run playback tests without an audio device. Subclasses receive every consumed
+ * block through consume() (see WavFileAudioOutput).
+ *
+ * EventDriven mode runs a render thread that pops from the frame source until it is closed
+ * and drained, following setNextFrameSource() switches; Push mode consumes inside
+ * playAudioData(). Position, counters and waitForDrain() are thread-safe.
+ */
+class NullAudioOutput : public IAudioOutput
+{
+public:
+    NullAudioOutput();
+    ~NullAudioOutput() override;
+
+    bool initialize(int sample_rate, int channels, int bits_per_sample = 16,
+                    RenderMode mode = RenderMode::Push) override;
+    void playAudioData(const uint8_t* data, int size, int64_t pts_samples = -1) override;
+    bool isInitialized() const override;
+    RenderMode renderMode() const override;
+
+    void setFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained) override;
+    void setNextFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained,
+                            std::function<void()> onStarted) override;
+    bool clearNextFrameSource() override;
+    void setCrossfadeDuration(int ms) override;
+
+    bool start() override;
+    bool pause() override;
+    bool stop() override;
+    bool isPlaying() const override;
+    // Push mode never has to wait for space
+    int getAvailableCacheBytes() const override;
+    int getCurrentFrames() const override;
+    // End of the last consumed frame
+    int64_t getCurrentPositionMs() const override;
+    void setPositionOffsetMs(int64_t positionMs) override;
+    bool flushForSeek(int64_t positionMs) override;
+    void setVolume(float volume) override;
+    void setTelemetry(std::shared_ptr<audio::PlaybackTelemetry> telemetry) override;
+    void setSpectrumTap(std::shared_ptr<audio::SpectrumTap> tap) override;
+
+    // Sample frames consumed since initialize(), across track switches
+    uint64_t framesConsumed() const { return frames_consumed_.load(); }
+    double secondsConsumed() const;
+    // EventDriven mode: block until the current source (including any queued next source)
+    // is closed and drained; false on timeout
+    bool waitForDrain(std::chrono::milliseconds timeout);
+
+protected:
+    // Called with each consumed PCM block, in the format given to initialize()
+    virtual void consume(const uint8_t* data, size_t size);
+    int sampleRate() const { return sample_rate_; }
+    int channels() const { return channels_; }
+    int bitsPerSample() const { return bits_per_sample_; }
+
+    // EventDriven subclasses must call this first in their destructor: the render thread
+    // calls consume() until it is stopped
+    void stopRenderThread();
+
+private:
+    void renderThreadFunc();
+    // Returns false when there is nothing to consume right now
+    bool consumeNextFrame();
+    void consumeBlock(const uint8_t* data, size_t size, int64_t pts_samples);
+    bool switchToNextSource();
+
+    bool initialized_ = false;
+    RenderMode render_mode_ = RenderMode::Push;
+    int sample_rate_ = 0;
+    int channels_ = 0;
+    int bits_per_sample_ = 0;
+    std::atomic<bool> playing_{false};
+    std::shared_ptr<audio::PlaybackTelemetry> telemetry_;
+    std::shared_ptr<audio::SpectrumTap> spectrum_tap_;
+
+    // Render thread (EventDriven)
+    std::thread render_thread_;
+    std::atomic<bool> render_exit_{false};
+    std::shared_ptr<AudioFrameQueue> frame_source_;
+    std::function<void()> on_drained_;
+    bool drained_notified_ = false;
+    bool discard_until_discontinuity_ = false;
+    std::mutex next_source_mutex_;
+    std::shared_ptr<AudioFrameQueue> next_frame_source_;
+    std::function<void()> next_on_drained_;
+    std::function<void()> next_on_started_;
+    audio::CrossfadeMixer crossfade_;
+
+    // Position: track frames consumed since position_base_ms_, or since the track start once
+    // frames carry a PTS. Written by the consuming thread only (or while it is stopped).
+    int64_t position_base_ms_ = 0;
+    int64_t track_frames_ = 0;
+    std::atomic<int64_t> position_ms_{0};
+    std::atomic<uint64_t> frames_consumed_{0};
+
+    std::mutex drain_mutex_;
+    std::condition_variable drain_cv_;
+    bool drained_ = false;
+};
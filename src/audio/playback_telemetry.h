@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace audio {
+/**
+ * @brief Lock-free glitch counters shared by the decoder, the output and the controller.
+ *
+ * Every recorder is a relaxed atomic update, so the render and decode threads can count
+ * without locks, logging or allocation. snapshot() may be taken from any thread; counters
+ * are read individually, which is good enough for diagnostics.
+ *
+ * Telling the causes apart: underruns with a high decoderStallUs and networkWaitUs point at
+ * the network; a high decoderStallUs with low networkWaitUs at the decoder; underruns or late
+ * writes while both stay flat (and the queue is deep) at the device or the render thread.
+ */
+class PlaybackTelemetry {
+public:
+    struct Snapshot {
+        uint64_t bufferUnderruns = 0;     // Device buffer found empty on a write: audible gap
+        uint64_t lateWrites = 0;          // Written with less than a quarter of the device buffer left
+        uint64_t framesQueued = 0;        // Device frames handed to the output
+        uint64_t maxQueueDepthFrames = 0; // Deepest decoder -> output queue seen by the consumer
+        int64_t maxQueueDepthMs = 0;
+        uint64_t decoderStallUs = 0;      // Decoder blocked in readPacket waiting for input bytes
+        uint64_t networkWaitUs = 0;       // Stream reader blocked reading the input stream
+        // Timer ticks and polls of the whole process (util::IdleMode), averaged over the
+        // last few seconds; filled in by AudioPlayerController, not reset()
+        double wakeupsPerSecond = 0.0;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // Output side: `queuedFrames` device frames were still buffered when a write of
+    // `writtenFrames` began, out of a buffer holding `bufferFrames`. The first write after
+    // start or a flush (`primed` false) always finds the buffer empty and isn't classified.
+    void recordDeviceWrite(uint64_t queuedFrames, uint64_t bufferFrames, uint64_t writtenFrames, bool primed) {
+        if (!primed) {
+            // Nothing was playing yet
+        } else if (queuedFrames == 0) {
+            bufferUnderruns_.fetch_add(1, std::memory_order_relaxed);
+        } else if (queuedFrames < bufferFrames / 4) {
+            lateWrites_.fetch_add(1, std::memory_order_relaxed);
+        }
+        framesQueued_.fetch_add(writtenFrames, std::memory_order_relaxed);
+    }
+
+    // Consumer side, on every frame popped from the decoder -> output queue
+    void recordQueueDepth(uint64_t frames, int64_t ms) {
+        raiseTo(maxQueueDepthFrames_, frames);
+        raiseTo(maxQueueDepthMs_, ms);
+    }
+
+    void addDecoderStall(Clock::duration waited) {
+        decoderStallUs_.fetch_add(toUs(waited), std::memory_order_relaxed);
+    }
+
+    void addNetworkWait(Clock::duration waited) {
+        networkWaitUs_.fetch_add(toUs(waited), std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        s.bufferUnderruns = bufferUnderruns_.load(std::memory_order_relaxed);
+        s.lateWrites = lateWrites_.load(std::memory_order_relaxed);
+        s.framesQueued = framesQueued_.load(std::memory_order_relaxed);
+        s.maxQueueDepthFrames = maxQueueDepthFrames_.load(std::memory_order_relaxed);
+        s.maxQueueDepthMs = maxQueueDepthMs_.load(std::memory_order_relaxed);
+        s.decoderStallUs = decoderStallUs_.load(std::memory_order_relaxed);
+        s.networkWaitUs = networkWaitUs_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset() {
+        bufferUnderruns_.store(0, std::memory_order_relaxed);
+        lateWrites_.store(0, std::memory_order_relaxed);
+        framesQueued_.store(0, std::memory_order_relaxed);
+        maxQueueDepthFrames_.store(0, std::memory_order_relaxed);
+        maxQueueDepthMs_.store(0, std::memory_order_relaxed);
+        decoderStallUs_.store(0, std::memory_order_relaxed);
+        networkWaitUs_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    template <typename T>
+    static void raiseTo(std::atomic<T>& target, T value) {
+        T current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    static uint64_t toUs(Clock::duration d) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        return us > 0 ? static_cast<uint64_t>(us) : 0;
+    }
+
+    std::atomic<uint64_t> bufferUnderruns_{0};
+    std::atomic<uint64_t> lateWrites_{0};
+    std::atomic<uint64_t> framesQueued_{0};
+    std::atomic<uint64_t> maxQueueDepthFrames_{0};
+    std::atomic<int64_t> maxQueueDepthMs_{0};
+    std::atomic<uint64_t> decoderStallUs_{0};
+    std::atomic<uint64_t> networkWaitUs_{0};
+};
+} // namespace audio
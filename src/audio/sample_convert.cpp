@@ -0,0 +1,467 @@
+#include "sample_convert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SAMPLE_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SAMPLE_CONVERT_AVX2_FN
+#else
+#include <cpuid.h>
+#define SAMPLE_CONVERT_AVX2_FN __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace audio
+{
+namespace
+{
+    constexpr float kS16ToF32Scale = 1.0f / 32768.0f;
+    constexpr float kF32ToS16Scale = 32768.0f;
+
+    // ---------------- Scalar reference kernels ----------------
+
+    void s16ToF32Scalar(const int16_t* in, float* out, size_t samples)
+    {
+        for (size_t i = 0; i < samples; ++i) {
+            out[i] = static_cast<float>(in[i]) * kS16ToF32Scale;
+        }
+    }
+
+    void f32ToS16Scalar(const float* in, int16_t* out, size_t samples)
+    {
+        for (size_t i = 0; i < samples; ++i) {
+            float v = std::min(1.0f, std::max(-1.0f, in[i])) * kF32ToS16Scale;
+            long r = std::lrint(v);
+            out[i] = static_cast<int16_t>(std::min(32767L, std::max(-32768L, r)));
+        }
+    }
+
+    void monoToStereoScalar(const float* in, float* out, size_t frames)
+    {
+        for (size_t i = 0; i < frames; ++i) {
+            out[2 * i] = in[i];
+            out[2 * i + 1] = in[i];
+        }
+    }
+
+    void stereoToMonoScalar(const float* in, float* out, size_t frames)
+    {
+        for (size_t i = 0; i < frames; ++i) {
+            out[i] = (in[2 * i] + in[2 * i + 1]) * 0.5f;
+        }
+    }
+
+    void crossfadeScalar(const float* from, const float* to, float* out, size_t samples,
+                         float gain, float gainStep, size_t first = 0)
+    {
+        for (size_t i = first; i < samples; ++i) {
+            float g = gain + static_cast<float>(i) * gainStep;
+            float target = to ? to[i] : 0.0f;
+            out[i] = from[i] + (target - from[i]) * g;
+        }
+    }
+
+    void applyGainF32Scalar(float* samples, size_t count, float gain, size_t first = 0)
+    {
+        for (size_t i = first; i < count; ++i) {
+            samples[i] *= gain;
+        }
+    }
+
+    void applyGainS16Scalar(int16_t* samples, size_t count, float gain, size_t first = 0)
+    {
+        for (size_t i = first; i < count; ++i) {
+            long r = std::lrint(static_cast<float>(samples[i]) * gain);
+            samples[i] = static_cast<int16_t>(std::min(32767L, std::max(-32768L, r)));
+        }
+    }
+
+#ifdef SAMPLE_CONVERT_X86
+    // ---------------- SSE2 kernels (baseline on x64) ----------------
+
+    void s16ToF32SSE2(const int16_t* in, float* out, size_t samples)
+    {
+        const __m128 scale = _mm_set1_ps(kS16ToF32Scale);
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            // Sign-extend by placing each int16 in the high half and shifting back down
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+        s16ToF32Scalar(in + i, out + i, samples - i);
+    }
+
+    void f32ToS16SSE2(const float* in, int16_t* out, size_t samples)
+    {
+        const __m128 scale = _mm_set1_ps(kF32ToS16Scale);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 minusOne = _mm_set1_ps(-1.0f);
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            __m128 a = _mm_min_ps(one, _mm_max_ps(minusOne, _mm_loadu_ps(in + i)));
+            __m128 b = _mm_min_ps(one, _mm_max_ps(minusOne, _mm_loadu_ps(in + i + 4)));
+            __m128i ia = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+            __m128i ib = _mm_cvtps_epi32(_mm_mul_ps(b, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(ia, ib));
+        }
+        f32ToS16Scalar(in + i, out + i, samples - i);
+    }
+
+    void monoToStereoSSE2(const float* in, float* out, size_t frames)
+    {
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4) {
+            __m128 v = _mm_loadu_ps(in + i);
+            _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(v, v));
+            _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(v, v));
+        }
+        monoToStereoScalar(in + i, out + 2 * i, frames - i);
+    }
+
+    void stereoToMonoSSE2(const float* in, float* out, size_t frames)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        size_t i = 0;
+        for (; i + 4 <= frames; i += 4) {
+            __m128 a = _mm_loadu_ps(in + 2 * i);
+            __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+        stereoToMonoScalar(in + 2 * i, out + i, frames - i);
+    }
+
+    void crossfadeSSE2(const float* from, const float* to, float* out, size_t samples,
+                       float gain, float gainStep)
+    {
+        const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 g0 = _mm_set1_ps(gain);
+        const __m128 step = _mm_set1_ps(gainStep);
+        size_t i = 0;
+        for (; i + 4 <= samples; i += 4) {
+            // Index is exact in float for any realistic buffer, so this matches the scalar ramp
+            __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+            __m128 g = _mm_add_ps(g0, _mm_mul_ps(index, step));
+            __m128 a = _mm_loadu_ps(from + i);
+            __m128 b = to ? _mm_loadu_ps(to + i) : _mm_setzero_ps();
+            _mm_storeu_ps(out + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), g)));
+        }
+        crossfadeScalar(from, to, out, samples, gain, gainStep, i);
+    }
+
+    void applyGainF32SSE2(float* samples, size_t count, float gain)
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+        }
+        applyGainF32Scalar(samples, count, gain, i);
+    }
+
+    void applyGainS16SSE2(int16_t* samples, size_t count, float gain)
+    {
+        const __m128 g = _mm_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            // Round to nearest like lrint, then pack with saturation
+            __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), g));
+            __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), g));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), _mm_packs_epi32(a, b));
+        }
+        applyGainS16Scalar(samples, count, gain, i);
+    }
+
+    // ---------------- AVX2 kernels (runtime-selected) ----------------
+
+    SAMPLE_CONVERT_AVX2_FN void s16ToF32AVX2(const int16_t* in, float* out, size_t samples)
+    {
+        const __m256 scale = _mm256_set1_ps(kS16ToF32Scale);
+        size_t i = 0;
+        for (; i + 16 <= samples; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+            _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+        }
+        s16ToF32Scalar(in + i, out + i, samples - i);
+    }
+
+    SAMPLE_CONVERT_AVX2_FN void f32ToS16AVX2(const float* in, int16_t* out, size_t samples)
+    {
+        const __m256 scale = _mm256_set1_ps(kF32ToS16Scale);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 minusOne = _mm256_set1_ps(-1.0f);
+        size_t i = 0;
+        for (; i + 16 <= samples; i += 16) {
+            __m256 a = _mm256_min_ps(one, _mm256_max_ps(minusOne, _mm256_loadu_ps(in + i)));
+            __m256 b = _mm256_min_ps(one, _mm256_max_ps(minusOne, _mm256_loadu_ps(in + i + 8)));
+            __m256i ia = _mm256_cvtps_epi32(_mm256_mul_ps(a, scale));
+            __m256i ib = _mm256_cvtps_epi32(_mm256_mul_ps(b, scale));
+            // packs works per 128-bit lane; restore sample order afterwards
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+        }
+        f32ToS16Scalar(in + i, out + i, samples - i);
+    }
+
+    SAMPLE_CONVERT_AVX2_FN void monoToStereoAVX2(const float* in, float* out, size_t frames)
+    {
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            __m256 v = _mm256_loadu_ps(in + i);
+            __m256 lo = _mm256_unpacklo_ps(v, v);
+            __m256 hi = _mm256_unpackhi_ps(v, v);
+            _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+        monoToStereoScalar(in + i, out + 2 * i, frames - i);
+    }
+
+    SAMPLE_CONVERT_AVX2_FN void stereoToMonoAVX2(const float* in, float* out, size_t frames)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        size_t i = 0;
+        for (; i + 8 <= frames; i += 8) {
+            __m256 a = _mm256_loadu_ps(in + 2 * i);
+            __m256 b = _mm256_loadu_ps(in + 2 * i + 8);
+            __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 mono = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+            // shuffle_ps interleaves the two lanes; put 64-bit pairs back in order
+            mono = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mono), 0xD8));
+            _mm256_storeu_ps(out + i, mono);
+        }
+        stereoToMonoScalar(in + 2 * i, out + i, frames - i);
+    }
+
+    SAMPLE_CONVERT_AVX2_FN void crossfadeAVX2(const float* from, const float* to, float* out, size_t samples,
+                                              float gain, float gainStep)
+    {
+        const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 g0 = _mm256_set1_ps(gain);
+        const __m256 step = _mm256_set1_ps(gainStep);
+        size_t i = 0;
+        for (; i + 8 <= samples; i += 8) {
+            __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes);
+            __m256 g = _mm256_add_ps(g0, _mm256_mul_ps(index, step));
+            __m256 a = _mm256_loadu_ps(from + i);
+            __m256 b = to ? _mm256_loadu_ps(to + i) : _mm256_setzero_ps();
+            _mm256_storeu_ps(out + i, _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), g)));
+        }
+        crossfadeScalar(from, to, out, samples, gain, gainStep, i);
+    }
+
+    SAMPLE_CONVERT_AVX2_FN void applyGainF32AVX2(float* samples, size_t count, float gain)
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+        }
+        applyGainF32Scalar(samples, count, gain, i);
+    }
+
+    SAMPLE_CONVERT_AVX2_FN void applyGainS16AVX2(int16_t* samples, size_t count, float gain)
+    {
+        const __m256 g = _mm256_set1_ps(gain);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i + 8));
+            __m256i ia = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), g));
+            __m256i ib = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), g));
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(ia, ib), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i), packed);
+        }
+        applyGainS16Scalar(samples, count, gain, i);
+    }
+
+    bool cpuSupportsAvx2()
+    {
+#if defined(_MSC_VER)
+        int info[4] = {0};
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx) return false;
+        // OS must save YMM state
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif // SAMPLE_CONVERT_X86
+
+    SampleConverter::Isa detectIsa()
+    {
+#ifdef SAMPLE_CONVERT_X86
+        if (cpuSupportsAvx2()) {
+            return SampleConverter::Isa::AVX2;
+        }
+        return SampleConverter::Isa::SSE2;
+#else
+        return SampleConverter::Isa::Scalar;
+#endif
+    }
+
+    SampleConverter::Isa supportedIsa()
+    {
+        static const SampleConverter::Isa isa = detectIsa();
+        return isa;
+    }
+
+    std::atomic<int> g_activeIsa{-1};
+
+    SampleConverter::Isa currentIsa()
+    {
+        int isa = g_activeIsa.load(std::memory_order_relaxed);
+        if (isa < 0) {
+            isa = static_cast<int>(supportedIsa());
+            g_activeIsa.store(isa, std::memory_order_relaxed);
+        }
+        return static_cast<SampleConverter::Isa>(isa);
+    }
+} // namespace
+
+void SampleConverter::s16ToF32(const int16_t* in, float* out, size_t samples)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: s16ToF32AVX2(in, out, samples); return;
+    case Isa::SSE2: s16ToF32SSE2(in, out, samples); return;
+#endif
+    default: s16ToF32Scalar(in, out, samples); return;
+    }
+}
+
+void SampleConverter::f32ToS16(const float* in, int16_t* out, size_t samples)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: f32ToS16AVX2(in, out, samples); return;
+    case Isa::SSE2: f32ToS16SSE2(in, out, samples); return;
+#endif
+    default: f32ToS16Scalar(in, out, samples); return;
+    }
+}
+
+void SampleConverter::monoToStereoF32(const float* in, float* out, size_t frames)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: monoToStereoAVX2(in, out, frames); return;
+    case Isa::SSE2: monoToStereoSSE2(in, out, frames); return;
+#endif
+    default: monoToStereoScalar(in, out, frames); return;
+    }
+}
+
+void SampleConverter::stereoToMonoF32(const float* in, float* out, size_t frames)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: stereoToMonoAVX2(in, out, frames); return;
+    case Isa::SSE2: stereoToMonoSSE2(in, out, frames); return;
+#endif
+    default: stereoToMonoScalar(in, out, frames); return;
+    }
+}
+
+void SampleConverter::crossfadeF32(const float* from, const float* to, float* out, size_t samples,
+                                   float gain, float gainStep)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: crossfadeAVX2(from, to, out, samples, gain, gainStep); return;
+    case Isa::SSE2: crossfadeSSE2(from, to, out, samples, gain, gainStep); return;
+#endif
+    default: crossfadeScalar(from, to, out, samples, gain, gainStep); return;
+    }
+}
+
+void SampleConverter::applyGainF32(float* samples, size_t count, float gain)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: applyGainF32AVX2(samples, count, gain); return;
+    case Isa::SSE2: applyGainF32SSE2(samples, count, gain); return;
+#endif
+    default: applyGainF32Scalar(samples, count, gain); return;
+    }
+}
+
+void SampleConverter::applyGainS16(int16_t* samples, size_t count, float gain)
+{
+    switch (currentIsa()) {
+#ifdef SAMPLE_CONVERT_X86
+    case Isa::AVX2: applyGainS16AVX2(samples, count, gain); return;
+    case Isa::SSE2: applyGainS16SSE2(samples, count, gain); return;
+#endif
+    default: applyGainS16Scalar(samples, count, gain); return;
+    }
+}
+
+void SampleConverter::applyGain(uint8_t* pcm, size_t bytes, int bitsPerSample, float gain)
+{
+    if (bitsPerSample == 32) {
+        applyGainF32(reinterpret_cast<float*>(pcm), bytes / sizeof(float), gain);
+    } else if (bitsPerSample == 16) {
+        applyGainS16(reinterpret_cast<int16_t*>(pcm), bytes / sizeof(int16_t), gain);
+    }
+}
+
+std::vector<int> SampleConverter::buildChannelMap(int inputChannels, int outputChannels)
+{
+    std::vector<int> map(static_cast<size_t>(std::max(0, outputChannels)), -1);
+    for (int ch = 0; ch < outputChannels; ++ch) {
+        if (ch < inputChannels) {
+            map[ch] = ch;
+        } else if (inputChannels == 1) {
+            map[ch] = 0;
+        }
+    }
+    return map;
+}
+
+void SampleConverter::remapChannelsF32(const float* in, int inputChannels,
+                                       float* out, const std::vector<int>& channelMap, size_t frames)
+{
+    const size_t outputChannels = channelMap.size();
+    for (size_t frame = 0; frame < frames; ++frame) {
+        const float* src = in + frame * inputChannels;
+        float* dst = out + frame * outputChannels;
+        for (size_t ch = 0; ch < outputChannels; ++ch) {
+            int from = channelMap[ch];
+            dst[ch] = from >= 0 ? src[from] : 0.0f;
+        }
+    }
+}
+
+SampleConverter::Isa SampleConverter::activeIsa()
+{
+    return currentIsa();
+}
+
+void SampleConverter::setIsa(Isa isa)
+{
+    Isa clamped = static_cast<int>(isa) > static_cast<int>(supportedIsa()) ? supportedIsa() : isa;
+    g_activeIsa.store(static_cast<int>(clamped), std::memory_order_relaxed);
+}
+}
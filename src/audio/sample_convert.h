@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace audio
+{
+    /**
+     * @brief Vectorized PCM sample-format kernels used by the output layer
+     *
+     * Every kernel has a scalar reference implementation plus SSE2 and AVX2
+     * variants. The fastest variant supported by the running CPU is chosen once,
+     * on first use; results are identical across variants.
+     *
+     * All counts are in samples (interleaved values), except the channel
+     * up/down-mix kernels which take a frame count.
+     */
+    class SampleConverter
+    {
+    public:
+        enum class Isa {
+            Scalar = 0,
+            SSE2 = 1,
+            AVX2 = 2
+        };
+
+        // int16 [-32768, 32767] -> float [-1.0, 1.0)
+        static void s16ToF32(const int16_t* in, float* out, size_t samples);
+        // float -> int16 with rounding and saturation
+        static void f32ToS16(const float* in, int16_t* out, size_t samples);
+        // Duplicate each mono sample into an interleaved stereo pair
+        static void monoToStereoF32(const float* in, float* out, size_t frames);
+        // Average each interleaved stereo pair into one mono sample
+        static void stereoToMonoF32(const float* in, float* out, size_t frames);
+
+        /**
+         * @brief Linear crossfade with a per-sample gain ramp
+         *
+         * out[i] = from[i] + (to[i] - from[i]) * (gain + i * gainStep), i.e. `from` fades
+         * out while `to` fades in. A null `to` fades `from` out to silence. `out` may
+         * alias `from`.
+         */
+        static void crossfadeF32(const float* from, const float* to, float* out, size_t samples,
+                                 float gain, float gainStep);
+
+        // Scale samples in place by a constant gain; the int16 variant rounds and saturates
+        static void applyGainF32(float* samples, size_t count, float gain);
+        static void applyGainS16(int16_t* samples, size_t count, float gain);
+        // Dispatch on the PCM layout (16-bit or float); other layouts are left unchanged
+        static void applyGain(uint8_t* pcm, size_t bytes, int bitsPerSample, float gain);
+
+        /**
+         * @brief Build an output->input channel table for interleaved remapping
+         *
+         * Output channels map 1:1 while input channels exist; extra output channels
+         * repeat the last mapped input channel for mono sources (so mono plays on
+         * every speaker) and are silent (-1) otherwise.
+         */
+        static std::vector<int> buildChannelMap(int inputChannels, int outputChannels);
+
+        // Generic interleaved remap of float frames through a channel table (-1 = silence)
+        static void remapChannelsF32(const float* in, int inputChannels,
+                                     float* out, const std::vector<int>& channelMap, size_t frames);
+
+        // Variant selected for this process (exposed for logging and tests)
+        static Isa activeIsa();
+
+        // Force a variant (tests/benchmarks only); requests above CPU support are clamped
+        static void setIsa(Isa isa);
+    };
+}
@@ -0,0 +1,200 @@
+#include "spectrum_analyzer.h"
+#include <log/log_manager.h>
+#include <util/idle_mode.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/tx.h>
+}
+
+namespace audio {
+
+namespace {
+    constexpr double PI = 3.14159265358979323846;
+    // Per update, how far a band may drop when the signal gets quieter (full range in ~0.8 s)
+    constexpr float BAND_FALL_PER_UPDATE = 0.04f;
+
+    double bandEdgeHz(int edge, int sampleRate)
+    {
+        const double top = std::min(SpectrumAnalyzer::MAX_FREQUENCY_HZ, sampleRate / 2.0);
+        const double ratio = top / SpectrumAnalyzer::MIN_FREQUENCY_HZ;
+        return SpectrumAnalyzer::MIN_FREQUENCY_HZ
+            * std::pow(ratio, static_cast<double>(edge) / SpectrumAnalyzer::BAND_COUNT);
+    }
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(std::shared_ptr<SpectrumTap> tap, QObject* parent)
+    : QObject(parent)
+    , tap_(std::move(tap))
+    , window_(FFT_SIZE)
+    , history_(FFT_SIZE, 0.0f)
+    , scratch_(SpectrumTap::CAPACITY)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < FFT_SIZE; ++i) {
+        window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * PI * i / (FFT_SIZE - 1)));
+        sum += window_[i];
+    }
+    window_gain_ = sum;
+
+    const float scale = 1.0f;
+    av_tx_fn fn = nullptr;
+    int ret = av_tx_init(&tx_ctx_, &fn, AV_TX_FLOAT_RDFT, 0, FFT_SIZE, &scale, 0);
+    fft_in_ = static_cast<float*>(av_malloc(sizeof(float) * FFT_SIZE));
+    fft_out_ = static_cast<float*>(av_malloc(sizeof(AVComplexFloat) * (FFT_SIZE / 2 + 1)));
+    if (ret < 0 || !fft_in_ || !fft_out_) {
+        LOG_ERROR("SpectrumAnalyzer: failed to set up a {}-point FFT ({})", FFT_SIZE, ret);
+        av_tx_uninit(&tx_ctx_);
+        fn = nullptr;
+    }
+    tx_fn_ = fn;
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+    av_tx_uninit(&tx_ctx_);
+    av_free(fft_in_);
+    av_free(fft_out_);
+}
+
+void SpectrumAnalyzer::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_.load() || !tap_ || !tx_fn_) return;
+    running_.store(true);
+    tap_->setEnabled(true);
+    worker_ = std::thread([this]() { workerLoop(); });
+}
+
+void SpectrumAnalyzer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load()) return;
+        running_.store(false);
+        if (tap_) {
+            tap_->setEnabled(false);
+        }
+    }
+    stop_cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SpectrumAnalyzer::setSuspended(bool suspended)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        suspended_ = suspended;
+    }
+    stop_cv_.notify_all();
+}
+
+bool SpectrumAnalyzer::isParked() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return parked_;
+}
+
+bool SpectrumAnalyzer::update(std::vector<float>& bands)
+{
+    if (!tap_ || !tx_fn_) return false;
+    const size_t got = tap_->read(scratch_.data(), scratch_.size());
+    const int sampleRate = tap_->sampleRate();
+    if (got == 0 || sampleRate <= 0) return false;
+
+    // Slide the window forward by the new samples
+    const size_t keep = got >= history_.size() ? 0 : history_.size() - got;
+    std::move(history_.end() - keep, history_.end(), history_.begin());
+    const size_t take = history_.size() - keep;
+    std::copy(scratch_.begin() + (got - take), scratch_.begin() + got, history_.begin() + keep);
+
+    for (int i = 0; i < FFT_SIZE; ++i) {
+        fft_in_[i] = history_[i] * window_[i];
+    }
+    tx_fn_(tx_ctx_, fft_out_, fft_in_, sizeof(float));
+
+    // A full-scale sine peaks at amplitude 1 (0 dB) in its bin
+    const AVComplexFloat* bins = reinterpret_cast<const AVComplexFloat*>(fft_out_);
+    const int binCount = FFT_SIZE / 2 + 1;
+    const double binHz = static_cast<double>(sampleRate) / FFT_SIZE;
+    const float norm = 2.0f / window_gain_;
+    bands.assign(BAND_COUNT, 0.0f);
+    for (int band = 0; band < BAND_COUNT; ++band) {
+        int first = static_cast<int>(std::ceil(bandEdgeHz(band, sampleRate) / binHz));
+        int last = static_cast<int>(std::floor(bandEdgeHz(band + 1, sampleRate) / binHz));
+        if (last < first) {
+            // Narrower than a bin: use the bin nearest to the band center
+            first = last = static_cast<int>(std::lround(bandCenterHz(band, sampleRate) / binHz));
+        }
+        first = std::clamp(first, 0, binCount - 1);
+        last = std::clamp(last, 0, binCount - 1);
+
+        float peak = 0.0f;
+        for (int b = first; b <= last; ++b) {
+            peak = std::max(peak, std::hypot(bins[b].re, bins[b].im) * norm);
+        }
+        const double db = peak > 0.0f ? 20.0 * std::log10(peak) : MIN_DB;
+        bands[band] = static_cast<float>(std::clamp((db - MIN_DB) / -MIN_DB, 0.0, 1.0));
+    }
+    return true;
+}
+
+double SpectrumAnalyzer::bandCenterHz(int band, int sampleRate)
+{
+    return std::sqrt(bandEdgeHz(band, sampleRate) * bandEdgeHz(band + 1, sampleRate));
+}
+
+/*************** Private Methods ***************/
+void SpectrumAnalyzer::workerLoop()
+{
+    std::vector<float> bands;
+    QVector<float> shown(BAND_COUNT, 0.0f);
+    bool idle = true;
+    auto next = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_.load()) {
+        next += std::chrono::milliseconds(UPDATE_INTERVAL_MS);
+        if (stop_cv_.wait_until(lock, next, [this]() { return !running_.load(); })) {
+            break;
+        }
+        lock.unlock();
+        util::IdleMode::recordWakeup();
+
+        const bool fresh = update(bands);
+        bool changed = false;
+        for (int band = 0; band < BAND_COUNT; ++band) {
+            float target = fresh ? bands[band] : 0.0f;
+            float value = std::max(target, shown[band] - BAND_FALL_PER_UPDATE);
+            value = std::max(value, 0.0f);
+            changed = changed || value != shown[band];
+            shown[band] = value;
+        }
+        // Nothing to redraw once the bars have fallen to zero
+        if (changed || !idle) {
+            emit spectrumUpdated(shown);
+        }
+        idle = !changed;
+
+        lock.lock();
+        if (suspended_ && idle) {
+            // Bars are down; nothing to draw until playback or the window comes back
+            parked_ = true;
+            stop_cv_.wait(lock, [this]() { return !running_.load() || !suspended_; });
+            parked_ = false;
+        }
+        // Don't try to catch up after a stall; keep the fixed rate from now on
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now;
+        }
+    }
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "spectrum_tap.h"
+
+struct AVTXContext;
+
+namespace audio {
+
+/**
+ * @brief Turns the samples collected by a SpectrumTap into visualizer bands.
+ *
+ * A worker thread wakes every UPDATE_INTERVAL_MS, takes whatever the render thread left
+ * in the tap, and runs a Hann-windowed real FFT (FFmpeg av_tx, which picks SIMD kernels
+ * at runtime) over the latest FFT_SIZE samples. The bins are folded into BAND_COUNT
+ * log-spaced bands scaled to 0..1 (MIN_DB..0 dBFS) and published through
+ * spectrumUpdated(), which reaches UI slots as a queued signal. Bands fall back smoothly
+ * once playback stops feeding the tap. A suspended worker stops waking once they reach
+ * zero, until it is resumed.
+ */
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int FFT_SIZE = 2048;
+    static constexpr int BAND_COUNT = 32;
+    static constexpr int UPDATE_INTERVAL_MS = 33;
+    static constexpr double MIN_DB = -90.0;
+    static constexpr double MIN_FREQUENCY_HZ = 40.0;
+    static constexpr double MAX_FREQUENCY_HZ = 16000.0;
+
+    explicit SpectrumAnalyzer(std::shared_ptr<SpectrumTap> tap, QObject* parent = nullptr);
+    ~SpectrumAnalyzer();
+
+    SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
+    SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
+
+    // Enable the tap and start the worker; no-op if running
+    void start();
+    // Stop the worker and disable the tap, so the render path skips the copy
+    void stop();
+    bool isRunning() const { return running_.load(); }
+    // Park the worker once the bands have fallen to zero (idle mode); false wakes it at once
+    void setSuspended(bool suspended);
+    // Whether the worker is parked by setSuspended(), waking for nothing but resume or stop
+    bool isParked() const;
+
+    /**
+     * @brief Pull new samples from the tap and compute the spectrum of the latest window.
+     * Called by the worker; exposed for tests (don't call it while the worker runs).
+     * @return false if the tap had no new samples (bands untouched)
+     */
+    bool update(std::vector<float>& bands);
+    // Geometric center of a band for the given sample rate
+    static double bandCenterHz(int band, int sampleRate);
+
+signals:
+    void spectrumUpdated(const QVector<float>& bands);
+
+private:
+    void workerLoop();
+
+    std::shared_ptr<SpectrumTap> tap_;
+    // Used by update() only
+    AVTXContext* tx_ctx_ = nullptr;
+    void (*tx_fn_)(AVTXContext*, void*, void*, ptrdiff_t) = nullptr;
+    float* fft_in_ = nullptr;                 // av_malloc'ed, FFT_SIZE floats
+    float* fft_out_ = nullptr;                // FFT_SIZE / 2 + 1 complex values
+    std::vector<float> window_;
+    std::vector<float> history_;              // Latest FFT_SIZE samples, oldest first
+    std::vector<float> scratch_;
+    float window_gain_ = 1.0f;                // Sum of the window, normalizes amplitudes
+
+    std::atomic<bool> running_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable stop_cv_;         // Stop, or resume a suspended worker
+    bool suspended_ = false;                  // Guarded by mutex_
+    bool parked_ = false;                     // Guarded by mutex_
+    std::thread worker_;
+};
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio {
+/**
+ * @brief Lock-free, drop-on-full copy of the rendered PCM for a visualizer.
+ *
+ * The output's render thread write()s every block it hands to the device; the samples are
+ * mixed down to mono float and stored in a single-producer/single-consumer ring. When the
+ * reader (SpectrumAnalyzer) falls behind the excess is dropped and counted, so the render
+ * thread never waits, locks or allocates. While disabled write() returns immediately.
+ *
+ * Exactly one thread may write (the output currently rendering) and one may read.
+ */
+class SpectrumTap {
+public:
+    // Mono samples buffered between reads, a power of two (about 170 ms at 48 kHz)
+    static constexpr size_t CAPACITY = 8192;
+
+    SpectrumTap() : samples_(CAPACITY) {}
+
+    SpectrumTap(const SpectrumTap&) = delete;
+    SpectrumTap& operator=(const SpectrumTap&) = delete;
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Render thread: interleaved 16-bit or float PCM; other layouts are ignored
+    void write(const uint8_t* pcm, size_t bytes, int channels, int bitsPerSample, int sampleRate) {
+        if (!enabled_.load(std::memory_order_relaxed) || channels <= 0) return;
+        if (bitsPerSample != 16 && bitsPerSample != 32) return;
+        sample_rate_.store(sampleRate, std::memory_order_relaxed);
+
+        const size_t frameBytes = static_cast<size_t>(channels) * (bitsPerSample / 8);
+        const size_t frames = bytes / frameBytes;
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t room = CAPACITY - (tail - head);
+        const size_t count = frames < room ? frames : room;
+        if (count < frames) {
+            dropped_.fetch_add(frames - count, std::memory_order_relaxed);
+        }
+
+        const float scale = 1.0f / static_cast<float>(channels);
+        for (size_t i = 0; i < count; ++i) {
+            float sum = 0.0f;
+            if (bitsPerSample == 32) {
+                const float* in = reinterpret_cast<const float*>(pcm) + i * channels;
+                for (int c = 0; c < channels; ++c) sum += in[c];
+            } else {
+                const int16_t* in = reinterpret_cast<const int16_t*>(pcm) + i * channels;
+                for (int c = 0; c < channels; ++c) sum += in[c] * (1.0f / 32768.0f);
+            }
+            samples_[(tail + i) & (CAPACITY - 1)] = sum * scale;
+        }
+        tail_.store(tail + count, std::memory_order_release);
+    }
+
+    // Reader: move up to maxSamples of the oldest buffered samples into out
+    size_t read(float* out, size_t maxSamples) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t available = tail - head;
+        const size_t count = available < maxSamples ? available : maxSamples;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = samples_[(head + i) & (CAPACITY - 1)];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t available() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    // Sample rate of the most recent write, 0 before the first one
+    int sampleRate() const { return sample_rate_.load(std::memory_order_relaxed); }
+    // Samples discarded because the reader was behind
+    uint64_t droppedSamples() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<float> samples_;
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> sample_rate_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+}
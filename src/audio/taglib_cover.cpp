@@ -1,8 +1,14 @@
 #include "taglib_cover.h"
 #include <log/log_manager.h>
+#include <QBuffer>
 #include <QFile>
 #include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
 #include <fstream>
+#include <taglib/fileref.h>
+#include <taglib/tvariant.h>
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -13,14 +19,39 @@ namespace audio
 {
     std::vector<uint8_t> TagLibCoverExtractor::extractViaTagLib(const QString& path)
     {
-        std::vector<uint8_t> empty;
-        std::string pathStr = path.toStdString();
-        
-        // Try to open with TagLib
-        // Note: TagLib support would require including TagLib headers here
-        // For now, return empty to trigger FFmpeg fallback
-        LOG_DEBUG("TagLibCoverExtractor: TagLib extraction not yet implemented, will try FFmpeg fallback");
-        return empty;
+        std::vector<uint8_t> result;
+
+        // Tags only: parsing the audio properties would read frames past them
+#ifdef _WIN32
+        TagLib::FileRef file(reinterpret_cast<const wchar_t*>(path.utf16()), false);
+#else
+        TagLib::FileRef file(QFile::encodeName(path).constData(), false);
+#endif
+        if (file.isNull()) {
+            LOG_DEBUG("TagLibCoverExtractor: TagLib can't read tags of: {}", path.toStdString());
+            return result;
+        }
+
+        // One list for every format TagLib knows (ID3v2 APIC, FLAC PICTURE, MP4 covr, ...)
+        const TagLib::List<TagLib::VariantMap> pictures = file.complexProperties("PICTURE");
+        const TagLib::VariantMap* chosen = nullptr;
+        for (const auto& picture : pictures) {
+            if (!chosen) {
+                chosen = &picture;
+            }
+            if (picture.value("pictureType").toString() == "Front Cover") {
+                chosen = &picture;
+                break;
+            }
+        }
+        if (!chosen) {
+            return result;
+        }
+
+        const TagLib::ByteVector data = chosen->value("data").toByteVector();
+        result.assign(reinterpret_cast<const uint8_t*>(data.data()),
+                      reinterpret_cast<const uint8_t*>(data.data()) + data.size());
+        return result;
     }
 
     std::vector<uint8_t> TagLibCoverExtractor::extractViaFFmpeg(const QString& path)
@@ -28,34 +59,20 @@ namespace audio
         std::vector<uint8_t> result;
         std::string pathStr = path.toStdString();
         
+        // Opening reads the header, embedded pictures included; avformat_find_stream_info
+        // would go on to decode audio, so it isn't called
         AVFormatContext* fmtCtx = nullptr;
         if (avformat_open_input(&fmtCtx, pathStr.c_str(), nullptr, nullptr) != 0) {
             LOG_DEBUG("TagLibCoverExtractor: Failed to open file for cover extraction: {}", pathStr);
             return result;
         }
 
-        if (avformat_find_stream_info(fmtCtx, nullptr) < 0) {
-            LOG_DEBUG("TagLibCoverExtractor: Failed to find stream info for: {}", pathStr);
-            avformat_close_input(&fmtCtx);
-            return result;
-        }
-
-        // Look for attached pictures in metadata
-        AVDictionaryEntry* tag = nullptr;
-        while ((tag = av_dict_get(fmtCtx->metadata, "", tag, AV_DICT_IGNORE_SUFFIX))) {
-            if (tag->key != nullptr && tag->value != nullptr) {
-                LOG_DEBUG("TagLibCoverExtractor: Found metadata tag: {}={}", tag->key, tag->value);
-            }
-        }
-
-        // Search for video/picture streams (typically index 0 if present)
         for (unsigned int i = 0; i < fmtCtx->nb_streams; i++) {
-            if (fmtCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-                // This is likely attached picture/cover
-                // In a real implementation, we'd decode the first frame
-                // For now, log and continue
-                LOG_DEBUG("TagLibCoverExtractor: Found potential picture stream at index {}", i);
-                // Note: Actual extraction would require libavcodec for decoding
+            const AVStream* stream = fmtCtx->streams[i];
+            if ((stream->disposition & AV_DISPOSITION_ATTACHED_PIC) && stream->attached_pic.size > 0) {
+                result.assign(stream->attached_pic.data, stream->attached_pic.data + stream->attached_pic.size);
+                LOG_DEBUG("TagLibCoverExtractor: Found attached picture in stream {}", i);
+                break;
             }
         }
 
@@ -88,6 +105,53 @@ namespace audio
         return coverData;
     }
 
+    std::vector<uint8_t> TagLibCoverExtractor::extractThumbnail(const QString& path, int maxSide)
+    {
+        return scaleCover(extractCover(path), maxSide);
+    }
+
+    std::vector<uint8_t> TagLibCoverExtractor::scaleCover(const std::vector<uint8_t>& data, int maxSide)
+    {
+        if (data.empty() || maxSide <= 0) {
+            return data;
+        }
+
+        QByteArray encoded = QByteArray::fromRawData(reinterpret_cast<const char*>(data.data()),
+                                                     static_cast<qsizetype>(data.size()));
+        QBuffer input(&encoded);
+        input.open(QIODevice::ReadOnly);
+        QImageReader reader(&input);
+        // Only the header is read here
+        const QSize size = reader.size();
+        if (!size.isValid() || (size.width() <= maxSide && size.height() <= maxSide)) {
+            return data;
+        }
+
+        reader.setScaledSize(size.scaled(maxSide, maxSide, Qt::KeepAspectRatio));
+        QImage image = reader.read();
+        if (image.isNull()) {
+            LOG_WARN("TagLibCoverExtractor: Failed to decode cover for scaling: {}", reader.errorString().toStdString());
+            return data;
+        }
+
+        QByteArray scaled;
+        QBuffer output(&scaled);
+        output.open(QIODevice::WriteOnly);
+        const bool transparent = image.hasAlphaChannel();
+        QImageWriter writer(&output, transparent ? "png" : "jpeg");
+        if (!transparent) {
+            writer.setQuality(THUMBNAIL_JPEG_QUALITY);
+        }
+        if (!writer.write(image)) {
+            LOG_WARN("TagLibCoverExtractor: Failed to encode scaled cover: {}", writer.errorString().toStdString());
+            return data;
+        }
+
+        LOG_DEBUG("TagLibCoverExtractor: Scaled cover from {}x{} ({} bytes) to {}x{} ({} bytes)",
+                  size.width(), size.height(), data.size(), image.width(), image.height(), scaled.size());
+        return std::vector<uint8_t>(scaled.begin(), scaled.end());
+    }
+
     bool TagLibCoverExtractor::extractAndSaveCover(const QString& audioPath, const QString& outputPath)
     {
         auto coverData = extractCover(audioPath);
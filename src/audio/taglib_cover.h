@@ -12,7 +12,10 @@ namespace audio
      * 
      * Extracts album artwork from audio files using TagLib library.
      * Falls back to FFmpeg if TagLib extraction fails.
-     * Returns raw image bytes (PNG/JPEG) without interpretation.
+     * Both read only the tags (audio properties aren't parsed, no stream is probed),
+     * so extraction costs about the size of the tag, not of the file.
+     * extractCover() returns raw image bytes (PNG/JPEG) without interpretation;
+     * extractThumbnail() scales them down once so the cache and UI never see the original.
      */
     class TagLibCoverExtractor
     {
@@ -31,6 +34,30 @@ namespace audio
          */
         static std::vector<uint8_t> extractCover(const QString& path);
 
+        /**
+         * @brief Extract cover art scaled down to a thumbnail
+         * 
+         * extractCover() followed by scaleCover().
+         * 
+         * @param path Absolute path to audio file
+         * @param maxSide Longest side of the result in pixels, 0 for the original
+         * @return Image bytes, or empty vector if no cover found
+         */
+        static std::vector<uint8_t> extractThumbnail(const QString& path, int maxSide);
+
+        /**
+         * @brief Scale an encoded image down to fit maxSide x maxSide
+         * 
+         * Images that already fit, or can't be decoded, are returned unchanged. Others
+         * are decoded at reduced size (JPEG decodes at 1/2, 1/4 or 1/8 directly) and
+         * re-encoded as JPEG, or PNG when they have transparency.
+         * 
+         * @param data Encoded image bytes
+         * @param maxSide Longest side of the result in pixels, 0 to keep the original
+         * @return Image bytes
+         */
+        static std::vector<uint8_t> scaleCover(const std::vector<uint8_t>& data, int maxSide);
+
         /**
          * @brief Extract cover art and save to file
          * 
@@ -52,6 +79,8 @@ namespace audio
          */
         static QString detectImageFormat(const std::vector<uint8_t>& data);
 
+        static constexpr int THUMBNAIL_JPEG_QUALITY = 85;
+
     private:
         /**
          * @brief Extract cover using TagLib
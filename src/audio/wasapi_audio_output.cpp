@@ -1,21 +1,47 @@
 #include "wasapi_audio_output.h"
+#include "sample_convert.h"
 #include <log/log_manager.h>
+#include <util/thread_priority.h>
+#include <magic_enum/magic_enum.hpp>
 #include <iostream>
 #include <algorithm>
 #include <cstring>
 #include <comdef.h>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ksmedia.h>
+
+namespace {
+    // True for IEEE float PCM, plain or wrapped in WAVEFORMATEXTENSIBLE
+    bool isFloatFormat(const WAVEFORMATEX* format)
+    {
+        if (format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT) return true;
+        if (format->wFormatTag == WAVE_FORMAT_EXTENSIBLE && format->cbSize >= 22) {
+            auto* ext = reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(format);
+            return ext->SubFormat == KSDATAFORMAT_SUBTYPE_IEEE_FLOAT;
+        }
+        return false;
+    }
+}
 
 WASAPIAudioOutputUnsafe::WASAPIAudioOutputUnsafe()
         : device_enumerator_(nullptr), audio_device_(nullptr), audio_client_(nullptr), render_client_(nullptr),
             audio_clock_(nullptr), volume_control_(nullptr), wave_format_(nullptr), buffer_frame_count_(0), initialized_(false), is_playing_(false),
-            input_sample_rate_(0), input_channels_(0), input_bits_per_sample_(0) {}
+            input_sample_rate_(0), input_channels_(0), input_bits_per_sample_(0),
+            format_passthrough_(false), same_rate_(true), rate_ratio_(1.0), input_step_(1.0),
+            render_mode_(RenderMode::Push), render_event_(nullptr), render_exit_(false),
+            pending_offset_(0), drained_notified_(false), device_error_reported_(false), frames_written_(0), track_start_frame_(0),
+            position_base_ms_(0), discard_until_discontinuity_(false),
+            pts_anchors_{}, anchor_head_(0), anchor_count_(0), last_anchor_offset_(NO_CLOCK_OFFSET),
+            clock_offset_frames_(NO_CLOCK_OFFSET) {}
 
 WASAPIAudioOutputUnsafe::~WASAPIAudioOutputUnsafe() {
     cleanup();
 }
 
-bool WASAPIAudioOutputUnsafe::initialize(int sample_rate, int channels, int bits_per_sample) {
+bool WASAPIAudioOutputUnsafe::initialize(int sample_rate, int channels, int bits_per_sample, RenderMode mode) {
+    render_mode_ = mode;
     input_sample_rate_ = sample_rate;
     input_channels_ = channels;
     input_bits_per_sample_ = bits_per_sample;
@@ -52,34 +78,68 @@ bool WASAPIAudioOutputUnsafe::initialize(int sample_rate, int channels, int bits
         return false;
     }
 
-    wave_format_ = (WAVEFORMATEX*)CoTaskMemAlloc(sizeof(WAVEFORMATEX));
-    wave_format_->wFormatTag = WAVE_FORMAT_PCM;
-    wave_format_->nChannels = static_cast<WORD>(channels);
-    wave_format_->nSamplesPerSec = static_cast<DWORD>(sample_rate);
-    wave_format_->wBitsPerSample = static_cast<WORD>(bits_per_sample);
-    wave_format_->nBlockAlign = static_cast<WORD>((channels * bits_per_sample) / 8);
-    wave_format_->nAvgBytesPerSec = sample_rate * wave_format_->nBlockAlign;
-    wave_format_->cbSize = 0;
-
-    WAVEFORMATEX* closest_format = nullptr;
-    hr = audio_client_->IsFormatSupported(AUDCLNT_SHAREMODE_SHARED, wave_format_, &closest_format);
-    if (hr == S_FALSE) {
-        CoTaskMemFree(wave_format_);
-        wave_format_ = closest_format;
-    } else if (FAILED(hr)) {
-        CoTaskMemFree(wave_format_);
+    const bool matches_mix_format = device_format->nSamplesPerSec == static_cast<DWORD>(sample_rate) &&
+        device_format->nChannels == static_cast<WORD>(channels) &&
+        device_format->wBitsPerSample == static_cast<WORD>(bits_per_sample) &&
+        (bits_per_sample == 32) == isFloatFormat(device_format);
+    if (matches_mix_format) {
+        // Input was negotiated to the mix format; use the device's own descriptor
+        // (keeps the extensible channel mask) and skip format probing.
         wave_format_ = device_format;
         device_format = nullptr;
+    } else {
+        wave_format_ = (WAVEFORMATEX*)CoTaskMemAlloc(sizeof(WAVEFORMATEX));
+        // 32-bit input is float, matching the float mix format shared mode uses
+        wave_format_->wFormatTag = bits_per_sample == 32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+        wave_format_->nChannels = static_cast<WORD>(channels);
+        wave_format_->nSamplesPerSec = static_cast<DWORD>(sample_rate);
+        wave_format_->wBitsPerSample = static_cast<WORD>(bits_per_sample);
+        wave_format_->nBlockAlign = static_cast<WORD>((channels * bits_per_sample) / 8);
+        wave_format_->nAvgBytesPerSec = sample_rate * wave_format_->nBlockAlign;
+        wave_format_->cbSize = 0;
+
+        WAVEFORMATEX* closest_format = nullptr;
+        hr = audio_client_->IsFormatSupported(AUDCLNT_SHAREMODE_SHARED, wave_format_, &closest_format);
+        if (hr == S_FALSE) {
+            CoTaskMemFree(wave_format_);
+            wave_format_ = closest_format;
+        } else if (FAILED(hr)) {
+            CoTaskMemFree(wave_format_);
+            wave_format_ = device_format;
+            device_format = nullptr;
+        }
     }
 
     if (device_format) CoTaskMemFree(device_format);
 
-    hr = audio_client_->Initialize(AUDCLNT_SHAREMODE_SHARED, 0, 10000000, 0, wave_format_, nullptr);
+    if (render_mode_ == RenderMode::EventDriven) {
+        // 100 ms buffer, refilled every device period when WASAPI signals the event
+        hr = audio_client_->Initialize(AUDCLNT_SHAREMODE_SHARED, AUDCLNT_STREAMFLAGS_EVENTCALLBACK,
+                                       1000000, 0, wave_format_, nullptr);
+    } else {
+        hr = audio_client_->Initialize(AUDCLNT_SHAREMODE_SHARED, 0, 10000000, 0, wave_format_, nullptr);
+    }
     if (FAILED(hr)) {
         LOG_ERROR("WASAPI: Failed to initialize audio client: 0x{:X}", static_cast<unsigned long>(hr));
         return false;
     }
 
+    if (render_mode_ == RenderMode::EventDriven) {
+        render_event_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!render_event_) {
+            LOG_ERROR("WASAPI: Failed to create render event");
+            return false;
+        }
+        hr = audio_client_->SetEventHandle(render_event_);
+        if (FAILED(hr)) {
+            LOG_ERROR("WASAPI: Failed to set event handle: 0x{:X}", static_cast<unsigned long>(hr));
+            return false;
+        }
+    }
+
+    buildConversionPlan();
+    crossfade_.configure(input_sample_rate_, input_channels_, input_bits_per_sample_);
+
     hr = audio_client_->GetBufferSize(&buffer_frame_count_);
     if (FAILED(hr)) {
         LOG_ERROR("WASAPI: Failed to get buffer size");
@@ -114,6 +174,8 @@ bool WASAPIAudioOutputUnsafe::initialize(int sample_rate, int channels, int bits
 
 void WASAPIAudioOutputUnsafe::cleanup() 
 {
+    stopRenderThread();
+
     if (audio_client_) {
         audio_client_->Stop();
         audio_client_->Release();
@@ -152,11 +214,256 @@ void WASAPIAudioOutputUnsafe::cleanup()
         volume_control_ = nullptr;
     }
 
+    if (render_event_) {
+        CloseHandle(render_event_);
+        render_event_ = nullptr;
+    }
+    frame_source_.reset();
+    pending_frame_.reset();
+
     CoUninitialize();
 }
 
-void WASAPIAudioOutputUnsafe::playAudioData(const uint8_t* data, int size) {
+WASAPIAudioOutputUnsafe::RenderMode WASAPIAudioOutputUnsafe::renderMode() const
+{
+    return render_mode_;
+}
+
+void WASAPIAudioOutputUnsafe::setFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained)
+{
+    if (render_thread_.joinable()) {
+        LOG_ERROR("WASAPI: Cannot change frame source while the render thread is running");
+        return;
+    }
+    frame_source_ = std::move(source);
+    on_drained_ = std::move(onDrained);
+    pending_frame_.reset();
+    pending_offset_ = 0;
+    drained_notified_ = false;
+    discard_until_discontinuity_ = false;
+    crossfade_.reset();
+    resetPtsAnchors();
+    clearNextFrameSource();
+}
+
+void WASAPIAudioOutputUnsafe::setNextFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained,
+                                                 std::function<void()> onStarted)
+{
+    std::scoped_lock lock(next_source_mutex_);
+    next_frame_source_ = std::move(source);
+    next_on_drained_ = std::move(onDrained);
+    next_on_started_ = std::move(onStarted);
+}
+
+bool WASAPIAudioOutputUnsafe::clearNextFrameSource()
+{
+    std::scoped_lock lock(next_source_mutex_);
+    if (!next_frame_source_) {
+        return false;
+    }
+    next_frame_source_.reset();
+    next_on_drained_ = nullptr;
+    next_on_started_ = nullptr;
+    return true;
+}
+
+void WASAPIAudioOutputUnsafe::setCrossfadeDuration(int ms)
+{
+    crossfade_.setDurationMs(ms);
+}
+
+bool WASAPIAudioOutputUnsafe::switchToNextSource(uint64_t at_frame)
+{
+    std::scoped_lock lock(next_source_mutex_);
+    if (!next_frame_source_) {
+        return false;
+    }
+    frame_source_ = std::move(next_frame_source_);
+    on_drained_ = std::move(next_on_drained_);
+    started_callback_ = std::move(next_on_started_);
+    next_on_drained_ = nullptr;
+    next_on_started_ = nullptr;
+    drained_notified_ = false;
+    discard_until_discontinuity_ = false;
+    last_anchor_offset_ = NO_CLOCK_OFFSET;  // The next track's first frame always anchors
+    track_start_frame_.store(at_frame);
+    position_base_ms_.store(0);
+    LOG_INFO("WASAPI: Switched to next frame source at device frame {}", at_frame);
+    return true;
+}
+
+void WASAPIAudioOutputUnsafe::renderThreadFunc()
+{
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    util::ScopedThreadPriority priority(util::ThreadRole::RealtimeAudio);
+    // Last log line until the thread exits: the loop below must not log or allocate
+    LOG_DEBUG("WASAPI: Render thread started (MMCSS Pro Audio: {}, raised priority: {})",
+              priority.mmcss(), priority.applied());
+    while (!render_exit_.load()) {
+        // The event fires once per device period while the client is running;
+        // the timeout only bounds how long stop/pause takes to be noticed.
+        DWORD waitResult = WaitForSingleObject(render_event_, 200);
+        if (render_exit_.load()) {
+            break;
+        }
+        if (waitResult != WAIT_OBJECT_0) {
+            continue;
+        }
+        fillFromSource();
+        promotePtsAnchors();
+        // Notified from here rather than fillFromSource() so the pre-roll in start()
+        // never runs the callbacks on the caller's thread.
+        if (started_callback_) {
+            auto onStarted = std::move(started_callback_);
+            started_callback_ = nullptr;
+            onStarted();
+        }
+        if (frame_source_ && !pending_frame_ && !drained_notified_
+            && frame_source_->closed() && frame_source_->empty()) {
+            drained_notified_ = true;
+            if (on_drained_) {
+                on_drained_();
+            }
+        }
+    }
+    LOG_DEBUG("WASAPI: Render thread exiting");
+    if (SUCCEEDED(hr)) {
+        CoUninitialize();
+    }
+}
+
+void WASAPIAudioOutputUnsafe::fillFromSource()
+{
+    if (!initialized_ || !frame_source_) return;
+
+    UINT32 padding = 0;
+    HRESULT hr = audio_client_->GetCurrentPadding(&padding);
+    if (FAILED(hr)) return;
+
+    UINT32 writable = buffer_frame_count_ - padding;
+    if (writable == 0) return;
+
+    BYTE* buffer_data = nullptr;
+    hr = render_client_->GetBuffer(writable, &buffer_data);
+    if (FAILED(hr)) {
+        // Runs every device period: report the first failure of a streak only
+        if (!device_error_reported_) {
+            device_error_reported_ = true;
+            LOG_ERROR("WASAPI: Failed to get buffer: 0x{:X} for size {}", static_cast<unsigned long>(hr), writable);
+        }
+        return;
+    }
+
+    const UINT32 input_bytes_per_frame = input_channels_ * (input_bits_per_sample_ / 8);
+    const UINT32 output_bytes_per_frame = wave_format_->nBlockAlign;
+
+    UINT32 written = 0;
+    while (written < writable) {
+        if (!pending_frame_ || pending_offset_ >= pending_frame_->data.size()) {
+            pending_frame_.reset();
+            pending_offset_ = 0;
+            if (telemetry_) {
+                telemetry_->recordQueueDepth(frame_source_->size(), frame_source_->queuedDurationMs());
+            }
+            if (!frame_source_->tryPop(pending_frame_)) {
+                // End of the current track: continue with the prepared one in this same buffer
+                if (frame_source_->closed() && frame_source_->empty()
+                    && switchToNextSource(frames_written_ + written)) {
+                    // Resume the next track where the crossfade left it
+                    pending_frame_ = crossfade_.takeCarryOver(pending_offset_);
+                    if (pending_frame_) {
+                        int64_t pts = pending_frame_->pts_samples;
+                        if (pts >= 0) {
+                            pts += static_cast<int64_t>(pending_offset_ / input_bytes_per_frame);
+                        }
+                        recordPtsAnchor(frames_written_ + written, pts, pending_frame_->sample_rate);
+                    }
+                    continue;
+                }
+                break;
+            }
+            if (discard_until_discontinuity_) {
+                if (!pending_frame_->discontinuity) {
+                    pending_frame_.reset();  // Decoded before the seek
+                    continue;
+                }
+                discard_until_discontinuity_ = false;
+            }
+            const float gain = frame_source_->trackGain();
+            if (gain != 1.0f) {
+                audio::SampleConverter::applyGain(pending_frame_->data.data(), pending_frame_->data.size(),
+                                           pending_frame_->bits_per_sample, gain);
+            }
+            applyCrossfade();
+            recordPtsAnchor(frames_written_ + written, pending_frame_->pts_samples, pending_frame_->sample_rate);
+            continue;
+        }
+
+        UINT32 input_frames = static_cast<UINT32>((pending_frame_->data.size() - pending_offset_) / input_bytes_per_frame);
+        UINT32 output_frames = same_rate_ ? input_frames : static_cast<UINT32>(input_frames * rate_ratio_);
+        if (output_frames == 0) {
+            pending_frame_.reset();
+            continue;
+        }
+
+        UINT32 frames_to_copy = std::min(writable - written, output_frames);
+        UINT32 frames_consumed = same_rate_ ? frames_to_copy
+            : std::min(input_frames, static_cast<UINT32>(std::ceil(frames_to_copy * input_step_)));
+        convertAndWriteAudio(pending_frame_->data.data() + pending_offset_,
+                             static_cast<int>(frames_consumed * input_bytes_per_frame),
+                             buffer_data + written * output_bytes_per_frame, frames_to_copy);
+        if (spectrum_tap_) {
+            spectrum_tap_->write(pending_frame_->data.data() + pending_offset_, frames_consumed * input_bytes_per_frame,
+                                 input_channels_, input_bits_per_sample_, input_sample_rate_);
+        }
+        pending_offset_ += frames_consumed * input_bytes_per_frame;
+        written += frames_to_copy;
+    }
+
+    hr = render_client_->ReleaseBuffer(written, 0);
+    if (FAILED(hr)) {
+        if (!device_error_reported_) {
+            device_error_reported_ = true;
+            LOG_ERROR("WASAPI: Failed to release buffer: 0x{:X}", static_cast<unsigned long>(hr));
+        }
+        return;
+    }
+    device_error_reported_ = false;
+    if (telemetry_ && written > 0) {
+        telemetry_->recordDeviceWrite(padding, buffer_frame_count_, written, frames_written_ > 0);
+    }
+    frames_written_ += written;
+}
+
+void WASAPIAudioOutputUnsafe::applyCrossfade()
+{
+    if (crossfade_.durationMs() <= 0 && !crossfade_.active()) return;
+    std::shared_ptr<AudioFrameQueue> next;
+    if (frame_source_->closed()) {
+        // Only near the end of a track; copying the pointer does not allocate
+        std::scoped_lock lock(next_source_mutex_);
+        next = next_frame_source_;
+    }
+    crossfade_.process(*pending_frame_, *frame_source_, next.get());
+}
+
+void WASAPIAudioOutputUnsafe::stopRenderThread()
+{
+    if (!render_thread_.joinable()) return;
+    render_exit_.store(true);
+    if (render_event_) {
+        SetEvent(render_event_);
+    }
+    render_thread_.join();
+    render_exit_.store(false);
+}
+
+void WASAPIAudioOutputUnsafe::playAudioData(const uint8_t* data, int size, int64_t pts_samples) {
     if (!initialized_ || !is_playing_) return;
+    if (render_mode_ == RenderMode::EventDriven) {
+        LOG_ERROR("WASAPI: playAudioData is not available in event-driven render mode");
+        return;
+    }
     
     UINT32 frames_available;
     HRESULT hr = audio_client_->GetCurrentPadding(&frames_available);
@@ -173,12 +480,7 @@ void WASAPIAudioOutputUnsafe::playAudioData(const uint8_t* data, int size) {
     if (input_frames == 0) return;
     
     // Handle sample rate conversion if needed
-    UINT32 output_frames = input_frames;
-    if (wave_format_->nSamplesPerSec != static_cast<DWORD>(input_sample_rate_)) {
-        // Simple sample rate conversion ratio
-        double ratio = static_cast<double>(wave_format_->nSamplesPerSec) / static_cast<double>(input_sample_rate_);
-        output_frames = static_cast<UINT32>(input_frames * ratio);
-    }
+    UINT32 output_frames = same_rate_ ? input_frames : static_cast<UINT32>(input_frames * rate_ratio_);
     
     // Write only what we can fit
     UINT32 frames_to_copy = std::min(frames_to_write, output_frames);
@@ -188,10 +490,22 @@ void WASAPIAudioOutputUnsafe::playAudioData(const uint8_t* data, int size) {
         hr = render_client_->GetBuffer(frames_to_copy, &buffer_data);
         if (SUCCEEDED(hr)) {
             convertAndWriteAudio(data, size, buffer_data, frames_to_copy);
+            if (spectrum_tap_) {
+                spectrum_tap_->write(data, static_cast<size_t>(size), input_channels_,
+                                     input_bits_per_sample_, input_sample_rate_);
+            }
             
             hr = render_client_->ReleaseBuffer(frames_to_copy, 0);
             if (FAILED(hr)) {
                 LOG_ERROR("WASAPI: Failed to release buffer: 0x{:X}", static_cast<unsigned long>(hr));
+            } else {
+                if (telemetry_) {
+                    telemetry_->recordDeviceWrite(frames_available, buffer_frame_count_, frames_to_copy,
+                                                  frames_written_ > 0);
+                }
+                recordPtsAnchor(frames_written_, pts_samples, input_sample_rate_);
+                frames_written_ += frames_to_copy;
+                promotePtsAnchors();
             }
         }
         else {
@@ -200,48 +514,96 @@ void WASAPIAudioOutputUnsafe::playAudioData(const uint8_t* data, int size) {
     }
 }
 
+void WASAPIAudioOutputUnsafe::buildConversionPlan() {
+    const int output_channels = wave_format_->nChannels;
+    same_rate_ = wave_format_->nSamplesPerSec == static_cast<DWORD>(input_sample_rate_);
+    rate_ratio_ = static_cast<double>(wave_format_->nSamplesPerSec) / static_cast<double>(input_sample_rate_);
+    input_step_ = 1.0 / rate_ratio_;
+    format_passthrough_ = same_rate_ && output_channels == input_channels_ &&
+        wave_format_->wBitsPerSample == input_bits_per_sample_;
+    channel_map_ = audio::SampleConverter::buildChannelMap(input_channels_, output_channels);
+
+    LOG_INFO("WASAPI: {} Hz/{} ch/{} bit -> {} Hz/{} ch/{} bit, {}, kernels: {}",
+             input_sample_rate_, input_channels_, input_bits_per_sample_,
+             wave_format_->nSamplesPerSec, output_channels, wave_format_->wBitsPerSample,
+             format_passthrough_ ? "passthrough" : "converting",
+             magic_enum::enum_name(audio::SampleConverter::activeIsa()));
+}
+
 void WASAPIAudioOutputUnsafe::convertAndWriteAudio(const uint8_t* data, int size, BYTE* buffer_data, UINT32 frames_to_copy) {
     const UINT32 input_bytes_per_sample = input_bits_per_sample_ / 8;
     const UINT32 input_bytes_per_frame = input_channels_ * input_bytes_per_sample;
-    UINT32 input_frames = size / input_bytes_per_frame;
-    
-    if (wave_format_->wBitsPerSample == input_bits_per_sample_ && 
-        wave_format_->nChannels == static_cast<WORD>(input_channels_) && 
-        wave_format_->nSamplesPerSec == static_cast<DWORD>(input_sample_rate_)) {
+    const UINT32 input_frames = size / input_bytes_per_frame;
+    const UINT32 output_channels = wave_format_->nChannels;
+
+    if (format_passthrough_) {
         // Direct copy for exact match
-        memcpy(buffer_data, data, frames_to_copy * input_bytes_per_frame);
-    } else if (wave_format_->wBitsPerSample == 32) {
-        // Convert to 32-bit float
+        memcpy(buffer_data, data, std::min(frames_to_copy, input_frames) * input_bytes_per_frame);
+        return;
+    }
+    if (input_frames == 0) return;
+
+    if (wave_format_->wBitsPerSample == 32) {
+        // 32-bit float output
         float* output_samples = reinterpret_cast<float*>(buffer_data);
-        
-        for (UINT32 frame = 0; frame < frames_to_copy; frame++) {
-            // Sample rate conversion: pick nearest input frame
-            UINT32 input_frame = frame;
-            if (wave_format_->nSamplesPerSec != static_cast<DWORD>(input_sample_rate_)) {
-                double ratio = static_cast<double>(input_sample_rate_) / static_cast<double>(wave_format_->nSamplesPerSec);
-                input_frame = static_cast<UINT32>(frame * ratio);
-                if (input_frame >= input_frames) input_frame = input_frames - 1;
+        const bool same_layout = output_channels == static_cast<UINT32>(input_channels_);
+        const UINT32 frames = same_rate_ ? std::min(frames_to_copy, input_frames) : frames_to_copy;
+        const size_t staged_samples = static_cast<size_t>(frames) * input_channels_;
+
+        // Stage 1: bring samples to float, still in the input channel layout, one input
+        // frame per output frame. Written straight into the device buffer when no
+        // channel mixing follows.
+        const float* staged = nullptr;
+        float* stage_target = output_samples;
+        if (!same_layout) {
+            if (convert_scratch_.size() < staged_samples) {
+                convert_scratch_.resize(staged_samples);
             }
-            
-            // Convert channels (handle different channel configurations)
-            for (UINT32 ch = 0; ch < wave_format_->nChannels; ch++) {
-                // Use left channel for mono output, or map channels appropriately
-                UINT32 input_channel = ch < static_cast<UINT32>(input_channels_) ? ch : 0;
-                
-                // Handle different input bit depths
-                float sample_float = 0.0f;
-                if (input_bits_per_sample_ == 16) {
-                    const int16_t* input_16 = reinterpret_cast<const int16_t*>(data);
-                    int16_t sample = input_16[input_frame * input_channels_ + input_channel];
-                    sample_float = sample / 32768.0f;
-                } else if (input_bits_per_sample_ == 32) {
-                    const float* input_32 = reinterpret_cast<const float*>(data);
-                    sample_float = input_32[input_frame * input_channels_ + input_channel];
+            stage_target = convert_scratch_.data();
+        }
+
+        if (same_rate_) {
+            if (input_bits_per_sample_ == 16) {
+                audio::SampleConverter::s16ToF32(reinterpret_cast<const int16_t*>(data), stage_target, staged_samples);
+                staged = stage_target;
+            } else {
+                staged = reinterpret_cast<const float*>(data);
+            }
+        } else {
+            // Sample rate conversion: pick nearest input frame
+            const int16_t* input_16 = reinterpret_cast<const int16_t*>(data);
+            const float* input_32 = reinterpret_cast<const float*>(data);
+            for (UINT32 frame = 0; frame < frames; frame++) {
+                UINT32 input_frame = std::min(static_cast<UINT32>(frame * input_step_), input_frames - 1);
+                const size_t src = static_cast<size_t>(input_frame) * input_channels_;
+                float* dst = stage_target + static_cast<size_t>(frame) * input_channels_;
+                for (int ch = 0; ch < input_channels_; ch++) {
+                    dst[ch] = input_bits_per_sample_ == 16 ? input_16[src + ch] / 32768.0f : input_32[src + ch];
                 }
-                
-                output_samples[frame * wave_format_->nChannels + ch] = sample_float;
             }
+            staged = stage_target;
+        }
+
+        // Stage 2: channel layout
+        if (staged == output_samples) {
+            return;
+        }
+        if (same_layout) {
+            memcpy(output_samples, staged, staged_samples * sizeof(float));
+        } else if (input_channels_ == 1 && output_channels == 2) {
+            audio::SampleConverter::monoToStereoF32(staged, output_samples, frames);
+        } else if (input_channels_ == 2 && output_channels == 1) {
+            audio::SampleConverter::stereoToMonoF32(staged, output_samples, frames);
+        } else {
+            audio::SampleConverter::remapChannelsF32(staged, input_channels_, output_samples, channel_map_, frames);
         }
+    } else if (wave_format_->wBitsPerSample == 16 && input_bits_per_sample_ == 32 &&
+               same_rate_ && output_channels == static_cast<UINT32>(input_channels_)) {
+        // Float input to a 16-bit device
+        const UINT32 frames = std::min(frames_to_copy, input_frames);
+        audio::SampleConverter::f32ToS16(reinterpret_cast<const float*>(data),
+                                         reinterpret_cast<int16_t*>(buffer_data),
+                                         static_cast<size_t>(frames) * input_channels_);
     } else {
         // Fallback: copy available data with basic format handling
         UINT32 bytes_to_copy = std::min(static_cast<UINT32>(size), frames_to_copy * wave_format_->nBlockAlign);
@@ -249,6 +611,41 @@ void WASAPIAudioOutputUnsafe::convertAndWriteAudio(const uint8_t* data, int size
     }
 }
 
+AudioFormat WASAPIAudioOutputUnsafe::queryMixFormat() {
+    AudioFormat format{0, 0, 0};
+    HRESULT hr = CoInitialize(nullptr);
+    if (FAILED(hr)) {
+        LOG_ERROR("WASAPI: Failed to initialize COM");
+        return format;
+    }
+
+    IMMDeviceEnumerator* enumerator = nullptr;
+    IMMDevice* device = nullptr;
+    IAudioClient* client = nullptr;
+    WAVEFORMATEX* mix_format = nullptr;
+    hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                          __uuidof(IMMDeviceEnumerator), (void**)&enumerator);
+    if (SUCCEEDED(hr)) hr = enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &device);
+    if (SUCCEEDED(hr)) hr = device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void**)&client);
+    if (SUCCEEDED(hr)) hr = client->GetMixFormat(&mix_format);
+
+    if (SUCCEEDED(hr) && mix_format) {
+        format.sample_rate = static_cast<int>(mix_format->nSamplesPerSec);
+        format.channels = mix_format->nChannels;
+        // Integer mix formats are rare in shared mode; 16-bit is accepted everywhere
+        format.bits_per_sample = (isFloatFormat(mix_format) && mix_format->wBitsPerSample == 32) ? 32 : 16;
+    } else {
+        LOG_WARN("WASAPI: Failed to query mix format: 0x{:X}", static_cast<unsigned long>(hr));
+    }
+
+    if (mix_format) CoTaskMemFree(mix_format);
+    if (client) client->Release();
+    if (device) device->Release();
+    if (enumerator) enumerator->Release();
+    CoUninitialize();
+    return format;
+}
+
 bool WASAPIAudioOutputUnsafe::isInitialized() const {
     return initialized_;
 }
@@ -256,6 +653,12 @@ bool WASAPIAudioOutputUnsafe::start() {
     if (!initialized_) return false;
     
     if (is_playing_) return true; // Already playing
+
+    if (render_mode_ == RenderMode::EventDriven && !render_thread_.joinable()) {
+        // Pre-roll the device buffer so the first period does not start with silence
+        fillFromSource();
+        render_thread_ = std::thread([this]() { this->renderThreadFunc(); });
+    }
     
     HRESULT hr = audio_client_->Start();
     if (SUCCEEDED(hr)) {
@@ -284,12 +687,19 @@ bool WASAPIAudioOutputUnsafe::pause() {
 
 bool WASAPIAudioOutputUnsafe::stop() {
     if (!initialized_) return false;
+
+    stopRenderThread();
     
     HRESULT hr = audio_client_->Stop();
     if (SUCCEEDED(hr)) {
         // Reset the audio client to clear any buffered audio
         hr = audio_client_->Reset();
         is_playing_ = false;
+        frames_written_ = 0;
+        track_start_frame_.store(0);
+        position_base_ms_.store(0);
+        resetPtsAnchors();
+        crossfade_.reset();
         
         if (SUCCEEDED(hr)) {
             return true;
@@ -340,23 +750,131 @@ int64_t WASAPIAudioOutputUnsafe::getCurrentPositionMs() const
         return 0;
     }
 
-    if (!audio_clock_) return 0;
+    double seconds = 0.0;
+    if (!readDeviceClock(seconds)) {
+        return 0;
+    }
+
+    const double device_rate = static_cast<double>(wave_format_->nSamplesPerSec);
+    const int64_t offset = clock_offset_frames_.load();
+    if (offset != NO_CLOCK_OFFSET) {
+        // Anchored to the PTS of the frames at the head of the device buffer
+        int64_t ms = static_cast<int64_t>((seconds + static_cast<double>(offset) / device_rate) * 1000.0);
+        return std::max<int64_t>(ms, 0);
+    }
+
+    // No PTS: offset of the current track in a gapless sequence; not reached yet means it is still at 0
+    seconds -= static_cast<double>(track_start_frame_.load()) / device_rate;
+    int64_t ms = static_cast<int64_t>(seconds * 1000.0);
+    return position_base_ms_.load() + std::max<int64_t>(ms, 0);
+}
+
+bool WASAPIAudioOutputUnsafe::readDeviceClock(double& seconds) const
+{
+    if (!audio_clock_) return false;
 
     UINT64 freq = 0;
     UINT64 pos = 0;
     HRESULT hr = audio_clock_->GetFrequency(&freq);
     if (FAILED(hr) || freq == 0) {
-        return 0;
+        return false;
     }
-
     hr = audio_clock_->GetPosition(&pos, nullptr);
     if (FAILED(hr)) {
-        return 0;
+        return false;
     }
+    seconds = static_cast<double>(pos) / static_cast<double>(freq);
+    return true;
+}
 
-    double seconds = static_cast<double>(pos) / static_cast<double>(freq);
-    int64_t ms = static_cast<int64_t>(seconds * 1000.0);
-    return ms;
+void WASAPIAudioOutputUnsafe::recordPtsAnchor(uint64_t device_frame, int64_t pts_samples, int sample_rate)
+{
+    if (pts_samples < 0 || sample_rate <= 0) return;
+
+    const int64_t device_rate = static_cast<int64_t>(wave_format_->nSamplesPerSec);
+    const int64_t pts_device = sample_rate == device_rate ? pts_samples : pts_samples * device_rate / sample_rate;
+    const int64_t offset = pts_device - static_cast<int64_t>(device_frame);
+    // Contiguous frames keep the offset; only jumps (seek, track switch, stream gaps) need an anchor
+    if (last_anchor_offset_ != NO_CLOCK_OFFSET && std::llabs(offset - last_anchor_offset_) <= device_rate / 1000) {
+        return;
+    }
+    last_anchor_offset_ = offset;
+    if (anchor_count_ == MAX_PTS_ANCHORS) {
+        // Device buffer holds more jumps than expected; the newest one wins
+        pts_anchors_[(anchor_head_ + anchor_count_ - 1) % MAX_PTS_ANCHORS] = {device_frame, offset};
+        return;
+    }
+    pts_anchors_[(anchor_head_ + anchor_count_) % MAX_PTS_ANCHORS] = {device_frame, offset};
+    ++anchor_count_;
+}
+
+void WASAPIAudioOutputUnsafe::promotePtsAnchors()
+{
+    if (anchor_count_ == 0) return;
+    double seconds = 0.0;
+    if (!readDeviceClock(seconds)) return;
+
+    const uint64_t played = static_cast<uint64_t>(seconds * static_cast<double>(wave_format_->nSamplesPerSec));
+    while (anchor_count_ > 0 && pts_anchors_[anchor_head_].device_frame <= played) {
+        clock_offset_frames_.store(pts_anchors_[anchor_head_].offset);
+        anchor_head_ = (anchor_head_ + 1) % MAX_PTS_ANCHORS;
+        --anchor_count_;
+    }
+}
+
+void WASAPIAudioOutputUnsafe::resetPtsAnchors()
+{
+    anchor_head_ = 0;
+    anchor_count_ = 0;
+    last_anchor_offset_ = NO_CLOCK_OFFSET;
+    clock_offset_frames_.store(NO_CLOCK_OFFSET);
+}
+
+void WASAPIAudioOutputUnsafe::setPositionOffsetMs(int64_t positionMs)
+{
+    position_base_ms_.store(std::max<int64_t>(positionMs, 0));
+}
+
+bool WASAPIAudioOutputUnsafe::flushForSeek(int64_t positionMs)
+{
+    if (!initialized_) return false;
+
+    const bool was_playing = is_playing_;
+    stopRenderThread();
+
+    HRESULT hr = audio_client_->Stop();
+    if (SUCCEEDED(hr)) {
+        hr = audio_client_->Reset();
+    }
+    is_playing_ = false;
+    if (FAILED(hr)) {
+        LOG_ERROR("WASAPI: Failed to flush audio client for seek: 0x{:X}", static_cast<unsigned long>(hr));
+        return false;
+    }
+
+    pending_frame_.reset();
+    pending_offset_ = 0;
+    discard_until_discontinuity_ = render_mode_ == RenderMode::EventDriven;
+    crossfade_.reset();
+    frames_written_ = 0;
+    track_start_frame_.store(0);
+    resetPtsAnchors();
+    setPositionOffsetMs(positionMs);
+
+    if (was_playing) {
+        return start();
+    }
+    return true;
+}
+
+void WASAPIAudioOutputUnsafe::setTelemetry(std::shared_ptr<audio::PlaybackTelemetry> telemetry)
+{
+    telemetry_ = std::move(telemetry);
+}
+
+void WASAPIAudioOutputUnsafe::setSpectrumTap(std::shared_ptr<audio::SpectrumTap> tap)
+{
+    spectrum_tap_ = std::move(tap);
 }
 
 void WASAPIAudioOutputUnsafe::setVolume(float volume)
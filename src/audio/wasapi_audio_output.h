@@ -3,35 +3,66 @@
 #include <cstdint>
 #include <functional>
 #include <thread>
+#include <array>
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <mmdeviceapi.h>
 #include <audioclient.h>
 #include <audiopolicy.h>
 #include <windows.h>
+#include <vector>
+#include "audio_frame.h"
+#include "audio_output.h"
+#include "crossfade_mixer.h"
 
 
 /**
  * WASAPIAudioOutputUnsafe - low-level WASAPI audio output handler (not thread-safe)
+ *
+ * Shared-mode output to the default render endpoint. In EventDriven mode the stream is
+ * opened with AUDCLNT_STREAMFLAGS_EVENTCALLBACK and the render thread wakes once per device
+ * period to pull PCM from the frame source. See IAudioOutput for the contract of each method.
  */
-class WASAPIAudioOutputUnsafe
+class WASAPIAudioOutputUnsafe : public IAudioOutput
 {
 public:
     explicit WASAPIAudioOutputUnsafe();
-    ~WASAPIAudioOutputUnsafe();
-    bool initialize(int sample_rate, int channels, int bits_per_sample = 16);
-    void playAudioData(const uint8_t* data, int size);
-    bool isInitialized() const;
-    
+    ~WASAPIAudioOutputUnsafe() override;
+    bool initialize(int sample_rate, int channels, int bits_per_sample = 16,
+                    RenderMode mode = RenderMode::Push) override;
+    void playAudioData(const uint8_t* data, int size, int64_t pts_samples = -1) override;
+    bool isInitialized() const override;
+
+    /**
+     * Shared-mode mix format of the default render endpoint, so the decoder can emit
+     * it directly and the output only has to copy. 32 bits per sample means float.
+     * Returns an invalid AudioFormat if the device can't be queried.
+     */
+    static AudioFormat queryMixFormat();
+    RenderMode renderMode() const override;
+
+    void setFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained) override;
+    // The switch happens inside the same device buffer
+    void setNextFrameSource(std::shared_ptr<AudioFrameQueue> source, std::function<void()> onDrained,
+                            std::function<void()> onStarted) override;
+    bool clearNextFrameSource() override;
+    void setCrossfadeDuration(int ms) override;
 
-    bool start();
-    bool pause();
-    bool stop();
-    bool isPlaying() const;
-    int getAvailableCacheBytes() const;  // Get number of frames available in buffer
-    int getCurrentFrames() const;
-    // Get current playback position in milliseconds according to the audio device clock
-    int64_t getCurrentPositionMs() const;
-    void setVolume(float volume); // Volume: 0.0 - 1.0
+    bool start() override;
+    bool pause() override;
+    bool stop() override;
+    bool isPlaying() const override;
+    int getAvailableCacheBytes() const override;
+    int getCurrentFrames() const override;
+    // Computed on demand from the device clock and the PTS of the frame now playing (relative
+    // to the last setNextFrameSource() switch when frames carry no PTS)
+    int64_t getCurrentPositionMs() const override;
+    void setPositionOffsetMs(int64_t positionMs) override;
+    bool flushForSeek(int64_t positionMs) override;
+    void setVolume(float volume) override;
+    void setTelemetry(std::shared_ptr<audio::PlaybackTelemetry> telemetry) override;
+    void setSpectrumTap(std::shared_ptr<audio::SpectrumTap> tap) override;
 private:
     // WASAPI COM interfaces
     IMMDeviceEnumerator* device_enumerator_;
@@ -50,8 +81,70 @@ private:
     int input_sample_rate_;
     int input_channels_;
     int input_bits_per_sample_;
+    // Conversion plan, fixed once the device format is known in initialize()
+    bool format_passthrough_;           // Input matches the device format exactly
+    bool same_rate_;
+    double rate_ratio_;                 // Output rate / input rate
+    double input_step_;                 // Input rate / output rate (nearest-frame resampling step)
+    std::vector<int> channel_map_;      // Output channel -> input channel (-1 = silence)
+    std::vector<float> convert_scratch_;
+    void buildConversionPlan();
     // Private helper for conversion
     void convertAndWriteAudio(const uint8_t* data, int size, BYTE* buffer_data, UINT32 frames_to_copy);
     // Cleanup resources
     void cleanup();
+
+    // Event-driven rendering
+    RenderMode render_mode_;
+    HANDLE render_event_;
+    std::thread render_thread_;
+    std::atomic<bool> render_exit_;
+    std::shared_ptr<AudioFrameQueue> frame_source_;
+    std::function<void()> on_drained_;
+    std::shared_ptr<AudioFrame> pending_frame_;  // Frame partially written to the device buffer
+    size_t pending_offset_;                      // Bytes of pending_frame_ already written
+    bool drained_notified_;
+    bool device_error_reported_;                 // GetBuffer/ReleaseBuffer failure already logged
+    std::shared_ptr<audio::PlaybackTelemetry> telemetry_;
+    std::shared_ptr<audio::SpectrumTap> spectrum_tap_;
+    // Gapless continuation, guarded by next_source_mutex_
+    std::mutex next_source_mutex_;
+    std::shared_ptr<AudioFrameQueue> next_frame_source_;
+    std::function<void()> next_on_drained_;
+    std::function<void()> next_on_started_;
+    std::function<void()> started_callback_;     // Set by fillFromSource() on a switch, run by the render thread
+    uint64_t frames_written_;                    // Device frames written since start
+    std::atomic<uint64_t> track_start_frame_;    // Device frame at which the current source started
+    std::atomic<int64_t> position_base_ms_;      // Track position at track_start_frame_
+    bool discard_until_discontinuity_;           // Frames still queued from before a seek
+    bool switchToNextSource(uint64_t at_frame);
+    audio::CrossfadeMixer crossfade_;            // Render thread only, except its duration
+    // Feed a frame just popped from frame_source_ through crossfade_
+    void applyCrossfade();
+
+    // Position anchoring. When a frame whose PTS doesn't continue the previous one is written,
+    // the device frame it starts at is queued with the offset mapping device frames to track
+    // frames from there on; once the device clock reaches it the offset is published.
+    // The queue belongs to whichever thread writes to the device (render or push caller).
+    struct PtsAnchor {
+        uint64_t device_frame;
+        int64_t offset;
+    };
+    static constexpr size_t MAX_PTS_ANCHORS = 16;
+    static constexpr int64_t NO_CLOCK_OFFSET = INT64_MIN;
+    std::array<PtsAnchor, MAX_PTS_ANCHORS> pts_anchors_;
+    size_t anchor_head_;
+    size_t anchor_count_;
+    int64_t last_anchor_offset_;
+    std::atomic<int64_t> clock_offset_frames_;   // Track frame = device clock frame + offset
+    void recordPtsAnchor(uint64_t device_frame, int64_t pts_samples, int sample_rate);
+    void promotePtsAnchors();
+    void resetPtsAnchors();
+    // Frames played according to IAudioClock; false if the clock can't be read
+    bool readDeviceClock(double& seconds) const;
+
+    void renderThreadFunc();
+    // Fill free device buffer space from frame_source_; called by the render thread only
+    void fillFromSource();
+    void stopRenderThread();
 };
\ No newline at end of file
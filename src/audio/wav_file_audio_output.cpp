@@ -0,0 +1,91 @@
+#include "wav_file_audio_output.h"
+#include <log/log_manager.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    constexpr uint16_t WAVE_FORMAT_PCM_TAG = 1;
+    constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT_TAG = 3;
+    // RIFF chunk sizes are 32 bits; stop growing the header past that
+    constexpr uint64_t MAX_DATA_BYTES = UINT32_MAX - 64;
+
+    template <typename T>
+    void writeLe(std::ofstream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+}
+
+WavFileAudioOutput::WavFileAudioOutput(std::string path)
+    : path_(std::move(path))
+{
+}
+
+WavFileAudioOutput::~WavFileAudioOutput()
+{
+    // The render thread writes to file_ until it is stopped
+    stopRenderThread();
+    finalize();
+}
+
+bool WavFileAudioOutput::initialize(int sample_rate, int channels, int bits_per_sample, RenderMode mode)
+{
+    if (!NullAudioOutput::initialize(sample_rate, channels, bits_per_sample, mode)) {
+        return false;
+    }
+    finalize();
+    file_.open(path_, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        LOG_ERROR("WavFileAudioOutput: failed to create {}", path_);
+        return false;
+    }
+    data_bytes_ = 0;
+    writeHeader();
+    return static_cast<bool>(file_);
+}
+
+bool WavFileAudioOutput::stop()
+{
+    bool result = NullAudioOutput::stop();
+    finalize();
+    return result;
+}
+
+void WavFileAudioOutput::consume(const uint8_t* data, size_t size)
+{
+    if (!file_.is_open()) return;
+    file_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    data_bytes_ += size;
+}
+
+/*************** Private Methods ***************/
+void WavFileAudioOutput::writeHeader()
+{
+    const uint16_t channelCount = static_cast<uint16_t>(channels());
+    const uint16_t bits = static_cast<uint16_t>(bitsPerSample());
+    const uint32_t rate = static_cast<uint32_t>(sampleRate());
+    const uint16_t blockAlign = static_cast<uint16_t>(channelCount * (bits / 8));
+    const uint32_t dataBytes = static_cast<uint32_t>(std::min(data_bytes_, MAX_DATA_BYTES));
+
+    file_.seekp(0);
+    file_.write("RIFF", 4);
+    writeLe<uint32_t>(file_, 36 + dataBytes);
+    file_.write("WAVE", 4);
+    file_.write("fmt ", 4);
+    writeLe<uint32_t>(file_, 16);
+    writeLe<uint16_t>(file_, bits == 32 ? WAVE_FORMAT_IEEE_FLOAT_TAG : WAVE_FORMAT_PCM_TAG);
+    writeLe<uint16_t>(file_, channelCount);
+    writeLe<uint32_t>(file_, rate);
+    writeLe<uint32_t>(file_, rate * blockAlign);
+    writeLe<uint16_t>(file_, blockAlign);
+    writeLe<uint16_t>(file_, bits);
+    file_.write("data", 4);
+    writeLe<uint32_t>(file_, dataBytes);
+}
+
+void WavFileAudioOutput::finalize()
+{
+    if (!file_.is_open()) return;
+    writeHeader();
+    file_.close();
+    LOG_INFO("WavFileAudioOutput: wrote {} bytes of PCM to {}", data_bytes_, path_);
+}
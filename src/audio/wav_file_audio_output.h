@@ -0,0 +1,40 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include "null_audio_output.h"
+
+/**
+ * WavFileAudioOutput - headless IAudioOutput that writes everything it consumes to a WAV file.
+ *
+ * Like NullAudioOutput it runs faster than realtime; the file holds the exact PCM the
+ * pipeline delivered (16-bit integer or 32-bit float, as passed to initialize()), which
+ * makes it usable for bit-exact pipeline checks. The header is completed when the output
+ * is stopped or destroyed.
+ */
+class WavFileAudioOutput : public NullAudioOutput
+{
+public:
+    explicit WavFileAudioOutput(std::string path);
+    ~WavFileAudioOutput() override;
+
+    // Creates (truncates) the file; fails if it can't be opened
+    bool initialize(int sample_rate, int channels, int bits_per_sample = 16,
+                    RenderMode mode = RenderMode::Push) override;
+    // Also finalizes the file
+    bool stop() override;
+
+    const std::string& path() const { return path_; }
+    uint64_t dataBytes() const { return data_bytes_; }
+
+protected:
+    void consume(const uint8_t* data, size_t size) override;
+
+private:
+    void writeHeader();
+    void finalize();
+
+    std::string path_;
+    std::ofstream file_;
+    uint64_t data_bytes_ = 0;
+};
@@ -0,0 +1,183 @@
+#include "waveform_overview.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace audio {
+
+namespace {
+    constexpr size_t MAGIC_SIZE = 4;
+    constexpr size_t HEADER_SIZE = MAGIC_SIZE + 4;
+
+    uint8_t quantize(double level)
+    {
+        return static_cast<uint8_t>(std::lround(std::clamp(level, 0.0, 1.0) * 255.0));
+    }
+}
+
+// ---------------- WaveformOverview ----------------
+
+std::vector<uint8_t> WaveformOverview::serialize() const
+{
+    const uint32_t count = static_cast<uint32_t>(peaks.size());
+    std::vector<uint8_t> data(FILE_MAGIC, FILE_MAGIC + MAGIC_SIZE);
+    for (int shift = 0; shift < 32; shift += 8) {
+        data.push_back(static_cast<uint8_t>(count >> shift));
+    }
+    data.insert(data.end(), peaks.begin(), peaks.end());
+    data.insert(data.end(), rms.begin(), rms.end());
+    return data;
+}
+
+std::optional<WaveformOverview> WaveformOverview::parse(const uint8_t* data, size_t size)
+{
+    if (!data || size < HEADER_SIZE || std::memcmp(data, FILE_MAGIC, MAGIC_SIZE) != 0) {
+        return std::nullopt;
+    }
+    uint32_t count = 0;
+    for (int i = 0; i < 4; ++i) {
+        count |= static_cast<uint32_t>(data[MAGIC_SIZE + i]) << (8 * i);
+    }
+    if (count == 0 || count > BUCKETS || size != HEADER_SIZE + 2 * static_cast<size_t>(count)) {
+        return std::nullopt;
+    }
+    WaveformOverview overview;
+    const uint8_t* values = data + HEADER_SIZE;
+    overview.peaks.assign(values, values + count);
+    overview.rms.assign(values + count, values + 2 * count);
+    return overview;
+}
+
+bool WaveformOverview::save(const std::string& path) const
+{
+    const fs::path file = fs::u8path(path);
+    std::error_code ec;
+    if (file.has_parent_path()) {
+        fs::create_directories(file.parent_path(), ec);
+    }
+    fs::path tempPath = file;
+    tempPath += ".tmp";
+    {
+        const std::vector<uint8_t> data = serialize();
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            out.close();
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tempPath, file, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+std::optional<WaveformOverview> WaveformOverview::load(const std::string& path)
+{
+    std::ifstream in(fs::u8path(path), std::ios::binary);
+    if (!in.is_open()) {
+        return std::nullopt;
+    }
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parse(data.data(), data.size());
+}
+
+// ---------------- WaveformBuilder ----------------
+
+WaveformBuilder::WaveformBuilder(int channels)
+    : channels_(static_cast<size_t>(std::max(1, channels)))
+{
+    blocks_.reserve(MAX_BLOCKS);
+}
+
+void WaveformBuilder::addFloat(const float* samples, size_t frames)
+{
+    add(samples, frames, 1.0f);
+}
+
+void WaveformBuilder::addS16(const int16_t* samples, size_t frames)
+{
+    add(samples, frames, 1.0f / 32768.0f);
+}
+
+WaveformOverview WaveformBuilder::finish() const
+{
+    std::vector<Block> blocks = blocks_;
+    if (currentFrames_ > 0) {
+        blocks.push_back(current_);
+    }
+    WaveformOverview overview;
+    if (blocks.empty()) {
+        return overview;
+    }
+
+    const size_t buckets = std::min(WaveformOverview::BUCKETS, blocks.size());
+    overview.peaks.reserve(buckets);
+    overview.rms.reserve(buckets);
+    for (size_t bucket = 0; bucket < buckets; ++bucket) {
+        const size_t begin = bucket * blocks.size() / buckets;
+        const size_t end = (bucket + 1) * blocks.size() / buckets;
+        Block merged;
+        for (size_t i = begin; i < end; ++i) {
+            merged.peak = std::max(merged.peak, blocks[i].peak);
+            merged.sumSquares += blocks[i].sumSquares;
+            merged.samples += blocks[i].samples;
+        }
+        overview.peaks.push_back(quantize(merged.peak));
+        overview.rms.push_back(quantize(merged.samples > 0 ? std::sqrt(merged.sumSquares / merged.samples) : 0.0));
+    }
+    return overview;
+}
+
+/*************** Private Methods ***************/
+template<typename Sample>
+void WaveformBuilder::add(const Sample* samples, size_t frames, float scale)
+{
+    if (!samples) {
+        return;
+    }
+    for (size_t frame = 0; frame < frames; ++frame) {
+        for (size_t channel = 0; channel < channels_; ++channel) {
+            const float value = static_cast<float>(samples[frame * channels_ + channel]) * scale;
+            current_.peak = std::max(current_.peak, std::fabs(value));
+            current_.sumSquares += static_cast<double>(value) * value;
+        }
+        current_.samples += channels_;
+        if (++currentFrames_ == blockFrames_) {
+            closeBlock();
+        }
+    }
+    frames_ += frames;
+}
+
+void WaveformBuilder::closeBlock()
+{
+    blocks_.push_back(current_);
+    current_ = Block();
+    currentFrames_ = 0;
+    if (blocks_.size() == MAX_BLOCKS) {
+        halve();
+    }
+}
+
+void WaveformBuilder::halve()
+{
+    // MAX_BLOCKS is even, so every block has a partner
+    for (size_t i = 0; i < blocks_.size() / 2; ++i) {
+        const Block& a = blocks_[2 * i];
+        const Block& b = blocks_[2 * i + 1];
+        blocks_[i] = Block{std::max(a.peak, b.peak), a.sumSquares + b.sumSquares, a.samples + b.samples};
+    }
+    blocks_.resize(blocks_.size() / 2);
+    blockFrames_ *= 2;
+}
+
+} // namespace audio
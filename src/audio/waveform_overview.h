@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace audio {
+
+/**
+ * @brief Peak and RMS outline of a whole track for the seek bar: up to BUCKETS values
+ * of each, 0..255 for silence..full scale, all channels together.
+ *
+ * Saved as a small binary file (FILE_MAGIC, the bucket count as 32-bit little-endian,
+ * the peaks, then the RMS values), about 2 KB per song.
+ */
+struct WaveformOverview {
+    static constexpr size_t BUCKETS = 1000;
+    static constexpr const char* FILE_MAGIC = "WFO1";
+    static constexpr const char* FILE_EXTENSION = ".wave";
+
+    std::vector<uint8_t> peaks;
+    std::vector<uint8_t> rms;
+
+    bool empty() const { return peaks.empty(); }
+
+    std::vector<uint8_t> serialize() const;
+    // nullopt unless data is a whole serialized overview
+    static std::optional<WaveformOverview> parse(const uint8_t* data, size_t size);
+
+    // UTF-8 path; written to a sibling file and renamed into place, directories created
+    bool save(const std::string& path) const;
+    static std::optional<WaveformOverview> load(const std::string& path);
+};
+
+/**
+ * @brief Builds a WaveformOverview from interleaved PCM as it is decoded, without
+ * knowing the track length up front.
+ *
+ * Samples are folded into blocks (peak and sum of squares) of blockFrames() sample-frames.
+ * Whenever MAX_BLOCKS are held, neighbouring blocks are merged and the block length
+ * doubles, so memory stays bounded for any length; finish() spreads the blocks over the
+ * buckets. Tracks shorter than BUCKETS blocks get one bucket per block.
+ */
+class WaveformBuilder {
+public:
+    static constexpr size_t INITIAL_BLOCK_FRAMES = 256;
+    static constexpr size_t MAX_BLOCKS = 8 * WaveformOverview::BUCKETS;
+
+    explicit WaveformBuilder(int channels);
+
+    void addFloat(const float* samples, size_t frames);
+    void addS16(const int16_t* samples, size_t frames);
+
+    uint64_t frames() const { return frames_; }
+    size_t blockFrames() const { return blockFrames_; }
+    // The overview of everything added; empty if nothing was
+    WaveformOverview finish() const;
+
+private:
+    struct Block {
+        float peak = 0.0f;
+        double sumSquares = 0.0;
+        uint64_t samples = 0;
+    };
+
+    template<typename Sample>
+    void add(const Sample* samples, size_t frames, float scale);
+    void closeBlock();
+    // Merge neighbouring blocks, doubling the block length
+    void halve();
+
+    size_t channels_;
+    size_t blockFrames_ = INITIAL_BLOCK_FRAMES;
+    std::vector<Block> blocks_;
+    Block current_;
+    size_t currentFrames_ = 0;
+    uint64_t frames_ = 0;
+};
+
+} // namespace audio
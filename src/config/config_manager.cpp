@@ -4,18 +4,29 @@
 #include <QStandardPaths>
 #include <QFileInfo>
 #include <QRegularExpression>
+#include <QTimer>
 #include <fmt/format.h>
 
 ConfigManager::ConfigManager(QObject* parent)
     : QObject(parent)
     , m_settings(nullptr)
+    , m_snapshot(std::make_shared<ConfigSnapshot>())
+    , m_flushTimer(new QTimer(this))
 {
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_DELAY_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &ConfigManager::saveToFile);
     LOG_DEBUG("ConfigManager created");
 }
 
 ConfigManager::~ConfigManager()
 {
     if (m_settings) {
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            writePendingUnsafe();
+            m_settings->sync();
+        }
         delete m_settings;
     }
     LOG_DEBUG("ConfigManager destroyed");
@@ -275,9 +286,12 @@ void ConfigManager::loadFromFile()
     
     LOG_INFO("Loading configuration from file");
     
-    // Cache frequently used values
-    m_currentTheme = m_settings->value("ui/theme", "dark").toString();
-    m_currentLanguage = m_settings->value("ui/language", "en").toString();
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        // Changes not written yet still win over the file
+        writePendingUnsafe();
+        std::atomic_store(&m_snapshot, std::shared_ptr<const ConfigSnapshot>(readSnapshotUnsafe()));
+    }
     
     // Ensure user-configurable directories exist
     ensureUserDirectoriesExist();
@@ -315,6 +329,9 @@ void ConfigManager::saveToFile()
     }
     
     LOG_DEBUG("Saving configuration to file");
+    m_flushTimer->stop();
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    writePendingUnsafe();
     m_settings->sync();
     
     if (m_settings->status() != QSettings::NoError) {
@@ -324,35 +341,120 @@ void ConfigManager::saveToFile()
     }
 }
 
+std::shared_ptr<ConfigSnapshot> ConfigManager::readSnapshotUnsafe() const
+{
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    ConfigSnapshot& s = *snapshot;
+    const auto read = [this](const char* key, const QVariant& defaultValue) {
+        return m_settings->value(key, defaultValue);
+    };
+    
+    s.playlistDirectory = getAbsolutePath(read("directories/playlists", s.playlistDirectory).toString());
+    s.themeDirectory = getAbsolutePath(read("directories/themes", s.themeDirectory).toString());
+    s.audioCacheDirectory = getAbsolutePath(read("directories/audio_cache", s.audioCacheDirectory).toString());
+    s.coverCacheDirectory = getAbsolutePath(read("directories/cover_cache", s.coverCacheDirectory).toString());
+    s.platformDirectory = getAbsolutePath(read("directories/platform", s.platformDirectory).toString());
+    s.audioCacheBudgetMB = read("directories/audio_cache_budget_mb", s.audioCacheBudgetMB).toInt();
+    s.coverCacheBudgetMB = read("directories/cover_cache_budget_mb", s.coverCacheBudgetMB).toInt();
+    s.coverThumbnailSize = read("directories/cover_thumbnail_size", s.coverThumbnailSize).toInt();
+    
+    s.networkTimeout = read("network/timeout", s.networkTimeout).toInt();
+    s.proxyUrl = read("network/proxy_url", s.proxyUrl).toString();
+    s.pageCacheTtlHours = read("network/page_cache_ttl_hours", s.pageCacheTtlHours).toInt();
+    s.connectionWarmUpEnabled = read("network/warm_up", s.connectionWarmUpEnabled).toBool();
+    s.prefetchTrackCount = read("network/prefetch_tracks", s.prefetchTrackCount).toInt();
+    s.prefetchBandwidthKBps = read("network/prefetch_bandwidth_kbps", s.prefetchBandwidthKBps).toInt();
+    s.prefetchDiskBudgetMB = read("network/prefetch_disk_budget_mb", s.prefetchDiskBudgetMB).toInt();
+    s.audioQuality = read("network/audio_quality", s.audioQuality).toString();
+    
+    s.theme = read("ui/theme", s.theme).toString();
+    s.language = read("ui/language", s.language).toString();
+    s.accentColor = QColor(read("ui/accent_color", s.accentColor.name()).toString());
+    
+    s.categoriesFilePath = read("playlists/category_file_path", s.categoriesFilePath).toString();
+    s.autoSaveEnabled = read("playlists/auto_save", s.autoSaveEnabled).toBool();
+    s.autoSaveInterval = read("playlists/auto_save_interval", s.autoSaveInterval).toInt();
+    s.playlistStorage = read("playlists/storage", s.playlistStorage).toString();
+    
+    s.volumeLevel = read("audio/volume_level", s.volumeLevel).toInt();
+    s.playMode = read("audio/play_mode", s.playMode).toInt();
+    s.currentPlaylistId = read("audio/current_playlist_id", s.currentPlaylistId).toString();
+    s.currentAudioIndex = read("audio/current_audio_index", s.currentAudioIndex).toInt();
+    s.decodeAheadMinMs = read("audio/decode_ahead_min_ms", s.decodeAheadMinMs).toInt();
+    s.decodeAheadMaxMs = read("audio/decode_ahead_max_ms", s.decodeAheadMaxMs).toInt();
+    s.telemetryLogInterval = read("audio/telemetry_log_interval", s.telemetryLogInterval).toInt();
+    s.pcmCacheBudgetMb = read("audio/pcm_cache_budget_mb", s.pcmCacheBudgetMb).toInt();
+    s.crossfadeMs = read("audio/crossfade_ms", s.crossfadeMs).toInt();
+    s.loudnessNormalization = read("audio/loudness_normalization", s.loudnessNormalization).toBool();
+    s.cacheTranscodeEnabled = read("audio/cache_transcode", s.cacheTranscodeEnabled).toBool();
+    s.cacheTranscodeBitrateKbps = read("audio/cache_transcode_bitrate_kbps", s.cacheTranscodeBitrateKbps).toInt();
+    s.warmRestore = read("audio/warm_restore", s.warmRestore).toBool();
+    
+    s.playlistTitleWidth = read("playlist_ui/column_width_title", s.playlistTitleWidth).toInt();
+    s.playlistUploaderWidth = read("playlist_ui/column_width_uploader", s.playlistUploaderWidth).toInt();
+    s.playlistPlatformWidth = read("playlist_ui/column_width_platform", s.playlistPlatformWidth).toInt();
+    s.playlistDurationWidth = read("playlist_ui/column_width_duration", s.playlistDurationWidth).toInt();
+    
+    s.memoryBudgetMb = read("memory/budget_mb", s.memoryBudgetMb).toInt();
+
+    s.traceEnabled = read("diagnostics/trace_enabled", s.traceEnabled).toBool();
+    return snapshot;
+}
+
+template <typename Apply>
+void ConfigManager::update(const QString& key, const QVariant& value, Apply&& apply)
+{
+    bool firstPending;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        auto next = std::make_shared<ConfigSnapshot>(*std::atomic_load(&m_snapshot));
+        apply(*next);
+        std::atomic_store(&m_snapshot, std::shared_ptr<const ConfigSnapshot>(std::move(next)));
+        firstPending = m_pendingWrites.isEmpty();
+        m_pendingWrites.insert(key, value);
+    }
+    if (firstPending) {
+        // Setters may run on other threads; the timer lives on ours
+        QMetaObject::invokeMethod(this, [this]() {
+            if (!m_flushTimer->isActive()) {
+                m_flushTimer->start();
+            }
+        });
+    }
+}
+
+void ConfigManager::writePendingUnsafe()
+{
+    for (auto it = m_pendingWrites.cbegin(); it != m_pendingWrites.cend(); ++it) {
+        m_settings->setValue(it.key(), it.value());
+    }
+    m_pendingWrites.clear();
+}
+
 // User-configurable paths
 QString ConfigManager::getPlaylistDirectory() const
 {
-    QString relativePath = m_settings ? m_settings->value("directories/playlists", "config/playlists").toString() : "config/playlists";
-    return getAbsolutePath(relativePath);
+    return snapshot()->playlistDirectory;
 }
 
 QString ConfigManager::getThemeDirectory() const
 {
-    QString relativePath = m_settings ? m_settings->value("directories/themes", "config/themes").toString() : "config/themes";
-    return getAbsolutePath(relativePath);
+    return snapshot()->themeDirectory;
 }
 
 QString ConfigManager::getAudioCacheDirectory() const
 {
-    QString relativePath = m_settings ? m_settings->value("directories/audio_cache", "tmp/audio").toString() : "tmp/audio";
-    return getAbsolutePath(relativePath);
+    return snapshot()->audioCacheDirectory;
 }
 
 QString ConfigManager::getCoverCacheDirectory() const
 {
-    QString relativePath = m_settings ? m_settings->value("directories/cover_cache", "tmp/covers").toString() : "tmp/covers";
-    return getAbsolutePath(relativePath);
+    return snapshot()->coverCacheDirectory;
 }
 
 QString ConfigManager::getPlatformDirectory() const
 {
-    QString relativePath = m_settings ? m_settings->value("directories/platform", "config/platform").toString() : "config/platform";
-    return getAbsolutePath(relativePath);
+    return snapshot()->platformDirectory;
 }
 
 void ConfigManager::setPlaylistDirectory(const QString& relativePath)
@@ -365,7 +467,7 @@ void ConfigManager::setPlaylistDirectory(const QString& relativePath)
         return;
     }
     
-    m_settings->setValue("directories/playlists", sanitizedPath);
+    update("directories/playlists", sanitizedPath, [&](ConfigSnapshot& snapshot) { snapshot.playlistDirectory = getAbsolutePath(sanitizedPath); });
     LOG_INFO("Playlist directory changed to: {}", sanitizedPath.toStdString());
     emit playlistDirectoryChanged(sanitizedPath);
 }
@@ -380,7 +482,7 @@ void ConfigManager::setThemeDirectory(const QString& relativePath)
         return;
     }
     
-    m_settings->setValue("directories/themes", sanitizedPath);
+    update("directories/themes", sanitizedPath, [&](ConfigSnapshot& snapshot) { snapshot.themeDirectory = getAbsolutePath(sanitizedPath); });
     LOG_INFO("Theme directory changed to: {}", sanitizedPath.toStdString());
 }
 
@@ -394,7 +496,7 @@ void ConfigManager::setAudioCacheDirectory(const QString& relativePath)
         return;
     }
     
-    m_settings->setValue("directories/audio_cache", sanitizedPath);
+    update("directories/audio_cache", sanitizedPath, [&](ConfigSnapshot& snapshot) { snapshot.audioCacheDirectory = getAbsolutePath(sanitizedPath); });
     LOG_INFO("Audio cache directory changed to: {}", sanitizedPath.toStdString());
 }
 
@@ -408,7 +510,7 @@ void ConfigManager::setCoverCacheDirectory(const QString& relativePath)
         return;
     }
     
-    m_settings->setValue("directories/cover_cache", sanitizedPath);
+    update("directories/cover_cache", sanitizedPath, [&](ConfigSnapshot& snapshot) { snapshot.coverCacheDirectory = getAbsolutePath(sanitizedPath); });
     LOG_INFO("Cover cache directory changed to: {}", sanitizedPath.toStdString());
 }
 
@@ -422,26 +524,64 @@ void ConfigManager::setPlatformDirectory(const QString &relativePath)
         return;
     }
     
-    m_settings->setValue("directories/platform", sanitizedPath);
+    update("directories/platform", sanitizedPath, [&](ConfigSnapshot& snapshot) { snapshot.platformDirectory = getAbsolutePath(sanitizedPath); });
     LOG_INFO("Platform directory changed to: {}", sanitizedPath.toStdString());
 }
 
+int ConfigManager::getAudioCacheBudgetMB() const
+{
+    return snapshot()->audioCacheBudgetMB;
+}
+
+void ConfigManager::setAudioCacheBudgetMB(int megabytes)
+{
+    if (!m_settings) return;
+    update("directories/audio_cache_budget_mb", megabytes, [&](ConfigSnapshot& snapshot) { snapshot.audioCacheBudgetMB = megabytes; });
+    LOG_INFO("Audio cache budget changed to: {} MB", megabytes);
+    emit audioCacheBudgetChanged(megabytes);
+}
+
+int ConfigManager::getCoverCacheBudgetMB() const
+{
+    return snapshot()->coverCacheBudgetMB;
+}
+
+void ConfigManager::setCoverCacheBudgetMB(int megabytes)
+{
+    if (!m_settings) return;
+    update("directories/cover_cache_budget_mb", megabytes, [&](ConfigSnapshot& snapshot) { snapshot.coverCacheBudgetMB = megabytes; });
+    LOG_INFO("Cover cache budget changed to: {} MB", megabytes);
+    emit coverCacheBudgetChanged(megabytes);
+}
+
+int ConfigManager::getCoverThumbnailSize() const
+{
+    return snapshot()->coverThumbnailSize;
+}
+
+void ConfigManager::setCoverThumbnailSize(int pixels)
+{
+    if (!m_settings) return;
+    update("directories/cover_thumbnail_size", pixels, [&](ConfigSnapshot& snapshot) { snapshot.coverThumbnailSize = pixels; });
+    LOG_INFO("Cover thumbnail size changed to: {} px", pixels);
+}
+
 // Network settings
 
 int ConfigManager::getNetworkTimeout() const
 {
-    return m_settings ? m_settings->value("network/timeout", 30000).toInt() : 30000;
+    return snapshot()->networkTimeout;
 }
 
 QString ConfigManager::getProxyUrl() const
 {
-    return m_settings ? m_settings->value("network/proxy_url", "").toString() : "";
+    return snapshot()->proxyUrl;
 }
 
 void ConfigManager::setNetworkTimeout(int timeoutMs)
 {
     if (!m_settings) return;
-    m_settings->setValue("network/timeout", timeoutMs);
+    update("network/timeout", timeoutMs, [&](ConfigSnapshot& snapshot) { snapshot.networkTimeout = timeoutMs; });
     LOG_INFO("Network timeout changed to: {}ms", timeoutMs);
     emit networkSettingsChanged();
 }
@@ -449,35 +589,111 @@ void ConfigManager::setNetworkTimeout(int timeoutMs)
 void ConfigManager::setProxyUrl(const QString& url)
 {
     if (!m_settings) return;
-    m_settings->setValue("network/proxy_url", url);
+    update("network/proxy_url", url, [&](ConfigSnapshot& snapshot) { snapshot.proxyUrl = url; });
     LOG_INFO("Proxy URL changed to: {}", url.toStdString());
     emit networkSettingsChanged();
 }
 
+int ConfigManager::getPageCacheTtlHours() const
+{
+    return snapshot()->pageCacheTtlHours;
+}
+
+void ConfigManager::setPageCacheTtlHours(int hours)
+{
+    if (!m_settings) return;
+    update("network/page_cache_ttl_hours", hours, [&](ConfigSnapshot& snapshot) { snapshot.pageCacheTtlHours = hours; });
+    LOG_INFO("Page cache TTL changed to: {} hours", hours);
+    emit networkSettingsChanged();
+}
+
+bool ConfigManager::getConnectionWarmUpEnabled() const
+{
+    return snapshot()->connectionWarmUpEnabled;
+}
+
+void ConfigManager::setConnectionWarmUpEnabled(bool enabled)
+{
+    if (!m_settings) return;
+    update("network/warm_up", enabled, [&](ConfigSnapshot& snapshot) { snapshot.connectionWarmUpEnabled = enabled; });
+    LOG_INFO("Connection warm-up {}", enabled ? "enabled" : "disabled");
+    emit networkSettingsChanged();
+}
+
+int ConfigManager::getPrefetchTrackCount() const
+{
+    return snapshot()->prefetchTrackCount;
+}
+
+int ConfigManager::getPrefetchBandwidthKBps() const
+{
+    return snapshot()->prefetchBandwidthKBps;
+}
+
+int ConfigManager::getPrefetchDiskBudgetMB() const
+{
+    return snapshot()->prefetchDiskBudgetMB;
+}
+
+void ConfigManager::setPrefetchTrackCount(int tracks)
+{
+    if (!m_settings) return;
+    update("network/prefetch_tracks", tracks, [&](ConfigSnapshot& snapshot) { snapshot.prefetchTrackCount = tracks; });
+    LOG_INFO("Prefetch track count changed to: {}", tracks);
+    emit networkSettingsChanged();
+}
+
+void ConfigManager::setPrefetchBandwidthKBps(int kbps)
+{
+    if (!m_settings) return;
+    update("network/prefetch_bandwidth_kbps", kbps, [&](ConfigSnapshot& snapshot) { snapshot.prefetchBandwidthKBps = kbps; });
+    LOG_INFO("Prefetch bandwidth changed to: {} KB/s", kbps);
+    emit networkSettingsChanged();
+}
+
+void ConfigManager::setPrefetchDiskBudgetMB(int megabytes)
+{
+    if (!m_settings) return;
+    update("network/prefetch_disk_budget_mb", megabytes, [&](ConfigSnapshot& snapshot) { snapshot.prefetchDiskBudgetMB = megabytes; });
+    LOG_INFO("Prefetch disk budget changed to: {} MB", megabytes);
+    emit networkSettingsChanged();
+}
+
+QString ConfigManager::getAudioQuality() const
+{
+    return snapshot()->audioQuality;
+}
+
+void ConfigManager::setAudioQuality(const QString& quality)
+{
+    if (!m_settings) return;
+    update("network/audio_quality", quality, [&](ConfigSnapshot& snapshot) { snapshot.audioQuality = quality; });
+    LOG_INFO("Audio quality changed to: {}", quality.toStdString());
+    emit networkSettingsChanged();
+}
+
 // UI settings
 QString ConfigManager::getTheme() const
 {
-    return m_currentTheme;
+    return snapshot()->theme;
 }
 
 QString ConfigManager::getLanguage() const
 {
-    return m_currentLanguage;
+    return snapshot()->language;
 }
 
 QColor ConfigManager::getAccentColor() const
 {
-    QString colorStr = m_settings ? m_settings->value("ui/accent_color", "#3498db").toString() : "#3498db";
-    return QColor(colorStr);
+    return snapshot()->accentColor;
 }
 
 void ConfigManager::setTheme(const QString& theme)
 {
     if (!m_settings) return;
     
-    if (m_currentTheme != theme) {
-        m_currentTheme = theme;
-        m_settings->setValue("ui/theme", theme);
+    if (snapshot()->theme != theme) {
+        update("ui/theme", theme, [&](ConfigSnapshot& snapshot) { snapshot.theme = theme; });
         LOG_INFO("Theme changed to: {}", theme.toStdString());
         emit themeChanged(theme);
     }
@@ -487,9 +703,8 @@ void ConfigManager::setLanguage(const QString& language)
 {
     if (!m_settings) return;
     
-    if (m_currentLanguage != language) {
-        m_currentLanguage = language;
-        m_settings->setValue("ui/language", language);
+    if (snapshot()->language != language) {
+        update("ui/language", language, [&](ConfigSnapshot& snapshot) { snapshot.language = language; });
         LOG_INFO("Language changed to: {}", language.toStdString());
         emit languageChanged(language);
     }
@@ -499,7 +714,7 @@ void ConfigManager::setAccentColor(const QColor& color)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("ui/accent_color", color.name());
+    update("ui/accent_color", color.name(), [&](ConfigSnapshot& snapshot) { snapshot.accentColor = color; });
     LOG_INFO("Accent color changed to: {}", color.name().toStdString());
     emit accentColorChanged(color);
 }
@@ -508,17 +723,17 @@ void ConfigManager::setAccentColor(const QColor& color)
 
 QString ConfigManager::getCategoriesFilePath() const
 {
-    return m_settings ? m_settings->value("playlists/category_file_path", "config/playlists/categories.json").toString() : "config/playlists/categories.json";
+    return snapshot()->categoriesFilePath;
 }
 
 bool ConfigManager::getAutoSaveEnabled() const
 {
-    return m_settings ? m_settings->value("playlists/auto_save", true).toBool() : true;
+    return snapshot()->autoSaveEnabled;
 }
 
 int ConfigManager::getAutoSaveInterval() const
 {
-    return m_settings ? m_settings->value("playlists/auto_save_interval", 5).toInt() : 5;
+    return snapshot()->autoSaveInterval;
 }
 
 QString ConfigManager::setCategoriesFilePath(const QString& relativePath)
@@ -531,7 +746,7 @@ QString ConfigManager::setCategoriesFilePath(const QString& relativePath)
         return QString();
     }
     
-    m_settings->setValue("playlists/category_file_path", sanitizedPath);
+    update("playlists/category_file_path", sanitizedPath, [&](ConfigSnapshot& snapshot) { snapshot.categoriesFilePath = sanitizedPath; });
     LOG_INFO("Categories file path changed to: {}", sanitizedPath.toStdString());
     return sanitizedPath;
 }
@@ -540,7 +755,7 @@ void ConfigManager::setAutoSaveEnabled(bool enabled)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("playlists/auto_save", enabled);
+    update("playlists/auto_save", enabled, [&](ConfigSnapshot& snapshot) { snapshot.autoSaveEnabled = enabled; });
     LOG_INFO("Auto-save enabled: {}", enabled);
 }
 
@@ -548,119 +763,288 @@ void ConfigManager::setAutoSaveInterval(int intervalMinutes)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("playlists/auto_save_interval", intervalMinutes);
+    update("playlists/auto_save_interval", intervalMinutes, [&](ConfigSnapshot& snapshot) { snapshot.autoSaveInterval = intervalMinutes; });
     LOG_INFO("Auto-save interval changed to: {} minutes", intervalMinutes);
 }
 
+QString ConfigManager::getPlaylistStorage() const
+{
+    return snapshot()->playlistStorage;
+}
+
+void ConfigManager::setPlaylistStorage(const QString& storage)
+{
+    if (!m_settings) return;
+    if (storage != "json" && storage != "binary" && storage != "sqlite") {
+        LOG_ERROR("Unknown playlist storage: {}", storage.toStdString());
+        return;
+    }
+    
+    update("playlists/storage", storage, [&](ConfigSnapshot& snapshot) { snapshot.playlistStorage = storage; });
+    LOG_INFO("Playlist storage changed to: {} (takes effect on restart)", storage.toStdString());
+}
+
 int ConfigManager::getVolumeLevel() const
 {
-    return m_settings ? m_settings->value("audio/volume_level", 50).toInt() : 50;
+    return snapshot()->volumeLevel;
 }
 
 void ConfigManager::setVolumeLevel(int level)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("audio/volume_level", level);
+    update("audio/volume_level", level, [&](ConfigSnapshot& snapshot) { snapshot.volumeLevel = level; });
     LOG_INFO("Volume level changed to: {}", level);
 }
 
 int ConfigManager::getPlayMode() const
 {
-    return m_settings ? m_settings->value("audio/play_mode", 0).toInt() : 0;
+    return snapshot()->playMode;
 }
 
 void ConfigManager::setPlayMode(int mode)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("audio/play_mode", mode);
+    update("audio/play_mode", mode, [&](ConfigSnapshot& snapshot) { snapshot.playMode = mode; });
     LOG_INFO("Play mode changed to: {}", mode);
 }
 
 QString ConfigManager::getCurrentPlaylistId() const
 {
-    return m_settings ? m_settings->value("audio/current_playlist_id", "").toString() : "";
+    return snapshot()->currentPlaylistId;
 }
 
 void ConfigManager::setCurrentPlaylistId(const QString& playlistId)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("audio/current_playlist_id", playlistId);
+    update("audio/current_playlist_id", playlistId, [&](ConfigSnapshot& snapshot) { snapshot.currentPlaylistId = playlistId; });
     LOG_INFO("Current playlist ID changed to: {}", playlistId.toStdString());
 }
 
 int ConfigManager::getCurrentAudioIndex() const
 {
-    return m_settings ? m_settings->value("audio/current_audio_index", 0).toInt() : 0;
+    return snapshot()->currentAudioIndex;
 }
 
 void ConfigManager::setCurrentAudioIndex(int index)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("audio/current_audio_index", index);
+    update("audio/current_audio_index", index, [&](ConfigSnapshot& snapshot) { snapshot.currentAudioIndex = index; });
     LOG_DEBUG("Current audio index changed to: {}", index);
 }
 
+int ConfigManager::getDecodeAheadMinMs() const
+{
+    return snapshot()->decodeAheadMinMs;
+}
+
+void ConfigManager::setDecodeAheadMinMs(int ms)
+{
+    if (!m_settings) return;
+    
+    update("audio/decode_ahead_min_ms", ms, [&](ConfigSnapshot& snapshot) { snapshot.decodeAheadMinMs = ms; });
+    LOG_INFO("Decode-ahead minimum changed to: {} ms", ms);
+}
+
+int ConfigManager::getDecodeAheadMaxMs() const
+{
+    return snapshot()->decodeAheadMaxMs;
+}
+
+void ConfigManager::setDecodeAheadMaxMs(int ms)
+{
+    if (!m_settings) return;
+    
+    update("audio/decode_ahead_max_ms", ms, [&](ConfigSnapshot& snapshot) { snapshot.decodeAheadMaxMs = ms; });
+    LOG_INFO("Decode-ahead maximum changed to: {} ms", ms);
+}
+
+int ConfigManager::getTelemetryLogInterval() const
+{
+    return snapshot()->telemetryLogInterval;
+}
+
+void ConfigManager::setTelemetryLogInterval(int seconds)
+{
+    if (!m_settings) return;
+    
+    update("audio/telemetry_log_interval", seconds, [&](ConfigSnapshot& snapshot) { snapshot.telemetryLogInterval = seconds; });
+    LOG_INFO("Telemetry log interval changed to: {} s", seconds);
+}
+
+int ConfigManager::getPcmCacheBudgetMb() const
+{
+    return snapshot()->pcmCacheBudgetMb;
+}
+
+void ConfigManager::setPcmCacheBudgetMb(int mb)
+{
+    if (!m_settings) return;
+    
+    update("audio/pcm_cache_budget_mb", mb, [&](ConfigSnapshot& snapshot) { snapshot.pcmCacheBudgetMb = mb; });
+    LOG_INFO("Decoded PCM cache budget changed to: {} MB", mb);
+}
+
+int ConfigManager::getCrossfadeMs() const
+{
+    return snapshot()->crossfadeMs;
+}
+
+void ConfigManager::setCrossfadeMs(int ms)
+{
+    if (!m_settings) return;
+    
+    update("audio/crossfade_ms", ms, [&](ConfigSnapshot& snapshot) { snapshot.crossfadeMs = ms; });
+    LOG_INFO("Crossfade duration changed to: {} ms", ms);
+}
+
+bool ConfigManager::getLoudnessNormalization() const
+{
+    return snapshot()->loudnessNormalization;
+}
+
+void ConfigManager::setLoudnessNormalization(bool enabled)
+{
+    if (!m_settings) return;
+    
+    update("audio/loudness_normalization", enabled, [&](ConfigSnapshot& snapshot) { snapshot.loudnessNormalization = enabled; });
+    LOG_INFO("Loudness normalization {}", enabled ? "enabled" : "disabled");
+}
+
+bool ConfigManager::getCacheTranscodeEnabled() const
+{
+    return snapshot()->cacheTranscodeEnabled;
+}
+
+void ConfigManager::setCacheTranscodeEnabled(bool enabled)
+{
+    if (!m_settings) return;
+    
+    update("audio/cache_transcode", enabled, [&](ConfigSnapshot& snapshot) { snapshot.cacheTranscodeEnabled = enabled; });
+    LOG_INFO("Audio cache transcoding {}", enabled ? "enabled" : "disabled");
+    emit cacheTranscodeChanged();
+}
+
+int ConfigManager::getCacheTranscodeBitrateKbps() const
+{
+    return snapshot()->cacheTranscodeBitrateKbps;
+}
+
+void ConfigManager::setCacheTranscodeBitrateKbps(int kbps)
+{
+    if (!m_settings) return;
+    
+    update("audio/cache_transcode_bitrate_kbps", kbps, [&](ConfigSnapshot& snapshot) { snapshot.cacheTranscodeBitrateKbps = kbps; });
+    LOG_INFO("Audio cache transcoding bitrate changed to: {} kbps", kbps);
+    emit cacheTranscodeChanged();
+}
+
+bool ConfigManager::getWarmRestore() const
+{
+    return snapshot()->warmRestore;
+}
+
+void ConfigManager::setWarmRestore(bool enabled)
+{
+    if (!m_settings) return;
+    
+    update("audio/warm_restore", enabled, [&](ConfigSnapshot& snapshot) { snapshot.warmRestore = enabled; });
+    LOG_INFO("Warm session restore {}", enabled ? "enabled" : "disabled");
+}
+
 int ConfigManager::getPlaylistTitleWidth() const
 {
-    return m_settings ? m_settings->value("playlist_ui/column_width_title", 300).toInt() : 300;
+    return snapshot()->playlistTitleWidth;
 }
 
 void ConfigManager::setPlaylistTitleWidth(int width)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("playlist_ui/column_width_title", width);
+    update("playlist_ui/column_width_title", width, [&](ConfigSnapshot& snapshot) { snapshot.playlistTitleWidth = width; });
     LOG_DEBUG("Playlist title column width changed to: {}", width);
 }
 
 int ConfigManager::getPlaylistUploaderWidth() const
 {
-    return m_settings ? m_settings->value("playlist_ui/column_width_uploader", 200).toInt() : 200;
+    return snapshot()->playlistUploaderWidth;
 }
 
 void ConfigManager::setPlaylistUploaderWidth(int width)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("playlist_ui/column_width_uploader", width);
+    update("playlist_ui/column_width_uploader", width, [&](ConfigSnapshot& snapshot) { snapshot.playlistUploaderWidth = width; });
     LOG_DEBUG("Playlist uploader column width changed to: {}", width);
 }
 
 int ConfigManager::getPlaylistPlatformWidth() const
 {
-    return m_settings ? m_settings->value("playlist_ui/column_width_platform", 120).toInt() : 120;
+    return snapshot()->playlistPlatformWidth;
 }
 
 void ConfigManager::setPlaylistPlatformWidth(int width)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("playlist_ui/column_width_platform", width);
+    update("playlist_ui/column_width_platform", width, [&](ConfigSnapshot& snapshot) { snapshot.playlistPlatformWidth = width; });
     LOG_DEBUG("Playlist platform column width changed to: {}", width);
 }
 
 int ConfigManager::getPlaylistDurationWidth() const
 {
-    return m_settings ? m_settings->value("playlist_ui/column_width_duration", 80).toInt() : 80;
+    return snapshot()->playlistDurationWidth;
 }
 
 void ConfigManager::setPlaylistDurationWidth(int width)
 {
     if (!m_settings) return;
     
-    m_settings->setValue("playlist_ui/column_width_duration", width);
+    update("playlist_ui/column_width_duration", width, [&](ConfigSnapshot& snapshot) { snapshot.playlistDurationWidth = width; });
     LOG_DEBUG("Playlist duration column width changed to: {}", width);
 }
 
+// Memory
+
+int ConfigManager::getMemoryBudgetMb() const
+{
+    return snapshot()->memoryBudgetMb;
+}
+
+void ConfigManager::setMemoryBudgetMb(int mb)
+{
+    if (!m_settings) return;
+    
+    update("memory/budget_mb", mb, [&](ConfigSnapshot& snapshot) { snapshot.memoryBudgetMb = mb; });
+    LOG_INFO("Memory budget changed to: {} MB", mb);
+    emit memoryBudgetChanged(mb);
+}
+
+// Diagnostics
+
+bool ConfigManager::getTraceEnabled() const
+{
+    return snapshot()->traceEnabled;
+}
+
+void ConfigManager::setTraceEnabled(bool enabled)
+{
+    if (!m_settings) return;
+    
+    update("diagnostics/trace_enabled", enabled, [&](ConfigSnapshot& snapshot) { snapshot.traceEnabled = enabled; });
+    LOG_INFO("Tracing {}", enabled ? "enabled" : "disabled");
+    emit traceEnabledChanged(enabled);
+}
+
 // Error logging
 void ConfigManager::logNetworkError(const QString& error)
 {
     if (!m_settings) return;
     
+    std::lock_guard<std::mutex> lock(m_writeMutex);
     // Keep last 100 errors
     QStringList errors = m_settings->value("errors/network", QStringList()).toStringList();
     errors.prepend(QString("%1: %2").arg(QDateTime::currentDateTime().toString()).arg(error));
@@ -675,5 +1059,7 @@ void ConfigManager::logNetworkError(const QString& error)
 
 QStringList ConfigManager::getRecentErrors() const
 {
-    return m_settings ? m_settings->value("errors/network", QStringList()).toStringList() : QStringList();
+    if (!m_settings) return QStringList();
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    return m_settings->value("errors/network", QStringList()).toStringList();
 }
\ No newline at end of file
@@ -5,17 +5,95 @@
 #include <QSettings>
 #include <QColor>
 #include <QDir>
+#include <QVariantHash>
+#include <memory>
+#include <mutex>
+
+class QTimer;
+
+/**
+ * Typed copy of every setting a getter returns, directories already resolved to
+ * absolute paths. Published as a whole on each change so readers never see a
+ * half-applied update.
+ */
+struct ConfigSnapshot
+{
+    // Directories (absolute)
+    QString playlistDirectory = "config/playlists";
+    QString themeDirectory = "config/themes";
+    QString audioCacheDirectory = "tmp/audio";
+    QString coverCacheDirectory = "tmp/covers";
+    QString platformDirectory = "config/platform";
+    int audioCacheBudgetMB = 2048;
+    int coverCacheBudgetMB = 256;
+    int coverThumbnailSize = 320;
+
+    // Network
+    int networkTimeout = 30000;
+    QString proxyUrl;
+    int pageCacheTtlHours = 168;
+    bool connectionWarmUpEnabled = true;
+    int prefetchTrackCount = 2;
+    int prefetchBandwidthKBps = 0;
+    int prefetchDiskBudgetMB = 256;
+    QString audioQuality = "auto";
+
+    // UI
+    QString theme = "dark";
+    QString language = "en";
+    QColor accentColor = QColor("#3498db");
+
+    // Playlists
+    QString categoriesFilePath = "config/playlists/categories.json";
+    bool autoSaveEnabled = true;
+    int autoSaveInterval = 5;
+    QString playlistStorage = "json";
+
+    // Audio
+    int volumeLevel = 50;
+    int playMode = 0;
+    QString currentPlaylistId;
+    int currentAudioIndex = 0;
+    int decodeAheadMinMs = 300;
+    int decodeAheadMaxMs = 2000;
+    int telemetryLogInterval = 0;
+    int pcmCacheBudgetMb = 256;
+    int crossfadeMs = 0;
+    bool loudnessNormalization = true;
+    bool cacheTranscodeEnabled = false;
+    int cacheTranscodeBitrateKbps = 96;
+    bool warmRestore = false;
+
+    // Playlist UI
+    int playlistTitleWidth = 300;
+    int playlistUploaderWidth = 200;
+    int playlistPlatformWidth = 120;
+    int playlistDurationWidth = 80;
+
+    // Memory
+    int memoryBudgetMb = 512;
+
+    // Diagnostics
+    bool traceEnabled = false;
+};
 
 /**
  * Configuration Manager - handles all application settings
  * All paths are relative to workspace directory for security and portability
  * Must be initialized first as other managers depend on it
+ *
+ * Getters read an in-memory ConfigSnapshot without locking and may be called from any
+ * thread. Setters publish a new snapshot at once and queue the change for config.ini;
+ * queued changes are written together FLUSH_DELAY_MS after the first one, or by
+ * saveToFile().
  */
 class ConfigManager : public QObject
 {
     Q_OBJECT
     
 public:
+    static constexpr int FLUSH_DELAY_MS = 2000;
+
     explicit ConfigManager(QObject* parent = nullptr);
     ~ConfigManager();
     
@@ -23,6 +101,8 @@ public:
     void initialize(const QString& workspaceDir);
     void loadFromFile();
     void saveToFile();
+    // The current settings, consistent with each other
+    std::shared_ptr<const ConfigSnapshot> snapshot() const { return std::atomic_load(&m_snapshot); }
     
     // Workspace management
     QString getWorkspaceDirectory() const { return m_workspaceDir; }
@@ -52,12 +132,41 @@ public:
     void setAudioCacheDirectory(const QString& relativePath);
     void setCoverCacheDirectory(const QString& relativePath);
     void setPlatformDirectory(const QString& relativePath);
+    // Disk held by finished songs in the audio cache in MB, least recently played
+    // evicted first (0 = unlimited)
+    int getAudioCacheBudgetMB() const;
+    void setAudioCacheBudgetMB(int megabytes);
+    // Disk held by cached cover images in MB, least recently shown evicted first
+    // (0 = unlimited)
+    int getCoverCacheBudgetMB() const;
+    void setCoverCacheBudgetMB(int megabytes);
+    // Longest side in pixels that covers extracted from local files are scaled down
+    // to before caching (0 = keep the original)
+    int getCoverThumbnailSize() const;
+    void setCoverThumbnailSize(int pixels);
     
     // Network settings (needed by NetworkManager)
     int getNetworkTimeout() const;
     QString getProxyUrl() const;
     void setNetworkTimeout(int timeoutMs);
     void setProxyUrl(const QString& url);
+    // Hours a video's page list is reused before asking the API again, 0 = no cache
+    int getPageCacheTtlHours() const;
+    void setPageCacheTtlHours(int hours);
+    // Pre-connect to the API and CDN hosts at startup
+    bool getConnectionWarmUpEnabled() const;
+    void setConnectionWarmUpEnabled(bool enabled);
+    // Background download of upcoming tracks: how many (0 = off), bandwidth in KB/s and
+    // disk held by not yet played ones in MB (0 = unlimited for both)
+    int getPrefetchTrackCount() const;
+    int getPrefetchBandwidthKBps() const;
+    int getPrefetchDiskBudgetMB() const;
+    void setPrefetchTrackCount(int tracks);
+    void setPrefetchBandwidthKBps(int kbps);
+    void setPrefetchDiskBudgetMB(int megabytes);
+    // Audio stream choice: "auto" (by measured throughput), "data_saver" or "best"
+    QString getAudioQuality() const;
+    void setAudioQuality(const QString& quality);
     
     // UI settings (needed by MainWindow)
     QString getTheme() const;
@@ -74,6 +183,11 @@ public:
     QString setCategoriesFilePath(const QString& relativePath);
     void setAutoSaveEnabled(bool enabled);
     void setAutoSaveInterval(int intervalMinutes);
+    // Where playlists are kept: "json" (snapshot plus journal), "binary" (the same with a
+    // memory-mapped binary snapshot) or "sqlite" (a database next to the categories file,
+    // imported from the snapshot files on first use)
+    QString getPlaylistStorage() const;
+    void setPlaylistStorage(const QString& storage);
 
     // Audio settings (needed by AudioPlayerController)
     int getVolumeLevel() const;
@@ -84,6 +198,32 @@ public:
     void setCurrentPlaylistId(const QString& playlistId);
     int getCurrentAudioIndex() const;
     void setCurrentAudioIndex(int index);
+    // Decode-ahead window: milliseconds of PCM kept queued between decoder and output
+    int getDecodeAheadMinMs() const;
+    void setDecodeAheadMinMs(int ms);
+    int getDecodeAheadMaxMs() const;
+    void setDecodeAheadMaxMs(int ms);
+    // Seconds between playback telemetry log dumps, 0 = off
+    int getTelemetryLogInterval() const;
+    void setTelemetryLogInterval(int seconds);
+    // Memory kept for fully decoded tracks replayed without decoding, 0 = off
+    int getPcmCacheBudgetMb() const;
+    void setPcmCacheBudgetMb(int mb);
+    // Overlap between consecutive tracks, 0 = plain gapless
+    int getCrossfadeMs() const;
+    void setCrossfadeMs(int ms);
+    // Play analyzed songs at a common loudness (ReplayGain-style per-track gain)
+    bool getLoudnessNormalization() const;
+    void setLoudnessNormalization(bool enabled);
+    // Transcode audio cache files not played for a while to Opus at this bitrate in the
+    // background, so the cache budget holds more songs
+    bool getCacheTranscodeEnabled() const;
+    void setCacheTranscodeEnabled(bool enabled);
+    int getCacheTranscodeBitrateKbps() const;
+    void setCacheTranscodeBitrateKbps(int kbps);
+    // Open the restored song paused once the UI is up, so the first play starts at once
+    bool getWarmRestore() const;
+    void setWarmRestore(bool enabled);
     
     // Playlist UI settings (column widths)
     int getPlaylistTitleWidth() const;
@@ -94,6 +234,14 @@ public:
     void setPlaylistPlatformWidth(int width);
     int getPlaylistDurationWidth() const;
     void setPlaylistDurationWidth(int width);
+
+    // Cap on the in-memory caches and stream buffers together, 0 = no cap
+    int getMemoryBudgetMb() const;
+    void setMemoryBudgetMb(int mb);
+
+    // Diagnostics: record a Chrome trace of audio, network and UI work into the log directory
+    bool getTraceEnabled() const;
+    void setTraceEnabled(bool enabled);
     
     // Error logging
     void logNetworkError(const QString& error);
@@ -105,16 +253,27 @@ signals:
     void accentColorChanged(const QColor& color);
     void networkSettingsChanged();
     void playlistDirectoryChanged(const QString& relativePath);
+    void audioCacheBudgetChanged(int megabytes);
+    void cacheTranscodeChanged();
+    void coverCacheBudgetChanged(int megabytes);
+    void memoryBudgetChanged(int megabytes);
+    void traceEnabledChanged(bool enabled);
     
 private:
     void setupDefaults();
     void ensureDefaultDirectoriesExist();
     void ensureUserDirectoriesExist();
+    std::shared_ptr<ConfigSnapshot> readSnapshotUnsafe() const;
+    // Publish a snapshot changed by apply and queue key = value for the next flush
+    template <typename Apply>
+    void update(const QString& key, const QVariant& value, Apply&& apply);
+    void writePendingUnsafe();
     
     QSettings* m_settings;
     QString m_workspaceDir;
     
-    // Cached values for performance
-    QString m_currentTheme;
-    QString m_currentLanguage;
+    std::shared_ptr<const ConfigSnapshot> m_snapshot;
+    mutable std::mutex m_writeMutex;    // Guards m_settings and m_pendingWrites
+    QVariantHash m_pendingWrites;       // Settings key -> value not yet in m_settings
+    QTimer* m_flushTimer;
 };
\ No newline at end of file
@@ -4,14 +4,20 @@
 #define CXX11
 #endif
 
+#include <algorithm>
+#include <cstddef>
 #include <list>
-#include <set>
+#include <utility>
+#include <vector>
 
 #ifdef CXX11
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 // Avoid polluting the global namespace in a header. Import only the needed std symbols.
 using std::function;
 using std::shared_ptr;
@@ -37,12 +43,25 @@ using namespace boost;
 #endif
 
 class EventBus : public enable_shared_from_this<EventBus> {
+public:
+    // Runs a task somewhere else, e.g. on the Qt main thread through
+    // QMetaObject::invokeMethod; for handlers of PostAsync events
+    typedef function<void(function<void()>)> Executor;
+#ifdef CXX11
+    // Worker threads delivering PostAsync events, started on first use
+    static constexpr size_t ASYNC_WORKERS = 2;
+    // Events a dispatcher may have waiting; PostAsync fails past this
+    static constexpr size_t MAX_PENDING_EVENTS = 1024;
+    // Events one worker delivers from a dispatcher before letting others have a turn
+    static constexpr size_t ASYNC_DRAIN_BATCH = 64;
+#endif
 private:
     template<typename EventType>
     struct SubscribeRecord {
     public:
         weak_ptr<void> subscriber;
         function<bool(EventType&)> handler;
+        Executor executor;      // Empty to run on the delivering thread
     private:
         unsigned long long m_id;
         static atomic<unsigned long long> s_id;
@@ -61,24 +80,253 @@ private:
             return m_id < other.m_id;
         }
     };
+    struct DispatcherBase {
+        virtual ~DispatcherBase() {}
+        // Drop the records of expired subscribers; returns how many went
+        virtual size_t CleanExpired() = 0;
+#ifdef CXX11
+        mutex queueMtx;
+        bool scheduled = false;     // Queued for or being drained by a worker
+        // Deliver up to ASYNC_DRAIN_BATCH pending events; true if more are left
+        virtual bool DrainAsync() = 0;
+#endif
+    };
     template<typename EventType>
-    struct Dispatcher {
-        weak_ptr<EventBus> bus;
-        mutex mtx;
-        std::set<SubscribeRecord<EventType> > subscribers;
+    struct Dispatcher : DispatcherBase {
+        typedef SubscribeRecord<EventType> Record;
+        // An immutable view of the subscribers: the first size records of slots. Slots
+        // past every view's size are spare, so Add can fill one in place
+        struct Records {
+            shared_ptr<std::vector<Record> > slots;
+            size_t size;
+            const Record& operator[](size_t i) const { return (*slots)[i]; }
+        };
+        typedef shared_ptr<const Records> RecordsPtr;
+
+        // Swapped, never modified, by the writers under mtx, so posters read it with one
+        // atomic load and hold no lock
+        RecordsPtr subscribers;
+        mutex mtx;      // Serializes the writers
+
+        Dispatcher()
+        {
+            Records empty = { make_shared<std::vector<Record> >(), 0 };
+            subscribers = make_shared<Records>(empty);
+        }
+
+        RecordsPtr Snapshot() const
+        {
+            return atomic_load(&subscribers);
+        }
+
+        void Add(const Record& record)
+        {
+            lock_guard<mutex> lock(mtx);
+            RecordsPtr current = Snapshot();
+            Records next = *current;
+            if (next.size == next.slots->size())
+            {
+                // Out of spare slots: move to storage twice the size, so adding stays
+                // amortized O(1) however many subscribe
+                next.slots = make_shared<std::vector<Record> >(std::max<size_t>(8, next.size * 2));
+                std::copy(current->slots->begin(), current->slots->begin() + current->size, next.slots->begin());
+            }
+            (*next.slots)[next.size++] = record;
+            atomic_store(&subscribers, RecordsPtr(make_shared<Records>(next)));
+        }
+
+        // Publish the records for which keep is true, if that drops any; returns how many
+        template<typename Predicate>
+        size_t RemoveUnless(Predicate keep)
+        {
+            lock_guard<mutex> lock(mtx);
+            RecordsPtr current = Snapshot();
+            Records next = { make_shared<std::vector<Record> >(), 0 };
+            next.slots->reserve(current->size);
+            for (size_t i = 0; i < current->size; ++i)
+            {
+                if (keep((*current)[i]))
+                {
+                    next.slots->push_back((*current)[i]);
+                }
+            }
+            next.size = next.slots->size();
+            if (next.size != current->size)
+            {
+                atomic_store(&subscribers, RecordsPtr(make_shared<Records>(next)));
+            }
+            return current->size - next.size;
+        }
+
+        size_t CleanExpired()
+        {
+            return RemoveUnless(IsLive());
+        }
+        struct IsLive {
+            bool operator()(const Record& record) const { return !record.subscriber.expired(); }
+        };
+        // Keeps all but the first record of target, and any expired ones
+        struct AllButFirstOf {
+            shared_ptr<void> target;
+            bool found;
+            bool operator()(const Record& record)
+            {
+                if (found || record.subscriber.lock() != target)
+                {
+                    return true;
+                }
+                found = true;
+                return false;
+            }
+        };
+#ifdef CXX11
+        std::deque<shared_ptr<EventType> > pending;     // Guarded by queueMtx
+
+        bool DrainAsync()
+        {
+            std::vector<shared_ptr<EventType> > batch;
+            {
+                lock_guard<mutex> lock(queueMtx);
+                while (!pending.empty() && batch.size() < ASYNC_DRAIN_BATCH)
+                {
+                    batch.push_back(pending.front());
+                    pending.pop_front();
+                }
+                if (batch.empty())
+                {
+                    scheduled = false;
+                    return false;
+                }
+            }
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                Deliver(batch[i]);
+            }
+            lock_guard<mutex> lock(queueMtx);
+            if (pending.empty())
+            {
+                scheduled = false;
+                return false;
+            }
+            return true;
+        }
+
+        void Deliver(const shared_ptr<EventType>& evt)
+        {
+            RecordsPtr records = Snapshot();
+            for (size_t i = 0; i < records->size; ++i)
+            {
+                const SubscribeRecord<EventType>& record = (*records)[i];
+                if (!record.executor)
+                {
+                    if (shared_ptr<void> sp = record.subscriber.lock())
+                    {
+                        record.handler(*evt);
+                    }
+                    continue;
+                }
+                weak_ptr<void> subscriber = record.subscriber;
+                function<bool(EventType&)> handler = record.handler;
+                record.executor([subscriber, handler, evt]() {
+                    if (shared_ptr<void> sp = subscriber.lock())
+                    {
+                        handler(*evt);
+                    }
+                });
+            }
+        }
+#endif
     };
     
+public:
+    // Event types get consecutive ids on first use, process-wide; each bus keeps its
+    // dispatcher for type id N in slot N, so finding it is one atomic load
+    static const size_t MAX_SLOTTED_TYPES = 256;
+    template<typename EventType>
+    static size_t TypeId()
+    {
+        static const size_t id = NextTypeId();
+        return id;
+    }
+    
 private:
+    static size_t NextTypeId()
+    {
+        static atomic<size_t> nextId(0);
+        return nextId.fetch_add(1, std::memory_order_relaxed);
+    }
     const size_t m_id;
+    atomic<DispatcherBase*> m_slots[MAX_SLOTTED_TYPES];
+    // Types past the slots, should a program ever have that many
+    std::list<std::pair<size_t, DispatcherBase*> > m_overflow;
+    mutex m_overflowMtx;
+#ifdef CXX11
+    // Dispatchers with pending PostAsync events, in the order they got them
+    mutex m_asyncMtx;
+    std::condition_variable m_asyncCv;
+    std::deque<DispatcherBase*> m_readyDispatchers;
+    std::vector<std::thread> m_asyncWorkers;
+    bool m_asyncStopping = false;
+
+    void ScheduleAsync(DispatcherBase* dispatcher)
+    {
+        lock_guard<mutex> lock(m_asyncMtx);
+        if (m_asyncWorkers.empty() && !m_asyncStopping)
+        {
+            for (size_t i = 0; i < ASYNC_WORKERS; ++i)
+            {
+                m_asyncWorkers.emplace_back([this]() { RunAsyncWorker(); });
+            }
+        }
+        m_readyDispatchers.push_back(dispatcher);
+        m_asyncCv.notify_one();
+    }
+
+    void RunAsyncWorker()
+    {
+        std::unique_lock<mutex> lock(m_asyncMtx);
+        for (;;)
+        {
+            m_asyncCv.wait(lock, [this]() { return m_asyncStopping || !m_readyDispatchers.empty(); });
+            if (m_readyDispatchers.empty())
+            {
+                return;     // Stopping, and everything posted is delivered
+            }
+            DispatcherBase* dispatcher = m_readyDispatchers.front();
+            m_readyDispatchers.pop_front();
+            lock.unlock();
+            // One worker per dispatcher at a time keeps its events in order
+            const bool more = dispatcher->DrainAsync();
+            lock.lock();
+            if (more)
+            {
+                m_readyDispatchers.push_back(dispatcher);
+                m_asyncCv.notify_one();
+            }
+        }
+    }
+#endif
 #ifdef CXX11
-    EventBus(const size_t id) : m_id(id) { }
+    EventBus(const size_t id) : m_id(id)
+    {
+        for (size_t i = 0; i < MAX_SLOTTED_TYPES; ++i)
+        {
+            m_slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
     EventBus() = delete;
     EventBus(const EventBus&) = delete;
     EventBus(EventBus&&) = delete;
     EventBus& operator=(const EventBus&) = delete;
     EventBus& operator=(EventBus&&) = default;
 #else
-    EventBus(const size_t id) : m_id(id) { }
+    EventBus(const size_t id) : m_id(id)
+    {
+        for (size_t i = 0; i < MAX_SLOTTED_TYPES; ++i)
+        {
+            m_slots[i].store(NULL, std::memory_order_relaxed);
+        }
+    }
     EventBus();
     // Prevent copying/moving (C++03 style: declare but do not define)
     EventBus(const EventBus&);
@@ -86,41 +334,42 @@ private:
 #endif
 private:
     template<typename EventType>
-    shared_ptr<Dispatcher<EventType> > GetDispatcher() noexcept
+    Dispatcher<EventType>* GetDispatcher() noexcept
     {
-        typedef std::list<shared_ptr<Dispatcher<EventType> > > DispatchersMap;
-        static DispatchersMap dispatchers;
-        static mutex mtx;
-
-        lock_guard<mutex> lock(mtx);
-
-        typename DispatchersMap::iterator target = dispatchers.end();
-        for (typename DispatchersMap::iterator it = dispatchers.begin(); it != dispatchers.end(); )
+        const size_t typeId = TypeId<EventType>();
+        if (typeId >= MAX_SLOTTED_TYPES)
         {
-            weak_ptr<EventBus> wp = (*it)->bus;
-            if (wp.expired())
-            {
-                it = dispatchers.erase(it);
-            }
-            else
-            {
-                shared_ptr<EventBus> sp = wp.lock();
-                if (sp->m_id == m_id)
-                {
-                    target = it;
-                    break;
-                }
-                ++it;
-            }
+            return GetOverflowDispatcher<EventType>(typeId);
         }
-        if (target != dispatchers.end())
+        atomic<DispatcherBase*>& slot = m_slots[typeId];
+        DispatcherBase* dispatcher = slot.load(std::memory_order_acquire);
+        if (dispatcher)
         {
-            return *target;
+            return static_cast<Dispatcher<EventType>*>(dispatcher);
         }
-        shared_ptr<Dispatcher<EventType> > dispatcher = make_shared<Dispatcher<EventType> >();
-        dispatcher->bus = shared_from_this();
-        dispatchers.push_back(dispatcher);
-
+        // First use of the type on this bus; of racing threads, one dispatcher wins
+        DispatcherBase* created = new Dispatcher<EventType>();
+        DispatcherBase* expected = NULL;
+        if (slot.compare_exchange_strong(expected, created, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return static_cast<Dispatcher<EventType>*>(created);
+        }
+        delete created;
+        return static_cast<Dispatcher<EventType>*>(expected);
+    }
+    template<typename EventType>
+    Dispatcher<EventType>* GetOverflowDispatcher(const size_t typeId) noexcept
+    {
+        lock_guard<mutex> lock(m_overflowMtx);
+        for (std::list<std::pair<size_t, DispatcherBase*> >::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+        {
+            if (it->first == typeId)
+            {
+                return static_cast<Dispatcher<EventType>*>(it->second);
+            }
+        }
+        Dispatcher<EventType>* dispatcher = new Dispatcher<EventType>();
+        m_overflow.push_back(std::make_pair(typeId, static_cast<DispatcherBase*>(dispatcher)));
         return dispatcher;
     }
 public:
@@ -130,68 +379,122 @@ public:
     int index = indexCounter.fetch_add(1, std::memory_order_relaxed);
         return shared_ptr<EventBus>(new EventBus(index));
     }
+    // Delivers the PostAsync events still pending first; must not run on a bus worker
+    ~EventBus()
+    {
+#ifdef CXX11
+        {
+            lock_guard<mutex> lock(m_asyncMtx);
+            m_asyncStopping = true;
+        }
+        m_asyncCv.notify_all();
+        for (size_t i = 0; i < m_asyncWorkers.size(); ++i)
+        {
+            m_asyncWorkers[i].join();
+        }
+#endif
+        for (size_t i = 0; i < MAX_SLOTTED_TYPES; ++i)
+        {
+            delete m_slots[i].load(std::memory_order_acquire);
+        }
+        for (std::list<std::pair<size_t, DispatcherBase*> >::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+        {
+            delete it->second;
+        }
+    }
     size_t GetId() { return m_id;}
     template<typename EventType>
     bool Subscribe(shared_ptr<void> subscriber, function<bool(const EventType&)> handler) noexcept
     {
-        shared_ptr<Dispatcher<EventType> > dispatcher = GetDispatcher<EventType>();
-        lock_guard<mutex> lock(dispatcher->mtx);
+        return Subscribe<EventType>(subscriber, handler, Executor());
+    }
+    // executor runs the handler for PostAsync events; Post always runs it inline
+    template<typename EventType>
+    bool Subscribe(shared_ptr<void> subscriber, function<bool(const EventType&)> handler, Executor executor) noexcept
+    {
         SubscribeRecord<EventType> record;
         record.subscriber = subscriber;
         record.handler = handler;
-        dispatcher->subscribers.insert(record);
+        record.executor = executor;
+        GetDispatcher<EventType>()->Add(record);
         return true;
     }
     template<typename EventType>
     bool Unsubscribe(weak_ptr<void> subscriber) noexcept
     {
-        shared_ptr<Dispatcher<EventType> > dispatcher = GetDispatcher<EventType>();
-        lock_guard<mutex> lock(dispatcher->mtx);
-        for(typename std::set<SubscribeRecord<EventType> >::const_reverse_iterator it=dispatcher->subscribers.rbegin(); it!=dispatcher->subscribers.rend(); )
+        typename Dispatcher<EventType>::AllButFirstOf keep = { subscriber.lock(), false };
+        if (!keep.target)
+        {
+            return false;   // Its records are expired; CleanExpiredSubscriber drops them
+        }
+        return GetDispatcher<EventType>()->RemoveUnless(keep) > 0;
+    }
+    // Handlers run on a snapshot of the subscribers with no lock held, so they may
+    // subscribe, unsubscribe or post themselves, and posts of one type run in parallel
+    template<typename EventType>
+    bool Post(EventType& evt)
+    {
+        typename Dispatcher<EventType>::RecordsPtr records = GetDispatcher<EventType>()->Snapshot();
+        bool result = true;
+        for (size_t i = 0; i < records->size; ++i)
         {
-            if (it->subscriber.expired())
+            const SubscribeRecord<EventType>& record = (*records)[i];
+            if (shared_ptr<void> sp = record.subscriber.lock())
             {
-                it = dispatcher->subscribers.erase(it);
+                result &= record.handler(evt);
             }
-            else
+        }
+        return result;
+    }
+    // Drop the records of subscribers that have gone away, from every event type; they
+    // are skipped until then. Returns how many were dropped
+    size_t CleanExpiredSubscriber() noexcept
+    {
+        size_t removed = 0;
+        for (size_t i = 0; i < MAX_SLOTTED_TYPES; ++i)
+        {
+            if (DispatcherBase* dispatcher = m_slots[i].load(std::memory_order_acquire))
             {
-                if (it->subscriber.lock() == subscriber.lock())
-                {
-                    dispatcher->subscribers.erase(it);
-                    return true;
-                }
-                ++it;
+                removed += dispatcher->CleanExpired();
             }
         }
-        return false;
+        lock_guard<mutex> lock(m_overflowMtx);
+        for (std::list<std::pair<size_t, DispatcherBase*> >::iterator it = m_overflow.begin(); it != m_overflow.end(); ++it)
+        {
+            removed += it->second->CleanExpired();
+        }
+        return removed;
     }
+#ifdef CXX11
+    /**
+     * Queue a copy of evt for the bus's workers and return at once. Events of one type
+     * reach each handler in the order they were posted; a handler with an executor gets
+     * them in the order that executor runs its tasks.
+     * @return false if MAX_PENDING_EVENTS of this type are already waiting
+     */
     template<typename EventType>
-    bool Post(EventType& evt)
+    bool PostAsync(const EventType& evt)
     {
-        shared_ptr<Dispatcher<EventType> > dispatcher = GetDispatcher<EventType>();
-        lock_guard<mutex> lock(dispatcher->mtx);
-        bool result = true;
-        for(typename std::set<SubscribeRecord<EventType> >::iterator it=dispatcher->subscribers.begin(); it!=dispatcher->subscribers.end(); )
+        Dispatcher<EventType>* dispatcher = GetDispatcher<EventType>();
         {
-            if (it->subscriber.expired())
+            lock_guard<mutex> lock(dispatcher->queueMtx);
+            if (dispatcher->pending.size() >= MAX_PENDING_EVENTS)
             {
-                dispatcher->subscribers.erase(it);
+                return false;
             }
-            else
+            dispatcher->pending.push_back(make_shared<EventType>(evt));
+            if (dispatcher->scheduled)
             {
-                if (shared_ptr<void> sp = it->subscriber.lock())
-                {
-                    result &= it->handler(evt);
-                }
-                ++it;
+                return true;    // The worker draining it will get there
             }
+            dispatcher->scheduled = true;
         }
-        return result;
+        ScheduleAsync(dispatcher);
+        return true;
     }
+#endif
     // Todo:
-    // PostAsync
     // HasSubscribe
-    // CleanExpiredSubscriber
 };
 
 template<typename EventType>
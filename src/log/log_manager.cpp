@@ -1,5 +1,8 @@
 #include "log_manager.h"
 #include <spdlog/async.h>
+#include <spdlog/async_logger.h>
+#include <algorithm>
+#include <chrono>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <filesystem>
 #include <iostream>
@@ -58,6 +61,34 @@ void LogManager::initialize(const std::string& logDirectory)
         
         // Ensure log directory exists
         std::filesystem::create_directories(logDirectory);
+
+        // Async mode: records go through a bounded queue to one writer thread
+        bool async = true;
+        if (props.count("async")) {
+            std::string val = props["async"];
+            for (auto &c : val) c = static_cast<char>(::tolower(c));
+            async = !(val == "false" || val == "0" || val == "off");
+        }
+        size_t asyncQueueSize = DEFAULT_ASYNC_QUEUE_SIZE;
+        if (props.count("async_queue_size")) {
+            try { asyncQueueSize = std::max<size_t>(1, static_cast<size_t>(std::stoull(props["async_queue_size"]))); } catch(...) {}
+        }
+        int flushIntervalMs = DEFAULT_FLUSH_INTERVAL_MS;
+        if (props.count("flush_interval_ms")) {
+            try { flushIntervalMs = std::max(1, std::stoi(props["flush_interval_ms"])); } catch(...) {}
+        }
+        if (async) {
+            spdlog::init_thread_pool(asyncQueueSize, 1);
+        }
+        auto makeLogger = [async](const std::string& name, std::vector<spdlog::sink_ptr> loggerSinks) -> std::shared_ptr<spdlog::logger> {
+            if (async) {
+                // Drop the oldest record rather than block the logging thread, e.g. audio
+                return std::make_shared<spdlog::async_logger>(name, loggerSinks.begin(), loggerSinks.end(),
+                                                              spdlog::thread_pool(),
+                                                              spdlog::async_overflow_policy::overrun_oldest);
+            }
+            return std::make_shared<spdlog::logger>(name, loggerSinks.begin(), loggerSinks.end());
+        };
         
         // Create sinks
         std::vector<spdlog::sink_ptr> sinks;
@@ -120,15 +151,15 @@ void LogManager::initialize(const std::string& logDirectory)
         sinks.push_back(file_sink);
         
         // Create logger with both sinks
-        m_logger = std::make_shared<spdlog::logger>("BilibiliPlayer", sinks.begin(), sinks.end());
+        m_logger = makeLogger("BilibiliPlayer", sinks);
         m_logger->set_level(spdlog::level::debug);
         
-        // In debug builds, flush on every log for immediate visibility
-        // In release builds, only flush on warnings and above for performance
+        // Flush warnings and above at once, the rest on the flush timer below. Synchronous
+        // debug builds flush every record for immediate visibility
 #ifdef NDEBUG
         m_logger->flush_on(spdlog::level::warn);
 #else
-        m_logger->flush_on(spdlog::level::trace);
+        m_logger->flush_on(async ? spdlog::level::warn : spdlog::level::trace);
 #endif
         
         // Register as default logger
@@ -164,14 +195,19 @@ void LogManager::initialize(const std::string& logDirectory)
         if (props.count("ffmpeg_pattern")) ffmpeg_sink->set_pattern(props["ffmpeg_pattern"]);
         else ffmpeg_sink->set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
 
-        m_ffmpeg_logger = std::make_shared<spdlog::logger>("ffmpeg", ffmpeg_sink);
+        m_ffmpeg_logger = makeLogger("ffmpeg", {ffmpeg_sink});
         m_ffmpeg_logger->set_level(ffmpeg_sink->level());
+        m_ffmpeg_logger->flush_on(spdlog::level::warn);
         spdlog::register_logger(m_ffmpeg_logger);
-        
+        spdlog::flush_every(std::chrono::milliseconds(flushIntervalMs));
+
+        s_appLogger.store(m_logger.get(), std::memory_order_release);
+        s_ffmpegLogger.store(m_ffmpeg_logger.get(), std::memory_order_release);
         m_initialized = true;
         
         LOG_INFO("LogManager initialized successfully");
         LOG_INFO("Log directory: {}", logDirectory);
+        LOG_INFO("Logging {}, flushing every {} ms", async ? "asynchronously" : "synchronously", flushIntervalMs);
         
     } catch (const std::exception& e) {
         std::cerr << "Failed to initialize LogManager: " << e.what() << std::endl;
@@ -187,15 +223,17 @@ void LogManager::shutdown()
     
     LOG_INFO("LogManager shutting down...");
     
+    s_appLogger.store(nullptr, std::memory_order_release);
+    s_ffmpegLogger.store(nullptr, std::memory_order_release);
     if (m_logger) {
         m_logger->flush();
-        if (m_ffmpeg_logger) {
-            m_ffmpeg_logger->flush();
-            m_ffmpeg_logger.reset();
-        }
-        spdlog::drop_all();
-        m_logger.reset();
     }
+    if (m_ffmpeg_logger) {
+        m_ffmpeg_logger->flush();
+    }
+    // Writes what is still queued, stops the flush timer and the async writer thread.
+    // The loggers themselves stay alive for a thread that read the pointers just before
+    spdlog::shutdown();
     
     m_initialized = false;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <spdlog/spdlog.h>
@@ -10,6 +12,10 @@
 /**
  * Log Manager - centralized logging using spdlog
  * Handles all application logging with different levels and outputs
+ *
+ * By default (log.properties: async=true) the loggers hand records to one spdlog
+ * background thread through a bounded queue (async_queue_size); when it is full the
+ * oldest record is dropped, so a thread that logs never blocks on disk or console I/O.
  */
 class LogManager
 {
@@ -22,6 +28,9 @@ public:
         Error = 4,
         Critical = 5
     };
+    // Defaults for log.properties' async_queue_size and flush_interval_ms
+    static constexpr size_t DEFAULT_ASYNC_QUEUE_SIZE = 8192;
+    static constexpr int DEFAULT_FLUSH_INTERVAL_MS = 1000;
 
     static LogManager& instance();
     
@@ -32,50 +41,32 @@ public:
     // Logging methods
     template<typename... Args>
     void trace(const std::string& format, Args&&... args) {
-        if (m_logger) {
-            m_logger->trace(fmt::format(format, std::forward<Args>(args)...));
-            m_logger->flush();
-        }
+        logTo(appLogger(), spdlog::level::trace, format, std::forward<Args>(args)...);
     }
     
     template<typename... Args>
     void debug(const std::string& format, Args&&... args) {
-        if (m_logger) {
-            m_logger->debug(fmt::format(format, std::forward<Args>(args)...));
-            m_logger->flush();
-        }
+        logTo(appLogger(), spdlog::level::debug, format, std::forward<Args>(args)...);
     }
     
     template<typename... Args>
     void info(const std::string& format, Args&&... args) {
-        if (m_logger) {
-            m_logger->info(fmt::format(format, std::forward<Args>(args)...));
-            m_logger->flush();
-        }
+        logTo(appLogger(), spdlog::level::info, format, std::forward<Args>(args)...);
     }
     
     template<typename... Args>
     void warn(const std::string& format, Args&&... args) {
-        if (m_logger) {
-            m_logger->warn(fmt::format(format, std::forward<Args>(args)...));
-            m_logger->flush();
-        }
+        logTo(appLogger(), spdlog::level::warn, format, std::forward<Args>(args)...);
     }
     
     template<typename... Args>
     void error(const std::string& format, Args&&... args) {
-        if (m_logger) {
-            m_logger->error(fmt::format(format, std::forward<Args>(args)...));
-            m_logger->flush();
-        }
+        logTo(appLogger(), spdlog::level::err, format, std::forward<Args>(args)...);
     }
     
     template<typename... Args>
     void critical(const std::string& format, Args&&... args) {
-        if (m_logger) {
-            m_logger->critical(fmt::format(format, std::forward<Args>(args)...));
-            m_logger->flush();
-        }
+        logTo(appLogger(), spdlog::level::critical, format, std::forward<Args>(args)...);
     }
     
     // Log level management
@@ -89,27 +80,40 @@ public:
     // FFmpeg-specific logging
     template<typename... Args>
     void ffmpeg_trace(const std::string& format, Args&&... args) {
-        auto lg = spdlog::get("ffmpeg"); if (lg) { lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::trace, fmt::format(format, std::forward<Args>(args)...)); lg->flush(); }
+        logTo(ffmpegLogger(), spdlog::level::trace, format, std::forward<Args>(args)...);
     }
     template<typename... Args>
     void ffmpeg_debug(const std::string& format, Args&&... args) {
-        auto lg = spdlog::get("ffmpeg"); if (lg) { lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::debug, fmt::format(format, std::forward<Args>(args)...)); lg->flush(); }
+        logTo(ffmpegLogger(), spdlog::level::debug, format, std::forward<Args>(args)...);
     }
     template<typename... Args>
     void ffmpeg_info(const std::string& format, Args&&... args) {
-        auto lg = spdlog::get("ffmpeg"); if (lg) { lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::info, fmt::format(format, std::forward<Args>(args)...)); lg->flush(); }
+        logTo(ffmpegLogger(), spdlog::level::info, format, std::forward<Args>(args)...);
     }
     template<typename... Args>
     void ffmpeg_warn(const std::string& format, Args&&... args) {
-        auto lg = spdlog::get("ffmpeg"); if (lg) { lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::warn, fmt::format(format, std::forward<Args>(args)...)); lg->flush(); }
+        logTo(ffmpegLogger(), spdlog::level::warn, format, std::forward<Args>(args)...);
     }
     template<typename... Args>
     void ffmpeg_error(const std::string& format, Args&&... args) {
-        auto lg = spdlog::get("ffmpeg"); if (lg) { lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::err, fmt::format(format, std::forward<Args>(args)...)); lg->flush(); }
+        logTo(ffmpegLogger(), spdlog::level::err, format, std::forward<Args>(args)...);
     }
     template<typename... Args>
     void ffmpeg_critical(const std::string& format, Args&&... args) {
-        auto lg = spdlog::get("ffmpeg"); if (lg) { lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::critical, fmt::format(format, std::forward<Args>(args)...)); lg->flush(); }
+        logTo(ffmpegLogger(), spdlog::level::critical, format, std::forward<Args>(args)...);
+    }
+
+    // The loggers, cached so logging skips the spdlog registry (a mutex and a map
+    // lookup); null before initialize() and after shutdown()
+    static spdlog::logger* appLogger() { return s_appLogger.load(std::memory_order_acquire); }
+    static spdlog::logger* ffmpegLogger() { return s_ffmpegLogger.load(std::memory_order_acquire); }
+    // For LOG_*_RATE_LIMITED: true at most once per intervalMs for one nextMs; racing
+    // callers past the deadline see one of them win
+    static bool rateLimitPassed(std::atomic<long long>& nextMs, long long intervalMs) {
+        const long long now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        long long next = nextMs.load(std::memory_order_relaxed);
+        return now >= next && nextMs.compare_exchange_strong(next, now + intervalMs, std::memory_order_relaxed);
     }
     
 private:
@@ -118,27 +122,93 @@ private:
     LogManager(const LogManager&) = delete;
     LogManager& operator=(const LogManager&) = delete;
     
+    // Formats only what the logger's level lets through. Flushing is left to the logger:
+    // on warnings and above, and every flush_interval_ms
+    template<typename... Args>
+    static void logTo(spdlog::logger* logger, spdlog::level::level_enum level, const std::string& format, Args&&... args) {
+        if (logger && logger->should_log(level)) {
+            logger->log(level, fmt::format(format, std::forward<Args>(args)...));
+        }
+    }
+    
     std::shared_ptr<spdlog::logger> m_logger;
     std::shared_ptr<spdlog::logger> m_ffmpeg_logger;
     std::string m_logDirectory;
     bool m_initialized = false;
+
+    inline static std::atomic<spdlog::logger*> s_appLogger{nullptr};
+    inline static std::atomic<spdlog::logger*> s_ffmpegLogger{nullptr};
 };
 
+// Records below LOG_ACTIVE_LEVEL (an SPDLOG_LEVEL_* value) are compiled out, arguments
+// and all. Release builds keep INFO and above unless the build sets it
+#ifndef LOG_ACTIVE_LEVEL
+#  ifdef NDEBUG
+#    define LOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+#  else
+#    define LOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#  endif
+#endif
+
 // Convenience macros for easy logging. These forward source location to spdlog so
 // sink patterns using [%s:%#] get populated. The message itself is the provided
 // format and args (no automatic function/line prefix) to avoid duplicate info
 // when the sink pattern already includes file/line.
-#define LOG_TRACE(...) do { auto _lg = spdlog::get("BilibiliPlayer"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::trace, __VA_ARGS__); } while(0)
-#define LOG_DEBUG(...) do { auto _lg = spdlog::get("BilibiliPlayer"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::debug, __VA_ARGS__); } while(0)
-#define LOG_INFO(...)  do { auto _lg = spdlog::get("BilibiliPlayer"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::info, __VA_ARGS__); } while(0)
-#define LOG_WARN(...)  do { auto _lg = spdlog::get("BilibiliPlayer"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::warn,  __VA_ARGS__); } while(0)
-#define LOG_ERROR(...) do { auto _lg = spdlog::get("BilibiliPlayer"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::err, __VA_ARGS__); } while(0)
-#define LOG_CRITICAL(...) do { auto _lg = spdlog::get("BilibiliPlayer"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::critical, __VA_ARGS__); } while(0)
+#define LOG_AT_LEVEL(LOGGER, LEVEL, ...) do { if (spdlog::logger* _lg = LogManager::LOGGER()) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, LEVEL, __VA_ARGS__); } while(0)
+// For hot loops: log only the 1st, N+1th, 2N+1th... call at this call site that the
+// logger's level lets through
+#define LOG_AT_LEVEL_EVERY_N(LOGGER, LEVEL, N, ...) do { \
+    static std::atomic<unsigned long long> _logCalls{0}; \
+    spdlog::logger* _lg = LogManager::LOGGER(); \
+    if (_lg && _lg->should_log(LEVEL) && _logCalls.fetch_add(1, std::memory_order_relaxed) % (N) == 0) \
+        _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, LEVEL, __VA_ARGS__); \
+} while(0)
+// For hot loops: log at most once every MS milliseconds at this call site
+#define LOG_AT_LEVEL_RATE_LIMITED(LOGGER, LEVEL, MS, ...) do { \
+    static std::atomic<long long> _logNextMs{0}; \
+    spdlog::logger* _lg = LogManager::LOGGER(); \
+    if (_lg && _lg->should_log(LEVEL) && LogManager::rateLimitPassed(_logNextMs, MS)) \
+        _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, LEVEL, __VA_ARGS__); \
+} while(0)
+#define LOG_DISABLED(...) do {} while(0)
+
+#if LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_TRACE(...) LOG_AT_LEVEL(appLogger, spdlog::level::trace, __VA_ARGS__)
+#define LOG_TRACE_EVERY_N(N, ...) LOG_AT_LEVEL_EVERY_N(appLogger, spdlog::level::trace, N, __VA_ARGS__)
+#define LOG_TRACE_RATE_LIMITED(MS, ...) LOG_AT_LEVEL_RATE_LIMITED(appLogger, spdlog::level::trace, MS, __VA_ARGS__)
+#define LOG_FFMPEG_TRACE(...) LOG_AT_LEVEL(ffmpegLogger, spdlog::level::trace, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) LOG_DISABLED()
+#define LOG_TRACE_EVERY_N(N, ...) LOG_DISABLED()
+#define LOG_TRACE_RATE_LIMITED(MS, ...) LOG_DISABLED()
+#define LOG_FFMPEG_TRACE(...) LOG_DISABLED()
+#endif
+
+#if LOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT_LEVEL(appLogger, spdlog::level::debug, __VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(N, ...) LOG_AT_LEVEL_EVERY_N(appLogger, spdlog::level::debug, N, __VA_ARGS__)
+#define LOG_DEBUG_RATE_LIMITED(MS, ...) LOG_AT_LEVEL_RATE_LIMITED(appLogger, spdlog::level::debug, MS, __VA_ARGS__)
+#define LOG_FFMPEG_DEBUG(...) LOG_AT_LEVEL(ffmpegLogger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISABLED()
+#define LOG_DEBUG_EVERY_N(N, ...) LOG_DISABLED()
+#define LOG_DEBUG_RATE_LIMITED(MS, ...) LOG_DISABLED()
+#define LOG_FFMPEG_DEBUG(...) LOG_DISABLED()
+#endif
+
+#define LOG_INFO(...)  LOG_AT_LEVEL(appLogger, spdlog::level::info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT_LEVEL(appLogger, spdlog::level::warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT_LEVEL(appLogger, spdlog::level::err, __VA_ARGS__)
+#define LOG_CRITICAL(...) LOG_AT_LEVEL(appLogger, spdlog::level::critical, __VA_ARGS__)
+#define LOG_INFO_EVERY_N(N, ...) LOG_AT_LEVEL_EVERY_N(appLogger, spdlog::level::info, N, __VA_ARGS__)
+#define LOG_WARN_EVERY_N(N, ...) LOG_AT_LEVEL_EVERY_N(appLogger, spdlog::level::warn, N, __VA_ARGS__)
+#define LOG_ERROR_EVERY_N(N, ...) LOG_AT_LEVEL_EVERY_N(appLogger, spdlog::level::err, N, __VA_ARGS__)
+#define LOG_INFO_RATE_LIMITED(MS, ...) LOG_AT_LEVEL_RATE_LIMITED(appLogger, spdlog::level::info, MS, __VA_ARGS__)
+#define LOG_WARN_RATE_LIMITED(MS, ...) LOG_AT_LEVEL_RATE_LIMITED(appLogger, spdlog::level::warn, MS, __VA_ARGS__)
+#define LOG_ERROR_RATE_LIMITED(MS, ...) LOG_AT_LEVEL_RATE_LIMITED(appLogger, spdlog::level::err, MS, __VA_ARGS__)
 
 // FFmpeg-specific logging macros
-#define LOG_FFMPEG_TRACE(...) do { auto _lg = spdlog::get("ffmpeg"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::trace, __VA_ARGS__); } while(0)
-#define LOG_FFMPEG_DEBUG(...) do { auto _lg = spdlog::get("ffmpeg"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::debug, __VA_ARGS__); } while(0)
-#define LOG_FFMPEG_INFO(...) do { auto _lg = spdlog::get("ffmpeg"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::info, __VA_ARGS__); } while(0)
-#define LOG_FFMPEG_WARN(...) do { auto _lg = spdlog::get("ffmpeg"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::warn, __VA_ARGS__); } while(0)
-#define LOG_FFMPEG_ERROR(...) do { auto _lg = spdlog::get("ffmpeg"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::err, __VA_ARGS__); } while(0)
-#define LOG_FFMPEG_CRITICAL(...) do { auto _lg = spdlog::get("ffmpeg"); if (_lg) _lg->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, spdlog::level::critical, __VA_ARGS__); } while(0)
\ No newline at end of file
+#define LOG_FFMPEG_INFO(...) LOG_AT_LEVEL(ffmpegLogger, spdlog::level::info, __VA_ARGS__)
+#define LOG_FFMPEG_WARN(...) LOG_AT_LEVEL(ffmpegLogger, spdlog::level::warn, __VA_ARGS__)
+#define LOG_FFMPEG_ERROR(...) LOG_AT_LEVEL(ffmpegLogger, spdlog::level::err, __VA_ARGS__)
+#define LOG_FFMPEG_CRITICAL(...) LOG_AT_LEVEL(ffmpegLogger, spdlog::level::critical, __VA_ARGS__)
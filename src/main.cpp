@@ -6,10 +6,15 @@
 #include <QTimer>
 #include <QImageReader>
 #include <manager/application_context.h>
+#include <audio/audio_player_controller.h>
+#include <config/config_manager.h>
 #include <exception>
+#include <optional>
 #include <csignal>
 #include <iostream>
 #include <log/log_manager.h>
+#include <ui/util/first_paint_tracer.h>
+#include <util/startup_trace.h>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <windows.h>
@@ -17,8 +22,13 @@
 #pragma comment(lib, "dbghelp.lib")
 #endif
 
+// Printed on stdout by --bench once the UI is ready, followed by the milliseconds since start
+static constexpr const char* BENCH_READY_MARKER = "BENCH_READY";
+
 int main(int argc, char *argv[])
 {
+    util::StartupTrace::instance().start();
+
     // Install terminate handler to capture uncaught exceptions and make them
     // visible in logs / debugger (calls abort() so debugger will stop).
     std::set_terminate([]() {
@@ -63,12 +73,16 @@ int main(int argc, char *argv[])
     std::signal(SIGABRT, [](int){ std::cerr << "fatal: SIGABRT" << std::endl; std::abort(); });
     std::signal(SIGFPE,  [](int){ std::cerr << "fatal: SIGFPE" << std::endl;  std::abort(); });
     std::signal(SIGILL,  [](int){ std::cerr << "fatal: SIGILL" << std::endl;  std::abort(); });
+    std::optional<util::StartupTrace::Scope> qtScope(std::in_place, "QApplication");
     QApplication a(argc, argv);
+    qtScope.reset();
 
     QTranslator translator;
     // Set application properties
     a.setApplicationName("BilibiliPlayer");
     a.setApplicationVersion("1.0.0");
+    // --bench: print the startup trace and exit once the UI is ready
+    const bool benchMode = a.arguments().contains("--bench");
 
     try {
         // Initialize with default workspace directory. Keep this fast; defer
@@ -79,8 +93,31 @@ int main(int argc, char *argv[])
         qCritical() << "Initialization failed:" << e.what();
         QApplication::quit();
     }
+    std::optional<util::StartupTrace::Scope> windowScope(std::in_place, "MainWindow");
     MainWindow w;
+    windowScope.reset();
     
+    // The UI is ready once the window is on screen and the managers finishing in the
+    // background are done, whichever comes last
+    auto onStartupStep = [benchMode]() {
+        util::StartupTrace& trace = util::StartupTrace::instance();
+        if (!trace.hasMark("first window paint") || !APP_CONTEXT.isPhaseInitialized(3) || !trace.mark("ui ready")) {
+            return;
+        }
+        const std::string summary = trace.summary();
+        LOG_INFO("Startup trace:\n{}", summary);
+        if (benchMode) {
+            std::cout << summary << BENCH_READY_MARKER << " " << trace.elapsedMs() << std::endl;
+            QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+            return;
+        }
+        // Open the restored song paused in the background, off the startup path
+        if (CONFIG_MANAGER && CONFIG_MANAGER->getWarmRestore() && AUDIO_PLAYER_CONTROLLER) {
+            AUDIO_PLAYER_CONTROLLER->prepareCurrentSong();
+        }
+    };
+    QObject::connect(&APP_CONTEXT, &ApplicationContext::managersInitialized, &w, onStartupStep);
+    FirstPaintTracer::install(&w, "first window paint", nullptr, onStartupStep);
     w.show();
 
     // Defer loading translators and logging image formats to the event loop
@@ -3,7 +3,10 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QThread>
+#include <QPixmapCache>
+#include <algorithm>
 #include <chrono>
 
 #include <playlist/playlist_manager.h>
@@ -12,7 +15,16 @@
 #include <network/network_manager.h>
 #include <log/log_manager.h>
 #include <audio/audio_player_controller.h>
+#include <audio/cache_transcoder.h>
+#include <stream/realtime_pipe.hpp>
 #include <event/event_bus.hpp>
+#include <util/audio_cache_store.h>
+#include <util/cover_cache.h>
+#include <util/idle_mode.h>
+#include <util/memory_pressure.h>
+#include <util/startup_trace.h>
+#include <util/trace.h>
+#include "startup_graph.h"
 
 ApplicationContext& ApplicationContext::instance()
 {
@@ -52,16 +64,70 @@ void ApplicationContext::initialize(const QString& workspaceDir)
     LOG_INFO("Dependency-aware initialization sequence starting...");
     
     try {
-        // Initialize in phases to handle dependencies
-        initializePhase1(workspace); // Core managers first
-        initializePhase2();          // Network and dependent managers
-        initializePhase3();          // Data managers last
+        using Affinity = StartupGraph::Affinity;
+        using util::StartupTrace;
+        StartupTrace::Scope traceScope("ApplicationContext::initialize");
+        // Phases overlap, so each is timed from the start until it is complete
+        const StartupTrace::Clock::time_point begin = StartupTrace::Clock::now();
+        m_startup = std::make_unique<StartupGraph>(STARTUP_WORKER_THREADS);
+        m_startup->setFailureHandler([](const std::string& step, std::exception_ptr error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Startup step '{}' failed: {}", step, e.what());
+            } catch (...) {
+                LOG_ERROR("Startup step '{}' failed", step);
+            }
+        });
         
+        // Phase 1: core managers
+        m_startup->add("config", {}, Affinity::Caller, [this, workspace]() { initializeConfigManager(workspace); });
+        m_startup->add("eventBus", {}, Affinity::Caller, [this]() { initializeEventBus(); });
+        m_startup->add("theme", {"config"}, Affinity::Caller, [this]() { initializeThemeManager(); });
+        m_startup->add("phase1", {"config", "eventBus", "theme"}, Affinity::Caller, [this, begin]() {
+            StartupTrace::instance().record("Phase 1: core managers", begin, StartupTrace::Clock::now());
+            m_currentPhase = 1;
+            emit phaseInitialized(1);
+            emit configLoaded();
+        });
+        
+        // Phase 2: network, configured on a worker while the playlists load
+        m_startup->add("coverCache", {"config"}, Affinity::Caller, [this]() { initializeCoverCache(); });
+        m_startup->add("network", {"coverCache"}, Affinity::Caller, [this]() { initializeNetworkManager(); });
+        m_startup->add("networkConfig", {"network"}, Affinity::Worker, [this]() { configureNetworkManager(); });
+        m_startup->add("phase2", {"phase1", "networkConfig"}, Affinity::Caller, [this, begin]() {
+            StartupTrace::instance().record("Phase 2: network", begin, StartupTrace::Clock::now());
+            m_currentPhase = 2;
+            emit phaseInitialized(2);
+            emit networkReady();
+        });
+        
+        // Phase 3: data managers; the audio cache index isn't needed to show the window
+        m_startup->add("playlist", {"coverCache"}, Affinity::Caller, [this]() { initializePlaylistManager(); });
+        m_startup->add("audioController", {"playlist"}, Affinity::Caller, [this]() { initializeAudioPlayerController(); });
+        m_startup->add("audioCache", {"config"}, Affinity::Worker, [this]() { initializeAudioCacheStore(); });
+        m_startup->add("attachAudioCache", {"audioCache", "network", "playlist"}, Affinity::Worker,
+                       [this]() { attachAudioCacheStore(); });
+        m_startup->add("phase3", {"phase2", "audioController", "attachAudioCache"}, Affinity::Worker, [this, begin]() {
+            StartupTrace::instance().record("Phase 3: data managers", begin, StartupTrace::Clock::now());
+            QMetaObject::invokeMethod(this, [this]() {
+                if (!m_initialized) {
+                    return;     // Shut down meanwhile
+                }
+                m_currentPhase = 3;
+                emit phaseInitialized(3);
+                emit dataManagersReady();
+                emit managersInitialized();
+                LOG_INFO("ApplicationContext background initialization complete");
+            }, Qt::QueuedConnection);
+        });
+        
+        m_startup->run();
         setupManagerConnections();
+        startMemoryMonitoring();
+        startIdleTracking();
         
         m_initialized = true;
-        emit managersInitialized();
-        
         LOG_INFO("ApplicationContext initialized successfully");
         
     } catch (const std::exception& e) {
@@ -73,6 +139,7 @@ void ApplicationContext::initialize(const QString& workspaceDir)
 void ApplicationContext::initializePhase1(const QString& workspaceDir)
 {
     LOG_INFO("Phase 1: Initializing core managers (Config, File)");
+    util::StartupTrace::Scope traceScope("Phase 1: core managers");
     
     // 1. ConfigManager first - needed by everyone
     initializeConfigManager(workspaceDir);
@@ -82,6 +149,10 @@ void ApplicationContext::initializePhase1(const QString& workspaceDir)
     
     // 3. ThemeManager - UI theming system
     initializeThemeManager();
+
+    // 4. AudioCacheStore - index of the audio cache, before anything writes to it
+    initializeAudioCacheStore();
+    initializeCoverCache();
     m_currentPhase = 1;
     emit phaseInitialized(1);
     emit configLoaded();
@@ -90,9 +161,11 @@ void ApplicationContext::initializePhase1(const QString& workspaceDir)
 void ApplicationContext::initializePhase2()
 {
     LOG_INFO("Phase 2: Initializing network managers");
+    util::StartupTrace::Scope traceScope("Phase 2: network");
     
     // 3. NetworkManager - depends on config for API settings, proxies, etc.
     initializeNetworkManager();
+    configureNetworkManager();
     
     m_currentPhase = 2;
     emit phaseInitialized(2);
@@ -102,9 +175,11 @@ void ApplicationContext::initializePhase2()
 void ApplicationContext::initializePhase3()
 {
     LOG_INFO("Phase 3: Initializing data managers");
+    util::StartupTrace::Scope traceScope("Phase 3: data managers");
     
     // 4. PlaylistManager - depends on config and potentially network
     initializePlaylistManager();
+    attachAudioCacheStore();
     
     // 5. AudioPlayerController - depends on PlaylistManager and NetworkManager
     initializeAudioPlayerController();
@@ -117,17 +192,114 @@ void ApplicationContext::initializePhase3()
 void ApplicationContext::initializeConfigManager(const QString& workspaceDir)
 {
     LOG_DEBUG("Creating ConfigManager...");
+    util::StartupTrace::Scope traceScope("ConfigManager");
     m_configManager = std::make_unique<ConfigManager>(this);
     
     // Initialize with workspace directory
     m_configManager->initialize(workspaceDir);
+    applyTraceSetting(m_configManager->getTraceEnabled());
+    connect(m_configManager.get(), &ConfigManager::traceEnabledChanged, this, &ApplicationContext::applyTraceSetting);
+    applyMemoryBudget(m_configManager->getMemoryBudgetMb());
+    connect(m_configManager.get(), &ConfigManager::memoryBudgetChanged, this, &ApplicationContext::applyMemoryBudget);
     
     LOG_DEBUG("ConfigManager initialized and config loaded");
 }
 
+void ApplicationContext::applyTraceSetting(bool enabled)
+{
+    util::Tracer& tracer = util::Tracer::instance();
+    if (!enabled) {
+        if (util::Tracer::enabled()) {
+            tracer.stop();
+            LOG_INFO("Trace written to {} ({} spans dropped)", tracer.path(), tracer.droppedEvents());
+        }
+        return;
+    }
+    if (util::Tracer::enabled()) {
+        return;
+    }
+    const QString name = QString("trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    const QString path = QDir(m_configManager->getAbsolutePath(m_configManager->getLogDirectory())).absoluteFilePath(name);
+    if (tracer.start(path.toStdString())) {
+        util::Tracer::setThreadName("GUI");
+        LOG_INFO("Tracing to {}", path.toStdString());
+    } else {
+        LOG_ERROR("Failed to create trace file {}", path.toStdString());
+    }
+}
+
+void ApplicationContext::applyMemoryBudget(int budgetMb)
+{
+    const size_t capBytes = static_cast<size_t>(std::max(0, budgetMb)) * 1024 * 1024;
+    util::MemoryBudget::instance().setCap(capBytes);
+    LOG_DEBUG("Memory budget for caches and buffers: {} MB", std::max(0, budgetMb));
+}
+
+void ApplicationContext::startMemoryMonitoring()
+{
+    // Pipe buffers can't shrink while a stream is open, but they push the caches out
+    m_streamBufferBudget = util::MemoryBudget::instance().add(
+        "stream buffers", util::MemoryBudget::Priority::High,
+        []() { return RealtimePipe::allocatedBytes(); }, nullptr);
+    m_memoryPressureMonitor = std::make_unique<util::MemoryPressureMonitor>([this]() { relieveMemoryPressure(); });
+    m_memoryPressureMonitor->start();
+}
+
+void ApplicationContext::relieveMemoryPressure()
+{
+    // On the monitor's thread; the pixmap cache belongs to the GUI thread
+    const size_t freed = util::MemoryBudget::instance().relieve();
+    QMetaObject::invokeMethod(this, []() { QPixmapCache::clear(); }, Qt::QueuedConnection);
+    LOG_WARN("System memory low ({} MB available), released {} KB of cached data",
+             util::MemoryPressureMonitor::availableBytes() / (1024 * 1024), freed / 1024);
+}
+
+void ApplicationContext::startIdleTracking()
+{
+    m_idleMode = std::make_unique<util::IdleMode>([this](bool idle) { applyIdleMode(idle); });
+    if (m_audioPlayerController) {
+        // Emitted on the audio event thread, delivered here on the GUI thread
+        connect(m_audioPlayerController.get(), &audio::AudioPlayerController::playbackStateChanged,
+                this, [this](audio::PlaybackState state) {
+                    if (m_idleMode) {
+                        m_idleMode->setPlaybackActive(state == audio::PlaybackState::Playing);
+                    }
+                });
+    }
+}
+
+void ApplicationContext::applyIdleMode(bool idle)
+{
+    // The position timer already stops with playback, and the marquee and progress bar
+    // with the window; these keep going on their own otherwise
+    if (m_playlistManager) {
+        m_playlistManager->setAutoSaveSuspended(idle);
+    }
+    if (m_memoryPressureMonitor) {
+        m_memoryPressureMonitor->setSlowPolling(idle);
+    }
+    if (m_audioPlayerController && m_audioPlayerController->spectrumAnalyzer()) {
+        m_audioPlayerController->spectrumAnalyzer()->setSuspended(idle);
+    }
+    LOG_INFO("{} idle mode ({:.1f} wake-ups/s)", idle ? "Entering" : "Leaving", util::IdleMode::wakeupsPerSecond());
+}
+
+void ApplicationContext::setWindowVisible(bool visible)
+{
+    if (m_idleMode) {
+        m_idleMode->setWindowVisible(visible);
+    }
+}
+
+bool ApplicationContext::isIdle() const
+{
+    return m_idleMode && m_idleMode->idle();
+}
+
 void ApplicationContext::initializeEventBus()
 {
     LOG_DEBUG("Creating EventBus...");
+    util::StartupTrace::Scope traceScope("EventBus");
     // EventBus uses a factory Create() returning shared_ptr
     m_eventBus = EventBus::Create();
     LOG_DEBUG("EventBus initialized");
@@ -136,6 +308,7 @@ void ApplicationContext::initializeEventBus()
 void ApplicationContext::initializeThemeManager()
 {
     LOG_DEBUG("Creating ThemeManager...");
+    util::StartupTrace::Scope traceScope("ThemeManager");
     m_themeManager = std::make_unique<ThemeManager>(this);
     
     // Load theme from config if available
@@ -150,14 +323,55 @@ void ApplicationContext::initializeThemeManager()
     LOG_DEBUG("ThemeManager initialized");
 }
 
+void ApplicationContext::initializeAudioCacheStore()
+{
+    LOG_DEBUG("Creating AudioCacheStore...");
+    util::StartupTrace::Scope traceScope("AudioCacheStore (worker)");
+    QString cacheDir = m_configManager->getAudioCacheDirectory();
+    uint64_t budget = static_cast<uint64_t>(std::max(0, m_configManager->getAudioCacheBudgetMB())) * 1024 * 1024;
+    auto store = std::make_shared<util::AudioCacheStore>(std::filesystem::u8path(cacheDir.toStdString()), budget);
+    LOG_DEBUG("AudioCacheStore initialized with {} files ({} bytes)", store->size(), store->totalBytes());
+    // Idle until enabled; the first pass runs a PASS_INTERVAL after that
+    auto transcoder = std::make_shared<audio::CacheTranscoder>(store, m_configManager->getCacheTranscodeEnabled(),
+                                                               m_configManager->getCacheTranscodeBitrateKbps());
+    std::atomic_store(&m_cacheTranscoder, std::move(transcoder));
+    std::atomic_store(&m_audioCacheStore, std::move(store));
+}
+
+void ApplicationContext::initializeCoverCache()
+{
+    // The index is read on first use, off the startup path
+    m_coverCache = std::make_shared<util::CoverCache>(m_configManager.get());
+}
+
+void ApplicationContext::attachAudioCacheStore()
+{
+    util::StartupTrace::Scope traceScope("AudioCacheStore attach (worker)");
+    // Both setters are thread-safe; until now the managers used the directory directly
+    auto store = std::atomic_load(&m_audioCacheStore);
+    m_networkManager->setAudioCacheStore(store);
+    m_playlistManager->setAudioCacheStore(store);
+    LOG_DEBUG("AudioCacheStore attached to the network and playlist managers");
+}
+
 // FileManager functionality is now integrated into ConfigManager
 // No separate FileManager needed
 
 void ApplicationContext::initializeNetworkManager()
 {
     LOG_DEBUG("Creating NetworkManager...");
+    util::StartupTrace::Scope traceScope("NetworkManager");
     
-    // Use singleton instance and configure it
+    // Created here so it lives on the GUI thread; configureNetworkManager() does the I/O
+    m_networkManager = std::make_shared<network::NetworkManager>();
+    m_networkManager->setCoverCache(m_coverCache);
+    
+    LOG_DEBUG("NetworkManager created");
+}
+
+void ApplicationContext::configureNetworkManager()
+{
+    util::StartupTrace::Scope traceScope("NetworkManager configure (worker)");
     QString platformDir = m_configManager->getPlatformDirectory();
     int timeout = m_configManager->getNetworkTimeout();
     QString proxyUrl = m_configManager->getProxyUrl();
@@ -165,8 +379,16 @@ void ApplicationContext::initializeNetworkManager()
         QDir().mkpath(platformDir);
         LOG_INFO("Created platform directory at {}", platformDir.toStdString());
     }
-    m_networkManager = std::make_shared<network::NetworkManager>();
     m_networkManager->configure(platformDir, timeout, proxyUrl);
+    m_networkManager->setPageCacheTtl(m_configManager->getPageCacheTtlHours());
+    m_networkManager->setAudioQuality(network::audioQualityFromString(m_configManager->getAudioQuality().toStdString()));
+    m_networkManager->setPrefetchOptions(m_configManager->getPrefetchTrackCount(),
+                                         m_configManager->getPrefetchBandwidthKBps(),
+                                         m_configManager->getPrefetchDiskBudgetMB());
+    // Handshakes run in the background while the remaining managers load
+    if (m_configManager->getConnectionWarmUpEnabled()) {
+        m_networkManager->warmUpConnections();
+    }
 
     LOG_DEBUG("NetworkManager initialized with config settings");
 }
@@ -174,9 +396,11 @@ void ApplicationContext::initializeNetworkManager()
 void ApplicationContext::initializePlaylistManager()
 {
     LOG_DEBUG("Creating PlaylistManager...");
+    util::StartupTrace::Scope traceScope("PlaylistManager");
     
     // PlaylistManager needs ConfigManager
     m_playlistManager = std::make_unique<PlaylistManager>(m_configManager.get(), this);
+    m_playlistManager->setCoverCache(m_coverCache);
     
     // Initialize and load existing playlists
     m_playlistManager->initialize();
@@ -187,6 +411,7 @@ void ApplicationContext::initializePlaylistManager()
 void ApplicationContext::initializeAudioPlayerController()
 {
     LOG_DEBUG("Creating AudioPlayerController...");
+    util::StartupTrace::Scope traceScope("AudioPlayerController");
     
     // AudioPlayerController needs PlaylistManager and NetworkManager
     m_audioPlayerController = std::make_unique<audio::AudioPlayerController>(this);
@@ -206,11 +431,46 @@ void ApplicationContext::setupManagerConnections()
                 // Notify UI components via signal
             });
     
+    // An accent change only swaps palette colors, without rebuilding the stylesheet
+    connect(m_configManager.get(), &ConfigManager::accentColorChanged,
+            m_themeManager.get(), &ThemeManager::setAccentColor);
+    
     connect(m_configManager.get(), &ConfigManager::languageChanged,
             this, [this](const QString& language) {
                 LOG_INFO("Language changed to: {}", language.toStdString());
                 // Reload UI strings if needed
             });
+
+    // The audio quality preference applies from the next track on
+    connect(m_configManager.get(), &ConfigManager::networkSettingsChanged,
+            this, [this]() {
+                if (m_networkManager) {
+                    m_networkManager->setAudioQuality(
+                        network::audioQualityFromString(m_configManager->getAudioQuality().toStdString()));
+                }
+            });
+    
+    connect(m_configManager.get(), &ConfigManager::coverCacheBudgetChanged,
+            this, [this](int megabytes) {
+                if (m_coverCache) {
+                    m_coverCache->setBudgetBytes(static_cast<int64_t>(std::max(0, megabytes)) * 1024 * 1024);
+                }
+            });
+    
+    connect(m_configManager.get(), &ConfigManager::audioCacheBudgetChanged,
+            this, [this](int megabytes) {
+                if (auto store = std::atomic_load(&m_audioCacheStore)) {
+                    store->setBudget(static_cast<uint64_t>(std::max(0, megabytes)) * 1024 * 1024);
+                }
+            });
+    
+    connect(m_configManager.get(), &ConfigManager::cacheTranscodeChanged,
+            this, [this]() {
+                if (auto transcoder = std::atomic_load(&m_cacheTranscoder)) {
+                    transcoder->setBitrateKbps(m_configManager->getCacheTranscodeBitrateKbps());
+                    transcoder->setEnabled(m_configManager->getCacheTranscodeEnabled());
+                }
+            });
     
     // Phase 3d: Handle deletion of currently playing song
     // When a song is deleted from the current playlist, the audio player should respond
@@ -305,6 +565,17 @@ void ApplicationContext::shutdown()
     
     LOG_INFO("Shutting down ApplicationContext...");
     
+    // Startup steps still running in the background use the managers
+    m_startup.reset();
+    // Stops a transcode in progress; it writes to the audio cache
+    m_cacheTranscoder.reset();
+    if (m_memoryPressureMonitor) {
+        m_memoryPressureMonitor->stop();
+    }
+    m_memoryPressureMonitor.reset();
+    m_streamBufferBudget.reset();
+    m_idleMode.reset();
+    
     try {
         // Phase 3 shutdown: Data managers and audio (reverse order)
         LOG_INFO("Shutdown Phase 3: Stopping audio and data managers");
@@ -342,6 +613,11 @@ void ApplicationContext::shutdown()
             LOG_DEBUG("Saving configuration...");
             m_configManager->saveToFile();
         }
+        if (m_audioCacheStore) {
+            m_audioCacheStore->flush();
+        }
+        m_audioCacheStore.reset();
+        m_coverCache.reset();
         m_configManager.reset();
         emit shutdownPhaseCompleted(1);
         
@@ -358,6 +634,8 @@ void ApplicationContext::shutdown()
         m_audioPlayerController.reset();
         m_playlistManager.reset();
         m_networkManager.reset();
+        m_cacheTranscoder.reset();
+        m_audioCacheStore.reset();
         m_configManager.reset();
         m_initialized = false;
         m_currentPhase = 0;
@@ -365,6 +643,7 @@ void ApplicationContext::shutdown()
         emit shutdownCompleted(); // Still emit completion even on error
     }
     
+    applyTraceSetting(false);
     // Shutdown logging system last (after all other logging is complete)
     LogManager::instance().flush();
     LogManager::instance().shutdown();
@@ -4,28 +4,44 @@
 #include <QString>
 #include <memory>
 #include <functional>
+#include <util/memory_budget.h>
 
 // Forward declarations
 class PlaylistManager;
 class ConfigManager;
 class ThemeManager;
-namespace audio { class AudioPlayerController; }
+namespace audio { class AudioPlayerController; class CacheTranscoder; }
 class EventBus;
 
 // Network namespace forward declaration
 namespace network {
     class NetworkManager;
 }
+namespace util {
+    class AudioCacheStore;
+    class CoverCache;
+    class MemoryPressureMonitor;
+    class IdleMode;
+}
+class StartupGraph;
 
 /**
  * Central application context that holds all global managers
  * Provides controlled access to shared services with proper initialization order
+ *
+ * initialize() runs the managers' setup as a StartupGraph: the network configuration
+ * loads on a worker while the playlists load on the GUI thread, and it returns once
+ * everything the main window uses exists (phases 1 and 2 done). The audio cache index is
+ * read in the background and handed to the managers when ready; phase 3 and
+ * managersInitialized follow on the GUI thread after that.
  */
 class ApplicationContext : public QObject
 {
     Q_OBJECT
     
 public:
+    static constexpr size_t STARTUP_WORKER_THREADS = 2;
+
     static ApplicationContext& instance();
     
     // Initialize all managers with proper dependency order (call once in main.cpp or MainWindow)
@@ -43,6 +59,15 @@ public:
     audio::AudioPlayerController* audioPlayerController() const { return m_audioPlayerController.get(); }
     network::NetworkManager* networkManager() const { return m_networkManager.get(); }
     EventBus* eventBus() const { return m_eventBus.get(); }
+    // Index of the finished songs in the audio cache directory, shared by the network,
+    // playlist and audio managers
+    // (nullptr until the index is read, which finishes in the background)
+    util::AudioCacheStore* audioCacheStore() const { return std::atomic_load(&m_audioCacheStore).get(); }
+    
+    // The main window reports being minimized or hidden (false) and shown again (true);
+    // with playback paused or stopped, hidden means idle mode
+    void setWindowVisible(bool visible);
+    bool isIdle() const;
     
     // Check initialization status
     bool isInitialized() const { return m_initialized; }
@@ -70,21 +95,41 @@ private:
     // Phase-based initialization
     void initializeConfigManager(const QString& workspaceDir);
     void initializeEventBus();
+    void initializeAudioCacheStore();
+    void initializeCoverCache();
     void initializeThemeManager();
     void initializeNetworkManager();
+    void configureNetworkManager();     // Platform config and cookies, off the GUI thread
+    void attachAudioCacheStore();
     void initializePlaylistManager();
     void initializeAudioPlayerController();
+    // Start or stop the Chrome trace written to the log directory
+    void applyTraceSetting(bool enabled);
+    // Cap of util::MemoryBudget, and what to let go when the system runs short
+    void applyMemoryBudget(int budgetMb);
+    void startMemoryMonitoring();
+    void relieveMemoryPressure();
+    // Idle mode: follow playback state and suspend timers and polling threads while idle
+    void startIdleTracking();
+    void applyIdleMode(bool idle);
     
     // Cross-manager connections
     void setupManagerConnections();
     
     // Smart pointers for automatic cleanup
+    std::unique_ptr<StartupGraph> m_startup;    // Until shutdown, for steps still running
     std::unique_ptr<ConfigManager> m_configManager;
     std::shared_ptr<EventBus> m_eventBus;
+    std::shared_ptr<util::AudioCacheStore> m_audioCacheStore;
+    std::shared_ptr<audio::CacheTranscoder> m_cacheTranscoder;    // Created with the store
+    std::shared_ptr<util::CoverCache> m_coverCache;   // One index for the network and playlist managers
     std::unique_ptr<ThemeManager> m_themeManager;
     std::unique_ptr<PlaylistManager> m_playlistManager;
     std::unique_ptr<audio::AudioPlayerController> m_audioPlayerController;
     std::shared_ptr<network::NetworkManager> m_networkManager;
+    util::MemoryBudget::Registration m_streamBufferBudget;
+    std::unique_ptr<util::MemoryPressureMonitor> m_memoryPressureMonitor;
+    std::unique_ptr<util::IdleMode> m_idleMode;
     
     bool m_initialized = false;
     int m_currentPhase = 0;
@@ -97,4 +142,5 @@ private:
 #define THEME_MANAGER APP_CONTEXT.themeManager()
 #define AUDIO_PLAYER_CONTROLLER APP_CONTEXT.audioPlayerController()
 #define NETWORK_MANAGER APP_CONTEXT.networkManager()
-#define EVENT_BUS APP_CONTEXT.eventBus()
\ No newline at end of file
+#define EVENT_BUS APP_CONTEXT.eventBus()
+#define AUDIO_CACHE_STORE APP_CONTEXT.audioCacheStore()
\ No newline at end of file
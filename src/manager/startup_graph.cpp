@@ -0,0 +1,173 @@
+#include "startup_graph.h"
+#include <util/thread_pool.h>
+#include <algorithm>
+#include <stdexcept>
+
+StartupGraph::StartupGraph(size_t workerThreads)
+    : pool_(std::make_unique<util::ThreadPool>(std::max<size_t>(1, workerThreads)))
+{
+}
+
+StartupGraph::~StartupGraph()
+{
+    wait();
+}
+
+void StartupGraph::add(const std::string& name, const std::vector<std::string>& after, Affinity affinity, Step step)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto indexOf = [this](const std::string& stepName) {
+        auto it = std::find_if(nodes_.begin(), nodes_.end(), [&](const Node& node) { return node.name == stepName; });
+        return static_cast<size_t>(it - nodes_.begin());
+    };
+    if (indexOf(name) != nodes_.size()) {
+        throw std::invalid_argument("Duplicate startup step: " + name);
+    }
+    Node node{name, {}, affinity, std::move(step)};
+    for (const std::string& before : after) {
+        const size_t index = indexOf(before);
+        if (index == nodes_.size()) {
+            throw std::invalid_argument("Startup step " + name + " comes after unknown step " + before);
+        }
+        node.after.push_back(index);
+    }
+    nodes_.push_back(std::move(node));
+}
+
+void StartupGraph::setFailureHandler(FailureHandler handler)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    onFailure_ = std::move(handler);
+}
+
+void StartupGraph::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        propagateFailure_unsafe();
+        launchWorkers_unsafe();
+        auto ready = std::find_if(nodes_.begin(), nodes_.end(), [this](const Node& node) {
+            return node.affinity == Affinity::Caller && isReady_unsafe(node);
+        });
+        if (ready != nodes_.end()) {
+            const size_t index = static_cast<size_t>(ready - nodes_.begin());
+            ready->state = State::Running;
+            Step step = ready->step;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                step();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            finish(index, error);
+            lock.lock();
+            continue;
+        }
+        if (callerStepsSettled_unsafe()) {
+            break;
+        }
+        changed_.wait(lock);
+    }
+    for (const Node& node : nodes_) {
+        if (node.affinity == Affinity::Caller && node.state == State::Failed) {
+            std::rethrow_exception(node.error);
+        }
+    }
+}
+
+void StartupGraph::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    // A finishing worker starts what it unblocked before it lets go of the lock, so once
+    // nothing runs nothing will; steps run() never got to don't hold anything up
+    changed_.wait(lock, [this]() {
+        return std::none_of(nodes_.begin(), nodes_.end(),
+            [](const Node& node) { return node.state == State::Running; });
+    });
+}
+
+bool StartupGraph::isDone(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::any_of(nodes_.begin(), nodes_.end(), [&](const Node& node) {
+        return node.name == name && node.state == State::Done;
+    });
+}
+
+bool StartupGraph::isReady_unsafe(const Node& node) const
+{
+    return node.state == State::Pending && std::all_of(node.after.begin(), node.after.end(),
+        [this](size_t index) { return nodes_[index].state == State::Done; });
+}
+
+void StartupGraph::propagateFailure_unsafe()
+{
+    // Steps only come after earlier ones, so one pass in order reaches every dependent
+    for (Node& node : nodes_) {
+        if (node.state != State::Pending) {
+            continue;
+        }
+        for (size_t index : node.after) {
+            if (nodes_[index].state == State::Failed) {
+                node.state = State::Failed;
+                node.error = nodes_[index].error;
+                break;
+            }
+        }
+    }
+}
+
+void StartupGraph::launchWorkers_unsafe()
+{
+    for (size_t index = 0; index < nodes_.size(); ++index) {
+        Node& node = nodes_[index];
+        if (node.affinity != Affinity::Worker || !isReady_unsafe(node)) {
+            continue;
+        }
+        node.state = State::Running;
+        pool_->submit(util::ThreadPool::Priority::Normal, [this, index, step = node.step]() {
+            std::exception_ptr error;
+            try {
+                step();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            finish(index, error);
+        });
+    }
+}
+
+void StartupGraph::finish(size_t index, std::exception_ptr error)
+{
+    if (error) {
+        // Before the failure shows, so run() and wait() return only after it is handled
+        FailureHandler onFailure;
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            onFailure = onFailure_;
+            name = nodes_[index].name;
+        }
+        if (onFailure) {
+            onFailure(name, error);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Node& node = nodes_[index];
+        node.state = error ? State::Failed : State::Done;
+        node.error = error;
+        propagateFailure_unsafe();
+        // Nobody else may be left to start what this one unblocked
+        launchWorkers_unsafe();
+    }
+    changed_.notify_all();
+}
+
+bool StartupGraph::callerStepsSettled_unsafe() const
+{
+    return std::all_of(nodes_.begin(), nodes_.end(), [](const Node& node) {
+        return node.affinity != Affinity::Caller || node.state == State::Done || node.state == State::Failed;
+    });
+}
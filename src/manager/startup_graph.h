@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace util { class ThreadPool; }
+
+/**
+ * @brief Startup steps ordered by what they need, independent ones run in parallel.
+ *
+ * A step runs once every step it comes after is done: Caller steps on the thread calling
+ * run() (for objects bound to the GUI thread), Worker steps on a pool of their own.
+ * run() returns as soon as every Caller step is done; Worker steps nothing on the caller
+ * needs keep going in the background, and wait() or the destructor blocks until they
+ * finish. Steps can only come after steps added before them, so there are no cycles.
+ *
+ * A step that throws fails every step after it. run() rethrows the first failure among
+ * the Caller steps and what they need; later failures only reach onFailure.
+ */
+class StartupGraph
+{
+public:
+    enum class Affinity { Caller, Worker };
+    using Step = std::function<void()>;
+    using FailureHandler = std::function<void(const std::string& step, std::exception_ptr error)>;
+
+    explicit StartupGraph(size_t workerThreads = 2);
+    ~StartupGraph();
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    // Throws std::invalid_argument for a duplicate name or an unknown step in after
+    void add(const std::string& name, const std::vector<std::string>& after, Affinity affinity, Step step);
+    // Called on the failing step's thread
+    void setFailureHandler(FailureHandler handler);
+
+    // Run steps until every Caller step is done; call once
+    void run();
+    // Block until every step is done or failed
+    void wait();
+
+    bool isDone(const std::string& name) const;
+
+private:
+    enum class State { Pending, Running, Done, Failed };
+    struct Node {
+        std::string name;
+        std::vector<size_t> after;
+        Affinity affinity;
+        Step step;
+        State state = State::Pending;
+        std::exception_ptr error;       // Its own failure or that of a step before it
+    };
+
+    bool isReady_unsafe(const Node& node) const;
+    // Fail the pending steps coming after a failed one
+    void propagateFailure_unsafe();
+    void launchWorkers_unsafe();
+    void finish(size_t index, std::exception_ptr error);
+    bool callerStepsSettled_unsafe() const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<Node> nodes_;
+    FailureHandler onFailure_;
+    std::unique_ptr<util::ThreadPool> pool_;    // Last: joined before the nodes go away
+};
@@ -0,0 +1,55 @@
+#include "audio_quality.h"
+
+namespace network
+{
+    size_t selectAudioStream(const std::vector<AudioStreamOption>& options, AudioQuality quality,
+                             uint64_t throughputBytesPerSecond)
+    {
+        if (options.empty()) {
+            return std::string::npos;
+        }
+        size_t lowest = 0;
+        size_t highest = 0;
+        for (size_t i = 1; i < options.size(); ++i) {
+            if (options[i].bandwidth < options[lowest].bandwidth) lowest = i;
+            if (options[i].bandwidth > options[highest].bandwidth) highest = i;
+        }
+        switch (quality) {
+        case AudioQuality::DataSaver:
+            return lowest;
+        case AudioQuality::Best:
+            return highest;
+        case AudioQuality::Auto:
+            break;
+        }
+
+        const double budget = static_cast<double>(throughputBytesPerSecond) * 8.0;
+        size_t chosen = std::string::npos;
+        for (size_t i = 0; i < options.size(); ++i) {
+            const bool fits = throughputBytesPerSecond == 0
+                ? !options[i].lossless
+                : static_cast<double>(options[i].bandwidth) * AUDIO_THROUGHPUT_HEADROOM <= budget;
+            if (fits && (chosen == std::string::npos || options[i].bandwidth > options[chosen].bandwidth)) {
+                chosen = i;
+            }
+        }
+        return chosen == std::string::npos ? lowest : chosen;
+    }
+
+    AudioQuality audioQualityFromString(const std::string& name)
+    {
+        if (name == "data_saver") return AudioQuality::DataSaver;
+        if (name == "best") return AudioQuality::Best;
+        return AudioQuality::Auto;
+    }
+
+    std::string audioQualityToString(AudioQuality quality)
+    {
+        switch (quality) {
+        case AudioQuality::DataSaver: return "data_saver";
+        case AudioQuality::Best: return "best";
+        case AudioQuality::Auto: break;
+        }
+        return "auto";
+    }
+} // namespace network
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace network
+{
+    // Which of a track's audio streams to play
+    enum class AudioQuality {
+        Auto,       // The best the measured throughput sustains
+        DataSaver,  // Always the lowest bitrate
+        Best        // Always the highest, lossless when offered
+    };
+
+    // One audio stream of a track as offered by the platform
+    struct AudioStreamOption {
+        std::string url;
+        uint64_t bandwidth = 0;    // Bits per second
+        bool lossless = false;
+    };
+
+    // Auto needs the throughput to exceed a stream's bitrate by this much, so a dip in the
+    // rate doesn't immediately stall playback
+    constexpr double AUDIO_THROUGHPUT_HEADROOM = 1.5;
+
+    /**
+     * @brief Index of the stream to play out of options, or npos when there are none.
+     *
+     * Auto picks the highest bitrate that throughputBytesPerSecond covers with headroom,
+     * the lowest when none does. While the throughput is unknown (0) it picks the highest
+     * lossy stream, so lossless only plays once the link has shown it can carry it.
+     */
+    size_t selectAudioStream(const std::vector<AudioStreamOption>& options, AudioQuality quality,
+                             uint64_t throughputBytesPerSecond);
+
+    // "auto", "data_saver" and "best" as stored in the settings; anything else is Auto
+    AudioQuality audioQualityFromString(const std::string& name);
+    std::string audioQualityToString(AudioQuality quality);
+} // namespace network
@@ -0,0 +1,60 @@
+#include "cancel_token.h"
+#include <algorithm>
+
+using namespace network;
+
+// ---------------- Registration ----------------
+
+CancelToken::Registration::Registration(Registration&& other) noexcept
+    : owner_(other.owner_), id_(other.id_) {
+    other.owner_ = nullptr;
+}
+
+CancelToken::Registration& CancelToken::Registration::operator=(Registration&& other) noexcept {
+    if (this != &other) {
+        reset();
+        owner_ = other.owner_;
+        id_ = other.id_;
+        other.owner_ = nullptr;
+    }
+    return *this;
+}
+
+void CancelToken::Registration::reset() {
+    if (owner_) {
+        owner_->unregister(id_);
+        owner_ = nullptr;
+    }
+}
+
+// ---------------- CancelToken ----------------
+
+void CancelToken::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cancelled_.exchange(true)) {
+        return;
+    }
+    for (auto& entry : aborts_) {
+        entry.second();
+    }
+    aborts_.clear();
+}
+
+CancelToken::Registration CancelToken::onCancel(Abort abort) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cancelled_.load()) {
+        abort();
+        return Registration();
+    }
+    const uint64_t id = next_id_++;
+    aborts_.emplace_back(id, std::move(abort));
+    return Registration(this, id);
+}
+
+/*************** Private Methods ***************/
+void CancelToken::unregister(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborts_.erase(std::remove_if(aborts_.begin(), aborts_.end(),
+                                 [id](const auto& entry) { return entry.first == id; }),
+                  aborts_.end());
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace network
+{
+    /**
+     * @brief Cancellation shared by every request of one operation, such as a search.
+     *
+     * Polling cancelled() between reads only helps once data arrives. A request blocked
+     * in connect or read therefore also registers an abort action (typically stopping its
+     * httplib client, which closes the socket) for as long as it runs, and cancel() runs
+     * those at once. Aborts run under the token's lock, so one can never fire after its
+     * Registration is gone and hit the next borrower of a pooled client. Thread-safe.
+     */
+    class CancelToken
+    {
+    public:
+        using Abort = std::function<void()>;
+
+        // Unregisters its abort action when destroyed or reset()
+        class Registration {
+        public:
+            Registration() = default;
+            ~Registration() { reset(); }
+            Registration(Registration&& other) noexcept;
+            Registration& operator=(Registration&& other) noexcept;
+            Registration(const Registration&) = delete;
+            Registration& operator=(const Registration&) = delete;
+
+            void reset();
+
+        private:
+            friend class CancelToken;
+            Registration(CancelToken* owner, uint64_t id) : owner_(owner), id_(id) {}
+
+            CancelToken* owner_ = nullptr;
+            uint64_t id_ = 0;
+        };
+
+        CancelToken() = default;
+
+        CancelToken(const CancelToken&) = delete;
+        CancelToken& operator=(const CancelToken&) = delete;
+
+        // Mark cancelled and run every registered abort; later calls do nothing
+        void cancel();
+        bool cancelled() const { return cancelled_.load(); }
+
+        /**
+         * @brief Run abort if the token is cancelled while the Registration lives.
+         * On an already cancelled token abort runs right away. Aborts must be quick and
+         * must not touch the token.
+         */
+        Registration onCancel(Abort abort);
+
+    private:
+        void unregister(uint64_t id);
+
+        std::mutex mutex_;
+        std::atomic<bool> cancelled_{false};
+        uint64_t next_id_ = 1;
+        std::vector<std::pair<uint64_t, Abort>> aborts_;
+    };
+} // namespace network
@@ -0,0 +1,162 @@
+#include "cover_fetcher.h"
+#include "network_executor.h"
+#include <algorithm>
+
+using namespace network;
+
+CoverFetcher::CoverFetcher(BatchFetch fetch, Store store, Lookup lookup)
+    : CoverFetcher(std::move(fetch), std::move(store), std::move(lookup), Options{})
+{
+}
+
+CoverFetcher::CoverFetcher(BatchFetch fetch, Store store, Lookup lookup, Options options)
+    : fetch_(std::move(fetch))
+    , store_(std::move(store))
+    , lookup_(std::move(lookup))
+    , options_(options)
+{
+    options_.maxBatch = std::max<size_t>(options_.maxBatch, 1);
+    options_.maxWorkers = std::max<size_t>(options_.maxWorkers, 1);
+}
+
+CoverFetcher::~CoverFetcher()
+{
+    shutdown();
+}
+
+std::shared_future<CoverFetcher::Path> CoverFetcher::request(const std::string& url)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(url);
+    if (it != pending_.end()) {
+        return it->second.future;
+    }
+    if (stopping_ || url.empty()) {
+        std::promise<Path> failed;
+        failed.set_value(std::nullopt);
+        return failed.get_future().share();
+    }
+
+    Pending& entry = pending_[url];
+    entry.future = entry.promise.get_future().share();
+    queue_.push_back(url);
+    // Running workers pick the URL up with their next batch
+    if (workers_ < options_.maxWorkers) {
+        ++workers_;
+        networkExecutor().submit(util::ThreadPool::Priority::Low, [this]() { workerLoop(); });
+    }
+    return entry.future;
+}
+
+void CoverFetcher::shutdown()
+{
+    std::vector<std::string> dropped;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+        dropped.assign(queue_.begin(), queue_.end());
+        queue_.clear();
+    }
+    for (const auto& url : dropped) {
+        resolve(url, std::nullopt);
+    }
+    // Submitted workers still run once; they find the queue empty and leave
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return workers_ == 0; });
+}
+
+size_t CoverFetcher::pendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+std::string CoverFetcher::thumbnailUrl(const std::string& url, int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        return url;
+    }
+    const size_t scheme = url.find("://");
+    const size_t hostStart = scheme == std::string::npos ? 0 : scheme + 3;
+    const size_t pathStart = url.find('/', hostStart);
+    if (pathStart == std::string::npos) {
+        return url;
+    }
+    const std::string host = url.substr(hostStart, pathStart - hostStart);
+    const std::string suffix = ".hdslb.com";
+    const bool biliCdn = host.size() > suffix.size()
+        && host.compare(host.size() - suffix.size(), suffix.size(), suffix) == 0;
+    // A query string or an existing '@' variant is left alone
+    if (!biliCdn || url.find_first_of("@?", pathStart) != std::string::npos) {
+        return url;
+    }
+    return url + "@" + std::to_string(width) + "w_" + std::to_string(height) + "h_1c.jpg";
+}
+
+/*************** Private Methods ***************/
+void CoverFetcher::workerLoop()
+{
+    for (;;) {
+        std::vector<std::string> batch;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || queue_.empty()) {
+                --workers_;
+                idle_.notify_all();
+                return;
+            }
+            const size_t count = std::min(options_.maxBatch, queue_.size());
+            batch.assign(queue_.begin(), queue_.begin() + count);
+            queue_.erase(queue_.begin(), queue_.begin() + count);
+        }
+
+        // Covers cached since they were queued (or by an earlier run) need no transfer
+        std::vector<std::string> missing;
+        for (const auto& url : batch) {
+            Path cached = lookup_ ? lookup_(url) : std::nullopt;
+            if (cached) {
+                resolve(url, cached);
+            } else {
+                missing.push_back(url);
+            }
+        }
+        if (missing.empty()) {
+            continue;
+        }
+
+        std::vector<bool> resolved(missing.size(), false);
+        try {
+            fetch_(missing, [&](size_t index, std::string&& body) {
+                if (index >= missing.size() || resolved[index]) {
+                    return;
+                }
+                resolved[index] = true;
+                Path path = body.empty() ? std::nullopt : store_(missing[index], std::move(body));
+                resolve(missing[index], path);
+            });
+        } catch (const std::exception&) {
+            // Whatever the batch didn't deliver fails below
+        }
+        for (size_t i = 0; i < missing.size(); ++i) {
+            if (!resolved[i]) {
+                resolve(missing[i], std::nullopt);
+            }
+        }
+    }
+}
+
+void CoverFetcher::resolve(const std::string& url, const Path& path)
+{
+    std::promise<Path> promise;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pending_.find(url);
+        if (it == pending_.end()) {
+            return;
+        }
+        promise = std::move(it->second.promise);
+        pending_.erase(it);
+    }
+    // Set outside the lock: continuations may request further covers
+    promise.set_value(path);
+}
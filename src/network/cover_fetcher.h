@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace network
+{
+    /**
+     * @brief Downloads cover images into a cache, each URL at most once at a time.
+     *
+     * A search page names the same cover many times (every part of a multi-part video
+     * repeats it), so request() hands a URL that is already queued or downloading the
+     * future of that transfer instead of starting another. Queued URLs are taken in
+     * batches of up to maxBatch and given to the BatchFetch together, which lets it run a
+     * whole batch over one kept-alive connection per host. At most maxWorkers batches run
+     * at once, as Low priority tasks on the network executor. Lookup is asked first so
+     * covers already cached need no transfer. All methods are thread-safe.
+     */
+    class CoverFetcher
+    {
+    public:
+        // Cached file path, nullopt when the cover could not be fetched or stored
+        using Path = std::optional<std::string>;
+        using BodySink = std::function<void(size_t index, std::string&& body)>;
+        // Download urls and pass each body to the sink with its index; a failed download is
+        // just left out. Called on an executor worker
+        using BatchFetch = std::function<void(const std::vector<std::string>& urls, const BodySink& sink)>;
+        using Store = std::function<Path(const std::string& url, std::string&& body)>;
+        using Lookup = std::function<Path(const std::string& url)>;
+
+        struct Options {
+            size_t maxBatch = 8;
+            size_t maxWorkers = 2;
+        };
+
+        CoverFetcher(BatchFetch fetch, Store store, Lookup lookup);
+        CoverFetcher(BatchFetch fetch, Store store, Lookup lookup, Options options);
+        ~CoverFetcher();
+
+        CoverFetcher(const CoverFetcher&) = delete;
+        CoverFetcher& operator=(const CoverFetcher&) = delete;
+
+        // Queue url unless it is already queued or downloading; resolves to its cached path
+        std::shared_future<Path> request(const std::string& url);
+        // Resolve everything still queued to nullopt and wait for running batches; later
+        // requests resolve to nullopt at once
+        void shutdown();
+
+        // URLs queued or downloading
+        size_t pendingCount() const;
+
+        /**
+         * @brief The CDN variant of a Bilibili cover scaled and cropped to width x height,
+         * as JPEG (suffix \@{w}w_{h}h_1c.jpg). URLs of other hosts, or that already name a
+         * variant, are returned unchanged.
+         */
+        static std::string thumbnailUrl(const std::string& url, int width, int height);
+
+    private:
+        void workerLoop();
+        void resolve(const std::string& url, const Path& path);
+
+        BatchFetch fetch_;
+        Store store_;
+        Lookup lookup_;
+        Options options_;
+        mutable std::mutex mutex_;
+        std::condition_variable idle_;
+        std::deque<std::string> queue_;
+        // Queued or downloading URLs and the promise their requests share
+        struct Pending {
+            std::promise<Path> promise;
+            std::shared_future<Path> future;
+        };
+        std::unordered_map<std::string, Pending> pending_;
+        size_t workers_ = 0;
+        bool stopping_ = false;
+    };
+} // namespace network
@@ -0,0 +1,219 @@
+#include "http_client_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace network;
+
+// ---------------- Lease ----------------
+
+HttpClientPool::Lease::Lease(std::shared_ptr<Bucket> bucket, std::shared_ptr<httplib::Client> client, bool isNew)
+    : bucket_(std::move(bucket)), client_(std::move(client)), new_(isNew) {}
+
+HttpClientPool::Lease::~Lease() {
+    release();
+}
+
+HttpClientPool::Lease::Lease(Lease&& other) noexcept
+    : bucket_(std::move(other.bucket_)), client_(std::move(other.client_)), new_(other.new_) {}
+
+HttpClientPool::Lease& HttpClientPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        bucket_ = std::move(other.bucket_);
+        client_ = std::move(other.client_);
+        new_ = other.new_;
+    }
+    return *this;
+}
+
+void HttpClientPool::Lease::release() {
+    if (bucket_ && client_) {
+        bucket_->giveBack(client_);
+    }
+    bucket_.reset();
+    client_.reset();
+}
+
+// ---------------- HttpClientPool ----------------
+
+HttpClientPool::HttpClientPool()
+    : HttpClientPool(Options{}) {}
+
+HttpClientPool::HttpClientPool(Options options)
+    : options_(options) {
+    options_.maxInFlightPerHost = std::max<size_t>(1, options_.maxInFlightPerHost);
+}
+
+HttpClientPool::~HttpClientPool() {
+    shutdown();
+}
+
+HttpClientPool::Lease HttpClientPool::acquire(const std::string& host) {
+    std::shared_ptr<Bucket> target;
+    std::string origin = host;
+    int timeout = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return Lease();
+        auto& slot = buckets_[host];
+        if (!slot) {
+            slot = std::make_shared<Bucket>();
+            slot->maxIdle = options_.maxIdlePerHost;
+            slot->maxInFlight = options_.maxInFlightPerHost;
+        }
+        target = slot;
+        timeout = options_.timeoutSeconds;
+        auto redirect = redirects_.find(host);
+        if (redirect != redirects_.end()) {
+            origin = redirect->second;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(target->mutex);
+    target->returned.wait(lock, [&]() {
+        return target->closed || !target->idle.empty() || target->lent.size() < target->maxInFlight;
+    });
+    if (target->closed) return Lease();
+
+    std::shared_ptr<httplib::Client> client;
+    const bool isNew = target->idle.empty();
+    if (!isNew) {
+        client = std::move(target->idle.back());
+        target->idle.pop_back();
+    } else {
+        // Constructing a client does not connect, so this is cheap enough under the bucket lock
+        client = createClient(origin, timeout);
+    }
+    target->lent.push_back(client);
+    return Lease(target, std::move(client), isNew);
+}
+
+size_t HttpClientPool::warmUp(const std::string& host, size_t connections,
+                              const std::function<bool(httplib::Client&)>& probe) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Beyond the in-flight limit acquire() would wait on our own leases
+        connections = std::min({ connections, options_.maxIdlePerHost, options_.maxInFlightPerHost });
+    }
+    // Hold every lease at once so each probe gets its own connection
+    std::vector<Lease> leases;
+    for (size_t i = 0; i < connections; ++i) {
+        Lease lease = acquire(host);
+        if (!lease) break;
+        leases.push_back(std::move(lease));
+    }
+
+    std::atomic<size_t> connected{0};
+    std::vector<std::thread> probes;
+    probes.reserve(leases.size());
+    for (auto& lease : leases) {
+        probes.emplace_back([&probe, &lease, &connected]() {
+            try {
+                if (probe(*lease)) ++connected;
+            } catch (...) {
+                // A failed probe only means the first real request connects itself
+            }
+        });
+    }
+    for (auto& thread : probes) {
+        thread.join();
+    }
+    return connected.load();
+}
+
+void HttpClientPool::setTimeout(int timeoutSeconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_.timeoutSeconds = timeoutSeconds;
+}
+
+void HttpClientPool::setHostRedirects(std::unordered_map<std::string, std::string> redirects) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    redirects_ = std::move(redirects);
+}
+
+void HttpClientPool::shutdown() {
+    std::vector<std::shared_ptr<Bucket>> buckets;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        for (auto& pair : buckets_) {
+            buckets.push_back(pair.second);
+        }
+    }
+
+    std::vector<std::shared_ptr<httplib::Client>> clients;
+    for (auto& bucket : buckets) {
+        {
+            std::lock_guard<std::mutex> lock(bucket->mutex);
+            bucket->closed = true;
+            clients.insert(clients.end(), bucket->idle.begin(), bucket->idle.end());
+            clients.insert(clients.end(), bucket->lent.begin(), bucket->lent.end());
+            bucket->idle.clear();
+        }
+        bucket->returned.notify_all();
+    }
+    // Lent clients are stopped too so in-flight requests end promptly
+    for (auto& client : clients) {
+        try {
+            client->stop();
+        } catch (...) {
+            // ignore
+        }
+    }
+}
+
+size_t HttpClientPool::clientCount(const std::string& host) const {
+    std::shared_ptr<Bucket> bucket;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bucket = findBucket_unsafe(host);
+    }
+    if (!bucket) return 0;
+    std::lock_guard<std::mutex> lock(bucket->mutex);
+    return bucket->idle.size() + bucket->lent.size();
+}
+
+size_t HttpClientPool::idleCount(const std::string& host) const {
+    std::shared_ptr<Bucket> bucket;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bucket = findBucket_unsafe(host);
+    }
+    if (!bucket) return 0;
+    std::lock_guard<std::mutex> lock(bucket->mutex);
+    return bucket->idle.size();
+}
+
+/*************** Private Methods ***************/
+void HttpClientPool::Bucket::giveBack(const std::shared_ptr<httplib::Client>& client) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(lent.begin(), lent.end(), client);
+        if (it != lent.end()) lent.erase(it);
+        // Over the idle cap the client is not kept; the lease drops the last reference
+        // and closes the connection after this returns
+        if (!closed && idle.size() < maxIdle) {
+            idle.push_back(client);
+        }
+    }
+    returned.notify_one();
+}
+
+std::shared_ptr<HttpClientPool::Bucket> HttpClientPool::findBucket_unsafe(const std::string& host) const {
+    auto it = buckets_.find(host);
+    return it == buckets_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<httplib::Client> HttpClientPool::createClient(const std::string& origin, int timeoutSeconds) const {
+    auto client = std::make_shared<httplib::Client>(origin);
+    client->set_keep_alive(true);
+    client->enable_server_certificate_verification(true);
+    client->set_follow_location(options_.followLocation);
+    client->set_connection_timeout(timeoutSeconds, 0);
+    client->set_read_timeout(timeoutSeconds, 0);
+    // Compressed API bodies are decoded by the caller (http_compression.h), which also
+    // counts their size on the wire
+    client->set_decompress(false);
+    return client;
+}
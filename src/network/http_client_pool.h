@@ -0,0 +1,135 @@
+#pragma once
+
+#include <httplib.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace network
+{
+    /**
+     * @brief Keep-alive httplib clients grouped by host, safe to use from many threads.
+     *
+     * Each host has its own bucket with its own lock, held only to pop or push a client,
+     * so requests to one host never wait on requests to another and the round-trip itself
+     * runs unlocked. At most maxInFlightPerHost clients of a host are lent out at once
+     * (acquire() waits for one to come back), and at most maxIdlePerHost are kept open
+     * between requests; extra clients are closed when returned.
+     */
+    class HttpClientPool
+    {
+    public:
+        struct Options {
+            size_t maxIdlePerHost = 4;
+            size_t maxInFlightPerHost = 8;
+            int timeoutSeconds = 10;
+            bool followLocation = true;
+        };
+
+    private:
+        struct Bucket;
+
+    public:
+        /**
+         * @brief A borrowed client, handed back to its bucket on destruction.
+         * An empty lease (operator bool false) means the pool was shut down.
+         */
+        class Lease
+        {
+        public:
+            Lease() = default;
+            ~Lease();
+            Lease(Lease&& other) noexcept;
+            Lease& operator=(Lease&& other) noexcept;
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+
+            httplib::Client* operator->() const { return client_.get(); }
+            httplib::Client& operator*() const { return *client_; }
+            explicit operator bool() const { return client_ != nullptr; }
+
+            // Return the client early
+            void release();
+            // Whether the client was created for this lease, so its first request also
+            // pays for DNS, TCP and TLS setup
+            bool isNew() const { return new_; }
+
+        private:
+            friend class HttpClientPool;
+            Lease(std::shared_ptr<Bucket> bucket, std::shared_ptr<httplib::Client> client, bool isNew);
+
+            std::shared_ptr<Bucket> bucket_;
+            std::shared_ptr<httplib::Client> client_;
+            bool new_ = false;
+        };
+
+        HttpClientPool();
+        explicit HttpClientPool(Options options);
+        ~HttpClientPool();
+
+        HttpClientPool(const HttpClientPool&) = delete;
+        HttpClientPool& operator=(const HttpClientPool&) = delete;
+
+        /**
+         * @brief Borrow a client for host (scheme included, e.g. https://api.bilibili.com),
+         * reusing an idle one or creating a new one. Blocks while the host is at its
+         * in-flight limit.
+         * @return Empty lease after shutdown()
+         */
+        Lease acquire(const std::string& host);
+
+        /**
+         * @brief Open up to `connections` keep-alive connections to host ahead of use.
+         * Borrows that many clients at once (capped at the idle limit) and runs probe on
+         * each from its own thread, so DNS, TCP and TLS setup overlap; the clients then
+         * go back to the pool still connected. probe sends some cheap request.
+         * @return How many probes succeeded
+         */
+        size_t warmUp(const std::string& host, size_t connections,
+                      const std::function<bool(httplib::Client&)>& probe);
+
+        // Applies to clients created from now on
+        void setTimeout(int timeoutSeconds);
+
+        /**
+         * @brief Send requests for some hosts to another origin, e.g.
+         * {"https://api.bilibili.com", "http://127.0.0.1:8080"}. Clients stay grouped
+         * under the host they were acquired for; only the connection target changes.
+         * Applies to clients created from now on. Meant for tests replaying recorded traffic.
+         */
+        void setHostRedirects(std::unordered_map<std::string, std::string> redirects);
+
+        // Stop every client, including lent ones, and make acquire() fail
+        void shutdown();
+
+        // Clients of a host that are open (idle + lent out)
+        size_t clientCount(const std::string& host) const;
+        size_t idleCount(const std::string& host) const;
+
+    private:
+        struct Bucket {
+            std::mutex mutex;
+            std::condition_variable returned;
+            std::vector<std::shared_ptr<httplib::Client>> idle;
+            std::vector<std::shared_ptr<httplib::Client>> lent;
+            size_t maxIdle = 0;
+            size_t maxInFlight = 0;
+            bool closed = false;
+
+            void giveBack(const std::shared_ptr<httplib::Client>& client);
+        };
+
+        std::shared_ptr<Bucket> findBucket_unsafe(const std::string& host) const;
+        std::shared_ptr<httplib::Client> createClient(const std::string& origin, int timeoutSeconds) const;
+
+        Options options_;
+        mutable std::mutex mutex_;      // Guards buckets_, closed_, redirects_ and options_.timeoutSeconds
+        std::unordered_map<std::string, std::shared_ptr<Bucket>> buckets_;
+        std::unordered_map<std::string, std::string> redirects_;
+        bool closed_ = false;
+    };
+} // namespace network
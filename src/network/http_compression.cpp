@@ -0,0 +1,150 @@
+#include "http_compression.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <vector>
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+#include <brotli/decode.h>
+#endif
+
+namespace network
+{
+    namespace {
+        constexpr size_t DECODE_CHUNK = 64 * 1024;
+        // A body inflating past this is treated as corrupt rather than buffered
+        constexpr size_t MAX_DECODED_SIZE = 64 * 1024 * 1024;
+
+        std::vector<std::string> splitCodings(const std::string& encoding) {
+            std::vector<std::string> codings;
+            size_t start = 0;
+            while (start <= encoding.size()) {
+                size_t end = encoding.find(',', start);
+                if (end == std::string::npos) end = encoding.size();
+                std::string coding = encoding.substr(start, end - start);
+                coding.erase(0, coding.find_first_not_of(" \t"));
+                coding.erase(coding.find_last_not_of(" \t") + 1);
+                std::transform(coding.begin(), coding.end(), coding.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                if (!coding.empty() && coding != "identity") {
+                    codings.push_back(std::move(coding));
+                }
+                start = end + 1;
+            }
+            return codings;
+        }
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+        // windowBits 15 + 32 accepts zlib and gzip headers, -15 raw deflate
+        bool inflateBody(const std::string& in, int windowBits, std::string& out) {
+            z_stream stream{};
+            if (inflateInit2(&stream, windowBits) != Z_OK) return false;
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+            stream.avail_in = static_cast<uInt>(in.size());
+
+            std::vector<char> chunk(DECODE_CHUNK);
+            std::string result;
+            int ret = Z_OK;
+            while (ret != Z_STREAM_END) {
+                stream.next_out = reinterpret_cast<Bytef*>(chunk.data());
+                stream.avail_out = static_cast<uInt>(chunk.size());
+                ret = inflate(&stream, Z_NO_FLUSH);
+                // Z_BUF_ERROR here means the input ended before the stream did
+                if ((ret != Z_OK && ret != Z_STREAM_END)
+                    || result.size() + (chunk.size() - stream.avail_out) > MAX_DECODED_SIZE) {
+                    inflateEnd(&stream);
+                    return false;
+                }
+                result.append(chunk.data(), chunk.size() - stream.avail_out);
+            }
+            inflateEnd(&stream);
+            out = std::move(result);
+            return true;
+        }
+#endif
+
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+        bool brotliBody(const std::string& in, std::string& out) {
+            BrotliDecoderState* state = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+            if (!state) return false;
+            const uint8_t* next_in = reinterpret_cast<const uint8_t*>(in.data());
+            size_t avail_in = in.size();
+
+            std::vector<uint8_t> chunk(DECODE_CHUNK);
+            std::string result;
+            BrotliDecoderResult ret = BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+            while (ret == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
+                uint8_t* next_out = chunk.data();
+                size_t avail_out = chunk.size();
+                ret = BrotliDecoderDecompressStream(state, &avail_in, &next_in, &avail_out, &next_out, nullptr);
+                if (result.size() + (chunk.size() - avail_out) > MAX_DECODED_SIZE) {
+                    ret = BROTLI_DECODER_RESULT_ERROR;
+                    break;
+                }
+                result.append(reinterpret_cast<const char*>(chunk.data()), chunk.size() - avail_out);
+            }
+            BrotliDecoderDestroyInstance(state);
+            // NEEDS_MORE_INPUT: the body was truncated
+            if (ret != BROTLI_DECODER_RESULT_SUCCESS) return false;
+            out = std::move(result);
+            return true;
+        }
+#endif
+
+        bool decodeOne(const std::string& coding, const std::string& in, std::string& out) {
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+            if (coding == "gzip" || coding == "x-gzip") {
+                return inflateBody(in, 15 + 32, out);
+            }
+            if (coding == "deflate") {
+                // Meant to be zlib-wrapped, but some servers send raw deflate
+                return inflateBody(in, 15 + 32, out) || inflateBody(in, -15, out);
+            }
+#endif
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+            if (coding == "br") {
+                return brotliBody(in, out);
+            }
+#endif
+            (void)in;
+            (void)out;
+            return false;
+        }
+    }
+
+    const std::string& acceptedContentEncodings()
+    {
+        static const std::string encodings = []() {
+            std::string value;
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+            value = "br";
+#endif
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+            value += value.empty() ? "gzip, deflate" : ", gzip, deflate";
+#endif
+            return value.empty() ? std::string("identity") : value;
+        }();
+        return encodings;
+    }
+
+    bool decodeContent(const std::string& encoding, const std::string& body, std::string& decoded)
+    {
+        const std::vector<std::string> codings = splitCodings(encoding);
+        if (codings.empty()) {
+            decoded = body;
+            return true;
+        }
+        std::string current = body;
+        for (auto it = codings.rbegin(); it != codings.rend(); ++it) {
+            std::string next;
+            if (!decodeOne(*it, current, next)) {
+                return false;
+            }
+            current = std::move(next);
+        }
+        decoded = std::move(current);
+        return true;
+    }
+} // namespace network
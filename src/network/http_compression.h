@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+namespace network
+{
+    /**
+     * @brief Content-Encoding support for API responses, decoded here rather than inside
+     * httplib so callers see both the compressed and the decoded size.
+     *
+     * Which codings are available follows the httplib build: gzip and deflate with
+     * CPPHTTPLIB_ZLIB_SUPPORT, br with CPPHTTPLIB_BROTLI_SUPPORT.
+     */
+
+    // Accept-Encoding value for the codings this build decodes, e.g. "br, gzip, deflate";
+    // "identity" when there are none
+    const std::string& acceptedContentEncodings();
+
+    /**
+     * @brief Undo the Content-Encoding of a response body.
+     * @param encoding Content-Encoding header value; codings are undone last to first,
+     *        empty and "identity" pass the body through
+     * @return false for a coding this build can't decode or a corrupt body
+     */
+    bool decodeContent(const std::string& encoding, const std::string& body, std::string& decoded);
+} // namespace network
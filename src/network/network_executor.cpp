@@ -0,0 +1,10 @@
+#include "network_executor.h"
+
+namespace network
+{
+    util::ThreadPool& networkExecutor()
+    {
+        static util::ThreadPool* executor = new util::ThreadPool(NETWORK_EXECUTOR_THREADS, NETWORK_EXECUTOR_RESERVED);
+        return *executor;
+    }
+} // namespace network
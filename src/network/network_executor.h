@@ -0,0 +1,21 @@
+#pragma once
+
+#include <util/thread_pool.h>
+
+namespace network
+{
+    constexpr size_t NETWORK_EXECUTOR_THREADS = 8;
+    // Workers Low-priority tasks (downloads, prefetches) can never take
+    constexpr size_t NETWORK_EXECUTOR_RESERVED = 2;
+
+    /**
+     * @brief Pool shared by NetworkManager and the platforms for request-scoped work:
+     * searches, page lookups, stream size queries, opening streams, downloads and
+     * prefetches. The HTTP transfers themselves keep their own threads, since they last
+     * as long as a song is read and would pin workers.
+     *
+     * Created on first use and intentionally never destroyed, so tasks still running at
+     * exit can't touch a destroyed pool.
+     */
+    util::ThreadPool& networkExecutor();
+} // namespace network
@@ -1,11 +1,15 @@
 #include "network_manager.h"
 #include "platform/i_platform.h"
 #include "platform/bili_network_interface.h"
+#include "network_executor.h"
+#include "part_file.h"
 #include <log/log_manager.h>
 #include <future>
 #include <thread>
 #include <chrono>
+#include <algorithm>
 #include <fstream>
+#include <vector>
 #include <QUrl>
 #include <QFile>
 #include <QFileInfo>
@@ -15,12 +19,65 @@
 
 namespace network
 {
+    namespace {
+        // Sequential streams overflow to disk up to this much (hours of audio) before blocking
+        constexpr uint64_t STREAM_SPILL_LIMIT = 512ull * 1024 * 1024;
+        // Full downloads of a known size are split into Range segments over parallel
+        // connections, since the CDN throttles each connection
+        constexpr size_t DOWNLOAD_CONNECTIONS = 4;
+        constexpr uint64_t DOWNLOAD_SEGMENT_SIZE = 1024 * 1024;
+        // Prefetched tracks that haven't played yet may hold this much disk by default
+        constexpr uint64_t DEFAULT_PREFETCH_DISK_BUDGET = 256ull * 1024 * 1024;
+        // Covers are requested from the CDN at this size, about twice the largest on screen
+        constexpr int COVER_THUMB_WIDTH = 320;
+        constexpr int COVER_THUMB_HEIGHT = 200;
+
+        using Priority = util::ThreadPool::Priority;
+    }
+
     NetworkManager::NetworkManager()
         : QObject(nullptr)
         , m_configured(false)
     {
         // Initialize BilibiliNetworkInterface (use shared_ptr so platform can shared_from_this)
         m_biliInterface = std::make_shared<BilibiliPlatform>();
+        // The scheduler is shut down first thing in the destructor, so the raw this is safe
+        m_prefetcher = std::make_unique<PrefetchScheduler>(
+            [this](const PrefetchScheduler::Item& item, uint64_t budgetLeft, const PrefetchScheduler::StopCheck& stop) {
+                return prefetchTrack(item, budgetLeft, stop);
+            },
+            [this]() { return isNetworkIdle(); });
+        m_prefetcher->setDiskBudget(DEFAULT_PREFETCH_DISK_BUDGET);
+        // Shut down in the destructor before anything the callbacks use goes away
+        m_coverFetcher = std::make_unique<CoverFetcher>(
+            [this](const std::vector<std::string>& urls, const CoverFetcher::BodySink& sink) {
+                // One Cover slot per batch, which then runs over pooled keep-alive clients
+                TransferScheduler::Slot slot = m_transfers.acquire(TransferClass::Cover,
+                    [this]() { return m_exitFlag.load(); });
+                if (slot) {
+                    m_biliInterface->fetchSmallFiles(urls, sink);
+                }
+            },
+            [this](const std::string& url, std::string&& body) -> CoverFetcher::Path {
+                std::shared_ptr<util::CoverCache> cache;
+                {
+                    std::lock_guard<std::mutex> lock(m_coverCacheMutex);
+                    cache = m_coverCache;
+                }
+                auto saved = cache
+                    ? cache->saveCover(QString::fromStdString(url), QByteArray(body.data(), static_cast<qsizetype>(body.size())))
+                    : std::nullopt;
+                return saved ? CoverFetcher::Path(saved->toStdString()) : std::nullopt;
+            },
+            [this](const std::string& url) -> CoverFetcher::Path {
+                std::shared_ptr<util::CoverCache> cache;
+                {
+                    std::lock_guard<std::mutex> lock(m_coverCacheMutex);
+                    cache = m_coverCache;
+                }
+                auto found = cache ? cache->findCachedCover(QString::fromStdString(url)) : std::nullopt;
+                return found ? CoverFetcher::Path(found->toStdString()) : std::nullopt;
+            });
         LOG_DEBUG("NetworkManager created");
     }
     
@@ -28,12 +85,16 @@ namespace network
     {
         // Signal exit to any running async tasks
         m_exitFlag.store(true);
+        m_prefetcher->shutdown();
+        m_coverFetcher->shutdown();
 
         // Signal cancel for searches
         cancelAllSearches();
 
         // Signal cancel for any active downloads and notify associated buffers
         std::vector<std::shared_ptr<RealtimePipe>> pipes;
+        std::vector<std::shared_ptr<BroadcastPipe>> broadcasts;
+        std::vector<std::shared_ptr<SeekableRangeStream>> rangeStreams;
         {
             std::lock_guard<std::mutex> lg(m_bgMutex);
             for (auto &entry : m_downloadCancelTokens) {
@@ -41,6 +102,10 @@ namespace network
                     entry.token->store(true);
                 if (entry.buffer)
                     pipes.push_back(entry.buffer);
+                if (entry.broadcast)
+                    broadcasts.push_back(entry.broadcast);
+                if (entry.rangeStream)
+                    rangeStreams.push_back(entry.rangeStream);
             }
             m_downloadCancelTokens.clear();
         }
@@ -48,6 +113,14 @@ namespace network
             pipe->close();
         }
         pipes.clear();
+        for (auto& broadcast : broadcasts) {
+            broadcast->close();
+        }
+        broadcasts.clear();
+        for (auto& rangeStream : rangeStreams) {
+            rangeStream->close();
+        }
+        rangeStreams.clear();
         
         // Join background watcher threads
         {
@@ -94,6 +167,20 @@ namespace network
         LOG_INFO("NetworkManager configuration complete");
     }
 
+    void NetworkManager::setPageCacheTtl(int hours)
+    {
+        if (m_biliInterface) {
+            m_biliInterface->setPageCacheTtl(std::chrono::hours(std::max(0, hours)));
+        }
+    }
+
+    void NetworkManager::setAudioQuality(AudioQuality quality)
+    {
+        if (m_biliInterface) {
+            m_biliInterface->setAudioQuality(quality);
+        }
+    }
+
     void NetworkManager::saveConfiguration()
     {
         if (m_biliInterface) {
@@ -104,6 +191,30 @@ namespace network
             }
         }
         //TODO save other interfaces' configurations if exists.
+        logRequestMetrics();
+    }
+
+    std::vector<RequestMetrics::EndpointStats> NetworkManager::requestMetrics() const
+    {
+        if (!m_biliInterface) {
+            return {};
+        }
+        return m_biliInterface->requestMetrics();
+    }
+
+    void NetworkManager::logRequestMetrics() const
+    {
+        // Times in milliseconds, p50/p95
+        auto ms = [](uint64_t micros) { return micros / 1000.0; };
+        for (const auto& stats : requestMetrics()) {
+            LOG_INFO("{}: {} requests, {} failed, {} retries, {} new connections, {} bytes; "
+                     "wait {:.1f}/{:.1f} ms, first byte {:.1f}/{:.1f} ms (new connection {:.1f}/{:.1f} ms), total {:.1f}/{:.1f} ms",
+                     stats.endpoint, stats.requests, stats.failures, stats.retries, stats.newConnections, stats.bytes,
+                     ms(stats.wait.percentile(50)), ms(stats.wait.percentile(95)),
+                     ms(stats.firstByte.percentile(50)), ms(stats.firstByte.percentile(95)),
+                     ms(stats.firstByteNewConnection.percentile(50)), ms(stats.firstByteNewConnection.percentile(95)),
+                     ms(stats.total.percentile(50)), ms(stats.total.percentile(95)));
+        }
     }
 
     // std::weak_ptr<BilibiliNetworkInterface> NetworkManager::getBiliNetworkInterface()
@@ -111,7 +222,7 @@ namespace network
     //     return m_biliInterface;
     // }
     
-    void NetworkManager::executeMultiSourceSearch(const QString& keyword, uint selectedInterface, int maxResults)
+    void NetworkManager::executeMultiSourceSearch(const QString& keyword, uint selectedInterface, int maxResults, int page)
     {
         if (keyword.trimmed().isEmpty()) {
             LOG_WARN("Search failed: keyword is empty");
@@ -119,166 +230,425 @@ namespace network
             return;
         }
         
-        LOG_INFO("Starting multi-source search for: '{}', interfaces: {}, maxResults: {}", 
-                keyword.toStdString(), selectedInterface, maxResults);
+        page = std::max(page, 1);
+        LOG_INFO("Starting multi-source search for: '{}', interfaces: {}, maxResults: {}, page: {}", 
+                keyword.toStdString(), selectedInterface, maxResults, page);
         
-        // Reset cancel flag for new search
-        m_cancelFlag = false;
+        // Reset cancel flag for new search; anything still running from an older search
+        // no longer matches the generation and stops emitting, and its requests in flight
+        // are aborted. Later pages keep the generation and token of the search they continue
+        uint64_t generation = m_searchGeneration.load();
+        std::shared_ptr<CancelToken> cancel;
+        if (page == 1) {
+            cancel = std::make_shared<CancelToken>();
+            std::shared_ptr<CancelToken> previous;
+            {
+                std::lock_guard<std::mutex> lock(m_searchTokenMutex);
+                previous = std::exchange(m_searchToken, cancel);
+            }
+            previous->cancel();
+            generation = ++m_searchGeneration;
+            m_cancelFlag = false;
+        } else {
+            cancel = currentSearchToken();
+        }
         
-        // Vector to store futures for monitoring
-        std::vector<std::future<void>> searchFutures;
+        // One result per platform search, for completeSearchWhenDone()
+        std::vector<util::AsyncResult<void>> searches;
         
-        // Launch Bilibili search if requested
+        // Launch Bilibili search if requested; a search repeated within the cache TTL is
+        // answered from the cache without touching the network
         if (selectedInterface & PlatformType::Bilibili) {
-            auto bilibiliFuture = std::async(std::launch::async, [self = this->shared_from_this(), keyword, maxResults]() {
-                try {
-                    if (self->m_exitFlag.load()) return;
-                    auto biliResults = self->performBilibiliSearchAsync(keyword, maxResults, self->m_cancelFlag).get();
-                    if (!self->m_cancelFlag.load()) {
-                        QMetaObject::invokeMethod(self.get(), [self, keyword, biliResults]() {
-                            emit self->searchProgress(keyword, biliResults);
-                        }, Qt::QueuedConnection);
+            auto cached = m_searchCache.find(keyword, page, PlatformType::Bilibili, maxResults);
+            if (cached) {
+                LOG_DEBUG("Bilibili search for '{}' served from cache ({} results)",
+                          keyword.toStdString(), cached->size());
+                QMetaObject::invokeMethod(this, [self = this->shared_from_this(), keyword, generation, results = std::move(*cached)]() {
+                    if (self->isSearchCurrent(generation) && !results.isEmpty()) {
+                        emit self->searchProgress(keyword, results);
                     }
-                } catch (const std::exception& e) {
-                    if (!self->m_cancelFlag.load()) {
-                        QMetaObject::invokeMethod(self.get(), [self, keyword, e]() {
-                            emit self->searchFailed(keyword, QString("Bilibili search failed: %1").arg(e.what()));
-                        }, Qt::QueuedConnection);
+                }, Qt::QueuedConnection);
+            } else {
+                auto search = [self = this->shared_from_this(), keyword, maxResults, page, generation, cancel]() {
+                    try {
+                        if (self->m_exitFlag.load()) return;
+                        // Results of a prefetch of this page, or of one that finished since the
+                        // check above, come from the cache
+                        if (auto cached = self->m_searchCache.find(keyword, page, PlatformType::Bilibili, maxResults)) {
+                            QMetaObject::invokeMethod(self.get(), [self, keyword, generation, results = std::move(*cached)]() {
+                                if (self->isSearchCurrent(generation) && !results.isEmpty()) {
+                                    emit self->searchProgress(keyword, results);
+                                }
+                            }, Qt::QueuedConnection);
+                            return;
+                        }
+                        // Emit every batch as it arrives so the first results show up without
+                        // waiting for the slowest page lookup
+                        self->performBilibiliSearch(keyword, page, maxResults, cancel,
+                            [self, keyword, generation](const QList<SearchResult>& batch) {
+                                if (!self->isSearchCurrent(generation)) return;
+                                QMetaObject::invokeMethod(self.get(), [self, keyword, generation, batch]() {
+                                    if (self->isSearchCurrent(generation)) {
+                                        emit self->searchProgress(keyword, batch);
+                                    }
+                                }, Qt::QueuedConnection);
+                            });
+                    } catch (const std::exception& e) {
+                        if (self->isSearchCurrent(generation)) {
+                            QMetaObject::invokeMethod(self.get(), [self, keyword, e]() {
+                                emit self->searchFailed(keyword, QString("Bilibili search failed: %1").arg(e.what()));
+                            }, Qt::QueuedConnection);
+                        }
                     }
+                };
+                util::AsyncPromise<void> done;
+                auto start = [search, done]() {
+                    networkExecutor().submit(Priority::Normal, [search, done]() {
+                        search();
+                        done.setValue();
+                    });
+                };
+                // A prefetch already fetching this page is waited for by queueing the search
+                // behind it, not by holding a worker until it finishes
+                util::AsyncResult<void> prefetch = claimSearchPrefetch(
+                    SearchResultCache::makeKey(keyword, page, PlatformType::Bilibili));
+                if (prefetch.valid()) {
+                    prefetch.then([start](const util::AsyncResult<void>&) { start(); });
+                } else {
+                    start();
                 }
-            });
-            searchFutures.push_back(std::move(bilibiliFuture));
+                searches.push_back(done.result());
+            }
         }
         
         // Future: Add other platforms here
         // if (selectedInterface & SupportInterface::YouTube) { ... }
         // if (selectedInterface & SupportInterface::Local) { ... }
         
-        // Monitor all futures in a separate thread using condition variables
-        monitorSearchFuturesWithCV(keyword, std::move(searchFutures));
+        completeSearchWhenDone(keyword, generation, std::move(searches));
     }
     
+    void NetworkManager::prefetchSearchPage(const QString& keyword, uint selectedInterface, int page, int maxResults)
+    {
+        if (keyword.trimmed().isEmpty() || page < 1 || !(selectedInterface & PlatformType::Bilibili)) {
+            return;
+        }
+        if (!checkPlatformStatus(PlatformType::Bilibili)
+            || m_searchCache.find(keyword, page, PlatformType::Bilibili, maxResults)) {
+            return;
+        }
+        const std::string key = SearchResultCache::makeKey(keyword, page, PlatformType::Bilibili);
+        util::AsyncPromise<void> done;
+        {
+            std::lock_guard<std::mutex> lock(m_searchPrefetchMutex);
+            if (!m_searchPrefetches.emplace(key, SearchPrefetch{ done.result() }).second) {
+                return;     // Already prefetching
+            }
+        }
+        const uint64_t generation = m_searchGeneration.load();
+        std::shared_ptr<CancelToken> cancel = currentSearchToken();
+        // Low priority: it yields the executor to everything the user is waiting for
+        networkExecutor().submit(Priority::Low, [self = this->shared_from_this(), keyword, page, maxResults, key, done, generation, cancel]() {
+            bool claimed = false;
+            {
+                std::lock_guard<std::mutex> lock(self->m_searchPrefetchMutex);
+                auto it = self->m_searchPrefetches.find(key);
+                if (it != self->m_searchPrefetches.end()) {
+                    it->second.started = true;
+                    claimed = true;
+                }
+            }
+            // Withdrawn by a load that fetched the page itself, or the search moved on
+            if (claimed && self->isSearchCurrent(generation)) {
+                try {
+                    const auto results = self->performBilibiliSearch(keyword, page, maxResults, cancel);
+                    LOG_DEBUG("Prefetched page {} of search '{}': {} results", page, keyword.toStdString(), results.size());
+                } catch (const std::exception& e) {
+                    LOG_WARN("Prefetching page {} of search '{}' failed: {}", page, keyword.toStdString(), e.what());
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(self->m_searchPrefetchMutex);
+                self->m_searchPrefetches.erase(key);
+            }
+            done.setValue();
+        });
+    }
+
+    util::AsyncResult<void> NetworkManager::claimSearchPrefetch(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(m_searchPrefetchMutex);
+        auto it = m_searchPrefetches.find(key);
+        if (it == m_searchPrefetches.end()) {
+            return {};
+        }
+        if (!it->second.started) {
+            // Still queued behind Low work; fetching now beats waiting for it
+            m_searchPrefetches.erase(it);
+            return {};
+        }
+        return it->second.done;
+    }
+
     void NetworkManager::cancelAllSearches()
     {
         m_cancelFlag = true;
+        ++m_searchGeneration;
+        currentSearchToken()->cancel();
     }
 
-    std::future<uint64_t> NetworkManager::getStreamSizeByParamsAsync(PlatformType platform, const QString &params)
+    bool NetworkManager::isSearchCurrent(uint64_t generation) const
+    {
+        return !m_cancelFlag.load() && !m_exitFlag.load() && m_searchGeneration.load() == generation;
+    }
+
+    std::shared_ptr<CancelToken> NetworkManager::currentSearchToken() const
+    {
+        std::lock_guard<std::mutex> lock(m_searchTokenMutex);
+        return m_searchToken;
+    }
+
+    util::AsyncResult<uint64_t> NetworkManager::streamSizeByParams(PlatformType platform, const QString &params)
     {
         if (checkPlatformStatus(platform) == false) {
-            return std::async(std::launch::async, [platform, params]() -> uint64_t {
-                LOG_ERROR("Requested platform is not configured for stream size query, "
-                    "platform enum: {}, params: {}", 
-                    static_cast<int>(platform), 
-                    params.toStdString());
-                return 0;
-            });
+            LOG_ERROR("Requested platform is not configured for stream size query, "
+                "platform enum: {}, params: {}", 
+                static_cast<int>(platform), 
+                params.toStdString());
+            return util::AsyncResult<uint64_t>::fromValue(0);
         }
         switch (platform) {
-            case PlatformType::Bilibili:
-                return std::async(std::launch::async, [self = this->shared_from_this(), params]() -> uint64_t {
+            case PlatformType::Bilibili: {
+                util::AsyncPromise<uint64_t> promise;
+                networkExecutor().submit(Priority::High, [self = this->shared_from_this(), params, promise]() {
                     try {
-                        if (self->m_exitFlag.load()) return 0;
+                        if (self->m_exitFlag.load()) {
+                            promise.setValue(0);
+                            return;
+                        }
                         std::string url = self->m_biliInterface->getAudioUrlByParams(params.toStdString());
                         if (url.empty()) {
                             LOG_ERROR("Failed to get audio URL from parameters for stream size query");
-                            return 0;
+                            promise.setValue(0);
+                            return;
                         }
-                        return self->m_biliInterface->getStreamBytesSize(url);
+                        promise.setValue(self->m_biliInterface->getStreamBytesSize(url));
                     } catch (const std::exception& e) {
                         LOG_ERROR("Bilibili stream size (by params) error: {}", e.what());
-                        throw; // Re-throw to be handled by caller
+                        promise.setException(std::current_exception()); // To be handled by caller
                     }
                 });
+                return promise.result();
+            }
 
             default:
-                return std::async(std::launch::async, []() -> uint64_t {
-                    throw std::runtime_error("Unsupported platform for stream size query (by params)");
-                });
+                return util::AsyncResult<uint64_t>::fromException(std::make_exception_ptr(
+                    std::runtime_error("Unsupported platform for stream size query (by params)")));
+        }
+    }
+
+    std::future<uint64_t> NetworkManager::getStreamSizeByParamsAsync(PlatformType platform, const QString &params)
+    {
+        return streamSizeByParams(platform, params).toFuture();
+    }
+
+    void NetworkManager::prefetchStreamUrl(PlatformType platform, const QString& params)
+    {
+        if (platform != PlatformType::Bilibili || !checkPlatformStatus(platform) || m_exitFlag.load()) {
+            return;
+        }
+        // Fire and forget: executor futures don't block when dropped, and holding only the
+        // platform keeps the task from outliving or destroying the manager
+        networkExecutor().submit(Priority::Low, [platform = m_biliInterface, params]() {
+            try {
+                if (!platform->prefetchAudioUrl(params.toStdString())) {
+                    LOG_DEBUG("Stream URL prefetch failed for {}", params.toStdString());
+                }
+            } catch (const std::exception& e) {
+                LOG_WARN("Stream URL prefetch error: {}", e.what());
+            }
+        });
+    }
+
+    util::AsyncResult<std::vector<SearchResult>> NetworkManager::videoParts(const SearchResult& part)
+    {
+        if (part.platform != PlatformType::Bilibili || !checkPlatformStatus(part.platform)) {
+            LOG_ERROR("Requested platform is not configured for video parts, platform enum: {}",
+                static_cast<int>(part.platform));
+            return util::AsyncResult<std::vector<SearchResult>>::fromValue(std::vector<SearchResult>());
+        }
+        util::AsyncPromise<std::vector<SearchResult>> promise;
+        networkExecutor().submit(Priority::High, [self = this->shared_from_this(), part, promise]() {
+            try {
+                if (self->m_exitFlag.load()) {
+                    promise.setValue(std::vector<SearchResult>());
+                    return;
+                }
+                promise.setValue(self->m_biliInterface->videoParts(part, VIDEO_PARTS_PREWARM));
+            } catch (const std::exception& e) {
+                LOG_ERROR("Bilibili video parts error: {}", e.what());
+                promise.setException(std::current_exception());
+            }
+        });
+        return promise.result();
+    }
+
+    void NetworkManager::setCoverCache(std::shared_ptr<util::CoverCache> cache)
+    {
+        std::lock_guard<std::mutex> lock(m_coverCacheMutex);
+        m_coverCache = std::move(cache);
+    }
+
+    void NetworkManager::setAudioCacheStore(std::shared_ptr<util::AudioCacheStore> store)
+    {
+        std::lock_guard<std::mutex> lock(m_audioCacheMutex);
+        m_audioCacheStore = std::move(store);
+    }
+
+    std::shared_future<std::optional<std::string>> NetworkManager::fetchCoverAsync(const QString& url)
+    {
+        bool haveCache = false;
+        {
+            std::lock_guard<std::mutex> lock(m_coverCacheMutex);
+            haveCache = m_coverCache != nullptr;
+        }
+        if (!haveCache || url.isEmpty() || !checkPlatformStatus(PlatformType::Bilibili)) {
+            std::promise<std::optional<std::string>> failed;
+            failed.set_value(std::nullopt);
+            return failed.get_future().share();
+        }
+        return m_coverFetcher->request(
+            CoverFetcher::thumbnailUrl(url.toStdString(), COVER_THUMB_WIDTH, COVER_THUMB_HEIGHT));
+    }
+
+    QString NetworkManager::coverCachePath(const QString& url) const
+    {
+        std::lock_guard<std::mutex> lock(m_coverCacheMutex);
+        if (!m_coverCache || url.isEmpty()) {
+            return QString();
         }
+        // Thumbnails are requested as JPEG, which CoverCache stores under this name
+        return m_coverCache->getCoverCachePath(QString::fromStdString(
+            CoverFetcher::thumbnailUrl(url.toStdString(), COVER_THUMB_WIDTH, COVER_THUMB_HEIGHT)));
     }
 
-    std::shared_future<void> NetworkManager::downloadAsync(PlatformType platform, const QString &url, const QString &filepath)
+    std::shared_future<void> NetworkManager::downloadAsync(PlatformType platform, const QString &url, const QString &filepath,
+                                                           TransferClass transferClass)
+    {
+        return download(platform, url, filepath, transferClass).toSharedFuture();
+    }
+
+    util::AsyncResult<void> NetworkManager::download(PlatformType platform, const QString &url, const QString &filepath,
+                                                     TransferClass transferClass)
     {
         if (checkPlatformStatus(platform) == false) {
-            return std::async(std::launch::async, [platform, url, filepath]() -> void {
-                LOG_ERROR("Requested platform is not configured for download, "
-                    "platform enum: {}, url: {}, filepath: {}", 
-                    static_cast<int>(platform), 
-                    url.toStdString(), 
-                    filepath.toStdString());
-                throw std::runtime_error("Platform not configured for download");
-            }).share();
+            LOG_ERROR("Requested platform is not configured for download, "
+                "platform enum: {}, url: {}, filepath: {}", 
+                static_cast<int>(platform), 
+                url.toStdString(), 
+                filepath.toStdString());
+            return util::AsyncResult<void>::fromException(std::make_exception_ptr(
+                std::runtime_error("Platform not configured for download")));
         }
         
         // Create a unique key for this download (combination of URL and filepath)
         QString downloadKey = QString("%1::%2").arg(url).arg(filepath);
         
-        // Check if this download is already in progress
+        // Check if this download is already in progress, and register it if not
+        util::AsyncPromise<void> promise;
         {
             std::lock_guard<std::mutex> lock(m_downloadMapMutex);
             auto it = m_activeDownloads.find(downloadKey);
             if (it != m_activeDownloads.end()) {
-                LOG_INFO("Download already in progress for: {}, returning existing future", filepath.toStdString());
-                return it->second.future;
+                LOG_INFO("Download already in progress for: {}, returning existing result", filepath.toStdString());
+                return it->second;
+            }
+            if (platform == PlatformType::Bilibili) {
+                m_activeDownloads.emplace(downloadKey, promise.result());
             }
-        }
-        
-        // Create a new download entry
-        auto promisePtr = std::make_shared<std::promise<void>>();
-        std::shared_future<void> sharedFuture = promisePtr->get_future().share();
-        
-        {
-            std::lock_guard<std::mutex> lock(m_downloadMapMutex);
-            m_activeDownloads[downloadKey] = ActiveDownload{ promisePtr, sharedFuture };
         }
         
         switch (platform) {
             case PlatformType::Bilibili:
-                return std::async(std::launch::async, [self = this->shared_from_this(), url, filepath, downloadKey, promisePtr]() -> void {
-                    if (self->m_exitFlag.load()) {
-                        promisePtr->set_exception(std::make_exception_ptr(std::runtime_error("NetworkManager is exiting")));
+                // Low priority: the task waits for the whole transfer, so only the workers
+                // not reserved for searches and stream opening can be tied up by downloads
+                networkExecutor().submit(Priority::Low, [self = this->shared_from_this(), url, filepath, downloadKey, promise, transferClass]() {
+                    auto exiting = [&self]() { return self->m_exitFlag.load(); };
+                    TransferScheduler::Slot slot = self->m_transfers.acquire(transferClass, exiting);
+                    if (!slot) {
+                        {
+                            std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
+                            self->m_activeDownloads.erase(downloadKey);
+                        }
+                        promise.setException(std::make_exception_ptr(std::runtime_error("NetworkManager is exiting")));
                         return;
                     }
                     try {
-                        // Write to temporary .part file first
+                        // Write to temporary .part file first, once a prefetch of it has let go
+                        self->m_prefetcher->release(filepath.toStdString());
                         const QString tempPath = filepath + ".part";
                         // Ensure target directory exists
                         QFileInfo fi(filepath);
                         QDir().mkpath(fi.absolutePath());
-                        std::ofstream file(tempPath.toStdString(), std::ios::binary);
+
+                        // A .part left by an interrupted attempt at the same stream (matching size
+                        // and ETag) is kept and only the rest is requested with a Range header
+                        const StreamInfo stream = self->m_biliInterface->getStreamInfo(url.toStdString());
+                        const uint64_t total_size = stream.size;
+                        const uint64_t resume_from = preparePartFile(tempPath.toStdString(), stream, false);
+                        std::ofstream file(tempPath.toStdString(),
+                                           std::ios::binary | (resume_from > 0 ? std::ios::app : std::ios::trunc));
                         if (!file.is_open()) {
                             throw std::runtime_error("Failed to open file for writing: " + tempPath.toStdString());
                         }
+                        if (resume_from > 0) {
+                            LOG_INFO("Resuming download of {} at {} of {} bytes", filepath.toStdString(), resume_from, total_size);
+                        }
                         
-                        // Use asyncDownloadStream with a callback that writes to file
-                        auto download_future = self->m_biliInterface->asyncDownloadStream(url.toStdString(), 
-                            [&file](const char* data, size_t size) -> bool {
-                                if (data && size > 0) {
-                                    file.write(data, size);
-                                    if (file.fail()) {
-                                        LOG_ERROR("Failed to write data to file");
-                                        return false; // Stop download on write error
+                        // Download (in parallel segments when the size is known) straight into the file
+                        bool write_failed = false;
+                        bool success = true;
+                        if (resume_from < total_size || total_size == 0) {
+                            auto download_future = self->startDownload(url.toStdString(), total_size,
+                                [&self, &file, &write_failed, &exiting, transferClass](const char* data, size_t size) -> bool {
+                                    // Give way to playback and searches between chunks
+                                    if (!self->m_transfers.yield(transferClass, exiting)) {
+                                        return false;
                                     }
-                                }
-                                return true; // Continue download
-                            }
-                        );
-                        
-                        // Wait for download to complete
-                        bool success = download_future.get();
+                                    if (data && size > 0) {
+                                        file.write(data, size);
+                                        if (file.fail()) {
+                                            LOG_ERROR("Failed to write data to file");
+                                            write_failed = true;
+                                            return false; // Stop download on write error
+                                        }
+                                    }
+                                    return true; // Continue download
+                                },
+                                resume_from
+                            );
+                            
+                            // Wait for download to complete
+                            success = download_future.get();
+                        }
                         file.close();
                         
                         if (!success) {
-                            // Remove partial file on failure
-                            QFile::remove(tempPath);
+                            // Keep what arrived for the next attempt, unless the file itself is bad
+                            // or the size is unknown (nothing to validate a resume against)
+                            if (write_failed || file.fail() || total_size == 0) {
+                                removePartFile(tempPath.toStdString());
+                            } else {
+                                LOG_INFO("Download of {} interrupted, keeping {} for resume",
+                                         filepath.toStdString(), tempPath.toStdString());
+                            }
                             
                                         // Clean up from active downloads map
                                         {
                                             std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
                                             self->m_activeDownloads.erase(downloadKey);
                                         }
-                                        promisePtr->set_exception(std::make_exception_ptr(std::runtime_error("Download failed")));
+                                        promise.setException(std::make_exception_ptr(std::runtime_error("Download failed")));
                                         QMetaObject::invokeMethod(self.get(), [self, url, filepath]() {
                                             emit self->downloadFailed(url, filepath, "Download failed");
                                         }, Qt::QueuedConnection);
@@ -300,7 +670,7 @@ namespace network
                                     std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
                                     self->m_activeDownloads.erase(downloadKey);
                                 }
-                                promisePtr->set_exception(std::make_exception_ptr(std::runtime_error("Failed to finalize download file move")));
+                                promise.setException(std::make_exception_ptr(std::runtime_error("Failed to finalize download file move")));
                                 QMetaObject::invokeMethod(self.get(), [self, url, filepath]() {
                                     emit self->downloadFailed(url, filepath, "Failed to finalize download file move");
                                 }, Qt::QueuedConnection);
@@ -308,6 +678,8 @@ namespace network
                             }
                         }
                         
+                        removePartFile(tempPath.toStdString());   // Only the .meta is left by now
+                        self->commitAudioCache(filepath);
                         LOG_INFO("Download completed successfully: {}", filepath.toStdString());
                         
                         // Clean up from active downloads map
@@ -315,7 +687,7 @@ namespace network
                             std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
                             self->m_activeDownloads.erase(downloadKey);
                         }
-                        promisePtr->set_value();
+                        promise.setValue();
                         QMetaObject::invokeMethod(self.get(), [self, url, filepath]() {
                             emit self->downloadCompleted(url, filepath);
                         }, Qt::QueuedConnection);
@@ -328,222 +700,279 @@ namespace network
                             std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
                             self->m_activeDownloads.erase(downloadKey);
                         }
-                        promisePtr->set_exception(std::current_exception());
+                        promise.setException(std::current_exception()); // To be handled by caller
                         QMetaObject::invokeMethod(self.get(), [self, url, filepath, e]() {
                             emit self->downloadFailed(url, filepath, e.what());
                         }, Qt::QueuedConnection);
-                        throw; // Re-throw to be handled by caller
                     }
-                }).share();
+                });
+                return promise.result();
                 
             default:
-                // Clean up and return error future
-                {
-                    std::lock_guard<std::mutex> lock(m_downloadMapMutex);
-                    m_activeDownloads.erase(downloadKey);
-                }
-                return std::async(std::launch::async, [promisePtr]() -> void {
-                    promisePtr->set_exception(std::make_exception_ptr(std::runtime_error("Unsupported platform for download")));
-                }).share();
+                return util::AsyncResult<void>::fromException(std::make_exception_ptr(
+                    std::runtime_error("Unsupported platform for download")));
         }
     }
 
     std::shared_future<std::shared_ptr<std::istream>> NetworkManager::getAudioStreamAsync(PlatformType platform, const QString& params, const QString& savepath)
     {
+        return openAudioStream(platform, params, savepath).toSharedFuture();
+    }
+
+    util::AsyncResult<std::shared_ptr<std::istream>> NetworkManager::openAudioStream(PlatformType platform, const QString& params, const QString& savepath)
+    {
+        using StreamResult = util::AsyncResult<std::shared_ptr<std::istream>>;
         if (checkPlatformStatus(platform) == false) {
-            return std::async(std::launch::async, [platform, params, savepath]() -> std::shared_ptr<std::istream> {
-                LOG_ERROR("Requested platform is not configured for streaming, "
-                    "platform enum: {}, params: {}, savepath: {}", 
-                    static_cast<int>(platform), 
-                    params.toStdString(),
-                    savepath.toStdString());
-                throw std::runtime_error("Platform not configured for streaming");
-            }).share();
+            LOG_ERROR("Requested platform is not configured for streaming, "
+                "platform enum: {}, params: {}, savepath: {}", 
+                static_cast<int>(platform), 
+                params.toStdString(),
+                savepath.toStdString());
+            return StreamResult::fromException(std::make_exception_ptr(
+                std::runtime_error("Platform not configured for streaming")));
+        }
+        if (platform != PlatformType::Bilibili) {
+            return StreamResult::fromException(std::make_exception_ptr(
+                std::runtime_error("Unsupported platform for streaming")));
         }
         
         // Create a unique key for this stream (combination of params and savepath)
         QString streamKey = QString("%1::%2").arg(params).arg(savepath);
         
-        // Check if this stream is already being fetched
+        // Check if this stream is already being fetched, and register it if not
+        util::AsyncPromise<std::shared_ptr<std::istream>> promise;
         {
             std::lock_guard<std::mutex> lock(m_downloadMapMutex);
             auto it = m_activeStreams.find(streamKey);
             if (it != m_activeStreams.end()) {
-                LOG_INFO("Audio stream already in progress for params: {}, savepath: {}, returning existing future", 
+                LOG_INFO("Audio stream already in progress for params: {}, savepath: {}, returning existing result", 
                          params.toStdString(), savepath.toStdString());
-                return it->second.future;
+                return it->second;
             }
+            m_activeStreams.emplace(streamKey, promise.result());
         }
         
-        // Create a new stream entry
-        auto promisePtr = std::make_shared<std::promise<std::shared_ptr<std::istream>>>();
-        std::shared_future<std::shared_ptr<std::istream>> sharedFuture = promisePtr->get_future().share();
-        
-        {
-            std::lock_guard<std::mutex> lock(m_downloadMapMutex);
-            m_activeStreams[streamKey] = ActiveStream{ promisePtr, sharedFuture };
-        }
-        
-        switch (platform) {
-            case PlatformType::Bilibili:
-                return std::async(std::launch::async, [self = this->shared_from_this(), params, savepath, streamKey, promisePtr]() -> std::shared_ptr<std::istream> {
-                    if (self->m_exitFlag.load()) {
-                        promisePtr->set_exception(std::make_exception_ptr(std::runtime_error("NetworkManager is exiting")));
-                        throw std::runtime_error("NetworkManager is exiting");
+        // Only sets the stream up; the transfer and its watcher run on their own threads
+        networkExecutor().submit(Priority::High, [self = this->shared_from_this(), params, savepath, streamKey, promise]() {
+            if (self->m_exitFlag.load()) {
+                promise.setException(std::make_exception_ptr(std::runtime_error("NetworkManager is exiting")));
+                return;
+            }
+            try {
+                // Held until the transfer ends; lower classes pause meanwhile
+                auto playback_slot = std::make_shared<TransferScheduler::Slot>(
+                    self->m_transfers.acquire(TransferClass::Playback));
+                // A background prefetch of this track gives up its .part file first
+                if (!savepath.isEmpty()) {
+                    self->m_prefetcher->release(savepath.toStdString());
+                }
+                // Get actual URL from params
+                std::string url = self->m_biliInterface->getAudioUrlByParams(params.toStdString());
+                if (url.empty()) {
+                    // Clean up from active streams map
+                    {
+                        std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
+                        self->m_activeStreams.erase(streamKey);
                     }
-                    try {
-                        // Create streaming buffer (5MB buffer for smooth streaming)
-                        const size_t buffer_size = 5 * 1024 * 1024;
-                        // Create streaming input that wraps the buffer
-                        auto pipe = std::make_shared<RealtimePipe>(buffer_size);
-                        std::shared_ptr<std::ofstream> file_stream;
-                        QString temp_savepath;
-                        if (!savepath.isEmpty()) {
-                            temp_savepath = savepath + ".part";
-                            // Ensure parent directory exists
-                            QFileInfo fi(savepath);
-                            QDir().mkpath(fi.absolutePath());
-                            file_stream = std::make_shared<std::ofstream>(temp_savepath.toStdString(), std::ios::binary);
-                            if (!file_stream->is_open()) {
-                                // Clean up from active streams map
-                                {
-                                    std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
-                                    self->m_activeStreams.erase(streamKey);
-                                }
-                                promisePtr->set_exception(std::make_exception_ptr(
-                                    std::runtime_error("Failed to open file for writing: " + temp_savepath.toStdString())));
-                                throw std::runtime_error("Failed to open file for writing: " + temp_savepath.toStdString());
-                            }
-                        }
-                        // Get actual URL from params
-                        std::string url = self->m_biliInterface->getAudioUrlByParams(params.toStdString());
-                        if (url.empty()) {
-                            // Clean up from active streams map
-                            {
-                                std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
-                                self->m_activeStreams.erase(streamKey);
-                            }
-                            promisePtr->set_exception(std::make_exception_ptr(
-                                std::runtime_error("Failed to get audio URL from parameters")));
-                            throw std::runtime_error("Failed to get audio URL from parameters");
+                    promise.setException(std::make_exception_ptr(
+                        std::runtime_error("Failed to get audio URL from parameters")));
+                    return;
+                }
+                const StreamInfo stream = self->m_biliInterface->getStreamInfo(url);
+                const uint64_t total_size = stream.size;
+                // Cached streams with a known size are seekable: ranges are fetched on
+                // demand into a sparse cache, so scrubbing never restarts from byte 0
+                // and a retry resumes from what an interrupted attempt left on disk
+                if (!savepath.isEmpty()) {
+                    if (total_size > 0) {
+                        auto is = self->startSeekableStream(url, stream, savepath, streamKey, playback_slot);
+                        if (is) {
+                            LOG_INFO("Seekable streaming started for URL: {} ({} bytes)", url, total_size);
+                            promise.setValue(is);
+                            return;
                         }
-                        // Start async download to the streaming buffer with a cancel token
-                        auto cancel_token = std::make_shared<std::atomic<bool>>(false);
+                        LOG_WARN("Falling back to sequential streaming for {}", savepath.toStdString());
+                    }
+                }
+
+                // Create streaming buffer (5MB buffer for smooth streaming)
+                const size_t buffer_size = 5 * 1024 * 1024;
+                // Playback only: a plain pipe. Saving too: a broadcast pipe whose second
+                // reader feeds the .part file from its own thread, so disk stalls don't
+                // reach the network thread until the file writer lags a full buffer behind
+                std::shared_ptr<RealtimePipe> pipe;
+                std::shared_ptr<BroadcastPipe> broadcast;
+                std::shared_ptr<BroadcastPipe::Reader> disk_reader;
+                std::shared_ptr<std::istream> is;
+                std::shared_ptr<std::ofstream> file_stream;
+                QString temp_savepath;
+                if (!savepath.isEmpty()) {
+                    temp_savepath = savepath + ".part";
+                    // Ensure parent directory exists
+                    QFileInfo fi(savepath);
+                    QDir().mkpath(fi.absolutePath());
+                    file_stream = std::make_shared<std::ofstream>(temp_savepath.toStdString(), std::ios::binary);
+                    if (!file_stream->is_open()) {
+                        // Clean up from active streams map
                         {
-                            std::lock_guard<std::mutex> lg(self->m_bgMutex);
-                            self->m_downloadCancelTokens.push_back({ cancel_token, pipe });
+                            std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
+                            self->m_activeStreams.erase(streamKey);
                         }
-                        auto os = pipe->getOutputStream();
-                        auto is = pipe->getInputStream();
-                        auto download_future = self->m_biliInterface->asyncDownloadStream(
-                            url,
-                            [os, file_stream, cancel_token](const char* data, size_t size) -> bool {
-                                // Check cancellation request
-                                if (cancel_token && cancel_token->load()) return false;
-                                if (data && size > 0) {
-                                    try {
-                                        os->write(data, size);
-                                        if (file_stream && file_stream->is_open())
-                                            file_stream->write(data, size);
-                                    } catch (...) {
-                                        return false; // stop on any exception
-                                    }
+                        promise.setException(std::make_exception_ptr(
+                            std::runtime_error("Failed to open file for writing: " + temp_savepath.toStdString())));
+                        return;
+                    }
+                    broadcast = std::make_shared<BroadcastPipe>(buffer_size);
+                    is = broadcast->getInputStream();
+                    disk_reader = broadcast->openReader();
+                } else {
+                    pipe = std::make_shared<RealtimePipe>(buffer_size);
+                    // Keep downloading at full speed while playback is paused or behind,
+                    // instead of stalling the CDN connection until it times out
+                    if (!pipe->enableSpill(QDir::tempPath().toStdString(), STREAM_SPILL_LIMIT)) {
+                        LOG_WARN("Can't create a stream spill file in {}, the download will wait for playback",
+                                 QDir::tempPath().toStdString());
+                    }
+                    is = pipe->getInputStream();
+                }
+                // Start async download to the streaming buffer with a cancel token
+                auto cancel_token = std::make_shared<std::atomic<bool>>(false);
+                {
+                    std::lock_guard<std::mutex> lg(self->m_bgMutex);
+                    self->m_downloadCancelTokens.push_back({ cancel_token, pipe, broadcast, nullptr });
+                }
+                auto download_future = self->startDownload(
+                    url, total_size,
+                    [pipe, broadcast, cancel_token](const char* data, size_t size) -> bool {
+                        // Check cancellation request
+                        if (cancel_token && cancel_token->load()) return false;
+                        if (data && size > 0) {
+                            try {
+                                if (broadcast) {
+                                    // Every reader is gone (player closed, file failed)
+                                    if (broadcast->write(data, size) < size) return false;
+                                } else {
+                                    // Straight into the pipe's ring, no ostream in between
+                                    pipe->write(data, size);
                                 }
-                                return true; // Continue download
+                            } catch (...) {
+                                return false; // stop on any exception
                             }
-                        );
+                        }
+                        return true; // Continue download
+                    }
+                );
 
-                        // Spawn a lightweight watcher to finalize file and mark buffer complete
-                        std::thread watcher_thread([self, os, file_stream, savepath, temp_savepath, streamKey, cancel_token, df = std::move(download_future)]() mutable {
-                            if (self->m_exitFlag.load()) {
-                                // attempt to stop gracefully
+                // Spawn a lightweight watcher to finalize file and mark buffer complete
+                std::thread watcher_thread([self, pipe, broadcast, disk_reader, file_stream, savepath, temp_savepath, streamKey, cancel_token, playback_slot, df = std::move(download_future)]() mutable {
+                    if (self->m_exitFlag.load()) {
+                        // attempt to stop gracefully
+                    }
+                    // Drain the file's reader while the download runs
+                    std::future<bool> disk_future;
+                    if (disk_reader) {
+                        disk_future = std::async(std::launch::async, [reader = std::move(disk_reader), file_stream]() mutable {
+                            std::vector<char> chunk(64 * 1024);
+                            size_t got = 0;
+                            bool good = true;
+                            while ((got = reader->read(chunk.data(), chunk.size())) > 0) {
+                                file_stream->write(chunk.data(), static_cast<std::streamsize>(got));
+                                if (!file_stream->good()) {
+                                    LOG_ERROR("Failed writing stream cache file, stopping the copy");
+                                    good = false;
+                                    break;
+                                }
                             }
-                            try {
-                                bool ok = df.get();
-                                os.reset(); // Always close output stream (even on error)
-                                if (ok) {
-                                    if (file_stream && file_stream->is_open()) {
-                                        file_stream->flush();
-                                        file_stream->close();
-                                    }
-                                } 
-                                if (!savepath.isEmpty()) {
-                                    if (ok) {
-                                        // Move .part to final
-                                        if (QFile::exists(savepath)) {
-                                            QFile::remove(savepath);
-                                        }
-                                        if (!QFile::rename(temp_savepath, savepath)) {
-                                            if (QFile::copy(temp_savepath, savepath)) {
-                                                QFile::remove(temp_savepath);
-                                            } else {
-                                                QFile::remove(temp_savepath);
-                                            }
-                                        }
+                            // Detach now so a failed copy no longer holds the writer back
+                            reader.reset();
+                            file_stream->flush();
+                            good = good && file_stream->good();
+                            file_stream->close();
+                            return good;
+                        });
+                    }
+                    auto closeOutput = [&]() {
+                        if (pipe) pipe->closeOutput();
+                        if (broadcast) broadcast->closeWriter();
+                    };
+                    try {
+                        bool ok = df.get();
+                        closeOutput(); // Always signal EOF (even on error)
+                        playback_slot->release();
+                        if (disk_future.valid()) {
+                            ok = disk_future.get() && ok && !broadcast->aborted();
+                        }
+                        if (!savepath.isEmpty()) {
+                            if (ok) {
+                                // Move .part to final
+                                if (QFile::exists(savepath)) {
+                                    QFile::remove(savepath);
+                                }
+                                if (!QFile::rename(temp_savepath, savepath)) {
+                                    if (QFile::copy(temp_savepath, savepath)) {
+                                        QFile::remove(temp_savepath);
                                     } else {
-                                        // Remove partial on failure
                                         QFile::remove(temp_savepath);
                                     }
                                 }
-                            } catch (const std::exception& ex) {
-                                LOG_ERROR("Streaming finalize error: {}", ex.what());
-                            }
-
-                            // Remove cancel token from active list (best-effort)
-                            std::lock_guard<std::mutex> lg(self->m_bgMutex);
-                            auto it = std::find_if(self->m_downloadCancelTokens.begin(), self->m_downloadCancelTokens.end(),
-                                [&cancel_token](const DownloadCancelEntry& e) { return e.token == cancel_token; });
-                            if (it != self->m_downloadCancelTokens.end()) {
-                                self->m_downloadCancelTokens.erase(it);
-                                LOG_INFO("Download canceled: {}", cancel_token->load());
-                            }
-                            
-                            // Remove from active streams map
-                            {
-                                std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
-                                self->m_activeStreams.erase(streamKey);
+                                removePartFile(temp_savepath.toStdString());
+                                self->commitAudioCache(savepath);
+                            } else {
+                                // Remove partial on failure
+                                removePartFile(temp_savepath.toStdString());
                             }
-                        });
-
-                        // Track watcher thread so we can join on shutdown
-                        {
-                            std::lock_guard<std::mutex> lg(self->m_bgMutex);
-                            self->m_bgThreads.emplace_back(std::move(watcher_thread));
                         }
-                        // Note: The download continues in background, the StreamingInputStream will
-                        // block on read() calls until data is available. A watcher thread ensures
-                        // buffer completion is signaled and optional file is finalized.
-                        
-                        LOG_INFO("Streaming started for URL: {}", url);
-                        
-                        // Set the promise with the input stream and return it
-                        promisePtr->set_value(is);
-                        return is;
-                        
-                    } catch (const std::exception& e) {
-                        LOG_ERROR("Bilibili streaming error: {}", e.what());
-                        
-                        // Clean up from active streams map
-                        {
-                            std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
-                            self->m_activeStreams.erase(streamKey);
+                    } catch (const std::exception& ex) {
+                        LOG_ERROR("Streaming finalize error: {}", ex.what());
+                        closeOutput();
+                        if (disk_future.valid()) {
+                            disk_future.wait();
+                            QFile::remove(temp_savepath);
                         }
-                        promisePtr->set_exception(std::current_exception());
-                        throw; // Re-throw to be handled by caller
                     }
-                }).share();
+
+                    // Remove cancel token from active list (best-effort)
+                    std::lock_guard<std::mutex> lg(self->m_bgMutex);
+                    auto it = std::find_if(self->m_downloadCancelTokens.begin(), self->m_downloadCancelTokens.end(),
+                        [&cancel_token](const DownloadCancelEntry& e) { return e.token == cancel_token; });
+                    if (it != self->m_downloadCancelTokens.end()) {
+                        self->m_downloadCancelTokens.erase(it);
+                        LOG_INFO("Download canceled: {}", cancel_token->load());
+                    }
+                    
+                    // Remove from active streams map
+                    {
+                        std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
+                        self->m_activeStreams.erase(streamKey);
+                    }
+                });
+
+                // Track watcher thread so we can join on shutdown
+                {
+                    std::lock_guard<std::mutex> lg(self->m_bgMutex);
+                    self->m_bgThreads.emplace_back(std::move(watcher_thread));
+                }
+                // Note: The download continues in background, the StreamingInputStream will
+                // block on read() calls until data is available. A watcher thread ensures
+                // buffer completion is signaled and optional file is finalized.
                 
-            default:
-                // Clean up and return error future
+                LOG_INFO("Streaming started for URL: {}", url);
+                
+                // Complete with the input stream
+                promise.setValue(is);
+                
+            } catch (const std::exception& e) {
+                LOG_ERROR("Bilibili streaming error: {}", e.what());
+                
+                // Clean up from active streams map
                 {
-                    std::lock_guard<std::mutex> lock(m_downloadMapMutex);
-                    m_activeStreams.erase(streamKey);
+                    std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
+                    self->m_activeStreams.erase(streamKey);
                 }
-                return std::async(std::launch::async, [promisePtr]() -> std::shared_ptr<std::istream> {
-                    promisePtr->set_exception(std::make_exception_ptr(std::runtime_error("Unsupported platform for streaming")));
-                    throw std::runtime_error("Unsupported platform for streaming");
-                }).share();
-        }
+                promise.setException(std::current_exception()); // To be handled by caller
+            }
+        });
+        return promise.result();
     }
 
     bool NetworkManager::cancelDownload(const std::shared_ptr<std::atomic<bool>>& token)
@@ -564,12 +993,259 @@ namespace network
             // wake blocked readers/writers
             buf->close();
         }
+        if (std::shared_ptr<BroadcastPipe> broadcast = it->broadcast) {
+            broadcast->close();
+        }
+        if (std::shared_ptr<SeekableRangeStream> rangeStream = it->rangeStream) {
+            rangeStream->close();
+        }
 
         // Erase the entry from the active list; caller may still hold token
         m_downloadCancelTokens.erase(it);
         return true;
     }
 
+    std::future<bool> NetworkManager::startDownload(const std::string& url, uint64_t totalSize,
+                                                    std::function<bool(const char*, size_t)> receiver,
+                                                    uint64_t offset)
+    {
+        const uint64_t remaining = totalSize > offset ? totalSize - offset : 0;
+        if (remaining < 2 * DOWNLOAD_SEGMENT_SIZE) {
+            return m_biliInterface->asyncDownloadStream(url, std::move(receiver), nullptr, offset);
+        }
+        std::shared_ptr<BilibiliPlatform> platform = m_biliInterface;
+        return std::async(std::launch::async, [platform, url, offset, remaining, receiver = std::move(receiver)]() -> bool {
+            SegmentedDownload::Options options;
+            options.connections = DOWNLOAD_CONNECTIONS;
+            options.segmentSize = DOWNLOAD_SEGMENT_SIZE;
+            // Segments are laid out over the remainder and shifted back to resource offsets
+            SegmentedDownload download(remaining,
+                [platform, url, offset](uint64_t segmentOffset, uint64_t length, SegmentedDownload::ContentReceiver segmentReceiver) {
+                    return platform->asyncDownloadStream(url, std::move(segmentReceiver), nullptr, offset + segmentOffset, length);
+                },
+                options);
+            LOG_DEBUG("Downloading {} bytes from offset {} in {} segments over {} connections", remaining, offset,
+                      download.segmentCount(), options.connections);
+            bool ok = download.run(receiver);
+            if (!ok) {
+                LOG_WARN("Segmented download stopped before completion: {}", url);
+            }
+            return ok;
+        });
+    }
+
+    std::shared_ptr<std::istream> NetworkManager::startSeekableStream(const std::string& url, const StreamInfo& stream,
+                                                                      const QString& savepath, const QString& streamKey,
+                                                                      std::shared_ptr<TransferScheduler::Slot> playbackSlot)
+    {
+        const uint64_t totalSize = stream.size;
+        QString temp_savepath = savepath + ".part";
+        QDir().mkpath(QFileInfo(savepath).absolutePath());
+        preparePartFile(temp_savepath.toStdString(), stream, true);
+
+        auto cache = std::make_shared<SparseSegmentCache>(totalSize);
+        if (!cache->open(temp_savepath.toStdString())) {
+            LOG_ERROR("Failed to open sparse stream cache: {}", temp_savepath.toStdString());
+            return nullptr;
+        }
+        if (cache->cachedBytes() > 0) {
+            LOG_INFO("Resuming cached stream {}: {} of {} bytes already on disk",
+                     temp_savepath.toStdString(), cache->cachedBytes(), totalSize);
+        }
+
+        auto rangeStream = std::make_shared<SeekableRangeStream>(cache,
+            [platform = m_biliInterface, url](uint64_t offset, SeekableRangeStream::ContentReceiver receiver) {
+                return platform->asyncDownloadStream(url, std::move(receiver), nullptr, offset);
+            });
+        auto cancel_token = std::make_shared<std::atomic<bool>>(false);
+        {
+            std::lock_guard<std::mutex> lg(m_bgMutex);
+            m_downloadCancelTokens.push_back({ cancel_token, nullptr, nullptr, rangeStream });
+        }
+        auto is = rangeStream->getInputStream();
+        rangeStream->start();
+
+        // Finalize the cache once every range has been fetched; an interrupted download keeps
+        // its .part/.idx pair so the next request for this song resumes instead of restarting
+        std::thread watcher_thread([self = this->shared_from_this(), rangeStream, cache, savepath, temp_savepath, streamKey, cancel_token, playbackSlot]() {
+            const bool complete = rangeStream->wait();
+            playbackSlot->release();
+            if (complete) {
+                if (cache->finalize(savepath.toStdString())) {
+                    removePartFile(temp_savepath.toStdString());
+                    self->commitAudioCache(savepath);
+                    LOG_INFO("Stream cached to {}", savepath.toStdString());
+                } else {
+                    LOG_ERROR("Failed to move stream cache {} to {}", temp_savepath.toStdString(), savepath.toStdString());
+                }
+            } else {
+                LOG_WARN("Stream download incomplete: {} of {} bytes kept in {}",
+                         cache->cachedBytes(), cache->totalSize(), temp_savepath.toStdString());
+            }
+
+            {
+                std::lock_guard<std::mutex> lg(self->m_bgMutex);
+                auto it = std::find_if(self->m_downloadCancelTokens.begin(), self->m_downloadCancelTokens.end(),
+                    [&cancel_token](const DownloadCancelEntry& e) { return e.token == cancel_token; });
+                if (it != self->m_downloadCancelTokens.end()) {
+                    self->m_downloadCancelTokens.erase(it);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(self->m_downloadMapMutex);
+                self->m_activeStreams.erase(streamKey);
+            }
+        });
+        {
+            std::lock_guard<std::mutex> lg(m_bgMutex);
+            m_bgThreads.emplace_back(std::move(watcher_thread));
+        }
+        return is;
+    }
+
+    void NetworkManager::warmUpConnections()
+    {
+        if (!checkPlatformStatus(PlatformType::Bilibili)) {
+            return;
+        }
+        networkExecutor().submit(Priority::Normal, [self = this->shared_from_this()]() {
+            if (self->m_exitFlag.load()) {
+                return;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const size_t connected = self->m_biliInterface->warmUpConnections();
+            LOG_INFO("Warmed up {} connections in {} ms", connected,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+        });
+    }
+
+    void NetworkManager::schedulePrefetch(const std::vector<PrefetchTrack>& tracks)
+    {
+        std::vector<PrefetchScheduler::Item> items;
+        const size_t limit = static_cast<size_t>(std::max(0, m_prefetchTracks.load()));
+        for (const auto& track : tracks) {
+            if (items.size() >= limit) {
+                break;
+            }
+            if (track.params.isEmpty() || track.savepath.isEmpty() || !checkPlatformStatus(track.platform)) {
+                continue;
+            }
+            items.push_back({ static_cast<int>(track.platform), track.params.toStdString(), track.savepath.toStdString() });
+        }
+        m_prefetcher->setPlan(std::move(items));
+    }
+
+    void NetworkManager::setPrefetchOptions(int tracks, int bandwidthKBps, int diskBudgetMB)
+    {
+        m_prefetchTracks.store(std::max(0, tracks));
+        m_prefetchLimiter.setRate(static_cast<uint64_t>(std::max(0, bandwidthKBps)) * 1024);
+        m_prefetcher->setDiskBudget(static_cast<uint64_t>(std::max(0, diskBudgetMB)) * 1024 * 1024);
+        if (tracks <= 0) {
+            m_prefetcher->setPlan({});
+        }
+        LOG_INFO("Prefetch: {} tracks, {} KB/s, {} MB disk", tracks, bandwidthKBps, diskBudgetMB);
+    }
+
+    bool NetworkManager::isNetworkIdle() const
+    {
+        return !m_transfers.isPreempted(TransferClass::Background);
+    }
+
+    PrefetchScheduler::Result NetworkManager::prefetchTrack(const PrefetchScheduler::Item& item, uint64_t budgetLeft,
+                                                            const PrefetchScheduler::StopCheck& stop)
+    {
+        using Outcome = PrefetchScheduler::Outcome;
+        const QString savepath = QString::fromStdString(item.savepath);
+        if (QFile::exists(savepath)) {
+            return { Outcome::Done, 0 };
+        }
+        if (m_exitFlag.load() || static_cast<PlatformType>(item.platform) != PlatformType::Bilibili
+            || !checkPlatformStatus(PlatformType::Bilibili)) {
+            return { Outcome::Failed, 0 };
+        }
+
+        try {
+            const std::string url = m_biliInterface->getAudioUrlByParams(item.params);
+            if (url.empty()) {
+                return { Outcome::Failed, 0 };
+            }
+            const StreamInfo stream = m_biliInterface->getStreamInfo(url);
+            const uint64_t total_size = stream.size;
+            if (total_size == 0) {
+                return { Outcome::Failed, 0 };
+            }
+            // Counts against the Background limit shared with downloads
+            TransferScheduler::Slot slot = m_transfers.acquire(TransferClass::Background, stop);
+            if (!slot || stop()) {
+                return { Outcome::Interrupted, 0 };
+            }
+
+            // Same .part/.idx pair a seekable stream uses, so a track started mid-prefetch
+            // (after release()) resumes from what is already on disk
+            const QString temp_savepath = savepath + ".part";
+            QDir().mkpath(QFileInfo(savepath).absolutePath());
+            preparePartFile(temp_savepath.toStdString(), stream, true);
+            auto cache = std::make_shared<SparseSegmentCache>(total_size);
+            if (!cache->open(temp_savepath.toStdString())) {
+                LOG_WARN("Prefetch can't open {}", temp_savepath.toStdString());
+                return { Outcome::Failed, 0 };
+            }
+            if (total_size - cache->cachedBytes() > budgetLeft) {
+                LOG_DEBUG("Prefetch of {} skipped: {} bytes over the disk budget", item.savepath,
+                          total_size - cache->cachedBytes() - budgetLeft);
+                return { Outcome::Skipped, 0 };
+            }
+
+            // Closed from inside the receiver, so a stop lands as soon as the next chunk does
+            auto self_ref = std::make_shared<std::weak_ptr<SeekableRangeStream>>();
+            auto interrupted = std::make_shared<std::atomic<bool>>(false);
+            auto rangeStream = std::make_shared<SeekableRangeStream>(cache,
+                [this, url, stop, self_ref, interrupted](uint64_t offset, SeekableRangeStream::ContentReceiver receiver) {
+                    return m_biliInterface->asyncDownloadStream(url,
+                        [this, stop, self_ref, interrupted, receiver = std::move(receiver)](const char* data, size_t size) -> bool {
+                            if (m_exitFlag.load() || stop() || !m_prefetchLimiter.acquire(size, stop)) {
+                                interrupted->store(true);
+                                if (auto stream = self_ref->lock()) {
+                                    stream->close();
+                                }
+                                return false;
+                            }
+                            return receiver(data, size);
+                        },
+                        nullptr, offset);
+                });
+            *self_ref = rangeStream;
+            LOG_DEBUG("Prefetching {} ({} of {} bytes cached)", item.savepath, cache->cachedBytes(), total_size);
+            rangeStream->start();
+            if (!rangeStream->wait()) {
+                return { interrupted->load() ? Outcome::Interrupted : Outcome::Failed, 0 };
+            }
+            if (!cache->finalize(item.savepath)) {
+                LOG_WARN("Failed to move prefetched {} into place", item.savepath);
+                return { Outcome::Failed, 0 };
+            }
+            removePartFile(temp_savepath.toStdString());
+            commitAudioCache(savepath);
+            LOG_INFO("Prefetched {} ({} bytes)", item.savepath, total_size);
+            return { Outcome::Done, total_size };
+        } catch (const std::exception& e) {
+            LOG_WARN("Prefetch of {} failed: {}", item.savepath, e.what());
+            return { Outcome::Failed, 0 };
+        }
+    }
+
+    void NetworkManager::commitAudioCache(const QString& filepath)
+    {
+        std::shared_ptr<util::AudioCacheStore> store;
+        {
+            std::lock_guard<std::mutex> lock(m_audioCacheMutex);
+            store = m_audioCacheStore;
+        }
+        if (store && store->manages(filepath.toStdString())) {
+            store->commit(filepath.toStdString());
+        }
+    }
+
     bool NetworkManager::checkPlatformStatus(PlatformType platform)
     {
         switch(platform)
@@ -581,47 +1257,64 @@ namespace network
         }
     }
 
-    std::future<QList<SearchResult>> NetworkManager::performBilibiliSearchAsync(
-        const QString &keyword, int maxResults, std::atomic<bool> &cancelFlag)
+    QList<SearchResult> NetworkManager::performBilibiliSearch(
+        const QString &keyword, int page, int maxResults, const std::shared_ptr<CancelToken> &cancel,
+        std::function<void(const QList<SearchResult>&)> onBatch)
     {
-        if (cancelFlag.load()) {
+        if (cancel->cancelled() || m_exitFlag.load()) {
             return {};
         }
         if (checkPlatformStatus(PlatformType::Bilibili) == false) {
-            return std::async(std::launch::async, [keyword]() -> QList<SearchResult> {
-                LOG_ERROR("Bilibili interface not configured for search, keyword: {}", keyword.toStdString());
-                throw std::runtime_error("Bilibili interface not configured for search");
-            });
+            LOG_ERROR("Bilibili interface not configured for search, keyword: {}", keyword.toStdString());
+            throw std::runtime_error("Bilibili interface not configured for search");
         }
 
-        auto fut = std::async(std::launch::async, [self = this->shared_from_this(), keyword, maxResults, &cancelFlag]() -> QList<SearchResult> {
-            try {
-                if (self->m_exitFlag.load()) return {};
-                if (!self->m_biliInterface) throw std::runtime_error("Invalid Bilibili interface");
-                // New searchByTitle returns a vector of network::SearchResult (platform-agnostic)
-                auto pages = self->m_biliInterface->searchByTitle(keyword.toStdString());
-
-                QList<SearchResult> result;
-                for (const auto& page : pages) {
-                    if (cancelFlag.load() || self->m_exitFlag.load()) {
-                        return {};
-                    }
+        // A search slot bounds concurrent searches (e.g. a cancelled one still finishing) and
+        // pauses covers and background transfers while it runs
+        TransferScheduler::Slot slot = m_transfers.acquire(TransferClass::Search, [&]() {
+            return cancel->cancelled() || m_exitFlag.load();
+        });
+        if (!slot) {
+            return {};
+        }
 
-                    // 'page' is already network::SearchResult (with QString fields), append directly
-                    result.append(page);
+        try {
+            // Streaming searchByTitle hands over network::SearchResult batches in rank order.
+            // Cancelling aborts its requests in flight, so a cancelled search ends with
+            // partial results at most and frees its connections right away
+            QList<SearchResult> result;
+            m_biliInterface->searchByTitle(keyword.toStdString(), page,
+                [&](std::vector<SearchResult>&& pages) -> bool {
+                    if (m_exitFlag.load()) {
+                        return false;
+                    }
 
-                    if (result.size() >= maxResults) {
-                        break; // Reached max results
+                    QList<SearchResult> batch;
+                    for (auto& page : pages) {
+                        if (result.size() + batch.size() >= maxResults) {
+                            break; // Reached max results
+                        }
+                        batch.append(std::move(page));
                     }
-                }
+                    result.append(batch);
+                    if (onBatch && !batch.isEmpty() && !cancel->cancelled()) {
+                        onBatch(batch);
+                    }
+                    return result.size() < maxResults;
+                }, cancel);
 
-                return result;
-            } catch (const std::exception& e) {
-                LOG_ERROR("Bilibili search error: {}", e.what());
-                throw; // Re-throw to be handled by caller
+            // Partial results of a cancelled search are not cached
+            if (m_exitFlag.load() || cancel->cancelled()) {
+                return {};
             }
-        });
-        return fut;
+            if (!result.isEmpty()) {
+                m_searchCache.insert(keyword, page, PlatformType::Bilibili, maxResults, result);
+            }
+            return result;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Bilibili search error: {}", e.what());
+            throw; // Re-throw to be handled by caller
+        }
     }
 
     // Helper method to convert seconds to hh:mm:ss format, hide hours if zero
@@ -637,19 +1330,18 @@ namespace network
         return fmt::format("{}:{:02}", minutes, seconds);
     }
 
-    std::future<void> NetworkManager::monitorSearchFuturesWithCV(const QString& keyword, std::vector<std::future<void>>&& futures)
+    void NetworkManager::completeSearchWhenDone(const QString& keyword, uint64_t generation, std::vector<util::AsyncResult<void>> searches)
     {
-        // Launch a monitoring thread that uses condition variables instead of polling
-        return std::async(std::launch::async, [self = this->shared_from_this(), keyword, futures = std::move(futures)]() mutable {
-
-            for (auto& future : futures) {
-                if (self->m_cancelFlag.load() || self->m_exitFlag.load()) {
+        // Runs on whichever thread finishes the last search (inline when none was started),
+        // so no worker is parked for the length of the search
+        util::whenAll(searches).then([self = this->shared_from_this(), keyword, generation, searches](const util::AsyncResult<void>&) {
+            for (const auto& search : searches) {
+                if (!self->isSearchCurrent(generation)) {
                     break;
                 }
 
                 try {
-                    // This blocks until the future completes (no CPU spinning!)
-                    future.get(); // This will re-throw any exception from the future
+                    search.get(); // Rethrows what the search didn't handle itself
 
                 } catch (const std::exception& e) {
                     // Exception handling: convert and emit error signal
@@ -665,12 +1357,15 @@ namespace network
                 }
             }
 
-            // All futures completed successfully
-            if (!self->m_cancelFlag.load() && !self->m_exitFlag.load()) {
+            // All searches completed
+            if (self->isSearchCurrent(generation)) {
                 QMetaObject::invokeMethod(self.get(), [self, keyword]() {
                     emit self->searchCompleted(keyword);
                 }, Qt::QueuedConnection);
             }
+            const auto stats = networkExecutor().stats();
+            LOG_DEBUG("Network executor after search: {} active, queued {}/{}/{} (high/normal/low), peak {}",
+                      stats.active, stats.queued[0], stats.queued[1], stats.queued[2], stats.peakQueued);
         });
     }
 }
\ No newline at end of file
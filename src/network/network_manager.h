@@ -10,8 +10,20 @@
 #include <thread>
 #include <unordered_map>
 #include <stream/realtime_pipe.hpp>
+#include <stream/broadcast_pipe.hpp>
+#include <stream/seekable_range_stream.hpp>
+#include <stream/segmented_download.hpp>
 #include "platform/i_platform.h"
 #include "platform/bili_network_interface.h"
+#include "search_result_cache.h"
+#include "prefetch_scheduler.h"
+#include "transfer_scheduler.h"
+#include "cancel_token.h"
+#include "cover_fetcher.h"
+#include <util/rate_limiter.h>
+#include <util/cover_cache.h>
+#include <util/audio_cache_store.h>
+#include <util/async_result.h>
 
 // Forward declarations for platform-specific types
 namespace network
@@ -34,16 +46,79 @@ namespace network
         void saveConfiguration();
         bool isConfigured() const { return m_configured; }
         
-        // Main search orchestrator method - coordinates multiple async searches
-        void executeMultiSourceSearch(const QString& keyword, uint selectedInterface, int maxResults = 20);
+        // Main search orchestrator method - coordinates multiple async searches.
+        // Page 1 starts a new search; a later page continues the current one, so its
+        // results arrive through the same signals and a cancel drops it as well
+        void executeMultiSourceSearch(const QString& keyword, uint selectedInterface, int maxResults = 20, int page = 1);
+        // Fetch a result page into the search cache without emitting anything, so loading
+        // it later returns at once. A load arriving mid-fetch waits for it. Fire and forget.
+        void prefetchSearchPage(const QString& keyword, uint selectedInterface, int page, int maxResults = 20);
         void cancelAllSearches();
+        // The operations below come in two forms. The AsyncResult ones complete through
+        // continuations, so callers chaining on them hold no thread while they wait; the
+        // future ones are the same operations for callers that block anyway.
         // Convenience: get size by interface params (e.g., bvid/cid) instead of direct URL
+        util::AsyncResult<uint64_t> streamSizeByParams(PlatformType platform, const QString& params);
         std::future<uint64_t> getStreamSizeByParamsAsync(PlatformType platform, const QString& params);
+        // Requests for a stream already being opened share its result
+        util::AsyncResult<std::shared_ptr<std::istream>> openAudioStream(PlatformType platform, const QString& params, const QString& savepath="");
         std::shared_future<std::shared_ptr<std::istream>> getAudioStreamAsync(PlatformType platform, const QString& params, const QString& savepath="");
-        std::shared_future<void> downloadAsync(PlatformType platform, const QString& url, const QString& filepath);
+        // Runs as a Cover or Background transfer: it waits for a free slot in its class and
+        // pauses while playback or a search is transferring. Requests for a download
+        // already in progress share its result
+        util::AsyncResult<void> download(PlatformType platform, const QString& url, const QString& filepath,
+                                         TransferClass transferClass = TransferClass::Background);
+        std::shared_future<void> downloadAsync(PlatformType platform, const QString& url, const QString& filepath,
+                                               TransferClass transferClass = TransferClass::Background);
+        // Resolve a queued track's stream URL in the background so starting it skips the API
+        // round-trip; a cached URL close to its deadline is refreshed. Fire and forget.
+        void prefetchStreamUrl(PlatformType platform, const QString& params);
+        // Every part of the multi-part video `part` comes from, in page order, from one page
+        // list lookup; the first VIDEO_PARTS_PREWARM parts' stream URLs are resolved in
+        // parallel before it completes. Completes with an empty list on failure.
+        static constexpr size_t VIDEO_PARTS_PREWARM = 4;
+        util::AsyncResult<std::vector<SearchResult>> videoParts(const SearchResult& part);
+        // Where fetchCoverAsync() stores covers; without one nothing is fetched
+        void setCoverCache(std::shared_ptr<util::CoverCache> cache);
+        // Fetch the thumbnail-sized variant of a cover into the cover cache as a Cover
+        // transfer. Requests for a cover already on its way share one download (every part
+        // of a video repeats its cover). Resolves to the cached file, nullopt on failure
+        std::shared_future<std::optional<std::string>> fetchCoverAsync(const QString& url);
+        // The cache file fetchCoverAsync(url) stores the cover in, empty without a cache
+        QString coverCachePath(const QString& url) const;
+        // Finished audio downloads are committed to this store, which may evict older ones
+        void setAudioCacheStore(std::shared_ptr<util::AudioCacheStore> store);
+
+        // A track expected to play soon, to be downloaded into savepath ahead of time
+        struct PrefetchTrack {
+            PlatformType platform;
+            QString params;
+            QString savepath;
+        };
+        // Replace the tracks fetched in the background, nearest first. They are downloaded
+        // one at a time as Background transfers and stop (to resume later) when preempted
+        void schedulePrefetch(const std::vector<PrefetchTrack>& tracks);
+        // tracks: how many upcoming tracks to keep cached (0 disables prefetching);
+        // bandwidth shared by prefetches, 0 = unlimited; disk held by prefetched tracks
+        // that haven't played yet, 0 = unlimited
+        void setPrefetchOptions(int tracks, int bandwidthKBps, int diskBudgetMB);
+        int prefetchTrackCount() const { return m_prefetchTracks.load(); }
+        // Concurrent transfers allowed per class, 0 = unlimited
+        void setTransferLimit(TransferClass transferClass, size_t maxActive) { m_transfers.setLimit(transferClass, maxActive); }
         
         void setRequestTimeout(int timeoutMs) { m_requestTimeout = timeoutMs; }
+        // How long resolved page lists are reused, 0 disables the cache
+        void setPageCacheTtl(int hours);
+        // Audio stream picked for tracks started from now on
+        void setAudioQuality(AudioQuality quality);
+        // Pre-connect to the API and recently used CDN hosts in the background, so the
+        // first search or track skips DNS, TCP and TLS setup. Fire and forget.
+        void warmUpConnections();
         int getRequestTimeout() const { return m_requestTimeout; }
+        // Per-endpoint request timing of every platform so far, see RequestMetrics
+        std::vector<RequestMetrics::EndpointStats> requestMetrics() const;
+        // One log line per endpoint: request count, failures, p50/p95 of the phases
+        void logRequestMetrics() const;
         
     signals:
         void searchCompleted(const QString& keyword);
@@ -56,44 +131,97 @@ namespace network
         NetworkManager(const NetworkManager&) = delete;
         NetworkManager& operator=(const NetworkManager&) = delete;
         
-        // Async search methods for different platforms
-        std::future<QList<SearchResult>> performBilibiliSearchAsync(
-            const QString& keyword, int maxResults, std::atomic<bool>& cancelFlag);
+        // Blocking search methods for different platforms, run on the network executor.
+        // onBatch, if set, is called with each batch as it resolves (in rank order, capped at
+        // maxResults). Returns an empty list once cancel is cancelled, which also aborts the
+        // requests still in flight
+        QList<SearchResult> performBilibiliSearch(
+            const QString& keyword, int page, int maxResults, const std::shared_ptr<CancelToken>& cancel,
+            std::function<void(const QList<SearchResult>&)> onBatch = nullptr);
+        // The prefetch of this page if it is already running (invalid otherwise). One that
+        // hasn't started yet is withdrawn instead, the caller fetches the page itself
+        util::AsyncResult<void> claimSearchPrefetch(const std::string& key);
         
         // Helper methods
-        std::future<void> monitorSearchFuturesWithCV(const QString& keyword, std::vector<std::future<void>>&& futures);
+        // Emits searchCompleted (or searchFailed) once every platform search has finished,
+        // from a continuation of the last one rather than a thread waiting on them
+        void completeSearchWhenDone(const QString& keyword, uint64_t generation, std::vector<util::AsyncResult<void>> searches);
+        // False once cancelAllSearches() or a newer search superseded this one
+        bool isSearchCurrent(uint64_t generation) const;
+        // Token shared by every request of the current search, its later pages included
+        std::shared_ptr<CancelToken> currentSearchToken() const;
         std::string Seconds2HMS(int totalSeconds);
         bool cancelDownload(const std::shared_ptr<std::atomic<bool>>& token);
+        // Whole-resource download from offset on: parallel Range segments delivered in order
+        // when the size is known, a single request otherwise
+        std::future<bool> startDownload(const std::string& url, uint64_t totalSize,
+                                        std::function<bool(const char*, size_t)> receiver,
+                                        uint64_t offset = 0);
+        // Open (or resume) the sparse cache at savepath + ".part" and return a seekable stream
+        // over it; the cache is moved to savepath once complete. A .part left by a different
+        // version of the stream is discarded. Returns nullptr on failure.
+        // playbackSlot is held until the stream's download ends
+        std::shared_ptr<std::istream> startSeekableStream(const std::string& url, const StreamInfo& stream,
+                                                          const QString& savepath, const QString& streamKey,
+                                                          std::shared_ptr<TransferScheduler::Slot> playbackSlot);
         bool checkPlatformStatus(PlatformType platform);
+        // PrefetchScheduler job: fetch one track into its sparse cache and finalize it
+        PrefetchScheduler::Result prefetchTrack(const PrefetchScheduler::Item& item, uint64_t budgetLeft,
+                                                const PrefetchScheduler::StopCheck& stop);
+        // Index a finished download in the audio cache store; files outside it are ignored
+        void commitAudioCache(const QString& filepath);
+        // Nothing of a higher class than prefetching is transferring
+        bool isNetworkIdle() const;
     
     private:    
         std::shared_ptr<BilibiliPlatform> m_biliInterface;
         std::atomic<bool> m_cancelFlag;
+        // Bumped by every search and cancel, so late batches of an older search are dropped
+        std::atomic<uint64_t> m_searchGeneration{0};
+        // Cancelled by cancelAllSearches() and replaced by every new search
+        mutable std::mutex m_searchTokenMutex;
+        std::shared_ptr<CancelToken> m_searchToken = std::make_shared<CancelToken>();
+        // Finished searches, so repeating one within a few minutes needs no network round-trip
+        SearchResultCache m_searchCache;
+        // Page prefetches by SearchResultCache key; started is set once the fetch runs
+        struct SearchPrefetch {
+            util::AsyncResult<void> done;
+            bool started = false;
+        };
+        std::mutex m_searchPrefetchMutex;
+        std::unordered_map<std::string, SearchPrefetch> m_searchPrefetches;
         std::atomic<bool> m_exitFlag{false};
         int m_requestTimeout = 10000; // 10 seconds
         bool m_configured = false;
-        // Background thread management for streaming/watchers
+        // Stream watcher threads; they live as long as a transfer, so they stay off the executor
         mutable std::mutex m_bgMutex;
         std::vector<std::thread> m_bgThreads;
         struct DownloadCancelEntry {
             std::shared_ptr<std::atomic<bool>> token;
             std::shared_ptr<RealtimePipe> buffer;
+            std::shared_ptr<BroadcastPipe> broadcast;   // Sequential stream that is also saved
+            std::shared_ptr<SeekableRangeStream> rangeStream;
         };
         std::vector<DownloadCancelEntry> m_downloadCancelTokens;
         
-        // Prevent duplicated downloads
-        struct ActiveDownload {
-            std::shared_ptr<std::promise<void>> promise;
-            std::shared_future<void> future;
-        };
-        std::unordered_map<QString, ActiveDownload> m_activeDownloads;
-        
-        struct ActiveStream {
-            std::shared_ptr<std::promise<std::shared_ptr<std::istream>>> promise;
-            std::shared_future<std::shared_ptr<std::istream>> future;
-        };
-        std::unordered_map<QString, ActiveStream> m_activeStreams;
+        // Prevent duplicated downloads and streams: later requests share the first one's result
+        std::unordered_map<QString, util::AsyncResult<void>> m_activeDownloads;
+        std::unordered_map<QString, util::AsyncResult<std::shared_ptr<std::istream>>> m_activeStreams;
         mutable std::mutex m_downloadMapMutex;
+
+        // Concurrency limits and preemption across playback, search, covers and the rest
+        TransferScheduler m_transfers;
+        // Background download of upcoming tracks, paced by m_prefetchLimiter
+        std::atomic<int> m_prefetchTracks{2};
+        util::RateLimiter m_prefetchLimiter;
+        std::unique_ptr<PrefetchScheduler> m_prefetcher;
+        // Cover downloads, deduplicated and batched by m_coverFetcher
+        mutable std::mutex m_coverCacheMutex;
+        std::shared_ptr<util::CoverCache> m_coverCache;
+        std::unique_ptr<CoverFetcher> m_coverFetcher;
+        // Finished audio files, see commitAudioCache()
+        mutable std::mutex m_audioCacheMutex;
+        std::shared_ptr<util::AudioCacheStore> m_audioCacheStore;
         
         // Cancel a specific download by token: sets the token and notifies/destroys the
         // associated buffer so any blocked readers/writers wake. Returns true if an
@@ -0,0 +1,85 @@
+#include "part_file.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <json/json.h>
+
+namespace network
+{
+    namespace {
+        std::string metaPath(const std::string& partPath) {
+            return partPath + ".meta";
+        }
+
+        bool sameValidator(const std::string& a, const std::string& b) {
+            return a.empty() || b.empty() || a == b;
+        }
+
+        bool loadMeta(const std::string& partPath, StreamInfo& stream, bool& sparse) {
+            std::ifstream file(metaPath(partPath), std::ios::binary);
+            if (!file.is_open()) return false;
+            Json::Value root;
+            Json::CharReaderBuilder builder;
+            std::string errors;
+            if (!Json::parseFromStream(builder, file, &root, &errors) || !root.isObject()) {
+                return false;
+            }
+            stream.size = root.get("size", 0).asUInt64();
+            stream.etag = root.get("etag", "").asString();
+            stream.lastModified = root.get("last_modified", "").asString();
+            sparse = root.get("sparse", false).asBool();
+            return true;
+        }
+
+        bool saveMeta(const std::string& partPath, const StreamInfo& stream, bool sparse) {
+            Json::Value root;
+            root["size"] = Json::UInt64(stream.size);
+            root["etag"] = stream.etag;
+            root["last_modified"] = stream.lastModified;
+            root["sparse"] = sparse;
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "";
+            std::ofstream file(metaPath(partPath), std::ios::binary | std::ios::trunc);
+            file << Json::writeString(builder, root);
+            return static_cast<bool>(file);
+        }
+    }
+
+    bool sameStream(const StreamInfo& a, const StreamInfo& b)
+    {
+        return a.size == b.size
+            && sameValidator(a.etag, b.etag)
+            && sameValidator(a.lastModified, b.lastModified);
+    }
+
+    uint64_t preparePartFile(const std::string& partPath, const StreamInfo& stream, bool sparse)
+    {
+        std::error_code ec;
+        uint64_t length = std::filesystem::exists(partPath, ec) ? std::filesystem::file_size(partPath, ec) : 0;
+        if (ec) {
+            length = 0;
+        }
+
+        StreamInfo stored;
+        bool stored_sparse = false;
+        const bool reusable = stream.size > 0 && length > 0 && length <= stream.size
+            && loadMeta(partPath, stored, stored_sparse)
+            && stored_sparse == sparse && sameStream(stored, stream);
+        if (!reusable) {
+            removePartFile(partPath);
+            length = 0;
+        }
+        if (stream.size > 0) {
+            saveMeta(partPath, stream, sparse);
+        }
+        return length;
+    }
+
+    void removePartFile(const std::string& partPath)
+    {
+        std::error_code ec;
+        std::filesystem::remove(partPath, ec);
+        std::filesystem::remove(partPath + ".idx", ec);
+        std::filesystem::remove(metaPath(partPath), ec);
+    }
+} // namespace network
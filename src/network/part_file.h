@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "platform/i_platform.h"
+
+namespace network
+{
+    /**
+     * @brief Bookkeeping that lets an interrupted download resume from its ".part" file.
+     *
+     * Next to the part file a "<part>.meta" records the size, ETag and Last-Modified of the
+     * stream it came from and its layout: a plain prefix written front to back, or a
+     * SparseSegmentCache file with its own ".idx". Data is only reused when the stream
+     * being downloaded now matches on all of them, so bytes of an updated or different
+     * file are never spliced together.
+     */
+
+    // Same size, and same ETag and Last-Modified wherever both sides have one
+    bool sameStream(const StreamInfo& a, const StreamInfo& b);
+
+    /**
+     * @brief Get partPath ready for downloading `stream`.
+     * Existing data is kept when its .meta matches the stream and layout; otherwise the
+     * .part, .idx and .meta are deleted. The new .meta is written either way, unless the
+     * size is unknown, which can't be validated and always starts over.
+     * @return Length of the reusable .part, 0 when starting from scratch
+     */
+    uint64_t preparePartFile(const std::string& partPath, const StreamInfo& stream, bool sparse);
+
+    // Delete the .part and everything kept alongside it
+    void removePartFile(const std::string& partPath);
+} // namespace network
@@ -4,13 +4,17 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
-#include <regex>
 #include <filesystem>
+#include <cctype>
 #include <openssl/md5.h>
 #include <json/json.h>
 #include <log/log_manager.h>
 #include <util/md5.h>
 #include <util/urlencode.h>
+#include <util/json_scanner.h>
+#include <util/trace.h>
+#include <network/network_executor.h>
+#include <network/http_compression.h>
 
 // Mixin key encoding table from Python script
 static const std::vector<int> mixinKeyEncTab = {
@@ -22,6 +26,153 @@ static const std::vector<int> mixinKeyEncTab = {
 
 using namespace network;
 
+namespace {
+    // A cached playurl is handed out only if it stays valid this long, so the stream
+    // (including later Range requests for seeking) starts well before the CDN rejects it
+    constexpr std::chrono::seconds PLAYURL_EXPIRY_MARGIN = std::chrono::minutes(10);
+    // prefetchAudioUrl() re-resolves URLs closer than this to their deadline
+    constexpr std::chrono::seconds PLAYURL_REFRESH_AHEAD = std::chrono::minutes(30);
+    // Assumed lifetime when the URL carries no deadline parameter
+    constexpr std::chrono::seconds PLAYURL_DEFAULT_LIFETIME = std::chrono::minutes(30);
+
+    // warmUpConnections() opens this many connections to the API (search page lookups run
+    // in parallel) and one to each of the last WARM_HOST_COUNT stream hosts
+    const std::string API_HOST = "https://api.bilibili.com";
+    constexpr size_t API_WARM_CONNECTIONS = 2;
+    constexpr size_t WARM_HOST_COUNT = 3;
+    // Header sets kept for (host, cookie paths) combinations before starting over
+    constexpr size_t HEADER_SET_LIMIT = 64;
+
+    // WBI keys rotate about daily. The refresher replaces them after WBI_REFRESH_AFTER,
+    // well before they stop being accepted, and signers keep using the old set meanwhile
+    constexpr std::chrono::hours WBI_REFRESH_AFTER{20};
+    // Backoff between failed fetches
+    constexpr std::chrono::seconds WBI_RETRY_MIN{30};
+    constexpr std::chrono::seconds WBI_RETRY_MAX = std::chrono::minutes(30);
+    // Longest the refresher sleeps at once, so a changed wall clock is noticed
+    constexpr std::chrono::seconds WBI_MAX_SLEEP = std::chrono::hours(1);
+    // How long a signer with no keys at all waits for the first fetch
+    constexpr std::chrono::seconds WBI_COLD_WAIT{10};
+
+    // bvid and cid from interface params ("bvid=...&cid=..."), false if either is missing
+    bool parsePlayParams(const std::string& params, std::string& bvid, int64_t& cid) {
+        auto bvid_pos = params.find("bvid=");
+        if (bvid_pos != std::string::npos) {
+            size_t bvid_end = params.find('&', bvid_pos);
+            bvid = params.substr(bvid_pos + 5, bvid_end - (bvid_pos + 5));
+        }
+        auto cid_pos = params.find("cid=");
+        if (cid_pos != std::string::npos) {
+            size_t cid_end = params.size();
+            cid = std::stoll(params.substr(cid_pos + 4, cid_end - (cid_pos + 4)));
+        }
+        return !bvid.empty() && cid != 0;
+    }
+
+    // One playable result per page of a video, titled "<video> - <part>"
+    SearchResult partResult(const BilibiliVideoInfo& video, const BilibiliPageInfo& page) {
+        return SearchResult{
+            .title = QString("%1 - %2").arg(QString::fromStdString(video.title)).arg(QString::fromStdString(page.part)),
+            .uploader = QString::fromStdString(video.author),
+            .platform = PlatformType::Bilibili,
+            .duration = page.duration * 1000,  // convert to milliseconds
+            .coverUrl = QString::fromStdString(video.coverImg),
+            // .coverImg = "", // to be filled by caller
+            .description = QString::fromStdString(video.description),
+            .interfaceData = QString("bvid=%1&cid=%2")
+                .arg(QString::fromStdString(video.bvid))
+                .arg(QString::number(page.cid))
+        };
+    }
+
+    // Search titles highlight the keyword with <em class="keyword"> tags
+    void stripHtmlTags(std::string& text) {
+        size_t out = 0;
+        bool inTag = false;
+        for (char c : text) {
+            if (c == '<') inTag = true;
+            else if (c == '>' && inTag) inTag = false;
+            else if (!inTag) text[out++] = c;
+        }
+        text.resize(out);
+    }
+
+    // One element of data.result in a search response; only the fields we show
+    bool readSearchItem(util::JsonScanner& json, BilibiliVideoInfo& info) {
+        if (!json.enterObject()) {
+            json.skipValue();
+            return false;
+        }
+        std::string_view key;
+        while (json.nextKey(key)) {
+            const bool taken = (key == "title" && json.readString(info.title))
+                || (key == "bvid" && json.readString(info.bvid))
+                || (key == "author" && json.readString(info.author))
+                || (key == "description" && json.readString(info.description))
+                || (key == "pic" && json.readString(info.coverImg));
+            if (!taken) json.skipValue();
+        }
+        stripHtmlTags(info.title);
+        info.coverImg.insert(0, "https:");
+        return json.ok() && !info.bvid.empty();
+    }
+
+    // One element of data in a /x/player/pagelist response
+    bool readPageItem(util::JsonScanner& json, BilibiliPageInfo& info) {
+        if (!json.enterObject()) {
+            json.skipValue();
+            return false;
+        }
+        std::string_view key;
+        while (json.nextKey(key)) {
+            const bool taken = (key == "cid" && json.readInt(info.cid))
+                || (key == "page" && json.readInt(info.page))
+                || (key == "part" && json.readString(info.part))
+                || (key == "duration" && json.readInt(info.duration))
+                || (key == "first_frame" && json.readString(info.firstFrame));
+            if (!taken) json.skipValue();
+        }
+        return json.ok();
+    }
+
+    std::string playUrlKey(const std::string& bvid, int64_t cid) {
+        return "bvid=" + bvid + "&cid=" + std::to_string(cid);
+    }
+
+    // Expiry of a Bilibili CDN URL from its deadline=<unix seconds> query parameter
+    std::chrono::system_clock::time_point playUrlExpiry(const std::string& url,
+                                                        std::chrono::system_clock::time_point now) {
+        auto pos = url.find("deadline=");
+        if (pos != std::string::npos) {
+            // Reject "xdeadline=" and friends: the key must start a query parameter
+            if (pos > 0 && (url[pos - 1] == '?' || url[pos - 1] == '&')) {
+                pos += 9;
+                size_t end = pos;
+                while (end < url.size() && std::isdigit(static_cast<unsigned char>(url[end]))) ++end;
+                if (end > pos) {
+                    try {
+                        return std::chrono::system_clock::from_time_t(
+                            static_cast<std::time_t>(std::stoll(url.substr(pos, end - pos))));
+                    } catch (...) {
+                        // Fall back to the default lifetime
+                    }
+                }
+            }
+        }
+        return now + PLAYURL_DEFAULT_LIFETIME;
+    }
+
+    // The streams of one response share a deadline, but take the earliest to be safe
+    std::chrono::system_clock::time_point playUrlExpiry(const std::vector<AudioStreamOption>& streams,
+                                                        std::chrono::system_clock::time_point now) {
+        auto expires = std::chrono::system_clock::time_point::max();
+        for (const auto& stream : streams) {
+            expires = std::min(expires, playUrlExpiry(stream.url, now));
+        }
+        return expires;
+    }
+}
+
 BilibiliPlatform::BilibiliPlatform() 
     : timeout_seconds_(10)
     , follow_location_(true)
@@ -29,39 +180,42 @@ BilibiliPlatform::BilibiliPlatform()
 }
 
 BilibiliPlatform::~BilibiliPlatform() {
-    exitFlag_.store(true);
-    // Clean up HTTP clients
-    for (auto &pair : http_clients) {
-        for (auto &entry : pair.second) {
-            if (entry.client) {
-                try {
-                    entry.client->stop();
-                } catch (...) {
-                    // ignore
-                }
-            }
-        }
+    {
+        std::scoped_lock lock(m_wbiMutex_);
+        exitFlag_.store(true);
+    }
+    wbi_cv_.notify_all();
+    const ApiTraffic traffic = apiTraffic();
+    if (traffic.responses > 0 && traffic.decodedBytes > 0) {
+        LOG_INFO("Bilibili API: {} responses, {} bytes received for {} bytes of content ({:.1f}% saved)",
+                 traffic.responses, traffic.wireBytes, traffic.decodedBytes,
+                 100.0 * (1.0 - static_cast<double>(traffic.wireBytes) / static_cast<double>(traffic.decodedBytes)));
+    }
+    // Clean up HTTP clients; this also aborts a key fetch in flight
+    client_pool_.shutdown();
+    if (wbi_refresher_.joinable()) {
+        wbi_refresher_.join();
     }
 }
 
 bool network::BilibiliPlatform::initializeDefaultConfig()
 {
-    std::scoped_lock lock(m_clientMutex_, m_wbiMutex_);
-    // Phase 1 set heeaders
-    httplib::Headers headers = getDefaultHeaders();
-    for(auto header : headers) {
-        headers_[header.first] = header.second;
+    {
+        std::scoped_lock lock(m_clientMutex_);
+        // Phase 1 set heeaders
+        httplib::Headers headers = getDefaultHeaders();
+        for(auto header : headers) {
+            headers_[header.first] = header.second;
+        }
+        updateClientCookies_unsafe();
     }
     // Phase 2 initialize cookies
-    if (!initializeCookies_unsafe()) {
+    if (!initializeCookies()) {
         LOG_ERROR("Failed to initialize default cookies.");
         return false;
     }
-    // Phase 3 initialize WBI keys
-    if (!refreshWbiKeys_unsafe()) {
-        LOG_ERROR("Failed to initialize default WBI keys.");
-        return false;
-    }
+    // Phase 3 WBI keys are fetched in the background
+    startWbiRefresher();
     return true;
 }
 
@@ -95,16 +249,30 @@ bool BilibiliPlatform::loadConfig(const std::string& config_file) {
                     LOG_ERROR("Failed to load cookies from config.");
                 }
             }
+            updateClientCookies_unsafe();
             // Load img_key, sub_key, last_update if present
             if (root.isMember("wbi_keys")) {
                 const auto& wbiObj = root["wbi_keys"];
+                std::scoped_lock wbiLock(m_wbiMutex_);
                 if (!loadWbiKeys_unsafe(wbiObj)) {
                     LOG_ERROR("Failed to load WBI keys from config.");
                 }
             }
-            if (needsWbiRefresh_unsafe()) {
-                refreshWbiKeys_unsafe();
+            if (root.isMember("compression")) {
+                compression_enabled_.store(root["compression"].asBool());
             }
+            if (root.isMember("warm_hosts")) {
+                std::scoped_lock hostsLock(m_warmHostsMutex_);
+                warm_hosts_.clear();
+                for (const auto& host : root["warm_hosts"]) {
+                    if (host.isString() && warm_hosts_.size() < WARM_HOST_COUNT) {
+                        warm_hosts_.push_back(host.asString());
+                    }
+                }
+            }
+            // Stale or missing keys are refreshed in the background; signing serves the
+            // loaded ones until then
+            startWbiRefresher();
             return true;
         } else {
             LOG_ERROR("Failed to parse config file: {}", config);
@@ -131,8 +299,24 @@ bool BilibiliPlatform::saveConfig(const std::string& config_file) {
         LOG_ERROR("Failed to save cookies to config.");
     }
     // Save Wbi keys
-    if (!saveWbiKeys_unsafe(root["wbi_keys"])) {
-        LOG_ERROR("Failed to save WBI keys to config.");
+    {
+        std::scoped_lock wbiLock(m_wbiMutex_);
+        if (!saveWbiKeys_unsafe(root["wbi_keys"])) {
+            LOG_ERROR("Failed to save WBI keys to config.");
+        }
+    }
+    root["compression"] = compression_enabled_.load();
+    {
+        std::scoped_lock hostsLock(m_warmHostsMutex_);
+        Json::Value& hosts = root["warm_hosts"];
+        hosts = Json::Value(Json::arrayValue);
+        for (const auto& host : warm_hosts_) {
+            hosts.append(host);
+        }
+    }
+    // Page lists live in their own file, it can grow much larger than the config
+    if (!page_cache_.save()) {
+        LOG_WARN("Failed to save page cache.");
     }
     Json::StreamWriterBuilder builder;
     builder["indentation"] = "  ";
@@ -147,6 +331,7 @@ bool BilibiliPlatform::setPlatformDirectory(const std::string &platform_dir)
     std::scoped_lock lock(m_clientMutex_);
     if (std::filesystem::exists(platform_dir) && std::filesystem::is_directory(platform_dir)) {
         this->platform_dir_ = platform_dir;
+        page_cache_.setDirectory(platform_dir);
         return true;
     }
     return false;
@@ -155,20 +340,71 @@ bool BilibiliPlatform::setPlatformDirectory(const std::string &platform_dir)
 void BilibiliPlatform::setTimeout(int timeout_sec) {
     std::scoped_lock lock(m_clientMutex_);
     timeout_seconds_ = timeout_sec;
+    client_pool_.setTimeout(timeout_sec);
 }
 
-void BilibiliPlatform::setUserAgent(const std::string& user_agent) {
-    std::scoped_lock lock(m_clientMutex_);
-    headers_["User-Agent"] = user_agent;
+void BilibiliPlatform::setPageCacheTtl(std::chrono::seconds ttl) {
+    page_cache_.setTtl(ttl);
+}
+
+void BilibiliPlatform::setCompressionEnabled(bool enabled) {
+    compression_enabled_.store(enabled);
 }
 
-std::vector<BilibiliPageInfo> BilibiliPlatform::getPagesCid(const std::string& bvid) {
+void BilibiliPlatform::setAudioQuality(AudioQuality quality) {
+    audio_quality_.store(quality);
+}
+
+uint64_t BilibiliPlatform::measuredThroughput() const {
+    return throughput_.bytesPerSecond();
+}
+
+size_t BilibiliPlatform::warmUpConnections() {
+    std::vector<std::pair<std::string, size_t>> targets{ { API_HOST, API_WARM_CONNECTIONS } };
+    {
+        std::scoped_lock lock(m_warmHostsMutex_);
+        for (const auto& host : warm_hosts_) {
+            targets.emplace_back(host, 1);
+        }
+    }
+
+    std::vector<std::future<size_t>> pending;
+    for (const auto& [host, connections] : targets) {
+        pending.push_back(std::async(std::launch::async, [this, host = host, connections = connections]() {
+            const httplib::Headers headers = requestHeaders(host, "/");
+            // Any response at all means DNS, TCP and TLS are done and the socket is kept
+            return client_pool_.warmUp(host, connections, [&headers](httplib::Client& client) {
+                return static_cast<bool>(client.Head("/", headers));
+            });
+        }));
+    }
+    size_t connected = 0;
+    for (auto& future : pending) {
+        connected += future.get();
+    }
+    return connected;
+}
+
+BilibiliPlatform::ApiTraffic BilibiliPlatform::apiTraffic() const {
+    ApiTraffic traffic;
+    traffic.responses = api_responses_.load();
+    traffic.wireBytes = api_wire_bytes_.load();
+    traffic.decodedBytes = api_decoded_bytes_.load();
+    return traffic;
+}
+
+std::vector<RequestMetrics::EndpointStats> BilibiliPlatform::requestMetrics() const {
+    return request_metrics_.snapshot();
+}
+
+void BilibiliPlatform::setUserAgent(const std::string& user_agent) {
     std::scoped_lock lock(m_clientMutex_);
-    return getPagesCid_unsafe(bvid);
+    headers_["User-Agent"] = user_agent;
+    updateClientCookies_unsafe();
 }
 
 /*********** Interface method *****************/
-std::vector<BilibiliVideoInfo> BilibiliPlatform::searchByTitleOld(const std::string& title, int page) {
+std::vector<BilibiliVideoInfo> BilibiliPlatform::searchByTitleOld(const std::string& title, int page, CancelToken* cancel) {
     std::unordered_map<std::string, std::string> params = {
         {"search_type", "video"},
         {"keyword", title},
@@ -176,80 +412,89 @@ std::vector<BilibiliVideoInfo> BilibiliPlatform::searchByTitleOld(const std::str
         {"page", std::to_string(page)}
     };
     
-    {
-        std::scoped_lock lock(m_wbiMutex_);
-        // Todo: add wbi updating check here
-        if (!encWbi_unsafe(params)) {
-            LOG_ERROR("Failed to encode WBI parameters for search.");
-            return {};
-        }
+    if (!encWbi(params)) {
+        LOG_ERROR("Failed to encode WBI parameters for search.");
+        return {};
     }
     std::string response;
-    {
-        std::scoped_lock lock(m_clientMutex_);
-
-        if (!sendGetRequest_unsafe("https://api.bilibili.com", "/x/web-interface/wbi/search/type", params, response)) {
+    if (!sendGetRequest("https://api.bilibili.com", "/x/web-interface/wbi/search/type", params, response, cancel)) {
+        if (!cancel || !cancel->cancelled()) {
             LOG_ERROR("Search request failed for title: {}", title);
-            return {};
         }
+        return {};
     }
     
+    // Pull data.result straight into the result structs instead of building a DOM
     std::vector<BilibiliVideoInfo> results;
-    Json::Value root;
-    Json::Reader reader;
-    
-    if (reader.parse(response, root) && root["data"]["result"].isArray()) {
-        for (const auto& item : root["data"]["result"]) {
-            BilibiliVideoInfo info;
-            info.title = item["title"].asString();
-            info.bvid = item["bvid"].asString();
-            info.author = item["author"].asString();
-            info.description = item["description"].asString();
-            info.coverImg = "https:" + item["pic"].asString();
-            // Clean up HTML tags from title
-            std::regex html_tag("<[^>]*>");
-            info.title = std::regex_replace(info.title, html_tag, "");
-            LOG_DEBUG("Found video: {} by {}", info.title, info.author);
-            results.push_back(info);
+    util::JsonScanner json(response);
+    std::string_view key;
+    if (json.enterObject()) {
+        while (json.nextKey(key)) {
+            if (key != "data" || !json.enterObject()) {
+                json.skipValue();
+                continue;
+            }
+            while (json.nextKey(key)) {
+                if (key != "result" || !json.enterArray()) {
+                    json.skipValue();
+                    continue;
+                }
+                while (json.nextElement()) {
+                    BilibiliVideoInfo info;
+                    if (readSearchItem(json, info)) {
+                        LOG_DEBUG("Found video: {} by {}", info.title, info.author);
+                        results.push_back(std::move(info));
+                    }
+                }
+            }
         }
     }
+    if (!json.ok()) {
+        LOG_ERROR("Malformed search response for title: {}", title);
+        return {};
+    }
     return results;
 }
 
 std::vector<SearchResult> BilibiliPlatform::searchByTitle(const std::string& title, int page) {
+    std::vector<SearchResult> allPages;
+    searchByTitle(title, page, [&allPages](std::vector<SearchResult>&& batch) {
+        allPages.insert(allPages.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        return true;
+    });
+    return allPages;
+}
+
+size_t BilibiliPlatform::searchByTitle(const std::string& title, int page, const SearchBatchCallback& onBatch) {
+    return searchByTitle(title, page, onBatch, nullptr);
+}
+
+size_t BilibiliPlatform::searchByTitle(const std::string& title, int page, const SearchBatchCallback& onBatch,
+                                       const std::shared_ptr<CancelToken>& cancel) {
+    TRACE_SCOPE("network", "BilibiliPlatform::searchByTitle");
     // Step 1: Search for videos by title (blocking)
-    std::vector<BilibiliVideoInfo> videoResults = searchByTitleOld(title, page);
-    if (exitFlag_.load()) return {};
+    std::vector<BilibiliVideoInfo> videoResults = searchByTitleOld(title, page, cancel.get());
+    if (exitFlag_.load() || (cancel && cancel->cancelled())) return 0;
 
     if (videoResults.empty()) {
         LOG_WARN("No video results found for title: {}", title);
-        return {};
+        return 0;
     }
-    // Step 2: For each video, get page info asynchronously
+    // Step 2: For each video, get page info asynchronously on the shared network executor
+    util::ThreadPool& executor = networkExecutor();
     std::vector<std::future<std::vector<SearchResult>>> pageFutures;
     
     for (const auto& video : videoResults) {
-        // Launch async task to get pages for this bvid
-        auto future = std::async(std::launch::async, 
-            [self = this->shared_from_this(), video]() -> std::vector<SearchResult> {
+        // Queue a task to get pages for this bvid
+        auto future = executor.submit(util::ThreadPool::Priority::Normal,
+            [self = this->shared_from_this(), video, cancel]() -> std::vector<SearchResult> {
             try {
-                if (self->exitFlag_.load()) return {};
-                std::scoped_lock lock(self->m_clientMutex_);
-                auto pages = self->getPagesCid_unsafe(video.bvid);
+                if (self->exitFlag_.load() || (cancel && cancel->cancelled())) return {};
+                // No shared lock here: each lookup runs on its own pooled client
+                auto pages = self->getPagesCid(video.bvid, cancel.get());
                 std::vector<SearchResult> results;
                 for (auto& page : pages) {
-                    results.emplace_back(SearchResult{
-                        .title = QString("%1 - %2").arg(QString::fromStdString(video.title)).arg(QString::fromStdString(page.part)),
-                        .uploader = QString::fromStdString(video.author),
-                        .platform = PlatformType::Bilibili,
-                        .duration = page.duration * 1000,  // convert to milliseconds
-                        .coverUrl = QString::fromStdString(video.coverImg),
-                        // .coverImg = "", // to be filled by caller
-                        .description = QString::fromStdString(video.description),
-                        .interfaceData = QString("bvid=%1&cid=%2")
-                            .arg(QString::fromStdString(video.bvid))
-                            .arg(QString::number(page.cid))
-                    });
+                    results.push_back(partResult(video, page));
                 }
                 return std::move(results);
             } catch (const std::exception& e) {
@@ -261,130 +506,304 @@ std::vector<SearchResult> BilibiliPlatform::searchByTitle(const std::string& tit
         pageFutures.push_back(std::move(future));
     }
     
-    // Step 3: Collect all results and enrich page info with video metadata
-    std::vector<SearchResult> allPages;
-    
+    // Step 3: Hand each video's pages over as soon as it and every higher-ranked video
+    // resolved, so results stream in rank order instead of waiting for the slowest lookup
+    size_t delivered = 0;
     for (auto& future : pageFutures) {
+        std::vector<SearchResult> pages;
         try {
-            auto pages = future.get();
-            allPages.insert(allPages.end(), pages.begin(), pages.end());
+            // Runs queued lookups meanwhile when this search is itself an executor task
+            executor.wait(future);
+            pages = future.get();
         } catch (const std::exception& e) {
             LOG_ERROR("Error retrieving page info: {}", e.what());
         }
+        if (pages.empty()) continue;
+        delivered += pages.size();
+        if (!onBatch(std::move(pages))) {
+            // Remaining lookups still run and fill the page cache unless the search is
+            // cancelled; nothing waits for them
+            break;
+        }
     }
     
-    LOG_INFO("Found {} total pages from {} videos for search: {}", 
-            allPages.size(), videoResults.size(), title);
+    LOG_INFO("Delivered {} total pages from {} videos for search: {}", 
+            delivered, videoResults.size(), title);
     
-    return allPages;
+    return delivered;
+}
+
+std::vector<SearchResult> BilibiliPlatform::videoParts(const SearchResult& part, size_t prewarm, CancelToken* cancel)
+{
+    TRACE_SCOPE("network", "BilibiliPlatform::videoParts");
+    BilibiliVideoInfo video;
+    int64_t cid = 0;
+    if (!parsePlayParams(part.interfaceData.toStdString(), video.bvid, cid)) {
+        LOG_WARN("Not a Bilibili part: {}", part.interfaceData.toStdString());
+        return {};
+    }
+    // Usually a page cache hit, as the search that produced `part` just looked it up
+    const std::vector<BilibiliPageInfo> pages = getPagesCid(video.bvid, cancel);
+    if (pages.empty()) {
+        LOG_WARN("Failed to get pages for bvid {}", video.bvid);
+        return {};
+    }
+
+    // The video's own fields come from the part; its title carries " - <part>" at the end
+    QString title = part.title;
+    auto page = std::find_if(pages.begin(), pages.end(), [cid](const BilibiliPageInfo& p) { return p.cid == cid; });
+    if (page != pages.end()) {
+        const QString suffix = QString(" - %1").arg(QString::fromStdString(page->part));
+        if (title.endsWith(suffix)) {
+            title.chop(suffix.size());
+        }
+    }
+    video.title = title.toStdString();
+    video.author = part.uploader.toStdString();
+    video.description = part.description.toStdString();
+    video.coverImg = part.coverUrl.toStdString();
+
+    std::vector<SearchResult> results;
+    results.reserve(pages.size());
+    for (const auto& p : pages) {
+        results.push_back(partResult(video, p));
+    }
+
+    // Resolve the first few playurls at once, each on its own pooled client; the rest are
+    // resolved when they come up (or by the queue prefetch), as URLs expire within hours
+    util::ThreadPool& executor = networkExecutor();
+    std::vector<std::future<bool>> prefetches;
+    for (size_t i = 0; i < std::min(prewarm, results.size()); ++i) {
+        prefetches.push_back(executor.submit(util::ThreadPool::Priority::Normal,
+            [self = this->shared_from_this(), params = results[i].interfaceData.toStdString(), cancel]() {
+            if (self->exitFlag_.load() || (cancel && cancel->cancelled())) return false;
+            try {
+                return self->prefetchAudioUrl(params);
+            } catch (const std::exception& e) {
+                LOG_WARN("Playurl prefetch failed for {}: {}", params, e.what());
+                return false;
+            }
+        }));
+    }
+    size_t resolved = 0;
+    for (auto& future : prefetches) {
+        executor.wait(future);
+        resolved += future.get() ? 1 : 0;
+    }
+    LOG_INFO("Expanded bvid {} into {} parts, {} playurls resolved ahead", video.bvid, results.size(), resolved);
+    return results;
 }
 
 std::string network::BilibiliPlatform::getAudioUrlByParams(const std::string &params)
 {
+    return resolveAudioUrl(params, PLAYURL_EXPIRY_MARGIN);
+}
+
+bool BilibiliPlatform::prefetchAudioUrl(const std::string& params)
+{
+    return !resolveAudioUrl(params, PLAYURL_REFRESH_AHEAD).empty();
+}
+
+std::string BilibiliPlatform::resolveAudioUrl(const std::string& params, std::chrono::seconds minRemaining)
+{
+    TRACE_SCOPE("network", "BilibiliPlatform::resolveAudioUrl");
     // Phase 1: Extract bvid and cid from params
     std::string bvid;
     int64_t cid = 0;
-    auto bvid_pos = params.find("bvid=");
-    if (bvid_pos != std::string::npos) {
-        size_t bvid_end = params.find('&', bvid_pos);
-        bvid = params.substr(bvid_pos + 5, bvid_end - (bvid_pos + 5));
+    if (!parsePlayParams(params, bvid, cid)) {
+        return std::string();
     }
-    auto cid_pos = params.find("cid=");
-    if (cid_pos != std::string::npos) {
-        size_t cid_end = params.size();
-        cid = std::stoll(params.substr(cid_pos + 4, cid_end - (cid_pos + 4)));
+
+    // Phase 2: reuse cached streams, or wait for a request already resolving this track.
+    // The stream is picked once per cache entry: the size probe and the download of one
+    // track resolve separately and must get the same URL
+    const std::string key = playUrlKey(bvid, cid);
+    std::promise<std::vector<AudioStreamOption>> resolved;
+    {
+        std::unique_lock<std::mutex> lock(m_playUrlMutex_);
+        auto cached = play_urls_.find(key);
+        if (cached != play_urls_.end()
+            && std::chrono::system_clock::now() + minRemaining < cached->second.expires) {
+            return pinnedAudioStream_unsafe(cached->second);
+        }
+        auto pending = play_url_requests_.find(key);
+        if (pending != play_url_requests_.end()) {
+            std::shared_future<std::vector<AudioStreamOption>> shared = pending->second;
+            lock.unlock();
+            std::vector<AudioStreamOption> streams = shared.get();
+            lock.lock();
+            cached = play_urls_.find(key);
+            return cached != play_urls_.end() ? pinnedAudioStream_unsafe(cached->second) : pickAudioStream(streams);
+        }
+        play_url_requests_.emplace(key, resolved.get_future().share());
     }
-    if (bvid.empty() || cid == 0) {
-        return std::string();
+
+    // Phase 3: resolve and publish to the cache and to anyone who joined meanwhile
+    std::vector<AudioStreamOption> streams;
+    try {
+        streams = requestAudioStreams(bvid, cid);
+    } catch (...) {
+        {
+            std::scoped_lock lock(m_playUrlMutex_);
+            play_url_requests_.erase(key);
+        }
+        resolved.set_exception(std::current_exception());
+        throw;
     }
-    // Phase 2: construct request and decorate with WBI
+    std::string url;
+    {
+        std::scoped_lock lock(m_playUrlMutex_);
+        play_url_requests_.erase(key);
+        if (!streams.empty()) {
+            const auto now = std::chrono::system_clock::now();
+            for (auto it = play_urls_.begin(); it != play_urls_.end();) {
+                it = it->second.expires <= now ? play_urls_.erase(it) : std::next(it);
+            }
+            PlayUrlEntry& entry = play_urls_[key];
+            entry = PlayUrlEntry{ streams, playUrlExpiry(streams, now) };
+            url = pinnedAudioStream_unsafe(entry);
+        }
+    }
+    resolved.set_value(streams);
+    return url;
+}
+
+std::vector<AudioStreamOption> BilibiliPlatform::requestAudioStreams(const std::string& bvid, int64_t cid)
+{
+    // Construct request and decorate with WBI
     std::unordered_map<std::string, std::string> req_params = {
         {"bvid", bvid},
         {"cid",  std::to_string(cid)},
         {"fnval", "16"},
         {"qn", "64"}
     };
-    {
-        std::scoped_lock lock(m_wbiMutex_);
-        // Todo: add wbi updating check here
-        if (!encWbi_unsafe(req_params)) {
-            LOG_ERROR("Failed to encode WBI parameters for audio URL.");
-            return std::string();
-        }
+    if (!encWbi(req_params)) {
+        LOG_ERROR("Failed to encode WBI parameters for audio URL.");
+        return {};
     }
     std::string response;
-    {
-        std::scoped_lock lock(m_clientMutex_);
-        if (!sendGetRequest_unsafe("https://api.bilibili.com", "/x/player/wbi/playurl", req_params, response)) {
-            LOG_ERROR("Failed to get audio link for bvid: {}, cid: {}", bvid, cid);
-            return "";
-        }
+    if (!sendGetRequest("https://api.bilibili.com", "/x/player/wbi/playurl", req_params, response)) {
+        LOG_ERROR("Failed to get audio link for bvid: {}, cid: {}", bvid, cid);
+        return {};
     }
 
     Json::Value root;
     Json::Reader reader;
-
+    std::vector<AudioStreamOption> streams;
     if (reader.parse(response, root)) {
-        const auto& audio_list = root["data"]["dash"]["audio"];
-        if (audio_list.isArray() && !audio_list.empty()) {
-            // Find highest bandwidth audio
-            Json::Value best_audio;
-            int max_bandwidth = 0;
-            
-            for (const auto& audio : audio_list) {
-                int bandwidth = audio["bandwidth"].asInt();
-                if (bandwidth > max_bandwidth) {
-                    max_bandwidth = bandwidth;
-                    best_audio = audio;
-                }
+        // Every DASH quality, plus the lossless FLAC track when the video has one
+        const Json::Value& dash = root["data"]["dash"];
+        auto addStream = [&streams](const Json::Value& audio, bool lossless) {
+            if (!audio.isObject() || !audio["baseUrl"].isString()) {
+                return;
+            }
+            streams.push_back(AudioStreamOption{
+                audio["baseUrl"].asString(),
+                audio["bandwidth"].asUInt64(),
+                lossless
+            });
+        };
+        if (dash["audio"].isArray()) {
+            for (const auto& audio : dash["audio"]) {
+                addStream(audio, false);
             }
-            
-            return best_audio["baseUrl"].asString();
         }
+        addStream(dash["flac"]["audio"], true);
+    }
+    return streams;
+}
+
+std::string BilibiliPlatform::pickAudioStream(const std::vector<AudioStreamOption>& streams) const
+{
+    const AudioQuality quality = audio_quality_.load();
+    const uint64_t throughput = throughput_.bytesPerSecond();
+    const size_t index = selectAudioStream(streams, quality, throughput);
+    if (index >= streams.size()) {
+        return std::string();
+    }
+    LOG_DEBUG("Audio stream {} of {} ({} kbps{}) for {} at {} KB/s measured",
+              index + 1, streams.size(), streams[index].bandwidth / 1000,
+              streams[index].lossless ? ", lossless" : "", audioQualityToString(quality), throughput / 1024);
+    return streams[index].url;
+}
+
+std::string BilibiliPlatform::pinnedAudioStream_unsafe(PlayUrlEntry& entry) const
+{
+    if (entry.url.empty()) {
+        entry.url = pickAudioStream(entry.streams);
     }
-    return std::string();
+    return entry.url;
 }
 
 uint64_t BilibiliPlatform::getStreamBytesSize(const std::string &url)
 {
+    return getStreamInfo(url).size;
+}
+
+StreamInfo BilibiliPlatform::getStreamInfo(const std::string &url)
+{
+    TRACE_SCOPE("network", "BilibiliPlatform::getStreamInfo");
+    StreamInfo info;
     // Parse the URL to extract host and path
     std::string host, path;
     if (!parseUrl(url, host, path)) {
         LOG_ERROR("Failed to parse URL: {}", url);
-        return 0;
+        return info;
     }
+    auto readValidators = [&info](const httplib::Response& res) {
+        auto etag_it = res.headers.find("ETag");
+        if (etag_it != res.headers.end()) {
+            info.etag = etag_it->second;
+        }
+        auto modified_it = res.headers.find("Last-Modified");
+        if (modified_it != res.headers.end()) {
+            info.lastModified = modified_it->second;
+        }
+    };
     
+    RequestMetrics::Timer timer(request_metrics_, host + " size");
     try {
-        std::scoped_lock lock(m_clientMutex_);
         // Borrow a client from the pool for this host
-        std::shared_ptr<httplib::Client> size_client = borrowHttpClient_unsafe(host);
+        auto size_client = client_pool_.acquire(host);
         if (!size_client) {
             LOG_ERROR("Failed to borrow HTTP client for host: {}", host);
-            return 0;
+            return info;
         }
+        timer.leased(size_client.isNew());
 
-        // Build headers (include cookies and configured headers) while holding the client mutex
-        httplib::Headers headers = getHttplibHeaders_unsafe(host, path);
+        // Build headers (include cookies and configured headers)
+        httplib::Headers headers = requestHeaders(host, path);
         // Ensure Range is set for byte range request
         headers.emplace("Range", "bytes=0-0");  // Request only first byte
+        headers.emplace("Accept-Encoding", "identity");
 
         // Try HEAD request first
         auto res = size_client->Head(path, headers);
+        if (res) {
+            timer.firstByte();
+        }
         if (res && res->status == 200) {
             auto it = res->headers.find("Content-Length");
             if (it != res->headers.end()) {
-                returnHttpClient_unsafe(size_client);
-                return std::stoull(it->second);
+                rememberWarmHost(host);
+                info.size = std::stoull(it->second);
+                readValidators(*res);
+                timer.succeeded();
+                return info;
             }
         }
 
         // If HEAD fails, try GET with Range header
+        timer.retried();
         res = size_client->Get(path, headers);
         if (!res) {
-            returnHttpClient_unsafe(size_client);
-            return 0;
+            return info;
         }
+        timer.firstByte();
+        timer.received(res->body.size());
+        rememberWarmHost(host);
         if (res && (res->status == 206 || res->status == 200)) {  // 206 = Partial Content, 200 = OK
+            readValidators(*res);
             // Try to get size from Content-Range header first (more reliable for partial content)
             auto range_it = res->headers.find("Content-Range");
             if (range_it != res->headers.end()) {
@@ -395,9 +814,9 @@ uint64_t BilibiliPlatform::getStreamBytesSize(const std::string &url)
                     std::string total_size_str = range_header.substr(slash_pos + 1);
                     if (total_size_str != "*") {  // "*" means size unknown
                         try {
-                            auto result = std::stoull(total_size_str);
-                            returnHttpClient_unsafe(size_client);
-                            return result;
+                            info.size = std::stoull(total_size_str);
+                            timer.succeeded();
+                            return info;
                         } catch (...) {
                             // Fall through to Content-Length
                         }
@@ -408,23 +827,82 @@ uint64_t BilibiliPlatform::getStreamBytesSize(const std::string &url)
             // Fallback to Content-Length header
             auto length_it = res->headers.find("Content-Length");
             if (length_it != res->headers.end()) {
-                auto result = std::stoull(length_it->second);
-                returnHttpClient_unsafe(size_client);
-                return result;
+                info.size = std::stoull(length_it->second);
+                timer.succeeded();
+                return info;
             }
 
         }
-        returnHttpClient_unsafe(size_client);
     } catch (const std::exception& e) {
         LOG_ERROR("Exception while getting stream size: {}", e.what());
     }
 
-    return 0;
+    return info;
+}
+
+void BilibiliPlatform::fetchSmallFiles(const std::vector<std::string>& urls,
+                                       const std::function<void(size_t, std::string&&)>& onBody)
+{
+    // Group by host, keeping the order within each, so every host's share of the batch
+    // runs over one borrowed keep-alive client
+    std::vector<std::pair<std::string, std::vector<std::pair<size_t, std::string>>>> byHost;
+    for (size_t i = 0; i < urls.size(); ++i) {
+        std::string host, path;
+        if (!parseUrl(urls[i], host, path)) {
+            LOG_WARN("Failed to parse URL: {}", urls[i]);
+            continue;
+        }
+        auto it = std::find_if(byHost.begin(), byHost.end(),
+                               [&host](const auto& group) { return group.first == host; });
+        if (it == byHost.end()) {
+            byHost.emplace_back(host, std::vector<std::pair<size_t, std::string>>{});
+            it = std::prev(byHost.end());
+        }
+        it->second.emplace_back(i, std::move(path));
+    }
+
+    for (auto& [host, paths] : byHost) {
+        auto client = client_pool_.acquire(host);
+        if (!client) {
+            LOG_ERROR("Failed to borrow HTTP client for host: {}", host);
+            return;
+        }
+        bool connecting = client.isNew();
+        for (auto& [index, path] : paths) {
+            if (exitFlag_.load()) {
+                return;
+            }
+            RequestMetrics::Timer timer(request_metrics_, host + " file");
+            timer.leased(connecting);
+            connecting = false;
+            httplib::Headers headers = requestHeaders(host, path);
+            headers.erase("Accept-Encoding");
+            headers.emplace("Accept-Encoding", "identity");
+            auto res = client->Get(path, headers,
+                [&timer](uint64_t, uint64_t) {
+                    timer.firstByte();
+                    return true;
+                });
+            if (res) {
+                timer.firstByte();
+                timer.received(res->body.size());
+            }
+            if (!res || res->status != 200) {
+                LOG_WARN("Fetching {}{} failed: {}", host, path,
+                         res ? std::to_string(res->status) : httplib::to_string(res.error()));
+                continue;
+            }
+            timer.succeeded();
+            onBody(index, std::move(res->body));
+        }
+    }
 }
 
 std::future<bool> BilibiliPlatform::asyncDownloadStream(const std::string &url,
                                                                 std::function<bool(const char *, size_t)> content_receiver,
-                                                                std::function<bool(uint64_t, uint64_t)> progress_callback)
+                                                                std::function<bool(uint64_t, uint64_t)> progress_callback,
+                                                                uint64_t range_start,
+                                                                uint64_t range_length)
 {
     // Return a future that executes the download in a separate thread
     std::string host, path;
@@ -432,36 +910,61 @@ std::future<bool> BilibiliPlatform::asyncDownloadStream(const std::string &url,
         LOG_ERROR("Failed to parse URL: {}", url);
         return std::async(std::launch::deferred, []() { return false; });
     }
-    return std::async(std::launch::async, [self = this->shared_from_this(), host, path, content_receiver, progress_callback]() -> bool {
+    return std::async(std::launch::async, [self = this->shared_from_this(), host, path, content_receiver, progress_callback, range_start, range_length]() -> bool {
         try {
             if (self->exitFlag_.load()) return false;
-            // Create a new client for this host (each thread needs its own client)
-            std::shared_ptr<httplib::Client> stream_client;
-            httplib::Headers headers;
-
-            // Borrow client and build headers while holding the client mutex
-            {
-                std::scoped_lock lock(self->m_clientMutex_);
-                stream_client = self->borrowHttpClient_unsafe(host);
-                if (!stream_client) {
-                    throw std::runtime_error("Failed to borrow HTTP client for streaming.");
+            TRACE_SCOPE("network", "BilibiliPlatform::downloadStream");
+            RequestMetrics::Timer timer(self->request_metrics_, host + " stream");
+            // Each thread borrows its own client; it goes back to the pool when the lease ends
+            auto stream_client = self->client_pool_.acquire(host);
+            if (!stream_client) {
+                throw std::runtime_error("Failed to borrow HTTP client for streaming.");
+            }
+            timer.leased(stream_client.isNew());
+            httplib::Headers headers = self->requestHeaders(host, path);
+            // Byte offsets must refer to the resource itself, never to a compressed body
+            headers.emplace("Accept-Encoding", "identity");
+            const bool ranged = range_start > 0 || range_length > 0;
+            if (ranged) {
+                std::string range = "bytes=" + std::to_string(range_start) + "-";
+                if (range_length > 0) {
+                    range += std::to_string(range_start + range_length - 1);
                 }
-                headers = self->getHttplibHeaders_unsafe(host, path);
+                headers.emplace("Range", range);
             }
-
-            auto res = stream_client->Get(path, headers, content_receiver, progress_callback);
-            self->returnHttpClient_unsafe(stream_client);
+            const int expected_status = ranged ? 206 : 200;
+
+            // Measure the link for audio quality selection; time the receiver takes is
+            // excluded, so a consumer pacing the download doesn't read as a slow network
+            ThroughputEstimator::Sampler sampler(self->throughput_);
+            // Reject the body before it reaches the receiver if a ranged request came back
+            // as a full response; writing it at range_start would corrupt the caller's data
+            auto res = stream_client->Get(path, headers,
+                [expected_status, &timer](const httplib::Response& response) {
+                    timer.firstByte();
+                    return response.status == expected_status;
+                },
+                [&sampler, &timer, &content_receiver](const char* data, size_t length) {
+                    sampler.received(length);
+                    timer.received(length);
+                    const bool more = content_receiver(data, length);
+                    sampler.resumed();
+                    return more;
+                },
+                progress_callback);
+            stream_client.release();
 
             if (!res) {
-                LOG_ERROR("Failed to perform async streaming from: {}/{}.", host, path);
+                LOG_ERROR("Failed to perform async streaming from: {}/{} (range start {}).", host, path, range_start);
                 return false;
             }
 
-            if (res->status != 200) {
+            if (res->status != expected_status) {
                 LOG_ERROR("HTTP error {} when async streaming from: {}/{}.", res->status, host, path);
                 return false;
             }
 
+            timer.succeeded();
             return true;
         } catch (const std::exception& e) {
             LOG_ERROR("Exception during async streaming: {}", e.what());
@@ -487,24 +990,14 @@ std::string BilibiliPlatform::getCurrentTimestamp() const {
     return std::to_string(timestamp);
 }
 
-bool BilibiliPlatform::needsWbiRefresh_unsafe() const {
-    if (wbi_keys_.img_key.empty() || wbi_keys_.sub_key.empty()) {
-        return true;
-    }
-    
-    auto now = std::chrono::system_clock::now();
-    auto diff = std::chrono::duration_cast<std::chrono::hours>(now - wbi_keys_.last_update);
-    return diff.count() >= 24; // Refresh every 24 hours
-}
-
-bool BilibiliPlatform::encWbi_unsafe(std::unordered_map<std::string, std::string> &params) const
+bool BilibiliPlatform::encWbi(std::unordered_map<std::string, std::string> &params) const
 {
-    BiliWbiKeys wbi_keys_copy = wbi_keys_;
-    if (wbi_keys_copy.img_key.empty() || wbi_keys_copy.sub_key.empty()) {
+    const std::shared_ptr<const BiliWbiKeys> keys = currentWbiKeys();
+    if (!keys) {
         LOG_INFO("WBI keys are not initialized");
         return false;
     }
-    std::string mixin_key = getMixinKey(wbi_keys_copy.img_key + wbi_keys_copy.sub_key);
+    const std::string& mixin_key = keys->mixin_key;
     params["wts"] = getCurrentTimestamp();
     
     // Sort parameters
@@ -527,50 +1020,97 @@ bool BilibiliPlatform::encWbi_unsafe(std::unordered_map<std::string, std::string
     return true;
 }
 
-bool BilibiliPlatform::refreshWbiKeys_unsafe() {
-    std::shared_ptr<httplib::Client> http_client;
-    httplib::Headers headers;
-    {
-        // Caller is expected to hold m_clientMutex_ before calling this _unsafe method.
-        http_client = borrowHttpClient_unsafe("https://api.bilibili.com");
-        if (!http_client) {
-            throw std::runtime_error("Failed to borrow HTTP client for WBI key refresh.");
-        }
-        headers = getHttplibHeaders_unsafe("https://api.bilibili.com", "/x/web-interface/nav");
+std::shared_ptr<const BilibiliPlatform::BiliWbiKeys> BilibiliPlatform::currentWbiKeys() const {
+    std::unique_lock<std::mutex> lock(m_wbiMutex_);
+    if (!wbi_keys_ && wbi_refresher_.joinable()) {
+        // Cold start: nothing to serve yet, so wait for the refresher's attempt to end
+        const uint64_t attempts = wbi_attempts_;
+        wbi_cv_.wait_for(lock, WBI_COLD_WAIT, [this, attempts]() {
+            return wbi_keys_ || wbi_attempts_ != attempts || exitFlag_.load();
+        });
+    }
+    return wbi_keys_;
+}
+
+std::optional<BilibiliPlatform::BiliWbiKeys> BilibiliPlatform::fetchWbiKeys() {
+    std::string body;
+    if (!getApiResponse(API_HOST, "/x/web-interface/nav", {}, requestHeaders(API_HOST, "/x/web-interface/nav"), body)) {
+        return std::nullopt;
+    }
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(body, root)) {
+        return std::nullopt;
+    }
+    std::string img_url = root["data"]["wbi_img"]["img_url"].asString();
+    std::string sub_url = root["data"]["wbi_img"]["sub_url"].asString();
+
+    // Extract keys from URLs
+    size_t img_slash = img_url.find_last_of('/');
+    size_t img_dot = img_url.find_last_of('.');
+    BiliWbiKeys new_keys;
+    if (img_slash != std::string::npos && img_dot != std::string::npos) {
+        new_keys.img_key = img_url.substr(img_slash + 1, img_dot - img_slash - 1);
     }
 
-    auto res = http_client->Get("/x/web-interface/nav", headers);
-    returnHttpClient_unsafe(http_client);
+    size_t sub_slash = sub_url.find_last_of('/');
+    size_t sub_dot = sub_url.find_last_of('.');
+    if (sub_slash != std::string::npos && sub_dot != std::string::npos) {
+        new_keys.sub_key = sub_url.substr(sub_slash + 1, sub_dot - sub_slash - 1);
+    }
+    if (new_keys.img_key.empty() || new_keys.sub_key.empty()) {
+        return std::nullopt;
+    }
+    new_keys.mixin_key = getMixinKey(new_keys.img_key + new_keys.sub_key);
+    new_keys.last_update = std::chrono::system_clock::now();
+    return new_keys;
+}
 
-    if (res && res->status == 200) {
-        Json::Value root;
-        Json::Reader reader;
-        
-        if (reader.parse(res->body, root)) {
-            std::string img_url = root["data"]["wbi_img"]["img_url"].asString();
-            std::string sub_url = root["data"]["wbi_img"]["sub_url"].asString();
-            
-            // Extract keys from URLs
-            size_t img_slash = img_url.find_last_of('/');
-            size_t img_dot = img_url.find_last_of('.');
-            BiliWbiKeys new_keys;
-            if (img_slash != std::string::npos && img_dot != std::string::npos) {
-                new_keys.img_key = img_url.substr(img_slash + 1, img_dot - img_slash - 1);
-            }
-            
-            size_t sub_slash = sub_url.find_last_of('/');
-            size_t sub_dot = sub_url.find_last_of('.');
-            if (sub_slash != std::string::npos && sub_dot != std::string::npos) {
-                new_keys.sub_key = sub_url.substr(sub_slash + 1, sub_dot - sub_slash - 1);
-            }
+void BilibiliPlatform::startWbiRefresher() {
+    std::scoped_lock lock(m_wbiMutex_);
+    if (wbi_refresher_.joinable() || exitFlag_.load()) {
+        return;
+    }
+    wbi_refresher_ = std::thread([this]() { wbiRefreshLoop(); });
+}
 
-            new_keys.last_update = std::chrono::system_clock::now();
-            wbi_keys_ = new_keys;
-            return true;
+void BilibiliPlatform::wbiRefreshLoop() {
+    std::chrono::seconds retry = WBI_RETRY_MIN;
+    std::unique_lock<std::mutex> lock(m_wbiMutex_);
+    while (!exitFlag_.load()) {
+        const auto now = std::chrono::system_clock::now();
+        const auto due = wbiRefreshDue_unsafe();
+        if (due > now) {
+            const auto sleep = std::min<std::chrono::system_clock::duration>(due - now, WBI_MAX_SLEEP);
+            wbi_cv_.wait_for(lock, sleep, [this]() { return exitFlag_.load(); });
+            continue;
+        }
+
+        lock.unlock();
+        std::optional<BiliWbiKeys> fresh = fetchWbiKeys();
+        lock.lock();
+        ++wbi_attempts_;
+        if (fresh) {
+            // Signers holding the old snapshot finish with it
+            wbi_keys_ = std::make_shared<const BiliWbiKeys>(std::move(*fresh));
+            wbi_retry_at_ = {};
+            retry = WBI_RETRY_MIN;
+            LOG_INFO("WBI keys refreshed");
+        } else if (!exitFlag_.load()) {
+            wbi_retry_at_ = std::chrono::system_clock::now() + retry;
+            LOG_WARN("Failed to refresh WBI keys, retrying in {}s{}", retry.count(),
+                     wbi_keys_ ? ", signing with the previous keys" : "");
+            retry = std::min(retry * 2, WBI_RETRY_MAX);
         }
+        wbi_cv_.notify_all();
     }
-    
-    return false;
+}
+
+std::chrono::system_clock::time_point BilibiliPlatform::wbiRefreshDue_unsafe() const {
+    if (!wbi_keys_) {
+        return wbi_retry_at_;
+    }
+    return std::max(wbi_keys_->last_update + WBI_REFRESH_AFTER, wbi_retry_at_);
 }
 
 const httplib::Headers& network::BilibiliPlatform::getDefaultHeaders() const
@@ -589,6 +1129,28 @@ const httplib::Headers& network::BilibiliPlatform::getDefaultHeaders() const
 
 // Helper method implementations
 httplib::Headers BilibiliPlatform::getHttplibHeaders_unsafe(const std::string& host, const std::string& path) const {
+    std::string key = host;
+    key += '\n';
+    for (const auto& cookie_path : cookie_paths_) {
+        key += path.rfind(cookie_path, 0) == 0 ? '1' : '0';
+    }
+    auto it = header_sets_.find(key);
+    if (it != header_sets_.end()
+        && (!it->second.expires.has_value() || std::chrono::system_clock::now() <= *it->second.expires)) {
+        return it->second.headers;
+    }
+    // Every stream CDN host adds a set; start over rather than grow without bound
+    if (header_sets_.size() >= HEADER_SET_LIMIT) {
+        header_sets_.clear();
+    }
+    HeaderSet set;
+    set.headers = buildHeaders_unsafe(host, path, set.expires);
+    return header_sets_.insert_or_assign(std::move(key), std::move(set)).first->second.headers;
+}
+
+httplib::Headers BilibiliPlatform::buildHeaders_unsafe(const std::string& host, const std::string& path,
+                                                       std::optional<std::chrono::system_clock::time_point>& expires) const {
+    expires.reset();
     httplib::Headers headers;
     for (const auto& pair : headers_) {
         headers.emplace(pair.first, pair.second);
@@ -628,6 +1190,9 @@ httplib::Headers BilibiliPlatform::getHttplibHeaders_unsafe(const std::string& h
 
         if (!cookie_str.empty()) cookie_str += "; ";
         cookie_str += c.name + "=" + c.value;
+        if (c.expires.has_value() && (!expires.has_value() || *c.expires < *expires)) {
+            expires = c.expires;
+        }
     }
 
     // Ensure we don't leave a stale Cookie entry copied from headers_
@@ -639,17 +1204,15 @@ httplib::Headers BilibiliPlatform::getHttplibHeaders_unsafe(const std::string& h
     return headers;
 }
 
-bool BilibiliPlatform::initializeCookies_unsafe() {
-    // Create a dedicated client for cookie initialization
-    std::shared_ptr<httplib::Client> http_client = borrowHttpClient_unsafe("https://www.bilibili.com");
+bool BilibiliPlatform::initializeCookies() {
+    // Headers are copied under the client mutex; the request itself runs without it
+    httplib::Headers headers = requestHeaders("https://www.bilibili.com", "/");
+    auto http_client = client_pool_.acquire("https://www.bilibili.com");
     if (!http_client) {
         throw std::runtime_error("Failed to borrow HTTP client for cookie initialization.");
     }
-
-    // Caller must hold m_clientMutex_ when invoking this _unsafe method.
-    httplib::Headers headers = getHttplibHeaders_unsafe("https://www.bilibili.com", "/");
     auto res = http_client->Head("/", headers);
-    returnHttpClient_unsafe(http_client);
+    http_client.release();
 
     if (!res) {
         LOG_ERROR("Failed to initialize cookies: No response from server.");
@@ -662,6 +1225,7 @@ bool BilibiliPlatform::initializeCookies_unsafe() {
     
     // Extract and parse Set-Cookie headers properly. There can be multiple Set-Cookie headers,
     // and each header contains one cookie followed by attributes separated by ';'.
+    std::scoped_lock lock(m_clientMutex_);
     cookies_.clear();
     for (const auto& header : res->headers) {
         if (header.first == "Set-Cookie") {
@@ -733,96 +1297,126 @@ bool BilibiliPlatform::initializeCookies_unsafe() {
             cookies_.push_back(std::move(c));
         }
     }
+    updateClientCookies_unsafe();
     return true;
 }
 
-std::shared_ptr<httplib::Client> network::BilibiliPlatform::borrowHttpClient_unsafe(const std::string &host)
+httplib::Headers BilibiliPlatform::requestHeaders(const std::string& host, const std::string& path) const
 {
-    // Find or create vector for this host
-    auto &vec = http_clients[host];
-    for (auto &entry : vec) {
-        if (entry.available) {
-            entry.available = false;
-            return entry.client;
-        }
-    }
-
-    // No available client for this host -> create and append
-    auto new_client = std::make_shared<httplib::Client>(host);
-    new_client->set_keep_alive(true);
-    new_client->enable_server_certificate_verification(true);
-    new_client->set_follow_location(true);
-    new_client->set_connection_timeout(timeout_seconds_, 0);
-    new_client->set_read_timeout(timeout_seconds_, 0);
-    vec.push_back({host, new_client, false});
-    return new_client;
+    std::scoped_lock lock(m_clientMutex_);
+    return getHttplibHeaders_unsafe(host, path);
 }
 
-void network::BilibiliPlatform::returnHttpClient_unsafe(std::shared_ptr<httplib::Client> client)
+bool BilibiliPlatform::sendGetRequest(const std::string& host, 
+                                        const std::string& path,
+                                        const std::unordered_map<std::string, std::string>& params,
+                                        std::string& response,
+                                        CancelToken* cancel) 
 {
-    // Search all host buckets for the client
-    for (auto &pair : http_clients) {
-        for (auto &entry : pair.second) {
-            if (entry.client == client) {
-                entry.available = true;
-                return;
-            }
-        }
+    httplib::Params httplib_params;
+    for (const auto& pair : params) {
+        httplib_params.emplace(pair.first, pair.second);
     }
-    // Not found: add to default empty-host bucket as available
-    LOG_WARN("returnHttpClient_unsafe: returned client not found in pool; adding to orphan bucket");
-    http_clients[std::string()].push_back({std::string(), client, true});
+    return getApiResponse(host, path, httplib_params, requestHeaders(host, path), response, cancel);
 }
 
-bool BilibiliPlatform::sendGetRequest_unsafe(const std::string& host, 
-                                                const std::string& path,
-                                               const std::unordered_map<std::string, std::string>& params,
-                                               std::string& response) 
+bool BilibiliPlatform::getApiResponse(const std::string& host,
+                                      const std::string& path,
+                                      const httplib::Params& params,
+                                      httplib::Headers headers,
+                                      std::string& body,
+                                      CancelToken* cancel)
 {
-    std::shared_ptr<httplib::Client> http_client = borrowHttpClient_unsafe(host);
+    if (cancel && cancel->cancelled()) {
+        return false;
+    }
+    TRACE_SCOPE("network", "BilibiliPlatform::getApiResponse");
+    RequestMetrics::Timer timer(request_metrics_, host + path);
+    auto http_client = client_pool_.acquire(host);
     if (!http_client) {
-        throw std::runtime_error("Failed to borrow HTTP client.");
+        throw std::runtime_error("Failed to borrow HTTP client for " + host);
+    }
+    timer.leased(http_client.isNew());
+    // Replace whatever the configured headers say: only codings decodeContent() handles
+    headers.erase("Accept-Encoding");
+    headers.emplace("Accept-Encoding", compression_enabled_.load() ? acceptedContentEncodings() : "identity");
+    // Progress is first reported once the headers and the first body bytes are in
+    auto progress = [cancel, &timer](uint64_t, uint64_t) {
+        timer.firstByte();
+        return !(cancel && cancel->cancelled());
+    };
+    httplib::Result res;
+    if (cancel) {
+        // stop() shuts the socket down, which wakes a connect or read blocked in httplib;
+        // the progress check ends a transfer that is still receiving
+        httplib::Client* client = &*http_client;
+        CancelToken::Registration abort = cancel->onCancel([client]() { client->stop(); });
+        res = http_client->Get(path, params, headers, progress);
+        // Unregistered before the client goes back to the pool and to another request
+        abort.reset();
+    } else {
+        res = http_client->Get(path, params, headers, progress);
+    }
+    http_client.release();
+    if (res) {
+        timer.firstByte();      // An empty body reports no progress
+        timer.received(res->body.size());
+    }
+    if (!res || res->status != 200) {
+        return false;
     }
 
-    httplib::Params httplib_params;
-    for (const auto& pair : params) {
-        httplib_params.emplace(pair.first, pair.second);
+    const std::string encoding = res->get_header_value("Content-Encoding");
+    if (!decodeContent(encoding, res->body, body)) {
+        LOG_ERROR("Failed to decode '{}' response from {}{}", encoding, host, path);
+        return false;
     }
-    auto res = http_client->Get(path, httplib_params, getHttplibHeaders_unsafe(host, path));
-    returnHttpClient_unsafe(http_client);
-    if (res && res->status == 200) {
-        response = res->body;
-        return true;
+    timer.succeeded();
+    ++api_responses_;
+    api_wire_bytes_ += res->body.size();
+    api_decoded_bytes_ += body.size();
+    if (!encoding.empty()) {
+        LOG_DEBUG("{}{}: {} bytes {} -> {} bytes", host, path, res->body.size(), encoding, body.size());
     }
-    return false;
+    return true;
 }
 
-std::vector<BilibiliPageInfo> BilibiliPlatform::getPagesCid_unsafe(const std::string& bvid) {
+std::vector<BilibiliPageInfo> BilibiliPlatform::getPagesCid(const std::string& bvid, CancelToken* cancel) {
+    if (auto cached = page_cache_.get(bvid)) {
+        return std::move(*cached);
+    }
     std::vector<BilibiliPageInfo> pages;
 
     httplib::Params params;
     params.emplace("bvid", util::urlEncode(bvid));
-    std::shared_ptr<httplib::Client> http_client = borrowHttpClient_unsafe("https://api.bilibili.com");
-    if (!http_client) {
-        throw std::runtime_error("Failed to borrow HTTP client for page CID retrieval.");
-    }
-    auto res = http_client->Get("/x/player/pagelist", params, getHttplibHeaders_unsafe("https://api.bilibili.com", "/x/player/pagelist"));
-    returnHttpClient_unsafe(http_client);
-    if (res && res->status == 200) {
-        Json::Value root;
-        Json::Reader reader;
-        
-        if (reader.parse(res->body, root) && root["code"].asInt() == 0) {
-            for (const auto& page : root["data"]) {
-                BilibiliPageInfo info;
-                info.cid = page["cid"].asInt64();
-                info.page = page["page"].asInt();
-                info.part = page["part"].asString();
-                info.duration = page["duration"].asInt();
-                info.firstFrame = page["first_frame"].asString();
-                pages.push_back(info);
+    std::string body;
+    if (getApiResponse("https://api.bilibili.com", "/x/player/pagelist", params,
+                       requestHeaders("https://api.bilibili.com", "/x/player/pagelist"), body, cancel)) {
+        util::JsonScanner json(body);
+        std::string_view key;
+        int code = 0;
+        if (json.enterObject()) {
+            while (json.nextKey(key)) {
+                if (key == "code" && json.readInt(code)) continue;
+                if (key != "data" || !json.enterArray()) {
+                    json.skipValue();
+                    continue;
+                }
+                while (json.nextElement()) {
+                    BilibiliPageInfo info{};
+                    if (readPageItem(json, info)) {
+                        pages.push_back(std::move(info));
+                    }
+                }
             }
         }
+        if (!json.ok() || code != 0) {
+            pages.clear();
+        }
+    }
+    // Failed lookups are not cached so the next search retries them
+    if (!pages.empty()) {
+        page_cache_.put(bvid, pages);
     }
     
     return pages;
@@ -831,11 +1425,18 @@ std::vector<BilibiliPageInfo> BilibiliPlatform::getPagesCid_unsafe(const std::st
 void BilibiliPlatform::updateClientCookies_unsafe() {
     // Since httplib 0.15.3 doesn't have built-in cookie store management,
     // we manually add cookies to each request via headers
-    // Update the Cookie header in our headers map for consistency
-    // Build cookie string under cookies mutex, then update headers under headers mutex
-    // With structured cookie jar we build Cookie header per-request. Clear any
+    // With structured cookie jar the Cookie header comes from the header sets. Clear any
     // previously-stored Cookie header in headers_ to avoid duplication.
     headers_.erase("Cookie");
+    // The sets are rebuilt from the changed jar and headers on next use
+    header_sets_.clear();
+    cookie_paths_.clear();
+    for (const auto& c : cookies_) {
+        if (!c.cookie_path.empty()
+            && std::find(cookie_paths_.begin(), cookie_paths_.end(), c.cookie_path) == cookie_paths_.end()) {
+            cookie_paths_.push_back(c.cookie_path);
+        }
+    }
 }
 
 /******* Configuration related *************/
@@ -952,17 +1553,22 @@ bool BilibiliPlatform::saveCookies_unsafe(Json::Value& jsonObj) const {
 bool network::BilibiliPlatform::loadWbiKeys_unsafe(const Json::Value &jsonObj)
 {
     if (jsonObj.isObject()) {
-        wbi_keys_.img_key = jsonObj.get("img_key", "").asString();
-        wbi_keys_.sub_key = jsonObj.get("sub_key", "").asString();
+        BiliWbiKeys keys;
+        keys.img_key = jsonObj.get("img_key", "").asString();
+        keys.sub_key = jsonObj.get("sub_key", "").asString();
         std::string last_update_str = jsonObj.get("last_update", "").asString();
         if (!last_update_str.empty()) {
             try {
                 std::time_t t = std::stoll(last_update_str);
-                wbi_keys_.last_update = std::chrono::system_clock::from_time_t(t);
+                keys.last_update = std::chrono::system_clock::from_time_t(t);
             } catch (...) {
-                wbi_keys_.last_update = std::chrono::system_clock::now();
+                keys.last_update = std::chrono::system_clock::now();
             }
         }
+        if (!keys.img_key.empty() && !keys.sub_key.empty()) {
+            keys.mixin_key = getMixinKey(keys.img_key + keys.sub_key);
+            wbi_keys_ = std::make_shared<const BiliWbiKeys>(std::move(keys));
+        }
         return true;
     }
     return false;
@@ -975,28 +1581,29 @@ bool network::BilibiliPlatform::saveWbiKeys_unsafe(Json::Value &jsonObj) const
         jsonObj = Json::Value(Json::objectValue);
     }
     
-    jsonObj["img_key"] = wbi_keys_.img_key;
-    jsonObj["sub_key"] = wbi_keys_.sub_key;
-    std::time_t t = std::chrono::system_clock::to_time_t(wbi_keys_.last_update);
+    if (!wbi_keys_) {
+        jsonObj["img_key"] = "";
+        jsonObj["sub_key"] = "";
+        jsonObj["last_update"] = "";
+        return true;
+    }
+    jsonObj["img_key"] = wbi_keys_->img_key;
+    jsonObj["sub_key"] = wbi_keys_->sub_key;
+    std::time_t t = std::chrono::system_clock::to_time_t(wbi_keys_->last_update);
     jsonObj["last_update"] = std::to_string(t);
     return true;
 }
 
 #ifdef UNIT_TEST
 void network::BilibiliPlatform::test_create_clients(const std::string& host, size_t n) {
-    std::scoped_lock lock(m_clientMutex_);
     for (size_t i = 0; i < n; ++i) {
-        auto c = borrowHttpClient_unsafe(host);
-        // Immediately return to mark as available
-        returnHttpClient_unsafe(c);
+        // Immediately returned to the pool when the lease goes out of scope
+        auto c = client_pool_.acquire(host);
     }
 }
 
 size_t network::BilibiliPlatform::test_pool_size(const std::string& host) const {
-    std::scoped_lock lock(m_clientMutex_);
-    auto it = http_clients.find(host);
-    if (it == http_clients.end()) return 0;
-    return it->second.size();
+    return client_pool_.clientCount(host);
 }
 
 bool network::BilibiliPlatform::test_concurrent_borrow_return(const std::string& host, size_t thread_count, size_t iter_count) {
@@ -1004,24 +1611,21 @@ bool network::BilibiliPlatform::test_concurrent_borrow_return(const std::string&
         // Ensure at least one client exists
         test_create_clients(host, 1);
 
+        std::atomic<bool> all_borrowed{true};
         std::vector<std::thread> threads;
         for (size_t t = 0; t < thread_count; ++t) {
-            threads.emplace_back([self = this->shared_from_this(), host, iter_count]() {
+            threads.emplace_back([self = this->shared_from_this(), host, iter_count, &all_borrowed]() {
                 for (size_t i = 0; i < iter_count; ++i) {
-                    std::shared_ptr<httplib::Client> c;
-                    {
-                        std::scoped_lock lock(self->m_clientMutex_);
-                        c = self->borrowHttpClient_unsafe(host);
-                    }
+                    auto c = self->client_pool_.acquire(host);
+                    if (!c) all_borrowed.store(false);
                     // Simulate short work
                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
-                    self->returnHttpClient_unsafe(c);
                 }
             });
         }
 
         for (auto &th : threads) th.join();
-        return true;
+        return all_borrowed.load();
     } catch (...) {
         return false;
     }
@@ -1050,7 +1654,7 @@ void network::BilibiliPlatform::test_add_cookie_from_set_cookie(const std::strin
     std::scoped_lock lock(m_clientMutex_);
     // Reuse parsing logic by constructing a fake response header
     std::string header = set_cookie_line;
-    // parse similarly to initializeCookies_unsafe
+    // parse similarly to initializeCookies
     std::istringstream iss(header);
     std::string token;
     std::vector<std::string> parts;
@@ -1102,6 +1706,39 @@ void network::BilibiliPlatform::test_add_cookie_from_set_cookie(const std::strin
     if (!c.domain.empty() && c.domain[0] == '.') c.domain.erase(0,1);
     std::transform(c.domain.begin(), c.domain.end(), c.domain.begin(), [](unsigned char ch){ return std::tolower(ch); });
     cookies_.push_back(std::move(c));
+    updateClientCookies_unsafe();
+}
+
+void network::BilibiliPlatform::test_seed_play_url(const std::string& params, const std::string& url) {
+    test_seed_play_streams(params, { AudioStreamOption{ url, 0, false } });
+}
+
+void network::BilibiliPlatform::test_seed_play_streams(const std::string& params, std::vector<AudioStreamOption> streams) {
+    std::string bvid;
+    int64_t cid = 0;
+    if (!parsePlayParams(params, bvid, cid)) return;
+    std::scoped_lock lock(m_playUrlMutex_);
+    const auto expires = playUrlExpiry(streams, std::chrono::system_clock::now());
+    play_urls_[playUrlKey(bvid, cid)] = PlayUrlEntry{ std::move(streams), expires };
+}
+
+void network::BilibiliPlatform::test_seed_wbi_keys(const std::string& img_key, const std::string& sub_key,
+                                                    std::chrono::system_clock::time_point last_update) {
+    BiliWbiKeys keys;
+    keys.img_key = img_key;
+    keys.sub_key = sub_key;
+    keys.mixin_key = getMixinKey(img_key + sub_key);
+    keys.last_update = last_update;
+    std::scoped_lock lock(m_wbiMutex_);
+    wbi_keys_ = std::make_shared<const BiliWbiKeys>(std::move(keys));
+}
+
+bool network::BilibiliPlatform::test_sign_wbi(std::unordered_map<std::string, std::string>& params) {
+    return encWbi(params);
+}
+
+void network::BilibiliPlatform::test_redirect_hosts(std::unordered_map<std::string, std::string> redirects) {
+    client_pool_.setHostRedirects(std::move(redirects));
 }
 
 httplib::Headers BilibiliPlatform::test_get_headers_for_url(const std::string& url) {
@@ -1136,4 +1773,19 @@ bool BilibiliPlatform::parseUrl(const std::string& url, std::string& host, std::
     }
     
     return true;
+}
+
+void BilibiliPlatform::rememberWarmHost(const std::string& host)
+{
+    if (host == API_HOST) return;
+    std::scoped_lock lock(m_warmHostsMutex_);
+    auto it = std::find(warm_hosts_.begin(), warm_hosts_.end(), host);
+    if (it == warm_hosts_.begin() && it != warm_hosts_.end()) return;
+    if (it != warm_hosts_.end()) {
+        warm_hosts_.erase(it);
+    }
+    warm_hosts_.insert(warm_hosts_.begin(), host);
+    if (warm_hosts_.size() > WARM_HOST_COUNT) {
+        warm_hosts_.resize(WARM_HOST_COUNT);
+    }
 }
\ No newline at end of file
@@ -11,8 +11,16 @@
 #include <httplib.h>
 #include <json/json.h>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <atomic>
 #include <optional>
+#include <network/http_client_pool.h>
+#include <network/cancel_token.h>
+#include <network/audio_quality.h>
+#include <network/throughput_estimator.h>
+#include <network/request_metrics.h>
+#include "bili_page_cache.h"
 
 namespace network
 {
@@ -24,14 +32,6 @@ namespace network
         std::string coverImg;
     };
 
-    struct BilibiliPageInfo {
-        int64_t cid; // cid
-        int page; // page number
-        std::string part; // part title
-        int duration; // duration in seconds
-        std::string firstFrame; // page cover
-    };
-
     struct BilibiliSearchResult {
         std::string title;
         std::string bvid;
@@ -59,20 +59,64 @@ namespace network
         void setUserAgent(const std::string& user_agent) override;
         
         std::vector<SearchResult> searchByTitle(const std::string& title, int page = 1) override;
+        size_t searchByTitle(const std::string& title, int page, const SearchBatchCallback& onBatch) override;
+        // As above; cancelling the token aborts the search request and page lookups in flight,
+        // releasing their pooled connections at once
+        size_t searchByTitle(const std::string& title, int page, const SearchBatchCallback& onBatch,
+                             const std::shared_ptr<CancelToken>& cancel);
         std::string getAudioUrlByParams(const std::string& params) override;
         uint64_t getStreamBytesSize(const std::string& url) override;
         std::future<bool> asyncDownloadStream(
             const std::string& url,
             std::function<bool(const char*, size_t)> content_receiver,
-            std::function<bool(uint64_t, uint64_t)> progress_callback = nullptr) override;
+            std::function<bool(uint64_t, uint64_t)> progress_callback = nullptr,
+            uint64_t range_start = 0,
+            uint64_t range_length = 0) override;
         
     public: // Platform-specific methods
         // Search videos by title and get page info (platform-specific return type)
+        // How long page lists fetched for a bvid are reused, 0 disables the cache
+        void setPageCacheTtl(std::chrono::seconds ttl);
+        // Resolve and cache the audio URL for params (bvid=...&cid=...) unless a cached one
+        // stays valid long enough to start the track later. Blocks; returns false on failure.
+        bool prefetchAudioUrl(const std::string& params);
+        // Every part of the video `part` belongs to (one of its search results), in page
+        // order, from a single page list lookup. The playurls of the first `prewarm` parts
+        // are resolved in parallel before returning. Blocks; empty on failure.
+        std::vector<SearchResult> videoParts(const SearchResult& part, size_t prewarm,
+                                             CancelToken* cancel = nullptr);
+        // Size plus ETag/Last-Modified of a stream, from the same probe as getStreamBytesSize
+        StreamInfo getStreamInfo(const std::string& url);
+        // GET each of urls in full and pass its body to onBody with its index; failed ones
+        // are logged and skipped. The URLs of one host share a single pooled connection
+        void fetchSmallFiles(const std::vector<std::string>& urls,
+                             const std::function<void(size_t, std::string&&)>& onBody);
+        // Pre-connect pooled keep-alive clients to the API host and the CDN hosts streams
+        // came from recently ("warm_hosts" in bilibili.json), all in parallel. Blocks until
+        // every handshake is done or failed; returns how many connections were opened.
+        size_t warmUpConnections();
+        // Advertise gzip/br to the API hosts ("compression" in bilibili.json, on by default)
+        void setCompressionEnabled(bool enabled);
+        // Which audio stream getAudioUrlByParams() picks; Auto by default
+        void setAudioQuality(AudioQuality quality);
+        // Per-connection download rate measured from recent streams, 0 while unknown
+        uint64_t measuredThroughput() const;
+
+        // API responses received so far, with their size on the wire and once decoded
+        struct ApiTraffic {
+            uint64_t responses = 0;
+            uint64_t wireBytes = 0;
+            uint64_t decodedBytes = 0;
+        };
+        ApiTraffic apiTraffic() const;
+        // Timing of the API, stream, size-probe and small-file requests so far, by endpoint
+        // ("host/path" for the API, "host stream", "host size" and "host file" for the CDNs)
+        std::vector<RequestMetrics::EndpointStats> requestMetrics() const;
 
 #ifdef UNIT_TEST
     // Test helpers (only present when UNIT_TEST is defined at compile time)
-    // Create `n` clients for the given host by borrowing/returning under the
-    // client mutex. Useful to populate the pool for tests.
+    // Create `n` clients for the given host by borrowing/returning them
+    // from the pool. Useful to populate the pool for tests.
     void test_create_clients(const std::string& host, size_t n);
     // Return the total number of clients recorded for a host
     size_t test_pool_size(const std::string& host) const;
@@ -83,11 +127,23 @@ namespace network
     void test_add_cookie_from_set_cookie(const std::string& set_cookie_line, const std::string& origin_host);
     // Build headers for a full URL (scheme+host+path) for testing cookie selection
     httplib::Headers test_get_headers_for_url(const std::string& url);
+    // Put a resolved audio URL in the playurl cache as if the API had returned it
+    void test_seed_play_url(const std::string& params, const std::string& url);
+    // Put resolved audio streams in the playurl cache as if the API had returned them
+    void test_seed_play_streams(const std::string& params, std::vector<AudioStreamOption> streams);
+    // Install WBI keys as if fetched at last_update, without the refresher thread
+    void test_seed_wbi_keys(const std::string& img_key, const std::string& sub_key,
+                            std::chrono::system_clock::time_point last_update);
+    // Sign params with the current keys; false when there are none
+    bool test_sign_wbi(std::unordered_map<std::string, std::string>& params);
+    // Connect to another origin for these hosts (see HttpClientPool::setHostRedirects)
+    void test_redirect_hosts(std::unordered_map<std::string, std::string> redirects);
 #endif
     private: // Struct
         struct BiliWbiKeys {
             std::string img_key;
             std::string sub_key;
+            std::string mixin_key;  // derived from img_key + sub_key once per key set
             std::chrono::system_clock::time_point last_update;
         };
     private:
@@ -95,45 +151,79 @@ namespace network
         // WBI signature methods, this method is thread-safe
         std::string getMixinKey(const std::string& orig) const;
         std::string getCurrentTimestamp() const;
-        // Require wbi mutex
-        bool encWbi_unsafe(std::unordered_map<std::string, std::string>& params) const;
-        bool needsWbiRefresh_unsafe() const;
-        // Require wbi mutex AND client mutex (caller must hold both when invoking)
-        bool refreshWbiKeys_unsafe();
+        // Sign params with the current keys, stale ones included; thread-safe and never
+        // touches the network once any keys exist. false when there are none
+        bool encWbi(std::unordered_map<std::string, std::string>& params) const;
+        // Snapshot of the keys. Until the first set arrives, waits (bounded) for the
+        // refresher's next attempt instead of fetching inline
+        std::shared_ptr<const BiliWbiKeys> currentWbiKeys() const;
+        // /x/web-interface/nav round-trip; takes no lock across the request
+        std::optional<BiliWbiKeys> fetchWbiKeys();
+        // Start the background refresher once; it replaces the keys ahead of expiry
+        void startWbiRefresher();
+        void wbiRefreshLoop();
+        // Require wbi mutex. When the refresher should fetch next
+        std::chrono::system_clock::time_point wbiRefreshDue_unsafe() const;
 
         // HTTP helper methods
         const httplib::Headers& getDefaultHeaders() const;
         // Require client mutex
         // Build request headers (including Cookie) appropriate for the target host/path.
         // Caller must hold m_clientMutex_. The host should include scheme (e.g. https://api.bilibili.com)
+        // Served from header_sets_ once built for the host and the cookie paths path falls under
         httplib::Headers getHttplibHeaders_unsafe(const std::string& host, const std::string& path) const;
-        // Require client mutex
-        bool initializeCookies_unsafe();
-        // Require client mutex
-        std::shared_ptr<httplib::Client> borrowHttpClient_unsafe(const std::string& host);
-        // Require client mutex
-        void returnHttpClient_unsafe(std::shared_ptr<httplib::Client> client);
-        // Require client mutex
-        bool sendGetRequest_unsafe(const std::string& host, 
+        // Match the cookie jar against host/path and join headers_ with the Cookie header
+        httplib::Headers buildHeaders_unsafe(const std::string& host, const std::string& path,
+                                             std::optional<std::chrono::system_clock::time_point>& expires) const;
+        // HEAD the home page for its cookies; takes the client mutex only to copy the
+        // headers and to store the cookies, never across the request
+        bool initializeCookies();
+        // Takes the client mutex only to copy headers/cookies, never across the request
+        httplib::Headers requestHeaders(const std::string& host, const std::string& path) const;
+        // GET an API endpoint on a pooled client and decode its Content-Encoding into body;
+        // false unless the status is 200. Takes no locks, so _unsafe callers may use it.
+        // Cancelling cancel aborts the request even while it is blocked in connect or read
+        bool getApiResponse(const std::string& host,
+                            const std::string& path,
+                            const httplib::Params& params,
+                            httplib::Headers headers,
+                            std::string& body,
+                            CancelToken* cancel = nullptr);
+        // Thread-safe, the round-trip runs on a pooled client without holding any lock
+        bool sendGetRequest(const std::string& host, 
                             const std::string& path,
                             const std::unordered_map<std::string, std::string>& params,
-                            std::string& response);
-        std::vector<BilibiliPageInfo> getPagesCid_unsafe(const std::string& bvid);
-        // Require client mutex
+                            std::string& response,
+                            CancelToken* cancel = nullptr);
+        // Require client mutex. Call after changing headers_ or cookies_: drops the
+        // precomputed header sets
         void updateClientCookies_unsafe();
         /************* Configuration related *************/
         bool loadHeaders_unsafe(const Json::Value& jsonObj);
         bool saveHeaders_unsafe(Json::Value& jsonObj) const;
         bool loadCookies_unsafe(const Json::Value& jsonObj);
         bool saveCookies_unsafe(Json::Value& jsonObj) const;
+        // Require wbi mutex
         bool loadWbiKeys_unsafe(const Json::Value& jsonObj);
         bool saveWbiKeys_unsafe(Json::Value& jsonObj) const;
         // Utility methods
         bool parseUrl(const std::string& url, std::string& host, std::string& path) const;
-        std::vector<BilibiliPageInfo> getPagesCid(const std::string& bvid);
-        std::vector<BilibiliVideoInfo> searchByTitleOld(const std::string& title, int page = 1);
+        void rememberWarmHost(const std::string& host);
+        // Served from page_cache_ when fresh; thread-safe
+        std::vector<BilibiliPageInfo> getPagesCid(const std::string& bvid, CancelToken* cancel = nullptr);
+        std::vector<BilibiliVideoInfo> searchByTitleOld(const std::string& title, int page = 1,
+                                                        CancelToken* cancel = nullptr);
+        // URL of the stream pickAudioStream() chose among the cached streams for params if
+        // they are valid for at least minRemaining, otherwise among fresh ones from the API;
+        // concurrent callers for the same track share one request. The choice is kept with
+        // the cache entry, so every caller gets the same stream until it expires
+        std::string resolveAudioUrl(const std::string& params, std::chrono::seconds minRemaining);
+        // Signed /x/player/wbi/playurl round-trip: every audio stream offered, lossless included
+        std::vector<AudioStreamOption> requestAudioStreams(const std::string& bvid, int64_t cid);
+        // URL of the stream the quality setting and the measured throughput call for
+        std::string pickAudioStream(const std::vector<AudioStreamOption>& streams) const;
     private:
-        // HTTP client instance
+        // Guards the request headers and cookie jar; the client pool has its own locks
         mutable std::mutex m_clientMutex_;
         std::unordered_map<std::string, std::string> headers_;
         // Structured cookie jar. Use a simple vector of Cookie entries keyed by
@@ -149,24 +239,63 @@ namespace network
             std::string sameSite;
         };
         std::vector<Cookie> cookies_;
-        struct ClientEntry {
-            std::string host;
-            std::shared_ptr<httplib::Client> client;
-            bool available = true;
+        // Full request headers by host and the cookie paths the request path falls under,
+        // built on first use and dropped by updateClientCookies_unsafe(). A set is rebuilt
+        // once the first cookie in it expires. Guarded by m_clientMutex_
+        struct HeaderSet {
+            httplib::Headers headers;
+            std::optional<std::chrono::system_clock::time_point> expires;
+        };
+        mutable std::unordered_map<std::string, HeaderSet> header_sets_;
+        // Distinct cookie paths; which of them prefix a request path is all matching needs of it
+        std::vector<std::string> cookie_paths_;
+        // Keep-alive clients per host, borrowed for the duration of one request
+        HttpClientPool client_pool_;
+        // Stream hosts seen lately, newest first, pre-connected at the next start
+        mutable std::mutex m_warmHostsMutex_;
+        std::vector<std::string> warm_hosts_;
+        // Page lists by bvid, persisted under platform_dir_
+        BiliPageCache page_cache_;
+
+        // Resolved audio streams by "bvid=...&cid=...", valid until the CDN deadline
+        struct PlayUrlEntry {
+            std::vector<AudioStreamOption> streams;
+            std::chrono::system_clock::time_point expires;
+            std::string url;    // The stream picked on first use, empty until then
         };
-        // Map from host -> list of client entries for that host. Using a hashmap
-        // makes lookups for a given host O(1) average and groups clients by host.
-        std::unordered_map<std::string, std::vector<ClientEntry>> http_clients;
+        // entry.url, picked now if it hasn't been; m_playUrlMutex_ must be held
+        std::string pinnedAudioStream_unsafe(PlayUrlEntry& entry) const;
+        mutable std::mutex m_playUrlMutex_;
+        std::unordered_map<std::string, PlayUrlEntry> play_urls_;
+        std::unordered_map<std::string, std::shared_future<std::vector<AudioStreamOption>>> play_url_requests_;
+        // Stream choice: the user's preference and the rate asyncDownloadStream() measures
+        std::atomic<AudioQuality> audio_quality_{AudioQuality::Auto};
+        ThroughputEstimator throughput_;
         
-        // WBI signature keys
+        // WBI signature keys. Replaced whole by the refresher, so signers only copy the
+        // pointer under the mutex and sign from an immutable snapshot
         mutable std::mutex m_wbiMutex_;
-        BiliWbiKeys wbi_keys_;
+        mutable std::condition_variable wbi_cv_;
+        std::shared_ptr<const BiliWbiKeys> wbi_keys_;
+        // Failed fetches back off until wbi_retry_at_; wbi_attempts_ lets cold signers
+        // stop waiting as soon as an attempt ends either way
+        std::chrono::system_clock::time_point wbi_retry_at_{};
+        uint64_t wbi_attempts_ = 0;
+        std::thread wbi_refresher_;
         
         // Configuration
         mutable std::mutex m_configureMutex_;
         std::string platform_dir_; // where to load/save config files
         int timeout_seconds_; // request timeout in seconds
         bool follow_location_; 
+        std::atomic<bool> compression_enabled_{true};
+
+        // Totals behind apiTraffic()
+        std::atomic<uint64_t> api_responses_{0};
+        std::atomic<uint64_t> api_wire_bytes_{0};
+        std::atomic<uint64_t> api_decoded_bytes_{0};
+        // Behind requestMetrics()
+        RequestMetrics request_metrics_;
 
         // Single shutdown/exit flag for async tasks to observe object lifetime
         std::atomic<bool> exitFlag_{false};
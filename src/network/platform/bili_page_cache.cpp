@@ -0,0 +1,170 @@
+#include "bili_page_cache.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <json/json.h>
+#include <log/log_manager.h>
+
+using namespace network;
+
+BiliPageCache::BiliPageCache(std::chrono::seconds ttl)
+    : ttl_(ttl) {
+}
+
+void BiliPageCache::setDirectory(const std::string& directory) {
+    std::scoped_lock lock(mutex_);
+    if (directory == directory_) return;
+    directory_ = directory;
+    // Read the new file on next use and merge it under what is already in memory
+    loaded_ = false;
+}
+
+void BiliPageCache::setTtl(std::chrono::seconds ttl) {
+    std::scoped_lock lock(mutex_);
+    ttl_ = ttl;
+}
+
+std::optional<std::vector<BilibiliPageInfo>> BiliPageCache::get(const std::string& bvid) {
+    std::scoped_lock lock(mutex_);
+    loadIfNeeded_unsafe();
+    auto it = entries_.find(bvid);
+    if (it == entries_.end() || expired_unsafe(it->second, std::chrono::system_clock::now())) {
+        return std::nullopt;
+    }
+    return it->second.pages;
+}
+
+void BiliPageCache::put(const std::string& bvid, std::vector<BilibiliPageInfo> pages) {
+    bool flush = false;
+    {
+        std::scoped_lock lock(mutex_);
+        if (ttl_.count() <= 0) return;
+        loadIfNeeded_unsafe();
+        entries_[bvid] = Entry{ std::move(pages), std::chrono::system_clock::now() };
+        flush = ++unsaved_ >= SAVE_EVERY && !directory_.empty();
+    }
+    if (flush) {
+        save();
+    }
+}
+
+bool BiliPageCache::save() {
+    std::scoped_lock fileLock(file_mutex_);
+    std::string content;
+    std::string path;
+    {
+        std::scoped_lock lock(mutex_);
+        if (directory_.empty() || unsaved_ == 0) return true;
+        // Keep entries that were on disk but never read this session
+        loadIfNeeded_unsafe();
+        content = serialize_unsafe();
+        path = filePath_unsafe();
+        unsaved_ = 0;
+    }
+
+    // Write a sibling file and swap it in so a crash never leaves a truncated cache
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARN("Failed to open page cache for writing: {}", tempPath);
+            return false;
+        }
+        file << content;
+        if (!file) {
+            LOG_WARN("Failed to write page cache: {}", tempPath);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        LOG_WARN("Failed to replace page cache {}: {}", path, ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+size_t BiliPageCache::size() const {
+    std::scoped_lock lock(mutex_);
+    return entries_.size();
+}
+
+/*************** Private Methods ***************/
+void BiliPageCache::loadIfNeeded_unsafe() {
+    if (loaded_) return;
+    loaded_ = true;
+    if (directory_.empty()) return;
+
+    std::ifstream file(filePath_unsafe(), std::ios::binary);
+    if (!file.is_open()) return;   // No cache yet
+
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(file, root) || !root.isObject()) {
+        LOG_WARN("Ignoring unreadable page cache: {}", filePath_unsafe());
+        return;
+    }
+
+    const auto now = std::chrono::system_clock::now();
+    const Json::Value& entries = root["entries"];
+    for (const auto& bvid : entries.getMemberNames()) {
+        // Entries fetched this session are newer than anything on disk
+        if (entries_.count(bvid)) continue;
+        const Json::Value& item = entries[bvid];
+        Entry entry;
+        entry.fetched = std::chrono::system_clock::from_time_t(static_cast<std::time_t>(item["fetched"].asInt64()));
+        if (expired_unsafe(entry, now)) continue;
+        for (const auto& page : item["pages"]) {
+            BilibiliPageInfo info;
+            info.cid = page["cid"].asInt64();
+            info.page = page["page"].asInt();
+            info.part = page["part"].asString();
+            info.duration = page["duration"].asInt();
+            info.firstFrame = page["first_frame"].asString();
+            entry.pages.push_back(std::move(info));
+        }
+        entries_.emplace(bvid, std::move(entry));
+    }
+}
+
+bool BiliPageCache::expired_unsafe(const Entry& entry, std::chrono::system_clock::time_point now) const {
+    return ttl_.count() <= 0 || now - entry.fetched > ttl_;
+}
+
+std::string BiliPageCache::serialize_unsafe() {
+    const auto now = std::chrono::system_clock::now();
+    Json::Value root;
+    Json::Value& entries = root["entries"];
+    entries = Json::Value(Json::objectValue);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (expired_unsafe(it->second, now)) {
+            it = entries_.erase(it);
+            continue;
+        }
+        Json::Value item;
+        item["fetched"] = static_cast<Json::Int64>(std::chrono::system_clock::to_time_t(it->second.fetched));
+        Json::Value& pages = item["pages"];
+        pages = Json::Value(Json::arrayValue);
+        for (const auto& info : it->second.pages) {
+            Json::Value page;
+            page["cid"] = static_cast<Json::Int64>(info.cid);
+            page["page"] = info.page;
+            page["part"] = info.part;
+            page["duration"] = info.duration;
+            page["first_frame"] = info.firstFrame;
+            pages.append(page);
+        }
+        entries[it->first] = item;
+        ++it;
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    return Json::writeString(builder, root);
+}
+
+std::string BiliPageCache::filePath_unsafe() const {
+    return directory_ + '/' + FILE_NAME;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace network
+{
+    struct BilibiliPageInfo {
+        int64_t cid; // cid
+        int page; // page number
+        std::string part; // part title
+        int duration; // duration in seconds
+        std::string firstFrame; // page cover
+    };
+
+    /**
+     * @brief Page lists (/x/player/pagelist) by bvid, kept in memory and in a JSON file
+     * under the platform directory so repeated searches skip the API call.
+     *
+     * The file is read on first use, not when the directory is set. Entries older than
+     * the TTL are treated as missing and dropped on load and save. New entries are
+     * written back by save() and, so a crash loses little, every SAVE_EVERY puts.
+     * Without a directory the cache is memory-only. Thread-safe.
+     */
+    class BiliPageCache
+    {
+    public:
+        static constexpr std::chrono::hours DEFAULT_TTL{24 * 7};
+        static constexpr size_t SAVE_EVERY = 32;
+        static constexpr const char* FILE_NAME = "bili_page_cache.json";
+
+        explicit BiliPageCache(std::chrono::seconds ttl = DEFAULT_TTL);
+
+        // Where the cache file lives; entries already in memory are kept
+        void setDirectory(const std::string& directory);
+        // 0 disables the cache
+        void setTtl(std::chrono::seconds ttl);
+
+        std::optional<std::vector<BilibiliPageInfo>> get(const std::string& bvid);
+        void put(const std::string& bvid, std::vector<BilibiliPageInfo> pages);
+
+        // Write pending entries to disk; true if nothing needed writing or it succeeded
+        bool save();
+
+        // Entries in memory, expired ones included
+        size_t size() const;
+
+    private:
+        struct Entry {
+            std::vector<BilibiliPageInfo> pages;
+            std::chrono::system_clock::time_point fetched;
+        };
+
+        void loadIfNeeded_unsafe();
+        bool expired_unsafe(const Entry& entry, std::chrono::system_clock::time_point now) const;
+        // Serialized cache file content, expired entries left out
+        std::string serialize_unsafe();
+        std::string filePath_unsafe() const;
+
+        mutable std::mutex mutex_;
+        std::mutex file_mutex_;         // Serializes writers of the cache file
+        std::unordered_map<std::string, Entry> entries_;
+        std::string directory_;
+        std::chrono::seconds ttl_;
+        bool loaded_ = false;
+        size_t unsaved_ = 0;
+    };
+} // namespace network
@@ -73,6 +73,15 @@ namespace network
 
         QString interfaceData;  // Reserved for raw interface data storage
     };
+    /**
+     * @brief Size and validators of a remote stream, used to tell whether a partial
+     * download still belongs to the same resource
+     */
+    struct StreamInfo {
+        uint64_t size = 0;          // 0 if unknown
+        std::string etag;           // Empty if the server sent none
+        std::string lastModified;
+    };
     /**
      * @brief Abstract base interface for platform-specific network operations
      *
@@ -145,6 +154,19 @@ namespace network
          * @return Vector of platform-specific video info structures
          */
         virtual std::vector<SearchResult> searchByTitle(const std::string& title, int page) = 0;
+
+        // Receives one batch of results; return false to stop the search
+        using SearchBatchCallback = std::function<bool(std::vector<SearchResult>&& batch)>;
+        /**
+         * @brief Streaming variant of searchByTitle: results are handed to onBatch as soon
+         *  as they resolve instead of after the whole list is known. Batches arrive in rank
+         *  order, on the calling thread, and concatenated equal what searchByTitle returns.
+         * @param title Search keyword
+         * @param page Page number for paginated results
+         * @param onBatch Called once per non-empty batch
+         * @return Number of results delivered
+         */
+        virtual size_t searchByTitle(const std::string& title, int page, const SearchBatchCallback& onBatch) = 0;
         // ========== Stream URL Methods ==========
 
         /**
@@ -170,11 +192,16 @@ namespace network
          *                         Return true to continue, false to cancel
          * @param progress_callback Optional progress callback: bool(uint64_t current, uint64_t total)
          *                          Return true to continue, false to cancel
+         * @param range_start Byte offset to start from; non-zero values send an HTTP Range request
+         *                    and the body is only delivered if the server honours it (206)
+         * @param range_length Bytes to fetch from range_start, 0 = to the end of the resource
          * @return Future that resolves to true on complete download, false on error/cancellation
          */
         virtual std::future<bool> asyncDownloadStream(
             const std::string& url,
             std::function<bool(const char*, size_t)> content_receiver,
-            std::function<bool(uint64_t, uint64_t)> progress_callback = nullptr) = 0;
+            std::function<bool(uint64_t, uint64_t)> progress_callback = nullptr,
+            uint64_t range_start = 0,
+            uint64_t range_length = 0) = 0;
     };
 }
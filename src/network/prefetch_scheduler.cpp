@@ -0,0 +1,174 @@
+#include "prefetch_scheduler.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+namespace network
+{
+    PrefetchScheduler::PrefetchScheduler(Job job, IdleCheck idle)
+        : job_(std::move(job))
+        , idle_(std::move(idle))
+    {
+        worker_ = std::thread([this]() { workerLoop(); });
+    }
+
+    PrefetchScheduler::~PrefetchScheduler()
+    {
+        shutdown();
+    }
+
+    void PrefetchScheduler::setDiskBudget(uint64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        disk_budget_ = bytes;
+    }
+
+    void PrefetchScheduler::setPlan(std::vector<Item> items)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::unordered_set<std::string> planned;
+            queue_.clear();
+            for (auto& item : items) {
+                if (!planned.insert(item.savepath).second) {
+                    continue;
+                }
+                if (done_.count(item.savepath) || item.savepath == running_) {
+                    continue;
+                }
+                queue_.push_back(std::move(item));
+            }
+            // Tracks that fell out of the plan are ordinary cache files from now on
+            for (auto it = done_.begin(); it != done_.end();) {
+                it = planned.count(it->first) ? std::next(it) : done_.erase(it);
+            }
+            if (!running_.empty() && !planned.count(running_)) {
+                stop_running_.store(true);
+            }
+            plan_changed_ = true;
+        }
+        wake_.notify_all();
+    }
+
+    void PrefetchScheduler::release(const std::string& savepath)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                    [&](const Item& item) { return item.savepath == savepath; }),
+                     queue_.end());
+        done_.erase(savepath);
+        if (running_ == savepath) {
+            stop_running_.store(true);
+            job_done_.wait(lock, [&]() { return running_ != savepath; });
+        }
+    }
+
+    void PrefetchScheduler::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            stop_running_.store(true);
+        }
+        wake_.notify_all();
+        if (worker_.joinable() && worker_.get_id() != std::this_thread::get_id()) {
+            worker_.join();
+        }
+    }
+
+    size_t PrefetchScheduler::pendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    std::string PrefetchScheduler::running() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    uint64_t PrefetchScheduler::prefetchedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t total = 0;
+        for (const auto& [path, bytes] : done_) {
+            total += bytes;
+        }
+        return total;
+    }
+
+    /*************** Private Methods ***************/
+    void PrefetchScheduler::workerLoop()
+    {
+        const StopCheck stop = [this]() {
+            return stop_running_.load() || !idle_();
+        };
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            if (queue_.empty()) {
+                wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                continue;
+            }
+            // IdleCheck takes the owner's locks, so never call it under ours
+            lock.unlock();
+            const bool idle = idle_();
+            lock.lock();
+            if (stopping_) {
+                break;
+            }
+            if (!idle) {
+                plan_changed_ = false;
+                wake_.wait_for(lock, IDLE_POLL, [this]() { return stopping_ || plan_changed_; });
+                continue;
+            }
+            if (queue_.empty()) {
+                continue;
+            }
+
+            Item item = std::move(queue_.front());
+            queue_.pop_front();
+            const uint64_t budget = budgetLeft_unsafe();
+            if (budget == 0) {
+                continue;   // Full; a release() or a new plan frees room
+            }
+            running_ = item.savepath;
+            stop_running_.store(false);
+            lock.unlock();
+
+            Result result;
+            try {
+                result = job_(item, budget, stop);
+            } catch (...) {
+                result.outcome = Outcome::Failed;
+            }
+
+            lock.lock();
+            // Released or dropped meanwhile: whatever the job did no longer belongs to the plan
+            const bool dropped = stop_running_.load();
+            running_.clear();
+            if (!dropped && !stopping_) {
+                if (result.outcome == Outcome::Done) {
+                    done_[item.savepath] = result.bytes;
+                } else if (result.outcome == Outcome::Interrupted) {
+                    queue_.push_front(std::move(item));
+                }
+            }
+            job_done_.notify_all();
+        }
+        running_.clear();
+        job_done_.notify_all();
+    }
+
+    uint64_t PrefetchScheduler::budgetLeft_unsafe() const
+    {
+        if (disk_budget_ == 0) {
+            return std::numeric_limits<uint64_t>::max();
+        }
+        uint64_t used = 0;
+        for (const auto& [path, bytes] : done_) {
+            used += bytes;
+        }
+        return used < disk_budget_ ? disk_budget_ - used : 0;
+    }
+} // namespace network
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace network
+{
+    /**
+     * @brief Background worker that downloads upcoming tracks while the network is idle.
+     *
+     * The plan is the list of tracks expected to play next, nearest first; each setPlan()
+     * replaces it. Items run one at a time on a dedicated thread through the Job, and only
+     * while IdleCheck reports no live transfer. A job must poll its StopCheck and return
+     * Interrupted when it fires: on a busy network the item goes back to the front of the
+     * queue and resumes once things are quiet again, on a plan change or release() it is
+     * dropped. Completed items count against the disk budget until they are released
+     * (played) or fall out of the plan. All methods are thread-safe.
+     */
+    class PrefetchScheduler
+    {
+    public:
+        struct Item {
+            int platform = 0;           // Boxed network::PlatformType
+            std::string params;
+            std::string savepath;       // Identifies the item
+        };
+        enum class Outcome {
+            Done,           // Cached; bytes is its size on disk
+            Skipped,        // Not worth fetching (already streaming, over budget)
+            Interrupted,    // StopCheck fired
+            Failed
+        };
+        struct Result {
+            Outcome outcome = Outcome::Failed;
+            uint64_t bytes = 0;
+        };
+        using StopCheck = std::function<bool()>;
+        // budgetLeft: disk bytes still available to prefetched tracks
+        using Job = std::function<Result(const Item& item, uint64_t budgetLeft, const StopCheck& stop)>;
+        using IdleCheck = std::function<bool()>;
+
+        // How often a waiting worker asks IdleCheck again
+        static constexpr std::chrono::milliseconds IDLE_POLL{500};
+
+        PrefetchScheduler(Job job, IdleCheck idle);
+        ~PrefetchScheduler();
+
+        PrefetchScheduler(const PrefetchScheduler&) = delete;
+        PrefetchScheduler& operator=(const PrefetchScheduler&) = delete;
+
+        // Bytes that completed prefetches may occupy, 0 for no limit
+        void setDiskBudget(uint64_t bytes);
+        // Replace the plan; already prefetched items are not fetched again
+        void setPlan(std::vector<Item> items);
+        // Forget savepath and stop its job, blocking until the job has returned, so the
+        // caller can open the file itself
+        void release(const std::string& savepath);
+        // Stop the running job and join the worker; later calls are no-ops
+        void shutdown();
+
+        size_t pendingCount() const;
+        // Savepath of the running job, empty if none
+        std::string running() const;
+        // Bytes held by completed prefetches that haven't been released
+        uint64_t prefetchedBytes() const;
+
+    private:
+        void workerLoop();
+        uint64_t budgetLeft_unsafe() const;
+
+        Job job_;
+        IdleCheck idle_;
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable job_done_;
+        std::deque<Item> queue_;
+        std::unordered_map<std::string, uint64_t> done_;   // savepath -> bytes
+        std::string running_;
+        uint64_t disk_budget_ = 0;
+        bool stopping_ = false;
+        bool plan_changed_ = false;
+        std::atomic<bool> stop_running_{false};
+        std::thread worker_;
+    };
+} // namespace network
@@ -0,0 +1,176 @@
+#include "request_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace network;
+
+namespace {
+    uint64_t toMicros(RequestMetrics::Clock::duration duration)
+    {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    }
+}
+
+// ---------------- LatencyHistogram ----------------
+
+void LatencyHistogram::record(uint64_t value)
+{
+    ++counts_[bucketOf(value)];
+    min_ = count_ == 0 ? value : std::min(min_, value);
+    max_ = std::max(max_, value);
+    sum_ += value;
+    ++count_;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (other.count_ == 0) {
+        return;
+    }
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+    count_ += other.count_;
+}
+
+double LatencyHistogram::mean() const
+{
+    return count_ ? static_cast<double>(sum_ / count_) : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    if (count_ == 0) {
+        return 0;
+    }
+    const double clamped = std::clamp(percent, 0.0, 100.0);
+    const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * count_)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            return std::min(bucketHigh(i), max_);
+        }
+    }
+    return max_;
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t value)
+{
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    int top = 0;    // Index of the highest set bit
+    for (int step = 32; step > 0; step /= 2) {
+        if (value >> (top + step)) {
+            top += step;
+        }
+    }
+    // The SUB_BUCKET_BITS bits below the top one pick the step within its power of two
+    const int shift = top - SUB_BUCKET_BITS;
+    const uint64_t sub = (value >> shift) - SUB_BUCKETS;
+    return static_cast<size_t>((shift + 1) * SUB_BUCKETS + sub);
+}
+
+uint64_t LatencyHistogram::bucketHigh(size_t index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    const uint64_t sub = index % SUB_BUCKETS;
+    const uint64_t low = (SUB_BUCKETS + sub) << shift;
+    return low + ((uint64_t{1} << shift) - 1);
+}
+
+// ---------------- Timer ----------------
+
+RequestMetrics::Timer::Timer(RequestMetrics& metrics, std::string endpoint)
+    : metrics_(metrics)
+    , endpoint_(std::move(endpoint))
+    , start_(Clock::now())
+    , sent_(start_)
+{
+}
+
+RequestMetrics::Timer::~Timer()
+{
+    const auto now = Clock::now();
+    Sample sample;
+    // Never leased: the whole request was spent waiting for a client
+    sample.wait = (leased_ ? sent_ : now) - start_;
+    sample.total = now - start_;
+    sample.reachedFirstByte = first_byte_ != Clock::time_point{};
+    if (sample.reachedFirstByte) {
+        sample.firstByte = first_byte_ - sent_;
+    }
+    sample.bytes = bytes_;
+    sample.retries = retries_;
+    sample.newConnection = leased_ && new_connection_;
+    sample.ok = ok_;
+    metrics_.record(endpoint_, sample);
+}
+
+void RequestMetrics::Timer::leased(bool isNew)
+{
+    sent_ = Clock::now();
+    leased_ = true;
+    new_connection_ = isNew;
+}
+
+void RequestMetrics::Timer::firstByte()
+{
+    if (first_byte_ == Clock::time_point{}) {
+        first_byte_ = Clock::now();
+    }
+}
+
+// ---------------- RequestMetrics ----------------
+
+void RequestMetrics::record(const std::string& endpoint, const Sample& sample)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    EndpointStats& stats = endpoints_[endpoint];
+    if (stats.endpoint.empty()) {
+        stats.endpoint = endpoint;
+    }
+    ++stats.requests;
+    if (!sample.ok) {
+        ++stats.failures;
+    }
+    stats.retries += static_cast<uint64_t>(std::max(0, sample.retries));
+    if (sample.newConnection) {
+        ++stats.newConnections;
+    }
+    stats.bytes += sample.bytes;
+    stats.wait.record(toMicros(sample.wait));
+    if (sample.reachedFirstByte) {
+        (sample.newConnection ? stats.firstByteNewConnection : stats.firstByte).record(toMicros(sample.firstByte));
+    }
+    stats.total.record(toMicros(sample.total));
+}
+
+std::vector<RequestMetrics::EndpointStats> RequestMetrics::snapshot() const
+{
+    std::vector<EndpointStats> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(endpoints_.size());
+        for (const auto& pair : endpoints_) {
+            result.push_back(pair.second);
+        }
+    }
+    std::sort(result.begin(), result.end(),
+              [](const EndpointStats& a, const EndpointStats& b) { return a.endpoint < b.endpoint; });
+    return result;
+}
+
+void RequestMetrics::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoints_.clear();
+}
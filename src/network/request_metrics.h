@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace network
+{
+    /**
+     * @brief Distribution of non-negative values in fixed memory, HdrHistogram style.
+     *
+     * Values below SUB_BUCKETS are counted exactly; above that every power of two is split
+     * into SUB_BUCKETS linear steps, so a value is kept to within 1 / SUB_BUCKETS of itself
+     * (12.5%) whatever its magnitude. Not thread-safe; RequestMetrics guards its own.
+     */
+    class LatencyHistogram
+    {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 3;
+        static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+
+        void record(uint64_t value);
+        void merge(const LatencyHistogram& other);
+
+        uint64_t count() const { return count_; }
+        uint64_t min() const { return count_ ? min_ : 0; }
+        uint64_t max() const { return max_; }
+        double mean() const;
+        // Smallest value at least `percent` of the recorded ones are at or below, to bucket
+        // precision (never above max()); 0 when empty
+        uint64_t percentile(double percent) const;
+
+    private:
+        static size_t bucketOf(uint64_t value);
+        // Largest value that falls in bucket index
+        static uint64_t bucketHigh(size_t index);
+
+        std::array<uint64_t, (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS> counts_{};
+        uint64_t count_ = 0;
+        uint64_t min_ = 0;
+        uint64_t max_ = 0;
+        long double sum_ = 0;
+    };
+
+    /**
+     * @brief Per-endpoint timing of HTTP requests: how long the wait for a pooled client,
+     * the first byte and the whole request took, plus bytes, failures and retries.
+     *
+     * httplib connects inside the first request on a client, so DNS, TCP and TLS can't be
+     * timed apart from the request itself; instead time to first byte is kept separately
+     * for new connections, and its difference from the reused-connection figure is the
+     * setup cost. Times are in microseconds. Thread-safe.
+     */
+    class RequestMetrics
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct EndpointStats {
+            std::string endpoint;
+            uint64_t requests = 0;
+            uint64_t failures = 0;
+            uint64_t retries = 0;           // Extra attempts made within a request
+            uint64_t newConnections = 0;
+            uint64_t bytes = 0;             // Body bytes received, as sent on the wire
+            LatencyHistogram wait;          // Until a pooled client was free
+            LatencyHistogram firstByte;     // Request sent to first response byte, reused connection
+            LatencyHistogram firstByteNewConnection;    // Same, connection set up first
+            LatencyHistogram total;         // Whole request, wait and body included
+        };
+
+        /**
+         * @brief Times one request; recorded when it goes out of scope, as a failure unless
+         * succeeded() was called. Call the other methods as the request reaches each stage.
+         */
+        class Timer {
+        public:
+            Timer(RequestMetrics& metrics, std::string endpoint);
+            ~Timer();
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+
+            // A client was borrowed; isNew if it has to connect first
+            void leased(bool isNew);
+            // Response headers or the first body bytes arrived; later calls are ignored
+            void firstByte();
+            void received(uint64_t bytes) { bytes_ += bytes; }
+            void retried() { ++retries_; }
+            void succeeded() { ok_ = true; }
+
+        private:
+            RequestMetrics& metrics_;
+            std::string endpoint_;
+            Clock::time_point start_;
+            Clock::time_point sent_;
+            Clock::time_point first_byte_{};
+            uint64_t bytes_ = 0;
+            int retries_ = 0;
+            bool leased_ = false;
+            bool new_connection_ = false;
+            bool ok_ = false;
+        };
+
+        struct Sample {
+            Clock::duration wait{};
+            Clock::duration firstByte{};
+            Clock::duration total{};
+            uint64_t bytes = 0;
+            int retries = 0;
+            bool newConnection = false;
+            bool ok = false;
+            bool reachedFirstByte = false;  // Failures before a response have no first byte
+        };
+        void record(const std::string& endpoint, const Sample& sample);
+
+        // Every endpoint seen, sorted by name
+        std::vector<EndpointStats> snapshot() const;
+        void reset();
+
+    private:
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, EndpointStats> endpoints_;
+    };
+} // namespace network
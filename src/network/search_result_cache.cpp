@@ -0,0 +1,68 @@
+#include "search_result_cache.h"
+
+using namespace network;
+
+SearchResultCache::SearchResultCache(size_t capacity, std::chrono::seconds ttl)
+    : capacity_(capacity), ttl_(ttl)
+{
+}
+
+std::optional<QList<SearchResult>> SearchResultCache::find(const QString& keyword, int page,
+                                                           uint platformMask, int maxResults)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(makeKey(keyword, page, platformMask));
+    if (it == index_.end()) return std::nullopt;
+
+    const Entry& entry = *it->second;
+    if (std::chrono::steady_clock::now() - entry.stored > ttl_) {
+        lru_.erase(it->second);
+        index_.erase(it);
+        return std::nullopt;
+    }
+    // A search cut off at a smaller limit cannot tell what the next results would be
+    const bool exhausted = entry.results.size() < entry.maxResults;
+    if (maxResults > entry.maxResults && !exhausted) {
+        return std::nullopt;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return entry.results.mid(0, maxResults);
+}
+
+void SearchResultCache::insert(const QString& keyword, int page, uint platformMask, int maxResults,
+                               const QList<SearchResult>& results)
+{
+    if (capacity_ == 0) return;
+    std::string key = makeKey(keyword, page, platformMask);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+    lru_.push_front(Entry{ key, results, maxResults, std::chrono::steady_clock::now() });
+    index_[std::move(key)] = lru_.begin();
+    while (lru_.size() > capacity_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+}
+
+void SearchResultCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+}
+
+size_t SearchResultCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+std::string SearchResultCache::makeKey(const QString& keyword, int page, uint platformMask)
+{
+    return std::to_string(platformMask) + '\n' + std::to_string(page) + '\n'
+        + keyword.trimmed().toCaseFolded().toStdString();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "platform/i_platform.h"
+
+namespace network
+{
+    /**
+     * @brief Small LRU cache of finished searches keyed by (keyword, page, platform mask).
+     *
+     * Entries live for a short TTL, since search rankings drift, and at most `capacity`
+     * are kept. Keywords are compared trimmed and case-folded. An entry remembers the
+     * result limit it was collected with, so it only answers requests it can fully serve:
+     * ones asking for no more results, or any request once the search ran out of results
+     * before reaching its limit. All methods are thread-safe.
+     */
+    class SearchResultCache
+    {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 64;
+        static constexpr std::chrono::seconds DEFAULT_TTL{300};
+
+        explicit SearchResultCache(size_t capacity = DEFAULT_CAPACITY,
+                                   std::chrono::seconds ttl = DEFAULT_TTL);
+
+        SearchResultCache(const SearchResultCache&) = delete;
+        SearchResultCache& operator=(const SearchResultCache&) = delete;
+
+        // Results for the search, at most maxResults, marked most recently used
+        std::optional<QList<SearchResult>> find(const QString& keyword, int page, uint platformMask, int maxResults);
+        // Store the results of a search run with the given result limit
+        void insert(const QString& keyword, int page, uint platformMask, int maxResults,
+                    const QList<SearchResult>& results);
+        void clear();
+        size_t size() const;
+
+        // Identity of a search as the cache sees it: trimmed, case-folded keyword
+        static std::string makeKey(const QString& keyword, int page, uint platformMask);
+
+    private:
+        struct Entry {
+            std::string key;
+            QList<SearchResult> results;
+            int maxResults = 0;
+            std::chrono::steady_clock::time_point stored;
+        };
+
+        mutable std::mutex mutex_;
+        size_t capacity_;
+        std::chrono::seconds ttl_;
+        std::list<Entry> lru_;          // Front is the most recently used
+        std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    };
+} // namespace network
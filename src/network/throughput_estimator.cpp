@@ -0,0 +1,80 @@
+#include "throughput_estimator.h"
+
+using namespace network;
+
+// ---------------- Sampler ----------------
+
+ThroughputEstimator::Sampler::Sampler(ThroughputEstimator& estimator)
+    : estimator_(estimator)
+    , waiting_since_(Clock::now())
+{
+}
+
+ThroughputEstimator::Sampler::~Sampler()
+{
+    if (bytes_ >= MIN_SAMPLE_BYTES) {
+        flush();
+    }
+}
+
+void ThroughputEstimator::Sampler::received(uint64_t bytes)
+{
+    const auto now = Clock::now();
+    // The first chunk's wait is connection setup and time to first byte, not throughput
+    if (first_) {
+        first_ = false;
+    } else {
+        waited_ += now - waiting_since_;
+        bytes_ += bytes;
+    }
+    waiting_since_ = now;
+    if (bytes_ >= SAMPLE_BYTES) {
+        flush();
+    }
+}
+
+void ThroughputEstimator::Sampler::resumed()
+{
+    waiting_since_ = Clock::now();
+}
+
+void ThroughputEstimator::Sampler::flush()
+{
+    estimator_.addSample(bytes_, waited_);
+    bytes_ = 0;
+    waited_ = Clock::duration::zero();
+}
+
+// ---------------- ThroughputEstimator ----------------
+
+void ThroughputEstimator::addSample(uint64_t bytes, Clock::duration elapsed, Clock::time_point now)
+{
+    // Chunks already buffered by the socket arrive back to back; below a millisecond the
+    // rate says nothing
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    if (bytes == 0 || seconds < 0.001) {
+        return;
+    }
+    const double rate = static_cast<double>(bytes) / seconds;
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool fresh = known_ && now - updated_ < STALE_AFTER;
+    rate_ = fresh ? SMOOTHING * rate + (1.0 - SMOOTHING) * rate_ : rate;
+    updated_ = now;
+    known_ = true;
+}
+
+uint64_t ThroughputEstimator::bytesPerSecond(Clock::time_point now) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!known_ || now - updated_ >= STALE_AFTER) {
+        return 0;
+    }
+    return static_cast<uint64_t>(rate_);
+}
+
+void ThroughputEstimator::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    known_ = false;
+    rate_ = 0.0;
+}
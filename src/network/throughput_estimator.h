@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace network
+{
+    /**
+     * @brief Smoothed estimate of the download rate a single connection achieves.
+     *
+     * Transfers feed it through a Sampler, which only counts the time spent waiting for
+     * data: time the receiver spends (and blocks, when a stream's buffer is full and playback
+     * paces the download) is left out, as is the wait for the first byte, so a consumer
+     * reading slowly doesn't make the link look slow. Samples are blended with an
+     * exponential moving average; one older than STALE_AFTER drops the estimate back to
+     * unknown, since the network may have changed since. Thread-safe.
+     */
+    class ThroughputEstimator
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // A sample is taken every SAMPLE_BYTES; shorter transfers count from MIN_SAMPLE_BYTES
+        static constexpr uint64_t SAMPLE_BYTES = 256 * 1024;
+        static constexpr uint64_t MIN_SAMPLE_BYTES = 32 * 1024;
+        static constexpr std::chrono::minutes STALE_AFTER{10};
+        // Weight of the newest sample
+        static constexpr double SMOOTHING = 0.3;
+
+        // Meters one transfer; create it when the request is sent, call received() as each
+        // chunk arrives and resumed() once the receiver has handled it
+        class Sampler {
+        public:
+            explicit Sampler(ThroughputEstimator& estimator);
+            ~Sampler();
+            Sampler(const Sampler&) = delete;
+            Sampler& operator=(const Sampler&) = delete;
+
+            void received(uint64_t bytes);
+            void resumed();
+
+        private:
+            void flush();
+
+            ThroughputEstimator& estimator_;
+            Clock::time_point waiting_since_;
+            Clock::duration waited_{};
+            uint64_t bytes_ = 0;
+            bool first_ = true;
+        };
+
+        // Blend in bytes received over elapsed time spent waiting for them
+        void addSample(uint64_t bytes, Clock::duration elapsed, Clock::time_point now = Clock::now());
+        // Bytes per second, 0 while unknown
+        uint64_t bytesPerSecond(Clock::time_point now = Clock::now()) const;
+        void reset();
+
+    private:
+        mutable std::mutex mutex_;
+        double rate_ = 0.0;
+        Clock::time_point updated_{};
+        bool known_ = false;
+    };
+} // namespace network
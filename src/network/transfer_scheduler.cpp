@@ -0,0 +1,137 @@
+#include "transfer_scheduler.h"
+
+namespace network
+{
+    TransferScheduler::Slot::Slot(Slot&& other) noexcept
+        : owner_(other.owner_)
+        , class_(other.class_)
+    {
+        other.owner_ = nullptr;
+    }
+
+    TransferScheduler::Slot& TransferScheduler::Slot::operator=(Slot&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            owner_ = other.owner_;
+            class_ = other.class_;
+            other.owner_ = nullptr;
+        }
+        return *this;
+    }
+
+    void TransferScheduler::Slot::release()
+    {
+        if (owner_) {
+            owner_->releaseSlot(class_);
+            owner_ = nullptr;
+        }
+    }
+
+    TransferScheduler::TransferScheduler()
+        : limits_{ 0, 2, 4, 2 }
+    {
+    }
+
+    void TransferScheduler::setLimit(TransferClass transferClass, size_t maxActive)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            limits_[index(transferClass)] = maxActive;
+        }
+        changed_.notify_all();
+    }
+
+    size_t TransferScheduler::limit(TransferClass transferClass) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return limits_[index(transferClass)];
+    }
+
+    TransferScheduler::Slot TransferScheduler::acquire(TransferClass transferClass, const std::function<bool()>& cancelled)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!hasRoom_unsafe(transferClass)) {
+            // The callback may take other locks, so never call it under ours
+            lock.unlock();
+            if (cancelled && cancelled()) {
+                return Slot();
+            }
+            lock.lock();
+            changed_.wait_for(lock, POLL, [&]() { return hasRoom_unsafe(transferClass); });
+        }
+        ++active_[index(transferClass)];
+        if (transferClass != TransferClass::Background) {
+            // Lower classes now see themselves preempted
+            changed_.notify_all();
+        }
+        return Slot(this, transferClass);
+    }
+
+    TransferScheduler::Slot TransferScheduler::tryAcquire(TransferClass transferClass)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!hasRoom_unsafe(transferClass)) {
+            return Slot();
+        }
+        ++active_[index(transferClass)];
+        return Slot(this, transferClass);
+    }
+
+    bool TransferScheduler::yield(TransferClass transferClass, const std::function<bool()>& cancelled)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + MAX_PAUSE;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (isPreempted_unsafe(transferClass) && std::chrono::steady_clock::now() < deadline) {
+            lock.unlock();
+            if (cancelled && cancelled()) {
+                return false;
+            }
+            lock.lock();
+            changed_.wait_for(lock, POLL, [&]() { return !isPreempted_unsafe(transferClass); });
+        }
+        lock.unlock();
+        return !(cancelled && cancelled());
+    }
+
+    bool TransferScheduler::isPreempted(TransferClass transferClass) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return isPreempted_unsafe(transferClass);
+    }
+
+    size_t TransferScheduler::activeCount(TransferClass transferClass) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return active_[index(transferClass)];
+    }
+
+    /*************** Private Methods ***************/
+    void TransferScheduler::releaseSlot(TransferClass transferClass)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_[index(transferClass)];
+        }
+        changed_.notify_all();
+    }
+
+    bool TransferScheduler::isPreempted_unsafe(TransferClass transferClass) const
+    {
+        if (transferClass == TransferClass::Playback || transferClass == TransferClass::Search) {
+            return false;
+        }
+        for (size_t i = 0; i < index(transferClass); ++i) {
+            if (active_[i] > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool TransferScheduler::hasRoom_unsafe(TransferClass transferClass) const
+    {
+        const size_t max = limits_[index(transferClass)];
+        return max == 0 || active_[index(transferClass)] < max;
+    }
+} // namespace network
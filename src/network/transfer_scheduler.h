@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+namespace network
+{
+    // Kinds of network work, most important first
+    enum class TransferClass {
+        Playback,       // The stream the player is reading
+        Search,         // Interactive API lookups
+        Cover,          // Cover images
+        Background      // Prefetches and downloads
+    };
+
+    /**
+     * @brief Admission and preemption for network transfers by TransferClass.
+     *
+     * A transfer holds a Slot while it runs; each class has its own concurrency limit
+     * (0 = unlimited) and acquire() blocks while the class is full. Covers and background
+     * work are preempted by any running transfer of a higher class: their receivers call
+     * yield() between chunks and pause there until the higher class is done, so they give
+     * up bandwidth without dropping their connections. Playback and searches are never
+     * paused. All methods are thread-safe.
+     */
+    class TransferScheduler
+    {
+    public:
+        static constexpr size_t CLASS_COUNT = 4;
+        // Cancellation is checked this often while waiting
+        static constexpr std::chrono::milliseconds POLL{100};
+        // A paused transfer lets one chunk through after this long, so servers don't
+        // drop the idle connection
+        static constexpr std::chrono::seconds MAX_PAUSE{15};
+
+        // Occupies one place in its class until destroyed or release()d
+        class Slot {
+        public:
+            Slot() = default;
+            ~Slot() { release(); }
+            Slot(Slot&& other) noexcept;
+            Slot& operator=(Slot&& other) noexcept;
+            Slot(const Slot&) = delete;
+            Slot& operator=(const Slot&) = delete;
+
+            void release();
+            explicit operator bool() const { return owner_ != nullptr; }
+
+        private:
+            friend class TransferScheduler;
+            Slot(TransferScheduler* owner, TransferClass transferClass)
+                : owner_(owner), class_(transferClass) {}
+
+            TransferScheduler* owner_ = nullptr;
+            TransferClass class_ = TransferClass::Background;
+        };
+
+        // Limits start at: playback unlimited, 2 searches, 4 covers, 2 background transfers
+        TransferScheduler();
+
+        TransferScheduler(const TransferScheduler&) = delete;
+        TransferScheduler& operator=(const TransferScheduler&) = delete;
+
+        void setLimit(TransferClass transferClass, size_t maxActive);
+        size_t limit(TransferClass transferClass) const;
+
+        /**
+         * @brief Wait for a place in the class.
+         * @param cancelled Polled while waiting; may be empty
+         * @return An empty Slot if cancelled returned true first
+         */
+        Slot acquire(TransferClass transferClass, const std::function<bool()>& cancelled = nullptr);
+        // Take a place only if one is free right now
+        Slot tryAcquire(TransferClass transferClass);
+
+        /**
+         * @brief Pause while the class is preempted, at most MAX_PAUSE.
+         * @return false if cancelled returned true first
+         */
+        bool yield(TransferClass transferClass, const std::function<bool()>& cancelled = nullptr);
+
+        // A higher class is transferring, so transfers of this class should pause
+        bool isPreempted(TransferClass transferClass) const;
+        size_t activeCount(TransferClass transferClass) const;
+
+    private:
+        void releaseSlot(TransferClass transferClass);
+        bool isPreempted_unsafe(TransferClass transferClass) const;
+        bool hasRoom_unsafe(TransferClass transferClass) const;
+        static size_t index(TransferClass transferClass) { return static_cast<size_t>(transferClass); }
+
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        size_t limits_[CLASS_COUNT];
+        size_t active_[CLASS_COUNT] = {};
+    };
+} // namespace network
@@ -0,0 +1,373 @@
+#include "binary_snapshot.h"
+#include <log/log_manager.h>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+using namespace playlist;
+
+namespace {
+    constexpr char MAGIC[8] = { 'B', 'P', 'L', 'I', 'B', 'R', 'A', 'R' };
+    // Written in native order; read back as another value on a machine of the other order
+    constexpr uint32_t BYTE_ORDER = 0x01020304;
+    constexpr uint32_t SONG_LOUDNESS_ANALYZED = 1u << 0;
+
+    struct StringRef {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t journalSeq;
+        uint8_t currentPlaylist[16];
+        uint32_t categoryCount;
+        uint32_t playlistCount;
+        uint32_t songCount;
+        uint32_t stringBytes;
+        uint64_t categoriesOffset;
+        uint64_t playlistsOffset;
+        uint64_t songsOffset;
+        uint64_t indexOffset;
+        uint64_t stringsOffset;
+    };
+
+    struct CategoryRecord {
+        uint8_t uuid[16];
+        StringRef name;
+        uint32_t firstPlaylist;
+        uint32_t playlistCount;
+    };
+
+    struct PlaylistRecord {
+        uint8_t uuid[16];
+        StringRef name;
+        StringRef creator;
+        StringRef description;
+        StringRef coverUri;
+        uint32_t firstSong;
+        uint32_t songCount;
+    };
+
+    struct SongRecord {
+        uint8_t uuid[16];
+        StringRef title;
+        StringRef uploader;
+        StringRef filepath;
+        StringRef coverName;
+        StringRef args;
+        int32_t platform;
+        int32_t duration;
+        float loudnessGainDb;
+        uint32_t flags;
+    };
+
+    // The layout is the file format: no padding, sizes keep every record array 8-byte aligned
+    static_assert(sizeof(Header) == 96 && std::is_trivially_copyable_v<Header>);
+    static_assert(sizeof(CategoryRecord) == 32 && std::is_trivially_copyable_v<CategoryRecord>);
+    static_assert(sizeof(PlaylistRecord) == 56 && std::is_trivially_copyable_v<PlaylistRecord>);
+    static_assert(sizeof(SongRecord) == 72 && std::is_trivially_copyable_v<SongRecord>);
+
+    uint64_t align8(uint64_t offset)
+    {
+        return (offset + 7) & ~uint64_t(7);
+    }
+
+    void putUuid(uint8_t* out, const QUuid& uuid)
+    {
+        const QByteArray bytes = uuid.toRfc4122();
+        std::memcpy(out, bytes.constData(), 16);
+    }
+
+    QUuid getUuid(const uint8_t* in)
+    {
+        return QUuid::fromRfc4122(QByteArray::fromRawData(reinterpret_cast<const char*>(in), 16));
+    }
+
+    // UTF-8 strings appended once each; uploaders and cover names repeat a lot
+    class StringTable {
+    public:
+        StringRef add(const QString& text)
+        {
+            if (text.isEmpty()) {
+                return StringRef{ 0, 0 };
+            }
+            auto it = refs_.constFind(text);
+            if (it != refs_.constEnd()) {
+                return it.value();
+            }
+            const QByteArray utf8 = text.toUtf8();
+            const StringRef ref{ static_cast<uint32_t>(bytes_.size()), static_cast<uint32_t>(utf8.size()) };
+            bytes_.append(utf8.constData(), static_cast<size_t>(utf8.size()));
+            refs_.insert(text, ref);
+            return ref;
+        }
+
+        const std::string& bytes() const { return bytes_; }
+
+    private:
+        std::string bytes_;
+        QHash<QString, StringRef> refs_;
+    };
+
+    const Header& headerOf(const util::MappedFile& file)
+    {
+        return *reinterpret_cast<const Header*>(file.data());
+    }
+
+    template <typename T>
+    const T* section(const util::MappedFile& file, uint64_t offset)
+    {
+        return reinterpret_cast<const T*>(file.data() + offset);
+    }
+}
+
+bool BinarySnapshot::write(const QString& path, const LibraryContents& contents, uint64_t journalSeq)
+{
+    std::vector<CategoryRecord> categories;
+    std::vector<PlaylistRecord> playlists;
+    std::vector<SongRecord> songs;
+    StringTable strings;
+    categories.reserve(static_cast<size_t>(contents.categories.size()));
+    for (const CategoryInfo& category : contents.categories) {
+        CategoryRecord categoryRecord{};
+        putUuid(categoryRecord.uuid, category.uuid);
+        categoryRecord.name = strings.add(category.name);
+        categoryRecord.firstPlaylist = static_cast<uint32_t>(playlists.size());
+        for (const PlaylistInfo& playlist : contents.playlists.value(category.uuid)) {
+            PlaylistRecord playlistRecord{};
+            putUuid(playlistRecord.uuid, playlist.uuid);
+            playlistRecord.name = strings.add(playlist.name);
+            playlistRecord.creator = strings.add(playlist.creator);
+            playlistRecord.description = strings.add(playlist.description);
+            playlistRecord.coverUri = strings.add(playlist.coverUri);
+            playlistRecord.firstSong = static_cast<uint32_t>(songs.size());
+            for (const SongInfo& song : contents.songs.value(playlist.uuid)) {
+                SongRecord songRecord{};
+                putUuid(songRecord.uuid, song.uuid);
+                songRecord.title = strings.add(song.title);
+                songRecord.uploader = strings.add(song.uploader);
+                songRecord.filepath = strings.add(song.filepath);
+                songRecord.coverName = strings.add(song.coverName);
+                songRecord.args = strings.add(song.args);
+                songRecord.platform = song.platform;
+                songRecord.duration = song.duration;
+                songRecord.loudnessGainDb = song.loudnessGainDb;
+                songRecord.flags = song.loudnessAnalyzed ? SONG_LOUDNESS_ANALYZED : 0;
+                songs.push_back(songRecord);
+            }
+            playlistRecord.songCount = static_cast<uint32_t>(songs.size()) - playlistRecord.firstSong;
+            playlists.push_back(playlistRecord);
+        }
+        categoryRecord.playlistCount = static_cast<uint32_t>(playlists.size()) - categoryRecord.firstPlaylist;
+        categories.push_back(categoryRecord);
+    }
+    if (strings.bytes().size() > UINT32_MAX) {
+        LOG_ERROR("Playlist library too large for a binary snapshot: {} bytes of text", strings.bytes().size());
+        return false;
+    }
+
+    std::vector<uint32_t> index(playlists.size());
+    std::iota(index.begin(), index.end(), 0u);
+    std::sort(index.begin(), index.end(), [&playlists](uint32_t a, uint32_t b) {
+        return std::memcmp(playlists[a].uuid, playlists[b].uuid, 16) < 0;
+    });
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER;
+    header.journalSeq = journalSeq;
+    putUuid(header.currentPlaylist, contents.currentPlaylistId);
+    header.categoryCount = static_cast<uint32_t>(categories.size());
+    header.playlistCount = static_cast<uint32_t>(playlists.size());
+    header.songCount = static_cast<uint32_t>(songs.size());
+    header.stringBytes = static_cast<uint32_t>(strings.bytes().size());
+    header.categoriesOffset = align8(sizeof(Header));
+    header.playlistsOffset = align8(header.categoriesOffset + categories.size() * sizeof(CategoryRecord));
+    header.songsOffset = align8(header.playlistsOffset + playlists.size() * sizeof(PlaylistRecord));
+    header.indexOffset = align8(header.songsOffset + songs.size() * sizeof(SongRecord));
+    header.stringsOffset = align8(header.indexOffset + index.size() * sizeof(uint32_t));
+
+    std::string out(header.stringsOffset + strings.bytes().size(), '\0');
+    auto put = [&out](uint64_t offset, const void* data, size_t size) {
+        if (size > 0) {
+            std::memcpy(&out[offset], data, size);
+        }
+    };
+    put(0, &header, sizeof(Header));
+    put(header.categoriesOffset, categories.data(), categories.size() * sizeof(CategoryRecord));
+    put(header.playlistsOffset, playlists.data(), playlists.size() * sizeof(PlaylistRecord));
+    put(header.songsOffset, songs.data(), songs.size() * sizeof(SongRecord));
+    put(header.indexOffset, index.data(), index.size() * sizeof(uint32_t));
+    put(header.stringsOffset, strings.bytes().data(), strings.bytes().size());
+
+    // Replace the file only once fully written, so a crash leaves the old snapshot
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(out.data(), static_cast<qint64>(out.size())) != static_cast<qint64>(out.size())
+        || !file.commit()) {
+        LOG_ERROR("Failed to write playlist snapshot {}: {}", path.toStdString(), file.errorString().toStdString());
+        return false;
+    }
+    return true;
+}
+
+bool BinarySnapshot::open(const std::string& path)
+{
+    if (!file_.open(path)) {
+        return false;
+    }
+    auto reject = [this, &path](const char* reason) {
+        LOG_WARN("Ignoring playlist snapshot {}: {}", path, reason);
+        file_.close();
+        return false;
+    };
+    if (file_.size() < sizeof(Header)) {
+        return reject("truncated");
+    }
+    const Header& h = headerOf(file_);
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return reject("not a playlist snapshot");
+    }
+    if (h.version != VERSION || h.byteOrder != BYTE_ORDER) {
+        return reject("written by another version or machine");
+    }
+    // Sections must be aligned and lie within the file; records are checked as they are read
+    const uint64_t size = file_.size();
+    auto fits = [size](uint64_t offset, uint64_t count, uint64_t recordSize) {
+        return offset % 8 == 0 && offset <= size && count <= (size - offset) / recordSize;
+    };
+    if (!fits(h.categoriesOffset, h.categoryCount, sizeof(CategoryRecord))
+        || !fits(h.playlistsOffset, h.playlistCount, sizeof(PlaylistRecord))
+        || !fits(h.songsOffset, h.songCount, sizeof(SongRecord))
+        || !fits(h.indexOffset, h.playlistCount, sizeof(uint32_t))
+        || !fits(h.stringsOffset, h.stringBytes, 1)) {
+        return reject("damaged");
+    }
+    return true;
+}
+
+uint64_t BinarySnapshot::journalSeq() const
+{
+    return isOpen() ? headerOf(file_).journalSeq : 0;
+}
+
+QUuid BinarySnapshot::currentPlaylistId() const
+{
+    return isOpen() ? getUuid(headerOf(file_).currentPlaylist) : QUuid();
+}
+
+int BinarySnapshot::categoryCount() const
+{
+    return isOpen() ? static_cast<int>(headerOf(file_).categoryCount) : 0;
+}
+
+CategoryInfo BinarySnapshot::category(int index) const
+{
+    CategoryInfo category;
+    if (index < 0 || index >= categoryCount()) {
+        return category;
+    }
+    const CategoryRecord& record = section<CategoryRecord>(file_, headerOf(file_).categoriesOffset)[index];
+    category.uuid = getUuid(record.uuid);
+    category.name = string(record.name.offset, record.name.size);
+    return category;
+}
+
+std::pair<int, int> BinarySnapshot::categoryPlaylists(int index) const
+{
+    if (index < 0 || index >= categoryCount()) {
+        return { 0, 0 };
+    }
+    const Header& h = headerOf(file_);
+    const CategoryRecord& record = section<CategoryRecord>(file_, h.categoriesOffset)[index];
+    if (record.firstPlaylist > h.playlistCount) {
+        return { 0, 0 };
+    }
+    const uint32_t count = std::min(record.playlistCount, h.playlistCount - record.firstPlaylist);
+    return { static_cast<int>(record.firstPlaylist), static_cast<int>(count) };
+}
+
+PlaylistInfo BinarySnapshot::playlist(int index) const
+{
+    PlaylistInfo playlist;
+    if (!isOpen() || index < 0 || static_cast<uint32_t>(index) >= headerOf(file_).playlistCount) {
+        return playlist;
+    }
+    const PlaylistRecord& record = section<PlaylistRecord>(file_, headerOf(file_).playlistsOffset)[index];
+    playlist.uuid = getUuid(record.uuid);
+    playlist.name = string(record.name.offset, record.name.size);
+    playlist.creator = string(record.creator.offset, record.creator.size);
+    playlist.description = string(record.description.offset, record.description.size);
+    playlist.coverUri = string(record.coverUri.offset, record.coverUri.size);
+    return playlist;
+}
+
+int BinarySnapshot::findPlaylist(const QUuid& playlistId) const
+{
+    if (!isOpen()) {
+        return -1;
+    }
+    const Header& h = headerOf(file_);
+    const PlaylistRecord* playlists = section<PlaylistRecord>(file_, h.playlistsOffset);
+    const uint32_t* index = section<uint32_t>(file_, h.indexOffset);
+    uint8_t key[16];
+    putUuid(key, playlistId);
+    const uint32_t* end = index + h.playlistCount;
+    const uint32_t* it = std::lower_bound(index, end, key, [&](uint32_t record, const uint8_t* uuid) {
+        return record < h.playlistCount && std::memcmp(playlists[record].uuid, uuid, 16) < 0;
+    });
+    if (it == end || *it >= h.playlistCount || std::memcmp(playlists[*it].uuid, key, 16) != 0) {
+        return -1;
+    }
+    return static_cast<int>(*it);
+}
+
+QList<SongInfo> BinarySnapshot::songs(int playlistIndex) const
+{
+    QList<SongInfo> songs;
+    if (!isOpen() || playlistIndex < 0 || static_cast<uint32_t>(playlistIndex) >= headerOf(file_).playlistCount) {
+        return songs;
+    }
+    const Header& h = headerOf(file_);
+    const PlaylistRecord& playlist = section<PlaylistRecord>(file_, h.playlistsOffset)[playlistIndex];
+    if (playlist.firstSong > h.songCount) {
+        return songs;
+    }
+    const uint32_t count = std::min(playlist.songCount, h.songCount - playlist.firstSong);
+    const SongRecord* records = section<SongRecord>(file_, h.songsOffset) + playlist.firstSong;
+    songs.reserve(static_cast<int>(count));
+    for (uint32_t i = 0; i < count; ++i) {
+        const SongRecord& record = records[i];
+        SongInfo song;
+        song.uuid = getUuid(record.uuid);
+        song.title = string(record.title.offset, record.title.size);
+        song.uploader = string(record.uploader.offset, record.uploader.size);
+        song.filepath = string(record.filepath.offset, record.filepath.size);
+        song.coverName = string(record.coverName.offset, record.coverName.size);
+        song.args = string(record.args.offset, record.args.size);
+        song.platform = record.platform;
+        song.duration = record.duration;
+        song.loudnessGainDb = record.loudnessGainDb;
+        song.loudnessAnalyzed = (record.flags & SONG_LOUDNESS_ANALYZED) != 0;
+        songs.append(song);
+    }
+    return songs;
+}
+
+QString BinarySnapshot::string(uint32_t offset, uint32_t size) const
+{
+    const Header& h = headerOf(file_);
+    if (size == 0 || offset > h.stringBytes || size > h.stringBytes - offset) {
+        return QString();
+    }
+    const auto* text = reinterpret_cast<const char*>(file_.data() + h.stringsOffset + offset);
+    return QString::fromUtf8(text, static_cast<qsizetype>(size));
+}
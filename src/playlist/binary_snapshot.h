@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QList>
+#include <QUuid>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <util/mapped_file.h>
+#include "playlist.h"
+
+namespace playlist
+{
+    /**
+     * @brief The library as one memory-mapped file, read in place without parsing; the
+     * alternative to the JSON snapshot under PlaylistManager's journal.
+     *
+     * Layout, native byte order (checked through the header), every section 8-byte aligned:
+     *
+     *     Header | CategoryRecord[] | PlaylistRecord[] | SongRecord[]
+     *            | uint32 playlist index, sorted by uuid | string table (UTF-8)
+     *
+     * Records have a fixed size. A category's playlists and a playlist's songs are
+     * consecutive ranges of records, in order; strings are (offset, size) in the table,
+     * with equal strings stored once. open() maps the file and checks the header and the
+     * section bounds only, so it costs the same whatever the library holds; accessors
+     * check the ranges and strings they read and make QStrings only then.
+     * Thread-safe once opened.
+     */
+    class BinarySnapshot
+    {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        // Write contents to path, replacing it once complete
+        static bool write(const QString& path, const LibraryContents& contents, uint64_t journalSeq);
+
+        // Map the file at path (UTF-8); false if missing, of another version or damaged
+        bool open(const std::string& path);
+        bool isOpen() const { return file_.isOpen(); }
+
+        uint64_t journalSeq() const;
+        QUuid currentPlaylistId() const;
+
+        int categoryCount() const;
+        CategoryInfo category(int index) const;
+        // Playlist record indices of a category, in order: first and count
+        std::pair<int, int> categoryPlaylists(int index) const;
+        PlaylistInfo playlist(int index) const;
+        // Record index of the playlist, by binary search in the uuid index; -1 if absent
+        int findPlaylist(const QUuid& playlistId) const;
+        QList<SongInfo> songs(int playlistIndex) const;
+
+    private:
+        // A string of the table; empty if out of its bounds
+        QString string(uint32_t offset, uint32_t size) const;
+
+        util::MappedFile file_;
+    };
+} // namespace playlist
@@ -0,0 +1,176 @@
+#include "local_metadata_cache.h"
+#include <log/log_manager.h>
+#include <json/json.h>
+#include <QDateTime>
+#include <QSaveFile>
+#include <fstream>
+
+using namespace playlist;
+
+namespace {
+    qint64 modifiedMs(const QFileInfo& file)
+    {
+        return file.lastModified().toMSecsSinceEpoch();
+    }
+}
+
+std::optional<LocalFileMetadata> LocalMetadataCache::lookup(const QFileInfo& file) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.constFind(file.absoluteFilePath());
+    if (it == files_.constEnd() || it->size != file.size() || it->modifiedMs != modifiedMs(file)) {
+        return std::nullopt;
+    }
+    return it->entry;
+}
+
+bool LocalMetadataCache::contains(const QString& path) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_.contains(path);
+}
+
+void LocalMetadataCache::store(const QFileInfo& file, const LocalFileMetadata& entry)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.insert(file.absoluteFilePath(), Record{ file.size(), modifiedMs(file), entry });
+    dirty_ = true;
+}
+
+void LocalMetadataCache::remove(const QString& path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (files_.remove(path) > 0) {
+        dirty_ = true;
+    }
+}
+
+QHash<QString, QUuid> LocalMetadataCache::folders() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return folders_;
+}
+
+void LocalMetadataCache::addFolder(const QString& directory, const QUuid& playlistId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (folders_.value(directory) != playlistId) {
+        folders_.insert(directory, playlistId);
+        dirty_ = true;
+    }
+}
+
+void LocalMetadataCache::removeFolder(const QString& directory)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (folders_.remove(directory) > 0) {
+        dirty_ = true;
+    }
+}
+
+bool LocalMetadataCache::load(const QString& filePath)
+{
+    std::ifstream file(filePath.toStdString(), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::string errs;
+    if (!Json::parseFromStream(builder, file, &root, &errs) || !root.isObject()) {
+        LOG_WARN("Ignoring unreadable local metadata file {}: {}", filePath.toStdString(), errs);
+        return false;
+    }
+
+    QHash<QString, Record> files;
+    const Json::Value& fileValues = root["files"];
+    for (auto it = fileValues.begin(); it != fileValues.end(); ++it) {
+        const Json::Value& value = *it;
+        Record record;
+        record.size = value["size"].asInt64();
+        record.modifiedMs = value["mtime"].asInt64();
+        audio::AudioMetadata& metadata = record.entry.metadata;
+        metadata.durationMs = value.get("duration", Json::Int64(INT_MAX)).asInt64();
+        metadata.artist = QString::fromStdString(value["artist"].asString());
+        metadata.title = QString::fromStdString(value["title"].asString());
+        metadata.album = QString::fromStdString(value["album"].asString());
+        metadata.sampleRate = value["rate"].asInt();
+        metadata.channels = value["channels"].asInt();
+        record.entry.coverName = QString::fromStdString(value["cover"].asString());
+        files.insert(QString::fromStdString(it.name()), std::move(record));
+    }
+    QHash<QString, QUuid> folders;
+    const Json::Value& folderValues = root["folders"];
+    for (auto it = folderValues.begin(); it != folderValues.end(); ++it) {
+        folders.insert(QString::fromStdString(it.name()), QUuid::fromString(QString::fromStdString(it->asString())));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_ = std::move(files);
+    folders_ = std::move(folders);
+    dirty_ = false;
+    LOG_INFO("Loaded metadata of {} local files from {}", files_.size(), filePath.toStdString());
+    return true;
+}
+
+bool LocalMetadataCache::save(const QString& filePath)
+{
+    Json::Value root(Json::objectValue);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_) {
+            return true;
+        }
+        Json::Value& fileValues = root["files"] = Json::Value(Json::objectValue);
+        for (auto it = files_.cbegin(); it != files_.cend(); ++it) {
+            const audio::AudioMetadata& metadata = it->entry.metadata;
+            Json::Value value(Json::objectValue);
+            value["size"] = Json::Int64(it->size);
+            value["mtime"] = Json::Int64(it->modifiedMs);
+            value["duration"] = Json::Int64(metadata.durationMs);
+            value["artist"] = metadata.artist.toStdString();
+            value["title"] = metadata.title.toStdString();
+            value["album"] = metadata.album.toStdString();
+            value["rate"] = metadata.sampleRate;
+            value["channels"] = metadata.channels;
+            value["cover"] = it->entry.coverName.toStdString();
+            fileValues[it.key().toStdString()] = std::move(value);
+        }
+        Json::Value& folderValues = root["folders"] = Json::Value(Json::objectValue);
+        for (auto it = folders_.cbegin(); it != folders_.cend(); ++it) {
+            folderValues[it.key().toStdString()] = it->toString().toStdString();
+        }
+        dirty_ = false;
+    }
+
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    const std::string text = Json::writeString(builder, root);
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_ERROR("Failed to open file for writing: {}", filePath.toStdString());
+        return false;
+    }
+    file.write(text.data(), static_cast<qint64>(text.size()));
+    if (!file.commit()) {
+        LOG_ERROR("Failed to write local metadata to: {}", filePath.toStdString());
+        std::lock_guard<std::mutex> lock(mutex_);
+        dirty_ = true;
+        return false;
+    }
+    return true;
+}
+
+void LocalMetadataCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    dirty_ = dirty_ || !files_.isEmpty() || !folders_.isEmpty();
+    files_.clear();
+    folders_.clear();
+}
+
+int LocalMetadataCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(files_.size());
+}
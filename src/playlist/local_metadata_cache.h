@@ -0,0 +1,59 @@
+#pragma once
+
+#include <QFileInfo>
+#include <QHash>
+#include <QString>
+#include <QUuid>
+#include <mutex>
+#include <optional>
+#include <audio/ffmpeg_probe.h>
+
+namespace playlist
+{
+    // What probing a local file found
+    struct LocalFileMetadata {
+        audio::AudioMetadata metadata;
+        QString coverName;      // File name in the cover cache, empty if the file has none
+    };
+
+    /**
+     * @brief What probing each local file found, kept with the file's size and modification
+     * time so a file is probed again only once it changes.
+     *
+     * Also holds the folders imported into playlists, which PlaylistManager watches and
+     * rescans. Saved to a JSON file of its own; thread-safe, as probes run in parallel.
+     */
+    class LocalMetadataCache
+    {
+    public:
+        // The entry stored for the file, if it hasn't changed on disk since
+        std::optional<LocalFileMetadata> lookup(const QFileInfo& file) const;
+        // Whether the file was probed before, changed on disk since or not
+        bool contains(const QString& path) const;
+        void store(const QFileInfo& file, const LocalFileMetadata& entry);
+        void remove(const QString& path);
+
+        // Imported folder -> playlist it was imported into
+        QHash<QString, QUuid> folders() const;
+        void addFolder(const QString& directory, const QUuid& playlistId);
+        void removeFolder(const QString& directory);
+
+        bool load(const QString& filePath);
+        // Writes only if something changed since loaded or last saved
+        bool save(const QString& filePath);
+        void clear();
+        int size() const;
+
+    private:
+        struct Record {
+            qint64 size = -1;
+            qint64 modifiedMs = 0;
+            LocalFileMetadata entry;
+        };
+
+        mutable std::mutex mutex_;
+        QHash<QString, Record> files_;
+        QHash<QString, QUuid> folders_;
+        bool dirty_ = false;
+    };
+} // namespace playlist
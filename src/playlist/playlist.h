@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <QList>
+#include <QHash>
 #include <QUuid>
 #include <QMetaType>
 
@@ -22,6 +23,8 @@ namespace playlist
         QString coverName;  // Local cover image filename (not including tmp/cover/ path), empty if not available
         QString args;       // Additional arguments or metadata for interface
         QUuid uuid;         // Unique identifier for the song (for SQLite storage in Phase 2)
+        float loudnessGainDb = 0.0f;    // Normalization gain from loudness analysis, valid if loudnessAnalyzed
+        bool loudnessAnalyzed = false;
         bool operator==(const SongInfo& other) const {
             return uuid == other.uuid;
         }
@@ -45,6 +48,14 @@ namespace playlist
             return uuid == other.uuid;
         }
     };
+
+    // The whole library in order, as the storage backends write and read it
+    struct LibraryContents {
+        QList<CategoryInfo> categories;
+        QHash<QUuid, QList<PlaylistInfo>> playlists;    // By category, in order
+        QHash<QUuid, QList<SongInfo>> songs;            // By playlist, in order
+        QUuid currentPlaylistId;
+    };
 }
 
 // Declare metatypes for Qt's type system
@@ -0,0 +1,86 @@
+#include "playlist_json.h"
+#include <json/json.h>
+
+namespace playlist
+{
+    QUuid uuidFromJson(const Json::Value& value)
+    {
+        return QUuid::fromString(QString::fromStdString(value.asString()));
+    }
+
+    Json::Value songToJson(const SongInfo& song)
+    {
+        Json::Value songObj(Json::objectValue);
+        songObj["title"] = song.title.toStdString();
+        songObj["uploader"] = song.uploader.toStdString();
+        songObj["platform"] = song.platform;
+        songObj["duration"] = song.duration;
+        songObj["filepath"] = song.filepath.toStdString();
+        songObj["coverName"] = song.coverName.toStdString();
+        songObj["args"] = song.args.toStdString();
+        songObj["uuid"] = song.uuid.toString().toStdString();
+        if (song.loudnessAnalyzed) {
+            songObj["loudnessGainDb"] = song.loudnessGainDb;
+        }
+        return songObj;
+    }
+
+    SongInfo songFromJson(const Json::Value& songValue)
+    {
+        SongInfo song;
+        song.title = QString::fromStdString(songValue["title"].asString());
+        song.uploader = QString::fromStdString(songValue["uploader"].asString());
+        song.platform = songValue["platform"].asInt();
+        song.duration = songValue["duration"].asInt();
+        song.filepath = QString::fromStdString(songValue["filepath"].asString());
+        song.coverName = QString::fromStdString(songValue["coverName"].asString());
+        song.args = QString::fromStdString(songValue["args"].asString());
+        // Load UUID from JSON or generate new one if not present
+        QString uuidStr = QString::fromStdString(songValue["uuid"].asString());
+        song.uuid = uuidStr.isEmpty() ? QUuid::createUuid() : QUuid::fromString(uuidStr);
+        // Absent until the song has been through loudness analysis
+        if (songValue.isMember("loudnessGainDb")) {
+            song.loudnessGainDb = songValue["loudnessGainDb"].asFloat();
+            song.loudnessAnalyzed = true;
+        }
+        return song;
+    }
+
+    Json::Value playlistToJson(const PlaylistInfo& playlist)
+    {
+        Json::Value playlistObj(Json::objectValue);
+        playlistObj["uuid"] = playlist.uuid.toString().toStdString();
+        playlistObj["name"] = playlist.name.toStdString();
+        playlistObj["creator"] = playlist.creator.toStdString();
+        playlistObj["description"] = playlist.description.toStdString();
+        playlistObj["coverUri"] = playlist.coverUri.toStdString();
+        return playlistObj;
+    }
+
+    PlaylistInfo playlistFromJson(const Json::Value& playlistValue)
+    {
+        PlaylistInfo playlist;
+        playlist.uuid = uuidFromJson(playlistValue["uuid"]);
+        playlist.name = QString::fromStdString(playlistValue["name"].asString());
+        playlist.creator = QString::fromStdString(playlistValue["creator"].asString());
+        playlist.description = QString::fromStdString(playlistValue["description"].asString());
+        playlist.coverUri = QString::fromStdString(playlistValue["coverUri"].asString());
+        return playlist;
+    }
+
+    Json::Value categoryToJson(const CategoryInfo& category)
+    {
+        Json::Value categoryObj(Json::objectValue);
+        categoryObj["uuid"] = category.uuid.toString().toStdString();
+        categoryObj["name"] = category.name.toStdString();
+        return categoryObj;
+    }
+
+    CategoryInfo categoryFromJson(const Json::Value& categoryValue)
+    {
+        CategoryInfo category;
+        category.uuid = uuidFromJson(categoryValue["uuid"]);
+        category.name = QString::fromStdString(categoryValue["name"].asString());
+        return category;
+    }
+} // namespace playlist
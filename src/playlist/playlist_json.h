@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QUuid>
+#include "playlist.h"
+
+namespace Json { class Value; }
+
+namespace playlist
+{
+    // JSON form of the playlist types, shared by the categories snapshot, its journal and
+    // the SQLite store. Playlists are written without their songs
+    QUuid uuidFromJson(const Json::Value& value);
+    Json::Value songToJson(const SongInfo& song);
+    // A song without a uuid gets a new one
+    SongInfo songFromJson(const Json::Value& value);
+    Json::Value playlistToJson(const PlaylistInfo& playlist);
+    PlaylistInfo playlistFromJson(const Json::Value& value);
+    Json::Value categoryToJson(const CategoryInfo& category);
+    CategoryInfo categoryFromJson(const Json::Value& value);
+} // namespace playlist
@@ -5,22 +5,170 @@
 #include <audio/ffmpeg_probe.h>
 #include <audio/taglib_cover.h>
 #include <util/cover_cache.h>
+#include <util/thread_pool.h>
+#include <util/audio_cache_store.h>
+#include "playlist_json.h"
+#include "sqlite_playlist_store.h"
+#include "binary_snapshot.h"
+#include "local_metadata_cache.h"
 #include <json/json.h>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSaveFile>
+#include <QSet>
 #include <QStandardPaths>
 #include <QTimer>
-#include <QRandomGenerator>
 #include <algorithm>
+#include <deque>
+#include <future>
 #include <optional>
 #include <functional>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <fmt/format.h>
-#include <util/md5.h>
+#include <util/hash.h>
+#include <util/idle_mode.h>
+#include <util/json_scanner.h>
+#include <util/trace.h>
 #include <QUrl>
 #include <thread>
+#include <utility>
+
+using playlist::uuidFromJson;
+using playlist::songToJson;
+using playlist::songFromJson;
+using playlist::playlistToJson;
+using playlist::playlistFromJson;
+using playlist::categoryToJson;
+using playlist::categoryFromJson;
+
+namespace {
+    // Parse the next value into object[key]. Used for the small header fields of the
+    // snapshot, so strings, nearly all of them, skip the JSON parser
+    bool readJsonMember(util::JsonScanner& json, std::string_view key, Json::Value& object)
+    {
+        std::string text;
+        if (json.readString(text)) {
+            object[std::string(key)] = text;
+            return true;
+        }
+        std::string_view raw;
+        if (!json.captureValue(raw)) {
+            return false;
+        }
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        Json::Value value;
+        if (!reader->parse(raw.data(), raw.data() + raw.size(), &value, nullptr)) {
+            return false;
+        }
+        object[std::string(key)] = std::move(value);
+        return true;
+    }
+
+    // The songs of a snapshot playlist's raw "songs" array
+    QList<playlist::SongInfo> songsFromJsonText(std::string_view text)
+    {
+        QList<playlist::SongInfo> songs;
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        Json::Value array;
+        std::string errs;
+        if (!reader->parse(text.data(), text.data() + text.size(), &array, &errs) || !array.isArray()) {
+            LOG_ERROR("Unreadable songs in the playlist snapshot: {}", errs);
+            return songs;
+        }
+        songs.reserve(static_cast<int>(array.size()));
+        for (const Json::Value& songValue : array) {
+            songs.append(songFromJson(songValue));
+        }
+        return songs;
+    }
+
+    // Apply a song record (addSong, updateSong, removeSong, setSongLoudness) to one
+    // playlist's songs; false if it found nothing to change
+    bool applySongRecord(QList<playlist::SongInfo>& songs, const Json::Value& record)
+    {
+        const std::string op = record["op"].asString();
+        if (op == "addSong") {
+            songs.append(songFromJson(record["song"]));
+            return true;
+        }
+        if (op == "setSongLoudness") {
+            const QUuid songId = uuidFromJson(record["songId"]);
+            bool found = false;
+            for (auto& song : songs) {
+                if (song.uuid == songId) {
+                    song.loudnessGainDb = record["gainDb"].asFloat();
+                    song.loudnessAnalyzed = true;
+                    found = true;
+                }
+            }
+            return found;
+        }
+        const QUuid songId = op == "removeSong" ? uuidFromJson(record["songId"])
+                                                : uuidFromJson(record["song"]["uuid"]);
+        auto it = std::find_if(songs.begin(), songs.end(),
+            [&songId](const playlist::SongInfo& s) { return s.uuid == songId; });
+        if (it == songs.end()) {
+            return false;
+        }
+        if (op == "removeSong") {
+            songs.erase(it);
+        } else {
+            *it = songFromJson(record["song"]);
+        }
+        return true;
+    }
+
+    // A journal record of op with one field, the change it describes
+    Json::Value change(const char* op, const char* key, Json::Value value)
+    {
+        Json::Value record(Json::objectValue);
+        record["op"] = op;
+        record[key] = std::move(value);
+        return record;
+    }
+
+    Json::Value songChange(const char* op, const playlist::SongInfo& song, const QUuid& playlistId)
+    {
+        Json::Value record = change(op, "song", songToJson(song));
+        record["playlistId"] = playlistId.toString().toStdString();
+        return record;
+    }
+}
+
+// QWriteLocker on m_dataLock that publishes the songs for songsSnapshot() when released
+class PlaylistManager::DataWriteLocker
+{
+public:
+    explicit DataWriteLocker(const PlaylistManager* manager)
+        : m_manager(manager)
+        , m_locker(&manager->m_dataLock)
+    {
+    }
+    ~DataWriteLocker() { unlock(); }
+    DataWriteLocker(const DataWriteLocker&) = delete;
+    DataWriteLocker& operator=(const DataWriteLocker&) = delete;
+    
+    void unlock()
+    {
+        if (m_locked) {
+            m_manager->publishSongs();
+            m_locker.unlock();
+            m_locked = false;
+        }
+    }
+    
+private:
+    const PlaylistManager* m_manager;
+    QWriteLocker m_locker;
+    bool m_locked = true;
+};
 
 PlaylistManager::PlaylistManager(ConfigManager* configManager, QObject* parent)
     : QObject(parent)
@@ -32,12 +180,170 @@ PlaylistManager::PlaylistManager(ConfigManager* configManager, QObject* parent)
         LOG_CRITICAL("PlaylistManager created with null ConfigManager");
         throw std::runtime_error("ConfigManager cannot be null");
     }
+    m_coverCache = std::make_shared<util::CoverCache>(m_configManager);
+    m_localMetadata = std::make_unique<playlist::LocalMetadataCache>();
+    m_folderWatcher = new QFileSystemWatcher(this);
+    connect(m_folderWatcher, &QFileSystemWatcher::directoryChanged, this, &PlaylistManager::onLocalFolderChanged);
+    m_rescanTimer = new QTimer(this);
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(LOCAL_RESCAN_DELAY_MS);
+    connect(m_rescanTimer, &QTimer::timeout, this, &PlaylistManager::rescanPendingFolders);
+    
+    // Keep the search index, once built, in step with the library
+    connect(this, &PlaylistManager::songAdded, this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        if (m_searchIndex) {
+            m_searchIndex->addSong(song, playlistId);
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songUpdated, this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        if (m_searchIndex) {
+            m_searchIndex->addSong(song, playlistId);
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songRemoved, this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        if (m_searchIndex) {
+            m_searchIndex->removeSong(song.uuid, playlistId);
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songsAdded, this, [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId, int) {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        if (m_searchIndex) {
+            for (const playlist::SongInfo& song : songs) {
+                m_searchIndex->addSong(song, playlistId);
+            }
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songsRemoved, this, [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        if (m_searchIndex) {
+            for (const playlist::SongInfo& song : songs) {
+                m_searchIndex->removeSong(song.uuid, playlistId);
+            }
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::playlistRemoved, this, [this](const QUuid& playlistId, const QUuid&) {
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        if (m_searchIndex) {
+            m_searchIndex->removePlaylist(playlistId);
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::categoriesLoaded, this, [this](int, int) {
+        // A new library; the next search indexes it
+        std::lock_guard<std::mutex> lock(m_searchMutex);
+        m_searchIndex.reset();
+    }, Qt::DirectConnection);
+    
+    // And the song identities
+    auto addIdentities = [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_identityMutex);
+        if (m_identities) {
+            for (const playlist::SongInfo& song : songs) {
+                m_identities->addSong(song, playlistId);
+            }
+        }
+    };
+    auto removeIdentities = [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_identityMutex);
+        if (m_identities) {
+            for (const playlist::SongInfo& song : songs) {
+                m_identities->removeSong(song.uuid, playlistId);
+            }
+        }
+    };
+    connect(this, &PlaylistManager::songAdded, this, [addIdentities](const playlist::SongInfo& song, const QUuid& playlistId) {
+        addIdentities({ song }, playlistId);
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songUpdated, this, [addIdentities](const playlist::SongInfo& song, const QUuid& playlistId) {
+        addIdentities({ song }, playlistId);
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songRemoved, this, [removeIdentities](const playlist::SongInfo& song, const QUuid& playlistId) {
+        removeIdentities({ song }, playlistId);
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songsAdded, this, [addIdentities](const QList<playlist::SongInfo>& songs, const QUuid& playlistId, int) {
+        addIdentities(songs, playlistId);
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songsRemoved, this, removeIdentities, Qt::DirectConnection);
+    connect(this, &PlaylistManager::playlistRemoved, this, [this](const QUuid& playlistId, const QUuid&) {
+        std::lock_guard<std::mutex> lock(m_identityMutex);
+        if (m_identities) {
+            m_identities->removePlaylist(playlistId);
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::categoriesLoaded, this, [this](int, int) {
+        std::lock_guard<std::mutex> lock(m_identityMutex);
+        m_identities.reset();
+    }, Qt::DirectConnection);
+    
+    // Songs added join the rest of their playlist's shuffle round; removed ones leave it
+    connect(this, &PlaylistManager::songAdded, this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        auto it = m_shuffleBags.find(playlistId);
+        if (it != m_shuffleBags.end()) {
+            it->second.insert(song.uuid);
+            m_shuffleDirty = true;
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songsAdded, this, [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId, int) {
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        auto it = m_shuffleBags.find(playlistId);
+        if (it != m_shuffleBags.end()) {
+            for (const playlist::SongInfo& song : songs) {
+                it->second.insert(song.uuid);
+            }
+            m_shuffleDirty = true;
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songRemoved, this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        auto it = m_shuffleBags.find(playlistId);
+        if (it != m_shuffleBags.end()) {
+            it->second.remove(song.uuid);
+            m_shuffleDirty = true;
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::songsRemoved, this, [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId) {
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        auto it = m_shuffleBags.find(playlistId);
+        if (it != m_shuffleBags.end()) {
+            for (const playlist::SongInfo& song : songs) {
+                it->second.remove(song.uuid);
+            }
+            m_shuffleDirty = true;
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::playlistRemoved, this, [this](const QUuid& playlistId, const QUuid&) {
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        if (m_shuffleBags.erase(playlistId) > 0 || m_savedShuffleBags.remove(playlistId)) {
+            m_shuffleDirty = true;
+        }
+    }, Qt::DirectConnection);
+    connect(this, &PlaylistManager::categoriesLoaded, this, [this](int, int) {
+        // Bags of the new library are read from its shuffle file again
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        m_shuffleBags.clear();
+        m_savedShuffleBags.clear();
+        m_shuffleFileRead = false;
+        m_shuffleDirty = false;
+    }, Qt::DirectConnection);
     
     LOG_DEBUG("PlaylistManager created");
 }
 
 PlaylistManager::~PlaylistManager()
 {
+    if (m_songPrefetch.joinable()) {
+        m_songPrefetch.join();
+    }
+    cancelLocalImport();
+    if (m_importThread.joinable()) {
+        m_importThread.join();
+    }
+    // Probes still queued are skipped; the running ones finish before the pool is gone
+    m_shuttingDown = true;
+    m_probePool.reset();
     if (m_initialized) {
         LOG_INFO("PlaylistManager destructor: saving all categories before shutdown");
         saveAllCategories();
@@ -63,6 +369,7 @@ void PlaylistManager::initialize()
     try {
         // Ensure playlist directory exists
         ensurePlaylistDirectoryExists();
+        openStore();
         
         // Setup auto-save timer
         setupAutoSave();
@@ -70,6 +377,17 @@ void PlaylistManager::initialize()
         // Load existing categories
         loadCategoriesFromFile();
         
+        // Probed local files, and the folders imported to watch
+        m_localMetadata->load(localMetadataFilePath());
+        const QHash<QString, QUuid> folders = m_localMetadata->folders();
+        for (auto it = folders.cbegin(); it != folders.cend(); ++it) {
+            watchLocalFolder(it.key());
+        }
+        
+        // Playback resumes from the current playlist; have its songs ready by then
+        const QUuid currentPlaylistId = m_currentPlaylistId;
+        m_songPrefetch = std::thread([this, currentPlaylistId]() { ensureSongsLoaded(currentPlaylistId); });
+        
         m_initialized = true;
         LOG_INFO("PlaylistManager initialization complete");
         
@@ -81,9 +399,10 @@ void PlaylistManager::initialize()
 
 bool PlaylistManager::loadCategoriesFromFile()
 {
-    LOG_INFO("Loading categories from JSON file...");
+    TRACE_SCOPE("playlist", "PlaylistManager::loadCategoriesFromFile");
+    LOG_INFO("Loading categories from {}...", m_store ? "the playlist database" : "the snapshot");
     
-    if (loadCategoriesFromJsonFile()) {
+    if (m_store ? loadCategoriesFromStore() : loadCategoriesFromSnapshot()) {
         int totalPlaylists = m_playlists.size();
         
         // Validate current playlist ID after loading
@@ -92,7 +411,7 @@ bool PlaylistManager::loadCategoriesFromFile()
             m_currentPlaylistId = QUuid();
         }
         
-        LOG_INFO("Categories loaded from JSON: {} categories, {} playlists", m_categories.size(), totalPlaylists);
+        LOG_INFO("Categories loaded: {} categories, {} playlists", m_categories.size(), totalPlaylists);
         emit categoriesLoaded(m_categories.size(), totalPlaylists);
         return true;
     }
@@ -111,13 +430,46 @@ void PlaylistManager::saveAllCategories()
     }
     
     LOG_INFO("Saving all categories...");
+    TRACE_SCOPE("playlist", "PlaylistManager::saveAllCategories");
     
-    if (saveCategoriesToJsonFile()) {
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    bool saved = false;
+    if (m_store) {
+        saved = saveChangesToStore();
+    } else {
+        const bool binary = useBinarySnapshot();
+        bool compact = !QFileInfo::exists(binary ? binarySnapshotFilePath() : categoriesFilePath());
+        {
+            std::lock_guard<std::mutex> lock(m_journalMutex);
+            compact = compact || m_journalRecords + static_cast<int>(m_journalPending.size()) >= JOURNAL_COMPACT_RECORDS;
+        }
+        if (compact) {
+            saved = binary ? saveCategoriesToBinaryFile() : saveCategoriesToJsonFile();
+        } else {
+            saved = appendJournal();
+        }
+    }
+    if (saved) {
         int totalPlaylists = m_playlists.size();
         LOG_INFO("Save categories complete: {} categories, {} playlists", m_categories.size(), totalPlaylists);
     } else {
         LOG_ERROR("Failed to save categories");
     }
+    saveShuffleBags();
+    m_localMetadata->save(localMetadataFilePath());
+}
+
+void PlaylistManager::setAudioCacheStore(std::shared_ptr<util::AudioCacheStore> store)
+{
+    DataWriteLocker locker(this);
+    m_audioCacheStore = std::move(store);
+}
+
+void PlaylistManager::setCoverCache(std::shared_ptr<util::CoverCache> cache)
+{
+    if (cache) {
+        m_coverCache = std::move(cache);
+    }
 }
 
 // Category operations
@@ -133,7 +485,7 @@ bool PlaylistManager::addCategory(const playlist::CategoryInfo& category)
         return false;
     }
     
-    QWriteLocker locker(&m_dataLock);
+    DataWriteLocker locker(this);
     if (m_categories.contains(category.uuid)) {
         LOG_ERROR("Category with UUID {} already exists", category.uuid.toString().toStdString());
         return false;
@@ -141,6 +493,7 @@ bool PlaylistManager::addCategory(const playlist::CategoryInfo& category)
     
     m_categories.insert(category.uuid, category);
     m_categoryPlaylists.insert(category.uuid, QList<QUuid>());
+    journal(change("addCategory", "category", categoryToJson(category)));
     locker.unlock(); // Unlock before emitting signal
     
     emit categoryAdded(category);
@@ -176,9 +529,10 @@ bool PlaylistManager::removeCategory(const QUuid& categoryId)
     }
     
     // Remove category itself
-    QWriteLocker writeLocker(&m_dataLock);
+    DataWriteLocker writeLocker(this);
     m_categories.remove(categoryId);
     m_categoryPlaylists.remove(categoryId);
+    journal(change("removeCategory", "categoryId", categoryId.toString().toStdString()));
     writeLocker.unlock();
     
     emit categoryRemoved(categoryId);
@@ -198,13 +552,14 @@ bool PlaylistManager::updateCategory(const playlist::CategoryInfo& category)
         return false;
     }
     
-    QWriteLocker locker(&m_dataLock);
+    DataWriteLocker locker(this);
     if (!m_categories.contains(category.uuid)) {
         LOG_ERROR("Category with UUID {} not found", category.uuid.toString().toStdString());
         return false;
     }
     
     m_categories[category.uuid] = category;
+    journal(change("updateCategory", "category", categoryToJson(category)));
     locker.unlock();
     
     emit categoryUpdated(category);
@@ -248,7 +603,7 @@ bool PlaylistManager::addPlaylist(const playlist::PlaylistInfo& playlist, const
         return false;
     }
     
-    QWriteLocker locker(&m_dataLock);
+    DataWriteLocker locker(this);
     if (m_playlists.contains(playlist.uuid)) {
         LOG_ERROR("Playlist with UUID {} already exists", playlist.uuid.toString().toStdString());
         return false;
@@ -271,6 +626,9 @@ bool PlaylistManager::addPlaylist(const playlist::PlaylistInfo& playlist, const
     
     // Add relationship
     m_categoryPlaylists[targetCategoryId].append(playlist.uuid);
+    Json::Value record = change("addPlaylist", "playlist", playlistToJson(playlist));
+    record["categoryId"] = targetCategoryId.toString().toStdString();
+    journal(record);
     locker.unlock();
     
     emit playlistAdded(playlist, targetCategoryId);
@@ -306,6 +664,7 @@ bool PlaylistManager::removePlaylist(const QUuid& playlistId, const QUuid& categ
         return false;
     }
     
+    DataWriteLocker locker(this);
     // Get playlist info for logging
     auto playlistIt = m_playlists.find(playlistId);
     QString playlistName = (playlistIt != m_playlists.end()) ? playlistIt.value().name : "Unknown";
@@ -316,6 +675,12 @@ bool PlaylistManager::removePlaylist(const QUuid& playlistId, const QUuid& categ
     // Remove playlist and its songs
     m_playlists.remove(playlistId);
     m_playlistSongs.remove(playlistId);
+    m_unloadedSongs.remove(playlistId);
+    m_deferredSongRecords.remove(playlistId);
+    journal(change("removePlaylist", "playlistId", playlistId.toString().toStdString()));
+    locker.unlock();
+    // Strings only its songs used are no longer shared by anything
+    m_stringPool.prune();
     
     emit playlistRemoved(playlistId, foundCategoryId);
     LOG_INFO("Removed playlist: {} ({}) from category: {}", 
@@ -341,6 +706,7 @@ bool PlaylistManager::updatePlaylist(const playlist::PlaylistInfo& playlist, con
     }
     
     m_playlists[playlist.uuid] = playlist;
+    journal(change("updatePlaylist", "playlist", playlistToJson(playlist)));
     emit playlistUpdated(playlist, categoryId);
     LOG_INFO("Updated playlist: {} ({})", playlist.name.toStdString(), playlist.uuid.toString().toStdString());
     return true;
@@ -383,40 +749,22 @@ bool PlaylistManager::addSongToPlaylist(const playlist::SongInfo& song, const QU
         return false;
     }
     
-    QWriteLocker locker(&m_dataLock);
+    std::optional<playlist::SongInfo> stored = songToStore(song);
+    if (!stored) {
+        // A relative local path is skipped, yet reported added when args are there to fall back on
+        return !song.args.isEmpty();
+    }
+    const playlist::SongInfo& songWithFilepath = *stored;
+    
+    ensureSongsLoaded(playlistId);
+    DataWriteLocker locker(this);
     if (!m_playlists.contains(playlistId)) {
         LOG_ERROR("Playlist with UUID {} not found", playlistId.toString().toStdString());
         return false;
     }
-    playlist::SongInfo songWithFilepath = song;
-    // If the provided filepath is a local file (file:// or absolute path), keep it as a file:// reference
-    QUrl maybeUrl = QUrl::fromUserInput(song.filepath);
-    if (maybeUrl.isLocalFile()) {
-        if (maybeUrl.isRelative()) {
-            LOG_WARN("Provided local file path is relative: {}", song.filepath.toStdString());
-            return songWithFilepath.args.isEmpty() ? false : true;
-        } else {
-            songWithFilepath.filepath = maybeUrl.toLocalFile();
-            // Mark as local media: set platform
-            // Uploader will be extracted from metadata in async probe, default to "local" if not available
-            if (songWithFilepath.uploader.isEmpty()) {
-                songWithFilepath.uploader = "local";
-            }
-            songWithFilepath.platform = static_cast<int>(network::PlatformType::Local);
-            LOG_DEBUG("Marked song as local: {} (platform={})", song.title.toStdString(), songWithFilepath.platform);
-        }
-    } else {
-        // Non-local sources are converted to internal streaming filepaths
-        if (songWithFilepath.args.isEmpty()) {
-            LOG_WARN("Cannot add song with empty args for non-local source: {}", song.filepath.toStdString());
-            return false;
-        } else {
-            songWithFilepath.filepath = generateStreamingFilepath(songWithFilepath);
-        }
-        
-    }
     
     m_playlistSongs[playlistId].append(songWithFilepath);
+    journal(songChange("addSong", songWithFilepath, playlistId));
     
     // Update UUID index with new song (O(1) append)
     int newIndex = m_playlistSongs[playlistId].size() - 1;
@@ -425,119 +773,15 @@ bool PlaylistManager::addSongToPlaylist(const playlist::SongInfo& song, const QU
     auto playlistIt = m_playlists.find(playlistId);
     QString playlistName = (playlistIt != m_playlists.end()) ? playlistIt.value().name : "Unknown";
     
-    // If it's a local file, launch async duration and artist probe
-    QString filepathForProbe;
-    if (static_cast<network::PlatformType>(songWithFilepath.platform) == network::PlatformType::Local) {
-        filepathForProbe = songWithFilepath.filepath;
-    }
-    
     locker.unlock();
     
     // Emit signals
-    emit songAdded(song, playlistId);
+    emit songAdded(songWithFilepath, playlistId);
     emit playlistSongsChanged(playlistId);
     
     // Async metadata probe for local files (non-blocking)
-    if (!filepathForProbe.isEmpty()) {
-        std::thread([this, filepathForProbe, playlistId, song]() {
-            // Probe comprehensive metadata in single pass (duration, artist, sample rate, etc.)
-            audio::AudioMetadata metadata = audio::FFmpegProbe::probeMetadata(filepathForProbe);
-            
-            LOG_DEBUG("Probed metadata for {}: duration={} ms, artist='{}', sampleRate={} Hz", 
-                     filepathForProbe.toStdString(), metadata.durationMs, 
-                     metadata.artist.toStdString(), metadata.sampleRate);
-            
-            // Update the song with probed metadata
-            QWriteLocker updateLocker(&m_dataLock);
-            if (m_playlistSongs.contains(playlistId)) {
-                for (auto& s : m_playlistSongs[playlistId]) {
-                    if (s.filepath == filepathForProbe && s.title == song.title) {
-                        // Update duration (from milliseconds to seconds)
-                        if (metadata.durationMs != INT_MAX) {
-                            s.duration = static_cast<int>(metadata.durationMs / 1000);
-                            LOG_INFO("Updated duration for song: {} = {} ms", s.title.toStdString(), metadata.durationMs);
-                        }
-                        
-                        // Update uploader if artist was found in metadata, otherwise keep default "local"
-                        if (!metadata.artist.isEmpty()) {
-                            s.uploader = metadata.artist;
-                            LOG_INFO("Updated artist for song: {} = '{}'", s.title.toStdString(), metadata.artist.toStdString());
-                        }
-                        
-                        updateLocker.unlock();
-                        emit songUpdated(s, playlistId);
-                        break;
-                    }
-                }
-            }
-            
-            // After duration probe, launch async cover extraction (non-blocking)
-            std::thread([this, filepathForProbe, playlistId, song]() {
-                try {
-                    util::CoverCache coverCache(m_configManager);
-                    
-                    // Check if cover already cached
-                    if (coverCache.hasCachedCover(filepathForProbe)) {
-                        LOG_DEBUG("Cover already cached for {}", filepathForProbe.toStdString());
-                        auto cachedCover = coverCache.getCachedCover(filepathForProbe);
-                        if (cachedCover) {
-                            QWriteLocker updateLocker(&m_dataLock);
-                            if (m_playlistSongs.contains(playlistId)) {
-                                for (auto& s : m_playlistSongs[playlistId]) {
-                                    if (s.filepath == filepathForProbe && s.title == song.title) {
-                                        // Store cache file name for persistence
-                                        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-                                        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
-                                        QString relativeName = QFileInfo(fullCacheDir).fileName() + "/" + 
-                                                               util::md5Hash(filepathForProbe.toStdString()).c_str();
-                                        s.coverName = QString::fromStdString(util::md5Hash(filepathForProbe.toStdString())) + ".jpg";
-                                        LOG_INFO("Set cached cover name for song: {} = {}", s.title.toStdString(), s.coverName.toStdString());
-                                        updateLocker.unlock();
-                                        emit songUpdated(s, playlistId);
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                        return;
-                    }
-                    
-                    // Extract cover using TagLib + FFmpeg fallback
-                    auto coverData = audio::TagLibCoverExtractor::extractCover(filepathForProbe);
-                    if (coverData.empty()) {
-                        LOG_DEBUG("No cover found for {}", filepathForProbe.toStdString());
-                        return;
-                    }
-                    
-                    // Convert to QByteArray for cache
-                    QByteArray coverBytes(reinterpret_cast<const char*>(coverData.data()), coverData.size());
-                    
-                    // Save to cache
-                    auto cachedPath = coverCache.saveCover(filepathForProbe, coverBytes);
-                    if (!cachedPath) {
-                        LOG_WARN("Failed to save cover to cache for {}", filepathForProbe.toStdString());
-                        return;
-                    }
-                    
-                    // Update song with cover name and emit update
-                    QWriteLocker updateLocker(&m_dataLock);
-                    if (m_playlistSongs.contains(playlistId)) {
-                        for (auto& s : m_playlistSongs[playlistId]) {
-                            if (s.filepath == filepathForProbe && s.title == song.title) {
-                                // Store just the filename for persistence
-                                s.coverName = QFileInfo(*cachedPath).fileName();
-                                LOG_INFO("Set cover name for song: {} = {}", s.title.toStdString(), s.coverName.toStdString());
-                                updateLocker.unlock();
-                                emit songUpdated(s, playlistId);
-                                break;
-                            }
-                        }
-                    }
-                } catch (const std::exception& e) {
-                    LOG_ERROR("Exception during cover extraction: {}", e.what());
-                }
-            }).detach();
-        }).detach();
+    if (static_cast<network::PlatformType>(songWithFilepath.platform) == network::PlatformType::Local) {
+        queueLocalProbe(songWithFilepath, playlistId);
     }
     
     LOG_INFO("Added song: {} to playlist: {} ({}), platform={}",
@@ -548,443 +792,1717 @@ bool PlaylistManager::addSongToPlaylist(const playlist::SongInfo& song, const QU
     return true;
 }
 
-bool PlaylistManager::removeSongFromPlaylist(const playlist::SongInfo& song, const QUuid& playlistId)
+int PlaylistManager::addSongsToPlaylist(const QList<playlist::SongInfo>& songs, const QUuid& playlistId)
+{
+    return insertSongs(songs, playlistId, true);
+}
+
+int PlaylistManager::insertSongs(const QList<playlist::SongInfo>& songs, const QUuid& playlistId, bool probeLocal)
 {
     if (!m_initialized) {
         LOG_ERROR("PlaylistManager not initialized");
-        return false;
+        return 0;
     }
     
-    QWriteLocker locker(&m_dataLock);
+    QList<playlist::SongInfo> added;
+    added.reserve(songs.size());
+    for (const playlist::SongInfo& song : songs) {
+        if (std::optional<playlist::SongInfo> stored = songToStore(song)) {
+            added.append(std::move(*stored));
+        }
+    }
     
-    auto songsIt = m_playlistSongs.find(playlistId);
-    if (songsIt == m_playlistSongs.end()) {
+    ensureSongsLoaded(playlistId);
+    DataWriteLocker locker(this);
+    if (!m_playlists.contains(playlistId)) {
         LOG_ERROR("Playlist with UUID {} not found", playlistId.toString().toStdString());
-        return false;
+        return 0;
+    }
+    QList<playlist::SongInfo>& playlistSongs = m_playlistSongs[playlistId];
+    QHash<QUuid, int>& index = m_songUuidIndex[playlistId];
+    const int first = playlistSongs.size();
+    playlistSongs.reserve(first + added.size());
+    for (const playlist::SongInfo& song : added) {
+        index.insert(song.uuid, playlistSongs.size());
+        playlistSongs.append(song);
+        journal(songChange("addSong", song, playlistId));
     }
+    locker.unlock();
     
-    auto& songs = songsIt.value();
-    auto it = std::find_if(songs.begin(), songs.end(),
-        [&song](const playlist::SongInfo& s) { return s == song; });
+    if (added.isEmpty()) {
+        return 0;
+    }
+    emit songsAdded(added, playlistId, first);
     
-    if (it != songs.end()) {
-        QUuid songToDelete = it->uuid;
-        
-        // Phase 3d: Check if this song is currently playing (in current playlist)
-        bool isCurrentPlaylistSong = (playlistId == m_currentPlaylistId);
-        
-        // Emit signal before deletion (Phase 3d: T056-T058)
-        if (isCurrentPlaylistSong) {
-            emit currentSongAboutToDelete(songToDelete, playlistId);
-        }
-        
-        // Calculate next song for deletion recovery (Phase 3d: T057-T058)
-        QUuid nextSongId;
-        int deletedIndex = std::distance(songs.begin(), it);
-        
-        if (deletedIndex < songs.size() - 1) {
-            // Song has a successor, use it
-            nextSongId = songs[deletedIndex + 1].uuid;
-        } else if (deletedIndex > 0) {
-            // Song is at end, use previous
-            nextSongId = songs[deletedIndex - 1].uuid;
-        }
-        // else: nextSongId remains null (last song case)
-        
-        // Remove the song
-        songs.erase(it);
-        
-        // Rebuild UUID index after deletion (songs list changed)
-        updateSongUuidIndex(playlistId);
-        
-        auto playlistIt = m_playlists.find(playlistId);
-        locker.unlock();
-        
-        // Emit signals
-        emit songRemoved(song, playlistId);
-        emit playlistSongsChanged(playlistId);
-        
-        // Emit deletion complete signal (Phase 3d: T057-T058)
-        if (isCurrentPlaylistSong) {
-            emit currentSongDeleted(songToDelete, nextSongId, playlistId);
+    for (const playlist::SongInfo& song : added) {
+        if (probeLocal && static_cast<network::PlatformType>(song.platform) == network::PlatformType::Local) {
+            queueLocalProbe(song, playlistId);
         }
-        
-        LOG_INFO("Removed song: {} from playlist: {} ({})",
-                 song.title.toStdString(), 
-                 (playlistIt != m_playlists.end()) ? playlistIt.value().name.toStdString() : "Unknown", 
-                 playlistId.toString().toStdString());
-        return true;
     }
     
-    LOG_WARN("Song {} not found in playlist {}", song.title.toStdString(), playlistId.toString().toStdString());
-    return false;
+    LOG_INFO("Added {} of {} songs to playlist {}", added.size(), songs.size(), playlistId.toString().toStdString());
+    return added.size();
 }
 
-bool PlaylistManager::updateSongInPlaylist(const playlist::SongInfo& song, const QUuid& playlistId)
+std::optional<playlist::SongInfo> PlaylistManager::songToStore(const playlist::SongInfo& song) const
 {
-    if (!m_initialized) {
-        LOG_ERROR("PlaylistManager not initialized");
-        return false;
+    playlist::SongInfo songWithFilepath = song;
+    // If the provided filepath is a local file (file:// or absolute path), keep it as a file:// reference
+    QUrl maybeUrl = QUrl::fromUserInput(song.filepath);
+    if (maybeUrl.isLocalFile()) {
+        if (maybeUrl.isRelative()) {
+            LOG_WARN("Provided local file path is relative: {}", song.filepath.toStdString());
+            return std::nullopt;
+        }
+        songWithFilepath.filepath = maybeUrl.toLocalFile();
+        // Mark as local media: set platform
+        // Uploader will be extracted from metadata in async probe, default to "local" if not available
+        if (songWithFilepath.uploader.isEmpty()) {
+            songWithFilepath.uploader = "local";
+        }
+        songWithFilepath.platform = static_cast<int>(network::PlatformType::Local);
+        LOG_DEBUG("Marked song as local: {} (platform={})", song.title.toStdString(), songWithFilepath.platform);
+    } else {
+        // Non-local sources are converted to internal streaming filepaths
+        if (songWithFilepath.args.isEmpty()) {
+            LOG_WARN("Cannot add song with empty args for non-local source: {}", song.filepath.toStdString());
+            return std::nullopt;
+        }
+        songWithFilepath.filepath = generateStreamingFilepath(songWithFilepath);
     }
-    
-    QWriteLocker locker(&m_dataLock);
-    
-    auto songsIt = m_playlistSongs.find(playlistId);
-    if (songsIt == m_playlistSongs.end()) {
-        LOG_ERROR("Playlist with UUID {} not found", playlistId.toString().toStdString());
-        return false;
+    adoptSharedFields(songWithFilepath);
+    internSongStrings(songWithFilepath);
+    return songWithFilepath;
+}
+
+void PlaylistManager::internSongStrings(playlist::SongInfo& song) const
+{
+    m_stringPool.internInPlace(song.uploader);
+    m_stringPool.internInPlace(song.filepath);
+    m_stringPool.internInPlace(song.coverName);
+}
+
+playlist::LocalFileMetadata PlaylistManager::localFileMetadata(const QString& path)
+{
+    const QFileInfo file(path);
+    if (std::optional<playlist::LocalFileMetadata> cached = m_localMetadata->lookup(file)) {
+        LOG_DEBUG("Local file unchanged since probed: {}", path.toStdString());
+        return *cached;
     }
     
-    auto& songs = songsIt.value();
-    auto it = std::find_if(songs.begin(), songs.end(),
-        [&song](const playlist::SongInfo& s) { return s == song; });
+    // Probe comprehensive metadata in single pass (duration, artist, sample rate, etc.)
+    playlist::LocalFileMetadata entry;
+    entry.metadata = audio::FFmpegProbe::probeMetadata(path);
+    LOG_DEBUG("Probed metadata for {}: duration={} ms, artist='{}', sampleRate={} Hz", 
+             path.toStdString(), entry.metadata.durationMs, 
+             entry.metadata.artist.toStdString(), entry.metadata.sampleRate);
     
-    if (it != songs.end()) {
-        *it = song;
-        if (it->filepath.isEmpty()) {
-            it->filepath = generateStreamingFilepath(*it);
+    // After the metadata, the cover: from the cache, else extracted with TagLib + FFmpeg fallback
+    try {
+        std::optional<QString> coverPath = m_coverCache->findCachedCover(path);
+        if (!coverPath) {
+            // Scaled down once here, so neither the cache nor the UI deals with the original
+            auto coverData = audio::TagLibCoverExtractor::extractThumbnail(path, std::max(0, m_configManager->getCoverThumbnailSize()));
+            if (!coverData.empty()) {
+                QByteArray coverBytes(reinterpret_cast<const char*>(coverData.data()), coverData.size());
+                coverPath = m_coverCache->saveCover(path, coverBytes);
+                if (!coverPath) {
+                    LOG_WARN("Failed to save cover to cache for {}", path.toStdString());
+                }
+            }
         }
-        auto playlistIt = m_playlists.find(playlistId);
-        locker.unlock();
-        
-        // Emit signals
-        emit songUpdated(song, playlistId);
-        emit playlistSongsChanged(playlistId);
-        
-        LOG_INFO("Updated song: {} in playlist: {} ({})",
-                 song.title.toStdString(), 
-                 (playlistIt != m_playlists.end()) ? playlistIt.value().name.toStdString() : "Unknown", 
-                 playlistId.toString().toStdString());
-        return true;
+        if (coverPath) {
+            // Store just the filename for persistence
+            entry.coverName = QFileInfo(*coverPath).fileName();
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception during cover extraction: {}", e.what());
     }
     
-    LOG_WARN("Song {} not found in playlist {}", song.title.toStdString(), playlistId.toString().toStdString());
-    return false;
+    m_localMetadata->store(file, entry);
+    return entry;
 }
 
-std::optional<playlist::SongInfo> PlaylistManager::getSongFromPlaylist(const QUuid& songId, const QUuid& playlistId) const
+void PlaylistManager::adoptSharedFields(playlist::SongInfo& song) const
 {
-    QReadLocker locker(&m_dataLock);
-    auto songsIt = m_playlistSongs.find(playlistId);
-    if (songsIt != m_playlistSongs.end()) {
-        // Since SongInfo doesn't have uuid, we'll need to find by index or other means
-        // For now, return the first song if songId matches the index
-        int index = 0;
-        for (const auto& song : songsIt.value()) {
-            if (QUuid::fromString(QString::number(index)) == songId) {
-                return song;
-            }
+    const QString identity = playlist::SongIdentityTable::identityOf(song);
+    if (identity.isEmpty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_identityMutex);
+    if (std::optional<playlist::SongInfo> shared = identityTable().find(identity)) {
+        playlist::SongIdentityTable::share(*shared, song);
+        LOG_DEBUG("Song {} shares its media with a copy already in the library", song.title.toStdString());
+    }
+}
+
+void PlaylistManager::shareWithCopies(const playlist::SongInfo& song, const QUuid& playlistId)
+{
+    QList<playlist::SongIdentityTable::SongRef> copies;
+    {
+        std::lock_guard<std::mutex> lock(m_identityMutex);
+        copies = identityTable().copiesOf(song.uuid, playlistId);
+    }
+    if (copies.isEmpty()) {
+        return;
+    }
+    
+    QList<QPair<playlist::SongInfo, QUuid>> updated;
+    {
+        DataWriteLocker locker(this);
+        for (const auto& [copyPlaylistId, copyId] : copies) {
+            auto songs = m_playlistSongs.find(copyPlaylistId);
+            const int index = m_songUuidIndex.value(copyPlaylistId).value(copyId, -1);
+            if (songs == m_playlistSongs.end() || index < 0 || index >= songs->size()) {
+                continue;
+            }
+            playlist::SongInfo& copy = (*songs)[index];
+            if (copy.uuid != copyId || !playlist::SongIdentityTable::differs(song, copy)) {
+                continue;
+            }
+            playlist::SongIdentityTable::share(song, copy);
+            internSongStrings(copy);
+            journal(songChange("updateSong", copy, copyPlaylistId));
+            updated.append(qMakePair(copy, copyPlaylistId));
+        }
+    }
+    for (const auto& entry : updated) {
+        emit songUpdated(entry.first, entry.second);
+    }
+    if (!updated.isEmpty()) {
+        LOG_DEBUG("Shared the media of {} with {} copies", song.title.toStdString(), updated.size());
+    }
+}
+
+playlist::SongIdentityTable& PlaylistManager::identityTable() const
+{
+    if (!m_identities) {
+        // Changes made meanwhile are in the library read below or signalled after it
+        ensureAllSongsLoaded();
+        auto table = std::make_unique<playlist::SongIdentityTable>();
+        QReadLocker locker(&m_dataLock);
+        for (auto it = m_playlistSongs.cbegin(); it != m_playlistSongs.cend(); ++it) {
+            for (const playlist::SongInfo& song : it.value()) {
+                table->addSong(song, it.key());
+            }
+        }
+        locker.unlock();
+        LOG_INFO("Found {} distinct songs among {} in the library", table->size(), table->songCount());
+        m_identities = std::move(table);
+    }
+    return *m_identities;
+}
+
+void PlaylistManager::probeLocalSong(const playlist::SongInfo& song, const QUuid& playlistId)
+{
+    const playlist::LocalFileMetadata probed = localFileMetadata(song.filepath);
+    const audio::AudioMetadata& metadata = probed.metadata;
+    
+    // Update the song with probed metadata
+    DataWriteLocker updateLocker(this);
+    if (!m_playlistSongs.contains(playlistId)) {
+        return;
+    }
+    for (auto& s : m_playlistSongs[playlistId]) {
+        if (s.filepath == song.filepath && s.title == song.title) {
+            // Update duration (from milliseconds to seconds)
+            if (metadata.durationMs != INT_MAX) {
+                s.duration = static_cast<int>(metadata.durationMs / 1000);
+            }
+            // Update uploader if artist was found in metadata, otherwise keep default "local"
+            if (!metadata.artist.isEmpty()) {
+                s.uploader = m_stringPool.intern(metadata.artist);
+            }
+            if (!probed.coverName.isEmpty()) {
+                s.coverName = m_stringPool.intern(probed.coverName);
+            }
+            LOG_INFO("Updated local song: {} (duration={} s, artist='{}', cover={})", s.title.toStdString(),
+                     s.duration, s.uploader.toStdString(), s.coverName.toStdString());
+            journal(songChange("updateSong", s, playlistId));
+            
+            playlist::SongInfo updated = s;
+            updateLocker.unlock();
+            emit songUpdated(updated, playlistId);
+            shareWithCopies(updated, playlistId);
+            break;
+        }
+    }
+}
+
+void PlaylistManager::queueLocalProbe(const playlist::SongInfo& song, const QUuid& playlistId)
+{
+    probePool().submit(util::ThreadPool::Priority::Normal, [this, song, playlistId]() {
+        if (!m_shuttingDown) {
+            probeLocalSong(song, playlistId);
+        }
+    });
+}
+
+util::ThreadPool& PlaylistManager::probePool()
+{
+    std::call_once(m_probePoolCreated, [this]() {
+        m_probePool = std::make_unique<util::ThreadPool>(LOCAL_PROBE_THREADS);
+    });
+    return *m_probePool;
+}
+
+playlist::SongInfo PlaylistManager::probeLocalFile(const QString& path)
+{
+    playlist::SongInfo song;
+    song.title = QFileInfo(path).completeBaseName();
+    song.uploader = "local";
+    song.platform = static_cast<int>(network::PlatformType::Local);
+    song.duration = 0;
+    song.filepath = path;
+    song.uuid = QUuid::createUuid();
+    
+    const playlist::LocalFileMetadata probed = localFileMetadata(path);
+    if (probed.metadata.durationMs != INT_MAX) {
+        song.duration = static_cast<int>(probed.metadata.durationMs / 1000);
+    }
+    if (!probed.metadata.artist.isEmpty()) {
+        song.uploader = probed.metadata.artist;
+    }
+    song.coverName = probed.coverName;
+    return song;
+}
+
+bool PlaylistManager::importLocalFolder(const QString& directory, const QUuid& playlistId)
+{
+    return startLocalImport(directory, playlistId, false);
+}
+
+bool PlaylistManager::startLocalImport(const QString& directory, const QUuid& playlistId, bool rescan)
+{
+    if (!m_initialized || !playlistExists(playlistId)) {
+        LOG_ERROR("Cannot import {} into playlist {}", directory.toStdString(), playlistId.toString().toStdString());
+        return false;
+    }
+    if (m_importRunning.exchange(true)) {
+        LOG_WARN("A local folder import is running already");
+        return false;
+    }
+    if (m_importThread.joinable()) {
+        m_importThread.join();      // The previous import, finished
+    }
+    m_importCancelled = false;
+    const QString root = QDir(directory).absolutePath();
+    m_importThread = std::thread([this, root, playlistId, rescan]() {
+        runLocalImport(root, playlistId, rescan);
+    });
+    return true;
+}
+
+void PlaylistManager::cancelLocalImport()
+{
+    if (m_importRunning) {
+        m_importCancelled = true;
+    }
+}
+
+void PlaylistManager::runLocalImport(const QString& directory, const QUuid& playlistId, bool rescan)
+{
+    static const QStringList audioFiles = {
+        "*.mp3", "*.flac", "*.wav", "*.m4a", "*.aac", "*.ogg", "*.opus", "*.wma", "*.ape"
+    };
+    LOG_INFO("Importing local folder {} into playlist {}", directory.toStdString(), playlistId.toString().toStdString());
+    
+    // Songs of the playlist from this folder already, by path
+    ensureSongsLoaded(playlistId);
+    QHash<QString, playlist::SongInfo> existing;
+    for (const playlist::SongInfo& song : songsSnapshot(playlistId)) {
+        if (song.filepath.startsWith(directory + '/')) {
+            existing.insert(song.filepath, song);
+        }
+    }
+    
+    // Only new files and files changed since probed are probed; the rest are there already
+    QStringList paths;
+    QDirIterator files(directory, audioFiles, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+    QSet<QString> seen;
+    int skipped = 0;
+    while (files.hasNext() && !m_importCancelled) {
+        const QString path = files.next();
+        seen.insert(path);
+        if (!existing.contains(path)) {
+            if (rescan && m_localMetadata->contains(path)) {
+                ++skipped;      // Removed from the playlist since an earlier scan
+            } else {
+                paths.append(path);
+            }
+        } else if (!m_localMetadata->lookup(QFileInfo(path))) {
+            paths.append(path);
+        }
+    }
+    paths.sort();
+    QList<playlist::SongInfo> gone;
+    for (auto it = existing.cbegin(); it != existing.cend(); ++it) {
+        if (!seen.contains(it.key())) {
+            gone.append(it.value());
+        }
+    }
+    emit localImportProgress(playlistId, 0, paths.size());
+    
+    // A few probes queued per worker keep the pool busy; the rest of the files wait here
+    util::ThreadPool& pool = probePool();
+    const size_t window = pool.threadCount() * 2;
+    std::deque<std::future<playlist::SongInfo>> probes;
+    QList<playlist::SongInfo> batch;
+    int probed = 0;
+    int added = 0;
+    auto collect = [&]() {
+        playlist::SongInfo song = probes.front().get();
+        probes.pop_front();
+        ++probed;
+        auto known = existing.constFind(song.filepath);
+        if (known != existing.constEnd()) {
+            // Changed on disk: the song keeps its place and identity, with what was read now
+            playlist::SongInfo updated = *known;
+            updated.duration = song.duration;
+            updated.uploader = song.uploader;
+            updated.coverName = song.coverName;
+            updateSongInPlaylist(updated, playlistId);
+        } else {
+            batch.append(std::move(song));
+        }
+        if (batch.size() >= LOCAL_IMPORT_BATCH && !m_importCancelled) {
+            added += insertSongs(batch, playlistId, false);
+            batch.clear();
+            emit localImportProgress(playlistId, probed, paths.size());
+        }
+    };
+    for (const QString& path : paths) {
+        if (m_importCancelled) {
+            break;
+        }
+        probes.push_back(pool.submit(util::ThreadPool::Priority::Normal, [this, path]() {
+            return probeLocalFile(path);
+        }));
+        if (probes.size() >= window) {
+            collect();
+        }
+    }
+    while (!probes.empty()) {
+        collect();
+    }
+    
+    const bool cancelled = m_importCancelled;
+    if (!cancelled) {
+        if (!batch.isEmpty()) {
+            added += insertSongs(batch, playlistId, false);
+        }
+        if (!gone.isEmpty()) {
+            // Deleted from the folder since the last scan
+            removeSongsFromPlaylist(gone, playlistId);
+            for (const playlist::SongInfo& song : gone) {
+                m_localMetadata->remove(song.filepath);
+            }
+        }
+        emit localImportProgress(playlistId, probed, paths.size());
+        m_localMetadata->addFolder(directory, playlistId);
+        QMetaObject::invokeMethod(this, [this, directory]() { watchLocalFolder(directory); }, Qt::QueuedConnection);
+    }
+    LOG_INFO("Imported {} songs from {} ({} probed, {} gone, {} removed before){}", added, directory.toStdString(),
+             probed, gone.size(), skipped, cancelled ? ", cancelled" : "");
+    m_importRunning = false;
+    emit localImportFinished(playlistId, added, cancelled);
+}
+
+QString PlaylistManager::localMetadataFilePath() const
+{
+    const QFileInfo categories(categoriesFilePath());
+    return categories.absoluteDir().filePath(categories.completeBaseName() + ".local.json");
+}
+
+void PlaylistManager::watchLocalFolder(const QString& directory)
+{
+    QStringList directories{ directory };
+    QDirIterator subdirectories(directory, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (subdirectories.hasNext()) {
+        directories.append(subdirectories.next());
+    }
+    const QStringList watched = m_folderWatcher->directories();
+    directories.removeIf([&watched](const QString& path) { return watched.contains(path); });
+    if (!directories.isEmpty()) {
+        m_folderWatcher->addPaths(directories);
+    }
+}
+
+void PlaylistManager::onLocalFolderChanged(const QString& path)
+{
+    const QHash<QString, QUuid> folders = m_localMetadata->folders();
+    for (auto it = folders.cbegin(); it != folders.cend(); ++it) {
+        if (path == it.key() || path.startsWith(it.key() + '/')) {
+            m_pendingRescans.insert(it.key());
+        }
+    }
+    // A copy of many files changes the folder many times; rescan once it settles
+    if (!m_pendingRescans.isEmpty()) {
+        m_rescanTimer->start();
+    }
+}
+
+void PlaylistManager::rescanPendingFolders()
+{
+    if (m_pendingRescans.isEmpty()) {
+        return;
+    }
+    if (isImportingLocalFolder()) {
+        m_rescanTimer->start();     // One import at a time
+        return;
+    }
+    const QString directory = *m_pendingRescans.cbegin();
+    m_pendingRescans.remove(directory);
+    const QUuid playlistId = m_localMetadata->folders().value(directory);
+    if (!QFileInfo(directory).isDir() || !startLocalImport(directory, playlistId, true)) {
+        // The folder or its playlist is gone; stop following it
+        LOG_INFO("No longer watching local folder {}", directory.toStdString());
+        m_localMetadata->removeFolder(directory);
+        QStringList watched = m_folderWatcher->directories();
+        watched.removeIf([&directory](const QString& path) {
+            return path != directory && !path.startsWith(directory + '/');
+        });
+        if (!watched.isEmpty()) {
+            m_folderWatcher->removePaths(watched);
+        }
+    }
+    if (!m_pendingRescans.isEmpty()) {
+        m_rescanTimer->start();
+    }
+}
+
+bool PlaylistManager::removeSongFromPlaylist(const playlist::SongInfo& song, const QUuid& playlistId)
+{
+    if (!m_initialized) {
+        LOG_ERROR("PlaylistManager not initialized");
+        return false;
+    }
+    
+    ensureSongsLoaded(playlistId);
+    DataWriteLocker locker(this);
+    
+    auto songsIt = m_playlistSongs.find(playlistId);
+    if (songsIt == m_playlistSongs.end()) {
+        LOG_ERROR("Playlist with UUID {} not found", playlistId.toString().toStdString());
+        return false;
+    }
+    
+    auto& songs = songsIt.value();
+    auto it = std::find_if(songs.begin(), songs.end(),
+        [&song](const playlist::SongInfo& s) { return s == song; });
+    
+    if (it != songs.end()) {
+        QUuid songToDelete = it->uuid;
+        
+        // Phase 3d: Check if this song is currently playing (in current playlist)
+        bool isCurrentPlaylistSong = (playlistId == m_currentPlaylistId);
+        
+        // Emit signal before deletion (Phase 3d: T056-T058)
+        if (isCurrentPlaylistSong) {
+            emit currentSongAboutToDelete(songToDelete, playlistId);
+        }
+        
+        // Calculate next song for deletion recovery (Phase 3d: T057-T058)
+        QUuid nextSongId;
+        int deletedIndex = std::distance(songs.begin(), it);
+        
+        if (deletedIndex < songs.size() - 1) {
+            // Song has a successor, use it
+            nextSongId = songs[deletedIndex + 1].uuid;
+        } else if (deletedIndex > 0) {
+            // Song is at end, use previous
+            nextSongId = songs[deletedIndex - 1].uuid;
+        }
+        // else: nextSongId remains null (last song case)
+        
+        // Remove the song
+        songs.erase(it);
+        Json::Value record = change("removeSong", "songId", songToDelete.toString().toStdString());
+        record["playlistId"] = playlistId.toString().toStdString();
+        journal(record);
+        
+        // Rebuild UUID index after deletion (songs list changed)
+        updateSongUuidIndex(playlistId);
+        
+        auto playlistIt = m_playlists.find(playlistId);
+        locker.unlock();
+        
+        // Emit signals
+        emit songRemoved(song, playlistId);
+        emit playlistSongsChanged(playlistId);
+        
+        // Emit deletion complete signal (Phase 3d: T057-T058)
+        if (isCurrentPlaylistSong) {
+            emit currentSongDeleted(songToDelete, nextSongId, playlistId);
+        }
+        
+        LOG_INFO("Removed song: {} from playlist: {} ({})",
+                 song.title.toStdString(), 
+                 (playlistIt != m_playlists.end()) ? playlistIt.value().name.toStdString() : "Unknown", 
+                 playlistId.toString().toStdString());
+        return true;
+    }
+    
+    LOG_WARN("Song {} not found in playlist {}", song.title.toStdString(), playlistId.toString().toStdString());
+    return false;
+}
+
+int PlaylistManager::removeSongsFromPlaylist(const QList<playlist::SongInfo>& songs, const QUuid& playlistId)
+{
+    if (!m_initialized) {
+        LOG_ERROR("PlaylistManager not initialized");
+        return 0;
+    }
+    
+    QSet<QUuid> songIds;
+    for (const playlist::SongInfo& song : songs) {
+        songIds.insert(song.uuid);
+    }
+    
+    ensureSongsLoaded(playlistId);
+    DataWriteLocker locker(this);
+    auto songsIt = m_playlistSongs.find(playlistId);
+    if (songsIt == m_playlistSongs.end()) {
+        LOG_ERROR("Playlist with UUID {} not found", playlistId.toString().toStdString());
+        return 0;
+    }
+    QList<playlist::SongInfo>& playlistSongs = songsIt.value();
+    const bool isCurrentPlaylist = (playlistId == m_currentPlaylistId);
+    
+    // One pass moving the kept songs up in order. A removed song's successor is the kept
+    // song that lands where it was, known once the pass is done
+    QList<playlist::SongInfo> removed;
+    QList<int> removedAt;
+    int kept = 0;
+    for (int i = 0; i < playlistSongs.size(); ++i) {
+        if (!songIds.contains(playlistSongs[i].uuid)) {
+            if (kept != i) {
+                playlistSongs[kept] = std::move(playlistSongs[i]);
+            }
+            ++kept;
+            continue;
+        }
+        if (isCurrentPlaylist) {
+            emit currentSongAboutToDelete(playlistSongs[i].uuid, playlistId);
+        }
+        Json::Value record = change("removeSong", "songId", playlistSongs[i].uuid.toString().toStdString());
+        record["playlistId"] = playlistId.toString().toStdString();
+        journal(record);
+        removed.append(std::move(playlistSongs[i]));
+        removedAt.append(kept);
+    }
+    playlistSongs.erase(playlistSongs.begin() + kept, playlistSongs.end());
+    
+    QHash<QUuid, int>& index = m_songUuidIndex[playlistId];
+    index.clear();
+    for (int i = 0; i < playlistSongs.size(); ++i) {
+        index.insert(playlistSongs[i].uuid, i);
+    }
+    
+    // Successor or, at the end, predecessor, as removeSongFromPlaylist reports it
+    QList<QUuid> nextSongIds;
+    if (isCurrentPlaylist) {
+        for (int position : removedAt) {
+            nextSongIds.append(position < kept ? playlistSongs[position].uuid
+                               : position > 0 ? playlistSongs[position - 1].uuid : QUuid());
+        }
+    }
+    locker.unlock();
+    
+    if (removed.isEmpty()) {
+        return 0;
+    }
+    emit songsRemoved(removed, playlistId);
+    for (int i = 0; i < nextSongIds.size(); ++i) {
+        emit currentSongDeleted(removed[i].uuid, nextSongIds[i], playlistId);
+    }
+    
+    LOG_INFO("Removed {} songs from playlist {}", removed.size(), playlistId.toString().toStdString());
+    return removed.size();
+}
+
+bool PlaylistManager::updateSongInPlaylist(const playlist::SongInfo& song, const QUuid& playlistId)
+{
+    if (!m_initialized) {
+        LOG_ERROR("PlaylistManager not initialized");
+        return false;
+    }
+    
+    ensureSongsLoaded(playlistId);
+    DataWriteLocker locker(this);
+    
+    auto songsIt = m_playlistSongs.find(playlistId);
+    if (songsIt == m_playlistSongs.end()) {
+        LOG_ERROR("Playlist with UUID {} not found", playlistId.toString().toStdString());
+        return false;
+    }
+    
+    auto& songs = songsIt.value();
+    auto it = std::find_if(songs.begin(), songs.end(),
+        [&song](const playlist::SongInfo& s) { return s == song; });
+    
+    if (it != songs.end()) {
+        *it = song;
+        if (it->filepath.isEmpty()) {
+            it->filepath = generateStreamingFilepath(*it);
+        }
+        internSongStrings(*it);
+        journal(songChange("updateSong", *it, playlistId));
+        const playlist::SongInfo updated = *it;
+        auto playlistIt = m_playlists.find(playlistId);
+        locker.unlock();
+        
+        // Emit signals
+        emit songUpdated(updated, playlistId);
+        emit playlistSongsChanged(playlistId);
+        shareWithCopies(updated, playlistId);
+        
+        LOG_INFO("Updated song: {} in playlist: {} ({})",
+                 song.title.toStdString(), 
+                 (playlistIt != m_playlists.end()) ? playlistIt.value().name.toStdString() : "Unknown", 
+                 playlistId.toString().toStdString());
+        return true;
+    }
+    
+    LOG_WARN("Song {} not found in playlist {}", song.title.toStdString(), playlistId.toString().toStdString());
+    return false;
+}
+
+bool PlaylistManager::setSongLoudness(const QUuid& songId, float gainDb)
+{
+    if (!m_initialized) {
+        LOG_ERROR("PlaylistManager not initialized");
+        return false;
+    }
+
+    // One record for every playlist holding the song, those not loaded yet included
+    Json::Value record = change("setSongLoudness", "songId", songId.toString().toStdString());
+    record["gainDb"] = gainDb;
+    QList<QPair<playlist::SongInfo, QUuid>> updated;
+    bool deferred = false;
+    {
+        DataWriteLocker locker(this);
+        for (auto it = m_playlistSongs.begin(); it != m_playlistSongs.end(); ++it) {
+            for (auto& song : it.value()) {
+                if (song.uuid == songId) {
+                    song.loudnessGainDb = gainDb;
+                    song.loudnessAnalyzed = true;
+                    updated.append(qMakePair(song, it.key()));
+                }
+            }
+        }
+        for (auto it = m_unloadedSongs.cbegin(); it != m_unloadedSongs.cend(); ++it) {
+            m_deferredSongRecords[it.key()].push_back(record);
+        }
+        deferred = !m_unloadedSongs.isEmpty();
+        if (!updated.isEmpty() || deferred) {
+            journal(record);
+        }
+    }
+
+    for (const auto& entry : updated) {
+        emit songUpdated(entry.first, entry.second);
+        shareWithCopies(entry.first, entry.second);
+    }
+    if (updated.isEmpty() && !deferred) {
+        LOG_DEBUG("Loudness result for unknown song {}", songId.toString().toStdString());
+        return false;
+    }
+    LOG_DEBUG("Stored loudness gain {:.2f} dB for song {}", gainDb, songId.toString().toStdString());
+    return true;
+}
+
+std::optional<playlist::SongInfo> PlaylistManager::getSongFromPlaylist(const QUuid& songId, const QUuid& playlistId) const
+{
+    ensureSongsLoaded(playlistId);
+    QReadLocker locker(&m_dataLock);
+    auto songsIt = m_playlistSongs.find(playlistId);
+    if (songsIt != m_playlistSongs.end()) {
+        // Since SongInfo doesn't have uuid, we'll need to find by index or other means
+        // For now, return the first song if songId matches the index
+        int index = 0;
+        for (const auto& song : songsIt.value()) {
+            if (QUuid::fromString(QString::number(index)) == songId) {
+                return song;
+            }
             index++;
         }
     }
-    
-    LOG_ERROR("Song {} not found in playlist {}", songId.toString().toStdString(), playlistId.toString().toStdString());
-    return std::nullopt;
+    
+    LOG_ERROR("Song {} not found in playlist {}", songId.toString().toStdString(), playlistId.toString().toStdString());
+    return std::nullopt;
+}
+
+QList<playlist::SongInfo> PlaylistManager::iterateSongsInPlaylist(const QUuid& playlistId, std::function<bool(const playlist::SongInfo&)> func) const
+{
+    // Walks a snapshot, so func runs without m_dataLock held
+    const QList<playlist::SongInfo> songs = songsSnapshot(playlistId);
+    QList<playlist::SongInfo> result;
+    for (const auto& song : songs) {
+        if (func(song)) {
+            result.append(song);
+        }
+    }
+    return result;
+}
+
+QList<playlist::SongInfo> PlaylistManager::songsSnapshot(const QUuid& playlistId) const
+{
+    auto published = std::atomic_load(&m_publishedSongs);
+    if (!published || !published->contains(playlistId)) {
+        // Not read yet, or no such playlist
+        ensureSongsLoaded(playlistId);
+        published = std::atomic_load(&m_publishedSongs);
+        if (!published) {
+            return {};
+        }
+    }
+    return published->value(playlistId);
+}
+
+void PlaylistManager::publishSongs() const
+{
+    // Sharing m_playlistSongs, the published table makes the next change to it copy what it
+    // changes: the table of lists, and the one list written to
+    auto published = std::atomic_load(&m_publishedSongs);
+    if (published && published->isSharedWith(m_playlistSongs)) {
+        return;     // Songs unchanged
+    }
+    std::atomic_store(&m_publishedSongs, std::make_shared<const QHash<QUuid, QList<playlist::SongInfo>>>(m_playlistSongs));
+}
+
+// UUID-based lookup
+QList<playlist::SongSearchHit> PlaylistManager::searchSongs(const QString& query, int limit) const
+{
+    std::lock_guard<std::mutex> lock(m_searchMutex);
+    if (!m_searchIndex) {
+        // Changes made meanwhile are in the library read below or signalled after it
+        ensureAllSongsLoaded();
+        auto index = std::make_unique<playlist::SongSearchIndex>();
+        QReadLocker locker(&m_dataLock);
+        for (auto it = m_playlistSongs.cbegin(); it != m_playlistSongs.cend(); ++it) {
+            for (const playlist::SongInfo& song : it.value()) {
+                index->addSong(song, it.key());
+            }
+        }
+        locker.unlock();
+        LOG_INFO("Indexed {} songs for search", index->size());
+        m_searchIndex = std::move(index);
+    }
+    return m_searchIndex->search(query, limit);
+}
+
+QList<playlist::SongIdentityTable::SongRef> PlaylistManager::songCopies(const QUuid& songId, const QUuid& playlistId) const
+{
+    std::lock_guard<std::mutex> lock(m_identityMutex);
+    return identityTable().copiesOf(songId, playlistId);
+}
+
+bool PlaylistManager::categoryExists(const QUuid& categoryId) const
+{
+    QReadLocker locker(&m_dataLock);
+    return m_categories.contains(categoryId);
+}
+
+bool PlaylistManager::playlistExists(const QUuid& playlistId) const
+{
+    QReadLocker locker(&m_dataLock);
+    return m_playlists.contains(playlistId);
+}
+
+// Current playlist management
+QUuid PlaylistManager::getCurrentPlaylist()
+{
+    if (!m_initialized) {
+        LOG_WARN("PlaylistManager not initialized, cannot get current playlist");
+        return QUuid();
+    }
+    QReadLocker locker(&m_dataLock);
+    if (m_currentPlaylistId.isNull()) {
+        locker.unlock();
+        return ensureDefaultSetup();
+    }
+    return m_currentPlaylistId;
+}
+
+void PlaylistManager::setCurrentPlaylist(const QUuid& playlistId)
+{
+    if (!m_initialized) {
+        LOG_ERROR("PlaylistManager not initialized");
+        return;
+    }
+    
+    if (!playlistId.isNull() && !playlistExists(playlistId)) {
+        LOG_ERROR("Cannot set current playlist: playlist {} not found", playlistId.toString().toStdString());
+        return;
+    }
+    
+    DataWriteLocker locker(this);
+    m_currentPlaylistId = playlistId;
+    journal(change("setCurrentPlaylist", "playlistId", playlistId.toString().toStdString()));
+    locker.unlock();
+    
+    emit currentPlaylistChanged(playlistId);
+    LOG_INFO("Current playlist changed to: {}", playlistId.toString().toStdString());
+}
+
+void PlaylistManager::setAutoSaveSuspended(bool suspended)
+{
+    if (m_autoSaveSuspended == suspended) {
+        return;
+    }
+    m_autoSaveSuspended = suspended;
+    if (suspended) {
+        if (m_autoSaveTimer) {
+            m_autoSaveTimer->stop();
+        }
+        LOG_DEBUG("Auto-save suspended while idle");
+    } else if (m_initialized) {
+        setupAutoSave();
+    }
+}
+
+void PlaylistManager::onAutoSaveTimer()
+{
+    util::IdleMode::recordWakeup();
+    if (m_initialized) {
+        LOG_DEBUG("Auto-save timer triggered, saving categories");
+        saveAllCategories();
+    }
+}
+
+// Helper methods
+QUuid PlaylistManager::getPlaylistCategoryId(const QUuid& playlistId) const
+{
+    QReadLocker locker(&m_dataLock);
+    for (auto it = m_categoryPlaylists.begin(); it != m_categoryPlaylists.end(); ++it) {
+        if (it.value().contains(playlistId)) {
+            return it.key();
+        }
+    }
+    return QUuid(); // Not found
+}
+
+// Initialization helpers
+void PlaylistManager::ensurePlaylistDirectoryExists()
+{
+    QString workspaceDir = m_configManager->getWorkspaceDirectory();
+    if (workspaceDir.isEmpty()) {
+        throw std::runtime_error("Workspace directory not configured");
+    }
+    
+    QDir dir(workspaceDir);
+    if (!dir.exists()) {
+        if (!dir.mkpath(".")) {
+            throw std::runtime_error("Failed to create workspace directory: " + workspaceDir.toStdString());
+        }
+        LOG_INFO("Created workspace directory: {}", workspaceDir.toStdString());
+    }
+}
+
+void PlaylistManager::setupAutoSave()
+{
+    bool autoSaveEnabled = m_configManager->getAutoSaveEnabled();
+    int autoSaveInterval = m_configManager->getAutoSaveInterval();
+    
+    if (m_autoSaveSuspended) {
+        // setAutoSaveSuspended(false) calls this again
+        if (m_autoSaveTimer) {
+            m_autoSaveTimer->stop();
+        }
+    } else if (autoSaveEnabled && autoSaveInterval > 0) {
+        if (!m_autoSaveTimer) {
+            m_autoSaveTimer = new QTimer(this);
+            connect(m_autoSaveTimer, &QTimer::timeout, this, &PlaylistManager::onAutoSaveTimer);
+        }
+        
+        m_autoSaveTimer->start(autoSaveInterval * 60 * 1000); // Convert minutes to milliseconds
+        LOG_INFO("Auto-save enabled with {} minute interval", autoSaveInterval);
+    } else {
+        if (m_autoSaveTimer) {
+            m_autoSaveTimer->stop();
+        }
+        LOG_INFO("Auto-save disabled");
+    }
+}
+
+bool PlaylistManager::saveCategoriesToJsonFile()
+{
+    TRACE_SCOPE("playlist", "PlaylistManager::saveCategoriesToJsonFile");
+    QString fullPath = categoriesFilePath();
+    // The snapshot is rewritten whole, songs included
+    ensureAllSongsLoaded();
+    
+    Json::Value root(Json::objectValue);
+    Json::Value categoriesArray(Json::arrayValue);
+    
+    // Convert hashmap structure to JSON (with read lock). The records queued so far are
+    // part of the snapshot; only the ones queued after it stay pending
+    QReadLocker locker(&m_dataLock);
+    uint64_t snapshotSeq = 0;
+    size_t coveredRecords = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_journalMutex);
+        snapshotSeq = m_journalSeq;
+        coveredRecords = m_journalPending.size();
+    }
+    for (auto catIt = m_categories.begin(); catIt != m_categories.end(); ++catIt) {
+        const playlist::CategoryInfo& category = catIt.value();
+        Json::Value categoryObj = categoryToJson(category);
+        
+        // Get playlists for this category
+        Json::Value playlistsArray(Json::arrayValue);
+        auto playlistIds = m_categoryPlaylists.value(category.uuid);
+        for (const QUuid& playlistId : playlistIds) {
+            auto playlistIt = m_playlists.find(playlistId);
+            if (playlistIt != m_playlists.end()) {
+                Json::Value playlistObj = playlistToJson(playlistIt.value());
+                
+                // Get songs for this playlist
+                Json::Value songsArray(Json::arrayValue);
+                auto songs = m_playlistSongs.value(playlistId);
+                for (const playlist::SongInfo& song : songs) {
+                    songsArray.append(songToJson(song));
+                }
+                playlistObj["songs"] = songsArray;
+                playlistsArray.append(playlistObj);
+            }
+        }
+        categoryObj["playlists"] = playlistsArray;
+        categoriesArray.append(categoryObj);
+    }
+    
+    root["categories"] = categoriesArray;
+    root["currentPlaylistId"] = m_currentPlaylistId.toString().toStdString();
+    root["journalSeq"] = Json::UInt64(snapshotSeq);
+    locker.unlock(); // Unlock before file I/O
+    
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "  ";
+    const std::string text = Json::writeString(builder, root);
+    
+    // Replace the file only once fully written, so a crash leaves the old snapshot
+    QSaveFile file(fullPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_ERROR("Failed to open file for writing: {}", fullPath.toStdString());
+        return false;
+    }
+    file.write(text.data(), static_cast<qint64>(text.size()));
+    if (!file.commit()) {
+        LOG_ERROR("Failed to write categories to: {}", fullPath.toStdString());
+        return false;
+    }
+    
+    journalCompacted(coveredRecords, binarySnapshotFilePath());
+    
+    LOG_INFO("Categories saved to: {}", fullPath.toStdString());
+    return true;
+}
+
+bool PlaylistManager::saveCategoriesToBinaryFile()
+{
+    TRACE_SCOPE("playlist", "PlaylistManager::saveCategoriesToBinaryFile");
+    const QString path = binarySnapshotFilePath();
+    // The records queued so far are part of the snapshot; only later ones stay pending
+    uint64_t snapshotSeq = 0;
+    size_t coveredRecords = 0;
+    playlist::LibraryContents contents;
+    ensureAllSongsLoaded();
+    {
+        QReadLocker locker(&m_dataLock);
+        {
+            std::lock_guard<std::mutex> lock(m_journalMutex);
+            snapshotSeq = m_journalSeq;
+            coveredRecords = m_journalPending.size();
+        }
+        contents = libraryContents();
+    }
+    if (!playlist::BinarySnapshot::write(path, contents, snapshotSeq)) {
+        return false;
+    }
+    journalCompacted(coveredRecords, categoriesFilePath());
+    
+    LOG_INFO("Categories saved to: {}", path.toStdString());
+    return true;
+}
+
+void PlaylistManager::journalCompacted(size_t coveredRecords, const QString& staleSnapshot)
+{
+    // Everything in the journal is in the snapshot now, and the other format's snapshot,
+    // if any, is older than the journal
+    QFile::remove(journalFilePath());
+    QFile::remove(staleSnapshot);
+    std::lock_guard<std::mutex> lock(m_journalMutex);
+    m_journalPending.erase(m_journalPending.begin(), m_journalPending.begin() + coveredRecords);
+    m_journalRecords = 0;
+}
+
+bool PlaylistManager::loadCategoriesFromSnapshot()
+{
+    // The configured format first; the other one if it is all there is, e.g. just switched
+    if (QFileInfo::exists(binarySnapshotFilePath())
+        && (useBinarySnapshot() || !QFileInfo::exists(categoriesFilePath()))) {
+        if (loadCategoriesFromBinaryFile()) {
+            return true;
+        }
+        if (!QFileInfo::exists(categoriesFilePath())) {
+            return false;
+        }
+    }
+    return loadCategoriesFromJsonFile();
+}
+
+bool PlaylistManager::loadCategoriesFromBinaryFile()
+{
+    TRACE_SCOPE("playlist", "PlaylistManager::loadCategoriesFromBinaryFile");
+    const QString path = binarySnapshotFilePath();
+    auto snapshot = std::make_shared<playlist::BinarySnapshot>();
+    if (!snapshot->open(path.toStdString())) {
+        LOG_ERROR("Can't read the binary category file: {}", path.toStdString());
+        return false;
+    }
+    
+    {
+        DataWriteLocker locker(this);
+        
+        clearLibrary();
+        // Headers now; songs once their playlist is used, see ensureSongsLoaded()
+        for (int i = 0; i < snapshot->categoryCount(); ++i) {
+            const playlist::CategoryInfo category = snapshot->category(i);
+            m_categories.insert(category.uuid, category);
+            QList<QUuid>& playlistIds = m_categoryPlaylists[category.uuid];
+            const auto [first, count] = snapshot->categoryPlaylists(i);
+            for (int j = first; j < first + count; ++j) {
+                const playlist::PlaylistInfo playlist = snapshot->playlist(j);
+                m_playlists.insert(playlist.uuid, playlist);
+                playlistIds.append(playlist.uuid);
+                m_unloadedSongs.insert(playlist.uuid, std::string_view());
+            }
+        }
+        m_currentPlaylistId = snapshot->currentPlaylistId();
+        m_binarySnapshot = snapshot;
+        
+        replayJournal(snapshot->journalSeq());
+        
+        // Build UUID indices for the playlists the journal added
+        for (auto it = m_playlistSongs.cbegin(); it != m_playlistSongs.cend(); ++it) {
+            QHash<QUuid, int>& index = m_songUuidIndex[it.key()];
+            index.clear();
+            for (int i = 0; i < it.value().size(); ++i) {
+                index.insert(it.value()[i].uuid, i);
+            }
+        }
+    }
+    
+    LOG_INFO("Loaded {} categories with {} playlists from {}",
+             m_categories.size(), m_playlists.size(), path.toStdString());
+    return true;
+}
+
+void PlaylistManager::clearLibrary()
+{
+    m_categories.clear();
+    m_playlists.clear();
+    m_categoryPlaylists.clear();
+    m_playlistSongs.clear();
+    m_songUuidIndex.clear();
+    m_unloadedSongs.clear();
+    m_deferredSongRecords.clear();
+    m_snapshotText.reset();
+    m_binarySnapshot.reset();
+    m_stringPool.clear();
+}
+
+playlist::LibraryContents PlaylistManager::libraryContents() const
+{
+    playlist::LibraryContents contents;
+    for (const auto& category : m_categories) {
+        contents.categories.append(category);
+        for (const QUuid& playlistId : m_categoryPlaylists.value(category.uuid)) {
+            contents.playlists[category.uuid].append(m_playlists.value(playlistId));
+            contents.songs.insert(playlistId, m_playlistSongs.value(playlistId));
+        }
+    }
+    contents.currentPlaylistId = m_currentPlaylistId;
+    return contents;
+}
+
+bool PlaylistManager::useBinarySnapshot() const
+{
+    return m_configManager->getPlaylistStorage() == "binary";
+}
+
+QString PlaylistManager::binarySnapshotFilePath() const
+{
+    const QFileInfo categories(categoriesFilePath());
+    return categories.absoluteDir().filePath(categories.completeBaseName() + ".bin");
+}
+
+bool PlaylistManager::loadCategoriesFromJsonFile()
+{
+    TRACE_SCOPE("playlist", "PlaylistManager::loadCategoriesFromJsonFile");
+    QString fullPath = categoriesFilePath();
+    
+    QFileInfo fileInfo(fullPath);
+    if (!fileInfo.exists()) {
+        LOG_INFO("Category file does not exist: {}, will create default setup", fullPath.toStdString());
+        // A journal without its snapshot has nothing to apply to
+        QFile::remove(journalFilePath());
+        {
+            std::lock_guard<std::mutex> lock(m_journalMutex);
+            m_journalPending.clear();
+            m_journalRecords = 0;
+            m_journalSeq = 0;
+        }
+        ensureDefaultSetup();
+        return false;
+    }
+    
+    auto text = std::make_shared<std::string>();
+    {
+        std::ifstream file(fullPath.toStdString(), std::ios::binary);
+        if (!file.is_open()) {
+            LOG_ERROR("Failed to open category file: {}", fullPath.toStdString());
+            return false;
+        }
+        text->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    
+    // Parse the headers only; each playlist's songs array is just located, and parsed by
+    // ensureSongsLoaded() once used
+    struct SnapshotPlaylist {
+        playlist::PlaylistInfo info;
+        std::string_view songs;
+    };
+    QList<QPair<playlist::CategoryInfo, QList<SnapshotPlaylist>>> categories;
+    std::string currentPlaylistId;
+    int64_t journalSeq = 0;
+    util::JsonScanner json(*text);
+    std::string_view key;
+    if (json.enterObject()) {
+        while (json.nextKey(key)) {
+            if (key == "categories" && json.enterArray()) {
+                while (json.nextElement()) {
+                    Json::Value categoryValue(Json::objectValue);
+                    QList<SnapshotPlaylist> playlists;
+                    if (!json.enterObject()) {
+                        json.skipValue();
+                        continue;
+                    }
+                    while (json.nextKey(key)) {
+                        if (key != "playlists" || !json.enterArray()) {
+                            readJsonMember(json, key, categoryValue);
+                            continue;
+                        }
+                        while (json.nextElement()) {
+                            Json::Value playlistValue(Json::objectValue);
+                            SnapshotPlaylist playlist;
+                            if (!json.enterObject()) {
+                                json.skipValue();
+                                continue;
+                            }
+                            while (json.nextKey(key)) {
+                                if (!(key == "songs" && json.captureValue(playlist.songs))) {
+                                    readJsonMember(json, key, playlistValue);
+                                }
+                            }
+                            playlist.info = playlistFromJson(playlistValue);
+                            playlists.append(playlist);
+                        }
+                    }
+                    categories.append(qMakePair(categoryFromJson(categoryValue), playlists));
+                }
+            } else if (!(key == "currentPlaylistId" && json.readString(currentPlaylistId))
+                       && !(key == "journalSeq" && json.readInt(journalSeq))) {
+                json.skipValue();
+            }
+        }
+    }
+    if (!json.ok()) {
+        LOG_ERROR("JSON parse error in category file: {}", fullPath.toStdString());
+        return false;
+    }
+    
+    {
+        DataWriteLocker locker(this);
+        
+        clearLibrary();
+        m_snapshotText = text;
+        
+        for (const auto& entry : categories) {
+            const playlist::CategoryInfo& category = entry.first;
+            m_categories.insert(category.uuid, category);
+            QList<QUuid>& playlistIds = m_categoryPlaylists[category.uuid];
+            for (const SnapshotPlaylist& playlist : entry.second) {
+                m_playlists.insert(playlist.info.uuid, playlist.info);
+                playlistIds.append(playlist.info.uuid);
+                m_unloadedSongs.insert(playlist.info.uuid, playlist.songs.empty() ? std::string_view("[]") : playlist.songs);
+            }
+        }
+        m_currentPlaylistId = QUuid::fromString(QString::fromStdString(currentPlaylistId));
+        
+        // Changes saved since the snapshot was written (absent in files from before the journal)
+        replayJournal(static_cast<uint64_t>(journalSeq));
+        
+        // Build UUID indices for the playlists the journal added
+        for (auto it = m_playlistSongs.begin(); it != m_playlistSongs.end(); ++it) {
+            rebuildSongUuidIndex(it.key());
+        }
+    }
+    
+    LOG_INFO("Loaded {} categories with {} playlists from {}", 
+             m_categories.size(), m_playlists.size(), fullPath.toStdString());
+    return true;
+}
+
+QString PlaylistManager::categoriesFilePath() const
+{
+    QString categoryFilePath = m_configManager->getCategoriesFilePath();
+    QString workspaceDir = m_configManager->getWorkspaceDirectory();
+    return QDir(workspaceDir).absoluteFilePath(categoryFilePath);
+}
+
+QString PlaylistManager::journalFilePath() const
+{
+    return categoriesFilePath() + ".journal";
+}
+
+QString PlaylistManager::shuffleFilePath() const
+{
+    const QFileInfo categories(categoriesFilePath());
+    return categories.absoluteDir().filePath(categories.completeBaseName() + ".shuffle.json");
+}
+
+playlist::ShuffleBag& PlaylistManager::shuffleBag(const QUuid& playlistId, const QList<playlist::SongInfo>& songs)
+{
+    auto it = m_shuffleBags.find(playlistId);
+    if (it != m_shuffleBags.end()) {
+        return it->second;
+    }
+    QList<QUuid> songIds;
+    songIds.reserve(songs.size());
+    for (const playlist::SongInfo& song : songs) {
+        songIds.append(song.uuid);
+    }
+    readShuffleFile();
+    auto saved = m_savedShuffleBags.find(playlistId);
+    if (saved == m_savedShuffleBags.end()) {
+        return m_shuffleBags.emplace(playlistId, playlist::ShuffleBag(songIds)).first->second;
+    }
+    // Carry on with the round of the last session
+    playlist::ShuffleBag bag = playlist::ShuffleBag::restore(saved->order, saved->current, songIds);
+    m_savedShuffleBags.erase(saved);
+    return m_shuffleBags.emplace(playlistId, std::move(bag)).first->second;
+}
+
+void PlaylistManager::readShuffleFile()
+{
+    if (m_shuffleFileRead) {
+        return;
+    }
+    m_shuffleFileRead = true;
+    const QString path = shuffleFilePath();
+    std::ifstream file(path.toStdString(), std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+    Json::CharReaderBuilder builder;
+    Json::Value root;
+    std::string errs;
+    if (!Json::parseFromStream(builder, file, &root, &errs) || !root.isObject()) {
+        LOG_WARN("Ignoring unreadable shuffle file {}: {}", path.toStdString(), errs);
+        return;
+    }
+    for (const std::string& key : root.getMemberNames()) {
+        const Json::Value& value = root[key];
+        SavedShuffleBag saved;
+        saved.current = uuidFromJson(value["current"]);
+        saved.order.reserve(static_cast<int>(value["order"].size()));
+        for (const Json::Value& songId : value["order"]) {
+            saved.order.append(uuidFromJson(songId));
+        }
+        m_savedShuffleBags.insert(QUuid::fromString(QString::fromStdString(key)), std::move(saved));
+    }
 }
 
-QList<playlist::SongInfo> PlaylistManager::iterateSongsInPlaylist(const QUuid& playlistId, std::function<bool(const playlist::SongInfo&)> func) const
+bool PlaylistManager::saveShuffleBags()
 {
-    QReadLocker locker(&m_dataLock);
-    QList<playlist::SongInfo> result;
-    auto songsIt = m_playlistSongs.find(playlistId);
-    if (songsIt != m_playlistSongs.end()) {
-        for (const auto& song : songsIt.value()) {
-            if (func(song)) {
-                result.append(song);
+    // Saved ones not restored yet are kept as they were
+    Json::Value root(Json::objectValue);
+    {
+        std::lock_guard<std::mutex> lock(m_shuffleMutex);
+        if (!m_shuffleDirty) {
+            return true;
+        }
+        readShuffleFile();
+        auto write = [&root](const QUuid& playlistId, const QList<QUuid>& order, const QUuid& current) {
+            Json::Value bag(Json::objectValue);
+            bag["current"] = current.toString().toStdString();
+            Json::Value& songIds = bag["order"] = Json::Value(Json::arrayValue);
+            for (const QUuid& songId : order) {
+                songIds.append(songId.toString().toStdString());
             }
+            root[playlistId.toString().toStdString()] = std::move(bag);
+        };
+        for (auto it = m_savedShuffleBags.cbegin(); it != m_savedShuffleBags.cend(); ++it) {
+            write(it.key(), it->order, it->current);
+        }
+        for (const auto& [playlistId, bag] : m_shuffleBags) {
+            write(playlistId, bag.order(), bag.current());
         }
+        m_shuffleDirty = false;
     }
-    return result;
+    
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    const std::string text = Json::writeString(builder, root);
+    const QString path = shuffleFilePath();
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_ERROR("Failed to open file for writing: {}", path.toStdString());
+        return false;
+    }
+    file.write(text.data(), static_cast<qint64>(text.size()));
+    if (!file.commit()) {
+        LOG_ERROR("Failed to write shuffle orders to: {}", path.toStdString());
+        return false;
+    }
+    return true;
 }
 
-// UUID-based lookup
-bool PlaylistManager::categoryExists(const QUuid& categoryId) const
+void PlaylistManager::journal(const Json::Value& change)
 {
-    QReadLocker locker(&m_dataLock);
-    return m_categories.contains(categoryId);
+    std::lock_guard<std::mutex> lock(m_journalMutex);
+    m_journalPending.push_back(change);
+    m_journalPending.back()["seq"] = Json::UInt64(++m_journalSeq);
 }
 
-bool PlaylistManager::playlistExists(const QUuid& playlistId) const
+bool PlaylistManager::appendJournal()
 {
-    QReadLocker locker(&m_dataLock);
-    return m_playlists.contains(playlistId);
+    TRACE_SCOPE("playlist", "PlaylistManager::appendJournal");
+    std::vector<Json::Value> records;
+    {
+        std::lock_guard<std::mutex> lock(m_journalMutex);
+        records.swap(m_journalPending);
+    }
+    if (records.empty()) {
+        return true;
+    }
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";    // One record per line
+    std::string pending;
+    for (const Json::Value& record : records) {
+        pending += Json::writeString(builder, record);
+        pending += '\n';
+    }
+    
+    const QString path = journalFilePath();
+    QFile file(path);
+    bool ok = file.open(QIODevice::ReadWrite);
+    if (ok && file.size() > 0) {
+        // A record cut short by a crash must not swallow the first one appended now
+        char last = '\n';
+        file.seek(file.size() - 1);
+        file.getChar(&last);
+        if (last != '\n') {
+            pending.insert(pending.begin(), '\n');
+        }
+    }
+    ok = ok && file.seek(file.size())
+            && file.write(pending.data(), static_cast<qint64>(pending.size())) == static_cast<qint64>(pending.size())
+            && file.flush();
+    if (!ok) {
+        LOG_ERROR("Failed to append to playlist journal {}: {}", path.toStdString(), file.errorString().toStdString());
+        requeueJournal(std::move(records));
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_journalMutex);
+        m_journalRecords += static_cast<int>(records.size());
+    }
+    LOG_DEBUG("Appended {} playlist changes to {}", records.size(), path.toStdString());
+    return true;
 }
 
-// Current playlist management
-QUuid PlaylistManager::getCurrentPlaylist()
+void PlaylistManager::replayJournal(uint64_t snapshotSeq)
 {
-    if (!m_initialized) {
-        LOG_WARN("PlaylistManager not initialized, cannot get current playlist");
-        return QUuid();
+    TRACE_SCOPE("playlist", "PlaylistManager::replayJournal");
+    uint64_t lastSeq = snapshotSeq;
+    int records = 0;
+    int applied = 0;
+    std::ifstream file(journalFilePath().toStdString());
+    if (file.is_open()) {
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            Json::Value record;
+            std::string errs;
+            if (!reader->parse(line.data(), line.data() + line.size(), &record, &errs) || !record.isObject()) {
+                // Cut short by a crash while it was written
+                LOG_WARN("Skipping unreadable playlist journal record: {}", errs);
+                continue;
+            }
+            ++records;
+            const uint64_t seq = record["seq"].asUInt64();
+            if (seq <= snapshotSeq) {
+                continue;   // Already in the snapshot
+            }
+            if (applyJournalRecord(record)) {
+                ++applied;
+            }
+            lastSeq = std::max(lastSeq, seq);
+        }
     }
-    QReadLocker locker(&m_dataLock);
-    if (m_currentPlaylistId.isNull()) {
-        locker.unlock();
-        return ensureDefaultSetup();
+    
+    std::lock_guard<std::mutex> lock(m_journalMutex);
+    m_journalPending.clear();
+    m_journalRecords = records;
+    m_journalSeq = lastSeq;
+    if (records > 0) {
+        LOG_INFO("Replayed {} of {} playlist journal records", applied, records);
     }
-    return m_currentPlaylistId;
 }
 
-void PlaylistManager::setCurrentPlaylist(const QUuid& playlistId)
+void PlaylistManager::requeueJournal(std::vector<Json::Value> records)
 {
-    if (!m_initialized) {
-        LOG_ERROR("PlaylistManager not initialized");
+    std::lock_guard<std::mutex> lock(m_journalMutex);
+    m_journalPending.insert(m_journalPending.begin(),
+                            std::make_move_iterator(records.begin()), std::make_move_iterator(records.end()));
+}
+
+void PlaylistManager::openStore()
+{
+    if (m_configManager->getPlaylistStorage() != "sqlite") {
         return;
     }
-    
-    if (!playlistId.isNull() && !playlistExists(playlistId)) {
-        LOG_ERROR("Cannot set current playlist: playlist {} not found", playlistId.toString().toStdString());
+    const QFileInfo categories(categoriesFilePath());
+    QDir().mkpath(categories.absolutePath());
+    const QString path = categories.absoluteDir().filePath(categories.completeBaseName() + ".db");
+    auto store = std::make_unique<playlist::SqlitePlaylistStore>();
+    if (!store->open(path.toStdString())) {
+        LOG_ERROR("Can't use the playlist database {}, keeping playlists in JSON files", path.toStdString());
         return;
     }
-    
-    QWriteLocker locker(&m_dataLock);
-    m_currentPlaylistId = playlistId;
-    locker.unlock();
-    
-    emit currentPlaylistChanged(playlistId);
-    LOG_INFO("Current playlist changed to: {}", playlistId.toString().toStdString());
+    m_store = std::move(store);
 }
 
-void PlaylistManager::onAutoSaveTimer()
+bool PlaylistManager::loadCategoriesFromStore()
 {
-    if (m_initialized) {
-        LOG_DEBUG("Auto-save timer triggered, saving categories");
-        saveAllCategories();
+    TRACE_SCOPE("playlist", "PlaylistManager::loadCategoriesFromStore");
+    if (m_store->isEmpty()
+        && (QFileInfo::exists(categoriesFilePath()) || QFileInfo::exists(binarySnapshotFilePath()))) {
+        // First start on the database: import the file library, leaving its files in place
+        if (!loadCategoriesFromSnapshot()) {
+            return false;
+        }
+        ensureAllSongsLoaded();
+        playlist::SqlitePlaylistStore::Contents contents;
+        {
+            QReadLocker locker(&m_dataLock);
+            contents = libraryContents();
+        }
+        std::lock_guard<std::mutex> storeLock(m_storeMutex);
+        if (!m_store->replaceAll(contents)) {
+            // Saving changes would make the database non-empty and the import would never
+            // run again; keep to the files this session so it is retried next start
+            LOG_ERROR("Failed to import playlists into the database, keeping playlists in files");
+            m_store.reset();
+            return true;
+        }
+        LOG_INFO("Imported {} categories with {} playlists into the playlist database",
+                 contents.categories.size(), m_playlists.size());
+        return true;
     }
-}
 
-// Helper methods
-QUuid PlaylistManager::getPlaylistCategoryId(const QUuid& playlistId) const
-{
-    QReadLocker locker(&m_dataLock);
-    for (auto it = m_categoryPlaylists.begin(); it != m_categoryPlaylists.end(); ++it) {
-        if (it.value().contains(playlistId)) {
-            return it.key();
+    // Songs are read per playlist once used, see ensureSongsLoaded()
+    playlist::SqlitePlaylistStore::Contents contents;
+    bool loaded = false;
+    {
+        std::lock_guard<std::mutex> storeLock(m_storeMutex);
+        loaded = m_store->loadHeaders(contents);
+    }
+    if (!loaded) {
+        LOG_ERROR("Failed to load playlists from the database");
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_journalMutex);
+        m_journalPending.clear();
+    }
+    if (contents.categories.isEmpty()) {
+        LOG_INFO("Playlist database is empty, will create default setup");
+        ensureDefaultSetup();
+        return false;
+    }
+
+    {
+        DataWriteLocker locker(this);
+        clearLibrary();
+        for (const auto& category : contents.categories) {
+            m_categories.insert(category.uuid, category);
+            QList<QUuid>& playlistIds = m_categoryPlaylists[category.uuid];
+            for (const auto& playlist : contents.playlists.value(category.uuid)) {
+                m_playlists.insert(playlist.uuid, playlist);
+                m_unloadedSongs.insert(playlist.uuid, std::string_view());
+                playlistIds.append(playlist.uuid);
+            }
         }
+        m_currentPlaylistId = contents.currentPlaylistId;
     }
-    return QUuid(); // Not found
+    return true;
 }
 
-// Initialization helpers
-void PlaylistManager::ensurePlaylistDirectoryExists()
+bool PlaylistManager::saveChangesToStore()
 {
-    QString workspaceDir = m_configManager->getWorkspaceDirectory();
-    if (workspaceDir.isEmpty()) {
-        throw std::runtime_error("Workspace directory not configured");
+    TRACE_SCOPE("playlist", "PlaylistManager::saveChangesToStore");
+    std::vector<Json::Value> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_journalMutex);
+        changes.swap(m_journalPending);
     }
-    
-    QDir dir(workspaceDir);
-    if (!dir.exists()) {
-        if (!dir.mkpath(".")) {
-            throw std::runtime_error("Failed to create workspace directory: " + workspaceDir.toStdString());
+    std::lock_guard<std::mutex> storeLock(m_storeMutex);
+    if (m_store->apply(changes)) {
+        if (!changes.empty()) {
+            LOG_DEBUG("Stored {} playlist changes", changes.size());
         }
-        LOG_INFO("Created workspace directory: {}", workspaceDir.toStdString());
+        return true;
     }
+    requeueJournal(std::move(changes));
+    return false;
 }
 
-void PlaylistManager::setupAutoSave()
+void PlaylistManager::ensureSongsLoaded(const QUuid& playlistId) const
 {
-    bool autoSaveEnabled = m_configManager->getAutoSaveEnabled();
-    int autoSaveInterval = m_configManager->getAutoSaveInterval();
-    
-    if (autoSaveEnabled && autoSaveInterval > 0) {
-        if (!m_autoSaveTimer) {
-            m_autoSaveTimer = new QTimer(this);
-            connect(m_autoSaveTimer, &QTimer::timeout, this, &PlaylistManager::onAutoSaveTimer);
-        }
-        
-        m_autoSaveTimer->start(autoSaveInterval * 60 * 1000); // Convert minutes to milliseconds
-        LOG_INFO("Auto-save enabled with {} minute interval", autoSaveInterval);
-    } else {
-        if (m_autoSaveTimer) {
-            m_autoSaveTimer->stop();
+    TRACE_SCOPE("playlist", "PlaylistManager::ensureSongsLoaded");
+    std::string_view raw;
+    std::shared_ptr<const std::string> snapshot;    // Keeps raw valid while parsing unlocked
+    std::shared_ptr<const playlist::BinarySnapshot> binary;
+    {
+        QReadLocker locker(&m_dataLock);
+        auto it = m_unloadedSongs.constFind(playlistId);
+        if (it == m_unloadedSongs.constEnd()) {
+            return;
         }
-        LOG_INFO("Auto-save disabled");
+        raw = it.value();
+        snapshot = m_snapshotText;
+        binary = m_binarySnapshot;
     }
-}
-
-bool PlaylistManager::saveCategoriesToJsonFile()
-{
-    QString categoryFilePath = m_configManager->getCategoriesFilePath();
-    QString workspaceDir = m_configManager->getWorkspaceDirectory();
-    QString fullPath = QDir(workspaceDir).absoluteFilePath(categoryFilePath);
-    
-    Json::Value root(Json::objectValue);
-    Json::Value categoriesArray(Json::arrayValue);
     
-    // Convert hashmap structure to JSON (with read lock)
-    QReadLocker locker(&m_dataLock);
-    for (auto catIt = m_categories.begin(); catIt != m_categories.end(); ++catIt) {
-        const playlist::CategoryInfo& category = catIt.value();
-        Json::Value categoryObj(Json::objectValue);
-        categoryObj["uuid"] = category.uuid.toString().toStdString();
-        categoryObj["name"] = category.name.toStdString();
-        
-        // Get playlists for this category
-        Json::Value playlistsArray(Json::arrayValue);
-        auto playlistIds = m_categoryPlaylists.value(category.uuid);
-        for (const QUuid& playlistId : playlistIds) {
-            auto playlistIt = m_playlists.find(playlistId);
-            if (playlistIt != m_playlists.end()) {
-                const playlist::PlaylistInfo& playlist = playlistIt.value();
-                Json::Value playlistObj(Json::objectValue);
-                playlistObj["uuid"] = playlist.uuid.toString().toStdString();
-                playlistObj["name"] = playlist.name.toStdString();
-                playlistObj["creator"] = playlist.creator.toStdString();
-                playlistObj["description"] = playlist.description.toStdString();
-                playlistObj["coverUri"] = playlist.coverUri.toStdString();
-                
-                // Get songs for this playlist
-                Json::Value songsArray(Json::arrayValue);
-                auto songs = m_playlistSongs.value(playlistId);
-                for (const playlist::SongInfo& song : songs) {
-                    Json::Value songObj(Json::objectValue);
-                    songObj["title"] = song.title.toStdString();
-                    songObj["uploader"] = song.uploader.toStdString();
-                    songObj["platform"] = song.platform;
-                    songObj["duration"] = song.duration;
-                    songObj["filepath"] = song.filepath.toStdString();
-                    songObj["coverName"] = song.coverName.toStdString();
-                    songObj["args"] = song.args.toStdString();
-                    songObj["uuid"] = song.uuid.toString().toStdString();  // Save UUID for future SQLite migration
-                    songsArray.append(songObj);
-                }
-                playlistObj["songs"] = songsArray;
-                playlistsArray.append(playlistObj);
-            }
+    QList<playlist::SongInfo> songs;
+    if (!raw.empty()) {
+        songs = songsFromJsonText(raw);
+    } else if (binary) {
+        songs = binary->songs(binary->findPlaylist(playlistId));
+    } else {
+        std::lock_guard<std::mutex> storeLock(m_storeMutex);
+        if (!m_store || !m_store->loadSongs(playlistId, songs)) {
+            LOG_ERROR("Failed to load the songs of playlist {} from the database", playlistId.toString().toStdString());
         }
-        categoryObj["playlists"] = playlistsArray;
-        categoriesArray.append(categoryObj);
     }
-    
-    root["categories"] = categoriesArray;
-    root["currentPlaylistId"] = m_currentPlaylistId.toString().toStdString();
-    locker.unlock(); // Unlock before file I/O
-    
-    // Write to file
-    std::ofstream file(fullPath.toStdString());
-    if (!file.is_open()) {
-        LOG_ERROR("Failed to open file for writing: {}", fullPath.toStdString());
-        return false;
+    for (playlist::SongInfo& song : songs) {
+        internSongStrings(song);
     }
     
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "  ";
-    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-    writer->write(root, &file);
-    file.close();
-    
-    LOG_INFO("Categories saved to: {}", fullPath.toStdString());
-    return true;
+    DataWriteLocker locker(this);
+    if (!m_unloadedSongs.remove(playlistId)) {
+        return;     // Loaded by another thread meanwhile
+    }
+    for (const Json::Value& record : m_deferredSongRecords.take(playlistId)) {
+        applySongRecord(songs, record);
+    }
+    QHash<QUuid, int>& index = m_songUuidIndex[playlistId];
+    index.clear();
+    for (int i = 0; i < songs.size(); ++i) {
+        index.insert(songs[i].uuid, i);
+    }
+    LOG_DEBUG("Loaded {} songs of playlist {}", songs.size(), playlistId.toString().toStdString());
+    m_playlistSongs.insert(playlistId, std::move(songs));
+    if (m_unloadedSongs.isEmpty()) {
+        // Nothing left to read from the snapshot; unmapped, the file can be replaced
+        m_snapshotText.reset();
+        m_binarySnapshot.reset();
+    }
 }
 
-bool PlaylistManager::loadCategoriesFromJsonFile()
+void PlaylistManager::ensureAllSongsLoaded() const
 {
-    QString categoryFilePath = m_configManager->getCategoriesFilePath();
-    QString workspaceDir = m_configManager->getWorkspaceDirectory();
-    QString fullPath = QDir(workspaceDir).absoluteFilePath(categoryFilePath);
-    
-    QFileInfo fileInfo(fullPath);
-    if (!fileInfo.exists()) {
-        LOG_INFO("Category file does not exist: {}, will create default setup", fullPath.toStdString());
-        ensureDefaultSetup();
-        return false;
-    }
-    
-    std::ifstream file(fullPath.toStdString());
-    if (!file.is_open()) {
-        LOG_ERROR("Failed to open category file: {}", fullPath.toStdString());
-        return false;
+    QList<QUuid> playlistIds;
+    {
+        QReadLocker locker(&m_dataLock);
+        playlistIds = m_unloadedSongs.keys();
     }
-    
-    Json::Value root;
-    Json::CharReaderBuilder builder;
-    std::string errs;
-    if (!Json::parseFromStream(builder, file, &root, &errs)) {
-        LOG_ERROR("JSON parse error in category file: {}", errs);
-        file.close();
-        return false;
+    for (const QUuid& playlistId : playlistIds) {
+        ensureSongsLoaded(playlistId);
     }
-    file.close();
-    
-    {
-        QWriteLocker locker(&m_dataLock);
-        
-        // Clear existing data
-        m_categories.clear();
-        m_playlists.clear();
-        m_categoryPlaylists.clear();
-        m_playlistSongs.clear();
-    
-        const Json::Value& categoriesArray = root["categories"];
-        
-        // Load categories and playlists
-        for (const Json::Value& categoryValue : categoriesArray) {
-            playlist::CategoryInfo category;
-            category.uuid = QUuid::fromString(QString::fromStdString(categoryValue["uuid"].asString()));
-            category.name = QString::fromStdString(categoryValue["name"].asString());
-            
-            // Add category
-            m_categories.insert(category.uuid, category);
+}
+
+bool PlaylistManager::applyJournalRecord(const Json::Value& record)
+{
+    const std::string op = record["op"].asString();
+    if (op == "addCategory" || op == "updateCategory") {
+        playlist::CategoryInfo category = categoryFromJson(record["category"]);
+        if (op == "updateCategory" && !m_categories.contains(category.uuid)) {
+            return false;
+        }
+        m_categories.insert(category.uuid, category);
+        if (!m_categoryPlaylists.contains(category.uuid)) {
             m_categoryPlaylists.insert(category.uuid, QList<QUuid>());
-            
-            // Load playlists for this category
-            const Json::Value& playlistsArray = categoryValue["playlists"];
-            for (const Json::Value& playlistValue : playlistsArray) {
-                playlist::PlaylistInfo playlist;
-                playlist.uuid = QUuid::fromString(QString::fromStdString(playlistValue["uuid"].asString()));
-                playlist.name = QString::fromStdString(playlistValue["name"].asString());
-                playlist.creator = QString::fromStdString(playlistValue["creator"].asString());
-                playlist.description = QString::fromStdString(playlistValue["description"].asString());
-                playlist.coverUri = QString::fromStdString(playlistValue["coverUri"].asString());
-                
-                // Add playlist
-                m_playlists.insert(playlist.uuid, playlist);
-                m_categoryPlaylists[category.uuid].append(playlist.uuid);
-                
-                // Load songs for this playlist
-                QList<playlist::SongInfo> songs;
-                const Json::Value& songsArray = playlistValue["songs"];
-                for (const Json::Value& songValue : songsArray) {
-                    playlist::SongInfo song;
-                    song.title = QString::fromStdString(songValue["title"].asString());
-                    song.uploader = QString::fromStdString(songValue["uploader"].asString());
-                    song.platform = songValue["platform"].asInt();
-                    song.duration = songValue["duration"].asInt();
-                    song.filepath = QString::fromStdString(songValue["filepath"].asString());
-                    song.coverName = QString::fromStdString(songValue["coverName"].asString());
-                    song.args = QString::fromStdString(songValue["args"].asString());
-                    // Load UUID from JSON or generate new one if not present
-                    QString uuidStr = QString::fromStdString(songValue["uuid"].asString());
-                    song.uuid = uuidStr.isEmpty() ? QUuid::createUuid() : QUuid::fromString(uuidStr);
-                    
-                    songs.append(song);
-                }
-                m_playlistSongs.insert(playlist.uuid, songs);
-            }
         }
-
-        // Load current playlist ID
-        QString currentPlaylistIdStr = QString::fromStdString(root["currentPlaylistId"].asString());
-        m_currentPlaylistId = QUuid::fromString(currentPlaylistIdStr);
-        
-        // Ensure all songs have UUIDs (for backward compatibility with old JSON files)
-        for (auto it = m_playlistSongs.begin(); it != m_playlistSongs.end(); ++it) {
-            for (auto& song : it.value()) {
-                if (song.uuid.isNull()) {
-                    song.uuid = QUuid::createUuid();
-                }
-            }
+    } else if (op == "removeCategory") {
+        const QUuid categoryId = uuidFromJson(record["categoryId"]);
+        m_categories.remove(categoryId);
+        m_categoryPlaylists.remove(categoryId);
+    } else if (op == "addPlaylist") {
+        playlist::PlaylistInfo playlist = playlistFromJson(record["playlist"]);
+        const QUuid categoryId = uuidFromJson(record["categoryId"]);
+        if (!m_categories.contains(categoryId) || m_playlists.contains(playlist.uuid)) {
+            return false;
         }
-        
-        // Build UUID indices for fast O(1) lookups
+        m_playlists.insert(playlist.uuid, playlist);
+        m_playlistSongs.insert(playlist.uuid, QList<playlist::SongInfo>());
+        m_categoryPlaylists[categoryId].append(playlist.uuid);
+    } else if (op == "updatePlaylist") {
+        playlist::PlaylistInfo playlist = playlistFromJson(record["playlist"]);
+        if (!m_playlists.contains(playlist.uuid)) {
+            return false;
+        }
+        m_playlists[playlist.uuid] = playlist;
+    } else if (op == "removePlaylist") {
+        const QUuid playlistId = uuidFromJson(record["playlistId"]);
+        for (auto it = m_categoryPlaylists.begin(); it != m_categoryPlaylists.end(); ++it) {
+            it.value().removeAll(playlistId);
+        }
+        m_playlists.remove(playlistId);
+        m_playlistSongs.remove(playlistId);
+        m_unloadedSongs.remove(playlistId);
+        m_deferredSongRecords.remove(playlistId);
+    } else if (op == "addSong" || op == "updateSong" || op == "removeSong") {
+        const QUuid playlistId = uuidFromJson(record["playlistId"]);
+        if (m_unloadedSongs.contains(playlistId)) {
+            m_deferredSongRecords[playlistId].push_back(record);
+            return true;
+        }
+        auto songsIt = m_playlistSongs.find(playlistId);
+        return songsIt != m_playlistSongs.end() && applySongRecord(songsIt.value(), record);
+    } else if (op == "setSongLoudness") {
+        bool applied = false;
         for (auto it = m_playlistSongs.begin(); it != m_playlistSongs.end(); ++it) {
-            rebuildSongUuidIndex(it.key());
+            applied = applySongRecord(it.value(), record) || applied;
+        }
+        for (auto it = m_unloadedSongs.cbegin(); it != m_unloadedSongs.cend(); ++it) {
+            m_deferredSongRecords[it.key()].push_back(record);
         }
+        return applied || !m_unloadedSongs.isEmpty();
+    } else if (op == "setCurrentPlaylist") {
+        m_currentPlaylistId = uuidFromJson(record["playlistId"]);
+    } else {
+        LOG_WARN("Unknown playlist journal record: {}", op);
+        return false;
     }
-    
-    LOG_INFO("Loaded {} categories with {} playlists from {}", 
-             m_categories.size(), m_playlists.size(), fullPath.toStdString());
     return true;
 }
 
@@ -994,16 +2512,22 @@ QString PlaylistManager::generateStreamingFilepath(const playlist::SongInfo& son
     // song.platform is not an enum type directly; cast it to the actual enum used by NetworkManager
     QString platformStr = QString::number(static_cast<int>(song.platform));
     
-    // Create a comprehensive hash from multiple song properties for uniqueness
-    std::string titleHash = util::md5Hash(song.title.toStdString()),
-                uploaderHash = util::md5Hash(song.uploader.toStdString()),
-                argsHash = util::md5Hash(song.args.toStdString());
-    std::string mixedStr = fmt::format("{}{}{}", titleHash, uploaderHash, argsHash);
-    std::string result = util::md5Hash(mixedStr);
+    // Create a comprehensive hash from multiple song properties for uniqueness.
+    // Songs added by earlier versions keep their stored MD5-based paths
+    util::ContentHasher hasher;
+    for (const QString& field : { song.title, song.uploader, song.args }) {
+        hasher.update(field.toStdString());
+        hasher.update(std::string_view("\0", 1));    // So ("ab", "c") and ("a", "bc") differ
+    }
+    std::string result = hasher.digest().hex();
     
     // Safe filename format: "platform_hash.audio"
     QString filename = QString("%1_%2.audio").arg(platformStr).arg(QString::fromStdString(result));
     
+    if (m_audioCacheStore) {
+        return QString::fromStdString(m_audioCacheStore->pathFor(filename.toStdString()));
+    }
+
     // Get audio cache directory from ConfigManager
     QString cacheDir = m_configManager->getAudioCacheDirectory();
     if (cacheDir.isEmpty()) {
@@ -1020,7 +2544,7 @@ QString PlaylistManager::generateStreamingFilepath(const playlist::SongInfo& son
 QUuid PlaylistManager::ensureDefaultSetup()
 {
     QUuid categoryUuid;
-    QWriteLocker locker(&m_dataLock);
+    DataWriteLocker locker(this);
     if (m_categories.empty()) {
         playlist::CategoryInfo defaultCategory;
         defaultCategory.name = "Default Category";
@@ -1028,6 +2552,7 @@ QUuid PlaylistManager::ensureDefaultSetup()
         
         m_categories.insert(defaultCategory.uuid, defaultCategory);
         m_categoryPlaylists.insert(defaultCategory.uuid, QList<QUuid>());
+        journal(change("addCategory", "category", categoryToJson(defaultCategory)));
         categoryUuid = defaultCategory.uuid;
         LOG_INFO("Created default category: {} ({})", 
                  defaultCategory.name.toStdString(), defaultCategory.uuid.toString().toStdString());
@@ -1048,12 +2573,17 @@ QUuid PlaylistManager::ensureDefaultSetup()
         m_playlistSongs.insert(favoritePlaylist.uuid, QList<playlist::SongInfo>());
         m_categoryPlaylists[categoryUuid].append(favoritePlaylist.uuid);
         m_currentPlaylistId = favoritePlaylist.uuid;
+        Json::Value record = change("addPlaylist", "playlist", playlistToJson(favoritePlaylist));
+        record["categoryId"] = categoryUuid.toString().toStdString();
+        journal(record);
+        journal(change("setCurrentPlaylist", "playlistId", favoritePlaylist.uuid.toString().toStdString()));
         emit playlistAdded(favoritePlaylist, categoryUuid);
         LOG_INFO("Created favorite playlist: {} ({}) in category: {}", 
              favoritePlaylist.name.toStdString(), favoritePlaylist.uuid.toString().toStdString(), categoryUuid.toString().toStdString());
     } else {
         QUuid firstPlaylistId = m_categoryPlaylists.value(categoryUuid).first();
         m_currentPlaylistId = firstPlaylistId;
+        journal(change("setCurrentPlaylist", "playlistId", firstPlaylistId.toString().toStdString()));
         LOG_INFO("Default setup exists with category: {} and playlist: {}", 
                  categoryUuid.toString().toStdString(), firstPlaylistId.toString().toStdString());
     }
@@ -1066,6 +2596,7 @@ std::optional<QUuid> PlaylistManager::getNextSong(const QUuid& currentSongId,
                                                    const QUuid& playlistId,
                                                    playlist::PlayMode mode)
 {
+    ensureSongsLoaded(playlistId);
     QReadLocker locker(&m_dataLock);
     
     // Validate inputs
@@ -1109,14 +2640,12 @@ std::optional<QUuid> PlaylistManager::getNextSong(const QUuid& currentSongId,
         }
         
         case playlist::PlayMode::Random: {
-            // Random next song: pick random from playlist
-            if (songs.size() == 1) {
-                return currentSongId;
-            }
-            int randomIndex = QRandomGenerator::global()->bounded(songs.size());
-            LOG_DEBUG("getNextSong: Random mode - selected random index {} from {} songs", 
-                      randomIndex, songs.size());
-            return songs[randomIndex].uuid;
+            // Next of the playlist's shuffle round
+            std::lock_guard<std::mutex> shuffleLock(m_shuffleMutex);
+            auto nextSongId = shuffleBag(playlistId, songs).next(currentSongId);
+            m_shuffleDirty = true;
+            LOG_DEBUG("getNextSong: Random mode - moving from index {} to the next of the shuffle round", currentIndex);
+            return nextSongId;
         }
         
         default:
@@ -1129,6 +2658,7 @@ std::optional<QUuid> PlaylistManager::getPreviousSong(const QUuid& currentSongId
                                                        const QUuid& playlistId,
                                                        playlist::PlayMode mode)
 {
+    ensureSongsLoaded(playlistId);
     QReadLocker locker(&m_dataLock);
     
     // Validate inputs
@@ -1172,14 +2702,12 @@ std::optional<QUuid> PlaylistManager::getPreviousSong(const QUuid& currentSongId
         }
         
         case playlist::PlayMode::Random: {
-            // Random previous song: pick random from playlist
-            if (songs.size() == 1) {
-                return currentSongId;
-            }
-            int randomIndex = QRandomGenerator::global()->bounded(songs.size());
-            LOG_DEBUG("getPreviousSong: Random mode - selected random index {} from {} songs", 
-                      randomIndex, songs.size());
-            return songs[randomIndex].uuid;
+            // Back along the playlist's shuffle round
+            std::lock_guard<std::mutex> shuffleLock(m_shuffleMutex);
+            auto previousSongId = shuffleBag(playlistId, songs).previous(currentSongId);
+            m_shuffleDirty = true;
+            LOG_DEBUG("getPreviousSong: Random mode - moving from index {} back along the shuffle round", currentIndex);
+            return previousSongId;
         }
         
         default:
@@ -4,17 +4,34 @@
 #include <QString>
 #include <QList>
 #include <QHash>
+#include <QSet>
 #include <QUuid>
 class QTimer;
+class QFileSystemWatcher;
 #include <QReadWriteLock>
 #include <QTextStream>
 #include <QFile>
 #include <optional>
+#include <atomic>
 #include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "playlist.h"
+#include "shuffle_bag.h"
+#include "song_search_index.h"
+#include "song_identity_table.h"
+#include <util/string_pool.h>
 
 // Forward declarations
 class ConfigManager;
+namespace util { class AudioCacheStore; class CoverCache; class ThreadPool; }
+namespace Json { class Value; }
+namespace playlist { class SqlitePlaylistStore; class BinarySnapshot; class LocalMetadataCache; struct LocalFileMetadata; }
 
 /**
  * @brief Enumeration for playlist item deletion behavior
@@ -35,17 +52,48 @@ enum class DeletionBehavior {
  * Each category and playlist has unique QUuid identifier for safe management
  * All file operations are constrained to workspace directory
  * Uses JSON format for saving category-playlist hierarchical data
+ *
+ * The JSON file is a snapshot; changes made since are kept in a journal next to it
+ * (same name plus ".journal", one JSON record per line) and replayed on load. A save
+ * appends the changes made since the last one, so it costs the changes rather than the
+ * library; once the journal holds JOURNAL_COMPACT_RECORDS records the snapshot is
+ * rewritten and the journal emptied. Records carry sequence numbers and the snapshot
+ * the last one it contains, so a journal left behind by an interrupted compaction is
+ * not applied twice.
+ *
+ * With the PlaylistStorage setting at "binary" the snapshot is a playlist::BinarySnapshot
+ * (same name, ".bin" suffix) instead, memory-mapped and read in place. Either format is
+ * loaded if it is the only one there, so switching converts the library on the next
+ * compaction, which also removes the snapshot in the other format.
+ *
+ * With the PlaylistStorage setting at "sqlite" the same records are written to a
+ * SqlitePlaylistStore instead, one transaction per save, and the snapshot files are only
+ * read once to import an existing library.
+ *
+ * Loading reads categories and playlist headers only. A playlist's songs are read the
+ * first time they are used (ensureSongsLoaded): from the snapshot text kept for it, the
+ * songs arrays having been skipped unparsed, from the mapped binary snapshot, or with one
+ * indexed query. Journal records for songs not loaded yet wait until they are. initialize() loads the current playlist
+ * in the background so playback can resume without waiting for it.
  * 
  * Config use:
  * CategoryFilePath: path to JSON file storing category and playlist data
  * AutoSaveEnabled: whether to auto-save changes periodically
  * AutoSaveInterval: interval in minutes for auto-saving (default 5 minutes)
+ * PlaylistStorage: "json", "binary" or "sqlite"
  */
 class PlaylistManager : public QObject
 {
     Q_OBJECT
     
 public:
+    static constexpr int JOURNAL_COMPACT_RECORDS = 5000;
+    // Local files probed at once, and the songs of a folder import added per batch
+    static constexpr size_t LOCAL_PROBE_THREADS = 4;
+    static constexpr int LOCAL_IMPORT_BATCH = 200;
+    // Quiet time after a change to a watched folder before it is rescanned
+    static constexpr int LOCAL_RESCAN_DELAY_MS = 2000;
+
     explicit PlaylistManager(ConfigManager* configManager, QObject* parent = nullptr);
     ~PlaylistManager();
     
@@ -53,6 +101,14 @@ public:
     void initialize();
     bool loadCategoriesFromFile();
     void saveAllCategories();
+    // Idle mode: stop the auto-save timer, and restart it when resumed. Nothing changes
+    // while idle, and shutdown saves anyway
+    void setAutoSaveSuspended(bool suspended);
+    // Streaming songs get their file names in this store's directory; without one the
+    // configured audio cache directory is used directly
+    void setAudioCacheStore(std::shared_ptr<util::AudioCacheStore> store);
+    // Share the cover cache index with the other managers; call before initialize()
+    void setCoverCache(std::shared_ptr<util::CoverCache> cache);
     
     // Category operations with UUID-based identification
     bool addCategory(const playlist::CategoryInfo& category);
@@ -70,9 +126,41 @@ public:
     // Song operations
     bool addSongToPlaylist(const playlist::SongInfo& song, const QUuid& playlistId);
     bool removeSongFromPlaylist(const playlist::SongInfo& song, const QUuid& playlistId);
+    // Batches under one lock and one index update, signalled once by songsAdded/songsRemoved.
+    // Return how many songs were added or removed
+    int addSongsToPlaylist(const QList<playlist::SongInfo>& songs, const QUuid& playlistId);
+    int removeSongsFromPlaylist(const QList<playlist::SongInfo>& songs, const QUuid& playlistId);
+    /**
+     * Import the audio files in directory and its subdirectories into the playlist, in the
+     * background: each file is probed (metadata and cover) on a bounded pool of workers,
+     * and the songs are added in batches of LOCAL_IMPORT_BATCH as they are ready.
+     * localImportProgress follows along, localImportFinished ends it. Cancelling keeps the
+     * batches added so far.
+     * Importing a folder again rescans it: only files new or changed since they were probed
+     * are probed, and songs whose files are gone are removed. Imported folders are watched
+     * and rescanned as files come and go; those rescans leave out files the user removed
+     * from the playlist, which only importing the folder again brings back.
+     * @return false if an import is running already or the playlist doesn't exist
+     */
+    bool importLocalFolder(const QString& directory, const QUuid& playlistId);
+    void cancelLocalImport();
+    bool isImportingLocalFolder() const { return m_importRunning.load(); }
     bool updateSongInPlaylist(const playlist::SongInfo& song, const QUuid& playlistId);
+    // Store a loudness analysis result in every playlist containing the song
+    bool setSongLoudness(const QUuid& songId, float gainDb);
     std::optional<playlist::SongInfo> getSongFromPlaylist(const QUuid& songId, const QUuid& playlistId) const;
     QList<playlist::SongInfo> iterateSongsInPlaylist(const QUuid& playlistId, std::function<bool(const playlist::SongInfo&)> func) const;
+    // The playlist's songs as of the last change: a shared, immutable list rather than a
+    // copy, taken without m_dataLock so a save or an import never holds the caller up.
+    // Empty for an unknown playlist
+    QList<playlist::SongInfo> songsSnapshot(const QUuid& playlistId) const;
+    // Songs of every playlist whose title or uploader match query, best first (see
+    // playlist::SongSearchIndex). The first search loads all songs to build the index;
+    // later ones cost the query alone
+    QList<playlist::SongSearchHit> searchSongs(const QString& query, int limit = 50) const;
+    // The copies of the song in the library, in this playlist or others, that play the same
+    // media (see playlist::SongIdentityTable)
+    QList<playlist::SongIdentityTable::SongRef> songCopies(const QUuid& songId, const QUuid& playlistId) const;
 
     // UUID-based lookup
     bool categoryExists(const QUuid& categoryId) const;
@@ -98,8 +186,7 @@ public:
      * - Normal: Next track in sequence, empty at end
      * - Repeat: Wraps to beginning at end
      * - RepeatOne: Returns same track
-     * - Shuffle: Returns next in shuffled order
-     * - Random: Returns random track from playlist
+     * - Random: Returns the next song of the playlist's shuffle bag, see playlist::ShuffleBag
      * 
      * Phase 3d (US4): Implement actual navigation logic
      */
@@ -119,8 +206,7 @@ public:
      * - Normal: Previous track in sequence, empty at start
      * - Repeat: Wraps to end at beginning
      * - RepeatOne: Returns same track
-     * - Shuffle: Returns previous in shuffled order
-     * - Random: Returns random track from playlist
+     * - Random: Returns the song played before in the playlist's shuffle bag
      * 
      * Phase 3d (US4): Implement actual navigation logic
      */
@@ -138,7 +224,14 @@ signals:
     void songRemoved(const playlist::SongInfo& song, const QUuid& playlistId);
     void songUpdated(const playlist::SongInfo& song, const QUuid& playlistId);
     void playlistSongsChanged(const QUuid& playlistId);
+    // A batch, in place of songAdded/songRemoved and playlistSongsChanged per song. Added
+    // songs are appended: they are the playlist's songs from index first on
+    void songsAdded(const QList<playlist::SongInfo>& songs, const QUuid& playlistId, int first);
+    void songsRemoved(const QList<playlist::SongInfo>& songs, const QUuid& playlistId);
     void categoriesLoaded(int categoryCount, int playlistCount);
+    // From the import's thread: files probed of those found, then the songs added
+    void localImportProgress(const QUuid& playlistId, int probed, int found);
+    void localImportFinished(const QUuid& playlistId, int added, bool cancelled);
     void currentPlaylistChanged(const QUuid& playlistId);
     
     /**
@@ -172,12 +265,88 @@ private:
     // Initialization helpers
     void ensurePlaylistDirectoryExists();
     void setupAutoSave();
+    // Rewrites the snapshot and empties the journal
     bool saveCategoriesToJsonFile();
     bool loadCategoriesFromJsonFile();
+    bool saveCategoriesToBinaryFile();
+    bool loadCategoriesFromBinaryFile();
+    // Load the snapshot in the configured format, or in the other if only it exists
+    bool loadCategoriesFromSnapshot();
+    // After a snapshot was written: drop the journal it covers and the stale other format
+    void journalCompacted(size_t coveredRecords, const QString& staleSnapshot);
+    // Empty the library; m_dataLock must be held for writing
+    void clearLibrary();
+    // Copy of the whole library; call with m_dataLock held and every playlist's songs loaded
+    playlist::LibraryContents libraryContents() const;
+    bool useBinarySnapshot() const;
+    QString categoriesFilePath() const;
+    QString binarySnapshotFilePath() const;
+    QString journalFilePath() const;
+    QString shuffleFilePath() const;
+    // Queue a change record for the next save. Call it with m_dataLock held for writing,
+    // so records are queued in the order the changes were made
+    void journal(const Json::Value& change);
+    // Append the queued records to the journal file
+    bool appendJournal();
+    // Apply the journal records newer than snapshotSeq; m_dataLock must be held for writing
+    void replayJournal(uint64_t snapshotSeq);
+    bool applyJournalRecord(const Json::Value& record);
+    // Put records that failed to save back in front of those queued meanwhile
+    void requeueJournal(std::vector<Json::Value> records);
+    // SQLite storage: open it if configured, load (importing the JSON files into an empty
+    // database), and write the queued records
+    void openStore();
+    bool loadCategoriesFromStore();
+    bool saveChangesToStore();
+    // Lazy loading: read a playlist's songs if not yet read. Call without m_dataLock held
+    void ensureSongsLoaded(const QUuid& playlistId) const;
+    void ensureAllSongsLoaded() const;
+    
+    // Write lock on m_dataLock publishing the songs on release; use it instead of QWriteLocker
+    class DataWriteLocker;
+    // Publish m_playlistSongs if changed since last time; call with m_dataLock held for writing
+    void publishSongs() const;
     
     // Helper methods
     QUuid getPlaylistCategoryId(const QUuid& playlistId) const;
     QString generateStreamingFilepath(const playlist::SongInfo& song) const;
+    // The song as stored: local files marked as such, streams given their cache path.
+    // Empty if it can't be added
+    std::optional<playlist::SongInfo> songToStore(const playlist::SongInfo& song) const;
+    // The playlist's shuffle bag, made (or restored from the shuffle file) on first use.
+    // Caller holds m_shuffleMutex and m_dataLock
+    playlist::ShuffleBag& shuffleBag(const QUuid& playlistId, const QList<playlist::SongInfo>& songs);
+    void readShuffleFile();
+    bool saveShuffleBags();
+    // Share the song's repeated strings through m_stringPool
+    void internSongStrings(playlist::SongInfo& song) const;
+    // Give a song about to be added what the library's copies of it know: cache file,
+    // cover, duration and loudness
+    void adoptSharedFields(playlist::SongInfo& song) const;
+    // And what one copy learned, to the others
+    void shareWithCopies(const playlist::SongInfo& song, const QUuid& playlistId);
+    // Builds the table first if needed; m_identityMutex held
+    playlist::SongIdentityTable& identityTable() const;
+    // Read a local song's duration, artist and cover into the playlist; blocks
+    void probeLocalSong(const playlist::SongInfo& song, const QUuid& playlistId);
+    // addSongsToPlaylist(), queueing local songs for probing only if probeLocal
+    int insertSongs(const QList<playlist::SongInfo>& songs, const QUuid& playlistId, bool probeLocal);
+    // Queue probeLocalSong() on the probe pool
+    void queueLocalProbe(const playlist::SongInfo& song, const QUuid& playlistId);
+    // The local file's metadata and cover, probed unless cached for the file as it is; blocks
+    playlist::LocalFileMetadata localFileMetadata(const QString& path);
+    // A song for the local file at path, its metadata and cover read; blocks
+    playlist::SongInfo probeLocalFile(const QString& path);
+    // Start runLocalImport() on m_importThread; false if one is running already
+    bool startLocalImport(const QString& directory, const QUuid& playlistId, bool rescan);
+    // A rescan adds only files no scan has probed before: those probed but no longer in
+    // the playlist were removed by the user and stay out
+    void runLocalImport(const QString& directory, const QUuid& playlistId, bool rescan);
+    util::ThreadPool& probePool();
+    QString localMetadataFilePath() const;
+    void watchLocalFolder(const QString& directory);
+    void onLocalFolderChanged(const QString& path);
+    void rescanPendingFolders();
     
     // UUID index maintenance methods (O(1) lookups)
     void rebuildSongUuidIndex(const QUuid& playlistId);
@@ -188,6 +357,7 @@ private:
     QUuid ensureDefaultSetup();
     
     ConfigManager* m_configManager;
+    std::shared_ptr<util::AudioCacheStore> m_audioCacheStore;
     
     // Thread synchronization
     mutable QReadWriteLock m_dataLock;
@@ -198,13 +368,73 @@ private:
     
     // Relationship mappings
     QHash<QUuid, QList<QUuid>> m_categoryPlaylists; // CategoryId -> List of PlaylistIds
-    QHash<QUuid, QList<playlist::SongInfo>> m_playlistSongs;
+    // Songs of the loaded playlists; filled in by ensureSongsLoaded(), hence mutable
+    mutable QHash<QUuid, QList<playlist::SongInfo>> m_playlistSongs;
+    // Copy-on-write view of m_playlistSongs for songsSnapshot(), replaced as each write lock
+    // is released (DataWriteLocker). Accessed with std::atomic_load/store only
+    mutable std::shared_ptr<const QHash<QUuid, QList<playlist::SongInfo>>> m_publishedSongs;
     
     // UUID indexing for O(1) lookups instead of O(n) linear search
     // Structure: PlaylistId -> (SongUuid -> Index in songs list)
-    QHash<QUuid, QHash<QUuid, int>> m_songUuidIndex;
+    mutable QHash<QUuid, QHash<QUuid, int>> m_songUuidIndex;
+    
+    // Playlists whose songs are not loaded yet -> their raw "songs" JSON in m_snapshotText,
+    // empty to read them from m_binarySnapshot or, without one, m_store. Guarded by
+    // m_dataLock like the data above
+    mutable QHash<QUuid, std::string_view> m_unloadedSongs;
+    mutable QHash<QUuid, std::vector<Json::Value>> m_deferredSongRecords;   // Replayed, waiting for their songs
+    // The snapshot loaded from, released once all songs are loaded
+    mutable std::shared_ptr<const std::string> m_snapshotText;
+    mutable std::shared_ptr<const playlist::BinarySnapshot> m_binarySnapshot;
+    std::thread m_songPrefetch;
+    
+    // Local file probes, a few at a time however many files come in
+    std::once_flag m_probePoolCreated;
+    std::unique_ptr<util::ThreadPool> m_probePool;
+    std::shared_ptr<util::CoverCache> m_coverCache;
+    std::atomic<bool> m_shuttingDown{false};        // Queued probes are skipped
+    std::thread m_importThread;
+    std::atomic<bool> m_importRunning{false};
+    std::atomic<bool> m_importCancelled{false};
+    std::unique_ptr<playlist::LocalMetadataCache> m_localMetadata;
+    QFileSystemWatcher* m_folderWatcher;
+    QTimer* m_rescanTimer;
+    QSet<QString> m_pendingRescans;     // Imported folders changed, waiting on m_rescanTimer
+    // Uploaders, file paths and cover names as loaded or added, shared between the songs
+    // that repeat them
+    mutable util::StringPool m_stringPool;
+    
+    // Built by the first search, then updated from the song signals. Locked before m_dataLock
+    mutable std::mutex m_searchMutex;
+    mutable std::unique_ptr<playlist::SongSearchIndex> m_searchIndex;
+    
+    // Songs by identity, built when first needed, then updated from the song signals.
+    // Locked before m_dataLock
+    mutable std::mutex m_identityMutex;
+    mutable std::unique_ptr<playlist::SongIdentityTable> m_identities;
+    
+    // Random play orders by playlist, updated from the song signals. Locked after m_dataLock
+    std::mutex m_shuffleMutex;
+    std::map<QUuid, playlist::ShuffleBag> m_shuffleBags;
+    struct SavedShuffleBag {
+        QList<QUuid> order;
+        QUuid current;
+    };
+    QHash<QUuid, SavedShuffleBag> m_savedShuffleBags;   // Read from the shuffle file, until restored
+    bool m_shuffleFileRead = false;
+    bool m_shuffleDirty = false;        // The bags moved on since saved
+    
+    // Journal state. Lock order: m_saveMutex, m_dataLock, m_journalMutex
+    std::mutex m_saveMutex;             // One save at a time
+    std::mutex m_journalMutex;
+    std::vector<Json::Value> m_journalPending;  // Records not saved yet
+    int m_journalRecords = 0;           // Records in the journal file
+    uint64_t m_journalSeq = 0;          // Sequence number of the latest record
+    std::unique_ptr<playlist::SqlitePlaylistStore> m_store;     // Null when storing JSON
+    mutable std::mutex m_storeMutex;    // m_store is not thread-safe; taken after m_saveMutex, before m_dataLock
     
     QTimer* m_autoSaveTimer;
+    bool m_autoSaveSuspended = false;
     QUuid m_currentPlaylistId;
     bool m_initialized = false;
 };
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "shuffle_bag.h"
+#include <QSet>
+#include <algorithm>
+
+using namespace playlist;
+
+namespace {
+    // Gaps left by removed songs are squeezed out once they outnumber the songs
+    constexpr int MIN_COMPACT_GAPS = 32;
+}
+
+ShuffleBag::ShuffleBag(const QList<QUuid>& songs, uint32_t seed)
+    : random_(seed)
+{
+    order_.reserve(static_cast<size_t>(songs.size()));
+    for (const QUuid& songId : songs) {
+        if (!songId.isNull() && !position_.contains(songId)) {
+            position_.insert(songId, static_cast<int>(order_.size()));
+            order_.push_back(songId);
+        }
+    }
+    reshuffle(QUuid());
+}
+
+ShuffleBag ShuffleBag::restore(const QList<QUuid>& order, const QUuid& current, const QList<QUuid>& songs)
+{
+    const QSet<QUuid> present(songs.cbegin(), songs.cend());
+    ShuffleBag bag(QList<QUuid>{});
+    for (const QUuid& songId : order) {
+        if (present.contains(songId) && !bag.position_.contains(songId)) {
+            bag.position_.insert(songId, static_cast<int>(bag.order_.size()));
+            bag.order_.push_back(songId);
+        }
+    }
+    bag.cursor_ = bag.position_.value(current, -1);
+    for (const QUuid& songId : songs) {
+        bag.insert(songId);
+    }
+    return bag;
+}
+
+std::optional<QUuid> ShuffleBag::next(const QUuid& current)
+{
+    if (position_.isEmpty()) {
+        return std::nullopt;
+    }
+    seat(current);
+    int slot = step(cursor_, 1);
+    if (slot < 0) {
+        // Round over; the next one starts from the song playing now, so it isn't repeated
+        reshuffle(contains(current) ? current : QUuid());
+        slot = step(cursor_, 1);
+        if (slot < 0) {
+            return order_[cursor_];     // The only song
+        }
+    }
+    return order_[slot];
+}
+
+std::optional<QUuid> ShuffleBag::previous(const QUuid& current)
+{
+    if (position_.isEmpty()) {
+        return std::nullopt;
+    }
+    seat(current);
+    int slot = step(cursor_, -1);
+    if (slot < 0) {
+        slot = step(static_cast<int>(order_.size()), -1);
+    }
+    return order_[slot];
+}
+
+void ShuffleBag::insert(const QUuid& songId)
+{
+    if (songId.isNull() || position_.contains(songId)) {
+        return;
+    }
+    // Anywhere among the songs still to come, each place as likely, except before the
+    // next one: it may be getting ready to play already
+    const int upcoming = step(cursor_, 1);
+    const int last = static_cast<int>(order_.size());
+    order_.push_back(songId);
+    position_.insert(songId, last);
+    std::uniform_int_distribution<int> place(upcoming < 0 ? last : upcoming + 1, last);
+    swapSlots(place(random_), last);
+}
+
+void ShuffleBag::remove(const QUuid& songId)
+{
+    auto it = position_.find(songId);
+    if (it == position_.end()) {
+        return;
+    }
+    order_[it.value()] = QUuid();
+    position_.erase(it);
+    ++removed_;
+    if (removed_ >= MIN_COMPACT_GAPS && removed_ * 2 > static_cast<int>(order_.size())) {
+        compact();
+    }
+}
+
+QList<QUuid> ShuffleBag::order() const
+{
+    QList<QUuid> songs;
+    songs.reserve(position_.size());
+    for (const QUuid& songId : order_) {
+        if (!songId.isNull()) {
+            songs.append(songId);
+        }
+    }
+    return songs;
+}
+
+QUuid ShuffleBag::current() const
+{
+    return cursor_ >= 0 ? order_[cursor_] : QUuid();
+}
+
+void ShuffleBag::seat(const QUuid& current)
+{
+    auto it = position_.constFind(current);
+    if (it == position_.constEnd() || it.value() == cursor_) {
+        return;
+    }
+    if (it.value() < cursor_) {
+        cursor_ = it.value();       // Back to a song played earlier this round
+        return;
+    }
+    // Played out of turn: it becomes the next song, the rest still to come
+    swapSlots(it.value(), cursor_ + 1);
+    ++cursor_;
+}
+
+int ShuffleBag::step(int slot, int direction) const
+{
+    const int size = static_cast<int>(order_.size());
+    for (slot += direction; slot >= 0 && slot < size; slot += direction) {
+        if (!order_[slot].isNull()) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+void ShuffleBag::swapSlots(int a, int b)
+{
+    std::swap(order_[a], order_[b]);
+    if (!order_[a].isNull()) {
+        position_[order_[a]] = a;
+    }
+    if (!order_[b].isNull()) {
+        position_[order_[b]] = b;
+    }
+}
+
+void ShuffleBag::reshuffle(const QUuid& first)
+{
+    compact();
+    std::shuffle(order_.begin(), order_.end(), random_);
+    for (int i = 0; i < static_cast<int>(order_.size()); ++i) {
+        position_[order_[i]] = i;
+    }
+    cursor_ = -1;
+    if (contains(first)) {
+        swapSlots(position_.value(first), 0);
+        cursor_ = 0;
+    }
+}
+
+void ShuffleBag::compact()
+{
+    if (removed_ == 0) {
+        return;
+    }
+    int live = 0;
+    int cursor = -1;
+    for (int i = 0; i < static_cast<int>(order_.size()); ++i) {
+        if (i == cursor_) {
+            // A removed current song leaves the cursor just before the song after it
+            cursor = order_[i].isNull() ? live - 1 : live;
+        }
+        if (!order_[i].isNull()) {
+            order_[live] = order_[i];
+            position_[order_[live]] = live;
+            ++live;
+        }
+    }
+    order_.resize(static_cast<size_t>(live));
+    cursor_ = cursor;
+    removed_ = 0;
+}
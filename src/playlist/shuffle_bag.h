@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QUuid>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace playlist
+{
+    /**
+     * @brief Random play order of one playlist: every song once per round, in a shuffled
+     * order, then a new shuffle.
+     *
+     * The order is a list of song uuids and a cursor at the current song; the songs
+     * before it were played this round, the ones after it are still to come. Stepping
+     * either way moves the cursor, so going back retraces what was played. Playing a song
+     * out of turn moves it just after the cursor. A song added is swapped into a random
+     * place among those still to come after the next one, and a song removed leaves a gap
+     * that steps skip; both cost O(1), and the order of the other songs stays as it was.
+     *
+     * Not thread-safe; PlaylistManager keeps its bags behind a mutex.
+     */
+    class ShuffleBag
+    {
+    public:
+        explicit ShuffleBag(const QList<QUuid>& songs, uint32_t seed = std::random_device{}());
+
+        // A saved order against the playlist's songs now: songs since removed are dropped
+        // and songs since added dealt into the rest of the round
+        static ShuffleBag restore(const QList<QUuid>& order, const QUuid& current, const QList<QUuid>& songs);
+
+        // The song after (before) current, making current the cursor. At the end of a
+        // round, next() shuffles a new one starting from current; before its start,
+        // previous() wraps to the round's last song. Empty if the bag is
+        std::optional<QUuid> next(const QUuid& current);
+        std::optional<QUuid> previous(const QUuid& current);
+
+        void insert(const QUuid& songId);
+        void remove(const QUuid& songId);
+        bool contains(const QUuid& songId) const { return position_.contains(songId); }
+        int size() const { return static_cast<int>(position_.size()); }
+
+        // Songs in play order, and the current one, for saving
+        QList<QUuid> order() const;
+        QUuid current() const;
+
+    private:
+        void seat(const QUuid& current);
+        // The next song's slot from slot in direction (+1 or -1), -1 if none
+        int step(int slot, int direction) const;
+        void swapSlots(int a, int b);
+        void reshuffle(const QUuid& first);
+        void compact();
+
+        std::vector<QUuid> order_;          // Null where a song was removed
+        QHash<QUuid, int> position_;        // Song -> slot
+        int cursor_ = -1;                   // Slot of the current song, -1 before the first
+        int removed_ = 0;
+        std::mt19937 random_;
+    };
+} // namespace playlist
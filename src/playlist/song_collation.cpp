@@ -0,0 +1,100 @@
+#include "song_collation.h"
+#include <QChar>
+#include <QRegularExpression>
+#include <algorithm>
+
+using namespace playlist;
+
+namespace {
+    // Pinyin initials in order, and the character Chinese collation puts first for each
+    // (阿八嚓哒妸发旮哈讥咔垃妈拏噢妑七呥仨他穵夕丫帀); no readings start with i, u or v
+    constexpr const char* INITIALS = "abcdefghjklmnopqrstwxyz";
+    constexpr const char16_t* INITIAL_BOUNDS =
+        u"\u963f\u516b\u5693\u54d2\u59b8\u53d1\u65ee\u54c8\u8ba5\u5494\u5783\u5988"
+        u"\u62cf\u5662\u5991\u4e03\u5465\u4ee8\u4ed6\u7a75\u5915\u4e2b\u5e00";
+
+    bool hasHan(const QString& text)
+    {
+        for (const uint code : text.toUcs4()) {
+            if (QChar::script(code) == QChar::Script_Han) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+SongCollation::SongCollation(const QLocale& locale)
+    : collator_(locale)
+    , pinyin_(QLocale(QLocale::Chinese, QLocale::China))
+{
+    collator_.setCaseSensitivity(Qt::CaseInsensitive);
+    collator_.setNumericMode(true);
+    const QString bounds = QString::fromUtf16(INITIAL_BOUNDS);
+    initialBounds_.reserve(bounds.size());
+    for (const QChar bound : bounds) {
+        initialBounds_.push_back(pinyin_.sortKey(QString(bound)));
+    }
+}
+
+SongSortKeys SongCollation::keys(const SongInfo& song) const
+{
+    QString search = fold(song.title) + u'\n' + fold(song.uploader);
+    for (const QString* text : { &song.title, &song.uploader }) {
+        if (hasHan(*text)) {
+            search += u'\n' + pinyinInitials(*text);
+        }
+    }
+    return SongSortKeys{ collator_.sortKey(song.title), collator_.sortKey(song.uploader), search };
+}
+
+QString SongCollation::pinyinInitials(const QString& text) const
+{
+    QString initials;
+    for (const uint code : fold(text).toUcs4()) {
+        if (QChar::script(code) == QChar::Script_Han) {
+            if (const char initial = pinyinInitial(code)) {
+                initials += QLatin1Char(initial);
+            }
+        } else if (QChar::isLetterOrNumber(code)) {
+            const char32_t letter = code;
+            initials += QString::fromUcs4(&letter, 1);
+        } else {
+            initials += u' ';
+        }
+    }
+    return initials;
+}
+
+QString SongCollation::fold(const QString& text)
+{
+    return text.normalized(QString::NormalizationForm_KC).toCaseFolded();
+}
+
+QStringList SongCollation::queryWords(const QString& query)
+{
+    static const QRegularExpression whitespace(QStringLiteral("\\s+"));
+    return fold(query).split(whitespace, Qt::SkipEmptyParts);
+}
+
+bool SongCollation::matches(const SongSortKeys& keys, const QStringList& words)
+{
+    return std::all_of(words.cbegin(), words.cend(),
+                       [&keys](const QString& word) { return keys.search.contains(word); });
+}
+
+/*************** Private Methods ***************/
+char SongCollation::pinyinInitial(char32_t code) const
+{
+    const auto cached = initials_.constFind(code);
+    if (cached != initials_.cend()) {
+        return *cached;
+    }
+    const QCollatorSortKey key = pinyin_.sortKey(QString::fromUcs4(&code, 1));
+    // The last bound not after the character
+    const auto bound = std::upper_bound(initialBounds_.begin(), initialBounds_.end(), key,
+        [](const QCollatorSortKey& value, const QCollatorSortKey& element) { return value.compare(element) < 0; });
+    const char initial = bound == initialBounds_.begin() ? 0 : INITIALS[bound - initialBounds_.begin() - 1];
+    initials_.insert(code, initial);
+    return initial;
+}
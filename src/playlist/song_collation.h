@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QCollator>
+#include <QHash>
+#include <QLocale>
+#include <QString>
+#include <QStringList>
+#include <vector>
+#include "playlist.h"
+
+namespace playlist
+{
+    /**
+     * @brief Keys a playlist view sorts and filters a song by, computed once per song so
+     * neither needs a locale-aware string comparison per row.
+     */
+    struct SongSortKeys {
+        QCollatorSortKey title;
+        QCollatorSortKey uploader;
+        // Folded title and uploader, then for each that has Han characters its pinyin
+        // initials, one per line. A filter word matches anywhere in it
+        QString search;
+    };
+
+    /**
+     * @brief Makes SongSortKeys for one locale.
+     *
+     * Titles and uploaders are ordered by the locale's collation, case-insensitive and with
+     * digit runs compared as numbers. Search text is NFKC-normalized and case-folded, so
+     * full-width Latin and half-width kana match their usual forms, and Han characters
+     * also get their pinyin initials ("周杰伦" matches "zjl"). Initials are looked up against
+     * Chinese collation, which orders Han characters by pinyin, and are memoized per
+     * character; rare characters outside the common readings may get a neighbour's.
+     *
+     * Not thread-safe; each model keeps its own.
+     */
+    class SongCollation
+    {
+    public:
+        explicit SongCollation(const QLocale& locale = QLocale());
+
+        SongSortKeys keys(const SongInfo& song) const;
+        // Initials of the Han characters, other letters and digits folded, separators kept
+        QString pinyinInitials(const QString& text) const;
+
+        static QString fold(const QString& text);
+        // The words of a filter query, folded like the search keys
+        static QStringList queryWords(const QString& query);
+        // Every word occurs in the keys' search text; no words match everything
+        static bool matches(const SongSortKeys& keys, const QStringList& words);
+
+    private:
+        // Lowercase pinyin initial of a Han character, 0 if it sorts before every bound
+        char pinyinInitial(char32_t code) const;
+
+        QCollator collator_;
+        QCollator pinyin_;
+        std::vector<QCollatorSortKey> initialBounds_;   // First character of each initial
+        mutable QHash<char32_t, char> initials_;
+    };
+} // namespace playlist
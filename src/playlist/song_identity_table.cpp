@@ -0,0 +1,140 @@
+#include "song_identity_table.h"
+#include <network/platform/i_platform.h>
+#include <QFileInfo>
+#include <climits>
+
+using namespace playlist;
+
+namespace {
+    bool knownDuration(int duration)
+    {
+        return duration > 0 && duration != INT_MAX;
+    }
+}
+
+QString SongIdentityTable::identityOf(const SongInfo& song)
+{
+    if (static_cast<network::PlatformType>(song.platform) == network::PlatformType::Local) {
+        if (song.filepath.isEmpty()) {
+            return QString();
+        }
+        // The same file reached by another path is the same song; rewritten, it isn't
+        const QFileInfo file(song.filepath);
+        const QString canonical = file.canonicalFilePath();
+        return QString("local:%1:%2").arg(canonical.isEmpty() ? file.absoluteFilePath() : canonical).arg(file.size());
+    }
+    if (song.args.isEmpty()) {
+        return QString();
+    }
+    return QString("%1:%2").arg(song.platform).arg(song.args);
+}
+
+void SongIdentityTable::share(const SongInfo& from, SongInfo& to)
+{
+    if (!from.filepath.isEmpty()) {
+        to.filepath = from.filepath;
+    }
+    if (!from.coverName.isEmpty()) {
+        to.coverName = from.coverName;
+    }
+    if (knownDuration(from.duration)) {
+        to.duration = from.duration;
+    }
+    if (from.loudnessAnalyzed) {
+        to.loudnessGainDb = from.loudnessGainDb;
+        to.loudnessAnalyzed = true;
+    }
+}
+
+bool SongIdentityTable::differs(const SongInfo& from, const SongInfo& to)
+{
+    return (!from.filepath.isEmpty() && from.filepath != to.filepath)
+        || (!from.coverName.isEmpty() && from.coverName != to.coverName)
+        || (knownDuration(from.duration) && from.duration != to.duration)
+        || (from.loudnessAnalyzed && (!to.loudnessAnalyzed || from.loudnessGainDb != to.loudnessGainDb));
+}
+
+void SongIdentityTable::addSong(const SongInfo& song, const QUuid& playlistId)
+{
+    const SongRef ref(playlistId, song.uuid);
+    const QString identity = identityOf(song);
+    auto known = identities_.constFind(ref);
+    if (known != identities_.constEnd() && known.value() != identity) {
+        removeSong(song.uuid, playlistId);     // Now another song, e.g. the file was replaced
+    }
+    if (identity.isEmpty()) {
+        return;
+    }
+    auto entry = entries_.find(identity);
+    if (entry == entries_.end()) {
+        entry = entries_.insert(identity, Entry{ song, {} });
+    } else {
+        share(song, entry->latest);     // What any copy knows, the identity knows
+    }
+    entry->songs.insert(ref);
+    identities_.insert(ref, identity);
+    playlistSongs_[playlistId].insert(song.uuid);
+}
+
+void SongIdentityTable::removeSong(const QUuid& songId, const QUuid& playlistId)
+{
+    const SongRef ref(playlistId, songId);
+    const QString identity = identities_.take(ref);
+    if (identity.isEmpty()) {
+        return;
+    }
+    auto entry = entries_.find(identity);
+    if (entry != entries_.end()) {
+        entry->songs.remove(ref);
+        if (entry->songs.isEmpty()) {
+            entries_.erase(entry);
+        }
+    }
+    auto playlist = playlistSongs_.find(playlistId);
+    if (playlist != playlistSongs_.end()) {
+        playlist->remove(songId);
+        if (playlist->isEmpty()) {
+            playlistSongs_.erase(playlist);
+        }
+    }
+}
+
+void SongIdentityTable::removePlaylist(const QUuid& playlistId)
+{
+    const QSet<QUuid> songIds = playlistSongs_.value(playlistId);
+    for (const QUuid& songId : songIds) {
+        removeSong(songId, playlistId);
+    }
+}
+
+void SongIdentityTable::clear()
+{
+    entries_.clear();
+    identities_.clear();
+    playlistSongs_.clear();
+}
+
+std::optional<SongInfo> SongIdentityTable::find(const QString& identity) const
+{
+    auto it = entries_.constFind(identity);
+    if (identity.isEmpty() || it == entries_.constEnd()) {
+        return std::nullopt;
+    }
+    return it->latest;
+}
+
+QList<SongIdentityTable::SongRef> SongIdentityTable::copiesOf(const QUuid& songId, const QUuid& playlistId) const
+{
+    const SongRef ref(playlistId, songId);
+    auto entry = entries_.constFind(identities_.value(ref));
+    if (entry == entries_.constEnd()) {
+        return {};
+    }
+    QList<SongRef> copies;
+    for (const SongRef& copy : entry->songs) {
+        if (copy != ref) {
+            copies.append(copy);
+        }
+    }
+    return copies;
+}
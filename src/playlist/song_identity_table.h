@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QUuid>
+#include <optional>
+#include "playlist.h"
+
+namespace playlist
+{
+    /**
+     * @brief The library's songs by what they play, whatever playlists they are in: the
+     * same Bilibili video part, or the same local file, is one identity.
+     *
+     * Each playlist keeps its own SongInfo, title and all, but the copies of one identity
+     * share what comes from the media: the audio cache file, cover, duration and loudness.
+     * A song added where its identity is known starts from those, and what is learned
+     * about one copy is given to the others.
+     *
+     * Not thread-safe; PlaylistManager keeps it behind a mutex.
+     */
+    class SongIdentityTable
+    {
+    public:
+        using SongRef = QPair<QUuid, QUuid>;    // Playlist, song
+
+        // Platform and args for network songs, canonical path and size for local files;
+        // empty if the song has neither
+        static QString identityOf(const SongInfo& song);
+        // Copy the shared fields of from into to
+        static void share(const SongInfo& from, SongInfo& to);
+        // True if to lacks something of the shared fields from has
+        static bool differs(const SongInfo& from, const SongInfo& to);
+
+        void addSong(const SongInfo& song, const QUuid& playlistId);
+        void removeSong(const QUuid& songId, const QUuid& playlistId);
+        void removePlaylist(const QUuid& playlistId);
+        void clear();
+
+        // A copy of the identity, with the shared fields as its copies know them, if the
+        // library has one
+        std::optional<SongInfo> find(const QString& identity) const;
+        // The copies of the song's identity other than the song itself
+        QList<SongRef> copiesOf(const QUuid& songId, const QUuid& playlistId) const;
+        int size() const { return static_cast<int>(entries_.size()); }
+        int songCount() const { return static_cast<int>(identities_.size()); }
+
+    private:
+        struct Entry {
+            SongInfo latest;        // Shared fields merged from every copy
+            QSet<SongRef> songs;
+        };
+
+        QHash<QString, Entry> entries_;
+        QHash<SongRef, QString> identities_;
+        QHash<QUuid, QSet<QUuid>> playlistSongs_;
+    };
+} // namespace playlist
@@ -0,0 +1,263 @@
+#include "song_search_index.h"
+#include <QChar>
+#include <algorithm>
+
+using namespace playlist;
+
+namespace {
+    constexpr uint32_t FIELD_TITLE = 0;
+    constexpr uint32_t FIELD_UPLOADER = 1;
+
+    struct QueryTerm {
+        QString text;
+        bool prefix;
+    };
+
+    bool isCjk(char32_t code)
+    {
+        switch (QChar::script(code)) {
+        case QChar::Script_Han:
+        case QChar::Script_Hiragana:
+        case QChar::Script_Katakana:
+        case QChar::Script_Hangul:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void appendCode(QString& text, char32_t code)
+    {
+        if (QChar::requiresSurrogates(code)) {
+            text.append(QChar(QChar::highSurrogate(code)));
+            text.append(QChar(QChar::lowSurrogate(code)));
+        } else {
+            text.append(QChar(static_cast<char16_t>(code)));
+        }
+    }
+
+    /**
+     * Split case-folded text into terms, calling onTerm(term, isWord) for each. Words are
+     * runs of letters and digits. A CJK run is emitted as its characters and overlapping
+     * pairs when indexing; in a query as its pairs, or the character if it stands alone,
+     * which are all terms the index holds.
+     */
+    template <typename OnTerm>
+    void tokenize(const QString& text, bool query, OnTerm&& onTerm)
+    {
+        QString word;
+        std::vector<char32_t> run;
+        auto flushWord = [&]() {
+            if (!word.isEmpty()) {
+                onTerm(word, true);
+                word.clear();
+            }
+        };
+        auto flushRun = [&]() {
+            for (size_t i = 0; i < run.size(); ++i) {
+                QString term;
+                appendCode(term, run[i]);
+                if (!query || run.size() == 1) {
+                    onTerm(term, false);
+                }
+                if (i + 1 < run.size()) {
+                    appendCode(term, run[i + 1]);
+                    onTerm(term, false);
+                }
+            }
+            run.clear();
+        };
+        for (const uint code : text.toCaseFolded().toUcs4()) {
+            if (isCjk(code)) {
+                flushWord();
+                run.push_back(code);
+            } else if (QChar::isLetterOrNumber(code)) {
+                flushRun();
+                appendCode(word, code);
+            } else {
+                flushWord();
+                flushRun();
+            }
+        }
+        flushWord();
+        flushRun();
+    }
+}
+
+void SongSearchIndex::addSong(const SongInfo& song, const QUuid& playlistId)
+{
+    const QPair<QUuid, QUuid> key(playlistId, song.uuid);
+    auto it = docIds_.constFind(key);
+    if (it != docIds_.constEnd()) {
+        const Doc& doc = docs_.at(it.value());
+        if (doc.title == song.title && doc.uploader == song.uploader) {
+            return;     // Nothing searchable changed, e.g. a loudness update
+        }
+        removeDoc(it.value());
+    }
+
+    const uint32_t docId = nextDocId_++;
+    docs_.emplace(docId, Doc{ song.uuid, playlistId, song.title, song.uploader });
+    docIds_.insert(key, docId);
+    playlistDocs_[playlistId].insert(docId);
+    // Title postings first, so each term's list stays sorted
+    indexField(song.title, (docId << 1) | FIELD_TITLE);
+    indexField(song.uploader, (docId << 1) | FIELD_UPLOADER);
+}
+
+void SongSearchIndex::removeSong(const QUuid& songId, const QUuid& playlistId)
+{
+    auto it = docIds_.constFind(qMakePair(playlistId, songId));
+    if (it != docIds_.constEnd()) {
+        removeDoc(it.value());
+    }
+}
+
+void SongSearchIndex::removePlaylist(const QUuid& playlistId)
+{
+    const QSet<uint32_t> docIds = playlistDocs_.take(playlistId);
+    for (uint32_t docId : docIds) {
+        removeDoc(docId);
+    }
+}
+
+void SongSearchIndex::clear()
+{
+    terms_.clear();
+    docs_.clear();
+    docIds_.clear();
+    playlistDocs_.clear();
+}
+
+QList<SongSearchHit> SongSearchIndex::search(const QString& query, int limit) const
+{
+    std::vector<QueryTerm> queryTerms;
+    tokenize(query, true, [&queryTerms](const QString& term, bool isWord) {
+        queryTerms.push_back(QueryTerm{ term, isWord });
+    });
+    if (queryTerms.empty() || limit <= 0) {
+        return {};
+    }
+
+    // Each term narrows the matches down; a match scores the best field it was found in
+    std::unordered_map<uint32_t, int> scores;
+    for (size_t i = 0; i < queryTerms.size(); ++i) {
+        const QueryTerm& term = queryTerms[i];
+        std::unordered_map<uint32_t, int> matched;
+        auto collect = [&](const Postings& postings, bool whole) {
+            for (const uint32_t posting : postings) {
+                const uint32_t docId = posting >> 1;
+                if (i > 0 && scores.find(docId) == scores.end()) {
+                    continue;
+                }
+                const int weight = (posting & 1) == FIELD_TITLE ? (whole ? 4 : 3) : (whole ? 2 : 1);
+                int& best = matched[docId];
+                best = std::max(best, weight);
+            }
+        };
+        if (term.prefix) {
+            for (auto it = terms_.lower_bound(term.text); it != terms_.end() && it->first.startsWith(term.text); ++it) {
+                collect(it->second, it->first.size() == term.text.size());
+            }
+        } else {
+            auto it = terms_.find(term.text);
+            if (it != terms_.end()) {
+                collect(it->second, true);
+            }
+        }
+
+        if (i == 0) {
+            scores = std::move(matched);
+        } else {
+            for (auto it = scores.begin(); it != scores.end();) {
+                auto found = matched.find(it->first);
+                if (found == matched.end()) {
+                    it = scores.erase(it);
+                } else {
+                    it->second += found->second;
+                    ++it;
+                }
+            }
+        }
+        if (scores.empty()) {
+            return {};
+        }
+    }
+
+    struct Ranked {
+        int score;
+        int titleLength;
+        uint32_t docId;
+    };
+    std::vector<Ranked> ranked;
+    ranked.reserve(scores.size());
+    for (const auto& [docId, score] : scores) {
+        ranked.push_back(Ranked{ score, static_cast<int>(docs_.at(docId).title.size()), docId });
+    }
+    const auto count = std::min(ranked.size(), static_cast<size_t>(limit));
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [](const Ranked& a, const Ranked& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        if (a.titleLength != b.titleLength) {
+            return a.titleLength < b.titleLength;
+        }
+        return a.docId < b.docId;
+    });
+
+    QList<SongSearchHit> hits;
+    hits.reserve(static_cast<qsizetype>(count));
+    for (size_t i = 0; i < count; ++i) {
+        const Doc& doc = docs_.at(ranked[i].docId);
+        hits.append(SongSearchHit{ doc.songId, doc.playlistId, ranked[i].score });
+    }
+    return hits;
+}
+
+void SongSearchIndex::indexField(const QString& text, uint32_t posting)
+{
+    tokenize(text, false, [this, posting](const QString& term, bool) {
+        Postings& postings = terms_[term];
+        if (postings.empty() || postings.back() != posting) {
+            postings.push_back(posting);
+        }
+    });
+}
+
+void SongSearchIndex::unindexField(const QString& text, uint32_t posting)
+{
+    tokenize(text, false, [this, posting](const QString& term, bool) {
+        auto it = terms_.find(term);
+        if (it == terms_.end()) {
+            return;
+        }
+        Postings& postings = it->second;
+        auto found = std::lower_bound(postings.begin(), postings.end(), posting);
+        if (found != postings.end() && *found == posting) {
+            postings.erase(found);
+        }
+        if (postings.empty()) {
+            terms_.erase(it);
+        }
+    });
+}
+
+void SongSearchIndex::removeDoc(uint32_t docId)
+{
+    auto it = docs_.find(docId);
+    if (it == docs_.end()) {
+        return;
+    }
+    const Doc doc = std::move(it->second);
+    docs_.erase(it);
+    docIds_.remove(qMakePair(doc.playlistId, doc.songId));
+    auto playlist = playlistDocs_.find(doc.playlistId);
+    if (playlist != playlistDocs_.end()) {
+        playlist->remove(docId);
+        if (playlist->isEmpty()) {
+            playlistDocs_.erase(playlist);
+        }
+    }
+    unindexField(doc.title, (docId << 1) | FIELD_TITLE);
+    unindexField(doc.uploader, (docId << 1) | FIELD_UPLOADER);
+}
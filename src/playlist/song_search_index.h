@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QUuid>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "playlist.h"
+
+namespace playlist
+{
+    struct SongSearchHit {
+        QUuid songId;
+        QUuid playlistId;
+        int score;          // Higher is better: title over uploader, whole words over prefixes
+    };
+
+    /**
+     * @brief Inverted index over the title and uploader of every song in the library.
+     *
+     * Text is case-folded and split into words; runs of CJK characters, which carry no
+     * spaces, are indexed as single characters and overlapping pairs instead. Terms are
+     * kept sorted, so a prefix is a range of the term map, and each term lists the
+     * (song entry, field) postings containing it. A song is an entry per playlist it is
+     * in. Updates cost the song's own terms, whatever the library holds.
+     *
+     * Not thread-safe; PlaylistManager keeps it behind its own mutex.
+     */
+    class SongSearchIndex
+    {
+    public:
+        // Add or re-index the song as a member of the playlist
+        void addSong(const SongInfo& song, const QUuid& playlistId);
+        void removeSong(const QUuid& songId, const QUuid& playlistId);
+        void removePlaylist(const QUuid& playlistId);
+        void clear();
+        int size() const { return static_cast<int>(docs_.size()); }
+
+        // Songs matching every word of query, each word as a prefix of a title or uploader
+        // word and CJK text by its characters; best first, then shortest title
+        QList<SongSearchHit> search(const QString& query, int limit) const;
+
+    private:
+        struct Doc {
+            QUuid songId;
+            QUuid playlistId;
+            QString title;
+            QString uploader;
+        };
+        using Postings = std::vector<uint32_t>;     // Sorted (doc id << 1) | field
+
+        void indexField(const QString& text, uint32_t posting);
+        void unindexField(const QString& text, uint32_t posting);
+        void removeDoc(uint32_t docId);
+
+        std::map<QString, Postings> terms_;
+        std::unordered_map<uint32_t, Doc> docs_;
+        QHash<QPair<QUuid, QUuid>, uint32_t> docIds_;           // (playlist, song) -> doc id
+        QHash<QUuid, QSet<uint32_t>> playlistDocs_;
+        uint32_t nextDocId_ = 0;        // Ids only grow, so new postings append
+    };
+} // namespace playlist
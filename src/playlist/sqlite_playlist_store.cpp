@@ -0,0 +1,516 @@
+#include "sqlite_playlist_store.h"
+#include "playlist_json.h"
+#include <log/log_manager.h>
+#include <json/json.h>
+#include <sqlite3.h>
+
+using namespace playlist;
+
+namespace {
+    // Bumped with every schema change; open() upgrades older databases step by step
+    constexpr int SCHEMA_VERSION = 1;
+
+    const char* const SCHEMA_V1 = R"sql(
+        CREATE TABLE IF NOT EXISTS meta (
+            key TEXT PRIMARY KEY,
+            value TEXT
+        ) WITHOUT ROWID;
+        CREATE TABLE IF NOT EXISTS categories (
+            uuid TEXT PRIMARY KEY,
+            name TEXT NOT NULL,
+            position INTEGER NOT NULL
+        );
+        CREATE TABLE IF NOT EXISTS playlists (
+            uuid TEXT PRIMARY KEY,
+            category_uuid TEXT NOT NULL,
+            name TEXT, creator TEXT, description TEXT, cover_uri TEXT,
+            position INTEGER NOT NULL
+        );
+        CREATE INDEX IF NOT EXISTS playlists_by_category ON playlists(category_uuid, position);
+        CREATE TABLE IF NOT EXISTS songs (
+            playlist_uuid TEXT NOT NULL,
+            uuid TEXT NOT NULL,
+            position INTEGER NOT NULL,
+            title TEXT, uploader TEXT, platform INTEGER, duration INTEGER,
+            filepath TEXT, cover_name TEXT, args TEXT,
+            loudness_gain_db REAL,
+            PRIMARY KEY (playlist_uuid, uuid)
+        );
+        CREATE INDEX IF NOT EXISTS songs_by_playlist ON songs(playlist_uuid, position);
+        CREATE INDEX IF NOT EXISTS songs_by_uuid ON songs(uuid);
+        CREATE INDEX IF NOT EXISTS songs_by_title ON songs(title COLLATE NOCASE);
+        CREATE INDEX IF NOT EXISTS songs_by_uploader ON songs(uploader COLLATE NOCASE);
+    )sql";
+
+    const char* const SQL_INSERT_CATEGORY =
+        "INSERT OR IGNORE INTO categories (uuid, name, position) VALUES (?1, ?2, "
+        "COALESCE((SELECT MAX(position) + 1 FROM categories), 0))";
+    const char* const SQL_UPDATE_CATEGORY = "UPDATE categories SET name = ?2 WHERE uuid = ?1";
+    const char* const SQL_DELETE_CATEGORY_SONGS =
+        "DELETE FROM songs WHERE playlist_uuid IN (SELECT uuid FROM playlists WHERE category_uuid = ?1)";
+    const char* const SQL_DELETE_CATEGORY_PLAYLISTS = "DELETE FROM playlists WHERE category_uuid = ?1";
+    const char* const SQL_DELETE_CATEGORY = "DELETE FROM categories WHERE uuid = ?1";
+    const char* const SQL_INSERT_PLAYLIST =
+        "INSERT OR IGNORE INTO playlists (uuid, category_uuid, name, creator, description, cover_uri, position) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)";
+    const char* const SQL_NEXT_PLAYLIST_POSITION =
+        "SELECT COALESCE(MAX(position) + 1, 0) FROM playlists WHERE category_uuid = ?1";
+    const char* const SQL_UPDATE_PLAYLIST =
+        "UPDATE playlists SET name = ?2, creator = ?3, description = ?4, cover_uri = ?5 WHERE uuid = ?1";
+    const char* const SQL_DELETE_PLAYLIST_SONGS = "DELETE FROM songs WHERE playlist_uuid = ?1";
+    const char* const SQL_DELETE_PLAYLIST = "DELETE FROM playlists WHERE uuid = ?1";
+    const char* const SQL_INSERT_SONG =
+        "INSERT OR REPLACE INTO songs (playlist_uuid, uuid, position, title, uploader, platform, duration, "
+        "filepath, cover_name, args, loudness_gain_db) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11)";
+    const char* const SQL_NEXT_SONG_POSITION =
+        "SELECT COALESCE(MAX(position) + 1, 0) FROM songs WHERE playlist_uuid = ?1";
+    const char* const SQL_UPDATE_SONG =
+        "UPDATE songs SET title = ?3, uploader = ?4, platform = ?5, duration = ?6, filepath = ?7, "
+        "cover_name = ?8, args = ?9, loudness_gain_db = ?10 WHERE playlist_uuid = ?1 AND uuid = ?2";
+    const char* const SQL_DELETE_SONG = "DELETE FROM songs WHERE playlist_uuid = ?1 AND uuid = ?2";
+    const char* const SQL_SET_SONG_LOUDNESS = "UPDATE songs SET loudness_gain_db = ?2 WHERE uuid = ?1";
+    const char* const SQL_SET_META = "INSERT OR REPLACE INTO meta (key, value) VALUES (?1, ?2)";
+    const char* const SQL_GET_META = "SELECT value FROM meta WHERE key = ?1";
+    const char* const SQL_ANY_CATEGORY = "SELECT EXISTS (SELECT 1 FROM categories)";
+    const char* const SQL_SELECT_CATEGORIES = "SELECT uuid, name FROM categories ORDER BY position";
+    const char* const SQL_SELECT_PLAYLISTS =
+        "SELECT uuid, category_uuid, name, creator, description, cover_uri FROM playlists "
+        "ORDER BY category_uuid, position";
+    const char* const SQL_SELECT_SONGS =
+        "SELECT playlist_uuid, uuid, title, uploader, platform, duration, filepath, cover_name, args, "
+        "loudness_gain_db FROM songs ORDER BY playlist_uuid, position";
+    const char* const SQL_SELECT_PLAYLIST_SONGS =
+        "SELECT uuid, title, uploader, platform, duration, filepath, cover_name, args, loudness_gain_db "
+        "FROM songs WHERE playlist_uuid = ?1 ORDER BY position";
+    const char* const SQL_INSERT_CATEGORY_AT =
+        "INSERT INTO categories (uuid, name, position) VALUES (?1, ?2, ?3)";
+
+    const char* const CURRENT_PLAYLIST_KEY = "currentPlaylistId";
+
+    void bindText(sqlite3_stmt* stmt, int index, const QString& text)
+    {
+        const QByteArray utf8 = text.toUtf8();
+        sqlite3_bind_text(stmt, index, utf8.constData(), utf8.size(), SQLITE_TRANSIENT);
+    }
+
+    void bindText(sqlite3_stmt* stmt, int index, const std::string& text)
+    {
+        sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+
+    void bindUuid(sqlite3_stmt* stmt, int index, const QUuid& uuid)
+    {
+        bindText(stmt, index, uuid.toString());
+    }
+
+    QString columnText(sqlite3_stmt* stmt, int column)
+    {
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+        return text ? QString::fromUtf8(text, sqlite3_column_bytes(stmt, column)) : QString();
+    }
+
+    QUuid columnUuid(sqlite3_stmt* stmt, int column)
+    {
+        return QUuid::fromString(columnText(stmt, column));
+    }
+
+    // A song from the row's columns from first on, in SQL_SELECT_PLAYLIST_SONGS order
+    SongInfo songFromRow(sqlite3_stmt* stmt, int first)
+    {
+        SongInfo song;
+        song.uuid = columnUuid(stmt, first);
+        song.title = columnText(stmt, first + 1);
+        song.uploader = columnText(stmt, first + 2);
+        song.platform = sqlite3_column_int(stmt, first + 3);
+        song.duration = sqlite3_column_int(stmt, first + 4);
+        song.filepath = columnText(stmt, first + 5);
+        song.coverName = columnText(stmt, first + 6);
+        song.args = columnText(stmt, first + 7);
+        if (sqlite3_column_type(stmt, first + 8) != SQLITE_NULL) {
+            song.loudnessGainDb = static_cast<float>(sqlite3_column_double(stmt, first + 8));
+            song.loudnessAnalyzed = true;
+        }
+        return song;
+    }
+
+    // Song columns from ?first on, in SQL_INSERT_SONG / SQL_UPDATE_SONG order
+    void bindSongFields(sqlite3_stmt* stmt, int first, const SongInfo& song)
+    {
+        bindText(stmt, first, song.title);
+        bindText(stmt, first + 1, song.uploader);
+        sqlite3_bind_int(stmt, first + 2, song.platform);
+        sqlite3_bind_int(stmt, first + 3, song.duration);
+        bindText(stmt, first + 4, song.filepath);
+        bindText(stmt, first + 5, song.coverName);
+        bindText(stmt, first + 6, song.args);
+        if (song.loudnessAnalyzed) {
+            sqlite3_bind_double(stmt, first + 7, song.loudnessGainDb);
+        } else {
+            sqlite3_bind_null(stmt, first + 7);
+        }
+    }
+}
+
+SqlitePlaylistStore::~SqlitePlaylistStore()
+{
+    close();
+}
+
+bool SqlitePlaylistStore::open(const std::string& path)
+{
+    close();
+    if (sqlite3_open_v2(path.c_str(), &db_, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK) {
+        LOG_ERROR("Failed to open playlist database {}: {}", path, db_ ? sqlite3_errmsg(db_) : "out of memory");
+        close();
+        return false;
+    }
+    sqlite3_busy_timeout(db_, 2000);
+    // WAL: a save appends to the log instead of rewriting pages in place, and readers
+    // never wait for it. NORMAL sync is durable across application crashes
+    if (!exec("PRAGMA journal_mode = WAL") || !exec("PRAGMA synchronous = NORMAL")) {
+        close();
+        return false;
+    }
+
+    int version = 0;
+    if (sqlite3_stmt* stmt = statement("PRAGMA user_version")) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_reset(stmt);
+    }
+    if (version > SCHEMA_VERSION) {
+        LOG_ERROR("Playlist database {} has schema version {}, newer than this build ({})", path, version, SCHEMA_VERSION);
+        close();
+        return false;
+    }
+    if (version < 1 && (!exec(SCHEMA_V1) || !exec("PRAGMA user_version = 1"))) {
+        close();
+        return false;
+    }
+    LOG_INFO("Opened playlist database {}", path);
+    return true;
+}
+
+void SqlitePlaylistStore::close()
+{
+    for (auto& pair : statements_) {
+        sqlite3_finalize(pair.second);
+    }
+    statements_.clear();
+    if (db_) {
+        sqlite3_close(db_);
+        db_ = nullptr;
+    }
+}
+
+bool SqlitePlaylistStore::isEmpty()
+{
+    sqlite3_stmt* stmt = statement(SQL_ANY_CATEGORY);
+    const bool empty = stmt && sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) == 0;
+    if (stmt) {
+        sqlite3_reset(stmt);
+    }
+    return empty;
+}
+
+bool SqlitePlaylistStore::load(Contents& contents)
+{
+    if (!loadHeaders(contents)) {
+        return false;
+    }
+    sqlite3_stmt* stmt = statement(SQL_SELECT_SONGS);
+    if (!stmt) {
+        return false;
+    }
+    // Rows come grouped by playlist, so the list being filled only changes between groups
+    QUuid playlistId;
+    QList<SongInfo>* songs = nullptr;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const QUuid rowPlaylist = columnUuid(stmt, 0);
+        if (!songs || rowPlaylist != playlistId) {
+            playlistId = rowPlaylist;
+            songs = &contents.songs[playlistId];
+        }
+        songs->append(songFromRow(stmt, 1));
+    }
+    sqlite3_reset(stmt);
+    return true;
+}
+
+bool SqlitePlaylistStore::loadHeaders(Contents& contents)
+{
+    contents = Contents{};
+    sqlite3_stmt* stmt = statement(SQL_SELECT_CATEGORIES);
+    if (!stmt) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        CategoryInfo category;
+        category.uuid = columnUuid(stmt, 0);
+        category.name = columnText(stmt, 1);
+        contents.categories.append(category);
+    }
+    sqlite3_reset(stmt);
+
+    if (!(stmt = statement(SQL_SELECT_PLAYLISTS))) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        PlaylistInfo playlist;
+        playlist.uuid = columnUuid(stmt, 0);
+        playlist.name = columnText(stmt, 2);
+        playlist.creator = columnText(stmt, 3);
+        playlist.description = columnText(stmt, 4);
+        playlist.coverUri = columnText(stmt, 5);
+        contents.playlists[columnUuid(stmt, 1)].append(playlist);
+    }
+    sqlite3_reset(stmt);
+
+    if (!(stmt = statement(SQL_GET_META))) {
+        return false;
+    }
+    bindText(stmt, 1, std::string(CURRENT_PLAYLIST_KEY));
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        contents.currentPlaylistId = columnUuid(stmt, 0);
+    }
+    sqlite3_reset(stmt);
+    return true;
+}
+
+bool SqlitePlaylistStore::loadSongs(const QUuid& playlistId, QList<SongInfo>& songs)
+{
+    songs.clear();
+    sqlite3_stmt* stmt = statement(SQL_SELECT_PLAYLIST_SONGS);
+    if (!stmt) {
+        return false;
+    }
+    bindUuid(stmt, 1, playlistId);
+    int rc = SQLITE_ROW;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        songs.append(songFromRow(stmt, 0));
+    }
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE;
+}
+
+bool SqlitePlaylistStore::replaceAll(const Contents& contents)
+{
+    if (!exec("BEGIN IMMEDIATE")) {
+        return false;
+    }
+    bool ok = exec("DELETE FROM songs") && exec("DELETE FROM playlists") && exec("DELETE FROM categories");
+    int64_t categoryPosition = 0;
+    for (const CategoryInfo& category : contents.categories) {
+        sqlite3_stmt* stmt = ok ? statement(SQL_INSERT_CATEGORY_AT) : nullptr;
+        if (!stmt) {
+            ok = false;
+            break;
+        }
+        bindUuid(stmt, 1, category.uuid);
+        bindText(stmt, 2, category.name);
+        sqlite3_bind_int64(stmt, 3, categoryPosition++);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+
+        int64_t playlistPosition = 0;
+        for (const PlaylistInfo& playlist : contents.playlists.value(category.uuid)) {
+            ok = ok && insertPlaylist(category.uuid, playlist, playlistPosition++);
+            int64_t songPosition = 0;
+            for (const SongInfo& song : contents.songs.value(playlist.uuid)) {
+                ok = ok && insertSong(playlist.uuid, song, songPosition++);
+            }
+        }
+    }
+    ok = ok && setCurrentPlaylist(contents.currentPlaylistId);
+    if (!ok || !exec("COMMIT")) {
+        LOG_ERROR("Failed to replace the playlist database contents: {}", sqlite3_errmsg(db_));
+        exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
+bool SqlitePlaylistStore::apply(const std::vector<Json::Value>& changes)
+{
+    if (changes.empty()) {
+        return true;
+    }
+    if (!exec("BEGIN IMMEDIATE")) {
+        return false;
+    }
+    for (const Json::Value& change : changes) {
+        if (!applyChange(change)) {
+            LOG_ERROR("Failed to store playlist change {}: {}", change["op"].asString(), sqlite3_errmsg(db_));
+            exec("ROLLBACK");
+            return false;
+        }
+    }
+    if (!exec("COMMIT")) {
+        exec("ROLLBACK");
+        return false;
+    }
+    return true;
+}
+
+bool SqlitePlaylistStore::applyChange(const Json::Value& change)
+{
+    const std::string op = change["op"].asString();
+    sqlite3_stmt* stmt = nullptr;
+    if (op == "addCategory" || op == "updateCategory") {
+        const Json::Value& category = change["category"];
+        if (!(stmt = statement(op == "addCategory" ? SQL_INSERT_CATEGORY : SQL_UPDATE_CATEGORY))) {
+            return false;
+        }
+        bindUuid(stmt, 1, uuidFromJson(category["uuid"]));
+        bindText(stmt, 2, category["name"].asString());
+    } else if (op == "removeCategory") {
+        const QUuid categoryId = uuidFromJson(change["categoryId"]);
+        for (const char* sql : { SQL_DELETE_CATEGORY_SONGS, SQL_DELETE_CATEGORY_PLAYLISTS, SQL_DELETE_CATEGORY }) {
+            if (!(stmt = statement(sql))) {
+                return false;
+            }
+            bindUuid(stmt, 1, categoryId);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                return false;
+            }
+        }
+        return true;
+    } else if (op == "addPlaylist") {
+        const QUuid categoryId = uuidFromJson(change["categoryId"]);
+        if (!(stmt = statement(SQL_NEXT_PLAYLIST_POSITION))) {
+            return false;
+        }
+        bindUuid(stmt, 1, categoryId);
+        const int64_t position = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+        sqlite3_reset(stmt);
+        return insertPlaylist(categoryId, playlistFromJson(change["playlist"]), position);
+    } else if (op == "updatePlaylist") {
+        const PlaylistInfo playlist = playlistFromJson(change["playlist"]);
+        if (!(stmt = statement(SQL_UPDATE_PLAYLIST))) {
+            return false;
+        }
+        bindUuid(stmt, 1, playlist.uuid);
+        bindText(stmt, 2, playlist.name);
+        bindText(stmt, 3, playlist.creator);
+        bindText(stmt, 4, playlist.description);
+        bindText(stmt, 5, playlist.coverUri);
+    } else if (op == "removePlaylist") {
+        const QUuid playlistId = uuidFromJson(change["playlistId"]);
+        for (const char* sql : { SQL_DELETE_PLAYLIST_SONGS, SQL_DELETE_PLAYLIST }) {
+            if (!(stmt = statement(sql))) {
+                return false;
+            }
+            bindUuid(stmt, 1, playlistId);
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                return false;
+            }
+        }
+        return true;
+    } else if (op == "addSong") {
+        const QUuid playlistId = uuidFromJson(change["playlistId"]);
+        if (!(stmt = statement(SQL_NEXT_SONG_POSITION))) {
+            return false;
+        }
+        bindUuid(stmt, 1, playlistId);
+        const int64_t position = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+        sqlite3_reset(stmt);
+        return insertSong(playlistId, songFromJson(change["song"]), position);
+    } else if (op == "updateSong") {
+        const SongInfo song = songFromJson(change["song"]);
+        if (!(stmt = statement(SQL_UPDATE_SONG))) {
+            return false;
+        }
+        bindUuid(stmt, 1, uuidFromJson(change["playlistId"]));
+        bindUuid(stmt, 2, song.uuid);
+        bindSongFields(stmt, 3, song);
+    } else if (op == "removeSong") {
+        if (!(stmt = statement(SQL_DELETE_SONG))) {
+            return false;
+        }
+        bindUuid(stmt, 1, uuidFromJson(change["playlistId"]));
+        bindUuid(stmt, 2, uuidFromJson(change["songId"]));
+    } else if (op == "setSongLoudness") {
+        if (!(stmt = statement(SQL_SET_SONG_LOUDNESS))) {
+            return false;
+        }
+        bindUuid(stmt, 1, uuidFromJson(change["songId"]));
+        sqlite3_bind_double(stmt, 2, change["gainDb"].asDouble());
+    } else if (op == "setCurrentPlaylist") {
+        return setCurrentPlaylist(uuidFromJson(change["playlistId"]));
+    } else {
+        LOG_ERROR("Unknown playlist change: {}", op);
+        return false;
+    }
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool SqlitePlaylistStore::insertSong(const QUuid& playlistId, const SongInfo& song, int64_t position)
+{
+    sqlite3_stmt* stmt = statement(SQL_INSERT_SONG);
+    if (!stmt) {
+        return false;
+    }
+    bindUuid(stmt, 1, playlistId);
+    bindUuid(stmt, 2, song.uuid);
+    sqlite3_bind_int64(stmt, 3, position);
+    bindSongFields(stmt, 4, song);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool SqlitePlaylistStore::insertPlaylist(const QUuid& categoryId, const PlaylistInfo& playlist, int64_t position)
+{
+    sqlite3_stmt* stmt = statement(SQL_INSERT_PLAYLIST);
+    if (!stmt) {
+        return false;
+    }
+    bindUuid(stmt, 1, playlist.uuid);
+    bindUuid(stmt, 2, categoryId);
+    bindText(stmt, 3, playlist.name);
+    bindText(stmt, 4, playlist.creator);
+    bindText(stmt, 5, playlist.description);
+    bindText(stmt, 6, playlist.coverUri);
+    sqlite3_bind_int64(stmt, 7, position);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool SqlitePlaylistStore::setCurrentPlaylist(const QUuid& playlistId)
+{
+    sqlite3_stmt* stmt = statement(SQL_SET_META);
+    if (!stmt) {
+        return false;
+    }
+    bindText(stmt, 1, std::string(CURRENT_PLAYLIST_KEY));
+    bindUuid(stmt, 2, playlistId);
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+sqlite3_stmt* SqlitePlaylistStore::statement(const char* sql)
+{
+    if (!db_) {
+        return nullptr;
+    }
+    auto it = statements_.find(sql);
+    if (it != statements_.end()) {
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        LOG_ERROR("Failed to prepare playlist statement: {}", sqlite3_errmsg(db_));
+        return nullptr;
+    }
+    statements_.emplace(sql, stmt);
+    return stmt;
+}
+
+bool SqlitePlaylistStore::exec(const char* sql)
+{
+    char* error = nullptr;
+    if (sqlite3_exec(db_, sql, nullptr, nullptr, &error) != SQLITE_OK) {
+        LOG_ERROR("Playlist database error: {}", error ? error : "unknown");
+        sqlite3_free(error);
+        return false;
+    }
+    return true;
+}
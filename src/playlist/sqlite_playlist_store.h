@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QUuid>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "playlist.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+namespace Json { class Value; }
+
+namespace playlist
+{
+    /**
+     * @brief Categories, playlists and songs in an SQLite database, the alternative to
+     * PlaylistManager's JSON snapshot and journal.
+     *
+     * Changes arrive as the records PlaylistManager journals and are written in one
+     * transaction per save through cached prepared statements, so a save costs the
+     * changes. The database runs in WAL mode; songs are indexed by playlist and position
+     * (membership and order), by uuid, and by title and uploader (case-insensitive).
+     * Order within a category or playlist is kept in a position column.
+     * Not thread-safe; PlaylistManager serializes its saves.
+     */
+    class SqlitePlaylistStore
+    {
+    public:
+        using Contents = LibraryContents;
+
+        SqlitePlaylistStore() = default;
+        ~SqlitePlaylistStore();
+        SqlitePlaylistStore(const SqlitePlaylistStore&) = delete;
+        SqlitePlaylistStore& operator=(const SqlitePlaylistStore&) = delete;
+
+        // Open or create the database at path and bring its schema up to date
+        bool open(const std::string& path);
+        void close();
+        bool isOpen() const { return db_ != nullptr; }
+
+        // No category stored yet
+        bool isEmpty();
+        bool load(Contents& contents);
+        // Categories, playlists and the current playlist, without songs
+        bool loadHeaders(Contents& contents);
+        // One playlist's songs in order, through the songs_by_playlist index
+        bool loadSongs(const QUuid& playlistId, QList<SongInfo>& songs);
+        // Replace everything stored, e.g. to import a library from JSON
+        bool replaceAll(const Contents& contents);
+        // Apply change records in order, all or none
+        bool apply(const std::vector<Json::Value>& changes);
+
+    private:
+        // Cached prepared statement for sql, reset and ready for binding; null on error
+        sqlite3_stmt* statement(const char* sql);
+        bool exec(const char* sql);
+        bool applyChange(const Json::Value& change);
+        bool insertSong(const QUuid& playlistId, const SongInfo& song, int64_t position);
+        bool insertPlaylist(const QUuid& categoryId, const PlaylistInfo& playlist, int64_t position);
+        bool setCurrentPlaylist(const QUuid& playlistId);
+
+        sqlite3* db_ = nullptr;
+        std::unordered_map<const char*, sqlite3_stmt*> statements_;
+    };
+} // namespace playlist
@@ -0,0 +1,189 @@
+#include "broadcast_pipe.hpp"
+#include <algorithm>
+#include <cstring>
+
+// ===============================================================
+// Internal implementation details
+// ===============================================================
+
+class BroadcastPipe::ReaderBuffer : public std::streambuf {
+public:
+    explicit ReaderBuffer(std::shared_ptr<Reader> reader)
+        : reader_(std::move(reader)) {
+        setg(get_area_, get_area_, get_area_);
+    }
+
+protected:
+    std::streamsize xsgetn(char* s, std::streamsize n) override {
+        // istream::read() semantics: block until n bytes arrive or the data ends
+        std::streamsize total = std::min(n, static_cast<std::streamsize>(egptr() - gptr()));
+        if (total > 0) {
+            std::memcpy(s, gptr(), static_cast<size_t>(total));
+            gbump(static_cast<int>(total));
+        }
+        while (total < n) {
+            size_t got = reader_->read(s + total, static_cast<size_t>(n - total));
+            if (got == 0) break;
+            total += static_cast<std::streamsize>(got);
+        }
+        return total;
+    }
+
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        size_t got = reader_->read(get_area_, GET_AREA_SIZE);
+        if (got == 0) {
+            setg(get_area_, get_area_, get_area_);
+            return traits_type::eof();
+        }
+        setg(get_area_, get_area_, get_area_ + got);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    static constexpr size_t GET_AREA_SIZE = 4096;
+
+    std::shared_ptr<Reader> reader_;
+    char get_area_[GET_AREA_SIZE];
+};
+
+class BroadcastPipe::InputStream : public std::istream {
+public:
+    explicit InputStream(std::shared_ptr<Reader> reader)
+        : std::istream(nullptr), buffer_(std::move(reader)) {
+        rdbuf(&buffer_);
+    }
+
+private:
+    ReaderBuffer buffer_;
+};
+
+// ---------------- Reader ----------------
+
+BroadcastPipe::Reader::Reader(std::shared_ptr<BroadcastPipe> pipe, uint64_t cursor)
+    : pipe_(std::move(pipe)), cursor_(cursor) {}
+
+BroadcastPipe::Reader::~Reader() {
+    pipe_->detach(this);
+}
+
+size_t BroadcastPipe::Reader::read(char* out, size_t size) {
+    return pipe_->readFor(this, out, size);
+}
+
+size_t BroadcastPipe::Reader::available() const {
+    std::lock_guard<std::mutex> lock(pipe_->mutex_);
+    return static_cast<size_t>(pipe_->tail_ - cursor_);
+}
+
+// ---------------- BroadcastPipe ----------------
+
+BroadcastPipe::BroadcastPipe(size_t lagLimit) {
+    size_t cap = 1;
+    while (cap < lagLimit) cap <<= 1;
+    ring_.resize(cap);
+    mask_ = cap - 1;
+}
+
+std::shared_ptr<BroadcastPipe::Reader> BroadcastPipe::openReader() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::shared_ptr<Reader> reader(new Reader(shared_from_this(), tail_));
+    readers_.push_back(reader.get());
+    return reader;
+}
+
+std::shared_ptr<std::istream> BroadcastPipe::getInputStream() {
+    return std::make_shared<InputStream>(openReader());
+}
+
+size_t BroadcastPipe::write(const char* data, size_t size) {
+    size_t written = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (written < size) {
+        space_available_.wait(lock, [this]() {
+            return aborted_ || readers_.empty() || tail_ - slowestCursor_unsafe() < ring_.size();
+        });
+        if (aborted_ || readers_.empty()) break;
+
+        const size_t free = ring_.size() - static_cast<size_t>(tail_ - slowestCursor_unsafe());
+        const size_t offset = static_cast<size_t>(tail_) & mask_;
+        const size_t chunk = std::min({ free, ring_.size() - offset, size - written });
+        // Every reader is behind tail_: nobody looks at this region until it is published
+        lock.unlock();
+        std::memcpy(ring_.data() + offset, data + written, chunk);
+        lock.lock();
+        tail_ += chunk;
+        written += chunk;
+        data_available_.notify_all();
+    }
+    return written;
+}
+
+void BroadcastPipe::closeWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writer_closed_ = true;
+    }
+    data_available_.notify_all();
+}
+
+void BroadcastPipe::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        aborted_ = true;
+        writer_closed_ = true;
+    }
+    data_available_.notify_all();
+    space_available_.notify_all();
+}
+
+bool BroadcastPipe::aborted() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return aborted_;
+}
+
+size_t BroadcastPipe::readerCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return readers_.size();
+}
+
+/*************** Private Methods ***************/
+void BroadcastPipe::detach(Reader* reader) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readers_.erase(std::remove(readers_.begin(), readers_.end(), reader), readers_.end());
+    }
+    // The writer may have been waiting on this reader
+    space_available_.notify_all();
+}
+
+size_t BroadcastPipe::readFor(Reader* reader, char* out, size_t size) {
+    if (size == 0) return 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    data_available_.wait(lock, [&]() {
+        return aborted_ || reader->cursor_ < tail_ || writer_closed_;
+    });
+    if (aborted_ || reader->cursor_ == tail_) {
+        return 0;
+    }
+
+    const size_t offset = static_cast<size_t>(reader->cursor_) & mask_;
+    const size_t chunk = std::min({ static_cast<size_t>(tail_ - reader->cursor_), ring_.size() - offset, size });
+    // The writer never overwrites bytes at or after the slowest cursor, ours included
+    lock.unlock();
+    std::memcpy(out, ring_.data() + offset, chunk);
+    lock.lock();
+    reader->cursor_ += chunk;
+    space_available_.notify_one();
+    return chunk;
+}
+
+uint64_t BroadcastPipe::slowestCursor_unsafe() const {
+    uint64_t slowest = tail_;
+    for (const Reader* reader : readers_) {
+        slowest = std::min(slowest, reader->cursor_);
+    }
+    return slowest;
+}
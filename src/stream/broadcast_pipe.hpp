@@ -0,0 +1,106 @@
+#pragma once
+
+#include <streambuf>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A single-writer pipe that broadcasts one copy of the data to any number of readers.
+ *
+ * Every reader opened with openReader()/getInputStream() has its own cursor into a shared
+ * ring and sees all bytes written after it was opened. Readers never wait for each other:
+ * the writer only blocks once the slowest reader is a full lag limit behind, so a slow
+ * consumer (e.g. a disk writer) holds the others back only at that point. Destroying a
+ * reader detaches it; write() stops early once no reader is left.
+ *
+ * closeWriter() ends the data (readers drain what is buffered, then see EOF);
+ * close() aborts the pipe and wakes everyone at once.
+ *
+ * The object must be owned by a shared_ptr; each reader keeps it alive.
+ */
+class BroadcastPipe : public std::enable_shared_from_this<BroadcastPipe> {
+public:
+    class Reader;
+
+    // @param lagLimit Bytes the writer may run ahead of the slowest reader, rounded up to a power of two
+    explicit BroadcastPipe(size_t lagLimit = 8192);
+
+    BroadcastPipe(const BroadcastPipe&) = delete;
+    BroadcastPipe& operator=(const BroadcastPipe&) = delete;
+
+    std::shared_ptr<Reader> openReader();
+    // Input stream over a new reader
+    std::shared_ptr<std::istream> getInputStream();
+
+    /**
+     * @brief Writer side: copy data into the ring, blocking while the slowest reader lags
+     * by the full limit.
+     * @return Bytes written, less than size if the pipe was closed or every reader detached
+     */
+    size_t write(const char* data, size_t size);
+
+    // Writer side: no more data; readers see EOF once they have drained the ring
+    void closeWriter();
+
+    /**
+     * @brief Abort: wake blocked readers and the writer; reads return 0 from now on.
+     */
+    void close();
+
+    // True after close(); tells readers that a 0 read was not a clean EOF
+    bool aborted() const;
+
+    size_t readerCount() const;
+    size_t lagLimit() const { return ring_.size(); }
+
+private:
+    class ReaderBuffer;
+    class InputStream;
+
+    void detach(Reader* reader);
+    size_t readFor(Reader* reader, char* out, size_t size);
+    // Cursor of the reader furthest behind (mutex held), tail_ if there is none
+    uint64_t slowestCursor_unsafe() const;
+
+    std::vector<char> ring_;
+    size_t mask_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable data_available_;
+    std::condition_variable space_available_;
+    uint64_t tail_ = 0;                 // Total bytes written
+    std::vector<Reader*> readers_;
+    bool writer_closed_ = false;
+    bool aborted_ = false;
+};
+
+/**
+ * @brief One read cursor of a BroadcastPipe. Only one thread may read from a given reader.
+ */
+class BroadcastPipe::Reader {
+public:
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    /**
+     * @brief Block until data is available, then copy up to size bytes.
+     * @return Bytes read, 0 at EOF or after the pipe was closed
+     */
+    size_t read(char* out, size_t size);
+
+    // Bytes written but not yet read by this reader
+    size_t available() const;
+
+private:
+    friend class BroadcastPipe;
+    Reader(std::shared_ptr<BroadcastPipe> pipe, uint64_t cursor);
+
+    std::shared_ptr<BroadcastPipe> pipe_;
+    uint64_t cursor_;                   // Guarded by the pipe's mutex
+};
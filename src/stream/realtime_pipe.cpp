@@ -1,69 +1,184 @@
 #include "realtime_pipe.hpp"
 #include <algorithm>
+#include <cstring>
+
+namespace {
+std::atomic<size_t> g_allocatedBytes{0};
+}
 
 // ---------------- PipeBuffer ----------------
 
 RealtimePipe::PipeBuffer::PipeBuffer(size_t capacity)
-    : buffer_(capacity) {}
+    : ring_(capacity) {
+    setg(get_area_, get_area_, get_area_);
+    g_allocatedBytes.fetch_add(ring_.capacity(), std::memory_order_relaxed);
+}
+
+RealtimePipe::PipeBuffer::~PipeBuffer() {
+    g_allocatedBytes.fetch_sub(ring_.capacity(), std::memory_order_relaxed);
+}
 
 void RealtimePipe::PipeBuffer::closeInput() {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        input_closed_ = true;
-    }
-    space_available_.notify_all();
+    ring_.closeReader();
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    spill_space_.notify_all();
 }
 
 void RealtimePipe::PipeBuffer::closeOutput() {
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        output_closed_ = true;
-    }
-    data_available_.notify_all();
+    ring_.closeWriter();
 }
 
 size_t RealtimePipe::PipeBuffer::available() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return buffer_.size();
+    return ring_.size() + static_cast<size_t>(spilled_.load(std::memory_order_acquire));
 }
 
-std::streamsize RealtimePipe::PipeBuffer::xsputn(const char* s, std::streamsize n) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    std::streamsize written = 0;
-
-    while (written < n) {
-        while (buffer_.full() && !input_closed_) space_available_.wait(lock);
-        if (input_closed_) break;  // reader gone
-        buffer_.push(s[written++]);
-        data_available_.notify_one();
+bool RealtimePipe::PipeBuffer::enableSpill(const std::string& directory, uint64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (maxBytes == 0 || !spill_.open(directory)) {
+        spill_limit_ = 0;
+        return false;
+    }
+    spill_limit_ = maxBytes;
+    return true;
+}
+
+uint64_t RealtimePipe::PipeBuffer::spilledBytes() const {
+    return spilled_.load(std::memory_order_acquire);
+}
+
+size_t RealtimePipe::PipeBuffer::write(const char* data, size_t size) {
+    size_t written = 0;
+    while (written < size) {
+        if (spilling_.load(std::memory_order_acquire)) {
+            size_t taken = writeSpill(data + written, size - written);
+            if (ring_.readerClosed()) break;
+            written += taken;
+            continue;
+        }
+        auto span = ring_.acquireWrite();
+        if (span.second == 0) {
+            if (ring_.readerClosed()) break;  // reader gone
+            if (beginSpill()) continue;
+            if (!ring_.waitWritable()) break;
+            continue;
+        }
+        const size_t chunk = std::min(span.second, size - written);
+        std::memcpy(span.first, data + written, chunk);
+        ring_.commitWrite(chunk);
+        written += chunk;
     }
     return written;
 }
 
-std::streamsize RealtimePipe::PipeBuffer::xsgetn(char* s, std::streamsize n) {
-    std::streamsize total = 0;
-    for (; total < n; ++total) {
-        int c = underflow();
-        if (c == traits_type::eof()) break;
-        s[total] = traits_type::to_char_type(c);
+size_t RealtimePipe::PipeBuffer::read(char* out, size_t size, bool fill) {
+    // Bytes already moved into the get area come first
+    size_t total = std::min(size, static_cast<size_t>(egptr() - gptr()));
+    if (total > 0) {
+        std::memcpy(out, gptr(), total);
+        gbump(static_cast<int>(total));
+    }
+    while (total < size) {
+        auto span = ring_.acquireRead();
+        if (span.second == 0) {
+            // The ring is drained; anything newer sits in the spill file
+            if (spilling_.load(std::memory_order_acquire)) {
+                total += readSpill(out + total, size - total);
+                continue;
+            }
+            // A short read may return what it has; a filling read waits for the rest
+            if ((total > 0 && !fill) || !ring_.waitReadable()) break;
+            continue;
+        }
+        const size_t chunk = std::min(span.second, size - total);
+        std::memcpy(out + total, span.first, chunk);
+        ring_.commitRead(chunk);
+        total += chunk;
     }
     return total;
 }
 
+std::streamsize RealtimePipe::PipeBuffer::xsputn(const char* s, std::streamsize n) {
+    if (n <= 0) return 0;
+    return static_cast<std::streamsize>(write(s, static_cast<size_t>(n)));
+}
+
+std::streambuf::int_type RealtimePipe::PipeBuffer::overflow(int_type ch) {
+    if (traits_type::eq_int_type(ch, traits_type::eof())) {
+        return traits_type::not_eof(ch);
+    }
+    const char c = traits_type::to_char_type(ch);
+    return write(&c, 1) == 1 ? ch : traits_type::eof();
+}
+
+std::streamsize RealtimePipe::PipeBuffer::xsgetn(char* s, std::streamsize n) {
+    if (n <= 0) return 0;
+    // istream::read() semantics: block until n bytes arrive or the writer closes
+    return static_cast<std::streamsize>(read(s, static_cast<size_t>(n), true));
+}
+
+std::streamsize RealtimePipe::PipeBuffer::showmanyc() {
+    const size_t buffered = ring_.size();
+    if (buffered == 0 && ring_.writerClosed()) return -1;
+    return static_cast<std::streamsize>(buffered);
+}
+
 std::streambuf::int_type RealtimePipe::PipeBuffer::underflow() {
-    std::unique_lock<std::mutex> lock(mutex_);
-    data_available_.wait(lock, [&] {
-        return !buffer_.empty() || output_closed_;
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    // Refill the get area with everything readable (up to its size) in one go
+    setg(get_area_, get_area_, get_area_);
+    const size_t got = read(get_area_, GET_AREA_SIZE, false);
+    if (got == 0) {
+        return traits_type::eof();
+    }
+    setg(get_area_, get_area_, get_area_ + got);
+    return traits_type::to_int_type(*gptr());
+}
+
+/*************** Private Methods ***************/
+size_t RealtimePipe::PipeBuffer::writeSpill(const char* data, size_t size) {
+    std::unique_lock<std::mutex> lock(spill_mutex_);
+    // Offsets only rewind once the reader has drained the file, so wait for that at the limit
+    spill_space_.wait(lock, [this]() {
+        return !spilling_.load() || spill_write_ < spill_limit_ || ring_.readerClosed();
     });
+    if (!spilling_.load() || ring_.readerClosed()) return 0;
 
-    if (buffer_.empty() && output_closed_) {
-        return traits_type::eof();
+    const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, spill_limit_ - spill_write_));
+    if (!spill_.reserve(spill_write_ + chunk)) {
+        // Out of disk space: cap the spill here and wait for the reader like a full ring
+        spill_limit_ = spill_write_;
+        return 0;
     }
+    std::memcpy(spill_.data() + spill_write_, data, chunk);
+    spill_write_ += chunk;
+    spilled_.store(spill_write_ - spill_read_, std::memory_order_release);
+    return chunk;
+}
 
-    current_char_ = buffer_.pop();
-    space_available_.notify_one();
-    setg(&current_char_, &current_char_, &current_char_ + 1);
-    return traits_type::to_int_type(current_char_);
+bool RealtimePipe::PipeBuffer::beginSpill() {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spill_limit_ == 0 || spill_write_ >= spill_limit_) return false;
+    spilling_.store(true, std::memory_order_release);
+    return true;
+}
+
+size_t RealtimePipe::PipeBuffer::readSpill(char* out, size_t size) {
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    const size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, spill_write_ - spill_read_));
+    if (chunk > 0) {
+        std::memcpy(out, spill_.data() + spill_read_, chunk);
+        spill_read_ += chunk;
+    }
+    if (spill_read_ == spill_write_) {
+        // Drained: rewind the file and send the writer back to the ring
+        spill_read_ = spill_write_ = 0;
+        spilling_.store(false, std::memory_order_release);
+        spill_space_.notify_all();
+    }
+    spilled_.store(spill_write_ - spill_read_, std::memory_order_release);
+    return chunk;
 }
 
 // ---------------- RealtimePipe ----------------
@@ -95,3 +210,23 @@ void RealtimePipe::closeOutput() {
 size_t RealtimePipe::available() const {
     return buffer_->available();
 }
+
+size_t RealtimePipe::write(const char* data, size_t size) {
+    return buffer_->write(data, size);
+}
+
+size_t RealtimePipe::read(char* out, size_t size) {
+    return buffer_->read(out, size, false);
+}
+
+bool RealtimePipe::enableSpill(const std::string& directory, uint64_t maxBytes) {
+    return buffer_->enableSpill(directory, maxBytes);
+}
+
+uint64_t RealtimePipe::spilledBytes() const {
+    return buffer_->spilledBytes();
+}
+
+size_t RealtimePipe::allocatedBytes() {
+    return g_allocatedBytes.load(std::memory_order_relaxed);
+}
@@ -1,21 +1,32 @@
 #pragma once
 
-#include <util/circular_buffer.hpp>
+#include <util/spsc_byte_ring.hpp>
+#include <util/spill_file.h>
 #include <streambuf>
 #include <istream>
 #include <ostream>
-#include <mutex>
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
 
 /**
- * @brief A thread-safe realtime pipe using a circular buffer internally.
+ * @brief A single-writer/single-reader realtime pipe over a lock-free byte ring.
  *
  * Writer threads obtain an output stream via getOutputStream(), and readers use getInputStream().
  * When the last output stream is destroyed, readers will automatically see EOF.
+ * write()/read() move bytes straight through the ring's spans without the iostream layer;
+ * a pipe should be fed through one of the two paths, not both at once.
+ *
+ * With enableSpill() a full ring no longer blocks the writer: further bytes go to a
+ * memory-mapped temporary file until the reader has drained it, then back to the ring,
+ * so the reader still sees one ordered stream while RAM use stays at the ring capacity.
  */
 class RealtimePipe {
 public:
+    // @param capacity Buffer size in bytes, rounded up to a power of two
     explicit RealtimePipe(size_t capacity = 8192);
 
     std::shared_ptr<std::istream> getInputStream();
@@ -36,6 +47,31 @@ public:
      */
     size_t available() const;
 
+    /**
+     * @brief Let the writer spill up to maxBytes to a temporary file in directory once
+     * the ring is full, blocking only beyond that. Call before writing starts.
+     * @return false if the spill file can't be created (the pipe keeps blocking when full)
+     */
+    bool enableSpill(const std::string& directory, uint64_t maxBytes);
+
+    // Bytes currently held in the spill file (included in available())
+    uint64_t spilledBytes() const;
+
+    // Ring memory of all pipes alive in the process, for the shared memory budget
+    static size_t allocatedBytes();
+
+    /**
+     * @brief Writer side: copy all of data into the pipe, blocking while it is full.
+     * @return Bytes written, less than size only if the reader side was closed
+     */
+    size_t write(const char* data, size_t size);
+
+    /**
+     * @brief Reader side: block until data is available, then copy up to size bytes.
+     * @return Bytes read, 0 once the writer side is closed and the pipe is drained
+     */
+    size_t read(char* out, size_t size);
+
 private:
     class PipeBuffer;
     class OutputStream;
@@ -51,23 +87,46 @@ private:
 class RealtimePipe::PipeBuffer : public std::streambuf {
 public:
     explicit PipeBuffer(size_t capacity);
+    ~PipeBuffer() override;
     void closeInput();
     void closeOutput();
     size_t available() const;
+    bool enableSpill(const std::string& directory, uint64_t maxBytes);
+    uint64_t spilledBytes() const;
+    size_t write(const char* data, size_t size);
+    size_t read(char* out, size_t size, bool fill);
 
 protected:
     std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int_type overflow(int_type ch) override;
     std::streamsize xsgetn(char* s, std::streamsize n) override;
+    std::streamsize showmanyc() override;
     int_type underflow() override;
 
 private:
-    util::CircularBuffer<char> buffer_;
-    mutable std::mutex mutex_;
-    std::condition_variable data_available_;
-    std::condition_variable space_available_;
-    bool input_closed_ = false;   // reader side closed
-    bool output_closed_ = false;  // writer side closed (EOF signal)
-    char current_char_ = 0;
+    // Get area for character-wise istream reads; bulk reads bypass it
+    static constexpr size_t GET_AREA_SIZE = 4096;
+
+    // Writer: append to the spill file if it is in use, returns bytes taken (0 = use the ring)
+    size_t writeSpill(const char* data, size_t size);
+    // Writer: the ring is full; start spilling if enabled, false if the writer must wait
+    bool beginSpill();
+    // Reader: take bytes from the spill file, switching back to the ring once it is drained
+    size_t readSpill(char* out, size_t size);
+
+    util::SpscByteRing ring_;
+    char get_area_[GET_AREA_SIZE];
+
+    // Spill state, guarded by spill_mutex_. While spilling_ is set the ring is empty or being
+    // drained and every new byte goes to the file, which keeps the stream in order.
+    mutable std::mutex spill_mutex_;
+    std::condition_variable spill_space_;
+    util::SpillFile spill_;
+    uint64_t spill_limit_ = 0;          // 0 = spilling disabled
+    uint64_t spill_read_ = 0;           // File offset of the next byte to read
+    uint64_t spill_write_ = 0;          // File offset of the next byte to write
+    std::atomic<bool> spilling_{false};
+    std::atomic<uint64_t> spilled_{0};  // spill_write_ - spill_read_
 };
 
 // ===============================================================
@@ -0,0 +1,211 @@
+#include "seekable_range_stream.hpp"
+#include <algorithm>
+#include <chrono>
+
+// ---------------- SeekableRangeStream ----------------
+
+SeekableRangeStream::SeekableRangeStream(std::shared_ptr<SparseSegmentCache> cache, RangeFetcher fetcher)
+    : cache_(std::move(cache)), fetcher_(std::move(fetcher)) {}
+
+SeekableRangeStream::~SeekableRangeStream() {
+    close();
+    if (fetch_thread_.joinable()) fetch_thread_.join();
+}
+
+void SeekableRangeStream::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_ || closed_) return;
+    started_ = true;
+    fetch_thread_ = std::thread([this]() { fetchLoop(); });
+}
+
+std::shared_ptr<std::istream> SeekableRangeStream::getInputStream() {
+    return std::make_shared<InputStream>(std::make_unique<RangeBuffer>(shared_from_this()));
+}
+
+void SeekableRangeStream::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    data_available_.notify_all();
+    fetch_changed_.notify_all();
+}
+
+bool SeekableRangeStream::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    fetch_changed_.wait(lock, [this]() { return finished_ || !started_; });
+    return !failed_ && cache_->complete();
+}
+
+void SeekableRangeStream::fetchLoop() {
+    const uint64_t total = cache_->totalSize();
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t next = 0;
+    int failures = 0;
+
+    while (!closed_) {
+        uint64_t from = retarget_ ? retarget_offset_ : next;
+        retarget_ = false;
+        uint64_t start = cache_->firstMissing(from);
+        if (start >= total) {
+            // Nothing missing after `from`; fill gaps left before it (e.g. skipped by a seek)
+            start = cache_->firstMissing(0);
+        }
+        if (start >= total) {
+            break;  // fully cached
+        }
+
+        uint64_t generation = ++fetch_generation_;
+        fetch_offset_ = start;
+        fetch_active_ = true;
+        hit_cached_ = false;
+        lock.unlock();
+
+        try {
+            std::future<bool> result = fetcher_(start, [this, generation](const char* data, size_t size) {
+                return onData(generation, data, size);
+            });
+            if (result.valid()) result.get();
+        } catch (...) {
+            // Counted as a failed attempt below
+        }
+
+        lock.lock();
+        fetch_active_ = false;
+        next = fetch_offset_;
+        if (closed_) break;
+        if (hit_cached_ || retarget_ || fetch_offset_ > start) {
+            // Completed, interrupted on purpose, or made progress before dropping
+            failures = 0;
+            continue;
+        }
+        if (++failures >= MAX_FETCH_RETRIES) {
+            failed_ = true;
+            break;
+        }
+        // Back off before retrying, unless a reader moved elsewhere in the meantime
+        fetch_changed_.wait_for(lock, std::chrono::milliseconds(500 * failures), [this]() {
+            return closed_ || retarget_;
+        });
+    }
+
+    finished_ = true;
+    fetch_active_ = false;
+    lock.unlock();
+    cache_->flush();
+    data_available_.notify_all();
+    fetch_changed_.notify_all();
+}
+
+bool SeekableRangeStream::onData(uint64_t generation, const char* data, size_t size) {
+    const uint64_t total = cache_->totalSize();
+    const uint64_t segment = cache_->segmentSize();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || retarget_ || generation != fetch_generation_) {
+            return false;  // cancelled, or superseded by a seek
+        }
+
+        size_t consumed = 0;
+        bool write_error = false;
+        while (consumed < size && fetch_offset_ < total) {
+            if (cache_->segmentComplete(fetch_offset_)) {
+                hit_cached_ = true;  // the rest of this response is already on disk
+                break;
+            }
+            uint64_t segment_end = std::min(total, (fetch_offset_ / segment + 1) * segment);
+            size_t take = static_cast<size_t>(std::min<uint64_t>(size - consumed, segment_end - fetch_offset_));
+            size_t written = cache_->write(fetch_offset_, data + consumed, take);
+            if (written == 0) {
+                write_error = true;  // cache file not writable; retried by fetchLoop
+                break;
+            }
+            fetch_offset_ += written;
+            consumed += written;
+        }
+        if (hit_cached_ || write_error) {
+            data_available_.notify_all();
+            return false;
+        }
+    }
+    data_available_.notify_all();
+    return true;
+}
+
+void SeekableRangeStream::requestRange_unsafe(uint64_t offset) {
+    if (finished_ || closed_) return;
+    if (retarget_) {
+        retarget_offset_ = offset;
+        return;
+    }
+    // The running fetch reaches this byte shortly; restarting would only cost a round trip
+    if (fetch_active_ && offset >= fetch_offset_ && offset < fetch_offset_ + SEEK_REUSE_WINDOW) {
+        return;
+    }
+    retarget_ = true;
+    retarget_offset_ = offset;
+    fetch_changed_.notify_all();
+}
+
+size_t SeekableRangeStream::readAt(uint64_t offset, char* data, size_t size) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (offset < cache_->totalSize()) {
+        size_t got = cache_->read(offset, data, size);
+        if (got > 0) return got;
+        if (closed_ || finished_) break;  // will never arrive
+        requestRange_unsafe(offset);
+        data_available_.wait(lock);
+    }
+    return 0;
+}
+
+// ---------------- RangeBuffer ----------------
+
+SeekableRangeStream::RangeBuffer::RangeBuffer(std::shared_ptr<SeekableRangeStream> owner)
+    : owner_(std::move(owner)), chunk_(CHUNK_SIZE) {}
+
+std::streambuf::int_type SeekableRangeStream::RangeBuffer::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    uint64_t position = chunk_offset_ + static_cast<uint64_t>(gptr() - eback());
+    size_t got = owner_->readAt(position, chunk_.data(), chunk_.size());
+    chunk_offset_ = position;
+    setg(chunk_.data(), chunk_.data(), chunk_.data() + got);
+    if (got == 0) {
+        return traits_type::eof();
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streambuf::pos_type SeekableRangeStream::RangeBuffer::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                                    std::ios_base::openmode which) {
+    const pos_type invalid(off_type(-1));
+    if (!(which & std::ios_base::in)) return invalid;
+
+    const int64_t total = static_cast<int64_t>(owner_->cache_->totalSize());
+    const int64_t current = static_cast<int64_t>(chunk_offset_) + (gptr() - eback());
+    int64_t target = 0;
+    switch (dir) {
+        case std::ios_base::beg: target = off; break;
+        case std::ios_base::cur: target = current + off; break;
+        case std::ios_base::end: target = total + off; break;
+        default: return invalid;
+    }
+    if (target < 0 || target > total) return invalid;
+
+    const int64_t chunk_begin = static_cast<int64_t>(chunk_offset_);
+    if (target >= chunk_begin && target <= chunk_begin + (egptr() - eback())) {
+        // Still inside the buffered chunk
+        setg(eback(), eback() + (target - chunk_begin), egptr());
+    } else {
+        chunk_offset_ = static_cast<uint64_t>(target);
+        setg(chunk_.data(), chunk_.data(), chunk_.data());
+    }
+    return pos_type(off_type(target));
+}
+
+std::streambuf::pos_type SeekableRangeStream::RangeBuffer::seekpos(pos_type pos, std::ios_base::openmode which) {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "sparse_segment_cache.hpp"
+#include <streambuf>
+#include <istream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A seekable input stream over a remote resource, backed by a SparseSegmentCache.
+ *
+ * A background fetch thread downloads the resource through a user-supplied range fetcher
+ * and stores it in the cache. Readers are served from the cache; when a reader seeks to a
+ * range that is neither cached nor about to arrive, the running fetch is cancelled and a
+ * new one is started at that position. A fetch that runs into an already cached segment
+ * stops and the thread moves on to the next gap, so each byte is downloaded only once.
+ *
+ * Input streams returned by getInputStream() support seekg/tellg and see EOF at the end of
+ * the resource or once the stream is closed.
+ */
+class SeekableRangeStream : public std::enable_shared_from_this<SeekableRangeStream> {
+public:
+    // Receives resource bytes in order; return false to cancel the request
+    using ContentReceiver = std::function<bool(const char*, size_t)>;
+    // Start a request delivering the resource from `offset` to its end; the future
+    // resolves to true once the response body was fully delivered
+    using RangeFetcher = std::function<std::future<bool>(uint64_t offset, ContentReceiver receiver)>;
+
+    SeekableRangeStream(std::shared_ptr<SparseSegmentCache> cache, RangeFetcher fetcher);
+    ~SeekableRangeStream();
+
+    SeekableRangeStream(const SeekableRangeStream&) = delete;
+    SeekableRangeStream& operator=(const SeekableRangeStream&) = delete;
+
+    // Start the fetch thread; readers block until it runs. No-op if already started.
+    void start();
+
+    // The object must be owned by a shared_ptr; each stream keeps it alive
+    std::shared_ptr<std::istream> getInputStream();
+
+    /**
+     * @brief Cancel any running fetch and wake blocked readers, which then see EOF.
+     */
+    void close();
+
+    /**
+     * @brief Block until the fetch thread has finished.
+     * @return true if the whole resource is cached, false on failure or close()
+     */
+    bool wait();
+
+    std::shared_ptr<SparseSegmentCache> cache() const { return cache_; }
+
+    // Reads that are this close behind the running fetch wait for it instead of restarting it
+    static constexpr uint64_t SEEK_REUSE_WINDOW = 512 * 1024;
+    // Consecutive failed requests without progress before giving up
+    static constexpr int MAX_FETCH_RETRIES = 3;
+
+private:
+    class RangeBuffer;
+    class InputStream;
+
+    void fetchLoop();
+    bool onData(uint64_t generation, const char* data, size_t size);
+    // Called by readers (mutex held): make sure the byte at offset is on its way
+    void requestRange_unsafe(uint64_t offset);
+    // Called by readers: copy cached bytes at offset, blocking until they arrive
+    size_t readAt(uint64_t offset, char* data, size_t size);
+
+    std::shared_ptr<SparseSegmentCache> cache_;
+    RangeFetcher fetcher_;
+
+    std::mutex mutex_;
+    std::condition_variable data_available_;
+    std::condition_variable fetch_changed_;
+    std::thread fetch_thread_;
+    bool started_ = false;
+    bool closed_ = false;
+    bool finished_ = false;          // fetch thread has exited
+    bool failed_ = false;
+    bool fetch_active_ = false;
+    uint64_t fetch_generation_ = 0;
+    uint64_t fetch_offset_ = 0;      // write head of the running fetch
+    bool retarget_ = false;
+    uint64_t retarget_offset_ = 0;
+    bool hit_cached_ = false;        // running fetch reached an already cached segment
+};
+
+// ===============================================================
+// Internal implementation details
+// ===============================================================
+
+class SeekableRangeStream::RangeBuffer : public std::streambuf {
+public:
+    explicit RangeBuffer(std::shared_ptr<SeekableRangeStream> owner);
+
+protected:
+    int_type underflow() override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::shared_ptr<SeekableRangeStream> owner_;
+    std::vector<char> chunk_;
+    uint64_t chunk_offset_ = 0;      // resource offset of chunk_[0]
+};
+
+class SeekableRangeStream::InputStream : public std::istream {
+public:
+    explicit InputStream(std::unique_ptr<RangeBuffer> buf)
+        : std::istream(buf.get()), holder_(std::move(buf)) {}
+private:
+    std::unique_ptr<RangeBuffer> holder_;
+};
@@ -0,0 +1,156 @@
+#include "segmented_download.hpp"
+#include <algorithm>
+
+SegmentedDownload::SegmentedDownload(uint64_t totalSize, RangeFetcher fetcher, Options options)
+    : total_size_(totalSize)
+    , fetcher_(std::move(fetcher))
+    , connections_(std::max<size_t>(1, options.connections))
+    , window_(options.window > 0 ? options.window : 2 * connections_)
+{
+    const uint64_t segmentSize = std::max<uint64_t>(1, options.segmentSize);
+    for (uint64_t offset = 0; offset < total_size_; offset += segmentSize) {
+        Segment segment;
+        segment.offset = offset;
+        segment.length = std::min(segmentSize, total_size_ - offset);
+        segments_.push_back(std::move(segment));
+    }
+}
+
+SegmentedDownload::~SegmentedDownload()
+{
+    cancel();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+bool SegmentedDownload::run(const ContentReceiver& receiver)
+{
+    const size_t workerCount = std::min(connections_, segments_.size());
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+
+    bool ok = true;
+    std::vector<char> chunk;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (head_ < segments_.size()) {
+        Segment& segment = segments_[head_];
+        segment_changed_.wait(lock, [&]() {
+            return failed_ || cancelled_.load() || !segment.pending.empty() || segment.done;
+        });
+        if (failed_ || cancelled_.load()) {
+            ok = false;
+            break;
+        }
+        chunk.clear();
+        chunk.swap(segment.pending);
+        const bool finished = segment.done;
+
+        // Deliver without the lock so workers keep filling their segments
+        lock.unlock();
+        const bool accepted = chunk.empty() || receiver(chunk.data(), chunk.size());
+        lock.lock();
+        if (!accepted) {
+            ok = false;
+            break;
+        }
+        if (finished && segments_[head_].pending.empty()) {
+            std::vector<char>().swap(segments_[head_].pending);
+            ++head_;
+            window_moved_.notify_all();
+        }
+    }
+    lock.unlock();
+
+    cancel();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+    workers_.clear();
+    return ok;
+}
+
+void SegmentedDownload::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_.store(true);
+    }
+    segment_changed_.notify_all();
+    window_moved_.notify_all();
+}
+
+/*************** Private Methods ***************/
+void SegmentedDownload::workerLoop()
+{
+    while (true) {
+        size_t index = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            window_moved_.wait(lock, [this]() {
+                return cancelled_.load() || failed_ || next_claim_ >= segments_.size()
+                    || next_claim_ < head_ + window_;
+            });
+            if (cancelled_.load() || failed_ || next_claim_ >= segments_.size()) {
+                return;
+            }
+            index = next_claim_++;
+        }
+
+        const bool ok = fetchSegment(index);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (ok) {
+                segments_[index].done = true;
+            } else {
+                failed_ = true;
+            }
+        }
+        segment_changed_.notify_all();
+        if (!ok) {
+            window_moved_.notify_all();
+            return;
+        }
+    }
+}
+
+bool SegmentedDownload::fetchSegment(size_t index)
+{
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        offset = segments_[index].offset;
+        length = segments_[index].length;
+    }
+
+    uint64_t received = 0;
+    int failures = 0;
+    while (received < length && !cancelled_.load()) {
+        const uint64_t before = received;
+        auto receiver = [this, index, length, &received](const char* data, size_t size) -> bool {
+            if (cancelled_.load()) return false;
+            // Ignore anything past the range in case the server sent more
+            const size_t take = static_cast<size_t>(std::min<uint64_t>(size, length - received));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Segment& segment = segments_[index];
+                segment.pending.insert(segment.pending.end(), data, data + take);
+            }
+            received += take;
+            segment_changed_.notify_all();
+            return true;
+        };
+        try {
+            fetcher_(offset + received, length - received, receiver).get();
+        } catch (...) {
+            // Counted as a failed attempt below
+        }
+        if (received >= length) break;
+        // Failed, or the server ended the range early: resume where it stopped
+        failures = received > before ? 1 : failures + 1;
+        if (failures > MAX_SEGMENT_RETRIES) return false;
+    }
+    return received >= length;
+}
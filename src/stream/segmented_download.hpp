@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Downloads a resource of known size as Range segments over several connections
+ * and delivers the bytes to a single receiver strictly in order.
+ *
+ * Worker threads claim segments lowest offset first, so the segment the reader needs next
+ * is always the one being fetched (or already done), and at most `window` segments are in
+ * flight or waiting ahead of it, which bounds memory to about window * segmentSize. The
+ * segment at the head is forwarded while it downloads instead of after it completes. A
+ * segment whose request fails is resumed from its last byte, up to MAX_SEGMENT_RETRIES
+ * consecutive requests without progress.
+ *
+ * run() executes on the caller's thread and is the only caller of the receiver.
+ */
+class SegmentedDownload {
+public:
+    // Receives resource bytes in order; return false to cancel
+    using ContentReceiver = std::function<bool(const char*, size_t)>;
+    // Start a request for `length` bytes at `offset`; the future resolves to true once the
+    // whole range was delivered to the receiver
+    using RangeFetcher = std::function<std::future<bool>(uint64_t offset, uint64_t length, ContentReceiver receiver)>;
+
+    struct Options {
+        size_t connections = 4;
+        uint64_t segmentSize = 1024 * 1024;
+        size_t window = 0;              // Segments fetched ahead of the head, 0 = 2 * connections
+    };
+
+    static constexpr int MAX_SEGMENT_RETRIES = 3;
+
+    SegmentedDownload(uint64_t totalSize, RangeFetcher fetcher, Options options);
+    ~SegmentedDownload();
+
+    SegmentedDownload(const SegmentedDownload&) = delete;
+    SegmentedDownload& operator=(const SegmentedDownload&) = delete;
+
+    /**
+     * @brief Download everything, feeding receiver in order. Blocks until done.
+     * @return true if every byte was delivered; false on failure, cancel() or a receiver returning false
+     */
+    bool run(const ContentReceiver& receiver);
+
+    // Stop the workers and make run() return false. Callable from any thread.
+    void cancel();
+
+    size_t segmentCount() const { return segments_.size(); }
+
+private:
+    struct Segment {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        std::vector<char> pending;      // Fetched but not yet handed to the receiver
+        bool done = false;
+    };
+
+    void workerLoop();
+    bool fetchSegment(size_t index);
+
+    uint64_t total_size_;
+    RangeFetcher fetcher_;
+    size_t connections_;
+    size_t window_;
+
+    std::mutex mutex_;
+    std::condition_variable segment_changed_;   // Workers -> run(): new bytes or state
+    std::condition_variable window_moved_;      // run() -> workers: head advanced
+    std::vector<Segment> segments_;
+    size_t next_claim_ = 0;             // First segment no worker has taken
+    size_t head_ = 0;                   // Segment run() is delivering
+    bool failed_ = false;
+    std::atomic<bool> cancelled_{false};
+    std::vector<std::thread> workers_;
+};
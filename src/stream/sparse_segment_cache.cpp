@@ -0,0 +1,230 @@
+#include "sparse_segment_cache.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+    constexpr uint32_t INDEX_MAGIC = 0x43535042;   // "BPSC"
+    constexpr uint32_t INDEX_VERSION = 1;
+
+    std::string indexPath(const std::string& path) { return path + ".idx"; }
+}
+
+SparseSegmentCache::SparseSegmentCache(uint64_t totalSize, uint64_t segmentSize)
+    : total_size_(totalSize)
+    , segment_size_(std::clamp<uint64_t>(segmentSize, 4096, UINT32_MAX))
+{
+    size_t count = static_cast<size_t>((total_size_ + segment_size_ - 1) / segment_size_);
+    filled_.assign(count, 0);
+}
+
+SparseSegmentCache::~SparseSegmentCache() {
+    flush();
+}
+
+bool SparseSegmentCache::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    finalized_ = false;
+
+    std::error_code ec;
+    bool resumed = std::filesystem::exists(path, ec) && loadIndex_unsafe()
+        && std::filesystem::file_size(path, ec) == total_size_;
+    if (!resumed) {
+        std::fill(filled_.begin(), filled_.end(), 0);
+        complete_segments_ = 0;
+        std::ofstream create(path, std::ios::binary | std::ios::trunc);
+        if (!create.is_open()) return false;
+        create.close();
+        std::filesystem::resize_file(path, total_size_, ec);
+        if (ec) return false;
+        index_dirty_ = true;
+    }
+
+    file_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file_.is_open()) return false;
+    return saveIndex_unsafe();
+}
+
+size_t SparseSegmentCache::write(uint64_t offset, const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || finalized_) return 0;
+
+    size_t consumed = 0;
+    bool segment_completed = false;
+    while (consumed < size && offset < total_size_) {
+        size_t index = static_cast<size_t>(offset / segment_size_);
+        uint64_t seg_start = index * segment_size_;
+        uint64_t seg_len = segmentLength(index);
+        uint64_t fill_end = seg_start + filled_[index];
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - consumed, seg_start + seg_len - offset));
+
+        if (offset > fill_end) {
+            break;  // would leave a hole inside the segment
+        }
+        if (offset + chunk > fill_end) {
+            // Skip the part that is already cached, store the rest
+            size_t skip = static_cast<size_t>(fill_end - offset);
+            file_.seekp(static_cast<std::streamoff>(fill_end));
+            file_.write(data + consumed + skip, static_cast<std::streamsize>(chunk - skip));
+            if (!file_) {
+                file_.clear();
+                break;
+            }
+            filled_[index] = static_cast<uint32_t>(offset + chunk - seg_start);
+            index_dirty_ = true;
+            if (filled_[index] == seg_len) {
+                ++complete_segments_;
+                segment_completed = true;
+            }
+        }
+        consumed += chunk;
+        offset += chunk;
+    }
+    if (segment_completed) {
+        file_.flush();
+        saveIndex_unsafe();
+    }
+    return consumed;
+}
+
+size_t SparseSegmentCache::read(uint64_t offset, char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || offset >= total_size_) return 0;
+
+    // Serve the contiguous cached run starting at offset
+    uint64_t end = offset;
+    while (end < offset + size && end < total_size_) {
+        size_t index = static_cast<size_t>(end / segment_size_);
+        uint64_t fill_end = index * segment_size_ + filled_[index];
+        if (end >= fill_end) break;
+        end = std::min<uint64_t>(fill_end, offset + size);
+        if (filled_[index] != segmentLength(index)) break;
+    }
+    if (end == offset) return 0;
+
+    file_.seekg(static_cast<std::streamoff>(offset));
+    file_.read(data, static_cast<std::streamsize>(end - offset));
+    std::streamsize got = file_.gcount();
+    file_.clear();
+    return got > 0 ? static_cast<size_t>(got) : 0;
+}
+
+uint64_t SparseSegmentCache::firstMissing(uint64_t from) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t index = static_cast<size_t>(from / segment_size_); index < filled_.size(); ++index) {
+        if (filled_[index] < segmentLength(index)) {
+            return index * segment_size_ + filled_[index];
+        }
+    }
+    return total_size_;
+}
+
+bool SparseSegmentCache::segmentComplete(uint64_t offset) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (offset >= total_size_) return true;
+    size_t index = static_cast<size_t>(offset / segment_size_);
+    return filled_[index] == segmentLength(index);
+}
+
+bool SparseSegmentCache::complete() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return complete_segments_ == filled_.size();
+}
+
+uint64_t SparseSegmentCache::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (uint32_t fill : filled_) total += fill;
+    return total;
+}
+
+bool SparseSegmentCache::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open() || finalized_) return false;
+    file_.flush();
+    return saveIndex_unsafe();
+}
+
+bool SparseSegmentCache::finalize(const std::string& finalPath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finalized_) return true;
+    if (!file_.is_open() || complete_segments_ != filled_.size()) return false;
+
+    file_.close();
+    std::error_code ec;
+    std::filesystem::remove(indexPath(path_), ec);
+    if (std::filesystem::exists(finalPath, ec)) {
+        std::filesystem::remove(finalPath, ec);
+    }
+    std::filesystem::rename(path_, finalPath, ec);
+    if (ec) {
+        // Rename fails across volumes; fall back to copy + remove
+        ec.clear();
+        std::filesystem::copy_file(path_, finalPath, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            file_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+            index_dirty_ = true;
+            saveIndex_unsafe();
+            return false;
+        }
+        std::filesystem::remove(path_, ec);
+    }
+    path_ = finalPath;
+    finalized_ = true;
+    file_.open(path_, std::ios::binary | std::ios::in);
+    return file_.is_open();
+}
+
+/*************** Private Methods ***************/
+uint64_t SparseSegmentCache::segmentLength(size_t index) const {
+    uint64_t start = index * segment_size_;
+    return std::min(segment_size_, total_size_ - start);
+}
+
+bool SparseSegmentCache::loadIndex_unsafe() {
+    std::ifstream in(indexPath(path_), std::ios::binary);
+    if (!in.is_open()) return false;
+
+    uint32_t magic = 0, version = 0;
+    uint64_t total = 0, segment = 0, count = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&total), sizeof(total));
+    in.read(reinterpret_cast<char*>(&segment), sizeof(segment));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || magic != INDEX_MAGIC || version != INDEX_VERSION
+        || total != total_size_ || segment != segment_size_ || count != filled_.size()) {
+        return false;
+    }
+
+    std::vector<uint32_t> filled(filled_.size());
+    in.read(reinterpret_cast<char*>(filled.data()), static_cast<std::streamsize>(filled.size() * sizeof(uint32_t)));
+    if (!in) return false;
+
+    complete_segments_ = 0;
+    for (size_t i = 0; i < filled.size(); ++i) {
+        filled[i] = static_cast<uint32_t>(std::min<uint64_t>(filled[i], segmentLength(i)));
+        if (filled[i] == segmentLength(i)) ++complete_segments_;
+    }
+    filled_ = std::move(filled);
+    index_dirty_ = false;
+    return true;
+}
+
+bool SparseSegmentCache::saveIndex_unsafe() {
+    if (!index_dirty_) return true;
+    std::ofstream out(indexPath(path_), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    uint64_t count = filled_.size();
+    out.write(reinterpret_cast<const char*>(&INDEX_MAGIC), sizeof(INDEX_MAGIC));
+    out.write(reinterpret_cast<const char*>(&INDEX_VERSION), sizeof(INDEX_VERSION));
+    out.write(reinterpret_cast<const char*>(&total_size_), sizeof(total_size_));
+    out.write(reinterpret_cast<const char*>(&segment_size_), sizeof(segment_size_));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(filled_.data()), static_cast<std::streamsize>(filled_.size() * sizeof(uint32_t)));
+    if (!out) return false;
+    index_dirty_ = false;
+    return true;
+}
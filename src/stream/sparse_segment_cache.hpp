@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A sparse, segment-indexed on-disk cache for one remote resource.
+ *
+ * The backing file is sized to the full resource up front and split into fixed-size
+ * segments. Each segment records how many bytes from its start have been written, so
+ * ranges fetched out of order (after a seek) can be stored and served again without
+ * re-downloading. The fill index is persisted next to the data file ("<path>.idx"),
+ * which lets an interrupted download resume where it stopped.
+ *
+ * Writes inside a segment must be contiguous with what the segment already holds;
+ * overlapping bytes are skipped and bytes beyond a gap are rejected.
+ * All methods are thread-safe.
+ */
+class SparseSegmentCache {
+public:
+    static constexpr uint64_t DEFAULT_SEGMENT_SIZE = 256 * 1024;
+
+    explicit SparseSegmentCache(uint64_t totalSize, uint64_t segmentSize = DEFAULT_SEGMENT_SIZE);
+    ~SparseSegmentCache();
+
+    SparseSegmentCache(const SparseSegmentCache&) = delete;
+    SparseSegmentCache& operator=(const SparseSegmentCache&) = delete;
+
+    /**
+     * @brief Open (or create) the backing file.
+     * An existing file is reused only when its index matches this cache's geometry;
+     * otherwise it is truncated and the cache starts empty.
+     * @return true on success, false when the file can't be created
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Store bytes at an absolute offset.
+     * @return Number of input bytes consumed (cached or already present); stops early at a gap
+     */
+    size_t write(uint64_t offset, const char* data, size_t size);
+
+    /**
+     * @brief Copy cached bytes starting at offset.
+     * @return Bytes copied; 0 if the byte at offset has not been fetched yet
+     */
+    size_t read(uint64_t offset, char* data, size_t size);
+
+    // Where a fetch must resume so the byte at `from` gets cached: the end of the cached
+    // prefix of the first incomplete segment at or after `from`, or totalSize() if none
+    uint64_t firstMissing(uint64_t from) const;
+    // Whether the segment containing offset is completely cached
+    bool segmentComplete(uint64_t offset) const;
+    bool complete() const;
+
+    uint64_t totalSize() const { return total_size_; }
+    uint64_t segmentSize() const { return segment_size_; }
+    uint64_t cachedBytes() const;
+
+    // Persist the fill index so a later open() can resume
+    bool flush();
+
+    /**
+     * @brief Move a complete cache to its final location.
+     * The index is removed, the data file renamed to finalPath and reopened read-only,
+     * so reads keep working afterwards.
+     * @return false if the cache is incomplete or the file can't be moved
+     */
+    bool finalize(const std::string& finalPath);
+
+private:
+    uint64_t segmentLength(size_t index) const;
+    bool loadIndex_unsafe();
+    bool saveIndex_unsafe();
+
+    const uint64_t total_size_;
+    const uint64_t segment_size_;
+    mutable std::mutex mutex_;
+    std::fstream file_;
+    std::string path_;
+    std::vector<uint32_t> filled_;   // bytes cached from each segment's start
+    size_t complete_segments_ = 0;
+    bool index_dirty_ = false;
+    bool finalized_ = false;
+};
@@ -11,6 +11,9 @@
 #include <ui/theme/theme_manager.h>
 #include <audio/audio_player_controller.h>
 #include <QApplication>
+#include <QEvent>
+#include <QHideEvent>
+#include <QShowEvent>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -67,8 +70,13 @@ void MainWindow::setupCustomComponents()
     auto* themeManager = THEME_MANAGER;
     if (themeManager) {
         connect(themeManager, &ThemeManager::themeApplied, this, [this, themeManager](const Theme& theme) {
-            QString styleSheet = themeManager->generateStyleSheet(theme);
-            qApp->setStyleSheet(styleSheet);
+            // Setting the stylesheet re-polishes every widget; skip it when only
+            // palette colors such as the accent changed
+            const QString styleSheet = themeManager->styleSheetFor(theme);
+            if (styleSheet != qApp->styleSheet()) {
+                qApp->setStyleSheet(styleSheet);
+            }
+            qApp->setPalette(ThemeManager::paletteFor(theme, qApp->palette()));
         });
     }
 }
@@ -120,6 +128,31 @@ void MainWindow::setupNavigator()
     }
 }
 
+void MainWindow::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        reportWindowVisibility();
+    }
+}
+
+void MainWindow::showEvent(QShowEvent* event)
+{
+    QMainWindow::showEvent(event);
+    reportWindowVisibility();
+}
+
+void MainWindow::hideEvent(QHideEvent* event)
+{
+    QMainWindow::hideEvent(event);
+    reportWindowVisibility();
+}
+
+void MainWindow::reportWindowVisibility()
+{
+    APP_CONTEXT.setWindowVisible(isVisible() && !isMinimized());
+}
+
 void MainWindow::onMinimizeClicked()
 {
     showMinimized();
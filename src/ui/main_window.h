@@ -25,6 +25,12 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    // Minimized or hidden counts towards idle mode (see ApplicationContext::setWindowVisible)
+    void changeEvent(QEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 private slots:
     void onMinimizeClicked();
     void onMaximizeClicked();
@@ -36,6 +42,7 @@ private slots:
 private:
     void setupCustomComponents();
     void setupNavigator();
+    void reportWindowVisibility();
 
 private:
     Ui::MainWindow *ui;
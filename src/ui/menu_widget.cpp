@@ -10,6 +10,7 @@
 #include <QKeyEvent>
 #include <QEvent>
 #include <QUuid>
+#include <QSet>
 #include <QMessageBox>
 #include <QRegularExpression>
 #include <QInputDialog>
@@ -18,6 +19,7 @@
 #include <QRect>
 #include <QTimer>
 #include <QThread>
+#include <algorithm>
 #include <QMetaObject>
 #include <QFontMetrics>
 #include <QShowEvent>
@@ -39,6 +41,8 @@ MenuWidget::MenuWidget(QWidget *parent)
     , m_addCategoryButton(nullptr)
     , m_addPlaylistButton(nullptr)
     , m_hoveredCategoryItem(nullptr)
+    , m_folderIcon(":/icons/folder.png")
+    , m_playlistItemIcon(":/icons/playlist_item.png")
 {
     ui->setupUi(this);
     
@@ -68,6 +72,27 @@ MenuWidget::MenuWidget(QWidget *parent)
         // Ensure slots run on the UI thread via queued connections
         connect(PLAYLIST_MANAGER, &PlaylistManager::categoriesLoaded, this, &MenuWidget::onCategoriesLoaded, Qt::QueuedConnection);
         connect(PLAYLIST_MANAGER, &PlaylistManager::categoryAdded, this, &MenuWidget::onCategoryAdded, Qt::QueuedConnection);
+        // Each change touches only its own item
+        connect(PLAYLIST_MANAGER, &PlaylistManager::categoryRemoved, this, &MenuWidget::onCategoryRemoved, Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::categoryUpdated, this, &MenuWidget::onCategoryUpdated, Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::playlistAdded, this, &MenuWidget::onPlaylistAdded, Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::playlistRemoved, this, &MenuWidget::onPlaylistRemoved, Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::playlistUpdated, this, &MenuWidget::onPlaylistUpdated, Qt::QueuedConnection);
+        // Song counts follow changes as they come, batches included
+        connect(PLAYLIST_MANAGER, &PlaylistManager::songAdded, this,
+                [this](const playlist::SongInfo&, const QUuid& playlistId) { adjustPlaylistSongCount(playlistId, 1); },
+                Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::songRemoved, this,
+                [this](const playlist::SongInfo&, const QUuid& playlistId) { adjustPlaylistSongCount(playlistId, -1); },
+                Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::songsAdded, this,
+                [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId, int) {
+                    adjustPlaylistSongCount(playlistId, static_cast<int>(songs.size()));
+                }, Qt::QueuedConnection);
+        connect(PLAYLIST_MANAGER, &PlaylistManager::songsRemoved, this,
+                [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId) {
+                    adjustPlaylistSongCount(playlistId, -static_cast<int>(songs.size()));
+                }, Qt::QueuedConnection);
 
         // If categories are already present, schedule update on the widget (GUI) thread.
     LOG_DEBUG("MenuWidget ctor: scheduling updateCategories (queued) on thread {} (widget thread {})",
@@ -275,7 +300,9 @@ QTreeWidgetItem* MenuWidget::createPlaylistItem(const MenuPlaylistInfo& playlist
     item->setData(0, Qt::UserRole, playlist.id);
     item->setData(0, Qt::UserRole + 1, uuid);
     item->setData(0, Qt::UserRole + 2, static_cast<int>(PlaylistItem));
-    item->setIcon(0, QIcon(":/icons/playlist_item.png"));
+    item->setData(0, Qt::UserRole + 3, playlist.name);
+    item->setData(0, Qt::UserRole + 4, playlist.songCount);
+    item->setIcon(0, m_playlistItemIcon);
     
     return item;
 }
@@ -291,6 +318,98 @@ QTreeWidgetItem* MenuWidget::createActionItem(const QString& name, const QString
     return item;
 }
 
+void MenuWidget::adjustPlaylistSongCount(const QUuid& playlistId, int delta)
+{
+    if (delta == 0) return;
+    
+    QTreeWidgetItem* item = m_playlistItems.value(playlistId);
+    if (!item) return;
+    const int songCount = std::max(0, item->data(0, Qt::UserRole + 4).toInt() + delta);
+    setPlaylistItemText(item, item->data(0, Qt::UserRole + 3).toString(), songCount);
+}
+
+void MenuWidget::setPlaylistItemText(QTreeWidgetItem* item, const QString& name, int songCount)
+{
+    item->setData(0, Qt::UserRole + 3, name);
+    item->setData(0, Qt::UserRole + 4, songCount);
+    item->setText(0, QString("%1 (%2 songs)").arg(name).arg(songCount));
+}
+
+QTreeWidgetItem* MenuWidget::syncCategoryItem(const playlist::CategoryInfo& category)
+{
+    QTreeWidgetItem* item = m_categoryItems.value(category.uuid);
+    if (item) {
+        item->setText(0, category.name);
+        return item;
+    }
+    QString categoryId = QString("category_%1").arg(category.uuid.toString(QUuid::WithoutBraces));
+    item = createCategoryItem(category.name, categoryId, category.uuid);
+    item->setIcon(0, m_folderIcon);
+    
+    // Add as a child of the Playlists category
+    m_playlistCategory->addChild(item);
+    m_categoryItems.insert(category.uuid, item);
+    return item;
+}
+
+QTreeWidgetItem* MenuWidget::syncPlaylistItem(const playlist::PlaylistInfo& playlist, const QUuid& categoryId)
+{
+    QTreeWidgetItem* item = m_playlistItems.value(playlist.uuid);
+    // A null category (updates that don't move the playlist) keeps it where it is
+    QTreeWidgetItem* categoryItem = categoryId.isNull() && item ? item->parent() : m_categoryItems.value(categoryId);
+    if (!categoryItem) {
+        LOG_WARN("Playlist {} is in category {}, which the menu doesn't have",
+                 playlist.uuid.toString().toStdString(), categoryId.toString().toStdString());
+        return nullptr;
+    }
+    if (item) {
+        setPlaylistItemText(item, playlist.name, item->data(0, Qt::UserRole + 4).toInt());
+        item->setToolTip(0, playlist.description);
+        if (item->parent() != categoryItem) {
+            // Moved to another category
+            item->parent()->removeChild(item);
+            categoryItem->addChild(item);
+        }
+        return item;
+    }
+    MenuPlaylistInfo menuPlaylist;
+    menuPlaylist.id = playlist.uuid.toString(QUuid::WithoutBraces);
+    menuPlaylist.name = playlist.name;
+    menuPlaylist.description = playlist.description;
+    // Get song count from the separate songs storage
+    menuPlaylist.songCount = PLAYLIST_MANAGER->songsSnapshot(playlist.uuid).size();
+    
+    item = createPlaylistItem(menuPlaylist, playlist.uuid);
+    categoryItem->addChild(item);
+    m_playlistItems.insert(playlist.uuid, item);
+    return item;
+}
+
+void MenuWidget::removeTreeItem(QTreeWidgetItem* item)
+{
+    if (!item) return;
+    
+    for (int i = item->childCount() - 1; i >= 0; --i) {
+        removeTreeItem(item->child(i));
+    }
+    const QUuid uuid = item->data(0, Qt::UserRole + 1).toUuid();
+    if (static_cast<ItemType>(item->data(0, Qt::UserRole + 2).toInt()) == CategoryItem) {
+        m_categoryItems.remove(uuid);
+    } else {
+        m_playlistItems.remove(uuid);
+    }
+    if (m_contextMenuItem == item) {
+        m_contextMenuItem = nullptr;
+    }
+    if (m_hoveredCategoryItem == item) {
+        onTreeLeaveEvent();
+    }
+    if (item->parent()) {
+        item->parent()->removeChild(item);
+    }
+    delete item;
+}
+
 QTreeWidgetItem* MenuWidget::findPlaylistItem(const QString& playlistId)
 {
     if (!m_playlistCategory) return nullptr;
@@ -365,66 +484,43 @@ void MenuWidget::updateCategories()
         return;
     }
     
-    // Clear existing child categories (but keep any existing playlists)
-    QList<QTreeWidgetItem*> toRemove;
-    for (int i = 0; i < m_playlistCategory->childCount(); ++i) {
-        QTreeWidgetItem* child = m_playlistCategory->child(i);
-        ItemType itemType = static_cast<ItemType>(child->data(0, Qt::UserRole + 2).toInt());
-        if (itemType == CategoryItem) {
-            toRemove.append(child);
-        }
-    }
-    
-    for (QTreeWidgetItem* item : toRemove) {
-        m_playlistCategory->removeChild(item);
-        delete item;
-    }
-    
-    // Load all categories from the manager
+    // Bring the items in line with the manager, keeping the ones still there
     QUuid currentPlaylistId = AUDIO_PLAYER_CONTROLLER->getCurrentPlaylistId();
     LOG_DEBUG("Updating categories, current playlist ID: {}", currentPlaylistId.toString(QUuid::WithoutBraces).toStdString());
-    int categoryCount = 0, playlistCount = 0;
+    ui->menuTree->setUpdatesEnabled(false);
+    QSet<QUuid> categoryIds, playlistIds;
     QList<playlist::CategoryInfo> categories = PLAYLIST_MANAGER->iterateCategories([](const playlist::CategoryInfo&) { return true; });
     for (const auto& categoryInfo : categories) {
-        QString categoryId = QString("category_%1").arg(categoryInfo.uuid.toString(QUuid::WithoutBraces));
+        QTreeWidgetItem* categoryItem = syncCategoryItem(categoryInfo);
+        categoryIds.insert(categoryInfo.uuid);
         
-        // Create category tree widget item
-        QTreeWidgetItem* categoryItem = createCategoryItem(categoryInfo.name, categoryId, categoryInfo.uuid);
-        categoryItem->setIcon(0, QIcon(":/icons/folder.png"));
-        
-        // Add as a child of the Playlists category
-        m_playlistCategory->addChild(categoryItem);
-        
-        // Add playlists to this category
         auto playlists = PLAYLIST_MANAGER->iteratePlaylistsInCategory(categoryInfo.uuid, 
             [](const playlist::PlaylistInfo&) { return true; });
         for (const auto& playlistInfo : playlists) {
-            MenuPlaylistInfo menuPlaylist;
-            menuPlaylist.id = playlistInfo.uuid.toString(QUuid::WithoutBraces);
-            menuPlaylist.name = playlistInfo.name;
-            menuPlaylist.description = playlistInfo.description;
-            // Get song count from the separate songs storage
-            auto songs = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistInfo.uuid,
-                [](const playlist::SongInfo&) { return true; });
-            menuPlaylist.songCount = songs.size();
-            
-            QTreeWidgetItem* playlistItem = createPlaylistItem(menuPlaylist, playlistInfo.uuid);
-            categoryItem->addChild(playlistItem);
-            playlistCount++;
-            // LOG_DEBUG("Added playlist '{}'({}) to category '{}'", 
-            //           menuPlaylist.name.toStdString(), menuPlaylist.id.toStdString(), categoryInfo.name.toStdString());
+            syncPlaylistItem(playlistInfo, categoryInfo.uuid);
+            playlistIds.insert(playlistInfo.uuid);
             // Expand if it contains the current playlist
             if (currentPlaylistId == playlistInfo.uuid) {
                 categoryItem->setExpanded(true);
             }
         }
-        categoryCount++;
     }
+    for (const QUuid& playlistId : m_playlistItems.keys()) {
+        if (!playlistIds.contains(playlistId)) {
+            removeTreeItem(m_playlistItems.value(playlistId));
+        }
+    }
+    for (const QUuid& categoryId : m_categoryItems.keys()) {
+        if (!categoryIds.contains(categoryId)) {
+            removeTreeItem(m_categoryItems.value(categoryId));
+        }
+    }
+    ui->menuTree->setUpdatesEnabled(true);
     
     // Update button position since text might have changed
     updateAddCategoryButtonPosition();
 
-    LOG_INFO("Updated menu with {} categories and {} playlists", categoryCount, playlistCount);
+    LOG_INFO("Updated menu with {} categories and {} playlists", categoryIds.size(), playlistIds.size());
 }
 
 void MenuWidget::showContextMenu(const QPoint& position)
@@ -505,17 +601,9 @@ void MenuWidget::addPlaylistToCategory(QTreeWidgetItem* categoryItem, const Menu
         .coverUri = "",
         .uuid = QUuid::createUuid()
     };
+    // The item follows from playlistAdded
     if (!PLAYLIST_MANAGER->addPlaylist(playlistInfo, categoryUuid)) {
         LOG_WARN("Failed to add playlist to manager: {}", playlist.name.toStdString());
-        return;
-    }
-    // Create playlist item and add to category
-    QTreeWidgetItem* playlistItem = createPlaylistItem(playlist, playlistInfo.uuid);
-    categoryItem->addChild(playlistItem);
-
-    // Update button position if this is the playlists category (text changed)
-    if (categoryItem == m_playlistCategory) {
-        updateAddCategoryButtonPosition();
     }
 }
 
@@ -600,18 +688,12 @@ void MenuWidget::createNewCategoryWithName(const QString& name)
         .name = name,
         .uuid = QUuid::createUuid()
     };
+    // The item follows from categoryAdded
     if (!PLAYLIST_MANAGER->addCategory(categoryInfo)) {
         LOG_ERROR("Failed to add category to manager: {}", name.toStdString());
         return;
     }
     
-    QString categoryId = QString("category_%1").arg(categoryInfo.uuid.toString(QUuid::WithoutBraces));
-    QTreeWidgetItem* categoryItem = createCategoryItem(name, categoryId, categoryInfo.uuid);
-    categoryItem->setIcon(0, QIcon(":/icons/folder.png"));
-    
-    // Add as a child of the Playlists category
-    m_playlistCategory->addChild(categoryItem);
-    
     // Emit signal for external handling
     emit categoryCreated(categoryInfo.uuid.toString(QUuid::WithoutBraces), name);
 
@@ -696,35 +778,46 @@ void MenuWidget::onCategoryAdded(const playlist::CategoryInfo& category)
         return;
     }
     
-    QString categoryId = QString("category_%1").arg(category.uuid.toString(QUuid::WithoutBraces));
-    
-    // Create category tree widget item
-    QTreeWidgetItem* categoryItem = createCategoryItem(category.name, categoryId, category.uuid);
-    categoryItem->setIcon(0, QIcon(":/icons/folder.png"));
-    
-    // Add as a child of the Playlists category
-    m_playlistCategory->addChild(categoryItem);
+    syncCategoryItem(category);
     
     // Add any existing playlists to this category
     auto playlists = PLAYLIST_MANAGER->iteratePlaylistsInCategory(category.uuid, 
         [](const playlist::PlaylistInfo&) { return true; });
     for (const auto& playlistInfo : playlists) {
-        MenuPlaylistInfo menuPlaylist;
-        menuPlaylist.id = playlistInfo.uuid.toString(QUuid::WithoutBraces);
-        menuPlaylist.name = playlistInfo.name;
-        menuPlaylist.description = playlistInfo.description;
-        // Get song count from the separate songs storage
-        auto songs = PLAYLIST_MANAGER->iterateSongsInPlaylist(playlistInfo.uuid,
-            [](const playlist::SongInfo&) { return true; });
-        menuPlaylist.songCount = songs.size();
-        
-        QTreeWidgetItem* playlistItem = createPlaylistItem(menuPlaylist, playlistInfo.uuid);
-        categoryItem->addChild(playlistItem);
+        syncPlaylistItem(playlistInfo, category.uuid);
     }
     
     LOG_DEBUG("Added category to menu: {} (invoked on thread {})", category.name.toStdString(), (void*)QThread::currentThread());
 }
 
+void MenuWidget::onCategoryRemoved(const QUuid& categoryId)
+{
+    removeTreeItem(m_categoryItems.value(categoryId));
+}
+
+void MenuWidget::onCategoryUpdated(const playlist::CategoryInfo& category)
+{
+    if (m_categoryItems.contains(category.uuid)) {
+        syncCategoryItem(category);
+    }
+}
+
+void MenuWidget::onPlaylistAdded(const playlist::PlaylistInfo& playlist, const QUuid& categoryId)
+{
+    syncPlaylistItem(playlist, categoryId);
+}
+
+void MenuWidget::onPlaylistRemoved(const QUuid& playlistId, const QUuid& categoryId)
+{
+    Q_UNUSED(categoryId)
+    removeTreeItem(m_playlistItems.value(playlistId));
+}
+
+void MenuWidget::onPlaylistUpdated(const playlist::PlaylistInfo& playlist, const QUuid& categoryId)
+{
+    syncPlaylistItem(playlist, categoryId);
+}
+
 void MenuWidget::deleteCategoryWithConfirmation(QTreeWidgetItem* categoryItem)
 {
     if (!categoryItem || !PLAYLIST_MANAGER) {
@@ -762,19 +855,8 @@ void MenuWidget::deleteCategoryWithConfirmation(QTreeWidgetItem* categoryItem)
     );
     
     if (reply == QMessageBox::Yes) {
-        // Delete from manager first
+        // The item goes with categoryRemoved
         if (PLAYLIST_MANAGER->removeCategory(categoryUuid)) {
-            // Remove from UI
-            if (categoryItem->parent()) {
-                categoryItem->parent()->removeChild(categoryItem);
-            } else {
-                int index = ui->menuTree->indexOfTopLevelItem(categoryItem);
-                if (index >= 0) {
-                    ui->menuTree->takeTopLevelItem(index);
-                }
-            }
-            delete categoryItem;
-            
             LOG_INFO("Deleted category: {} with {} playlists", categoryName.toStdString(), playlistCount);
         } else {
             QMessageBox::warning(this, "Delete Failed", 
@@ -821,14 +903,8 @@ void MenuWidget::deletePlaylistWithConfirmation(QTreeWidgetItem* playlistItem)
             categoryUuid = playlistItem->parent()->data(0, Qt::UserRole + 1).toUuid();
         }
         
-        // Delete from manager first
+        // The item goes with playlistRemoved
         if (PLAYLIST_MANAGER->removePlaylist(playlistUuid, categoryUuid)) {
-            // Remove from UI
-            if (playlistItem->parent()) {
-                playlistItem->parent()->removeChild(playlistItem);
-            }
-            delete playlistItem;
-            
             LOG_INFO("Deleted playlist: {}", playlistName.toStdString());
         } else {
             QMessageBox::warning(this, "Delete Failed", 
@@ -2,6 +2,7 @@
 
 #include <QWidget>
 #include <QMetaType>
+#include <QHash>
 #include <QIcon>
 #include <QUuid>
 #include <QString>
@@ -22,6 +23,7 @@ QT_END_NAMESPACE
 // Forward declarations
 namespace playlist {
     struct CategoryInfo;
+    struct PlaylistInfo;
 }
 
 struct MenuPlaylistInfo {
@@ -76,6 +78,11 @@ private slots:
     void onTreeLeaveEvent();
     void onCategoriesLoaded(int categoryCount, int playlistCount);
     void onCategoryAdded(const playlist::CategoryInfo& category);
+    void onCategoryRemoved(const QUuid& categoryId);
+    void onCategoryUpdated(const playlist::CategoryInfo& category);
+    void onPlaylistAdded(const playlist::PlaylistInfo& playlist, const QUuid& categoryId);
+    void onPlaylistRemoved(const QUuid& playlistId, const QUuid& categoryId);
+    void onPlaylistUpdated(const playlist::PlaylistInfo& playlist, const QUuid& categoryId);
     void onDeleteItem();
 
 private:
@@ -88,6 +95,15 @@ private:
     QTreeWidgetItem* createPlaylistItem(const MenuPlaylistInfo& playlist, const QUuid& uuid);
     QTreeWidgetItem* createActionItem(const QString& name, const QString& args = "", const QIcon& icon = QIcon());
     QTreeWidgetItem* findPlaylistItem(const QString& playlistId);
+    // The item of a manager category or playlist, created or brought up to date; a null
+    // categoryId leaves an existing playlist item in its category
+    QTreeWidgetItem* syncCategoryItem(const playlist::CategoryInfo& category);
+    QTreeWidgetItem* syncPlaylistItem(const playlist::PlaylistInfo& playlist, const QUuid& categoryId);
+    void setPlaylistItemText(QTreeWidgetItem* item, const QString& name, int songCount);
+    // Drop an item from the tree and the uuid maps, children included
+    void removeTreeItem(QTreeWidgetItem* item);
+    // Keep a playlist item's "(N songs)" in step with song changes
+    void adjustPlaylistSongCount(const QUuid& playlistId, int delta);
     QString generateUniquePlaylistId();
     void addPlaylistToCategory(QTreeWidgetItem* categoryItem, const MenuPlaylistInfo& playlist);
     void createNewCategoryWithName(const QString& name);
@@ -103,6 +119,12 @@ private:
     QPushButton* m_addCategoryButton;
     QPushButton* m_addPlaylistButton;
     QTreeWidgetItem* m_hoveredCategoryItem;
+    // Manager categories and playlists by uuid, so changes touch only their own items
+    QHash<QUuid, QTreeWidgetItem*> m_categoryItems;
+    QHash<QUuid, QTreeWidgetItem*> m_playlistItems;
+    // Shared by every item, loaded once
+    QIcon m_folderIcon;
+    QIcon m_playlistItemIcon;
 };
 
 Q_DECLARE_METATYPE(MenuWidget::MenuItem)
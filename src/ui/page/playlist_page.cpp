@@ -5,17 +5,22 @@
 #include <log/log_manager.h>
 #include <config/config_manager.h>
 #include <ui/util/elided_label.h>
+#include <ui/util/cover_thumbnailer.h>
+#include <ui/util/first_paint_tracer.h>
+#include "playlist_song_model.h"
 #include <QHeaderView>
-#include <QPixmap>
+#include <QItemSelectionModel>
+#include <QSortFilterProxyModel>
+#include <QTreeView>
 #include <QUrl>
 #include <QUrlQuery>
-#include <QTime>
 #include <QMenu>
 #include <QAction>
 #include <QEvent>
 #include <QTimer>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QSet>
 #include <QDir>
 #include <QPropertyAnimation>
 #include <manager/application_context.h>
@@ -27,6 +32,8 @@ PlaylistPage::PlaylistPage(QWidget *parent)
     , INavigablePage(PLAYLIST_PAGE_TYPE)
     , ui(new Ui_PlaylistPageForm)
     , m_playlistManager(nullptr)
+    , m_songModel(nullptr)
+    , m_songProxy(nullptr)
 {
     ui->setupUi(this);
     
@@ -36,14 +43,19 @@ PlaylistPage::PlaylistPage(QWidget *parent)
     ui->songListView->setContextMenuPolicy(Qt::CustomContextMenu);
     
     // Connect signals
-    connect(ui->songListView, &QTreeWidget::itemDoubleClicked, 
+    connect(ui->songListView, &QTreeView::doubleClicked,
             this, &PlaylistPage::onSongDoubleClicked);
-    connect(ui->songListView, &QTreeWidget::itemSelectionChanged,
+    connect(ui->songListView->selectionModel(), &QItemSelectionModel::selectionChanged,
             this, &PlaylistPage::onSelectionChanged);
-    connect(ui->songListView, &QTreeWidget::customContextMenuRequested,
+    connect(ui->songListView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+            this, &PlaylistPage::updateCurrentTitleLabel);
+    connect(ui->songListView, &QTreeView::customContextMenuRequested,
             this, &PlaylistPage::showContextMenu);
 
     SetupPlaylistManager();
+    // Startup tracing: the first time songs are on screen
+    FirstPaintTracer::install(ui->songListView, "first playlist render",
+                              [this]() { return m_songModel->rowCount() > 0; });
 }
 
 PlaylistPage::~PlaylistPage()
@@ -53,11 +65,20 @@ PlaylistPage::~PlaylistPage()
 
 void PlaylistPage::setupUI()
 {
-    // Configure the tree widget
-    ui->songListView->setHeaderLabels({"Title", "Uploader/Artist", "Platform", "Duration"});
+    // Songs come from a model holding the playlist snapshot; the proxy sorts on header clicks
+    // and filters as the filter text changes, both by the model's precomputed keys
+    m_songModel = new PlaylistSongModel(this);
+    m_songProxy = new PlaylistSongProxy(this);
+    m_songProxy->setSourceModel(m_songModel);
+    m_songProxy->setSortRole(PlaylistSongModel::SortRole);
+    ui->songListView->setModel(m_songProxy);
+    connect(ui->songFilterEdit, &QLineEdit::textChanged, m_songProxy, &PlaylistSongProxy::setFilterText);
     
     // Configure header for interactive resizing
     QHeaderView* header = ui->songListView->header();
+    // Playlist order until a column is clicked
+    header->setSortIndicator(-1, Qt::AscendingOrder);
+    m_songProxy->sort(-1);
     header->setStretchLastSection(false);
     header->setSectionsMovable(false);  // Prevent column reordering
     header->setSectionResizeMode(QHeaderView::Interactive);  // Enable manual resizing
@@ -81,6 +102,10 @@ void PlaylistPage::setupUI()
         connect(ui->addLocalFilesButton, &QPushButton::clicked,
                 this, &PlaylistPage::onAddLocalFilesClicked);
     }
+    if (ui->addLocalFolderButton) {
+        connect(ui->addLocalFolderButton, &QPushButton::clicked,
+                this, &PlaylistPage::onAddLocalFolderClicked);
+    }
 }
 
 void PlaylistPage::SetupPlaylistManager()
@@ -97,32 +122,83 @@ void PlaylistPage::SetupPlaylistManager()
                         refreshPlaylist();
                     }
                 });
+        // Folder imports report from their own thread; queued to this one
+        connect(m_playlistManager, &PlaylistManager::localImportProgress,
+                this, [this](const QUuid& playlistId, int probed, int found) {
+                    Q_UNUSED(playlistId)
+                    ui->addLocalFolderButton->setText(tr("Cancel Import (%1/%2)").arg(probed).arg(found));
+                });
+        connect(m_playlistManager, &PlaylistManager::localImportFinished,
+                this, [this](const QUuid& playlistId, int added, bool cancelled) {
+                    ui->addLocalFolderButton->setText(tr("Add Local Folder"));
+                    if (added > 0) {
+                        emit playlistModified();
+                    }
+                    LOG_INFO("Local folder import {}: {} songs added to {}",
+                             cancelled ? "cancelled" : "finished", added, playlistId.toString().toStdString());
+                });
         
         // Connect to song-related signals
         connect(m_playlistManager, &PlaylistManager::playlistSongsChanged,
                 this, [this](const QUuid& playlistId) {
+                    // The rows themselves follow the song signals below
                     if (playlistId == m_currentPlaylistId) {
-                        LOG_DEBUG("Songs changed in current playlist, refreshing UI");
-                        refreshPlaylist();
+                        ui->songCountLabel->setText(QString(tr("%1 songs")).arg(m_songModel->rowCount()));
                     }
                 });
                 
         connect(m_playlistManager, &PlaylistManager::songAdded,
                 this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
-                    Q_UNUSED(song)
                     if (playlistId == m_currentPlaylistId) {
-                        LOG_DEBUG("Song added to current playlist, refreshing UI");
-                        refreshPlaylist();
+                        LOG_DEBUG("Song added to current playlist");
+                        m_songModel->insertSongs(m_songModel->rowCount(), { song });
                     }
                 });
                 
         connect(m_playlistManager, &PlaylistManager::songRemoved,
                 this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
-                    Q_UNUSED(song)
                     if (playlistId == m_currentPlaylistId) {
-                        LOG_DEBUG("Song removed from current playlist, refreshing UI");
+                        LOG_DEBUG("Song removed from current playlist");
+                        m_songModel->removeSongs({ song.uuid });
+                    }
+                });
+        
+        connect(m_playlistManager, &PlaylistManager::songUpdated,
+                this, [this](const playlist::SongInfo& song, const QUuid& playlistId) {
+                    if (playlistId == m_currentPlaylistId) {
+                        m_songModel->updateSong(song);
+                        updateCurrentTitleLabel();
+                    }
+                });
+        
+        // Batches change the list in place instead of rebuilding it
+        connect(m_playlistManager, &PlaylistManager::songsAdded,
+                this, [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId, int first) {
+                    if (playlistId != m_currentPlaylistId) {
+                        return;
+                    }
+                    if (first != m_songModel->rowCount()) {
+                        // The list is out of step with the playlist
                         refreshPlaylist();
+                        return;
                     }
+                    m_songModel->insertSongs(first, songs);
+                    ui->songCountLabel->setText(QString(tr("%1 songs")).arg(m_songModel->rowCount()));
+                    LOG_DEBUG("Appended {} songs to the current playlist", songs.size());
+                });
+        
+        connect(m_playlistManager, &PlaylistManager::songsRemoved,
+                this, [this](const QList<playlist::SongInfo>& songs, const QUuid& playlistId) {
+                    if (playlistId != m_currentPlaylistId) {
+                        return;
+                    }
+                    QSet<QUuid> songIds;
+                    for (const auto& song : songs) {
+                        songIds.insert(song.uuid);
+                    }
+                    m_songModel->removeSongs(songIds);
+                    ui->songCountLabel->setText(QString(tr("%1 songs")).arg(m_songModel->rowCount()));
+                    LOG_DEBUG("Removed {} songs from the current playlist", songs.size());
                 });
     }
 }
@@ -130,6 +206,9 @@ void PlaylistPage::SetupPlaylistManager()
 void PlaylistPage::setCurrentPlaylist(const QUuid& playlistId)
 {
     LOG_DEBUG("Setting current playlist to: {}", playlistId.toString().toStdString());
+    if (playlistId != m_currentPlaylistId) {
+        ui->songFilterEdit->clear();
+    }
     m_currentPlaylistId = playlistId;
     refreshPlaylist();
 }
@@ -145,8 +224,8 @@ void PlaylistPage::refreshPlaylist()
         ui->creatorLabel->setText("");
         ui->songCountLabel->setText(tr("0 songs"));
         ui->descriptionLabel->setText("");
-        ui->coverLabel->setText(tr("No Cover"));
-        ui->songListView->clear();
+        CoverThumbnailer::clearCover(ui->coverLabel, tr("No Cover"));
+        m_songModel->clear();
         return;
     }
     
@@ -157,8 +236,8 @@ void PlaylistPage::refreshPlaylist()
         ui->creatorLabel->setText("");
         ui->songCountLabel->setText(tr("0 songs"));
         ui->descriptionLabel->setText("");
-        ui->coverLabel->setText(tr("No Cover"));
-        ui->songListView->clear();
+        CoverThumbnailer::clearCover(ui->coverLabel, tr("No Cover"));
+        m_songModel->clear();
         return;
     }
     
@@ -190,14 +269,14 @@ void PlaylistPage::removeSong(int index)
         return;
     }
     
-    // Get the song at the specified index
-    QTreeWidgetItem* item = ui->songListView->topLevelItem(index);
-    if (!item) {
+    // Get the song at the specified row, as the view shows it
+    const QModelIndex proxyIndex = m_songProxy->index(index, 0);
+    if (!proxyIndex.isValid()) {
         LOG_ERROR("Invalid song index: {}", index);
         return;
     }
     
-    playlist::SongInfo song = item->data(0, Qt::UserRole).value<playlist::SongInfo>();
+    playlist::SongInfo song = m_songModel->songAt(m_songProxy->mapToSource(proxyIndex).row());
     
     if (m_playlistManager->removeSongFromPlaylist(song, m_currentPlaylistId)) {
         // The playlist will be refreshed via signal connection
@@ -215,13 +294,10 @@ void PlaylistPage::clearSongs()
         return;
     }
     
-    // Get all songs and remove them one by one
-    auto songs = m_playlistManager->iterateSongsInPlaylist(m_currentPlaylistId, 
-                                                          [](const playlist::SongInfo&) { return true; });
+    // Get all songs and remove them in one batch
+    auto songs = m_playlistManager->songsSnapshot(m_currentPlaylistId);
     
-    for (const auto& song : songs) {
-        m_playlistManager->removeSongFromPlaylist(song, m_currentPlaylistId);
-    }
+    m_playlistManager->removeSongsFromPlaylist(songs, m_currentPlaylistId);
     
     emit playlistModified();
     LOG_DEBUG("Cleared all songs from playlist");
@@ -241,8 +317,7 @@ void PlaylistPage::updatePlaylistInfo()
     }
     
     // Get songs for this playlist
-    auto songs = m_playlistManager->iterateSongsInPlaylist(m_currentPlaylistId, 
-                                                          [](const playlist::SongInfo&) { return true; });
+    auto songs = m_playlistManager->songsSnapshot(m_currentPlaylistId);
     
     // Update playlist name and info
     ui->playlistNameLabel->setText(playlistInfo->name);
@@ -250,113 +325,89 @@ void PlaylistPage::updatePlaylistInfo()
     ui->songCountLabel->setText(QString(tr("%1 songs")).arg(songs.size()));
     ui->descriptionLabel->setText(playlistInfo->description);
     
-    // Set cover image (placeholder for now)
+    // Set cover image, decoded off the GUI thread
     if (!playlistInfo->coverUri.isEmpty()) {
-        // In a real implementation, you would load the image asynchronously
         if (QFile::exists(playlistInfo->coverUri)) {
-            QPixmap pix(playlistInfo->coverUri);
             LOG_DEBUG("Loading cover image from local path: {}", playlistInfo->coverUri.toStdString());
-            if (!pix.isNull()) 
-                ui->coverLabel->setPixmap(pix.scaled(150,150, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+            CoverThumbnailer::instance().setCover(ui->coverLabel, playlistInfo->coverUri, QSize(COVER_SIZE, COVER_SIZE));
         } else {
-            ui->coverLabel->setText(tr("Loading..."));
+            CoverThumbnailer::clearCover(ui->coverLabel, tr("Loading..."));
             m_currentCoverPath = playlistInfo->coverUri;
             LOG_DEBUG("Requesting cover image download from {}", playlistInfo->coverUri.toStdString());
         }
     } else {
-        ui->coverLabel->setText(tr("No Cover"));
+        CoverThumbnailer::clearCover(ui->coverLabel, tr("No Cover"));
     }
 }
 
 void PlaylistPage::updateSongList()
 {
-    ui->songListView->clear();
-    
     if (!m_playlistManager || m_currentPlaylistId.isNull()) {
         LOG_DEBUG("Cannot update song list: missing manager or playlist ID");
+        m_songModel->clear();
         return;
     }
     
-    // Get songs from playlist manager
-    auto songs = m_playlistManager->iterateSongsInPlaylist(m_currentPlaylistId, 
-                                                          [](const playlist::SongInfo&) { return true; });
+    // The model keeps the snapshot itself; rows are formatted only when shown
+    auto songs = m_playlistManager->songsSnapshot(m_currentPlaylistId);
+    m_songModel->setSongs(songs);
+    updateCurrentTitleLabel();
     
-    LOG_DEBUG("Retrieved {} songs for playlist {}", songs.size(), m_currentPlaylistId.toString().toStdString());
-    
-    for (const auto& song : songs) {
-        LOG_DEBUG("Adding song to UI: {}", song.title.toStdString());
-        QTreeWidgetItem* item = createSongItem(song);
-        ui->songListView->addTopLevelItem(item);
-        // Create your custom QLabel
-        ScrollingLabel* titleLabel = new ScrollingLabel(this);
-        titleLabel->setText(song.title);
-
-        // Replace column 0's text with this label
-        ui->songListView->setItemWidget(item, 0, titleLabel);
-    }
-    
-    LOG_DEBUG("Song list updated, total items in UI: {}", ui->songListView->topLevelItemCount());
+    LOG_DEBUG("Song list updated, {} songs for playlist {}", songs.size(), m_currentPlaylistId.toString().toStdString());
 }
 
-QTreeWidgetItem* PlaylistPage::createSongItem(const playlist::SongInfo& song)
+void PlaylistPage::updateCurrentTitleLabel()
 {
-    QTreeWidgetItem* item = new QTreeWidgetItem();
-    // item->setText(0, song.title);
-    item->setText(1, song.uploader);
-    
-    // Convert platform enum to string using i18n-enabled function
-    QString platformStr = network::getPlatformName(static_cast<network::PlatformType>(song.platform));
-    item->setText(2, platformStr);
-    item->setText(3, formatDuration(song.duration/1000)); // Convert ms to seconds
-    
-    // Store song data for retrieval
-    item->setData(0, Qt::UserRole, QVariant::fromValue(song));
-
-    return item;
+    // A scrolling title for the current row only; the rest are painted from the model,
+    // which leaves the current row's title cell blank so the label doesn't show over it
+    const QModelIndex current = ui->songListView->currentIndex();
+    const QModelIndex titleIndex = current.isValid() ? current.siblingAtColumn(PlaylistSongModel::TitleColumn) : QModelIndex();
+    if (m_titleIndex.isValid() && m_titleIndex != titleIndex) {
+        ui->songListView->setIndexWidget(m_titleIndex, nullptr);
+    }
+    m_titleIndex = titleIndex;
+    if (!titleIndex.isValid()) {
+        m_songModel->setCoveredTitle(QUuid());
+        return;
+    }
+    const playlist::SongInfo& song = m_songModel->songAt(m_songProxy->mapToSource(titleIndex).row());
+    m_songModel->setCoveredTitle(song.uuid);
+    auto* titleLabel = qobject_cast<ScrollingLabel*>(ui->songListView->indexWidget(titleIndex));
+    if (!titleLabel) {
+        titleLabel = new ScrollingLabel();
+        ui->songListView->setIndexWidget(titleIndex, titleLabel);
+    }
+    titleLabel->setText(song.title);
 }
 
-QString PlaylistPage::formatDuration(int seconds) const
+QList<playlist::SongInfo> PlaylistPage::selectedSongs() const
 {
-    if (seconds < 3600) {
-        // Less than an hour: MM:SS
-        return QTime(0, 0, 0).addSecs(seconds).toString("mm:ss");
-    } else {
-        // Hour or more: HH:MM:SS
-        return QTime(0, 0, 0).addSecs(seconds).toString("hh:mm:ss");
+    QList<playlist::SongInfo> songs;
+    const QModelIndexList rows = ui->songListView->selectionModel()->selectedRows();
+    for (const QModelIndex& row : rows) {
+        songs.append(m_songModel->songAt(m_songProxy->mapToSource(row).row()));
     }
+    return songs;
 }
 
-void PlaylistPage::onSongDoubleClicked(QTreeWidgetItem* item, int column)
+void PlaylistPage::onSongDoubleClicked(const QModelIndex& index)
 {
-    Q_UNUSED(column)
-    
-    if (item) {
-        playlist::SongInfo song = item->data(0, Qt::UserRole).value<playlist::SongInfo>();
-        emit songDoubleClicked(song);
+    if (index.isValid()) {
+        emit songDoubleClicked(m_songModel->songAt(m_songProxy->mapToSource(index).row()));
     }
 }
 
 void PlaylistPage::onSelectionChanged()
 {
-    QList<QTreeWidgetItem*> selectedItems = ui->songListView->selectedItems();
-    QList<playlist::SongInfo> selectedSongs;
-    
-    for (QTreeWidgetItem* item : selectedItems) {
-        playlist::SongInfo song = item->data(0, Qt::UserRole).value<playlist::SongInfo>();
-        selectedSongs.append(song);
-    }
-    
-    emit songsSelected(selectedSongs);
+    emit songsSelected(selectedSongs());
 }
 
 void PlaylistPage::onNetworkDownload(QString url, QString savePath)
 {
     if (savePath == m_currentCoverPath) {
         if (ui->coverLabel) {
-            QPixmap pix(savePath);
             LOG_DEBUG("Cover image downloaded, updating UI from {}", savePath.toStdString());
-            if (!pix.isNull()) 
-                ui->coverLabel->setPixmap(pix.scaled(150,150, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+            CoverThumbnailer::instance().setCover(ui->coverLabel, savePath, QSize(COVER_SIZE, COVER_SIZE));
         }
     }
 }
@@ -384,8 +435,7 @@ void PlaylistPage::restoreFromState(const QString& state)
 
 void PlaylistPage::showContextMenu(const QPoint& pos)
 {
-    QTreeWidgetItem* item = ui->songListView->itemAt(pos);
-    if (!item) {
+    if (!ui->songListView->indexAt(pos).isValid()) {
         return; // No item at this position
     }
     
@@ -399,8 +449,9 @@ void PlaylistPage::showContextMenu(const QPoint& pos)
 
 void PlaylistPage::deleteSong()
 {
-    QList<QTreeWidgetItem*> selectedItems = ui->songListView->selectedItems();
-    if (selectedItems.isEmpty()) {
+    // Delete all selected songs in one batch
+    const QList<playlist::SongInfo> songs = selectedSongs();
+    if (songs.isEmpty()) {
         LOG_WARN("No song selected for deletion");
         return;
     }
@@ -410,15 +461,11 @@ void PlaylistPage::deleteSong()
         return;
     }
     
-    // Delete all selected songs
-    for (QTreeWidgetItem* item : selectedItems) {
-        playlist::SongInfo song = item->data(0, Qt::UserRole).value<playlist::SongInfo>();
-        
-        if (m_playlistManager->removeSongFromPlaylist(song, m_currentPlaylistId)) {
-            LOG_DEBUG("Deleted song '{}' from playlist", song.title.toStdString());
-        } else {
-            LOG_ERROR("Failed to delete song '{}' from playlist", song.title.toStdString());
-        }
+    const int removed = m_playlistManager->removeSongsFromPlaylist(songs, m_currentPlaylistId);
+    if (removed == songs.size()) {
+        LOG_DEBUG("Deleted {} songs from playlist", removed);
+    } else {
+        LOG_ERROR("Deleted {} of {} selected songs from playlist", removed, songs.size());
     }
 }
 
@@ -494,6 +541,7 @@ void PlaylistPage::onAddLocalFilesClicked()
                                                      tr("Audio Files (*.mp3 *.wav *.flac);;All Files (*)"));
     if (paths.isEmpty()) return;
 
+    QList<playlist::SongInfo> songs;
     for (const QString& path : paths) {
         playlist::SongInfo song;
         song.title = QFileInfo(path).baseName();
@@ -503,6 +551,34 @@ void PlaylistPage::onAddLocalFilesClicked()
         song.filepath = path; // PlaylistManager will convert to file:// if necessary
         song.coverName = QString();
         song.args = QString();
-        addSong(song);
+        song.uuid = QUuid::createUuid();
+        songs.append(song);
+    }
+    
+    // One batch, one update of the list
+    const int added = m_playlistManager->addSongsToPlaylist(songs, m_currentPlaylistId);
+    if (added > 0) {
+        emit playlistModified();
+    }
+    LOG_DEBUG("Added {} of {} local files to playlist", added, songs.size());
+}
+
+void PlaylistPage::onAddLocalFolderClicked()
+{
+    if (!m_playlistManager || m_currentPlaylistId.isNull()) {
+        LOG_WARN("Cannot add local folder: no playlist manager or current playlist");
+        return;
+    }
+    // The same button cancels an import under way
+    if (m_playlistManager->isImportingLocalFolder()) {
+        m_playlistManager->cancelLocalImport();
+        return;
     }
-}
\ No newline at end of file
+
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Select Music Folder"), QDir::homePath());
+    if (directory.isEmpty()) return;
+
+    if (m_playlistManager->importLocalFolder(directory, m_currentPlaylistId)) {
+        ui->addLocalFolderButton->setText(tr("Cancel Import"));
+    }
+}
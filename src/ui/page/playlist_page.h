@@ -4,6 +4,7 @@
 #include <QString>
 #include <QMetaType>
 #include <QUuid>
+#include <QPersistentModelIndex>
 #include "../navigator/i_navigable_page.h"
 #include "../../playlist/playlist.h"
 
@@ -13,9 +14,8 @@ class Ui_PlaylistPageForm;
 QT_END_NAMESPACE
 
 // Forward-declare Qt classes used only as pointers in this header to reduce compile-time dependencies
-class QTreeWidget;
-class QTreeWidgetItem;
-class ScrollingLabel;
+class PlaylistSongModel;
+class PlaylistSongProxy;
 
 class PlaylistManager;
 
@@ -25,6 +25,7 @@ class PlaylistPage : public QWidget, public INavigablePage
 
 public:
     static const QString PLAYLIST_PAGE_TYPE;
+    static constexpr int COVER_SIZE = 150;
     
     explicit PlaylistPage(QWidget *parent = nullptr);
     ~PlaylistPage();
@@ -54,23 +55,27 @@ signals:
     void playlistModified();
 
 private slots:
-    void onSongDoubleClicked(QTreeWidgetItem* item, int column);
+    void onSongDoubleClicked(const QModelIndex& index);
     void onSelectionChanged();
     void onNetworkDownload(QString url, QString savePath);
     void showContextMenu(const QPoint& pos);
     void deleteSong();
     void onAddLocalFilesClicked();
+    void onAddLocalFolderClicked();
 
 private:
     void setupUI();
     void SetupPlaylistManager();
     void updatePlaylistInfo();
     void updateSongList();
-    QString formatDuration(int seconds) const;
-    QTreeWidgetItem* createSongItem(const playlist::SongInfo& song);
+    void updateCurrentTitleLabel();
+    QList<playlist::SongInfo> selectedSongs() const;
     
     Ui_PlaylistPageForm *ui;
     PlaylistManager* m_playlistManager;
+    PlaylistSongModel* m_songModel;
+    PlaylistSongProxy* m_songProxy;
+    QPersistentModelIndex m_titleIndex;     // Row showing a ScrollingLabel title
     QUuid m_currentPlaylistId;
     QString m_currentCoverPath;
 };
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "playlist_song_model.h"
+#include <network/platform/i_platform.h>
+#include <QTime>
+#include <algorithm>
+#include <climits>
+
+PlaylistSongModel::PlaylistSongModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int PlaylistSongModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_songs.size());
+}
+
+int PlaylistSongModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant PlaylistSongModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_songs.size()) {
+        return QVariant();
+    }
+    const playlist::SongInfo& song = m_songs.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case TitleColumn:
+            return song.uuid == m_coveredTitle ? QString() : song.title;
+        case UploaderColumn:
+            return song.uploader;
+        case PlatformColumn:
+            // Convert platform enum to string using i18n-enabled function
+            return network::getPlatformName(static_cast<network::PlatformType>(song.platform));
+        case DurationColumn:
+            return formatDuration(song.duration);
+        }
+        break;
+    case Qt::ToolTipRole:
+        if (index.column() == TitleColumn) {
+            return song.title;
+        }
+        break;
+    case SortRole:
+        if (index.column() == DurationColumn) {
+            return song.duration;
+        }
+        return data(index, Qt::DisplayRole);
+    case Qt::UserRole:
+        return QVariant::fromValue(song);
+    }
+    return QVariant();
+}
+
+QVariant PlaylistSongModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case TitleColumn:
+        return tr("Title");
+    case UploaderColumn:
+        return tr("Uploader/Artist");
+    case PlatformColumn:
+        return tr("Platform");
+    case DurationColumn:
+        return tr("Duration");
+    }
+    return QVariant();
+}
+
+void PlaylistSongModel::setSongs(const QList<playlist::SongInfo>& songs)
+{
+    std::vector<playlist::SongSortKeys> keys;
+    keys.reserve(songs.size());
+    for (const auto& song : songs) {
+        keys.push_back(m_collation.keys(song));
+    }
+    beginResetModel();
+    m_songs = songs;
+    m_keys = std::move(keys);
+    endResetModel();
+}
+
+void PlaylistSongModel::insertSongs(int first, const QList<playlist::SongInfo>& songs)
+{
+    if (songs.isEmpty()) {
+        return;
+    }
+    first = qBound(0, first, static_cast<int>(m_songs.size()));
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(songs.size()) - 1);
+    m_songs.insert(first, songs.size(), playlist::SongInfo());
+    std::copy(songs.cbegin(), songs.cend(), m_songs.begin() + first);
+    std::vector<playlist::SongSortKeys> keys;
+    keys.reserve(songs.size());
+    for (const auto& song : songs) {
+        keys.push_back(m_collation.keys(song));
+    }
+    m_keys.insert(m_keys.begin() + first, std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+    endInsertRows();
+}
+
+void PlaylistSongModel::removeSongs(const QSet<QUuid>& songIds)
+{
+    // From the back, a run of adjacent rows at a time
+    int row = static_cast<int>(m_songs.size()) - 1;
+    while (row >= 0) {
+        if (!songIds.contains(m_songs.at(row).uuid)) {
+            --row;
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && songIds.contains(m_songs.at(row - 1).uuid)) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_songs.remove(row, last - row + 1);
+        m_keys.erase(m_keys.begin() + row, m_keys.begin() + last + 1);
+        endRemoveRows();
+        --row;
+    }
+}
+
+void PlaylistSongModel::updateSong(const playlist::SongInfo& song)
+{
+    for (int row = 0; row < m_songs.size(); ++row) {
+        if (m_songs.at(row).uuid == song.uuid) {
+            m_songs[row] = song;
+            m_keys[row] = m_collation.keys(song);
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+            return;
+        }
+    }
+}
+
+void PlaylistSongModel::setCoveredTitle(const QUuid& songId)
+{
+    if (songId == m_coveredTitle) {
+        return;
+    }
+    const QUuid previous = m_coveredTitle;
+    m_coveredTitle = songId;
+    for (int row = 0; row < m_songs.size(); ++row) {
+        const QUuid& uuid = m_songs.at(row).uuid;
+        if ((!previous.isNull() && uuid == previous) || (!songId.isNull() && uuid == songId)) {
+            emit dataChanged(index(row, TitleColumn), index(row, TitleColumn), { Qt::DisplayRole });
+        }
+    }
+}
+
+int PlaylistSongModel::compareRows(int left, int right, int column) const
+{
+    const playlist::SongInfo& a = m_songs.at(left);
+    const playlist::SongInfo& b = m_songs.at(right);
+    switch (column) {
+    case TitleColumn:
+        return m_keys[left].title.compare(m_keys[right].title);
+    case UploaderColumn:
+        return m_keys[left].uploader.compare(m_keys[right].uploader);
+    case PlatformColumn:
+        return a.platform - b.platform;
+    case DurationColumn:
+        return (a.duration > b.duration) - (a.duration < b.duration);
+    }
+    return 0;
+}
+
+bool PlaylistSongModel::rowMatches(int row, const QStringList& words) const
+{
+    return playlist::SongCollation::matches(m_keys[row], words);
+}
+
+QString PlaylistSongModel::formatDuration(int seconds)
+{
+    if (seconds <= 0 || seconds == INT_MAX) {
+        return QString();
+    }
+    if (seconds < 3600) {
+        // Less than an hour: MM:SS
+        return QTime(0, 0, 0).addSecs(seconds).toString("mm:ss");
+    }
+    // Hour or more: HH:MM:SS
+    return QTime(0, 0, 0).addSecs(seconds).toString("hh:mm:ss");
+}
+
+// ==================== PlaylistSongProxy ====================
+
+PlaylistSongProxy::PlaylistSongProxy(QObject* parent)
+    : QSortFilterProxyModel(parent)
+{
+}
+
+void PlaylistSongProxy::setSourceModel(QAbstractItemModel* model)
+{
+    m_songs = qobject_cast<PlaylistSongModel*>(model);
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+void PlaylistSongProxy::setFilterText(const QString& text)
+{
+    QStringList words = playlist::SongCollation::queryWords(text);
+    if (words == m_filterWords) {
+        return;
+    }
+    m_filterWords = std::move(words);
+    invalidateFilter();
+}
+
+bool PlaylistSongProxy::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    if (!m_songs) {
+        return QSortFilterProxyModel::lessThan(left, right);
+    }
+    return m_songs->compareRows(left.row(), right.row(), left.column()) < 0;
+}
+
+bool PlaylistSongProxy::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (!m_songs || m_filterWords.isEmpty()) {
+        return true;
+    }
+    return !sourceParent.isValid() && m_songs->rowMatches(sourceRow, m_filterWords);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QStringList>
+#include <QUuid>
+#include <vector>
+#include "../../playlist/playlist.h"
+#include "../../playlist/song_collation.h"
+
+/**
+ * @brief The songs of one playlist as a table for PlaylistPage's song view.
+ *
+ * Holds the playlist's song snapshot (a shared copy, not per-row items) and formats
+ * cells only as the view asks for them, which with uniform row heights is the visible
+ * rows alone. Changes come in as row inserts, removals and updates, so the view keeps
+ * its scroll position and selection.
+ *
+ * Next to the snapshot it keeps each song's collation and search keys, made when the song
+ * comes in or changes, so sorting and filtering compare precomputed keys.
+ */
+class PlaylistSongModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { TitleColumn, UploaderColumn, PlatformColumn, DurationColumn, ColumnCount };
+    // Raw value of a cell for sorting: durations as numbers
+    static constexpr int SortRole = Qt::UserRole + 1;
+
+    explicit PlaylistSongModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void setSongs(const QList<playlist::SongInfo>& songs);
+    void insertSongs(int first, const QList<playlist::SongInfo>& songs);
+    void removeSongs(const QSet<QUuid>& songIds);
+    void updateSong(const playlist::SongInfo& song);
+    void clear() { setSongs({}); }
+
+    const playlist::SongInfo& songAt(int row) const { return m_songs.at(row); }
+    // Leave songId's title cell blank, for a widget drawn over it; a null id shows every title
+    void setCoveredTitle(const QUuid& songId);
+
+    // Order of two rows by a column's value, negative if left comes first
+    int compareRows(int left, int right, int column) const;
+    // The row's title or uploader contains every word (see SongCollation::queryWords)
+    bool rowMatches(int row, const QStringList& words) const;
+
+private:
+    static QString formatDuration(int seconds);
+
+    QList<playlist::SongInfo> m_songs;
+    std::vector<playlist::SongSortKeys> m_keys;     // Parallel to m_songs
+    QUuid m_coveredTitle;
+    playlist::SongCollation m_collation;
+};
+
+/**
+ * @brief Sorts and filters a PlaylistSongModel by its precomputed keys.
+ */
+class PlaylistSongProxy : public QSortFilterProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit PlaylistSongProxy(QObject* parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel* model) override;
+    // Keep the songs whose title or uploader contains every word of text, or its pinyin
+    // initials for Chinese; empty shows all
+    void setFilterText(const QString& text);
+
+protected:
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    PlaylistSongModel* m_songs = nullptr;
+    QStringList m_filterWords;
+};
@@ -1,13 +1,16 @@
 #include "search_page.h"
 #include "ui_search_page.h"
+#include "search_result_model.h"
 #include <QUrlQuery>
 #include <QMenu>
 #include <QActionGroup>
 #include <QAction>
 #include <QKeyEvent>
-#include <QListWidgetItem>
+#include <QListView>
+#include <QScrollBar>
 #include <QPixmap>
 #include <QFile>
+#include <QFileInfo>
 #include <QTimer>
 #include <log/log_manager.h>
 #include <audio/audio_player_controller.h>
@@ -18,6 +21,45 @@
 #include <util/md5.h>
 #include <config/config_manager.h>
 
+namespace {
+    // Network covers go to the cover cache; the parts of a video share one download
+    QString coverPathOf(const network::SearchResult& result)
+    {
+        if (result.coverImg.isEmpty() && !result.coverUrl.isEmpty()) {
+            return NETWORK_MANAGER->coverCachePath(result.coverUrl);
+        }
+        return CONFIG_MANAGER->getCoverCacheDirectory() + "/" + result.coverImg;
+    }
+
+    playlist::SongInfo songFromResult(const network::SearchResult& result, const QString& coverPath)
+    {
+        return playlist::SongInfo{
+            .title = result.title,
+            .uploader = result.uploader,
+            .platform = static_cast<int>(result.platform),
+            .duration = result.duration,
+            .coverName = QFileInfo(coverPath).fileName(),
+            .args = result.interfaceData,
+            .uuid = QUuid::createUuid()
+        };
+    }
+
+    // Download the cover if it isn't cached yet, and give the playlist a cover if it has none
+    void useResultCover(const network::SearchResult& result, const QString& coverPath, const QUuid& playlistId)
+    {
+        if (!result.coverUrl.isEmpty() && !QFile::exists(coverPath)) {
+            LOG_INFO("Downloading cover image: {} -> {}", result.coverUrl.toStdString(), coverPath.toStdString());
+            NETWORK_MANAGER->fetchCoverAsync(result.coverUrl);
+        }
+        auto playlistOpt = PLAYLIST_MANAGER->getPlaylist(playlistId);
+        if (playlistOpt.has_value() && playlistOpt->coverUri.isEmpty()) {
+            auto playlist = playlistOpt.value();
+            playlist.coverUri = coverPath;
+            PLAYLIST_MANAGER->updatePlaylist(playlist, QUuid());
+        }
+    }
+}
+
 // ==================== SearchPage Implementation ====================
 
 
@@ -25,6 +67,7 @@ SearchPage::SearchPage(QWidget *parent)
     : QWidget(parent)
     , INavigablePage(SEARCH_PAGE_TYPE)
     , ui(new Ui_SearchPage)
+    , m_resultModel(nullptr)
     , m_currentScope(SearchScope::All)
     , m_scopeMenu(nullptr)
     , m_scopeActionGroup(nullptr)
@@ -32,11 +75,19 @@ SearchPage::SearchPage(QWidget *parent)
     ui->setupUi(this);
     setupScopeMenu();
     
+    // Results are painted by the view's delegate straight from the model, one frame's
+    // batches at a time
+    m_resultModel = new SearchResultModel(this);
+    ui->resultsList->setModel(m_resultModel);
+    
     // Connect signals
     connect(ui->searchButton, &QPushButton::clicked, this, &SearchPage::onSearchButtonClicked);
     connect(ui->searchInput, &QLineEdit::returnPressed, this, &SearchPage::onSearchInputReturnPressed);
     connect(ui->scopeButton, &QPushButton::clicked, this, &SearchPage::onScopeButtonClicked);
-    connect(ui->resultsList, &QListWidget::itemDoubleClicked, this, &SearchPage::onResultItemDoubleClicked);
+    connect(ui->resultsList, &QListView::doubleClicked, this, &SearchPage::onResultItemDoubleClicked);
+    ui->resultsList->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->resultsList, &QListView::customContextMenuRequested, this, &SearchPage::showResultContextMenu);
+    connect(ui->resultsList->verticalScrollBar(), &QScrollBar::valueChanged, this, &SearchPage::onResultsScrolled);
     
     // Connect NetworkManager signals
     connect(NETWORK_MANAGER, &network::NetworkManager::searchCompleted,
@@ -138,20 +189,40 @@ void SearchPage::performSearch()
     
     // Show searching state
     showSearchingState();
-    ui->resultsList->clear();
+    m_resultModel->clear();
     
     // Disable search button to prevent multiple requests
     ui->searchButton->setEnabled(false);
     ui->searchInput->setEnabled(false);
     
-    
-    if (m_currentScope == SearchScope::Bilibili) {
-        // Use Bilibili search only
-        NETWORK_MANAGER->executeMultiSourceSearch(keyword, network::PlatformType::Bilibili, 20);
-    } else {
-        // For "All" scope, search all available sources
-        NETWORK_MANAGER->executeMultiSourceSearch(keyword, network::PlatformType::All, 20);
+    m_hasMorePages = true;
+    loadPage(1);
+}
+
+void SearchPage::loadPage(int page)
+{
+    m_currentPage = page;
+    m_pageLoading = true;
+    m_pageResultCount = 0;
+    NETWORK_MANAGER->executeMultiSourceSearch(m_currentSearchText, searchInterfaces(), RESULTS_PER_PAGE, page);
+}
+
+void SearchPage::maybeLoadNextPage()
+{
+    if (m_currentSearchText.isEmpty() || m_pageLoading || !m_hasMorePages) {
+        return;
     }
+    // Near the end, or the results don't fill the list yet
+    const QScrollBar* bar = ui->resultsList->verticalScrollBar();
+    if (bar->maximum() == 0 || bar->value() >= bar->maximum() - bar->pageStep() / 2) {
+        loadPage(m_currentPage + 1);
+    }
+}
+
+uint SearchPage::searchInterfaces() const
+{
+    // "All" scope searches every available source
+    return m_currentScope == SearchScope::Bilibili ? network::PlatformType::Bilibili : network::PlatformType::All;
 }
 
 void SearchPage::showEmptyState()
@@ -235,6 +306,17 @@ void SearchPage::onSearchCompleted(const QString& keyword)
     ui->searchButton->setEnabled(true);
     ui->searchInput->setEnabled(true);
     
+    m_pageLoading = false;
+    m_resultModel->flush();
+    if (m_pageResultCount == 0) {
+        // Ran past the last page
+        m_hasMorePages = false;
+        return;
+    }
+    // Fetch the following page while the user looks at this one
+    NETWORK_MANAGER->prefetchSearchPage(keyword, searchInterfaces(), m_currentPage + 1, RESULTS_PER_PAGE);
+    // Once the list has laid out the new rows
+    QTimer::singleShot(0, this, &SearchPage::maybeLoadNextPage);
 }
 
 void SearchPage::onSearchFailed(const QString& keyword, const QString& errorMessage)
@@ -247,12 +329,18 @@ void SearchPage::onSearchFailed(const QString& keyword, const QString& errorMess
     if (keyword != m_currentSearchText) {
         return;
     }
+    // A later page failing keeps what is shown and stops paging
+    if (m_currentPage > 1) {
+        LOG_WARN("Loading page {} of search '{}' failed: {}", m_currentPage,
+                 keyword.toStdString(), errorMessage.toStdString());
+        m_hasMorePages = false;
+        return;
+    }
     
     // Show error message
     showResults();
-    ui->resultsList->clear();
-    ui->resultsList->addItem(QString(tr("Search failed: %1")).arg(errorMessage));
-    ui->resultsList->addItem(tr("Please check your network connection or try again later"));
+    m_resultModel->showMessages({ QString(tr("Search failed: %1")).arg(errorMessage),
+                                  tr("Please check your network connection or try again later") });
 }
 
 void SearchPage::onSearchProgress(const QString& keyword, const QList<network::SearchResult>& results)
@@ -262,26 +350,26 @@ void SearchPage::onSearchProgress(const QString& keyword, const QList<network::S
         return;
     }
     
-    // Show results page
+    // Show results page as soon as the first batch arrives
     showResults();
+    m_pageResultCount += results.size();
     
-    for (const auto& result : results) {
-        // Create a simple list item with the result title
-        QListWidgetItem* item = new QListWidgetItem(ui->resultsList);
-        item->setText(result.title);
-        item->setData(Qt::UserRole, QVariant::fromValue(result));
-        
-        ui->resultsList->addItem(item);
-    }
+    // Batches stream in rank order, so each one is appended below the previous ones
+    m_resultModel->appendResults(results);
+}
+
+void SearchPage::onResultsScrolled()
+{
+    maybeLoadNextPage();
 }
 
-void SearchPage::onResultItemDoubleClicked(QListWidgetItem* item)
+void SearchPage::onResultItemDoubleClicked(const QModelIndex& index)
 {
-    if (!item) {
+    if (!index.isValid() || !m_resultModel->isResult(index.row())) {
         return;
     }
 
-    network::SearchResult result = item->data(Qt::UserRole).value<network::SearchResult>();
+    network::SearchResult result = m_resultModel->resultAt(index.row());
     auto currentPlaylistUuid = PLAYLIST_MANAGER->getCurrentPlaylist();
     if (currentPlaylistUuid.isNull()) {
         LOG_WARN("No current playlist selected");
@@ -292,34 +380,13 @@ void SearchPage::onResultItemDoubleClicked(QListWidgetItem* item)
         LOG_WARN("No playlist found for current playlist UUID");
         return;
     }
-    playlist::SongInfo song{
-        .title = result.title,
-        .uploader = result.uploader,
-        .platform = static_cast<int>(result.platform),
-        .duration = result.duration,
-        .coverName = result.coverImg,  // Use coverImg from search result
-        .args = result.interfaceData,
-        .uuid = QUuid::createUuid()
-    };
+    const QString coverPath = coverPathOf(result);
+    const playlist::SongInfo song = songFromResult(result, coverPath);
     bool success = PLAYLIST_MANAGER->addSongToPlaylist(song, currentPlaylistUuid);
     if (!success) {
         LOG_ERROR("Failed to add song to playlist");
     }
-    
-    // Download cover image if it doesn't exist in tmp/cover
-    QString coverPath = CONFIG_MANAGER->getCoverCacheDirectory() + "/" + result.coverImg;
-    if (!QFile::exists(coverPath)) {
-        LOG_INFO("Downloading cover image: {} -> {}", result.coverUrl.toStdString(), coverPath.toStdString());
-        NETWORK_MANAGER->downloadAsync(network::PlatformType::Bilibili,
-                                           result.coverUrl,
-                                           coverPath);
-    }
-    
-    auto playlist = playlistOpt.value();
-    if (playlist.coverUri.isEmpty()) {
-        playlist.coverUri = coverPath;
-        PLAYLIST_MANAGER->updatePlaylist(playlist, QUuid());
-    }
+    useResultCover(result, coverPath, currentPlaylistUuid);
     
     if (AUDIO_PLAYER_CONTROLLER) {
         if (!AUDIO_PLAYER_CONTROLLER->isPlaying()) {
@@ -328,6 +395,52 @@ void SearchPage::onResultItemDoubleClicked(QListWidgetItem* item)
     }
 }
 
+void SearchPage::showResultContextMenu(const QPoint& pos)
+{
+    const QModelIndex index = ui->resultsList->indexAt(pos);
+    if (!index.isValid() || !m_resultModel->isResult(index.row())) {
+        return;
+    }
+    const network::SearchResult result = m_resultModel->resultAt(index.row());
+
+    QMenu contextMenu(this);
+    QAction* addPartsAction = contextMenu.addAction(tr("Add all parts"));
+    addPartsAction->setEnabled(result.platform == network::PlatformType::Bilibili);
+    connect(addPartsAction, &QAction::triggered, this, [this, result]() { addAllParts(result); });
+    contextMenu.exec(ui->resultsList->mapToGlobal(pos));
+}
+
+void SearchPage::addAllParts(const network::SearchResult& result)
+{
+    const QUuid playlistId = PLAYLIST_MANAGER->getCurrentPlaylist();
+    if (playlistId.isNull()) {
+        LOG_WARN("No current playlist selected");
+        return;
+    }
+    // One page list lookup with the first playurls resolved alongside; the parts are added
+    // on the GUI thread in one batch, even if this page is gone by then
+    NETWORK_MANAGER->videoParts(result).then(
+        [playlistId](const util::AsyncResult<std::vector<network::SearchResult>>& parts) {
+        if (parts.failed() || parts.get().empty()) {
+            LOG_WARN("No parts to add");
+            return;
+        }
+        std::vector<network::SearchResult> results = parts.get();
+        QMetaObject::invokeMethod(PLAYLIST_MANAGER, [playlistId, results = std::move(results)]() {
+            // Every part shares the video's cover
+            const QString coverPath = coverPathOf(results.front());
+            QList<playlist::SongInfo> songs;
+            songs.reserve(static_cast<qsizetype>(results.size()));
+            for (const auto& part : results) {
+                songs.append(songFromResult(part, coverPath));
+            }
+            const int added = PLAYLIST_MANAGER->addSongsToPlaylist(songs, playlistId);
+            LOG_INFO("Added {} of {} parts to playlist", added, songs.size());
+            useResultCover(results.front(), coverPath, playlistId);
+        }, Qt::QueuedConnection);
+    });
+}
+
 void SearchPage::cancelPendingSearch()
 {
     // Phase 3b: Cancel any pending search operations
@@ -11,15 +11,19 @@
 
 QT_BEGIN_NAMESPACE
 class Ui_SearchPage;
-class QListWidgetItem;
+class QModelIndex;
 QT_END_NAMESPACE
 
+class SearchResultModel;
+
 class SearchPage : public QWidget, public INavigablePage
 {
     Q_OBJECT
     
 public:
     static constexpr const char* SEARCH_PAGE_TYPE = "SearchPage";
+    // Results requested per search page (one API page of videos, split into parts)
+    static constexpr int RESULTS_PER_PAGE = 50;
     
     enum SearchScope {
         All = 0,
@@ -61,20 +65,36 @@ private slots:
     void onSearchProgress(const QString& keyword, const QList<network::SearchResult>& results);
     
     // UI interaction slots
-    void onResultItemDoubleClicked(QListWidgetItem* item);
+    void onResultItemDoubleClicked(const QModelIndex& index);
+    void showResultContextMenu(const QPoint& pos);
+    // Loads the next page once the list is scrolled near its end
+    void onResultsScrolled();
 
 private:
     void performSearch();
+    // Request a page of the current search; its results are appended to the list
+    void loadPage(int page);
+    void maybeLoadNextPage();
+    uint searchInterfaces() const;
     void showEmptyState();
     void showSearchingState();
     void showResults();
     void setupScopeMenu();
+    // Add every part of the result's video to the current playlist as one change
+    void addAllParts(const network::SearchResult& result);
     QString convertPlatformEnumToString(network::PlatformType platform) const;
     
 private:
     Ui_SearchPage *ui;
+    SearchResultModel* m_resultModel;
     QString m_currentSearchText;
     SearchScope m_currentScope;
+    // Paging of the current search: the last page requested, whether it is still
+    // loading, how many results it brought and whether another page may follow
+    int m_currentPage = 0;
+    bool m_pageLoading = false;
+    int m_pageResultCount = 0;
+    bool m_hasMorePages = false;
     class QMenu* m_scopeMenu;
     class QActionGroup* m_scopeActionGroup;
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "search_result_model.h"
+#include <QTimer>
+
+SearchResultModel::SearchResultModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_flushTimer(new QTimer(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &SearchResultModel::flush);
+}
+
+int SearchResultModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(m_messages.isEmpty() ? m_results.size() : m_messages.size());
+}
+
+QVariant SearchResultModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (!m_messages.isEmpty()) {
+        return role == Qt::DisplayRole ? QVariant(m_messages.at(index.row())) : QVariant();
+    }
+    const network::SearchResult& result = m_results.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        return result.title;
+    case Qt::UserRole:
+        return QVariant::fromValue(result);
+    }
+    return QVariant();
+}
+
+void SearchResultModel::appendResults(const QList<network::SearchResult>& results)
+{
+    if (results.isEmpty()) {
+        return;
+    }
+    m_pending.append(results);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void SearchResultModel::flush()
+{
+    m_flushTimer->stop();
+    if (m_pending.isEmpty()) {
+        return;
+    }
+    if (!m_messages.isEmpty()) {
+        // Results take over from the messages
+        beginResetModel();
+        m_messages.clear();
+        m_results = std::move(m_pending);
+        m_pending.clear();
+        endResetModel();
+        return;
+    }
+    const int first = static_cast<int>(m_results.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(m_pending.size()) - 1);
+    m_results.append(m_pending);
+    endInsertRows();
+    m_pending.clear();
+}
+
+void SearchResultModel::clear()
+{
+    m_flushTimer->stop();
+    beginResetModel();
+    m_results.clear();
+    m_pending.clear();
+    m_messages.clear();
+    endResetModel();
+}
+
+void SearchResultModel::showMessages(const QStringList& lines)
+{
+    m_flushTimer->stop();
+    beginResetModel();
+    m_results.clear();
+    m_pending.clear();
+    m_messages = lines;
+    endResetModel();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QList>
+#include <QStringList>
+#include <network/network_manager.h>
+
+class QTimer;
+
+/**
+ * @brief Search results for SearchPage's result list, appended as they stream in.
+ *
+ * Batches arriving within one frame (FLUSH_INTERVAL_MS) are held back and inserted as a
+ * single row range, so the view lays out and repaints once per frame however fast the
+ * batches come. The list can instead show a few lines of text, e.g. a search error.
+ */
+class SearchResultModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int FLUSH_INTERVAL_MS = 16;
+
+    explicit SearchResultModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // Queue results to be appended with the next flush
+    void appendResults(const QList<network::SearchResult>& results);
+    // Insert the queued results now
+    void flush();
+    void clear();
+    // Replace the results with lines of text
+    void showMessages(const QStringList& lines);
+
+    bool isResult(int row) const { return m_messages.isEmpty() && row >= 0 && row < m_results.size(); }
+    const network::SearchResult& resultAt(int row) const { return m_results.at(row); }
+
+private:
+    QList<network::SearchResult> m_results;
+    QList<network::SearchResult> m_pending;
+    QStringList m_messages;
+    QTimer* m_flushTimer;
+};
@@ -76,6 +76,8 @@ void SettingsPage::connectSignals()
             this, &SettingsPage::onSettingsChanged);
     connect(ui->proxyUrlEdit, &QLineEdit::textChanged,
             this, &SettingsPage::onSettingsChanged);
+    connect(ui->audioQualityCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &SettingsPage::onSettingsChanged);
     
     // Path settings
     connect(ui->playlistDirButton, &QPushButton::clicked,
@@ -151,6 +153,10 @@ void SettingsPage::loadSettings()
     // Network settings
     ui->timeoutSpinBox->setValue(m_configManager->getNetworkTimeout());
     ui->proxyUrlEdit->setText(m_configManager->getProxyUrl());
+    QString audioQuality = m_configManager->getAudioQuality();
+    if (audioQuality == "data_saver") ui->audioQualityCombo->setCurrentIndex(1);
+    else if (audioQuality == "best") ui->audioQualityCombo->setCurrentIndex(2);
+    else ui->audioQualityCombo->setCurrentIndex(0); // auto
     
     // Path settings
     updateDirectoryLabels();
@@ -188,6 +194,8 @@ void SettingsPage::saveSettings()
     // Network settings
     m_configManager->setNetworkTimeout(ui->timeoutSpinBox->value());
     m_configManager->setProxyUrl(ui->proxyUrlEdit->text());
+    QStringList audioQualities = {"auto", "data_saver", "best"};
+    m_configManager->setAudioQuality(audioQualities[ui->audioQualityCombo->currentIndex()]);
     
     // Playlist settings
     m_configManager->setAutoSaveEnabled(ui->autoSaveCheckBox->isChecked());
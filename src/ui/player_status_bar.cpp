@@ -3,7 +3,10 @@
 #include <manager/application_context.h>
 #include <audio/audio_player_controller.h>
 #include <ui/util/elided_label.h>
-#include <QPixmap>
+#include <ui/util/spectrum_widget.h>
+#include <ui/util/cover_thumbnailer.h>
+#include <ui/util/progress_presenter.h>
+#include <ui/util/waveform_slider.h>
 #include <QPushButton>
 #include <QSlider>
 #include <QEvent>
@@ -11,6 +14,8 @@
 #include <QPropertyAnimation>
 #include <log/log_manager.h>
 #include <config/config_manager.h>
+#include <algorithm>
+#include <climits>
 
 PlayerStatusBar::PlayerStatusBar(QWidget* parent)
     : QWidget(parent)
@@ -45,15 +50,33 @@ PlayerStatusBar::PlayerStatusBar(QWidget* parent)
     if (ui->btnMute) {
         connect(ui->btnMute, &QPushButton::clicked, this, &PlayerStatusBar::onMuteClicked);
     }
+    if (ui->progressSlider) {
+        connect(ui->progressSlider, &QSlider::sliderReleased, this, &PlayerStatusBar::onProgressSliderReleased);
+    }
 
     // Connect audio controller signals
     if (audioController) {
         connect(audioController, &audio::AudioPlayerController::currentSongChanged, 
                 this, &PlayerStatusBar::onCurrentSongChanged);
+        // Drawn at most once a frame, and not at all while hidden
+        if (ui->progressSlider) {
+            m_progressPresenter = new ProgressPresenter(ui->progressSlider, this);
+        }
+        // Emitted by decode threads when an outline is first computed
+        if (ui->progressSlider) {
+            connect(audioController, &audio::AudioPlayerController::waveformReady,
+                    ui->progressSlider, &WaveformSlider::setWaveform, Qt::QueuedConnection);
+        }
         connect(audioController, &audio::AudioPlayerController::positionChanged, 
                 this, &PlayerStatusBar::onPositionChanged);
         connect(audioController, &audio::AudioPlayerController::playbackStateChanged, 
                 this, &PlayerStatusBar::onPlaybackStateChanged);
+        // Bins are computed off the render thread and arrive here as queued signals
+        if (auto* spectrum = audioController->spectrumAnalyzer(); spectrum && ui->spectrumWidget) {
+            connect(spectrum, &audio::SpectrumAnalyzer::spectrumUpdated,
+                    ui->spectrumWidget, &SpectrumWidget::setBands, Qt::QueuedConnection);
+            spectrum->start();
+        }
     }
 }
 
@@ -67,10 +90,7 @@ void PlayerStatusBar::onNetworkDownload(QString url, QString savePath)
 {
     if (savePath == m_currentCoverPath) {
         if (ui->coverLabel) {
-            QPixmap pix(savePath);
-            if (!pix.isNull()) {
-                ui->coverLabel->setPixmap(pix.scaled(64, 64, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-            }
+            CoverThumbnailer::instance().setCover(ui->coverLabel, savePath, QSize(COVER_SIZE, COVER_SIZE));
         }
     }
 }
@@ -163,7 +183,9 @@ void PlayerStatusBar::onCurrentSongChanged(const playlist::SongInfo& song, int i
         ui->uploaderLabel->setText(song.uploader);
     }
     if (ui->progressSlider) {
-        ui->progressSlider->setRange(0, song.duration);
+        // Positions arrive in milliseconds, duration is stored in seconds
+        ui->progressSlider->setRange(0, static_cast<int>(std::min<qint64>(qint64(song.duration) * 1000, INT_MAX)));
+        ui->progressSlider->setSong(song.uuid);
     }
     
     if (ui->coverLabel) {
@@ -174,26 +196,21 @@ void PlayerStatusBar::onCurrentSongChanged(const playlist::SongInfo& song, int i
             // Check if cover exists, if not trigger download
             if (!QFile::exists(coverPath)) {
                 LOG_INFO("Cover image not found at {}, will download when available", coverPath.toStdString());
-                ui->coverLabel->setText("Loading...");
+                CoverThumbnailer::clearCover(ui->coverLabel, "Loading...");
                 m_currentCoverPath = coverPath;
                 // Note: The download should be triggered elsewhere (e.g., when song is added)
                 // Here we just set placeholder and remember the path
             } else {
-                QPixmap pix(coverPath);
-                if (!pix.isNull()) {
-                    QPixmap scaled = pix.scaled(64, 64, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-                    ui->coverLabel->setPixmap(scaled);
-                } else {
-                    LOG_WARN("Failed to load cover image: {}", coverPath.toStdString());
-                    ui->coverLabel->setText("No Cover");
-                }
+                // Decoded off the GUI thread; the label says "Loading..." until then
+                m_currentCoverPath.clear();
+                CoverThumbnailer::instance().setCover(ui->coverLabel, coverPath, QSize(COVER_SIZE, COVER_SIZE));
             }
         } else {
-            ui->coverLabel->setText("No Cover");
+            m_currentCoverPath.clear();
+            CoverThumbnailer::clearCover(ui->coverLabel, "No Cover");
         }
     }
     
-    m_currentCoverPath = song.filepath;
     LOG_INFO("Now playing: {} by {} (Index: {}), duration {}, cover {}", 
         song.title.toStdString(), song.uploader.toStdString(), index, 
         song.duration, song.coverName.toStdString());
@@ -201,8 +218,15 @@ void PlayerStatusBar::onCurrentSongChanged(const playlist::SongInfo& song, int i
 
 void PlayerStatusBar::onPositionChanged(qint64 posMs)
 {
-    if (ui->progressSlider) {
-        ui->progressSlider->setValue(posMs);
+    if (m_progressPresenter) {
+        m_progressPresenter->setPosition(posMs);
+    }
+}
+
+void PlayerStatusBar::onProgressSliderReleased()
+{
+    if (auto* audioController = AUDIO_PLAYER_CONTROLLER) {
+        audioController->seekTo(ui->progressSlider->value());
     }
 }
 
@@ -17,11 +17,14 @@ class QPropertyAnimation;
 QT_END_NAMESPACE
 
 class ScrollingLabel;
+class ProgressPresenter;
 
 class PlayerStatusBar : public QWidget
 {
     Q_OBJECT
 public:
+    static constexpr int COVER_SIZE = 64;
+
     explicit PlayerStatusBar(QWidget* parent = nullptr);
     virtual ~PlayerStatusBar();
 public slots:
@@ -34,10 +37,12 @@ public slots:
     void onMuteClicked();
     void onCurrentSongChanged(const playlist::SongInfo& song, int index);
     void onPositionChanged(qint64 posMs);
+    void onProgressSliderReleased();
     void onPlaybackStateChanged(audio::PlaybackState state);
 
 private:
     Ui_PlayerStatusBar* ui;
     QString m_currentCoverPath;
+    ProgressPresenter* m_progressPresenter = nullptr;
     float m_lastVolumeBeforeMute;
 };
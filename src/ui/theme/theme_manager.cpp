@@ -1,6 +1,7 @@
 #include "theme_manager.h"
 #include <log/log_manager.h>
 #include <json/json.h>
+#include <QCryptographicHash>
 #include <QFile>
 #include <QDir>
 #include <QFileInfo>
@@ -281,13 +282,58 @@ void ThemeManager::applyTheme(const Theme& theme)
 
 void ThemeManager::applyCurrentTheme()
 {
-    QString styleSheet = generateStyleSheet(m_currentTheme);
-    
     // Emit signal to notify subscribers (MainWindow or other UI components) to apply the theme
     emit themeApplied(m_currentTheme);
     LOG_INFO("Theme applied signal emitted: {}", m_currentTheme.name.toStdString());
 }
 
+void ThemeManager::setAccentColor(const QColor& color)
+{
+    if (!color.isValid() || color == m_currentTheme.accentColor) {
+        return;
+    }
+    m_currentTheme.accentColor = color;
+    applyCurrentTheme();
+}
+
+QByteArray ThemeManager::themeKey(const Theme& theme)
+{
+    // toMap() is what a theme file holds, in key order
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const QMap<QString, QVariant> map = theme.toMap();
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        hash.addData(it.key().toUtf8());
+        hash.addData(QByteArrayView("=", 1));
+        hash.addData(it.value().toString().toUtf8());
+        hash.addData(QByteArrayView("\n", 1));
+    }
+    return hash.result();
+}
+
+QString ThemeManager::styleSheetFor(const Theme& theme)
+{
+    const QByteArray key = themeKey(theme);
+    auto it = m_styleSheets.constFind(key);
+    if (it != m_styleSheets.constEnd()) {
+        return it.value();
+    }
+    QString styleSheet = generateStyleSheet(theme);
+    m_styleSheets.insert(key, styleSheet);
+    return styleSheet;
+}
+
+QPalette ThemeManager::paletteFor(const Theme& theme, const QPalette& base)
+{
+    QPalette palette = base;
+    if (theme.accentColor.isValid()) {
+        palette.setColor(QPalette::Highlight, theme.accentColor);
+    }
+    if (theme.fontLinkColor.isValid()) {
+        palette.setColor(QPalette::Link, theme.fontLinkColor);
+    }
+    return palette;
+}
+
 QString ThemeManager::generateStyleSheet(const Theme& theme) const
 {
     QString qss;
@@ -365,7 +411,7 @@ QString ThemeManager::generateStyleSheet(const Theme& theme) const
                          theme.borderColor.name());
     
     // TreeWidget/ListView styling
-    qss += QString("QTreeWidget, QListWidget, QTableWidget { "
+    qss += QString("QTreeView, QListView, QTableView { "
                    "background-color: %1; "
                    "color: %2; "
                    "border: 1px solid %3; "
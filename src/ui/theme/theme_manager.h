@@ -3,7 +3,9 @@
 #include <QObject>
 #include <QString>
 #include <QColor>
+#include <QHash>
 #include <QMap>
+#include <QPalette>
 #include <QPixmap>
 
 /**
@@ -71,6 +73,9 @@ public:
     // Apply theme
     void applyTheme(const Theme& theme);
     void applyCurrentTheme();
+    // Change only the accent of the current theme; it lives in the palette, not the
+    // stylesheet, so widgets aren't re-polished
+    void setAccentColor(const QColor& color);
     
     // Built-in themes
     static Theme getLightTheme();
@@ -87,6 +92,12 @@ public:
     
     // Preview
     QString generateStyleSheet(const Theme& theme) const;
+    // generateStyleSheet(), generated once per theme content
+    QString styleSheetFor(const Theme& theme);
+    // Colors that are not part of the stylesheet: accent and links
+    static QPalette paletteFor(const Theme& theme, const QPalette& base);
+    // Hash of everything in the theme, its JSON form included
+    static QByteArray themeKey(const Theme& theme);
     
 signals:
     void themeChanged(const QString& themeName);
@@ -96,6 +107,7 @@ private:
     Theme m_currentTheme;
     QString m_themeDirectory;
     QMap<QString, Theme> m_builtInThemes;
+    QHash<QByteArray, QString> m_styleSheets;     // By themeKey()
     
     void initializeBuiltInThemes();
     QString colorToStyleSheet(const QColor& color) const;
@@ -0,0 +1,112 @@
+#include "cover_thumbnailer.h"
+#include <util/thread_pool.h>
+#include <log/log_manager.h>
+#include <QCoreApplication>
+#include <QImage>
+#include <QImageReader>
+#include <QLabel>
+#include <QPixmapCache>
+
+namespace {
+    // The cache key of the cover a label is waiting for
+    const char* const COVER_KEY_PROPERTY = "coverThumbnailKey";
+
+    QImage decodeScaled(const QString& path, const QSize& size)
+    {
+        QImageReader reader(path);
+        reader.setAutoTransform(true);
+        const QSize original = reader.size();
+        // Decoding at the target size skips most of the work for large covers
+        if (original.isValid() && (original.width() > size.width() || original.height() > size.height())) {
+            reader.setScaledSize(original.scaled(size, Qt::KeepAspectRatio));
+        }
+        QImage image = reader.read();
+        if (image.isNull()) {
+            LOG_WARN("Failed to load cover image {}: {}", path.toStdString(), reader.errorString().toStdString());
+        }
+        return image;
+    }
+}
+
+CoverThumbnailer& CoverThumbnailer::instance()
+{
+    // Owned by the application, so the pool is gone before it
+    static CoverThumbnailer* thumbnailer = new CoverThumbnailer(QCoreApplication::instance());
+    return *thumbnailer;
+}
+
+CoverThumbnailer::CoverThumbnailer(QObject* parent)
+    : QObject(parent)
+    , m_pool(std::make_unique<util::ThreadPool>(DECODE_THREADS))
+{
+}
+
+CoverThumbnailer::~CoverThumbnailer() = default;
+
+QString CoverThumbnailer::cacheKey(const QString& path, const QSize& size)
+{
+    return QString("cover:%1x%2:%3").arg(size.width()).arg(size.height()).arg(path);
+}
+
+QPixmap CoverThumbnailer::thumbnail(const QString& path, const QSize& size)
+{
+    const QString key = cacheKey(path, size);
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+    if (m_pending.contains(key)) {
+        return QPixmap();
+    }
+    m_pending.insert(key);
+    m_pool->submit(util::ThreadPool::Priority::Normal, [this, key, path, size]() {
+        QImage image = decodeScaled(path, size);
+        // QPixmap belongs to the GUI thread
+        QMetaObject::invokeMethod(this, [this, key, path, size, image]() {
+            m_pending.remove(key);
+            QPixmap pixmap;
+            if (!image.isNull()) {
+                pixmap = QPixmap::fromImage(image);
+                QPixmapCache::insert(key, pixmap);
+            }
+            emit thumbnailReady(path, size, pixmap);
+        }, Qt::QueuedConnection);
+    });
+    return QPixmap();
+}
+
+void CoverThumbnailer::clearCover(QLabel* label, const QString& text)
+{
+    label->setProperty(COVER_KEY_PROPERTY, QVariant());
+    label->setText(text);
+}
+
+void CoverThumbnailer::setCover(QLabel* label, const QString& path, const QSize& size)
+{
+    const QString key = cacheKey(path, size);
+    label->setProperty(COVER_KEY_PROPERTY, key);
+    const QPixmap pixmap = thumbnail(path, size);
+    if (!pixmap.isNull()) {
+        label->setPixmap(pixmap);
+        return;
+    }
+    label->setText(tr("Loading..."));
+
+    // One-shot: gone with the label, or once this cover is in
+    auto connection = std::make_shared<QMetaObject::Connection>();
+    *connection = connect(this, &CoverThumbnailer::thumbnailReady, label,
+        [label, key, connection](const QString& readyPath, const QSize& readySize, const QPixmap& ready) {
+            if (cacheKey(readyPath, readySize) != key) {
+                return;
+            }
+            QObject::disconnect(*connection);
+            if (label->property(COVER_KEY_PROPERTY).toString() != key) {
+                return;     // The label has moved on to another cover
+            }
+            if (ready.isNull()) {
+                label->setText(tr("No Cover"));
+            } else {
+                label->setPixmap(ready);
+            }
+        });
+}
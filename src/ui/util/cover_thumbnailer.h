@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <memory>
+
+class QLabel;
+
+namespace util { class ThreadPool; }
+
+/**
+ * @brief Cover images scaled down for display, decoded off the GUI thread.
+ *
+ * Covers are decoded straight to the target size with QImageReader::setScaledSize, on a
+ * small pool of their own, and kept in QPixmapCache by path and size. A cover not in the
+ * cache yet is reported through thumbnailReady once decoded; setCover() does that for a
+ * label, showing a placeholder until then.
+ *
+ * GUI thread only, like the pixmaps it hands out.
+ */
+class CoverThumbnailer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr size_t DECODE_THREADS = 2;
+
+    static CoverThumbnailer& instance();
+    ~CoverThumbnailer() override;
+
+    // The cached thumbnail of the image at path, fitting size; null if it isn't decoded
+    // yet, in which case decoding starts and thumbnailReady follows
+    QPixmap thumbnail(const QString& path, const QSize& size);
+    // Show the thumbnail in label, "Loading..." until it is decoded and "No Cover" if it
+    // can't be; a later call for the same label wins
+    void setCover(QLabel* label, const QString& path, const QSize& size);
+    // Show text in label instead, dropping any cover it is waiting for
+    static void clearCover(QLabel* label, const QString& text);
+
+signals:
+    // pixmap is null if the image couldn't be read
+    void thumbnailReady(const QString& path, const QSize& size, const QPixmap& pixmap);
+
+private:
+    explicit CoverThumbnailer(QObject* parent);
+    static QString cacheKey(const QString& path, const QSize& size);
+
+    std::unique_ptr<util::ThreadPool> m_pool;
+    QSet<QString> m_pending;     // Cache keys being decoded
+};
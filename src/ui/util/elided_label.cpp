@@ -2,12 +2,16 @@
 #include <QPainter>
 #include <QResizeEvent>
 #include <QEnterEvent>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QTimer>
 #include <QPropertyAnimation>
 #include <log/log_manager.h>
+#include <util/idle_mode.h>
 
 ScrollingLabel::ScrollingLabel(QWidget* parent)
     : QLabel(parent)
+    , m_textWidth(-1)
     , m_scrollOffset(0)
     , m_isTextElided(false)
     , m_scrollingEnabled(true)
@@ -20,8 +24,13 @@ ScrollingLabel::ScrollingLabel(QWidget* parent)
 }
 
 void ScrollingLabel::setText(const QString& text) {
+    if (text == m_fullText && m_textWidth >= 0) {
+        return;
+    }
     m_fullText = text;
     setToolTip(text);
+    m_textWidth = -1;
+    invalidateTextPixmap();
     updateText();
 }
 
@@ -57,9 +66,48 @@ bool ScrollingLabel::isAutoScroll() const {
 
 void ScrollingLabel::resizeEvent(QResizeEvent* event) {
     QLabel::resizeEvent(event);
+    if (event->size().height() != event->oldSize().height()) {
+        invalidateTextPixmap();
+    }
     updateText();
 }
 
+void ScrollingLabel::changeEvent(QEvent* event) {
+    QLabel::changeEvent(event);
+    switch (event->type()) {
+    case QEvent::FontChange:
+        m_textWidth = -1;
+        invalidateTextPixmap();
+        updateText();
+        break;
+    case QEvent::PaletteChange:
+    case QEvent::StyleChange:
+        invalidateTextPixmap();
+        break;
+    default:
+        break;
+    }
+}
+
+void ScrollingLabel::showEvent(QShowEvent* event) {
+    QLabel::showEvent(event);
+    if (m_scrollAnimation && m_scrollAnimation->state() == QAbstractAnimation::Paused) {
+        m_scrollAnimation->resume();
+    } else if (!m_scrollAnimation && m_pauseTimer && !m_pauseTimer->isActive()) {
+        m_pauseTimer->start();
+    }
+}
+
+void ScrollingLabel::hideEvent(QHideEvent* event) {
+    QLabel::hideEvent(event);
+    if (m_scrollAnimation && m_scrollAnimation->state() == QAbstractAnimation::Running) {
+        m_scrollAnimation->pause();
+    }
+    if (m_pauseTimer) {
+        m_pauseTimer->stop();
+    }
+}
+
 void ScrollingLabel::enterEvent(QEnterEvent* event) {
     QLabel::enterEvent(event);
     if (!m_autoScroll && m_scrollingEnabled && m_isTextElided) {
@@ -83,37 +131,64 @@ void ScrollingLabel::paintEvent(QPaintEvent* event) {
         return;
     }
 
-    QPainter painter(this);
-    painter.setFont(font());
-    
-    QFontMetrics metrics(font());
-    int textWidth = metrics.horizontalAdvance(m_fullText);
-    
-    // LOG_DEBUG("ScrollingLabel::paintEvent: scrollOffset={}, textWidth={}, labelWidth={}, font={}",
-    //           m_scrollOffset, textWidth, width(), font().toString().toStdString());
+    const int fullWidth = textWidth();
     
     // If textWidth is 0, font metrics failed - fall back to showing text normally
-    if (textWidth == 0) {
+    if (fullWidth == 0) {
         QLabel::setText(m_fullText);
         QLabel::paintEvent(event);
         return;
     }
     
-    // Draw scrolling text
+    // Blit the rendered text at the scroll offset
+    QPainter painter(this);
+    const QPixmap& pixmap = textPixmap();
     int x = -m_scrollOffset;
-    painter.drawText(x, 0, textWidth, height(), Qt::AlignLeft | Qt::AlignVCenter, m_fullText);
+    painter.drawPixmap(x, 0, pixmap);
     
     // Draw duplicate for seamless loop
     if (m_scrollOffset > 0) {
-        painter.drawText(x + textWidth + 20, 0, textWidth, height(), Qt::AlignLeft | Qt::AlignVCenter, m_fullText);
+        painter.drawPixmap(x + fullWidth + 20, 0, pixmap);
     }
 }
 
 void ScrollingLabel::setScrollOffset(int offset) {
+    util::IdleMode::recordWakeup();
+    // The animation ticks faster than the text moves a pixel
+    if (offset == m_scrollOffset) {
+        return;
+    }
     m_scrollOffset = offset;
     update();
 }
 
+int ScrollingLabel::textWidth() {
+    if (m_textWidth < 0) {
+        m_textWidth = QFontMetrics(font()).horizontalAdvance(m_fullText);
+    }
+    return m_textWidth;
+}
+
+void ScrollingLabel::invalidateTextPixmap() {
+    m_textPixmap = QPixmap();
+}
+
+const QPixmap& ScrollingLabel::textPixmap() {
+    const qreal dpr = devicePixelRatioF();
+    if (!m_textPixmap.isNull() && m_textPixmap.devicePixelRatio() == dpr) {
+        return m_textPixmap;
+    }
+    const QRect bounds(0, 0, textWidth(), height());
+    m_textPixmap = QPixmap(bounds.size() * dpr);
+    m_textPixmap.setDevicePixelRatio(dpr);
+    m_textPixmap.fill(Qt::transparent);
+    QPainter painter(&m_textPixmap);
+    painter.setFont(font());
+    painter.setPen(palette().color(foregroundRole()));
+    painter.drawText(bounds, Qt::AlignLeft | Qt::AlignVCenter, m_fullText);
+    return m_textPixmap;
+}
+
 int ScrollingLabel::scrollOffset() const {
     return m_scrollOffset;
 }
@@ -124,13 +199,11 @@ void ScrollingLabel::updateText() {
         return;
     }
     
-    QFontMetrics metrics(font());
-    int textWidth = metrics.horizontalAdvance(m_fullText);
-    m_isTextElided = textWidth > width();
+    m_isTextElided = textWidth() > width();
     
     if (!m_scrollingEnabled || !m_isTextElided) {
         // Show elided text
-        QString elided = metrics.elidedText(m_fullText, Qt::ElideRight, width());
+        QString elided = m_isTextElided ? QFontMetrics(font()).elidedText(m_fullText, Qt::ElideRight, width()) : m_fullText;
         QLabel::setText(elided);
         stopScrolling();
     } else {
@@ -145,27 +218,30 @@ void ScrollingLabel::updateText() {
 void ScrollingLabel::startScrolling() {
     stopScrolling();
 
-    QFontMetrics metrics(font());
-    int textWidth = metrics.horizontalAdvance(m_fullText);
+    const int fullWidth = textWidth();
     
     // Check if scrolling is actually needed
-    if (!m_scrollingEnabled || textWidth <= width()) {
+    if (!m_scrollingEnabled || fullWidth <= width()) {
         return;
     }
     
     // Pause before starting
     m_pauseTimer = new QTimer(this);
     m_pauseTimer->setSingleShot(true);
-    connect(m_pauseTimer, &QTimer::timeout, this, [this, textWidth]() {
+    connect(m_pauseTimer, &QTimer::timeout, this, [this, fullWidth]() {
+        if (!isVisible()) {
+            return;     // showEvent starts the pause over
+        }
         m_scrollAnimation = new QPropertyAnimation(this, "scrollOffset", this);
-        m_scrollAnimation->setDuration((textWidth + 20) * 15); // ~15ms per pixel
+        m_scrollAnimation->setDuration((fullWidth + 20) * 15); // ~15ms per pixel
         m_scrollAnimation->setStartValue(0);
-        m_scrollAnimation->setEndValue(textWidth + 20);
+        m_scrollAnimation->setEndValue(fullWidth + 20);
         m_scrollAnimation->setEasingCurve(QEasingCurve::Linear);
         m_scrollAnimation->setLoopCount(-1); // Infinite loop
         m_scrollAnimation->start();
     });
-    m_pauseTimer->start(500); // 500ms pause before scrolling
+    m_pauseTimer->setInterval(500); // 500ms pause before scrolling
+    m_pauseTimer->start();
 }
 
 void ScrollingLabel::stopScrolling() {
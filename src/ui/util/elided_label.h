@@ -1,10 +1,13 @@
 #pragma once
 
 #include <QLabel>
+#include <QPixmap>
 
 class QResizeEvent;
 class QEnterEvent;
 class QPaintEvent;
+class QShowEvent;
+class QHideEvent;
 class QPropertyAnimation;
 class QTimer;
 
@@ -29,6 +32,10 @@ protected:
     void enterEvent(QEnterEvent* event) override;
     void leaveEvent(QEvent* event) override;
     void paintEvent(QPaintEvent* event) override;
+    void changeEvent(QEvent* event) override;
+    // Minimizing or hiding the window hides the label too; no ticks meanwhile
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
 
 private slots:
     void setScrollOffset(int offset);
@@ -38,8 +45,16 @@ private:
     void updateText();
     void startScrolling();
     void stopScrolling();
+    int textWidth();
+    // Drop the rendered text after a text, font, palette or size change
+    void invalidateTextPixmap();
+    // The full text rendered once at the label's height and device pixel ratio; scroll
+    // frames only blit it
+    const QPixmap& textPixmap();
 
     QString m_fullText;
+    int m_textWidth;            // Of m_fullText in the current font, -1 until measured
+    QPixmap m_textPixmap;
     int m_scrollOffset;
     bool m_isTextElided;
     bool m_scrollingEnabled;
@@ -0,0 +1,52 @@
+#include "first_paint_tracer.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+#include <util/startup_trace.h>
+
+void FirstPaintTracer::install(QWidget* widget, const std::string& markName,
+                               std::function<bool()> ready, std::function<void()> onMarked)
+{
+    if (!widget || util::StartupTrace::instance().hasMark(markName)) {
+        return;
+    }
+    // Owned by the widget, so it goes away with it if never painted
+    new FirstPaintTracer(widget, markName, std::move(ready), std::move(onMarked));
+}
+
+FirstPaintTracer::FirstPaintTracer(QWidget* widget, std::string markName,
+                                   std::function<bool()> ready, std::function<void()> onMarked)
+    : QObject(widget)
+    , m_widget(widget)
+    , m_markName(std::move(markName))
+    , m_ready(std::move(ready))
+    , m_onMarked(std::move(onMarked))
+{
+    // Children are painted without their parent when they cover it, so watch them all
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+bool FirstPaintTracer::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() != QEvent::Paint || m_painted || !watched->isWidgetType()) {
+        return false;
+    }
+    auto* painted = static_cast<QWidget*>(watched);
+    if (painted != m_widget && !m_widget->isAncestorOf(painted)) {
+        return false;
+    }
+    if (m_ready && !m_ready()) {
+        return false;
+    }
+    m_painted = true;
+    QCoreApplication::instance()->removeEventFilter(this);
+    // The whole frame is painted and flushed within this event loop pass
+    QTimer::singleShot(0, this, [this]() {
+        if (util::StartupTrace::instance().mark(m_markName) && m_onMarked) {
+            m_onMarked();
+        }
+        deleteLater();
+    });
+    return false;
+}
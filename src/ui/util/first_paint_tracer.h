@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QObject>
+#include <functional>
+#include <string>
+
+class QWidget;
+
+/**
+ * @brief Marks in util::StartupTrace when a widget, or anything inside it, is first painted.
+ *
+ * Watches paint events application-wide until the first one in the widget for which
+ * ready() (if given) holds, then records the mark once that frame is done and deletes
+ * itself, calling onMarked. Nothing is installed if the mark already exists.
+ */
+class FirstPaintTracer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void install(QWidget* widget, const std::string& markName,
+                        std::function<bool()> ready = nullptr, std::function<void()> onMarked = nullptr);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    FirstPaintTracer(QWidget* widget, std::string markName, std::function<bool()> ready, std::function<void()> onMarked);
+
+    QWidget* m_widget;
+    std::string m_markName;
+    std::function<bool()> m_ready;
+    std::function<void()> m_onMarked;
+    bool m_painted = false;
+};
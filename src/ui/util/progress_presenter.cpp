@@ -0,0 +1,93 @@
+#include "progress_presenter.h"
+#include <QEvent>
+#include <QScreen>
+#include <QSlider>
+#include <QStyle>
+#include <QTimer>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <util/idle_mode.h>
+#include <util/trace.h>
+
+ProgressPresenter::ProgressPresenter(QSlider* slider, QObject* parent)
+    : QObject(parent)
+    , m_slider(slider)
+    , m_frameTimer(new QTimer(this))
+{
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &ProgressPresenter::present);
+    connect(m_slider, &QSlider::rangeChanged, this, [this]() { m_shownPixel = -1; });
+    m_slider->installEventFilter(this);
+    m_slider->window()->installEventFilter(this);
+}
+
+void ProgressPresenter::setPosition(qint64 positionMs)
+{
+    m_positionMs = positionMs;
+    m_dirty = true;
+    // Later positions in this frame replace this one
+    if (canPresent() && !m_frameTimer->isActive()) {
+        m_frameTimer->start(framePeriodMs());
+    }
+}
+
+bool ProgressPresenter::eventFilter(QObject* watched, QEvent* event)
+{
+    switch (event->type()) {
+    case QEvent::ParentChange:
+        if (watched == m_slider) {
+            m_slider->window()->installEventFilter(this);
+        }
+        break;
+    case QEvent::Resize:
+        m_shownPixel = -1;      // The same value may now be another pixel
+        [[fallthrough]];
+    case QEvent::Show:
+    case QEvent::WindowStateChange:
+        // Back from hidden or minimized: catch up with the latest position
+        if (m_dirty && canPresent() && !m_frameTimer->isActive()) {
+            m_frameTimer->start(framePeriodMs());
+        }
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void ProgressPresenter::present()
+{
+    util::IdleMode::recordWakeup();
+    if (!m_dirty || !canPresent()) {
+        return;     // Presented again once shown
+    }
+    // Don't fight the user while they drag the handle
+    if (m_slider->isSliderDown()) {
+        return;
+    }
+    m_dirty = false;
+    TRACE_SCOPE("ui", "ProgressPresenter::present");
+    const int value = static_cast<int>(std::min<qint64>(m_positionMs, INT_MAX));
+    const int span = m_slider->orientation() == Qt::Horizontal ? m_slider->width() : m_slider->height();
+    const int pixel = QStyle::sliderPositionFromValue(m_slider->minimum(), m_slider->maximum(), value, span);
+    if (pixel == m_shownPixel && value >= m_slider->minimum() && value <= m_slider->maximum()) {
+        return;
+    }
+    m_shownPixel = pixel;
+    m_slider->setValue(value);
+}
+
+bool ProgressPresenter::canPresent() const
+{
+    const QWidget* window = m_slider->window();
+    return m_slider->isVisible() && !window->isMinimized();
+}
+
+int ProgressPresenter::framePeriodMs() const
+{
+    const QScreen* screen = m_slider->screen();
+    const qreal rate = screen ? screen->refreshRate() : 60.0;
+    return rate > 0 ? std::max(1, static_cast<int>(std::lround(1000.0 / rate))) : 16;
+}
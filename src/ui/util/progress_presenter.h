@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QObject>
+
+class QSlider;
+class QTimer;
+
+/**
+ * @brief Shows the playback position on a slider, at most once a screen frame and only
+ * when the handle would land on another pixel.
+ *
+ * Positions are coalesced until the next frame of the slider's screen. Nothing is drawn
+ * while the slider is hidden or its window minimized; the latest position is shown once
+ * it is visible again. The handle is left alone while the user drags it.
+ */
+class ProgressPresenter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProgressPresenter(QSlider* slider, QObject* parent = nullptr);
+
+public slots:
+    void setPosition(qint64 positionMs);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void present();
+    bool canPresent() const;
+    int framePeriodMs() const;
+
+    QSlider* m_slider;
+    QTimer* m_frameTimer;
+    qint64 m_positionMs = 0;
+    bool m_dirty = false;
+    int m_shownPixel = -1;      // Handle offset last drawn
+};
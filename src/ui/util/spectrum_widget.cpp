@@ -0,0 +1,37 @@
+#include "spectrum_widget.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <algorithm>
+
+SpectrumWidget::SpectrumWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
+}
+
+QSize SpectrumWidget::sizeHint() const {
+    return QSize(128, 32);
+}
+
+void SpectrumWidget::setBands(const QVector<float>& bands) {
+    m_bands = bands;
+    update();
+}
+
+void SpectrumWidget::paintEvent(QPaintEvent*) {
+    if (m_bands.isEmpty()) {
+        return;
+    }
+    QPainter painter(this);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(palette().color(QPalette::Highlight));
+
+    const int count = m_bands.size();
+    const qreal slot = static_cast<qreal>(width()) / count;
+    const qreal barWidth = std::max<qreal>(1.0, slot - 1.0);
+    for (int i = 0; i < count; ++i) {
+        const qreal barHeight = std::clamp(m_bands[i], 0.0f, 1.0f) * height();
+        if (barHeight < 1.0) continue;
+        painter.drawRect(QRectF(i * slot, height() - barHeight, barWidth, barHeight));
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QWidget>
+#include <QVector>
+
+class QPaintEvent;
+
+// Bar graph of visualizer bands (0..1 each), fed by audio::SpectrumAnalyzer
+class SpectrumWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit SpectrumWidget(QWidget* parent = nullptr);
+
+    QSize sizeHint() const override;
+
+public slots:
+    void setBands(const QVector<float>& bands);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    QVector<float> m_bands;
+};
@@ -0,0 +1,131 @@
+#include "waveform_slider.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include <algorithm>
+
+WaveformSlider::WaveformSlider(QWidget* parent)
+    : QSlider(Qt::Horizontal, parent)
+{
+    setMinimumHeight(24);
+}
+
+void WaveformSlider::setSong(const QUuid& songId)
+{
+    if (songId == m_songId) {
+        return;
+    }
+    m_songId = songId;
+    if (!songId.isNull() && songId == m_pendingSongId) {
+        m_peaks = std::move(m_pendingPeaks);
+        m_rms = std::move(m_pendingRms);
+    } else {
+        m_peaks.clear();
+        m_rms.clear();
+    }
+    m_pendingSongId = QUuid();
+    m_pendingPeaks.clear();
+    m_pendingRms.clear();
+    renderPixmaps();
+    update();
+}
+
+void WaveformSlider::setWaveform(const QUuid& songId, const QByteArray& peaks, const QByteArray& rms)
+{
+    if (peaks.isEmpty() || peaks.size() != rms.size()) {
+        return;
+    }
+    if (songId != m_songId) {
+        m_pendingSongId = songId;
+        m_pendingPeaks = peaks;
+        m_pendingRms = rms;
+        return;
+    }
+    m_peaks = peaks;
+    m_rms = rms;
+    renderPixmaps();
+    update();
+}
+
+void WaveformSlider::paintEvent(QPaintEvent* event)
+{
+    if (m_peaks.isEmpty() || m_played.isNull()) {
+        QSlider::paintEvent(event);
+        return;
+    }
+    QPainter painter(this);
+    QStyleOptionSlider option;
+    initStyleOption(&option);
+    const QRect handle = style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderHandle, this);
+    const int split = handle.center().x();
+
+    painter.setClipRect(0, 0, split, height());
+    painter.drawPixmap(0, 0, m_played);
+    painter.setClipRect(split, 0, width() - split, height());
+    painter.drawPixmap(0, 0, m_remaining);
+    painter.setClipping(false);
+
+    // The handle only; the outline stands in for the groove
+    option.subControls = QStyle::SC_SliderHandle;
+    style()->drawComplexControl(QStyle::CC_Slider, &option, &painter, this);
+}
+
+void WaveformSlider::resizeEvent(QResizeEvent* event)
+{
+    QSlider::resizeEvent(event);
+    renderPixmaps();
+}
+
+void WaveformSlider::changeEvent(QEvent* event)
+{
+    QSlider::changeEvent(event);
+    if (event->type() == QEvent::PaletteChange || event->type() == QEvent::StyleChange) {
+        renderPixmaps();
+    }
+}
+
+/*************** Private Methods ***************/
+void WaveformSlider::renderPixmaps()
+{
+    if (m_peaks.isEmpty() || width() <= 0 || height() <= 0) {
+        m_played = QPixmap();
+        m_remaining = QPixmap();
+        return;
+    }
+    const qreal ratio = devicePixelRatioF();
+    const int columns = std::max(1, static_cast<int>(width() * ratio));
+    const qreal middle = height() / 2.0;
+    const int count = m_peaks.size();
+
+    auto render = [&](const QColor& color) -> QPixmap {
+        QPixmap pixmap(QSize(columns, static_cast<int>(height() * ratio)));
+        pixmap.setDevicePixelRatio(ratio);
+        pixmap.fill(Qt::transparent);
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing, false);
+        QColor peakColor = color;
+        peakColor.setAlpha(110);
+        for (int x = 0; x < columns; ++x) {
+            // Loudest bucket under this column, so short transients stay visible
+            const int first = static_cast<int>(static_cast<qint64>(x) * count / columns);
+            const int last = std::max(first + 1, static_cast<int>(static_cast<qint64>(x + 1) * count / columns));
+            uchar peak = 0;
+            uchar rms = 0;
+            for (int i = first; i < last && i < count; ++i) {
+                peak = std::max(peak, static_cast<uchar>(m_peaks[i]));
+                rms = std::max(rms, static_cast<uchar>(m_rms[i]));
+            }
+            const qreal px = x / ratio;
+            const qreal peakHeight = std::max(0.5, peak / 255.0 * middle);
+            const qreal rmsHeight = rms / 255.0 * middle;
+            painter.fillRect(QRectF(px, middle - peakHeight, 1.0 / ratio, 2 * peakHeight), peakColor);
+            painter.fillRect(QRectF(px, middle - rmsHeight, 1.0 / ratio, 2 * rmsHeight), color);
+        }
+        painter.end();
+        return pixmap;
+    };
+    m_played = render(palette().color(QPalette::Highlight));
+    m_remaining = render(palette().color(QPalette::Mid));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QSlider>
+#include <QByteArray>
+#include <QPixmap>
+#include <QUuid>
+
+class QPaintEvent;
+class QResizeEvent;
+class QEvent;
+
+// Seek slider drawn over the song's waveform overview (audio::WaveformOverview): the part
+// before the handle in the highlight colour, the rest muted. The outline is rendered to
+// two pixmaps on size or palette changes, so a position update only blits them. Without
+// an outline for the current song it paints as a plain QSlider.
+class WaveformSlider : public QSlider {
+    Q_OBJECT
+
+public:
+    explicit WaveformSlider(QWidget* parent = nullptr);
+
+    // The song now playing; shows its outline if it already arrived, else clears
+    void setSong(const QUuid& songId);
+
+public slots:
+    // 0..255 per bucket, peaks and rms the same length. An outline for another song is
+    // kept for the next setSong(), since it can arrive before the song change does
+    void setWaveform(const QUuid& songId, const QByteArray& peaks, const QByteArray& rms);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void changeEvent(QEvent* event) override;
+
+private:
+    void renderPixmaps();
+
+    QUuid m_songId;
+    QByteArray m_peaks;
+    QByteArray m_rms;
+    // One outline that arrived ahead of its song
+    QUuid m_pendingSongId;
+    QByteArray m_pendingPeaks;
+    QByteArray m_pendingRms;
+    QPixmap m_played;
+    QPixmap m_remaining;
+};
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace util {
+template <typename T> class AsyncPromise;
+
+/**
+ * @brief Outcome of an operation that completes later, observed through continuations
+ * instead of a blocked thread.
+ *
+ * then() queues a callback that runs once the result is set: right away on the calling
+ * thread if it already is, otherwise on the thread that sets it. A pending operation thus
+ * costs its state and its callbacks, not a waiting thread, however many there are.
+ * Callbacks run inline, so they should be short and hand longer work to an executor.
+ *
+ * Copies share one state and any number of continuations may be attached. wait() and get()
+ * block, for callers that have a thread to spare; toFuture() and toSharedFuture() bridge
+ * to std::future based APIs. Thread-safe.
+ */
+template <typename T>
+class AsyncResult {
+    using Stored = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    struct State {
+        std::mutex mutex;
+        std::condition_variable set;
+        std::optional<Stored> value;
+        std::exception_ptr error;
+        bool ready = false;
+        std::vector<std::function<void()>> continuations;
+    };
+
+public:
+    AsyncResult() = default;
+
+    // Already completed, for operations answered without waiting (cache hits, errors)
+    template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    static AsyncResult fromValue(U value) {
+        AsyncResult result(std::make_shared<State>());
+        result.state_->value.emplace(std::move(value));
+        result.state_->ready = true;
+        return result;
+    }
+    template <typename U = T, typename = std::enable_if_t<std::is_void_v<U>>>
+    static AsyncResult fromValue() {
+        AsyncResult result(std::make_shared<State>());
+        result.state_->value.emplace();
+        result.state_->ready = true;
+        return result;
+    }
+    static AsyncResult fromException(std::exception_ptr error) {
+        AsyncResult result(std::make_shared<State>());
+        result.state_->error = std::move(error);
+        result.state_->ready = true;
+        return result;
+    }
+
+    bool valid() const { return state_ != nullptr; }
+
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->ready;
+    }
+
+    // Completed with an exception
+    bool failed() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->ready && state_->error;
+    }
+
+    // Run callback(const AsyncResult<T>&) once completed; see the class comment for where
+    template <typename F>
+    void then(F&& callback) const {
+        auto run = [result = *this, callback = std::forward<F>(callback)]() mutable { callback(result); };
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (!state_->ready) {
+                state_->continuations.emplace_back(std::move(run));
+                return;
+            }
+        }
+        run();
+    }
+
+    void wait() const {
+        std::unique_lock<std::mutex> lock(state_->mutex);
+        state_->set.wait(lock, [this]() { return state_->ready; });
+    }
+
+    // The value, or the exception rethrown; blocks until completed
+    template <typename U = T>
+    std::enable_if_t<!std::is_void_v<U>, const U&> get() const {
+        wait();
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+        return *state_->value;
+    }
+    template <typename U = T>
+    std::enable_if_t<std::is_void_v<U>> get() const {
+        wait();
+        if (state_->error) {
+            std::rethrow_exception(state_->error);
+        }
+    }
+
+    // The exception completed with, null on success or while pending
+    std::exception_ptr exception() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->error;
+    }
+
+    std::shared_future<T> toSharedFuture() const { return toFuture().share(); }
+
+    std::future<T> toFuture() const {
+        auto promise = std::make_shared<std::promise<T>>();
+        std::future<T> future = promise->get_future();
+        then([promise](const AsyncResult& result) {
+            if (std::exception_ptr error = result.exception()) {
+                promise->set_exception(error);
+            } else if constexpr (std::is_void_v<T>) {
+                promise->set_value();
+            } else {
+                promise->set_value(result.get());
+            }
+        });
+        return future;
+    }
+
+private:
+    friend class AsyncPromise<T>;
+
+    explicit AsyncResult(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    // First completion wins; false if already completed
+    bool complete(std::optional<Stored> value, std::exception_ptr error) const {
+        std::vector<std::function<void()>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (state_->ready) {
+                return false;
+            }
+            state_->value = std::move(value);
+            state_->error = std::move(error);
+            state_->ready = true;
+            continuations.swap(state_->continuations);
+        }
+        state_->set.notify_all();
+        for (auto& continuation : continuations) {
+            continuation();
+        }
+        return true;
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Producer side of an AsyncResult. Copies complete the same result; the first
+ * completion wins and later ones return false. If the last copy goes away without
+ * completing, the result fails with std::future_errc::broken_promise, so no continuation
+ * is left waiting forever.
+ */
+template <typename T>
+class AsyncPromise {
+public:
+    AsyncPromise() : owner_(std::make_shared<Owner>()) {}
+
+    AsyncResult<T> result() const { return owner_->result; }
+
+    template <typename U = T>
+    std::enable_if_t<!std::is_void_v<U>, bool> setValue(U value) const {
+        return owner_->result.complete(std::move(value), nullptr);
+    }
+    template <typename U = T>
+    std::enable_if_t<std::is_void_v<U>, bool> setValue() const {
+        return owner_->result.complete(std::monostate{}, nullptr);
+    }
+    bool setException(std::exception_ptr error) const {
+        return owner_->result.complete(std::nullopt, std::move(error));
+    }
+
+private:
+    struct Owner {
+        AsyncResult<T> result{ std::make_shared<typename AsyncResult<T>::State>() };
+        ~Owner() {
+            result.complete(std::nullopt,
+                            std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    };
+    std::shared_ptr<Owner> owner_;
+};
+
+// Completes once every one of results has, successful or not; inspect them for failures
+template <typename T>
+AsyncResult<void> whenAll(const std::vector<AsyncResult<T>>& results) {
+    if (results.empty()) {
+        return AsyncResult<void>::fromValue();
+    }
+    AsyncPromise<void> promise;
+    auto remaining = std::make_shared<std::atomic<size_t>>(results.size());
+    for (const auto& result : results) {
+        result.then([promise, remaining](const AsyncResult<T>&) {
+            if (--*remaining == 0) {
+                promise.setValue();
+            }
+        });
+    }
+    return promise.result();
+}
+}
@@ -0,0 +1,416 @@
+#include "audio_cache_store.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <log/log_manager.h>
+
+namespace fs = std::filesystem;
+
+namespace util {
+
+namespace {
+// First line of the index; a different one means a format we can't read
+constexpr const char* INDEX_HEADER = "audio-cache-index 2";
+// Same lines without the compacted column
+constexpr const char* INDEX_HEADER_V1 = "audio-cache-index 1";
+}
+
+AudioCacheStore::AudioCacheStore(const std::filesystem::path& directory, uint64_t budgetBytes)
+    : directory_(directory.lexically_normal())
+    , budget_(budgetBytes) {
+    // "dir/" normalizes to "dir/" with an empty file name; compare against "dir"
+    if (!directory_.has_filename() && directory_.has_parent_path()) {
+        directory_ = directory_.parent_path();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    load_unsafe();
+    evict_unsafe(std::string());
+    if (dirty_) {
+        save_unsafe();
+    }
+}
+
+AudioCacheStore::~AudioCacheStore() {
+    flush();
+}
+
+std::string AudioCacheStore::pathFor(const std::string& name) const {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    return (directory_ / fs::u8path(name)).generic_u8string();
+}
+
+void AudioCacheStore::setBudget(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    evict_unsafe(std::string());
+    if (dirty_) {
+        save_unsafe();
+    }
+}
+
+uint64_t AudioCacheStore::budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+bool AudioCacheStore::manages(const std::string& path) const {
+    return !nameOf(path).empty();
+}
+
+bool AudioCacheStore::contains(const std::string& path) {
+    return check(path, false);
+}
+
+bool AudioCacheStore::open(const std::string& path) {
+    return check(path, true);
+}
+
+bool AudioCacheStore::commit(const std::string& path) {
+    const std::string name = nameOf(path);
+    if (name.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry entry;
+    const bool exists = stat_unsafe(name, entry);
+    auto it = entries_.find(name);
+    if (it != entries_.end()) {
+        total_ -= it->second.size;
+        entries_.erase(it);
+        dirty_ = true;
+    }
+    if (exists) {
+        entry.lastAccess = touch_unsafe();
+        entries_[name] = entry;
+        total_ += entry.size;
+        dirty_ = true;
+        evict_unsafe(name);
+    }
+    save_unsafe();
+    return exists;
+}
+
+bool AudioCacheStore::remove(const std::string& path) {
+    const std::string name = nameOf(path);
+    if (name.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    fs::remove(directory_ / fs::u8path(name), ec);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        return false;
+    }
+    total_ -= it->second.size;
+    entries_.erase(it);
+    dirty_ = true;
+    save_unsafe();
+    return true;
+}
+
+std::vector<AudioCacheStore::ColdEntry> AudioCacheStore::coldEntries(std::chrono::milliseconds minIdle,
+                                                                     size_t maxCount) const {
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t usedBefore = now - static_cast<int64_t>(minIdle.count());
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<int64_t, std::string>> order;
+    for (const auto& [name, entry] : entries_) {
+        if (!entry.compacted && entry.lastAccess < usedBefore) {
+            order.emplace_back(entry.lastAccess, name);
+        }
+    }
+    std::sort(order.begin(), order.end());
+    if (order.size() > maxCount) {
+        order.resize(maxCount);
+    }
+
+    std::vector<ColdEntry> cold;
+    cold.reserve(order.size());
+    for (const auto& [lastAccess, name] : order) {
+        const Entry& entry = entries_.at(name);
+        cold.push_back(ColdEntry{(directory_ / fs::u8path(name)).generic_u8string(), entry.size, entry.mtime});
+    }
+    return cold;
+}
+
+bool AudioCacheStore::replace(const ColdEntry& original, const std::string& replacementPath) {
+    const fs::path replacement = fs::u8path(replacementPath);
+    const std::string name = nameOf(original.path);
+    std::error_code ec;
+    if (name.empty()) {
+        fs::remove(replacement, ec);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    Entry current;
+    if (it == entries_.end() || it->second.size != original.size || it->second.mtime != original.mtime
+        || !stat_unsafe(name, current) || current.size != original.size || current.mtime != original.mtime) {
+        fs::remove(replacement, ec);
+        return false;
+    }
+    // The rename is atomic; the index is saved right after. A crash in between leaves a
+    // file that open() drops as changed, never one indexed with the wrong size
+    fs::rename(replacement, directory_ / fs::u8path(name), ec);
+    if (ec) {
+        LOG_DEBUG("Can't replace audio cache file {} yet: {}", name, ec.message());
+        fs::remove(replacement, ec);
+        return false;
+    }
+    Entry replaced;
+    total_ -= it->second.size;
+    if (!stat_unsafe(name, replaced)) {
+        entries_.erase(it);
+        dirty_ = true;
+        save_unsafe();
+        return false;
+    }
+    replaced.lastAccess = it->second.lastAccess;
+    replaced.compacted = true;
+    it->second = replaced;
+    total_ += replaced.size;
+    dirty_ = true;
+    save_unsafe();
+    return true;
+}
+
+void AudioCacheStore::markCompacted(const std::string& path) {
+    const std::string name = nameOf(path);
+    if (name.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    if (it != entries_.end() && !it->second.compacted) {
+        it->second.compacted = true;
+        dirty_ = true;
+    }
+}
+
+uint64_t AudioCacheStore::totalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+size_t AudioCacheStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+bool AudioCacheStore::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !dirty_ || save_unsafe();
+}
+
+/*************** Private Methods ***************/
+std::string AudioCacheStore::nameOf(const std::string& path) const {
+    if (path.empty()) {
+        return std::string();
+    }
+    const fs::path file = fs::u8path(path).lexically_normal();
+    if (!file.has_filename() || file.parent_path() != directory_) {
+        return std::string();
+    }
+    return file.filename().u8string();
+}
+
+bool AudioCacheStore::check(const std::string& path, bool touch) {
+    const std::string name = nameOf(path);
+    if (name.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry current;
+    const bool exists = stat_unsafe(name, current);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        if (!exists) {
+            return false;
+        }
+        // Finished by a session that exited before saving its commit
+        current.lastAccess = touch_unsafe();
+        entries_[name] = current;
+        total_ += current.size;
+        dirty_ = true;
+        evict_unsafe(name);
+        save_unsafe();
+        return true;
+    }
+    if (!exists || it->second.size != current.size || it->second.mtime != current.mtime) {
+        if (exists) {
+            // Truncated or rewritten behind our back; a fresh download will replace it
+            LOG_WARN("Dropping changed audio cache file {} ({} bytes, indexed {})",
+                     name, current.size, it->second.size);
+            std::error_code ec;
+            fs::remove(directory_ / fs::u8path(name), ec);
+        }
+        total_ -= it->second.size;
+        entries_.erase(it);
+        dirty_ = true;
+        save_unsafe();
+        return false;
+    }
+    if (touch) {
+        it->second.lastAccess = touch_unsafe();
+        dirty_ = true;
+    }
+    return true;
+}
+
+void AudioCacheStore::load_unsafe() {
+    std::ifstream file(directory_ / INDEX_FILE, std::ios::binary);
+    std::string line;
+    if (!file.is_open() || !std::getline(file, line) || (line != INDEX_HEADER && line != INDEX_HEADER_V1)) {
+        scan_unsafe();
+        return;
+    }
+    const bool hasCompacted = line == INDEX_HEADER;
+    // name \t size \t mtime \t last access \t compacted
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        Entry entry;
+        int compacted = 0;
+        if (!std::getline(fields, name, '\t') || name.empty()
+            || !(fields >> entry.size >> entry.mtime >> entry.lastAccess)
+            || (hasCompacted && !(fields >> compacted))) {
+            continue;
+        }
+        entry.compacted = compacted != 0;
+        auto [it, inserted] = entries_.emplace(std::move(name), entry);
+        if (inserted) {
+            total_ += entry.size;
+            clock_ = std::max(clock_, entry.lastAccess);
+        }
+    }
+}
+
+void AudioCacheStore::scan_unsafe() {
+    std::error_code ec;
+    std::vector<std::pair<std::string, Entry>> found;
+    for (fs::directory_iterator it(directory_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != FILE_EXTENSION) {
+            continue;
+        }
+        std::string name = it->path().filename().u8string();
+        Entry entry;
+        if (stat_unsafe(name, entry)) {
+            found.emplace_back(std::move(name), entry);
+        }
+    }
+    if (found.empty()) {
+        return;
+    }
+    // Play history is unknown: order by age so the oldest downloads go first, and
+    // behind anything played from now on
+    std::sort(found.begin(), found.end(),
+              [](const auto& a, const auto& b) { return a.second.mtime < b.second.mtime; });
+    int64_t order = 0;
+    for (auto& [name, entry] : found) {
+        entry.lastAccess = ++order;
+        total_ += entry.size;
+        entries_.emplace(std::move(name), entry);
+    }
+    dirty_ = true;
+    LOG_INFO("Indexed {} audio cache files ({} bytes) in {}", entries_.size(), total_, directory_.u8string());
+}
+
+bool AudioCacheStore::stat_unsafe(const std::string& name, Entry& entry) const {
+    std::error_code ec;
+    const fs::path file = directory_ / fs::u8path(name);
+    if (!fs::is_regular_file(file, ec)) {
+        return false;
+    }
+    const uintmax_t size = fs::file_size(file, ec);
+    if (ec) {
+        return false;
+    }
+    const auto mtime = fs::last_write_time(file, ec);
+    if (ec) {
+        return false;
+    }
+    entry.size = static_cast<uint64_t>(size);
+    entry.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+    return true;
+}
+
+int64_t AudioCacheStore::touch_unsafe() {
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    clock_ = std::max(now, clock_ + 1);
+    return clock_;
+}
+
+void AudioCacheStore::evict_unsafe(const std::string& keep) {
+    if (budget_ == 0 || total_ <= budget_) {
+        return;
+    }
+    std::vector<std::pair<int64_t, std::string>> order;
+    order.reserve(entries_.size());
+    for (const auto& [name, entry] : entries_) {
+        if (name != keep) {
+            order.emplace_back(entry.lastAccess, name);
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    size_t evicted = 0;
+    for (const auto& [lastAccess, name] : order) {
+        if (total_ <= budget_) {
+            break;
+        }
+        std::error_code ec;
+        fs::remove(directory_ / fs::u8path(name), ec);
+        if (ec) {
+            continue;   // In use; try again next time
+        }
+        auto it = entries_.find(name);
+        total_ -= it->second.size;
+        entries_.erase(it);
+        dirty_ = true;
+        ++evicted;
+    }
+    if (evicted > 0) {
+        LOG_INFO("Evicted {} audio cache files, {} of {} bytes in use", evicted, total_, budget_);
+    }
+}
+
+bool AudioCacheStore::save_unsafe() {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    // Write a sibling file and swap it in so a crash never leaves a truncated index
+    const fs::path path = directory_ / INDEX_FILE;
+    fs::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARN("Failed to open audio cache index for writing: {}", tempPath.u8string());
+            return false;
+        }
+        file << INDEX_HEADER << '\n';
+        for (const auto& [name, entry] : entries_) {
+            file << name << '\t' << entry.size << '\t' << entry.mtime << '\t' << entry.lastAccess
+                 << '\t' << (entry.compacted ? 1 : 0) << '\n';
+        }
+        if (!file) {
+            LOG_WARN("Failed to write audio cache index: {}", tempPath.u8string());
+            return false;
+        }
+    }
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        LOG_WARN("Failed to replace audio cache index {}: {}", path.u8string(), ec.message());
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    dirty_ = false;
+    return true;
+}
+
+}
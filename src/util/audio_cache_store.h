@@ -0,0 +1,132 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace util {
+/**
+ * @brief Index of the finished audio files in the audio cache directory, kept within a
+ * byte budget by evicting the least recently played.
+ *
+ * Entries are keyed by file name and record size, modification time and last access.
+ * The index lives in INDEX_FILE next to the files, so startup reads one small file
+ * instead of stat'ing the directory; only a missing or unreadable index triggers a
+ * one-time scan, which adopts the `.audio` files found. open() checks an entry's size
+ * and modification time against the index, so a truncated or replaced file is dropped
+ * instead of handed to the decoder. Touches are written back by flush() (and on
+ * destruction); adds and removals are written immediately.
+ *
+ * A file that can't be deleted (open by the player on Windows) keeps its entry and is
+ * tried again on the next eviction. A budget of 0 disables eviction. Thread-safe.
+ *
+ * Files can be rewritten in place (e.g. transcoded to a smaller format): coldEntries()
+ * lists the least recently played ones not compacted yet, and replace() swaps a rewritten
+ * copy in under the index lock, keeping the entry's place in the eviction order. Entries
+ * replaced, or marked with markCompacted(), aren't listed again until recommitted.
+ */
+class AudioCacheStore {
+public:
+    static constexpr const char* INDEX_FILE = "audio_cache_index.txt";
+    static constexpr const char* FILE_EXTENSION = ".audio";
+
+    // Reads the index (or scans directory) and evicts down to budgetBytes
+    explicit AudioCacheStore(const std::filesystem::path& directory, uint64_t budgetBytes = 0);
+    ~AudioCacheStore();
+
+    AudioCacheStore(const AudioCacheStore&) = delete;
+    AudioCacheStore& operator=(const AudioCacheStore&) = delete;
+
+    const std::filesystem::path& directory() const { return directory_; }
+    // Full path of a cache file name; the directory is created if needed
+    std::string pathFor(const std::string& name) const;
+
+    // Evicts right away when the store is over the new budget
+    void setBudget(uint64_t bytes);
+    uint64_t budget() const;
+
+    // Whether path names a file directly inside the cache directory
+    bool manages(const std::string& path) const;
+
+    /**
+     * @brief Whether path is an intact cached file, marking it recently used.
+     *
+     * A file in the directory but missing from the index (finished by an earlier session
+     * before its commit was saved) is adopted. An entry whose file is gone or changed
+     * size or modification time is dropped, and a changed file deleted.
+     */
+    bool open(const std::string& path);
+    // open() without marking the file used, for checks that don't play it
+    bool contains(const std::string& path);
+
+    /**
+     * @brief Record a finished file at path, then evict down to the budget.
+     * @return false if path isn't a file in the cache directory
+     */
+    bool commit(const std::string& path);
+
+    // Delete a cached file and its entry; true if an entry was removed
+    bool remove(const std::string& path);
+
+    // A cached file as indexed when listed, so replace() can tell it's still the same
+    struct ColdEntry {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    // Up to maxCount entries not compacted and not opened within minIdle, least recently
+    // used first
+    std::vector<ColdEntry> coldEntries(std::chrono::milliseconds minIdle, size_t maxCount) const;
+
+    /**
+     * @brief Move replacementPath over a cached file and index it as compacted.
+     *
+     * The entry keeps its last access. Refused if the file was removed, recommitted or
+     * changed since coldEntries() listed it, or can't be overwritten (open by the player
+     * on Windows); replacementPath is deleted either way.
+     * @return true if the replacement is in place
+     */
+    bool replace(const ColdEntry& original, const std::string& replacementPath);
+
+    // Keep a file out of coldEntries() as it is, e.g. when rewriting it wouldn't save space
+    void markCompacted(const std::string& path);
+
+    uint64_t totalBytes() const;
+    size_t size() const;
+
+    // Write pending touches; true if nothing needed writing or it succeeded
+    bool flush();
+
+private:
+    struct Entry {
+        uint64_t size = 0;
+        int64_t mtime = 0;          // file_time_type ticks
+        int64_t lastAccess = 0;     // Milliseconds since the epoch
+        bool compacted = false;     // Replaced, or not worth replacing
+    };
+
+    // Cache file name of path, empty if path isn't directly inside the directory
+    std::string nameOf(const std::string& path) const;
+    bool check(const std::string& path, bool touch);
+    void load_unsafe();
+    void scan_unsafe();
+    // Stat name into entry; false if it isn't a regular file
+    bool stat_unsafe(const std::string& name, Entry& entry) const;
+    int64_t touch_unsafe();
+    void evict_unsafe(const std::string& keep);
+    bool save_unsafe();
+
+    mutable std::mutex mutex_;
+    std::filesystem::path directory_;
+    uint64_t budget_;
+    uint64_t total_ = 0;
+    std::unordered_map<std::string, Entry> entries_;
+    bool dirty_ = false;
+    int64_t clock_ = 0;             // Latest access handed out, so touches in the same tick still order
+};
+}
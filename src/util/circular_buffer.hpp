@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <stdexcept>
 #include <algorithm>
+#include <utility>
 
 namespace util {
 /**
@@ -81,6 +82,38 @@ public:
         return totalRead;
     }
 
+    // Drop up to count of the oldest elements without copying them out
+    size_t discard(size_t count) {
+        size_t dropped = std::min(count, size());
+        if (dropped > 0) {
+            read_pos_ = (read_pos_ + dropped) % capacity_;
+            full_ = false;
+        }
+        return dropped;
+    }
+
+    void clear() {
+        read_pos_ = write_pos_ = 0;
+        full_ = false;
+    }
+
+    // Largest contiguous free region at the write position, for producers that fill the
+    // buffer in place (e.g. istream::read straight into it). Publish what was stored with
+    // commit(). The region stays valid until the next write(), push(), commit() or clear().
+    std::pair<T*, size_t> writableSpan() {
+        size_t space = full_ ? 0 :
+                    (write_pos_ >= read_pos_ ? capacity_ - write_pos_ : read_pos_ - write_pos_);
+        return {buffer_.data() + write_pos_, space};
+    }
+
+    // Make count elements written into writableSpan() readable
+    void commit(size_t count) {
+        count = std::min(count, capacity_ - size());
+        if (count == 0) return;
+        write_pos_ = (write_pos_ + count) % capacity_;
+        full_ = write_pos_ == read_pos_;
+    }
+
 
     bool empty() const { return !full_ && (read_pos_ == write_pos_); }
     bool full() const { return full_; }
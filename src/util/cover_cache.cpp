@@ -1,11 +1,16 @@
 #include "cover_cache.h"
 #include <config/config_manager.h>
+#include <util/hash.h>
 #include <util/md5.h>
 #include <log/log_manager.h>
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QStandardPaths>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace util
 {
@@ -14,7 +19,9 @@ namespace util
     {
         if (!m_configManager) {
             LOG_WARN("CoverCache created with null ConfigManager");
+            return;
         }
+        m_budgetBytes = static_cast<int64_t>(std::max(0, m_configManager->getCoverCacheBudgetMB())) * 1024 * 1024;
     }
 
     CoverCache::~CoverCache()
@@ -25,8 +32,13 @@ namespace util
     QString CoverCache::generateCacheKey(const QString& filePathOrUrl)
     {
         std::string input = filePathOrUrl.toStdString();
-        std::string hash = util::md5Hash(input);
-        return QString::fromStdString(hash);
+        return QString::fromStdString(util::hashHex(input));
+    }
+
+    QString CoverCache::legacyCacheKey(const QString& filePathOrUrl)
+    {
+        std::string input = filePathOrUrl.toStdString();
+        return QString::fromStdString(util::md5Hash(input));
     }
 
     QString CoverCache::detectImageFormat(const QByteArray& data)
@@ -66,10 +78,9 @@ namespace util
             return false;
         }
 
-        QString fullPath = m_configManager->getAbsolutePath(coverCacheDir);
         QDir dir;
-        if (!dir.mkpath(fullPath)) {
-            LOG_ERROR("CoverCache: Failed to create cache directory: {}", fullPath.toStdString());
+        if (!dir.mkpath(coverCacheDir)) {
+            LOG_ERROR("CoverCache: Failed to create cache directory: {}", coverCacheDir.toStdString());
             return false;
         }
 
@@ -87,53 +98,38 @@ namespace util
             return "";
         }
 
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = findEntry_unsafe(filePathOrUrl);
+            if (it != m_entries.end()) {
+                return entryPath_unsafe(it);
+            }
+        }
+
         QString key = generateCacheKey(filePathOrUrl);
         // We'll use jpg as default, but actual extension is determined on save
-        return QDir(fullCacheDir).filePath(QString("%1.jpg").arg(key));
+        return QDir(coverCacheDir).filePath(QString("%1.jpg").arg(key));
     }
 
     bool CoverCache::hasCachedCover(const QString& filePathOrUrl) const
     {
-        if (!ensureCacheDirectoryExists()) {
-            return false;
-        }
-
-        QString key = generateCacheKey(filePathOrUrl);
-        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
-
-        // Check for any file with this key (different extensions possible)
-        QDir dir(fullCacheDir);
-        QStringList filters;
-        filters << QString("%1.*").arg(key);
-        QStringList files = dir.entryList(filters);
-
-        return !files.isEmpty();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return findEntry_unsafe(filePathOrUrl) != m_entries.end();
     }
 
     std::optional<QByteArray> CoverCache::getCachedCover(const QString& filePathOrUrl) const
     {
-        if (!ensureCacheDirectoryExists()) {
-            return std::nullopt;
+        QString cachedFile;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            cachedFile = locate_unsafe(filePathOrUrl);
         }
 
-        QString key = generateCacheKey(filePathOrUrl);
-        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
-
-        // Find the cached file (any extension)
-        QDir dir(fullCacheDir);
-        QStringList filters;
-        filters << QString("%1.*").arg(key);
-        QStringList files = dir.entryList(filters);
-
-        if (files.isEmpty()) {
+        if (cachedFile.isEmpty()) {
             LOG_DEBUG("CoverCache: No cached cover for {}", filePathOrUrl.toStdString());
             return std::nullopt;
         }
 
-        QString cachedFile = dir.filePath(files[0]);
         QFile file(cachedFile);
 
         if (!file.open(QIODevice::ReadOnly)) {
@@ -148,6 +144,16 @@ namespace util
         return data;
     }
 
+    std::optional<QString> CoverCache::findCachedCover(const QString& filePathOrUrl) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        QString cachedFile = locate_unsafe(filePathOrUrl);
+        if (cachedFile.isEmpty()) {
+            return std::nullopt;
+        }
+        return cachedFile;
+    }
+
     std::optional<QString> CoverCache::saveCover(const QString& filePathOrUrl, const QByteArray& coverData)
     {
         if (!ensureCacheDirectoryExists()) {
@@ -162,8 +168,7 @@ namespace util
 
         QString key = generateCacheKey(filePathOrUrl);
         QString extension = detectImageFormat(coverData);
-        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
+        QString fullCacheDir = m_configManager->getCoverCacheDirectory();
         QString cachePath = QDir(fullCacheDir).filePath(QString("%1.%2").arg(key, extension));
 
         QFile file(cachePath);
@@ -182,6 +187,23 @@ namespace util
             return std::nullopt;
         }
 
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // A first scan may already have picked up the file written above
+            QString directory = indexedDirectory_unsafe();
+            auto it = m_entries.find(key);
+            if (it != m_entries.end()) {
+                m_totalBytes -= it->second.size;
+                if (it->second.extension != extension) {
+                    QFile::remove(QDir(directory).filePath(QString("%1.%2").arg(key, it->second.extension)));
+                }
+                m_entries.erase(it);
+            }
+            m_entries.emplace(key, Entry{ extension, written, touch_unsafe() });
+            m_totalBytes += written;
+            evict_unsafe(key);
+        }
+
         LOG_INFO("CoverCache: Saved cover cache for {} at {}", 
                 filePathOrUrl.toStdString(), cachePath.toStdString());
         return cachePath;
@@ -189,22 +211,17 @@ namespace util
 
     bool CoverCache::removeCachedCover(const QString& filePathOrUrl)
     {
-        QString key = generateCacheKey(filePathOrUrl);
-        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
-
-        QDir dir(fullCacheDir);
-        QStringList filters;
-        filters << QString("%1.*").arg(key);
-        QStringList files = dir.entryList(filters);
-
-        if (files.isEmpty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = findEntry_unsafe(filePathOrUrl);
+        if (it == m_entries.end()) {
             LOG_DEBUG("CoverCache: No cached cover to remove for {}", filePathOrUrl.toStdString());
             return false;
         }
 
-        QString cachedFile = dir.filePath(files[0]);
-        if (QFile(cachedFile).remove()) {
+        QString cachedFile = entryPath_unsafe(it);
+        if (QFile(cachedFile).remove() || !QFile::exists(cachedFile)) {
+            m_totalBytes -= it->second.size;
+            m_entries.erase(it);
             LOG_INFO("CoverCache: Removed cached cover: {}", cachedFile.toStdString());
             return true;
         } else {
@@ -215,8 +232,8 @@ namespace util
 
     int CoverCache::clearCache()
     {
-        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        QString fullCacheDir = m_configManager->getCoverCacheDirectory();
         QDir dir(fullCacheDir);
 
         if (!dir.exists()) {
@@ -232,28 +249,154 @@ namespace util
             }
         }
 
+        // Files that couldn't be deleted are picked up again
+        scan_unsafe(fullCacheDir);
         LOG_INFO("CoverCache: Cleared cache, removed {} files", removed);
         return removed;
     }
 
     int64_t CoverCache::getCacheSizeBytes() const
     {
-        QString coverCacheDir = m_configManager->getCoverCacheDirectory();
-        QString fullCacheDir = m_configManager->getAbsolutePath(coverCacheDir);
-        QDir dir(fullCacheDir);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        indexedDirectory_unsafe();
+        return m_totalBytes;
+    }
 
-        if (!dir.exists()) {
-            return 0;
+    void CoverCache::setBudgetBytes(int64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_budgetBytes = std::max<int64_t>(0, bytes);
+        evict_unsafe(QString());
+    }
+
+    int64_t CoverCache::budgetBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_budgetBytes;
+    }
+
+    /*************** Private Methods ***************/
+    QString CoverCache::indexedDirectory_unsafe() const
+    {
+        if (!m_configManager) {
+            return QString();
         }
+        QString directory = m_configManager->getCoverCacheDirectory();
+        if (!m_indexed || directory != m_indexedDirectory) {
+            scan_unsafe(directory);
+        }
+        return directory;
+    }
 
-        int64_t totalSize = 0;
-        QStringList files = dir.entryList(QDir::Files);
+    void CoverCache::scan_unsafe(const QString& directory) const
+    {
+        m_entries.clear();
+        m_totalBytes = 0;
+        m_indexedDirectory = directory;
+        m_indexed = true;
+        if (directory.isEmpty()) {
+            return;
+        }
 
-        for (const auto& file : files) {
-            QFileInfo fileInfo(dir.filePath(file));
-            totalSize += fileInfo.size();
+        QDir dir(directory);
+        const QFileInfoList files = dir.entryInfoList(QDir::Files);
+        for (const QFileInfo& info : files) {
+            // Files are named {key}.{extension}
+            QString key = info.fileName().section('.', 0, 0);
+            QDateTime lastUsed = std::max(info.lastRead(), info.lastModified());
+            Entry entry{ info.fileName().section('.', 1), info.size(), lastUsed.toMSecsSinceEpoch() };
+
+            auto it = m_entries.find(key);
+            if (it != m_entries.end()) {
+                // Left behind by a save with another format; the newer file is the one in use
+                const bool keepNew = entry.lastAccess > it->second.lastAccess;
+                const Entry& stale = keepNew ? it->second : entry;
+                if (!QFile::remove(dir.filePath(QString("%1.%2").arg(key, stale.extension)))) {
+                    continue;
+                }
+                if (!keepNew) {
+                    continue;
+                }
+                m_totalBytes -= it->second.size;
+                m_entries.erase(it);
+            }
+            m_totalBytes += entry.size;
+            m_entries.emplace(key, std::move(entry));
+        }
+        LOG_DEBUG("CoverCache: Indexed {} covers ({} bytes) in {}", m_entries.size(), m_totalBytes, directory.toStdString());
+    }
+
+    CoverCache::EntryMap::iterator CoverCache::findEntry_unsafe(const QString& filePathOrUrl) const
+    {
+        indexedDirectory_unsafe();
+        auto it = m_entries.find(generateCacheKey(filePathOrUrl));
+        if (it == m_entries.end() && !m_entries.empty()) {
+            it = m_entries.find(legacyCacheKey(filePathOrUrl));
+        }
+        return it;
+    }
+
+    QString CoverCache::entryPath_unsafe(EntryMap::const_iterator it) const
+    {
+        return QDir(m_indexedDirectory).filePath(QString("%1.%2").arg(it->first, it->second.extension));
+    }
+
+    QString CoverCache::locate_unsafe(const QString& filePathOrUrl) const
+    {
+        auto it = findEntry_unsafe(filePathOrUrl);
+        if (it == m_entries.end()) {
+            return QString();
         }
+        QString path = entryPath_unsafe(it);
+        // Deleted behind our back (the user emptied the folder)
+        if (!QFileInfo::exists(path)) {
+            m_totalBytes -= it->second.size;
+            m_entries.erase(it);
+            return QString();
+        }
+        it->second.lastAccess = touch_unsafe();
+        return path;
+    }
+
+    int64_t CoverCache::touch_unsafe() const
+    {
+        m_clock = std::max(QDateTime::currentMSecsSinceEpoch(), m_clock + 1);
+        return m_clock;
+    }
 
-        return totalSize;
+    void CoverCache::evict_unsafe(const QString& keep)
+    {
+        if (m_budgetBytes <= 0 || m_totalBytes <= m_budgetBytes) {
+            return;
+        }
+
+        std::vector<std::pair<int64_t, QString>> byAccess;
+        byAccess.reserve(m_entries.size());
+        for (const auto& [key, entry] : m_entries) {
+            if (key != keep) {
+                byAccess.emplace_back(entry.lastAccess, key);
+            }
+        }
+        std::sort(byAccess.begin(), byAccess.end());
+
+        QDir dir(m_indexedDirectory);
+        int evicted = 0;
+        for (const auto& [lastAccess, key] : byAccess) {
+            if (m_totalBytes <= m_budgetBytes) {
+                break;
+            }
+            auto it = m_entries.find(key);
+            QString path = dir.filePath(QString("%1.%2").arg(key, it->second.extension));
+            // A file that can't be deleted (open elsewhere) is tried again next time
+            if (!QFile::remove(path) && QFile::exists(path)) {
+                continue;
+            }
+            m_totalBytes -= it->second.size;
+            m_entries.erase(it);
+            ++evicted;
+        }
+        if (evicted > 0) {
+            LOG_DEBUG("CoverCache: Evicted {} covers, {} of {} bytes used", evicted, m_totalBytes, m_budgetBytes);
+        }
     }
 }
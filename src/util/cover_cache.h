@@ -2,8 +2,11 @@
 
 #include <QString>
 #include <QByteArray>
+#include <cstdint>
 #include <optional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 // Forward declaration
 class ConfigManager;
@@ -14,14 +17,23 @@ namespace util
      * @brief Cover image cache manager for local and streaming media
      * 
      * Manages persistent caching of cover images extracted from audio files.
-     * Uses MD5 hash of file path/URL as cache key.
+     * Uses the XXH3 128-bit hash (util/hash.h) of file path/URL as cache key; covers
+     * saved under the MD5 names of earlier versions are still found by lookups.
      * 
      * Cache location: `{workspace_cache_dir}/covers/`
-     * Cache files: `{md5_hash}.{extension}` (e.g., `abc123def.jpg`)
+     * Cache files: `{hash}.{extension}` (e.g., `abc123def.jpg`)
+     *
+     * Lookups go through an in-memory index of key -> (extension, size, last access),
+     * built by one scan of the directory on first use (and again when the configured
+     * directory changes), then kept up to date by saves and removals. Over the byte
+     * budget the least recently used covers are deleted; 0 means unlimited. Share one
+     * instance per directory, since files another instance adds are not seen until the
+     * next rescan. Thread-safe.
      */
     class CoverCache
     {
     public:
+        // The budget starts at ConfigManager::getCoverCacheBudgetMB()
         explicit CoverCache(ConfigManager* configManager);
         ~CoverCache();
 
@@ -41,6 +53,14 @@ namespace util
          */
         std::optional<QByteArray> getCachedCover(const QString& filePathOrUrl) const;
 
+        /**
+         * @brief Find the cached cover file, whatever its extension
+         * 
+         * @param filePathOrUrl Source audio file path or URL
+         * @return Full path of the cached file, or std::nullopt if not cached
+         */
+        std::optional<QString> findCachedCover(const QString& filePathOrUrl) const;
+
         /**
          * @brief Store cover image in cache
          * 
@@ -56,7 +76,8 @@ namespace util
         /**
          * @brief Get full path to cached cover file
          * 
-         * Returns path whether file exists or not (useful for checking what path would be used).
+         * Returns path whether file exists or not (useful for checking what path would be used):
+         * the cached file if there is one, else where a JPEG cover would be saved.
          * 
          * @param filePathOrUrl Source audio file path or URL
          * @return Full cache file path
@@ -87,14 +108,30 @@ namespace util
          */
         int64_t getCacheSizeBytes() const;
 
+        /**
+         * @brief Set the byte budget, evicting least recently used covers if over it
+         * 
+         * @param bytes New budget, 0 for unlimited
+         */
+        void setBudgetBytes(int64_t bytes);
+        int64_t budgetBytes() const;
+
     private:
+        struct Entry {
+            QString extension;
+            int64_t size = 0;
+            int64_t lastAccess = 0;     // Milliseconds since the epoch
+        };
+
         /**
-         * @brief Generate MD5 hash for cache key
+         * @brief Generate hash for cache key
          * 
          * @param filePathOrUrl Source file path or URL
-         * @return Hex string MD5 hash
+         * @return Hex string hash
          */
         static QString generateCacheKey(const QString& filePathOrUrl);
+        // Key earlier versions saved covers under (MD5)
+        static QString legacyCacheKey(const QString& filePathOrUrl);
 
         /**
          * @brief Detect image format from data
@@ -113,6 +150,34 @@ namespace util
          */
         bool ensureCacheDirectoryExists() const;
 
+        /**
+         * @brief Cache directory, with the index built for it
+         * 
+         * Scans the directory when the index is missing or was built for another one.
+         * 
+         * @return Directory path, empty if not configured
+         */
+        QString indexedDirectory_unsafe() const;
+        void scan_unsafe(const QString& directory) const;
+        using EntryMap = std::unordered_map<QString, Entry>;
+        // Entry of the source under its key, else its legacy key; end() if not cached
+        EntryMap::iterator findEntry_unsafe(const QString& filePathOrUrl) const;
+        QString entryPath_unsafe(EntryMap::const_iterator it) const;
+        // Path of the source's cached file, touching it; empty if not cached
+        QString locate_unsafe(const QString& filePathOrUrl) const;
+        int64_t touch_unsafe() const;
+        // Delete least recently used covers, other than `keep`, until within budget
+        void evict_unsafe(const QString& keep);
+
         ConfigManager* m_configManager;
+
+        mutable std::mutex m_mutex;
+        // The index is built lazily by const lookups, hence mutable
+        mutable QString m_indexedDirectory;
+        mutable bool m_indexed = false;
+        mutable EntryMap m_entries;
+        mutable int64_t m_totalBytes = 0;
+        mutable int64_t m_clock = 0;   // Latest access handed out, so touches in the same tick still order
+        int64_t m_budgetBytes = 0;
     };
 }
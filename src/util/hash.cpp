@@ -0,0 +1,98 @@
+#include "hash.h"
+#include <xxhash.h>
+#include <fstream>
+#include <new>
+#include <vector>
+
+namespace util {
+
+namespace {
+constexpr size_t FILE_CHUNK_BYTES = 256 * 1024;
+
+Hash128 fromXxh(const XXH128_hash_t& hash) {
+    return Hash128{ hash.high64, hash.low64 };
+}
+}
+
+std::string Hash128::hex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        out[15 - i] = digits[(high >> (i * 4)) & 0xF];
+        out[31 - i] = digits[(low >> (i * 4)) & 0xF];
+    }
+    return out;
+}
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed) {
+    return XXH3_64bits_withSeed(data, size, seed);
+}
+
+Hash128 hash128(const void* data, size_t size) {
+    return fromXxh(XXH3_128bits(data, size));
+}
+
+std::string hashHex(std::string_view text) {
+    return hash128(text).hex();
+}
+
+// ---------------- ContentHasher ----------------
+
+struct ContentHasher::State {
+    State() : xxh(XXH3_createState()) {
+        if (!xxh) {
+            throw std::bad_alloc();
+        }
+        XXH3_128bits_reset(xxh);
+    }
+    ~State() { XXH3_freeState(xxh); }
+
+    XXH3_state_t* xxh;      // Allocated by xxHash, which aligns it for the vector code
+};
+
+ContentHasher::ContentHasher()
+    : state_(std::make_unique<State>()) {
+}
+
+ContentHasher::~ContentHasher() = default;
+ContentHasher::ContentHasher(ContentHasher&& other) noexcept = default;
+ContentHasher& ContentHasher::operator=(ContentHasher&& other) noexcept = default;
+
+void ContentHasher::update(const void* data, size_t size) {
+    if (size == 0) return;
+    if (!state_) {
+        state_ = std::make_unique<State>();     // Moved from
+    }
+    XXH3_128bits_update(state_->xxh, data, size);
+    bytes_ += size;
+}
+
+Hash128 ContentHasher::digest() const {
+    return state_ ? fromXxh(XXH3_128bits_digest(state_->xxh)) : hash128(nullptr, 0);
+}
+
+void ContentHasher::reset() {
+    if (state_) {
+        XXH3_128bits_reset(state_->xxh);
+    }
+    bytes_ = 0;
+}
+
+std::optional<Hash128> hashFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+    ContentHasher hasher;
+    std::vector<char> buffer(FILE_CHUNK_BYTES);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hasher.update(buffer.data(), static_cast<size_t>(in.gcount()));
+    }
+    if (in.bad()) {
+        return std::nullopt;
+    }
+    return hasher.digest();
+}
+
+} // namespace util
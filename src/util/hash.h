@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace util {
+/**
+ * @brief Fast non-cryptographic hashing (XXH3 from xxHash, vectorized with SSE2/NEON)
+ * for cache keys and content identity.
+ *
+ * Several GB/s against a few hundred MB/s for MD5, and nothing to set up per call. Not
+ * for anything where someone could pick inputs to collide; MD5 (util/md5.h) stays
+ * where the other side expects it, such as the WBI signature, and for reading cache
+ * names written by earlier versions.
+ */
+
+// 128-bit digest, for content identity and file names
+struct Hash128 {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    // 32 lowercase hex digits, high half first
+    std::string hex() const;
+
+    bool operator==(const Hash128& other) const { return high == other.high && low == other.low; }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+inline uint64_t hash64(std::string_view text, uint64_t seed = 0) { return hash64(text.data(), text.size(), seed); }
+Hash128 hash128(const void* data, size_t size);
+inline Hash128 hash128(std::string_view text) { return hash128(text.data(), text.size()); }
+// hash128(text).hex(), the same length as an MD5 hex name
+std::string hashHex(std::string_view text);
+
+/**
+ * @brief Incremental hash128 of data arriving in pieces, e.g. a download hashed as its
+ * chunks are written, so the file needn't be read again. The digest equals hash128()
+ * of everything passed to update(), however it was split.
+ */
+class ContentHasher {
+public:
+    ContentHasher();
+    ~ContentHasher();
+    ContentHasher(ContentHasher&& other) noexcept;
+    ContentHasher& operator=(ContentHasher&& other) noexcept;
+    ContentHasher(const ContentHasher&) = delete;
+    ContentHasher& operator=(const ContentHasher&) = delete;
+
+    void update(const void* data, size_t size);
+    void update(std::string_view text) { update(text.data(), text.size()); }
+    // Digest of the data so far; more may be added afterwards
+    Hash128 digest() const;
+    uint64_t bytes() const { return bytes_; }
+    void reset();
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+    uint64_t bytes_ = 0;
+};
+
+// hash128 of a file's contents read in chunks; nullopt if it can't be read
+std::optional<Hash128> hashFile(const std::filesystem::path& path);
+}
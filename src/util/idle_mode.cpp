@@ -0,0 +1,87 @@
+#include "idle_mode.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace util {
+
+namespace {
+// One slot per second: the second in the upper bits, that second's count in the lower
+constexpr int COUNT_BITS = 24;
+constexpr uint64_t COUNT_MASK = (uint64_t(1) << COUNT_BITS) - 1;
+constexpr int SLOT_COUNT = IdleMode::RATE_WINDOW_SECONDS + 1;
+
+std::atomic<uint64_t> g_wakeups{0};
+std::atomic<uint64_t> g_slots[SLOT_COUNT];
+
+uint64_t currentSecond() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+}
+
+IdleMode::IdleMode(Handler onChange)
+    : onChange_(std::move(onChange)) {
+}
+
+void IdleMode::setPlaybackActive(bool active) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    playbackActive_ = active;
+    apply_unsafe(lock);
+}
+
+void IdleMode::setWindowVisible(bool visible) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    windowVisible_ = visible;
+    apply_unsafe(lock);
+}
+
+bool IdleMode::idle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_;
+}
+
+void IdleMode::recordWakeup() {
+    g_wakeups.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t second = currentSecond();
+    std::atomic<uint64_t>& slot = g_slots[second % SLOT_COUNT];
+    uint64_t current = slot.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        // A slot still holding an older second starts over
+        const bool sameSecond = (current >> COUNT_BITS) == second;
+        const uint64_t count = sameSecond ? (current & COUNT_MASK) : 0;
+        next = (second << COUNT_BITS) | std::min(count + 1, COUNT_MASK);
+    } while (!slot.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+uint64_t IdleMode::wakeups() {
+    return g_wakeups.load(std::memory_order_relaxed);
+}
+
+double IdleMode::wakeupsPerSecond() {
+    // Whole seconds only; the current one is still filling up
+    const uint64_t now = currentSecond();
+    uint64_t total = 0;
+    for (const auto& slot : g_slots) {
+        const uint64_t value = slot.load(std::memory_order_relaxed);
+        const uint64_t second = value >> COUNT_BITS;
+        if (second < now && now - second <= static_cast<uint64_t>(RATE_WINDOW_SECONDS)) {
+            total += value & COUNT_MASK;
+        }
+    }
+    return static_cast<double>(total) / RATE_WINDOW_SECONDS;
+}
+
+/*************** Private Methods ***************/
+void IdleMode::apply_unsafe(std::unique_lock<std::mutex>& lock) {
+    const bool idle = !playbackActive_ && !windowVisible_;
+    if (idle == idle_) return;
+    idle_ = idle;
+    lock.unlock();
+    if (onChange_) {
+        onChange_(idle);
+    }
+}
+
+}
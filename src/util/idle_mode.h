@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace util {
+/**
+ * @brief Whether the player sits idle: playback paused or stopped while the window is
+ * minimized or hidden. Components that wake the CPU on a timer are suspended while idle
+ * and resumed on the first change back, by the handler given to the constructor.
+ *
+ * The handler runs on the thread that changed the state, after the change, outside the
+ * lock; setters are meant to be called from one thread (the GUI thread).
+ *
+ * Wake-up accounting is process-wide: each timer tick or poll of a periodic component
+ * calls recordWakeup(), which is a lock-free atomic update safe on any thread, the
+ * real-time ones included. wakeupsPerSecond() averages the last RATE_WINDOW_SECONDS
+ * whole seconds.
+ */
+class IdleMode {
+public:
+    using Handler = std::function<void(bool idle)>;
+
+    static constexpr int RATE_WINDOW_SECONDS = 10;
+
+    explicit IdleMode(Handler onChange);
+
+    IdleMode(const IdleMode&) = delete;
+    IdleMode& operator=(const IdleMode&) = delete;
+
+    // Playing counts as active; paused, stopped and errors don't
+    void setPlaybackActive(bool active);
+    // False while the window is minimized or hidden
+    void setWindowVisible(bool visible);
+    bool idle() const;
+
+    static void recordWakeup();
+    // Wake-ups recorded since the process started
+    static uint64_t wakeups();
+    static double wakeupsPerSecond();
+
+private:
+    // Recompute idle_ after an input changed; calls the handler with the lock released
+    void apply_unsafe(std::unique_lock<std::mutex>& lock);
+
+    Handler onChange_;
+    mutable std::mutex mutex_;      // Guards the inputs and idle_
+    bool playbackActive_ = false;
+    bool windowVisible_ = true;
+    bool idle_ = false;
+};
+}
@@ -0,0 +1,279 @@
+#include "json_scanner.h"
+
+namespace util {
+
+namespace {
+    // Past this depth skipValue() gives up rather than walk a hostile document
+    constexpr int MAX_SKIP_DEPTH = 256;
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-';
+    }
+}
+
+JsonScanner::JsonScanner(std::string_view json)
+    : json_(json) {
+}
+
+bool JsonScanner::enterObject() {
+    if (peek() != '{') return false;
+    ++pos_;
+    skipWhitespace();
+    opened_ = pos_;
+    return true;
+}
+
+bool JsonScanner::enterArray() {
+    if (peek() != '[') return false;
+    ++pos_;
+    skipWhitespace();
+    opened_ = pos_;
+    return true;
+}
+
+bool JsonScanner::nextKey(std::string_view& key) {
+    const bool first = pos_ == opened_;
+    char c = peek();
+    if (c == '}') {
+        ++pos_;
+        return false;
+    }
+    if (!first) {
+        if (c != ',') return fail();
+        ++pos_;
+        c = peek();
+    }
+    if (c != '"') return fail();
+    const size_t start = ++pos_;
+    while (pos_ < json_.size() && json_[pos_] != '"') {
+        pos_ += json_[pos_] == '\\' ? 2 : 1;
+    }
+    if (pos_ >= json_.size()) return fail();
+    key = json_.substr(start, pos_ - start);
+    ++pos_;
+    if (peek() != ':') return fail();
+    ++pos_;
+    return true;
+}
+
+bool JsonScanner::nextElement() {
+    const bool first = pos_ == opened_;
+    const char c = peek();
+    if (c == ']') {
+        ++pos_;
+        return false;
+    }
+    if (first) {
+        return c != 0 || fail();
+    }
+    if (c != ',') return fail();
+    ++pos_;
+    return true;
+}
+
+bool JsonScanner::readString(std::string& out) {
+    if (peek() != '"') return false;
+    ++pos_;
+    out.clear();
+    for (;;) {
+        // Copy the run up to the next quote or escape in one go
+        size_t end = pos_;
+        while (end < json_.size() && json_[end] != '"' && json_[end] != '\\') ++end;
+        out.append(json_.data() + pos_, end - pos_);
+        pos_ = end;
+        if (pos_ >= json_.size()) return fail();
+        if (json_[pos_] == '"') {
+            ++pos_;
+            return true;
+        }
+        if (!decodeEscape(out)) return fail();
+    }
+}
+
+bool JsonScanner::readInt(int64_t& out) {
+    const char c = peek();
+    if (c != '-' && (c < '0' || c > '9')) return false;
+    size_t pos = pos_;
+    const bool negative = c == '-';
+    if (negative) ++pos;
+    if (pos >= json_.size() || json_[pos] < '0' || json_[pos] > '9') return fail();
+    int64_t value = 0;
+    while (pos < json_.size() && json_[pos] >= '0' && json_[pos] <= '9') {
+        value = value * 10 + (json_[pos] - '0');
+        ++pos;
+    }
+    // A fraction or exponent is dropped
+    while (pos < json_.size() && isNumberChar(json_[pos])) ++pos;
+    pos_ = pos;
+    out = negative ? -value : value;
+    return true;
+}
+
+bool JsonScanner::readInt(int& out) {
+    int64_t value = 0;
+    if (!readInt(value)) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
+bool JsonScanner::readBool(bool& out) {
+    const char c = peek();
+    if (c == 't' && json_.compare(pos_, 4, "true") == 0) {
+        pos_ += 4;
+        out = true;
+        return true;
+    }
+    if (c == 'f' && json_.compare(pos_, 5, "false") == 0) {
+        pos_ += 5;
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+bool JsonScanner::skipValue() {
+    const char c = peek();
+    if (c == '"') return skipString();
+    if (c != '{' && c != '[') return skipScalar();
+
+    // Containers: only brackets and strings matter, so count depth instead of parsing
+    int depth = 0;
+    while (pos_ < json_.size()) {
+        const char ch = json_[pos_];
+        if (ch == '"') {
+            if (!skipString()) return false;
+            continue;
+        }
+        ++pos_;
+        if (ch == '{' || ch == '[') {
+            if (++depth > MAX_SKIP_DEPTH) return fail();
+        } else if (ch == '}' || ch == ']') {
+            if (--depth == 0) return true;
+        }
+    }
+    return fail();
+}
+
+bool JsonScanner::captureValue(std::string_view& raw) {
+    peek();
+    const size_t start = pos_;
+    if (!skipValue()) return false;
+    raw = json_.substr(start, pos_ - start);
+    return true;
+}
+
+/*************** Private Methods ***************/
+bool JsonScanner::fail() {
+    failed_ = true;
+    pos_ = json_.size();
+    return false;
+}
+
+void JsonScanner::skipWhitespace() {
+    while (pos_ < json_.size()) {
+        const char c = json_[pos_];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        ++pos_;
+    }
+}
+
+char JsonScanner::peek() {
+    skipWhitespace();
+    return pos_ < json_.size() ? json_[pos_] : 0;
+}
+
+bool JsonScanner::skipString() {
+    ++pos_;     // Opening quote
+    while (pos_ < json_.size()) {
+        const char c = json_[pos_];
+        if (c == '"') {
+            ++pos_;
+            return true;
+        }
+        pos_ += c == '\\' ? 2 : 1;
+    }
+    return fail();
+}
+
+bool JsonScanner::skipScalar() {
+    // Numbers and literals run until a delimiter
+    const size_t start = pos_;
+    while (pos_ < json_.size()) {
+        const char c = json_[pos_];
+        if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r') break;
+        if (c == '"' || c == '{' || c == '[' || c == ':') return fail();
+        ++pos_;
+    }
+    return pos_ > start || fail();
+}
+
+bool JsonScanner::decodeEscape(std::string& out) {
+    // At the backslash
+    if (pos_ + 1 >= json_.size()) return false;
+    const char c = json_[pos_ + 1];
+    pos_ += 2;
+    switch (c) {
+    case '"': out += '"'; return true;
+    case '\\': out += '\\'; return true;
+    case '/': out += '/'; return true;
+    case 'b': out += '\b'; return true;
+    case 'f': out += '\f'; return true;
+    case 'n': out += '\n'; return true;
+    case 'r': out += '\r'; return true;
+    case 't': out += '\t'; return true;
+    case 'u': break;
+    default: return false;
+    }
+
+    auto readHex4 = [this](uint32_t& value) {
+        if (pos_ + 4 > json_.size()) return false;
+        value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const int digit = hexValue(json_[pos_ + i]);
+            if (digit < 0) return false;
+            value = (value << 4) | static_cast<uint32_t>(digit);
+        }
+        pos_ += 4;
+        return true;
+    };
+    uint32_t codepoint = 0;
+    if (!readHex4(codepoint)) return false;
+    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+        // High surrogate, the low half must follow
+        uint32_t low = 0;
+        if (json_.compare(pos_, 2, "\\u") != 0) return false;
+        pos_ += 2;
+        if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+    } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+        return false;
+    }
+    appendUtf8(codepoint, out);
+    return true;
+}
+
+void JsonScanner::appendUtf8(uint32_t codepoint, std::string& out) {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace util {
+/**
+ * @brief Forward-only, on-demand reader over a JSON document held in memory.
+ *
+ * Instead of building a DOM, callers walk the document and pull out only the fields they
+ * use; everything else is skipped without allocating. Keys are views into the input and
+ * strings are decoded straight into the caller's std::string, so a reused target keeps
+ * its capacity.
+ *
+ * enterObject(), enterArray() and the read*() calls leave a value of another type where
+ * it is, so the caller can skipValue() it. Malformed input makes every call fail from then
+ * on and ok() false. The input must outlive the scanner. Not thread-safe.
+ *
+ *     while (json.nextKey(key)) {
+ *         if (!(key == "bvid" && json.readString(bvid))) json.skipValue();
+ *     }
+ */
+class JsonScanner {
+public:
+    explicit JsonScanner(std::string_view json);
+
+    // Consume '{' or '[' if the next value is an object or array
+    bool enterObject();
+    bool enterArray();
+
+    /**
+     * @brief Advance to the next member of the current object.
+     * @param key Raw key text, escapes not decoded
+     * @return false once the closing '}' has been consumed, or on malformed input
+     */
+    bool nextKey(std::string_view& key);
+
+    // Advance to the next element of the current array; false once ']' is consumed
+    bool nextElement();
+
+    // Decode a string value into out, escapes and \u sequences included (UTF-8)
+    bool readString(std::string& out);
+    // An integer, or a number's integral part; out is untouched on failure
+    bool readInt(int64_t& out);
+    bool readInt(int& out);
+    bool readBool(bool& out);
+
+    // Skip the next value whatever its type, nested containers included
+    bool skipValue();
+    // Skip the next value and return its text, e.g. to parse a part of the document later
+    bool captureValue(std::string_view& raw);
+
+    // No malformed input seen so far
+    bool ok() const { return !failed_; }
+
+private:
+    bool fail();
+    void skipWhitespace();
+    // Next non-whitespace character, 0 at the end
+    char peek();
+    bool skipString();
+    bool skipScalar();
+    bool decodeEscape(std::string& out);
+    static void appendUtf8(uint32_t codepoint, std::string& out);
+
+    std::string_view json_;
+    size_t pos_ = 0;
+    // Position just past the last '{' or '[' and its whitespace. Still being there means
+    // the container's first member is next, anywhere else a ',' is due
+    size_t opened_ = std::string_view::npos;
+    bool failed_ = false;
+};
+}
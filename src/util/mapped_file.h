@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace util {
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Used for local audio files so the decoder can hand FFmpeg bytes straight from the
+ * page cache, without a reader thread or intermediate buffer.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the file at path (UTF-8). Returns false if it can't be opened, is empty or can't be mapped.
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    uint64_t size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;       // HANDLE
+    void* mapping_ = nullptr;    // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
+}
@@ -0,0 +1,186 @@
+#include "memory_budget.h"
+#include <algorithm>
+
+namespace util {
+
+namespace {
+// Set while the calling thread measures or trims consumers
+thread_local bool t_trimming = false;
+
+class TrimScope {
+public:
+    TrimScope() : previous_(t_trimming) { t_trimming = true; }
+    ~TrimScope() { t_trimming = previous_; }
+
+private:
+    bool previous_;
+};
+}
+
+// ---------------- Registration ----------------
+
+MemoryBudget::Registration::Registration(Registration&& other) noexcept
+    : owner_(other.owner_), id_(other.id_) {
+    other.owner_ = nullptr;
+}
+
+MemoryBudget::Registration& MemoryBudget::Registration::operator=(Registration&& other) noexcept {
+    if (this != &other) {
+        reset();
+        owner_ = other.owner_;
+        id_ = other.id_;
+        other.owner_ = nullptr;
+    }
+    return *this;
+}
+
+void MemoryBudget::Registration::grew() {
+    if (!owner_) return;
+    owner_->recheck_.store(true);
+    owner_->enforcePending();
+}
+
+void MemoryBudget::Registration::reset() {
+    if (owner_) {
+        owner_->remove(id_);
+        owner_ = nullptr;
+    }
+}
+
+// ---------------- MemoryBudget ----------------
+
+MemoryBudget& MemoryBudget::instance() {
+    static MemoryBudget budget;
+    return budget;
+}
+
+MemoryBudget::MemoryBudget(size_t capBytes)
+    : cap_(capBytes) {
+}
+
+MemoryBudget::Registration MemoryBudget::add(std::string name, Priority priority,
+                                             UsageFunction usage, TrimFunction trim) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t id = next_id_++;
+    consumers_.push_back(Consumer{ id, std::move(name), priority, std::move(usage), std::move(trim) });
+    return Registration(this, id);
+}
+
+void MemoryBudget::setCap(size_t capBytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cap_ = capBytes;
+    }
+    enforce();
+}
+
+size_t MemoryBudget::cap() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cap_;
+}
+
+size_t MemoryBudget::used() const {
+    std::lock_guard<std::recursive_mutex> lock(trim_mutex_);
+    size_t total = 0;
+    for (const auto& measured : measure_unsafe()) {
+        total += measured.bytes;
+    }
+    return total;
+}
+
+std::vector<MemoryBudget::ConsumerUsage> MemoryBudget::usage() const {
+    std::lock_guard<std::recursive_mutex> lock(trim_mutex_);
+    std::vector<ConsumerUsage> result;
+    for (auto& measured : measure_unsafe()) {
+        result.push_back(ConsumerUsage{ std::move(measured.consumer.name), measured.consumer.priority, measured.bytes });
+    }
+    return result;
+}
+
+size_t MemoryBudget::enforce() {
+    size_t freed = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(trim_mutex_);
+        freed = enforce_unsafe();
+    }
+    return freed + enforcePending();
+}
+
+size_t MemoryBudget::relieve() {
+    size_t freed = 0;
+    {
+        std::lock_guard<std::recursive_mutex> lock(trim_mutex_);
+        TrimScope scope;
+        for (auto& measured : measure_unsafe()) {
+            const Consumer& consumer = measured.consumer;
+            if (!consumer.trim || measured.bytes == 0 || consumer.priority == Priority::High) continue;
+            freed += consumer.trim(consumer.priority == Priority::Low ? measured.bytes : measured.bytes / 2);
+        }
+    }
+    return freed + enforcePending();
+}
+
+/*************** Private Methods ***************/
+void MemoryBudget::remove(uint64_t id) {
+    std::lock_guard<std::recursive_mutex> trimLock(trim_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumers_.erase(std::remove_if(consumers_.begin(), consumers_.end(),
+                                    [id](const Consumer& consumer) { return consumer.id == id; }),
+                     consumers_.end());
+}
+
+std::vector<MemoryBudget::Measured> MemoryBudget::measure_unsafe() const {
+    std::vector<Consumer> consumers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        consumers = consumers_;
+    }
+    TrimScope scope;
+    std::vector<Measured> measured;
+    measured.reserve(consumers.size());
+    for (auto& consumer : consumers) {
+        const size_t bytes = consumer.usage ? consumer.usage() : 0;
+        measured.push_back(Measured{ std::move(consumer), bytes });
+    }
+    std::stable_sort(measured.begin(), measured.end(), [](const Measured& a, const Measured& b) {
+        if (a.consumer.priority != b.consumer.priority) return a.consumer.priority < b.consumer.priority;
+        return a.bytes > b.bytes;
+    });
+    return measured;
+}
+
+size_t MemoryBudget::enforce_unsafe() {
+    recheck_.store(false);
+    const size_t capBytes = cap();
+    if (capBytes == 0) return 0;
+
+    TrimScope scope;
+    std::vector<Measured> measured = measure_unsafe();
+    size_t total = 0;
+    for (const auto& entry : measured) {
+        total += entry.bytes;
+    }
+    if (total <= capBytes) return 0;
+
+    const size_t excess = total - capBytes;
+    size_t freed = 0;
+    for (const auto& entry : measured) {
+        if (freed >= excess) break;
+        if (!entry.consumer.trim || entry.bytes == 0) continue;
+        freed += entry.consumer.trim(std::min(entry.bytes, excess - freed));
+    }
+    return freed;
+}
+
+size_t MemoryBudget::enforcePending() {
+    size_t freed = 0;
+    // Inside a trim the pass already running on this thread is followed by this loop
+    while (recheck_.load() && !t_trimming) {
+        std::unique_lock<std::recursive_mutex> lock(trim_mutex_, std::try_to_lock);
+        if (!lock.owns_lock()) break;      // The thread holding it runs this loop after letting go
+        freed += enforce_unsafe();
+    }
+    return freed;
+}
+
+} // namespace util
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace util {
+/**
+ * @brief One memory cap shared by the in-memory caches and buffers of the process.
+ *
+ * Each consumer registers how to read its current size and how to give memory back.
+ * A consumer that grew calls Registration::grew(); when the sizes add up to more than
+ * the cap, consumers are asked to trim, lowest priority first and the largest first
+ * within a priority, until the total fits again. Consumers that can't give anything
+ * back (fixed buffers) still count, so they push the caches out.
+ *
+ * Sizes are read and trims run on the thread that reported growth. A grew() from inside
+ * a trim, or while another thread is trimming, only asks that thread for another pass.
+ * Consumers must not hold their own lock while calling grew(), since their size is read
+ * then, and must not unregister from inside their trim. All methods are thread-safe.
+ */
+class MemoryBudget {
+public:
+    // Which consumers give memory back first: Low before Normal before High
+    enum class Priority { Low, Normal, High };
+    // Current size in bytes
+    using UsageFunction = std::function<size_t()>;
+    // Free about `bytes`, return how many were freed
+    using TrimFunction = std::function<size_t(size_t bytes)>;
+
+    struct ConsumerUsage {
+        std::string name;
+        Priority priority;
+        size_t bytes;
+    };
+
+    // Unregisters its consumer when destroyed or reset(); waits for a trim in progress
+    class Registration {
+    public:
+        Registration() = default;
+        ~Registration() { reset(); }
+        Registration(Registration&& other) noexcept;
+        Registration& operator=(Registration&& other) noexcept;
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+        // The consumer got bigger: trim consumers now if the total is over the cap
+        void grew();
+        void reset();
+        explicit operator bool() const { return owner_ != nullptr; }
+
+    private:
+        friend class MemoryBudget;
+        Registration(MemoryBudget* owner, uint64_t id) : owner_(owner), id_(id) {}
+
+        MemoryBudget* owner_ = nullptr;
+        uint64_t id_ = 0;
+    };
+
+    static constexpr size_t DEFAULT_CAP_BYTES = 512ull * 1024 * 1024;
+
+    static MemoryBudget& instance();
+    explicit MemoryBudget(size_t capBytes = DEFAULT_CAP_BYTES);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // trim may be empty for memory that can't be given back
+    Registration add(std::string name, Priority priority, UsageFunction usage, TrimFunction trim);
+
+    // Lowering the cap trims right away; 0 removes the cap
+    void setCap(size_t capBytes);
+    size_t cap() const;
+    // Total size of the consumers, and each one's share
+    size_t used() const;
+    std::vector<ConsumerUsage> usage() const;
+
+    /**
+     * @brief Enforce the cap now.
+     * @return Bytes freed
+     */
+    size_t enforce();
+    /**
+     * @brief The system is short of memory: Low consumers drop everything and Normal
+     * ones half of what they hold, whatever the cap. High consumers are left alone.
+     * @return Bytes freed
+     */
+    size_t relieve();
+
+private:
+    struct Consumer {
+        uint64_t id;
+        std::string name;
+        Priority priority;
+        UsageFunction usage;
+        TrimFunction trim;
+    };
+    struct Measured {
+        Consumer consumer;
+        size_t bytes;
+    };
+
+    void remove(uint64_t id);
+    // The consumers with their sizes, in trim order; caller holds trim_mutex_
+    std::vector<Measured> measure_unsafe() const;
+    size_t enforce_unsafe();
+    // Passes for growth reported since the last one, unless another thread is trimming
+    size_t enforcePending();
+
+    mutable std::mutex mutex_;          // Guards consumers_, cap_ and next_id_
+    // Held while consumer callbacks run; removing a consumer waits for it, so no callback
+    // runs on a consumer that is gone. Recursive for a trim that reads used() or ends up
+    // in enforce() again
+    mutable std::recursive_mutex trim_mutex_;
+    std::vector<Consumer> consumers_;
+    size_t cap_;
+    uint64_t next_id_ = 1;
+    std::atomic<bool> recheck_{false};  // Growth reported while another thread was trimming
+};
+}
@@ -0,0 +1,109 @@
+#include "memory_pressure.h"
+#include "idle_mode.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#endif
+
+namespace util {
+
+MemoryPressureMonitor::MemoryPressureMonitor(std::function<void()> onLow)
+    : onLow_(std::move(onLow)) {
+}
+
+MemoryPressureMonitor::~MemoryPressureMonitor() {
+    stop();
+}
+
+void MemoryPressureMonitor::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void MemoryPressureMonitor::setSlowPolling(bool slow) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slowPolling_ == slow) return;
+        slowPolling_ = slow;
+        pollNow_ = !slow;
+    }
+    wake_.notify_all();
+}
+
+void MemoryPressureMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+#ifdef _WIN32
+uint64_t MemoryPressureMonitor::availableBytes() {
+    MEMORYSTATUSEX status{};
+    status.dwLength = sizeof(status);
+    return GlobalMemoryStatusEx(&status) ? status.ullAvailPhys : 0;
+}
+
+bool MemoryPressureMonitor::memoryLow() {
+    // Signalled while the system considers physical memory low; never closed
+    static const HANDLE notification = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+    BOOL low = FALSE;
+    if (notification && QueryMemoryResourceNotification(notification, &low)) {
+        return low != FALSE;
+    }
+    const uint64_t available = availableBytes();
+    return available > 0 && available < LOW_MEMORY_BYTES;
+}
+#else
+uint64_t MemoryPressureMonitor::availableBytes() {
+#ifdef __linux__
+    // MemAvailable counts reclaimable page cache, unlike the free page count
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line)) {
+        if (line.rfind("MemAvailable:", 0) == 0) {
+            return std::stoull(line.substr(13)) * 1024;     // "MemAvailable:   123456 kB"
+        }
+    }
+#endif
+    return 0;
+}
+
+bool MemoryPressureMonitor::memoryLow() {
+    const uint64_t available = availableBytes();
+    return available > 0 && available < LOW_MEMORY_BYTES;
+}
+#endif
+
+/*************** Private Methods ***************/
+void MemoryPressureMonitor::run() {
+    bool wasLow = false;
+    std::chrono::steady_clock::time_point lastFired;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        lock.unlock();
+        IdleMode::recordWakeup();
+        const bool low = memoryLow();
+        const auto now = std::chrono::steady_clock::now();
+        if (low && (!wasLow || now - lastFired >= REPEAT_INTERVAL)) {
+            onLow_();
+            lastFired = now;
+        }
+        wasLow = low;
+        lock.lock();
+        const std::chrono::seconds interval = slowPolling_ ? IDLE_POLL_INTERVAL : POLL_INTERVAL;
+        wake_.wait_for(lock, interval, [this]() { return stopping_ || pollNow_; });
+        pollNow_ = false;
+    }
+}
+
+}
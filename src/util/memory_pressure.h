@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace util {
+/**
+ * @brief Calls onLow from a thread of its own when the system runs short of physical
+ * memory, so caches can be trimmed before the OS starts paging other programs out.
+ *
+ * Windows reports the condition through a low-memory resource notification. Elsewhere
+ * the available memory is compared with LOW_MEMORY_BYTES. The check runs every
+ * POLL_INTERVAL, or IDLE_POLL_INTERVAL while slowed down (idle mode); onLow fires when
+ * memory becomes low, and again every REPEAT_INTERVAL while it stays low.
+ */
+class MemoryPressureMonitor {
+public:
+    static constexpr std::chrono::seconds POLL_INTERVAL{2};
+    static constexpr std::chrono::seconds IDLE_POLL_INTERVAL{30};
+    static constexpr std::chrono::seconds REPEAT_INTERVAL{30};
+    static constexpr uint64_t LOW_MEMORY_BYTES = 256ull * 1024 * 1024;
+
+    explicit MemoryPressureMonitor(std::function<void()> onLow);
+    ~MemoryPressureMonitor();
+
+    MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+    MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+    void start();
+    void stop();
+    // Check every IDLE_POLL_INTERVAL instead of POLL_INTERVAL; false checks right away
+    void setSlowPolling(bool slow);
+
+    // Physical memory available to programs now, 0 if the platform doesn't say
+    static uint64_t availableBytes();
+    static bool memoryLow();
+
+private:
+    void run();
+
+    std::function<void()> onLow_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    bool slowPolling_ = false;
+    bool pollNow_ = false;      // Check again without waiting out the interval
+    std::thread thread_;
+};
+}
@@ -0,0 +1,49 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <thread>
+
+namespace util {
+
+RateLimiter::RateLimiter(uint64_t bytesPerSecond)
+    : rate_(bytesPerSecond)
+    , next_(Clock::now()) {
+}
+
+void RateLimiter::setRate(uint64_t bytesPerSecond) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_ = bytesPerSecond;
+    // Bookings made at the old rate don't hold back the new one
+    next_ = std::min(next_, Clock::now());
+}
+
+uint64_t RateLimiter::rate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rate_;
+}
+
+bool RateLimiter::acquire(size_t size, const std::function<bool()>& cancelled) {
+    Clock::time_point due;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (rate_ == 0) {
+            return true;
+        }
+        const Clock::time_point now = Clock::now();
+        const auto cost = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(size) / static_cast<double>(rate_)));
+        // Book the bytes after earlier bookings; the caller may run up to BURST ahead of them
+        next_ = std::max(next_, now) + cost;
+        due = next_ - std::chrono::duration_cast<Clock::duration>(BURST);
+    }
+    for (;;) {
+        if (cancelled && cancelled()) {
+            return false;
+        }
+        const Clock::time_point now = Clock::now();
+        if (now >= due) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::min<Clock::duration>(due - now, SLEEP_SLICE));
+    }
+}
+}
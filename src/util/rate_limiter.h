@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace util {
+/**
+ * @brief Paces a byte stream to an average rate, shared by every thread that calls acquire().
+ *
+ * Each acquire() books its bytes on a common timeline and sleeps until its slot comes up,
+ * so several transfers together stay under the rate. Up to BURST worth of unused time is
+ * carried over, so short idle gaps don't slow the next chunk down. A rate of 0 is unlimited.
+ */
+class RateLimiter {
+public:
+    // Unused time carried over (at most this much traffic is sent unpaced)
+    static constexpr std::chrono::milliseconds BURST{250};
+    // Sleeps are split into slices this long so cancellation is seen promptly
+    static constexpr std::chrono::milliseconds SLEEP_SLICE{50};
+
+    explicit RateLimiter(uint64_t bytesPerSecond = 0);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    void setRate(uint64_t bytesPerSecond);
+    uint64_t rate() const;
+
+    /**
+     * @brief Wait until size more bytes fit the rate.
+     * @param cancelled Polled while sleeping; may be empty
+     * @return false if cancelled returned true first (the bytes stay booked)
+     */
+    bool acquire(size_t size, const std::function<bool()>& cancelled = nullptr);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    mutable std::mutex mutex_;
+    uint64_t rate_;
+    Clock::time_point next_;        // When the booked traffic has drained at rate_
+};
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+
+namespace util {
+
+// What RingBuffer::push()/write() do when the buffer has no room left
+enum class OverflowPolicy {
+    Overwrite,  // Drop the oldest elements (same as CircularBuffer)
+    Block,      // Wait until the consumer frees space; the buffer is internally synchronized
+    Reject      // Store only what fits and report how much that was
+};
+
+/**
+ * @brief Circular buffer with power-of-two capacity and a compile-time overflow policy
+ *
+ * Positions are free-running counters masked into the storage, so no index update
+ * needs a modulo and full/empty need no extra flag. Bulk write()/read() copy at most two
+ * contiguous runs, with memcpy when T is trivially copyable; readableSpans() and
+ * writableSpans() expose those runs for callers that fill or drain the buffer in place.
+ *
+ * Overwrite and Reject buffers are not thread-safe, like CircularBuffer. A Block buffer
+ * guards every call with an internal mutex, so one thread may write() while another
+ * reads; spans handed out are only safe to use while no other thread touches the buffer.
+ *
+ * @tparam T Type of elements stored
+ * @tparam Policy Behavior on overflow
+ */
+template <typename T, OverflowPolicy Policy = OverflowPolicy::Overwrite>
+class RingBuffer {
+public:
+    using Span = std::pair<T*, size_t>;
+    using ConstSpan = std::pair<const T*, size_t>;
+
+    // @param capacity Number of elements, rounded up to a power of two
+    explicit RingBuffer(size_t capacity) {
+        if (capacity == 0) throw std::invalid_argument("RingBuffer capacity must be > 0");
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        buffer_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Returns false if the element was rejected (Reject when full, Block after close())
+    bool push(const T& item) {
+        return write(&item, 1) == 1;
+    }
+
+    T pop() {
+        [[maybe_unused]] auto lock = guard();
+        if (tail_ == head_) throw std::runtime_error("RingBuffer is empty");
+        T item = buffer_[head_ & mask_];
+        ++head_;
+        notifySpace();
+        return item;
+    }
+
+    /**
+     * @brief Append count elements according to the overflow policy.
+     * @return Elements stored: always count for Overwrite, what fit for Reject,
+     *         and count for Block unless the buffer was closed while waiting
+     */
+    size_t write(const T* data, size_t count) {
+        [[maybe_unused]] auto lock = guard();
+        if constexpr (Policy == OverflowPolicy::Overwrite) {
+            size_t kept = count;
+            if (kept > capacity()) {
+                // Only the newest capacity() elements survive
+                data += kept - capacity();
+                head_ = tail_ = tail_ + kept - capacity();
+                kept = capacity();
+            }
+            const size_t free = capacity() - (tail_ - head_);
+            if (kept > free) head_ += kept - free;
+            copyIn(data, kept);
+            return count;
+        } else if constexpr (Policy == OverflowPolicy::Reject) {
+            const size_t stored = std::min(count, capacity() - (tail_ - head_));
+            copyIn(data, stored);
+            return stored;
+        } else {
+            size_t written = 0;
+            while (written < count) {
+                sync_.space.wait(lock, [this]() {
+                    return sync_.closed || tail_ - head_ < capacity();
+                });
+                if (sync_.closed) break;
+                const size_t chunk = std::min(count - written, capacity() - (tail_ - head_));
+                copyIn(data + written, chunk);
+                written += chunk;
+            }
+            return written;
+        }
+    }
+
+    // Copy out up to count of the oldest elements, returns how many were read
+    size_t read(T* data, size_t count) {
+        [[maybe_unused]] auto lock = guard();
+        const size_t taken = std::min(count, tail_ - head_);
+        const size_t offset = head_ & mask_;
+        const size_t first = std::min(taken, capacity() - offset);
+        copyElements(data, buffer_.data() + offset, first);
+        copyElements(data + first, buffer_.data(), taken - first);
+        head_ += taken;
+        notifySpace();
+        return taken;
+    }
+
+    // Drop up to count of the oldest elements without copying them out
+    size_t discard(size_t count) {
+        [[maybe_unused]] auto lock = guard();
+        const size_t dropped = std::min(count, tail_ - head_);
+        head_ += dropped;
+        notifySpace();
+        return dropped;
+    }
+
+    void clear() {
+        [[maybe_unused]] auto lock = guard();
+        head_ = tail_ = 0;
+        notifySpace();
+    }
+
+    // Stored elements, oldest first, as up to two contiguous runs (the second may be empty).
+    // Release what was consumed with discard().
+    std::array<ConstSpan, 2> readableSpans() const {
+        [[maybe_unused]] auto lock = guard();
+        const size_t used = tail_ - head_;
+        const size_t offset = head_ & mask_;
+        const size_t first = std::min(used, capacity() - offset);
+        return {{ { buffer_.data() + offset, first }, { buffer_.data(), used - first } }};
+    }
+
+    // Free space at the write position as up to two contiguous runs (the second may be
+    // empty). Publish what was stored with commit(). Valid until the next write or clear().
+    std::array<Span, 2> writableSpans() {
+        [[maybe_unused]] auto lock = guard();
+        const size_t free = capacity() - (tail_ - head_);
+        const size_t offset = tail_ & mask_;
+        const size_t first = std::min(free, capacity() - offset);
+        return {{ { buffer_.data() + offset, first }, { buffer_.data(), free - first } }};
+    }
+
+    // First run of writableSpans(), the drop-in for CircularBuffer::writableSpan()
+    Span writableSpan() {
+        return writableSpans()[0];
+    }
+
+    // Make count elements written into writableSpans() readable
+    void commit(size_t count) {
+        [[maybe_unused]] auto lock = guard();
+        tail_ += std::min(count, capacity() - (tail_ - head_));
+    }
+
+    // Block policy: wake a waiting writer and make further writes fail
+    void close() {
+        if constexpr (Policy == OverflowPolicy::Block) {
+            std::lock_guard<std::mutex> lock(sync_.mutex);
+            sync_.closed = true;
+            sync_.space.notify_all();
+        }
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() == capacity(); }
+    size_t size() const {
+        [[maybe_unused]] auto lock = guard();
+        return tail_ - head_;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Unsynchronized {
+        // Stand-in for a lock when the policy needs none
+        struct Guard {};
+    };
+    struct Synchronized {
+        std::mutex mutex;
+        std::condition_variable space;
+        bool closed = false;
+    };
+    static constexpr bool SYNCHRONIZED = Policy == OverflowPolicy::Block;
+
+    auto guard() const {
+        if constexpr (SYNCHRONIZED) {
+            return std::unique_lock<std::mutex>(sync_.mutex);
+        } else {
+            return typename Unsynchronized::Guard{};
+        }
+    }
+
+    void notifySpace() {
+        if constexpr (SYNCHRONIZED) {
+            sync_.space.notify_all();
+        }
+    }
+
+    static void copyElements(T* dst, const T* src, size_t count) {
+        if (count == 0) return;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(dst, src, count * sizeof(T));
+        } else {
+            std::copy(src, src + count, dst);
+        }
+    }
+
+    // Store count elements at the write position (caller made room) and publish them
+    void copyIn(const T* data, size_t count) {
+        const size_t offset = tail_ & mask_;
+        const size_t first = std::min(count, capacity() - offset);
+        copyElements(buffer_.data() + offset, data, first);
+        copyElements(buffer_.data(), data + first, count - first);
+        tail_ += count;
+    }
+
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+    size_t head_ = 0;   // Total elements consumed
+    size_t tail_ = 0;   // Total elements stored
+    mutable std::conditional_t<SYNCHRONIZED, Synchronized, Unsynchronized> sync_;
+};
+}
@@ -1,52 +1,116 @@
 #pragma once
 
-#include <queue>
-#include <mutex>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <utility>
 
+/**
+ * @brief Unbounded multi-producer, multi-consumer FIFO queue.
+ *
+ * Items are moved in and out. close() ends the queue: later enqueues are refused,
+ * waiting consumers wake up, and the waits return false once the remaining items are
+ * taken, so a consumer loop ends without polling empty(). Consumers that can handle
+ * several items at once take them under one lock with drainTo().
+ */
 template<typename T>
 class SafeQueue {
 public:
     SafeQueue() = default;
     ~SafeQueue() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        while (!queue_.empty()) {
-            queue_.pop();
-        }
-        cv.notify_all();
+        close();
     }
 
-    void enqueue(const T& item) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(item);
+    SafeQueue(const SafeQueue&) = delete;
+    SafeQueue& operator=(const SafeQueue&) = delete;
+
+    // Return false if the queue is closed; the item is dropped then
+    bool enqueue(const T& item) {
+        return emplace(item);
+    }
+
+    bool enqueue(T&& item) {
+        return emplace(std::move(item));
+    }
+
+    template<typename... Args>
+    bool emplace(Args&&... args) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            queue_.emplace_back(std::forward<Args>(args)...);
+        }
         cv.notify_one();
+        return true;
     }
 
+    // Take the front item without waiting; false if there is none
     bool dequeue(T& item) {
         std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.empty()) {
-            return false;
-        }
-        item = queue_.front();
-        queue_.pop();
-        return true;
+        return take_unsafe(item);
     }
 
-    void waitAndDequeue(T& item) {
+    // Wait for an item; false once the queue is closed and drained
+    bool waitAndDequeue(T& item) {
         std::unique_lock<std::mutex> lock(mutex_);
-        cv.wait(lock, [this]() { return !queue_.empty(); });
-        item = queue_.front();
-        queue_.pop();
+        cv.wait(lock, [this]() { return !queue_.empty() || closed_; });
+        return take_unsafe(item);
     }
 
-    void clean() {
+    // Wait up to timeout for an item; false on timeout, or once closed and drained
+    template<typename Rep, typename Period>
+    bool waitFor(T& item, const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv.wait_for(lock, timeout, [this]() { return !queue_.empty() || closed_; });
+        return take_unsafe(item);
+    }
+
+    /**
+     * @brief Move up to maxItems queued items to the back of out, in order, without waiting.
+     * @param out Any container with push_back (std::vector, std::deque, QList)
+     * @return Number of items moved
+     */
+    template<typename Container>
+    size_t drainTo(Container& out, size_t maxItems = std::numeric_limits<size_t>::max()) {
         std::lock_guard<std::mutex> lock(mutex_);
-        while (!queue_.empty()) {
-            queue_.pop();
+        size_t moved = 0;
+        while (moved < maxItems && !queue_.empty()) {
+            out.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+            ++moved;
+        }
+        return moved;
+    }
+
+    // Refuse further items and wake every waiting consumer; queued items can still be taken
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
         }
         cv.notify_all();
     }
 
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    void clean() {
+        std::deque<T> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dropped.swap(queue_);
+        }
+        cv.notify_all();
+        // Items are destroyed outside the lock
+    }
+
     bool empty() const {
         std::lock_guard<std::mutex> lock(mutex_);
         return queue_.empty();
@@ -58,7 +122,17 @@ public:
     }
 
 private:
+    bool take_unsafe(T& item) {
+        if (queue_.empty()) {
+            return false;
+        }
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        return true;
+    }
+
     mutable std::condition_variable cv;
     mutable std::mutex mutex_;
-    std::queue<T> queue_;
-};
\ No newline at end of file
+    std::deque<T> queue_;
+    bool closed_ = false;
+};
@@ -0,0 +1,140 @@
+#include "spill_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <vector>
+#endif
+
+namespace util {
+
+SpillFile::~SpillFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool SpillFile::open(const std::string& directory)
+{
+    close();
+    int wideLen = MultiByteToWideChar(CP_UTF8, 0, directory.c_str(), -1, nullptr, 0);
+    if (wideLen <= 0) return false;
+    std::wstring wideDir(static_cast<size_t>(wideLen), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, directory.c_str(), -1, wideDir.data(), wideLen);
+
+    wchar_t path[MAX_PATH];
+    if (GetTempFileNameW(wideDir.c_str(), L"bps", 0, path) == 0) return false;
+    // Temporary + delete-on-close: the cache manager keeps pages in RAM when it can
+    HANDLE file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        DeleteFileW(path);
+        return false;
+    }
+    file_ = file;
+    open_ = true;
+    return true;
+}
+
+bool SpillFile::reserve(uint64_t size)
+{
+    if (!open_) return false;
+    if (size <= size_) return true;
+    const uint64_t newSize = (size + GROW_STEP - 1) / GROW_STEP * GROW_STEP;
+
+    unmap();
+    // Creating a larger mapping extends the file
+    HANDLE mapping = CreateFileMappingW(static_cast<HANDLE>(file_), nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(newSize >> 32),
+                                        static_cast<DWORD>(newSize & 0xFFFFFFFFu), nullptr);
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(newSize));
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<uint8_t*>(view);
+    size_ = newSize;
+    return true;
+}
+
+void SpillFile::unmap()
+{
+    if (data_) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(static_cast<HANDLE>(mapping_));
+        mapping_ = nullptr;
+    }
+    size_ = 0;
+}
+
+void SpillFile::close()
+{
+    unmap();
+    if (file_) {
+        CloseHandle(static_cast<HANDLE>(file_));
+        file_ = nullptr;
+    }
+    open_ = false;
+}
+#else
+bool SpillFile::open(const std::string& directory)
+{
+    close();
+    std::string pattern = directory + "/bp_spill_XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+    int fd = mkstemp(path.data());
+    if (fd < 0) return false;
+    // Nothing else needs the name; the space is released once the fd closes
+    unlink(path.data());
+    fd_ = fd;
+    open_ = true;
+    return true;
+}
+
+bool SpillFile::reserve(uint64_t size)
+{
+    if (!open_) return false;
+    if (size <= size_) return true;
+    const uint64_t newSize = (size + GROW_STEP - 1) / GROW_STEP * GROW_STEP;
+
+    if (ftruncate(fd_, static_cast<off_t>(newSize)) != 0) return false;
+    void* view = mmap(nullptr, static_cast<size_t>(newSize), PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (view == MAP_FAILED) return false;
+    unmap();
+    data_ = static_cast<uint8_t*>(view);
+    size_ = newSize;
+    return true;
+}
+
+void SpillFile::unmap()
+{
+    if (data_) {
+        munmap(data_, static_cast<size_t>(size_));
+        data_ = nullptr;
+    }
+    size_ = 0;
+}
+
+void SpillFile::close()
+{
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    open_ = false;
+}
+#endif
+
+}
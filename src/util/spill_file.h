@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace util {
+/**
+ * @brief Growable read/write memory mapping of an anonymous temporary file.
+ *
+ * Used as overflow storage when an in-memory buffer is full: the pages are backed by
+ * the file, so the OS can write them out instead of holding them in RAM. The file is
+ * deleted when the SpillFile is closed (or the process exits). Not thread-safe.
+ */
+class SpillFile {
+public:
+    // Mapping grows in steps of this many bytes
+    static constexpr uint64_t GROW_STEP = 16 * 1024 * 1024;
+
+    SpillFile() = default;
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // Create an empty temporary file in directory (UTF-8). Returns false if that fails.
+    bool open(const std::string& directory);
+    void close();
+
+    /**
+     * @brief Make at least size bytes addressable, extending the file and remapping it.
+     * Pointers from data() are invalidated when the mapping grows.
+     */
+    bool reserve(uint64_t size);
+
+    bool isOpen() const { return open_; }
+    uint8_t* data() const { return data_; }
+    uint64_t size() const { return size_; }
+
+private:
+    void unmap();
+
+    bool open_ = false;
+    uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;       // HANDLE
+    void* mapping_ = nullptr;    // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+
+namespace util {
+/**
+ * @brief Bounded single-producer/single-consumer byte ring with span-based I/O
+ *
+ * The producer asks for the contiguous free region with acquireWrite(), fills
+ * it in place and publishes it with commitWrite(); the consumer does the same
+ * with acquireRead()/commitRead(). Neither side takes a lock or copies through
+ * an intermediate buffer. waitWritable()/waitReadable() only fall back to a
+ * mutex + condition variable when a side actually has to sleep.
+ *
+ * Closing: closeWriter() marks the end of the data (the reader drains what is
+ * left, then sees EOF); closeReader() tells the writer nobody will read any more.
+ *
+ * Exactly one thread may produce and exactly one thread may consume.
+ * The close calls may come from any thread.
+ */
+class SpscByteRing {
+public:
+    // @param capacity Size in bytes, rounded up to a power of two
+    explicit SpscByteRing(size_t capacity) {
+        if (capacity == 0) throw std::invalid_argument("SpscByteRing capacity must be > 0");
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        bytes_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    SpscByteRing(const SpscByteRing&) = delete;
+    SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+    // Producer side: contiguous free region, empty when the ring is full.
+    // The region stays valid until commitWrite().
+    std::pair<char*, size_t> acquireWrite() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t free = bytes_.size() - (tail - head);
+        const size_t offset = tail & mask_;
+        return { bytes_.data() + offset, std::min(free, bytes_.size() - offset) };
+    }
+
+    // Producer side: publish count bytes written into acquireWrite()
+    void commitWrite(size_t count) {
+        if (count == 0) return;
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        wake(readerWaiting_, readerCv_);
+    }
+
+    // Consumer side: contiguous readable region, empty when the ring is empty.
+    // The region stays valid until commitRead().
+    std::pair<const char*, size_t> acquireRead() const {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t offset = head & mask_;
+        return { bytes_.data() + offset, std::min(tail - head, bytes_.size() - offset) };
+    }
+
+    // Consumer side: release count bytes taken from acquireRead()
+    void commitRead(size_t count) {
+        if (count == 0) return;
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        wake(writerWaiting_, writerCv_);
+    }
+
+    // Producer side: copy as much of data as fits without blocking, returns the bytes taken
+    size_t tryWrite(const char* data, size_t count) {
+        size_t written = 0;
+        while (written < count) {
+            auto span = acquireWrite();
+            if (span.second == 0) break;
+            const size_t chunk = std::min(span.second, count - written);
+            std::memcpy(span.first, data + written, chunk);
+            commitWrite(chunk);
+            written += chunk;
+        }
+        return written;
+    }
+
+    // Consumer side: copy up to count buffered bytes without blocking, returns the bytes read
+    size_t tryRead(char* out, size_t count) {
+        size_t read = 0;
+        while (read < count) {
+            auto span = acquireRead();
+            if (span.second == 0) break;
+            const size_t chunk = std::min(span.second, count - read);
+            std::memcpy(out + read, span.first, chunk);
+            commitRead(chunk);
+            read += chunk;
+        }
+        return read;
+    }
+
+    // Producer side: block until there is free space.
+    // Returns false if the reader was closed (nothing more should be written).
+    bool waitWritable() {
+        while (!readerClosed() && size() == bytes_.size()) {
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            writerWaiting_.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            writerCv_.wait(lock, [this]() {
+                return size() < bytes_.size() || readerClosed();
+            });
+            writerWaiting_.store(false, std::memory_order_relaxed);
+        }
+        return !readerClosed();
+    }
+
+    // Consumer side: block until data arrives.
+    // Returns false only when the writer is closed and the ring is drained (EOF).
+    bool waitReadable() {
+        while (empty()) {
+            if (writerClosed()) {
+                // Re-check: the last commit may have landed just before the close
+                return !empty();
+            }
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            readerWaiting_.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            readerCv_.wait(lock, [this]() {
+                return !empty() || writerClosed();
+            });
+            readerWaiting_.store(false, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // No more data will be written; the reader sees EOF once the ring is drained
+    void closeWriter() {
+        writerClosed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        readerCv_.notify_all();
+    }
+
+    // Nobody reads any more; wakes a writer blocked in waitWritable()
+    void closeReader() {
+        readerClosed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        writerCv_.notify_all();
+    }
+
+    bool writerClosed() const { return writerClosed_.load(std::memory_order_acquire); }
+    bool readerClosed() const { return readerClosed_.load(std::memory_order_acquire); }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t capacity() const { return bytes_.size(); }
+
+private:
+    void wake(std::atomic<bool>& waiting, std::condition_variable& cv) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            cv.notify_one();
+        }
+    }
+
+    std::vector<char> bytes_;
+    size_t mask_ = 0;
+
+    // Producer and consumer indices live on separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+    alignas(64) std::atomic<bool> writerClosed_{false};
+    std::atomic<bool> readerClosed_{false};
+    std::atomic<bool> writerWaiting_{false};
+    std::atomic<bool> readerWaiting_{false};
+    std::mutex waitMutex_;
+    std::condition_variable writerCv_;
+    std::condition_variable readerCv_;
+};
+} // namespace util
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+
+namespace util {
+/**
+ * @brief Bounded single-producer/single-consumer ring queue
+ *
+ * tryPush/tryPop are wait-free and never take a lock. The blocking
+ * variants (push/waitPop) only fall back to a mutex + condition variable
+ * when they actually have to sleep, so the steady-state hand-off between
+ * one producer thread and one consumer thread is lock-free.
+ *
+ * Backpressure: push() blocks once the queue reaches the high watermark
+ * and resumes only after the consumer has drained it down to the low
+ * watermark, which keeps the producer from waking up for every slot.
+ *
+ * Exactly one thread may produce and exactly one thread may consume.
+ * close() may be called from any thread.
+ *
+ * @tparam T Type of elements stored (must be default constructible and movable)
+ */
+template <typename T>
+class SpscRingQueue {
+public:
+    /**
+     * @param capacity Maximum number of elements, rounded up to a power of two
+     * @param highWatermark push() blocks when size() reaches this value (0 = 3/4 of capacity)
+     * @param lowWatermark blocked push() resumes when size() drops to this value (0 = 1/4 of capacity)
+     */
+    explicit SpscRingQueue(size_t capacity, size_t highWatermark = 0, size_t lowWatermark = 0) {
+        if (capacity == 0) throw std::invalid_argument("SpscRingQueue capacity must be > 0");
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+
+        high_ = highWatermark == 0 ? std::max<size_t>(1, cap - cap / 4) : std::min(highWatermark, cap);
+        low_ = lowWatermark == 0 ? cap / 4 : lowWatermark;
+        if (low_ >= high_) low_ = high_ - 1;
+    }
+
+    ~SpscRingQueue() {
+        close();
+    }
+
+    SpscRingQueue(const SpscRingQueue&) = delete;
+    SpscRingQueue& operator=(const SpscRingQueue&) = delete;
+
+    // Producer side: enqueue without blocking, returns false if full or closed.
+    bool tryPush(T item) {
+        if (closed_.load(std::memory_order_acquire)) return false;
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        if (tail - head >= slots_.size()) return false;
+        slots_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        wakeConsumer();
+        return true;
+    }
+
+    // Producer side: enqueue, blocking while the queue is above the high watermark.
+    // Returns false if the queue was closed before the item could be stored.
+    bool push(T item) {
+        if (size() >= high_) {
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            producerWaiting_.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            producerCv_.wait(lock, [this]() {
+                return size() <= low_ || closed_.load(std::memory_order_acquire);
+            });
+            producerWaiting_.store(false, std::memory_order_relaxed);
+        }
+        return tryPush(std::move(item));
+    }
+
+    // Consumer side: dequeue without blocking, returns false if empty.
+    bool tryPop(T& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        if (head == tail) return false;
+        item = std::move(slots_[head & mask_]);
+        slots_[head & mask_] = T();
+        head_.store(head + 1, std::memory_order_release);
+        wakeProducer(tail - head - 1);
+        return true;
+    }
+
+    // Consumer side: dequeue, blocking until an item arrives or the queue is closed.
+    // Returns false only when the queue is closed and fully drained.
+    bool waitPop(T& item) {
+        while (!tryPop(item)) {
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            consumerWaiting_.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            consumerCv_.wait(lock, [this]() {
+                return !empty() || closed_.load(std::memory_order_acquire);
+            });
+            consumerWaiting_.store(false, std::memory_order_relaxed);
+            if (empty() && closed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Reject further pushes and wake both sides. Items already queued can still be popped.
+    void close() {
+        closed_.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        producerCv_.notify_all();
+        consumerCv_.notify_all();
+    }
+
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+    // Consumer side (or after the consumer has stopped): drop every queued item.
+    void clean() {
+        T item;
+        while (tryPop(item)) {
+        }
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t capacity() const { return slots_.size(); }
+    size_t highWatermark() const { return high_; }
+    size_t lowWatermark() const { return low_; }
+
+private:
+    void wakeConsumer() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumerWaiting_.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            consumerCv_.notify_one();
+        }
+    }
+
+    void wakeProducer(size_t remaining) {
+        if (remaining > low_) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (producerWaiting_.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            producerCv_.notify_one();
+        }
+    }
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+    size_t high_ = 0;
+    size_t low_ = 0;
+
+    // Producer and consumer indices live on separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+    alignas(64) std::atomic<bool> closed_{false};
+    std::atomic<bool> producerWaiting_{false};
+    std::atomic<bool> consumerWaiting_{false};
+    std::mutex waitMutex_;
+    std::condition_variable producerCv_;
+    std::condition_variable consumerCv_;
+};
+} // namespace util
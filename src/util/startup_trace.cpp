@@ -0,0 +1,102 @@
+#include "startup_trace.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace util {
+
+StartupTrace& StartupTrace::instance()
+{
+    static StartupTrace trace;
+    return trace;
+}
+
+StartupTrace::StartupTrace()
+    : origin_(Clock::now())
+{
+}
+
+void StartupTrace::start(Clock::time_point origin)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    origin_ = origin;
+    spans_.clear();
+    marks_.clear();
+}
+
+void StartupTrace::record(const std::string& name, Clock::time_point begin, Clock::time_point end)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    spans_.push_back({name, sinceOrigin_unsafe(begin), std::chrono::duration<double, std::milli>(end - begin).count()});
+}
+
+bool StartupTrace::mark(const std::string& name)
+{
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::find(marks_.begin(), marks_.end(), name) != marks_.end()) {
+        return false;
+    }
+    marks_.push_back(name);
+    spans_.push_back({name, sinceOrigin_unsafe(now), 0});
+    return true;
+}
+
+bool StartupTrace::hasMark(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::find(marks_.begin(), marks_.end(), name) != marks_.end();
+}
+
+double StartupTrace::elapsedMs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sinceOrigin_unsafe(Clock::now());
+}
+
+std::vector<StartupTrace::Span> StartupTrace::spans() const
+{
+    std::vector<Span> spans;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spans = spans_;
+    }
+    // Enclosing spans first when two start together
+    std::stable_sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) {
+        return a.startMs != b.startMs ? a.startMs < b.startMs : a.durationMs > b.durationMs;
+    });
+    return spans;
+}
+
+std::string StartupTrace::summary() const
+{
+    const std::vector<Span> spans = this->spans();
+    std::string text;
+    std::vector<double> openEnds;       // End times of the spans enclosing the current one
+    for (const Span& span : spans) {
+        // Indented under the spans containing it; one merely overlapping (on another thread) isn't
+        const double end = span.startMs + span.durationMs;
+        while (!openEnds.empty() && (span.startMs >= openEnds.back() || end > openEnds.back())) {
+            openEnds.pop_back();
+        }
+        char times[64];
+        if (span.durationMs > 0) {
+            std::snprintf(times, sizeof(times), "%9.1f ms %9.1f ms  ", span.startMs, span.durationMs);
+        } else {
+            std::snprintf(times, sizeof(times), "%9.1f ms %12s  ", span.startMs, "mark");
+        }
+        text += times;
+        text.append(openEnds.size() * 2, ' ');
+        text += span.name;
+        text += '\n';
+        if (span.durationMs > 0) {
+            openEnds.push_back(end);
+        }
+    }
+    return text;
+}
+
+double StartupTrace::sinceOrigin_unsafe(Clock::time_point time) const
+{
+    return std::chrono::duration<double, std::milli>(time - origin_).count();
+}
+}
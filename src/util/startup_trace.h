@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace util {
+/**
+ * @brief Timeline of application startup: spans around the initializers and one-off
+ * marks such as the first painted frame, in milliseconds since the process started.
+ *
+ * The origin is the first instance() call unless start() sets it; call that first thing
+ * in main(). Thread-safe; spans are meant for startup only and are kept until exit.
+ */
+class StartupTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Span {
+        std::string name;
+        double startMs = 0;
+        double durationMs = 0;      // 0 for marks
+    };
+
+    // Times the enclosing block as a span
+    class Scope {
+    public:
+        explicit Scope(std::string name) : name_(std::move(name)), begin_(Clock::now()) {}
+        ~Scope() { StartupTrace::instance().record(name_, begin_, Clock::now()); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::string name_;
+        Clock::time_point begin_;
+    };
+
+    static StartupTrace& instance();
+
+    void start(Clock::time_point origin = Clock::now());
+    void record(const std::string& name, Clock::time_point begin, Clock::time_point end);
+    // Record an instant; only the first mark of a name counts, false for later ones
+    bool mark(const std::string& name);
+    bool hasMark(const std::string& name) const;
+
+    double elapsedMs() const;
+    // Spans and marks by start time
+    std::vector<Span> spans() const;
+    // One line per span: start, duration and name, indented by nesting
+    std::string summary() const;
+
+private:
+    StartupTrace();
+    double sinceOrigin_unsafe(Clock::time_point time) const;
+
+    mutable std::mutex mutex_;
+    Clock::time_point origin_;
+    std::vector<Span> spans_;
+    std::vector<std::string> marks_;
+};
+}
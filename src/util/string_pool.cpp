@@ -0,0 +1,47 @@
+#include "string_pool.h"
+
+namespace util {
+
+QString StringPool::intern(const QString& text)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = strings_.constFind(text);
+    if (it == strings_.constEnd()) {
+        it = strings_.insert(text);
+    }
+    return *it;
+}
+
+void StringPool::internInPlace(QString& text)
+{
+    if (!text.isEmpty()) {
+        text = intern(text);
+    }
+}
+
+void StringPool::prune()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = strings_.begin(); it != strings_.end();) {
+        // Detached: no one else refers to the buffer any more
+        if (it->isDetached()) {
+            it = strings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void StringPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    strings_.clear();
+}
+
+int StringPool::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(strings_.size());
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QSet>
+#include <QString>
+#include <mutex>
+
+namespace util {
+/**
+ * @brief Table of shared strings, so equal strings held in many places share one buffer.
+ *
+ * intern() returns the pooled copy of a string, adding it first if it is new. QString is
+ * implicitly shared, so every interned copy is a reference to the same characters rather
+ * than its own allocation. Meant for fields that repeat across a large collection, such as
+ * the uploader of thousands of songs. Thread-safe.
+ */
+class StringPool {
+public:
+    StringPool() = default;
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    QString intern(const QString& text);
+    // Intern text in place; empty strings are left alone
+    void internInPlace(QString& text);
+
+    // Drop strings the pool alone still holds
+    void prune();
+    void clear();
+    int size() const;
+
+private:
+    mutable std::mutex mutex_;
+    QSet<QString> strings_;
+};
+}
@@ -0,0 +1,142 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace util {
+
+namespace {
+    // Pool whose worker is running on this thread, if any
+    thread_local const ThreadPool* t_current_pool = nullptr;
+}
+
+ThreadPool::ThreadPool(size_t threads, size_t reservedThreads) {
+    threads = std::max<size_t>(threads, 1);
+    low_limit_ = reservedThreads < threads ? threads - reservedThreads : 1;
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool ThreadPool::onWorkerThread() const {
+    return t_current_pool == this;
+}
+
+ThreadPool::Stats ThreadPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.threads = workers_.size();
+    stats.active = active_;
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i) {
+        stats.queued[i] = queues_[i].size();
+    }
+    stats.peakQueued = peak_queued_;
+    stats.submitted = submitted_;
+    stats.completed = completed_;
+    return stats;
+}
+
+/*************** Private Methods ***************/
+void ThreadPool::enqueue(Priority priority, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queues_[static_cast<size_t>(priority)].push_back(std::move(task));
+        ++submitted_;
+        peak_queued_ = std::max(peak_queued_, queuedCount_unsafe());
+    }
+    work_ready_.notify_one();
+    if (priority != Priority::Low) {
+        // A worker blocked in wait() may pick it up
+        task_done_.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    t_current_pool = this;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        work_ready_.wait(lock, [this]() {
+            return hasRunnable_unsafe() || (stopping_ && queuedCount_unsafe() == 0);
+        });
+        Task task;
+        Priority priority;
+        if (!popTask_unsafe(true, task, priority)) {
+            return;     // Stopping and drained
+        }
+        runTask_unsafe(lock, task, priority);
+    }
+}
+
+bool ThreadPool::helpOne() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Task task;
+    Priority priority;
+    if (!popTask_unsafe(false, task, priority)) {
+        return false;
+    }
+    runTask_unsafe(lock, task, priority);
+    return true;
+}
+
+bool ThreadPool::popTask_unsafe(bool allowLow, Task& task, Priority& priority) {
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i) {
+        priority = static_cast<Priority>(i);
+        if (priority == Priority::Low && (!allowLow || running_low_ >= low_limit_)) {
+            break;
+        }
+        if (!queues_[i].empty()) {
+            task = std::move(queues_[i].front());
+            queues_[i].pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask_unsafe(std::unique_lock<std::mutex>& lock, Task& task, Priority priority) {
+    ++active_;
+    if (priority == Priority::Low) ++running_low_;
+    lock.unlock();
+    task();     // packaged_task: exceptions end up in the future
+    task = nullptr;
+    lock.lock();
+    --active_;
+    ++completed_;
+    if (priority == Priority::Low) {
+        --running_low_;
+        // A Low task held back by the limit can start now
+        work_ready_.notify_one();
+    }
+    task_done_.notify_all();
+}
+
+bool ThreadPool::hasRunnable_unsafe() const {
+    return hasHelpable_unsafe()
+        || (!queues_[static_cast<size_t>(Priority::Low)].empty() && running_low_ < low_limit_);
+}
+
+bool ThreadPool::hasHelpable_unsafe() const {
+    return !queues_[static_cast<size_t>(Priority::High)].empty()
+        || !queues_[static_cast<size_t>(Priority::Normal)].empty();
+}
+
+size_t ThreadPool::queuedCount_unsafe() const {
+    size_t count = 0;
+    for (const auto& queue : queues_) {
+        count += queue.size();
+    }
+    return count;
+}
+}
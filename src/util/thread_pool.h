@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace util {
+/**
+ * @brief Fixed set of worker threads running queued tasks by priority.
+ *
+ * High tasks run before Normal ones, Normal before Low, first in first out within a
+ * priority. Low tasks are for long background work: at most threads - reservedThreads of
+ * them run at once, so the reserved workers stay free for High and Normal tasks.
+ *
+ * A task that waits for tasks it submitted must use wait() instead of blocking on the
+ * future: on a worker it keeps running queued High and Normal tasks meanwhile, so a full
+ * pool can't deadlock on itself. The destructor runs every queued task, then joins.
+ */
+class ThreadPool {
+public:
+    enum class Priority { High, Normal, Low };
+    static constexpr size_t PRIORITY_COUNT = 3;
+    // How often wait() rechecks a future that no pool task completes
+    static constexpr std::chrono::milliseconds HELP_POLL{20};
+
+    struct Stats {
+        size_t threads = 0;
+        size_t active = 0;                      // Tasks running, helped ones included
+        size_t queued[PRIORITY_COUNT] = {};     // Waiting tasks by priority
+        size_t peakQueued = 0;                  // Deepest the whole queue has been
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+    };
+
+    explicit ThreadPool(size_t threads, size_t reservedThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue func; its result or exception is delivered through the future
+    template <typename F>
+    auto submit(Priority priority, F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(func));
+        std::future<R> future = task->get_future();
+        enqueue(priority, [task]() { (*task)(); });
+        return future;
+    }
+
+    // Block until future (std::future or std::shared_future) is ready, helping on a worker
+    template <typename Future>
+    void wait(const Future& future) {
+        if (!onWorkerThread()) {
+            future.wait();
+            return;
+        }
+        auto ready = [&future]() {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        };
+        while (!ready()) {
+            if (helpOne()) continue;
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_done_.wait_for(lock, HELP_POLL, [&]() { return ready() || hasHelpable_unsafe(); });
+        }
+    }
+
+    // Whether the calling thread is one of this pool's workers
+    bool onWorkerThread() const;
+    size_t threadCount() const { return workers_.size(); }
+    Stats stats() const;
+
+private:
+    using Task = std::function<void()>;
+
+    void enqueue(Priority priority, Task task);
+    void workerLoop();
+    // Run one queued High or Normal task on the calling thread; false if there is none
+    bool helpOne();
+    // Pop the next task; Low ones only when allowLow and below the Low limit
+    bool popTask_unsafe(bool allowLow, Task& task, Priority& priority);
+    // Runs task with the lock released; lock is held again on return
+    void runTask_unsafe(std::unique_lock<std::mutex>& lock, Task& task, Priority priority);
+    bool hasRunnable_unsafe() const;
+    bool hasHelpable_unsafe() const;
+    size_t queuedCount_unsafe() const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;        // Tasks queued, a Low slot freed or stopping
+    std::condition_variable task_done_;         // Wakes wait() callers
+    std::deque<Task> queues_[PRIORITY_COUNT];
+    std::vector<std::thread> workers_;
+    size_t low_limit_;
+    size_t running_low_ = 0;
+    size_t active_ = 0;
+    size_t peak_queued_ = 0;
+    uint64_t submitted_ = 0;
+    uint64_t completed_ = 0;
+    bool stopping_ = false;
+};
+}
@@ -0,0 +1,58 @@
+#include "thread_priority.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <avrt.h>
+#endif
+
+namespace util {
+
+#ifdef _WIN32
+ScopedThreadPriority::ScopedThreadPriority(ThreadRole role)
+{
+    switch (role) {
+    case ThreadRole::RealtimeAudio: {
+        DWORD taskIndex = 0;
+        HANDLE task = AvSetMmThreadCharacteristicsW(L"Pro Audio", &taskIndex);
+        if (task) {
+            AvSetMmThreadPriority(task, AVRT_PRIORITY_HIGH);
+            mmcss_handle_ = task;
+            applied_ = true;
+        } else {
+            // MMCSS service disabled or the task name is unknown: still outrank normal threads
+            applied_ = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+        }
+        break;
+    }
+    case ThreadRole::AudioWorker:
+        applied_ = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL) != 0;
+        break;
+    case ThreadRole::Background:
+        background_ = SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) != 0;
+        applied_ = background_ || SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST) != 0;
+        break;
+    }
+}
+
+ScopedThreadPriority::~ScopedThreadPriority()
+{
+    if (mmcss_handle_) {
+        AvRevertMmThreadCharacteristics(static_cast<HANDLE>(mmcss_handle_));
+        mmcss_handle_ = nullptr;
+    }
+    if (background_) {
+        SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+        background_ = false;
+    }
+}
+#else
+ScopedThreadPriority::ScopedThreadPriority(ThreadRole)
+{
+}
+
+ScopedThreadPriority::~ScopedThreadPriority()
+{
+}
+#endif
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+namespace util {
+/**
+ * @brief Scheduling class of a long-running audio thread.
+ *
+ * RealtimeAudio threads hand PCM to the device (WASAPI render thread, push-mode
+ * frame transmission thread). They are registered with MMCSS as "Pro Audio" and must
+ * not log, allocate or block on anything but the device once running.
+ * AudioWorker threads feed them (decoder, stream reader, audio event processor) and only
+ * get a raised priority so a busy desktop doesn't starve the queue they fill.
+ * Background threads do bulk work nobody is waiting on (loudness analysis) and run in
+ * the OS background mode, which also lowers their disk and memory priority.
+ */
+enum class ThreadRole {
+    RealtimeAudio,
+    AudioWorker,
+    Background,
+};
+
+/**
+ * @brief Applies a ThreadRole to the calling thread for the lifetime of the object.
+ *
+ * Construct it at the top of the thread function, before entering the loop; the
+ * destructor reverts the MMCSS registration. Setup never logs, callers decide whether
+ * to report a failed registration (before the real-time loop starts).
+ * No-op on platforms without MMCSS.
+ */
+class ScopedThreadPriority {
+public:
+    explicit ScopedThreadPriority(ThreadRole role);
+    ~ScopedThreadPriority();
+
+    ScopedThreadPriority(const ScopedThreadPriority&) = delete;
+    ScopedThreadPriority& operator=(const ScopedThreadPriority&) = delete;
+
+    // Whether the thread runs in the requested class (MMCSS task or raised priority)
+    bool applied() const { return applied_; }
+    // Whether the thread is registered as an MMCSS task
+    bool mmcss() const { return mmcss_handle_ != nullptr; }
+
+private:
+    void* mmcss_handle_ = nullptr;   // HANDLE returned by AvSetMmThreadCharacteristics
+    bool background_ = false;        // thread entered THREAD_MODE_BACKGROUND_BEGIN
+    bool applied_ = false;
+};
+}
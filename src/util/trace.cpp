@@ -0,0 +1,189 @@
+#include "trace.h"
+
+namespace util {
+
+std::atomic<bool> Tracer::enabled_{false};
+
+namespace {
+void writeJsonString(std::FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+        }
+        std::fputc(*c, file);
+    }
+    std::fputc('"', file);
+}
+}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer()
+{
+    stop();
+}
+
+bool Tracer::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> control(controlMutex_);
+    stop_unsafe();
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::fputs("[\n", file);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_ = file;
+        path_ = path;
+        firstEvent_ = true;
+        // Spans recorded while stopping the previous trace don't belong to this one
+        for (const auto& buffer : buffers_) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            buffer->events.clear();
+            buffer->nameWritten = false;
+        }
+    }
+    origin_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    writer_ = std::thread(&Tracer::writerLoop, this);
+    enabled_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void Tracer::stop()
+{
+    std::lock_guard<std::mutex> control(controlMutex_);
+    stop_unsafe();
+}
+
+void Tracer::stop_unsafe()
+{
+    enabled_.store(false, std::memory_order_relaxed);
+    if (!writer_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    writer_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::fputs("\n]\n", file_);
+    std::fclose(file_);
+    file_ = nullptr;
+    stopping_ = false;
+}
+
+std::string Tracer::path() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return path_;
+}
+
+void Tracer::complete(const char* category, const char* name, Clock::time_point begin, Clock::time_point end)
+{
+    if (!enabled()) {
+        return;     // Stopped while the span was open
+    }
+    const Clock::time_point origin{Clock::duration(origin_.load(std::memory_order_relaxed))};
+    ThreadBuffer& buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= BUFFER_EVENTS) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events.push_back({category, name,
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(begin - origin).count(),
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()});
+}
+
+void Tracer::setThreadName(const char* name)
+{
+    ThreadBuffer& buffer = instance().localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+}
+
+Tracer::ThreadBuffer& Tracer::localBuffer()
+{
+    // Shared with the writer so spans of an exiting thread are still written
+    thread_local std::shared_ptr<ThreadBuffer> local;
+    if (!local) {
+        local = std::make_shared<ThreadBuffer>();
+        local->events.reserve(BUFFER_EVENTS);
+        std::lock_guard<std::mutex> lock(mutex_);
+        local->tid = nextTid_++;
+        buffers_.push_back(local);
+    }
+    return *local;
+}
+
+void Tracer::writerLoop()
+{
+    // Swapped with each thread's buffer, so neither side allocates once both are reserved
+    std::vector<Event> spare;
+    spare.reserve(BUFFER_EVENTS);
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Drains at least once, so what is buffered when stop() comes (even before this
+    // thread first ran) is still written
+    do {
+        wake_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this]() { return stopping_; });
+        drain_unsafe(spare);
+    } while (!stopping_);
+}
+
+void Tracer::drain_unsafe(std::vector<Event>& spare)
+{
+    for (auto it = buffers_.begin(); it != buffers_.end();) {
+        ThreadBuffer& buffer = **it;
+        const char* threadName;
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+            buffer.events.swap(spare);
+            threadName = buffer.threadName;
+        }
+        if (threadName && !buffer.nameWritten) {
+            std::fputs(firstEvent_ ? "" : ",\n", file_);
+            firstEvent_ = false;
+            std::fprintf(file_, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                         static_cast<unsigned>(buffer.tid));
+            writeJsonString(file_, threadName);
+            std::fputs("}}", file_);
+            buffer.nameWritten = true;
+        }
+        writeEvents_unsafe(buffer, spare);
+        spare.clear();
+        // Only we hold it once its thread has exited, and it was just emptied
+        if (it->use_count() == 1) {
+            it = buffers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::fflush(file_);
+}
+
+void Tracer::writeEvents_unsafe(const ThreadBuffer& buffer, const std::vector<Event>& events)
+{
+    for (const Event& event : events) {
+        std::fputs(firstEvent_ ? "" : ",\n", file_);
+        firstEvent_ = false;
+        std::fputs("{\"name\":", file_);
+        writeJsonString(file_, event.name);
+        std::fputs(",\"cat\":", file_);
+        writeJsonString(file_, event.category);
+        // Chrome trace times are in microseconds
+        std::fprintf(file_, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     static_cast<unsigned>(buffer.tid), event.beginNs / 1000.0, event.durationNs / 1000.0);
+    }
+}
+}
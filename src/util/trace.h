@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace util {
+/**
+ * @brief Timed spans from every thread, written to a Chrome trace file (chrome://tracing,
+ * ui.perfetto.dev) to see how decoding, networking and UI work line up across threads.
+ *
+ * Each thread records into a buffer of its own; a writer thread collects the buffers
+ * every FLUSH_INTERVAL_MS and appends them to the file, so recording never touches disk.
+ * A full buffer drops spans (counted) instead of growing, which keeps recording
+ * allocation-free on the real-time audio thread after its first span.
+ *
+ * While stopped a TRACE_SCOPE costs one relaxed atomic load. The file is a JSON array
+ * closed by stop(); the viewers also accept one cut short by a crash.
+ */
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int FLUSH_INTERVAL_MS = 200;
+    static constexpr size_t BUFFER_EVENTS = 2048;      // Per thread and flush interval
+
+    static Tracer& instance();
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Start a new trace at path, stopping the current one; false if it can't be created
+    bool start(const std::string& path);
+    // Write what the threads have recorded and close the file
+    void stop();
+    std::string path() const;
+    // Spans dropped on full buffers since start()
+    uint64_t droppedEvents() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // name and category must outlive the trace: string literals or static names
+    void complete(const char* category, const char* name, Clock::time_point begin, Clock::time_point end);
+    // Label the calling thread in the viewer
+    static void setThreadName(const char* name);
+
+    ~Tracer();
+
+private:
+    struct Event {
+        const char* category;
+        const char* name;
+        int64_t beginNs;
+        int64_t durationNs;
+    };
+    struct ThreadBuffer {
+        std::mutex mutex;                   // Taken by the writer only to swap events out
+        std::vector<Event> events;
+        const char* threadName = nullptr;
+        bool nameWritten = false;           // Writer only
+        uint32_t tid = 0;
+    };
+
+    Tracer() = default;
+    ThreadBuffer& localBuffer();
+    void stop_unsafe();                     // With controlMutex_ held
+    void writerLoop();
+    // Append every buffer's events to the file; prune buffers of exited threads
+    void drain_unsafe(std::vector<Event>& spare);
+    void writeEvents_unsafe(const ThreadBuffer& buffer, const std::vector<Event>& events);
+
+    static std::atomic<bool> enabled_;
+
+    std::mutex controlMutex_;               // Serializes start() and stop()
+    mutable std::mutex mutex_;              // Guards the members below
+    std::condition_variable wake_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    uint32_t nextTid_ = 1;
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    bool firstEvent_ = true;
+    bool stopping_ = false;
+    std::atomic<Clock::rep> origin_{0};     // Start of the trace, in Clock ticks
+    std::thread writer_;
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * @brief Records the enclosing block as a span when tracing is on.
+ */
+class TraceScope {
+public:
+    TraceScope(const char* category, const char* name)
+        : name_(Tracer::enabled() ? name : nullptr)
+        , category_(category)
+    {
+        if (name_) {
+            begin_ = Tracer::Clock::now();
+        }
+    }
+    ~TraceScope()
+    {
+        if (name_) {
+            Tracer::instance().complete(category_, name_, begin_, Tracer::Clock::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    Tracer::Clock::time_point begin_;
+};
+}
+
+#define UTIL_TRACE_CONCAT_(a, b) a##b
+#define UTIL_TRACE_CONCAT(a, b) UTIL_TRACE_CONCAT_(a, b)
+// Time the rest of the enclosing block as category/name
+#define TRACE_SCOPE(category, name) ::util::TraceScope UTIL_TRACE_CONCAT(traceScope_, __LINE__)(category, name)
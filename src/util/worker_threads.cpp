@@ -0,0 +1,103 @@
+#include "worker_threads.h"
+
+namespace util {
+
+// ---------------- Job ----------------
+
+bool WorkerThreads::Job::done() const {
+    if (!state_) return true;
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->done;
+}
+
+void WorkerThreads::Job::wait() const {
+    if (!state_) return;
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->finished.wait(lock, [this]() { return state_->done; });
+}
+
+void WorkerThreads::Job::reset() {
+    wait();
+    state_.reset();
+}
+
+// ---------------- WorkerThreads ----------------
+
+WorkerThreads::~WorkerThreads() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& worker : workers_) {
+            worker->wake.notify_one();
+        }
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+WorkerThreads::Job WorkerThreads::run(std::function<void()> job) {
+    auto state = std::make_shared<Job::State>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    Worker* idle = nullptr;
+    for (auto& worker : workers_) {
+        if (!worker->busy) {
+            idle = worker.get();
+            break;
+        }
+    }
+    if (!idle) {
+        workers_.push_back(std::make_unique<Worker>());
+        idle = workers_.back().get();
+        idle->thread = std::thread([this, idle]() { workerLoop(idle); });
+        ++started_;
+    }
+    idle->job = std::move(job);
+    idle->state = state;
+    idle->busy = true;
+    ++jobs_;
+    idle->wake.notify_one();
+    return Job(std::move(state));
+}
+
+WorkerThreads::Stats WorkerThreads::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.threads = workers_.size();
+    for (const auto& worker : workers_) {
+        if (worker->busy) ++stats.busy;
+    }
+    stats.started = started_;
+    stats.jobs = jobs_;
+    return stats;
+}
+
+/*************** Private Methods ***************/
+void WorkerThreads::workerLoop(Worker* worker) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        worker->wake.wait(lock, [this, worker]() { return worker->job || stopping_; });
+        if (!worker->job) {
+            return;     // Stopping and idle
+        }
+        std::function<void()> job = std::move(worker->job);
+        worker->job = nullptr;
+        std::shared_ptr<Job::State> state = std::move(worker->state);
+        lock.unlock();
+
+        job();
+        job = nullptr;      // Release captures before reporting completion
+
+        // Idle before the job reports completion, so a run() right after wait() reuses this thread
+        lock.lock();
+        worker->busy = false;
+        {
+            std::lock_guard<std::mutex> stateLock(state->mutex);
+            state->done = true;
+        }
+        state->finished.notify_all();
+    }
+}
+}
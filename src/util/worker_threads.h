@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+/**
+ * @brief Threads that outlive the jobs they run, for long-running per-track work.
+ *
+ * run() hands a job to an idle thread and only starts a new one when all of them are
+ * busy; a thread whose job returned waits for the next one instead of exiting. Unlike
+ * ThreadPool there is no queue and no upper bound: every job starts right away, since
+ * the jobs (decoding, frame transmission) block for as long as a track plays. The
+ * thread count settles at the most jobs ever running at once.
+ *
+ * Jobs set up their own thread state (ScopedThreadPriority, trace name) and must undo
+ * it before returning. The destructor waits for running jobs, then joins the threads.
+ */
+class WorkerThreads {
+public:
+    // Completion of one run() call; waiting on it replaces joining a std::thread
+    class Job {
+    public:
+        Job() = default;
+
+        // Whether this refers to a job, finished or not
+        bool valid() const { return state_ != nullptr; }
+        bool done() const;
+        // Block until the job returned; no-op for an empty Job. Must not be called from
+        // the job itself
+        void wait() const;
+        // wait(), then forget the job
+        void reset();
+
+    private:
+        friend class WorkerThreads;
+        struct State {
+            mutable std::mutex mutex;
+            std::condition_variable finished;
+            bool done = false;
+        };
+        explicit Job(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+        std::shared_ptr<State> state_;
+    };
+
+    struct Stats {
+        size_t threads = 0;         // Threads alive
+        size_t busy = 0;            // Threads running a job
+        uint64_t started = 0;       // Threads ever started
+        uint64_t jobs = 0;          // Jobs ever run
+    };
+
+    WorkerThreads() = default;
+    ~WorkerThreads();
+
+    WorkerThreads(const WorkerThreads&) = delete;
+    WorkerThreads& operator=(const WorkerThreads&) = delete;
+
+    // Start job on an idle thread, or on a new one if none is idle
+    Job run(std::function<void()> job);
+
+    Stats stats() const;
+
+private:
+    struct Worker {
+        std::thread thread;
+        std::function<void()> job;
+        std::shared_ptr<Job::State> state;
+        std::condition_variable wake;
+        bool busy = false;
+    };
+
+    void workerLoop(Worker* worker);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    uint64_t started_ = 0;
+    uint64_t jobs_ = 0;
+    bool stopping_ = false;
+};
+}
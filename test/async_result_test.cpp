@@ -0,0 +1,137 @@
+/**
+ * AsyncResult Unit Tests
+ *
+ * Tests continuations attached before and after completion, exceptions,
+ * broken promises, whenAll and the std::future bridges.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/async_result.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using util::AsyncPromise;
+using util::AsyncResult;
+
+TEST_CASE("AsyncResult runs continuations", "[AsyncResult]") {
+    AsyncPromise<int> promise;
+    AsyncResult<int> result = promise.result();
+
+    SECTION("attached before completion, run by the completing thread") {
+        std::thread::id ranOn;
+        int seen = 0;
+        result.then([&](const AsyncResult<int>& r) {
+            ranOn = std::this_thread::get_id();
+            seen = r.get();
+        });
+        REQUIRE_FALSE(result.ready());
+        std::thread producer([&]() { promise.setValue(7); });
+        const std::thread::id producerId = producer.get_id();
+        producer.join();
+        REQUIRE(seen == 7);
+        REQUIRE(ranOn == producerId);
+    }
+
+    SECTION("attached after completion, run inline") {
+        promise.setValue(3);
+        int seen = 0;
+        result.then([&](const AsyncResult<int>& r) { seen = r.get(); });
+        REQUIRE(seen == 3);
+    }
+
+    SECTION("the first completion wins") {
+        REQUIRE(promise.setValue(1));
+        REQUIRE_FALSE(promise.setValue(2));
+        REQUIRE_FALSE(promise.setException(std::make_exception_ptr(std::runtime_error("late"))));
+        REQUIRE(result.get() == 1);
+        REQUIRE_FALSE(result.failed());
+    }
+
+    SECTION("exceptions reach get()") {
+        promise.setException(std::make_exception_ptr(std::runtime_error("boom")));
+        REQUIRE(result.failed());
+        REQUIRE(result.exception());
+        REQUIRE_THROWS_AS(result.get(), std::runtime_error);
+    }
+
+    SECTION("get() blocks until completed") {
+        std::thread producer([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            promise.setValue(42);
+        });
+        REQUIRE(result.get() == 42);
+        producer.join();
+    }
+}
+
+TEST_CASE("AsyncPromise dropped unset breaks its result", "[AsyncResult]") {
+    AsyncResult<std::string> result;
+    {
+        AsyncPromise<std::string> promise;
+        result = promise.result();
+        AsyncPromise<std::string> copy = promise;
+    }
+    REQUIRE(result.ready());
+    REQUIRE_THROWS_AS(result.get(), std::future_error);
+}
+
+TEST_CASE("AsyncResult void and ready-made results", "[AsyncResult]") {
+    SECTION("void") {
+        AsyncPromise<void> promise;
+        bool ran = false;
+        promise.result().then([&](const AsyncResult<void>& r) {
+            r.get();
+            ran = true;
+        });
+        promise.setValue();
+        REQUIRE(ran);
+    }
+
+    SECTION("fromValue and fromException") {
+        REQUIRE(AsyncResult<int>::fromValue(5).get() == 5);
+        REQUIRE(AsyncResult<void>::fromValue().ready());
+        auto failed = AsyncResult<int>::fromException(std::make_exception_ptr(std::runtime_error("x")));
+        REQUIRE(failed.failed());
+    }
+}
+
+TEST_CASE("whenAll waits for every result", "[AsyncResult]") {
+    SECTION("empty completes at once") {
+        REQUIRE(util::whenAll(std::vector<AsyncResult<int>>{}).ready());
+    }
+
+    SECTION("completes after the last, failures included") {
+        std::vector<AsyncPromise<int>> promises(3);
+        std::vector<AsyncResult<int>> results;
+        for (const auto& promise : promises) {
+            results.push_back(promise.result());
+        }
+        std::atomic<int> fired{ 0 };
+        util::whenAll(results).then([&](const AsyncResult<void>&) { ++fired; });
+
+        promises[0].setValue(1);
+        promises[2].setException(std::make_exception_ptr(std::runtime_error("x")));
+        REQUIRE(fired == 0);
+        std::thread producer([&]() { promises[1].setValue(2); });
+        producer.join();
+        REQUIRE(fired == 1);
+        REQUIRE(results[2].failed());
+    }
+}
+
+TEST_CASE("AsyncResult bridges to std::future", "[AsyncResult]") {
+    AsyncPromise<int> promise;
+    std::future<int> future = promise.result().toFuture();
+    std::shared_future<int> shared = promise.result().toSharedFuture();
+    promise.setValue(9);
+    REQUIRE(future.get() == 9);
+    REQUIRE(shared.get() == 9);
+
+    AsyncPromise<void> failing;
+    std::shared_future<void> failed = failing.result().toSharedFuture();
+    failing.setException(std::make_exception_ptr(std::runtime_error("x")));
+    REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+}
@@ -0,0 +1,279 @@
+/**
+ * AudioCacheStore Unit Tests
+ *
+ * Tests the index surviving a restart, rebuilding it by a directory scan, LRU
+ * eviction to the byte budget, dropping files changed behind the store's back and
+ * replacing cold files with compacted copies.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/audio_cache_store.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using util::AudioCacheStore;
+namespace fs = std::filesystem;
+
+namespace {
+    fs::path makeTempDir() {
+        std::random_device rd;
+        fs::path dir = fs::temp_directory_path() / ("audio_cache_store_test_" + std::to_string(rd()));
+        fs::create_directories(dir);
+        return dir;
+    }
+
+    struct TempDir {
+        fs::path path = makeTempDir();
+        ~TempDir() {
+            std::error_code ec;
+            fs::remove_all(path, ec);
+        }
+    };
+
+    std::string writeFile(const fs::path& dir, const std::string& name, size_t size) {
+        const fs::path file = dir / name;
+        std::ofstream(file, std::ios::binary) << std::string(size, 'x');
+        return file.string();
+    }
+}
+
+TEST_CASE("AudioCacheStore keeps an index", "[AudioCacheStore]") {
+    TempDir dir;
+
+    SECTION("commits survive a restart") {
+        {
+            AudioCacheStore store(dir.path);
+            REQUIRE(store.commit(writeFile(dir.path, "1_a.audio", 100)));
+            REQUIRE(store.commit(writeFile(dir.path, "1_b.audio", 50)));
+            REQUIRE(store.totalBytes() == 150);
+        }
+        REQUIRE(fs::exists(dir.path / AudioCacheStore::INDEX_FILE));
+        AudioCacheStore store(dir.path);
+        REQUIRE(store.size() == 2);
+        REQUIRE(store.totalBytes() == 150);
+        REQUIRE(store.open((dir.path / "1_a.audio").string()));
+    }
+
+    SECTION("a missing index is rebuilt from the .audio files") {
+        writeFile(dir.path, "1_a.audio", 10);
+        writeFile(dir.path, "1_b.audio", 20);
+        writeFile(dir.path, "1_c.audio.part", 30);
+        AudioCacheStore store(dir.path);
+        REQUIRE(store.size() == 2);
+        REQUIRE(store.totalBytes() == 30);
+    }
+
+    SECTION("an unreadable index is rebuilt too") {
+        writeFile(dir.path, "1_a.audio", 10);
+        std::ofstream(dir.path / AudioCacheStore::INDEX_FILE) << "garbage\n";
+        AudioCacheStore store(dir.path);
+        REQUIRE(store.size() == 1);
+    }
+
+    SECTION("only files directly in the directory are managed") {
+        AudioCacheStore store(dir.path);
+        fs::create_directories(dir.path / "sub");
+        REQUIRE_FALSE(store.commit(writeFile(dir.path / "sub", "1_a.audio", 10)));
+        REQUIRE_FALSE(store.manages("/elsewhere/1_a.audio"));
+        REQUIRE(store.manages((dir.path / "1_a.audio").string()));
+        REQUIRE(store.manages(store.pathFor("1_a.audio")));
+        REQUIRE_FALSE(store.commit((dir.path / "missing.audio").string()));
+        REQUIRE(store.size() == 0);
+    }
+
+    SECTION("files finished without a commit are adopted on open") {
+        AudioCacheStore store(dir.path);
+        const std::string path = writeFile(dir.path, "1_a.audio", 10);
+        REQUIRE(store.open(path));
+        REQUIRE(store.size() == 1);
+        REQUIRE_FALSE(store.open((dir.path / "missing.audio").string()));
+    }
+
+    SECTION("remove deletes the file") {
+        AudioCacheStore store(dir.path);
+        const std::string path = writeFile(dir.path, "1_a.audio", 10);
+        store.commit(path);
+        REQUIRE(store.remove(path));
+        REQUIRE_FALSE(fs::exists(path));
+        REQUIRE(store.totalBytes() == 0);
+        REQUIRE_FALSE(store.remove(path));
+    }
+}
+
+TEST_CASE("AudioCacheStore checks entries on open", "[AudioCacheStore]") {
+    TempDir dir;
+    AudioCacheStore store(dir.path);
+    const std::string path = writeFile(dir.path, "1_a.audio", 100);
+    store.commit(path);
+
+    SECTION("a changed size drops and deletes the file") {
+        writeFile(dir.path, "1_a.audio", 40);
+        REQUIRE_FALSE(store.contains(path));
+        REQUIRE_FALSE(fs::exists(path));
+        REQUIRE(store.size() == 0);
+        REQUIRE(store.totalBytes() == 0);
+    }
+
+    SECTION("a deleted file drops its entry") {
+        fs::remove(path);
+        REQUIRE_FALSE(store.open(path));
+        REQUIRE(store.size() == 0);
+    }
+
+    SECTION("a recommit takes the new size") {
+        writeFile(dir.path, "1_a.audio", 40);
+        REQUIRE(store.commit(path));
+        REQUIRE(store.open(path));
+        REQUIRE(store.totalBytes() == 40);
+    }
+}
+
+TEST_CASE("AudioCacheStore evicts the least recently used", "[AudioCacheStore]") {
+    TempDir dir;
+    AudioCacheStore store(dir.path, 250);
+    const std::string a = writeFile(dir.path, "1_a.audio", 100);
+    const std::string b = writeFile(dir.path, "1_b.audio", 100);
+    const std::string c = writeFile(dir.path, "1_c.audio", 100);
+    store.commit(a);
+    store.commit(b);
+
+    SECTION("the oldest goes first") {
+        store.commit(c);
+        REQUIRE_FALSE(fs::exists(a));
+        REQUIRE(fs::exists(b));
+        REQUIRE(fs::exists(c));
+        REQUIRE(store.totalBytes() == 200);
+    }
+
+    SECTION("opening a file keeps it") {
+        REQUIRE(store.open(a));
+        store.commit(c);
+        REQUIRE(fs::exists(a));
+        REQUIRE_FALSE(fs::exists(b));
+    }
+
+    SECTION("contains doesn't count as use") {
+        REQUIRE(store.contains(a));
+        store.commit(c);
+        REQUIRE_FALSE(fs::exists(a));
+    }
+
+    SECTION("a file over the budget by itself is still kept") {
+        const std::string big = writeFile(dir.path, "1_big.audio", 400);
+        store.commit(big);
+        REQUIRE(fs::exists(big));
+        REQUIRE(store.size() == 1);
+    }
+
+    SECTION("lowering the budget evicts") {
+        store.setBudget(150);
+        REQUIRE_FALSE(fs::exists(a));
+        REQUIRE(store.totalBytes() == 100);
+        store.setBudget(0);
+        store.commit(c);
+        REQUIRE(store.totalBytes() == 200);
+    }
+
+    SECTION("access order survives a restart") {
+        REQUIRE(store.open(a));
+        store.flush();
+        AudioCacheStore reopened(dir.path, 250);
+        reopened.commit(c);
+        REQUIRE(fs::exists(a));
+        REQUIRE_FALSE(fs::exists(b));
+    }
+}
+
+TEST_CASE("AudioCacheStore replaces cold files in place", "[AudioCacheStore]") {
+    TempDir dir;
+    const std::string a = writeFile(dir.path, "1_a.audio", 100);
+    const std::string b = writeFile(dir.path, "1_b.audio", 100);
+    const std::string c = writeFile(dir.path, "1_c.audio", 100);
+    const auto now = fs::file_time_type::clock::now();
+    fs::last_write_time(a, now - std::chrono::hours(3));
+    fs::last_write_time(b, now - std::chrono::hours(2));
+    fs::last_write_time(c, now - std::chrono::hours(1));
+    // Scanned files have no play history, so all of them are cold, oldest first
+    AudioCacheStore store(dir.path);
+    const auto cold = std::chrono::hours(1);
+
+    SECTION("cold entries are listed least recently used first") {
+        auto entries = store.coldEntries(cold, 10);
+        REQUIRE(entries.size() == 3);
+        REQUIRE(fs::path(entries[0].path) == fs::path(a));
+        REQUIRE(fs::path(entries[2].path) == fs::path(c));
+        REQUIRE(entries[0].size == 100);
+        REQUIRE(store.coldEntries(cold, 1).size() == 1);
+
+        REQUIRE(store.open(a));
+        entries = store.coldEntries(cold, 10);
+        REQUIRE(entries.size() == 2);
+        REQUIRE(fs::path(entries[0].path) == fs::path(b));
+    }
+
+    SECTION("a replacement takes the file's place and isn't listed again") {
+        const auto original = store.coldEntries(cold, 1).front();
+        const std::string replacement = writeFile(dir.path, "1_a.audio.tmp", 40);
+        REQUIRE(store.replace(original, replacement));
+        REQUIRE_FALSE(fs::exists(replacement));
+        REQUIRE(fs::file_size(a) == 40);
+        REQUIRE(store.totalBytes() == 240);
+        REQUIRE(store.open(a));
+        REQUIRE(store.coldEntries(cold, 10).size() == 2);
+
+        // Still oldest in the eviction order, as before the replacement
+        AudioCacheStore reopened(dir.path);
+        REQUIRE(reopened.totalBytes() == 240);
+        REQUIRE(reopened.coldEntries(cold, 10).size() == 2);
+    }
+
+    SECTION("a file changed since it was listed isn't replaced") {
+        const auto original = store.coldEntries(cold, 1).front();
+        writeFile(dir.path, "1_a.audio", 120);
+        REQUIRE(store.commit(a));
+        const std::string replacement = writeFile(dir.path, "1_a.audio.tmp", 40);
+        REQUIRE_FALSE(store.replace(original, replacement));
+        REQUIRE_FALSE(fs::exists(replacement));
+        REQUIRE(fs::file_size(a) == 120);
+        REQUIRE(store.totalBytes() == 320);
+    }
+
+    SECTION("a removed file isn't brought back") {
+        const auto original = store.coldEntries(cold, 1).front();
+        REQUIRE(store.remove(a));
+        const std::string replacement = writeFile(dir.path, "1_a.audio.tmp", 40);
+        REQUIRE_FALSE(store.replace(original, replacement));
+        REQUIRE_FALSE(fs::exists(a));
+        REQUIRE_FALSE(fs::exists(replacement));
+    }
+
+    SECTION("marked files aren't listed, across a restart") {
+        store.markCompacted(a);
+        REQUIRE(store.coldEntries(cold, 10).size() == 2);
+        store.flush();
+        AudioCacheStore reopened(dir.path);
+        REQUIRE(reopened.coldEntries(cold, 10).size() == 2);
+    }
+
+    SECTION("an index without the compacted column still loads") {
+        store.flush();
+        const fs::path index = dir.path / AudioCacheStore::INDEX_FILE;
+        std::ifstream in(index, std::ios::binary);
+        std::string line;
+        std::getline(in, line);
+        std::ostringstream v1;
+        v1 << "audio-cache-index 1\n";
+        while (std::getline(in, line)) {
+            v1 << line.substr(0, line.rfind('\t')) << '\n';
+        }
+        in.close();
+        std::ofstream(index, std::ios::binary | std::ios::trunc) << v1.str();
+
+        AudioCacheStore reopened(dir.path);
+        REQUIRE(reopened.size() == 3);
+        REQUIRE(reopened.coldEntries(cold, 10).size() == 3);
+        REQUIRE(reopened.open(b));
+    }
+}
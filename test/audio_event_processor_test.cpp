@@ -0,0 +1,133 @@
+/**
+ * AudioEventProcessor Unit Tests
+ *
+ * Tests in-order delivery past the event ring's capacity, typed payloads, the
+ * QVariantHash compatibility layer in both directions, and dropping superseded events.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/audio_event_processor.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using audio::AudioEventProcessor;
+
+namespace {
+bool waitUntil(const std::function<bool()>& done)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+}
+
+TEST_CASE("AudioEventProcessor delivers typed events in order", "[AudioEventProcessor]") {
+    AudioEventProcessor processor;
+    std::mutex mutex;
+    std::vector<int> codes;
+    std::vector<QString> errors;
+    processor.setEventHandler(AudioEventProcessor::DECODING_ERROR,
+        AudioEventProcessor::EventHandler([&](const AudioEventProcessor::Event& event) {
+            std::scoped_lock lock(mutex);
+            codes.push_back(std::get<AudioEventProcessor::ErrorInfo>(event.payload).code);
+        }));
+    processor.setEventHandler(AudioEventProcessor::PLAYBACK_ERROR,
+        AudioEventProcessor::EventHandler([&](const AudioEventProcessor::Event& event) {
+            std::scoped_lock lock(mutex);
+            errors.push_back(event.errorMessage());
+        }));
+
+    // More than the ring holds, so some wait in the overflow queue
+    const int posts = static_cast<int>(AudioEventProcessor::EVENT_RING_CAPACITY) * 3;
+    for (int i = 0; i < posts; ++i) {
+        processor.postEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{QString(), i});
+    }
+    processor.postEvent(AudioEventProcessor::PLAYBACK_ERROR, AudioEventProcessor::ErrorInfo{QStringLiteral("typed"), 5});
+    processor.postEvent(AudioEventProcessor::PLAYBACK_ERROR,
+                        QVariantHash{{QStringLiteral("error"), QVariant(QStringLiteral("hash"))}});
+    REQUIRE(processor.pendingEventCount() == posts + 2);
+
+    processor.start();
+    REQUIRE(waitUntil([&]() { std::scoped_lock lock(mutex); return errors.size() == 2; }));
+    processor.stop();
+
+    REQUIRE(codes.size() == static_cast<size_t>(posts));
+    for (int i = 0; i < posts; ++i) {
+        REQUIRE(codes[i] == i);
+    }
+    REQUIRE(errors[0] == QStringLiteral("typed"));
+    REQUIRE(errors[1] == QStringLiteral("hash"));
+}
+
+TEST_CASE("AudioEventProcessor hash handlers get typed payloads converted", "[AudioEventProcessor]") {
+    AudioEventProcessor processor;
+    std::mutex mutex;
+    std::vector<QVariantHash> received;
+    processor.setEventHandler(AudioEventProcessor::DECODING_ERROR, [&](const QVariantHash& data) {
+        std::scoped_lock lock(mutex);
+        received.push_back(data);
+    });
+    processor.start();
+    processor.postEvent(AudioEventProcessor::DECODING_ERROR, AudioEventProcessor::ErrorInfo{QStringLiteral("bad packet"), -22});
+    processor.postEvent(AudioEventProcessor::DECODING_ERROR);
+    REQUIRE(waitUntil([&]() { std::scoped_lock lock(mutex); return received.size() == 2; }));
+    processor.stop();
+
+    REQUIRE(received[0].value(QStringLiteral("error")).toString() == QStringLiteral("bad packet"));
+    REQUIRE(received[0].value(QStringLiteral("code")).toInt() == -22);
+    REQUIRE(received[1].isEmpty());
+}
+
+TEST_CASE("AudioEventProcessor drops superseded events", "[AudioEventProcessor]") {
+    AudioEventProcessor processor;
+    std::mutex mutex;
+    std::vector<AudioEventProcessor::PlayerEventType> handled;
+    std::vector<qint64> positions;
+    AudioEventProcessor::EventHandler record = [&](const AudioEventProcessor::Event& event) {
+        std::scoped_lock lock(mutex);
+        handled.push_back(event.type);
+        if (event.type == AudioEventProcessor::SEEK) {
+            positions.push_back(event.seekPositionMs());
+        }
+    };
+    for (auto type : {AudioEventProcessor::PLAY, AudioEventProcessor::PAUSE,
+                      AudioEventProcessor::STOP, AudioEventProcessor::SEEK}) {
+        processor.setEventHandler(type, record);
+    }
+
+    // Skipping through songs: only the last STOP and PLAY should open anything
+    processor.postEvent(AudioEventProcessor::PLAY);
+    processor.postEvent(AudioEventProcessor::PAUSE);
+    processor.postEvent(AudioEventProcessor::PLAY);
+    processor.postEvent(AudioEventProcessor::STOP);
+    processor.postEvent(AudioEventProcessor::PLAY);
+    processor.postEvent(AudioEventProcessor::SEEK, AudioEventProcessor::SeekRequest{1000});
+    processor.postEvent(AudioEventProcessor::SEEK, AudioEventProcessor::SeekRequest{2000});
+    processor.start();
+    REQUIRE(waitUntil([&]() { std::scoped_lock lock(mutex); return handled.size() == 3; }));
+    // Give a wrongly delivered event time to show up
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    processor.stop();
+
+    REQUIRE(handled == std::vector<AudioEventProcessor::PlayerEventType>{
+        AudioEventProcessor::STOP, AudioEventProcessor::PLAY, AudioEventProcessor::SEEK});
+    REQUIRE(positions == std::vector<qint64>{2000});
+}
+
+TEST_CASE("AudioEventProcessor keeps STOP before a later PLAY", "[AudioEventProcessor]") {
+    using Type = AudioEventProcessor::PlayerEventType;
+    const auto supersedes = [](Type posted, Type pending) {
+        return (AudioEventProcessor::supersededTypes(posted) & (quint32(1) << pending)) != 0;
+    };
+    REQUIRE_FALSE(supersedes(AudioEventProcessor::PLAY, AudioEventProcessor::STOP));
+    REQUIRE_FALSE(supersedes(AudioEventProcessor::PAUSE, AudioEventProcessor::PLAY));
+    REQUIRE(supersedes(AudioEventProcessor::STOP, AudioEventProcessor::PLAY));
+    REQUIRE_FALSE(supersedes(AudioEventProcessor::PLAYBACK_ERROR, AudioEventProcessor::PLAYBACK_ERROR));
+}
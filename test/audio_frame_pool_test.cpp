@@ -0,0 +1,90 @@
+/**
+ * AudioFramePool Unit Tests
+ *
+ * Tests frame recycling, capacity reuse and hit/miss accounting.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/audio_frame_pool.h>
+#include <memory>
+#include <vector>
+
+TEST_CASE("AudioFramePool recycling", "[AudioFramePool]") {
+    SECTION("First acquire is a miss") {
+        AudioFramePool pool(4);
+
+        auto frame = pool.acquire(1024);
+
+        REQUIRE(frame != nullptr);
+        REQUIRE(frame->data.size() == 1024);
+        REQUIRE(pool.stats().misses == 1);
+        REQUIRE(pool.stats().hits == 0);
+        REQUIRE(pool.stats().pooled == 1);
+    }
+
+    SECTION("Released frame is reused") {
+        AudioFramePool pool(4);
+
+        AudioFrame* first = nullptr;
+        {
+            auto frame = pool.acquire(1024);
+            first = frame.get();
+        }
+        auto again = pool.acquire(512);
+
+        REQUIRE(again.get() == first);
+        REQUIRE(again->data.size() == 512);
+        REQUIRE(pool.stats().hits == 1);
+        REQUIRE(pool.stats().misses == 1);
+    }
+
+    SECTION("Frames still in flight are not handed out twice") {
+        AudioFramePool pool(4);
+
+        auto a = pool.acquire(256);
+        auto b = pool.acquire(256);
+
+        REQUIRE(a.get() != b.get());
+        REQUIRE(pool.stats().pooled == 2);
+    }
+
+    SECTION("Growing a recycled buffer counts as a miss") {
+        AudioFramePool pool(4);
+        { auto frame = pool.acquire(128); }
+
+        auto bigger = pool.acquire(4096);
+
+        REQUIRE(bigger->data.size() == 4096);
+        REQUIRE(pool.stats().misses == 2);
+        REQUIRE(pool.stats().hits == 0);
+    }
+
+    SECTION("Pool never retains more than maxFrames") {
+        AudioFramePool pool(2);
+        std::vector<std::shared_ptr<AudioFrame>> inFlight;
+        for (int i = 0; i < 5; ++i) {
+            inFlight.push_back(pool.acquire(64));
+        }
+
+        REQUIRE(pool.stats().pooled == 2);
+        REQUIRE(pool.stats().misses == 5);
+    }
+
+    SECTION("Steady state has no misses") {
+        AudioFramePool pool(8);
+        std::vector<std::shared_ptr<AudioFrame>> window;
+        // Warm up with a window of 4 in-flight frames
+        for (int i = 0; i < 4; ++i) {
+            window.push_back(pool.acquire(4096));
+        }
+        auto warmMisses = pool.stats().misses;
+
+        for (int i = 0; i < 1000; ++i) {
+            window.erase(window.begin());
+            window.push_back(pool.acquire(4096 - (i % 16)));
+        }
+
+        REQUIRE(pool.stats().misses == warmMisses);
+        REQUIRE(pool.stats().hits == 1000);
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * AudioFrameQueue Unit Tests
+ *
+ * Tests decode-ahead accounting in playback time: queued duration tracking,
+ * blocking at the maximum window and resuming at the minimum, and close semantics.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/audio_frame.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <memory>
+
+namespace {
+    // 100 ms of 16-bit stereo PCM at 48 kHz
+    std::shared_ptr<AudioFrame> makeFrame100ms() {
+        auto frame = std::make_shared<AudioFrame>(4800 * 2 * 2);
+        frame->sample_rate = 48000;
+        frame->channels = 2;
+        frame->bits_per_sample = 16;
+        frame->pts = 0;
+        return frame;
+    }
+}
+
+TEST_CASE("AudioFrameQueue tracks queued duration", "[AudioFrameQueue]") {
+    SECTION("Default window") {
+        AudioFrameQueue queue;
+        REQUIRE(queue.minAheadMs() == DEFAULT_MIN_DECODE_AHEAD_MS);
+        REQUIRE(queue.maxAheadMs() == DEFAULT_MAX_DECODE_AHEAD_MS);
+        REQUIRE(queue.queuedDurationMs() == 0);
+    }
+
+    SECTION("Push, pop and clean adjust the queued duration") {
+        AudioFrameQueue queue;
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(queue.push(makeFrame100ms()) == true);
+        }
+        REQUIRE(queue.queuedDurationMs() == 500);
+
+        std::shared_ptr<AudioFrame> frame;
+        REQUIRE(queue.tryPop(frame) == true);
+        REQUIRE(queue.queuedDurationMs() == 400);
+        REQUIRE(queue.waitPop(frame) == true);
+        REQUIRE(queue.queuedDurationMs() == 300);
+
+        queue.clean();
+        REQUIRE(queue.empty() == true);
+        REQUIRE(queue.queuedDurationMs() == 0);
+    }
+
+    SECTION("Failed pushes are not counted") {
+        AudioFrameQueue queue;
+        queue.close();
+        REQUIRE(queue.push(makeFrame100ms()) == false);
+        REQUIRE(queue.tryPush(makeFrame100ms()) == false);
+        REQUIRE(queue.queuedDurationMs() == 0);
+    }
+}
+
+TEST_CASE("AudioFrameQueue decode-ahead backpressure", "[AudioFrameQueue]") {
+    SECTION("push blocks at the maximum until drained to the minimum") {
+        AudioFrameQueue queue(AUDIO_FRAME_QUEUE_CAPACITY, 200, 500);
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(queue.push(makeFrame100ms()) == true);
+        }
+
+        std::atomic<bool> pushed{false};
+        std::thread producer([&]() {
+            queue.push(makeFrame100ms());
+            pushed.store(true);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(pushed.load() == false);
+
+        std::shared_ptr<AudioFrame> frame;
+        REQUIRE(queue.tryPop(frame) == true);
+        REQUIRE(queue.tryPop(frame) == true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // 300 ms still queued, above the 200 ms minimum
+        REQUIRE(pushed.load() == false);
+
+        REQUIRE(queue.tryPop(frame) == true);
+        producer.join();
+        REQUIRE(pushed.load() == true);
+        REQUIRE(queue.queuedDurationMs() == 300);
+    }
+
+    SECTION("Frame count does not matter, only duration") {
+        AudioFrameQueue queue(AUDIO_FRAME_QUEUE_CAPACITY, 10, 50);
+        // A single long frame already fills the window
+        auto longFrame = makeFrame100ms();
+        REQUIRE(queue.push(longFrame) == true);
+        REQUIRE(queue.size() == 1);
+        REQUIRE(queue.tryPush(makeFrame100ms()) == true);
+        REQUIRE(queue.queuedDurationMs() == 200);
+    }
+
+    SECTION("Widening the window releases a blocked producer") {
+        AudioFrameQueue queue(AUDIO_FRAME_QUEUE_CAPACITY, 100, 300);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(queue.push(makeFrame100ms()) == true);
+        }
+        std::thread producer([&]() { queue.push(makeFrame100ms()); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.setDecodeAheadWindow(1000, 2000);
+        producer.join();
+        REQUIRE(queue.queuedDurationMs() == 400);
+    }
+
+    SECTION("close wakes a blocked producer") {
+        AudioFrameQueue queue(AUDIO_FRAME_QUEUE_CAPACITY, 100, 200);
+        REQUIRE(queue.push(makeFrame100ms()) == true);
+        REQUIRE(queue.push(makeFrame100ms()) == true);
+
+        std::atomic<bool> result{true};
+        std::thread producer([&]() { result.store(queue.push(makeFrame100ms())); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.close();
+        producer.join();
+        REQUIRE(result.load() == false);
+        REQUIRE(queue.queuedDurationMs() == 200);
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * Headless Audio Output Unit Tests
+ *
+ * Tests NullAudioOutput and WavFileAudioOutput without an audio device: event-driven
+ * draining of a frame queue, gapless source switches, seek discards, push mode, and the
+ * WAV file written by the file sink.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/null_audio_output.h>
+#include <audio/wav_file_audio_output.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+    constexpr int kRate = 48000;
+    constexpr int kChannels = 2;
+    constexpr int kFrameSamples = 480;  // 10 ms
+
+    std::shared_ptr<AudioFrame> makeFrame(int64_t ptsSamples, int16_t value, bool discontinuity = false) {
+        auto frame = std::make_shared<AudioFrame>(kFrameSamples * kChannels * sizeof(int16_t));
+        frame->sample_rate = kRate;
+        frame->channels = kChannels;
+        frame->bits_per_sample = 16;
+        frame->pts = ptsSamples;
+        frame->pts_samples = ptsSamples;
+        frame->discontinuity = discontinuity;
+        auto* samples = reinterpret_cast<int16_t*>(frame->data.data());
+        for (int i = 0; i < kFrameSamples * kChannels; ++i) samples[i] = value;
+        return frame;
+    }
+
+    std::shared_ptr<AudioFrameQueue> makeClosedQueue(int frames, int16_t value = 1) {
+        auto queue = std::make_shared<AudioFrameQueue>();
+        for (int i = 0; i < frames; ++i) {
+            REQUIRE(queue->tryPush(makeFrame(static_cast<int64_t>(i) * kFrameSamples, value)));
+        }
+        queue->close();
+        return queue;
+    }
+}
+
+TEST_CASE("NullAudioOutput event-driven rendering", "[NullAudioOutput]") {
+    NullAudioOutput output;
+    REQUIRE(output.initialize(kRate, kChannels, 16, IAudioOutput::RenderMode::EventDriven));
+    REQUIRE(output.renderMode() == IAudioOutput::RenderMode::EventDriven);
+
+    SECTION("Drains a closed source and reports the end position") {
+        std::atomic<int> drained{0};
+        output.setFrameSource(makeClosedQueue(50), [&drained]() { drained++; });
+        REQUIRE(output.start());
+        REQUIRE(output.waitForDrain(2000ms));
+        REQUIRE(drained.load() == 1);
+        REQUIRE(output.framesConsumed() == 50u * kFrameSamples);
+        REQUIRE(output.getCurrentPositionMs() == 500);
+        output.stop();
+    }
+
+    SECTION("Switches to the next source without draining") {
+        std::atomic<int> firstDrained{0}, secondDrained{0}, started{0};
+        output.setFrameSource(makeClosedQueue(10), [&firstDrained]() { firstDrained++; });
+        output.setNextFrameSource(makeClosedQueue(20), [&secondDrained]() { secondDrained++; },
+                                  [&started]() { started++; });
+        REQUIRE(output.start());
+        REQUIRE(output.waitForDrain(2000ms));
+        REQUIRE(started.load() == 1);
+        REQUIRE(firstDrained.load() == 0);
+        REQUIRE(secondDrained.load() == 1);
+        REQUIRE(output.framesConsumed() == 30u * kFrameSamples);
+        // Position is relative to the second track
+        REQUIRE(output.getCurrentPositionMs() == 200);
+        REQUIRE_FALSE(output.clearNextFrameSource());
+    }
+
+    SECTION("A seek drops frames until the discontinuity") {
+        auto queue = std::make_shared<AudioFrameQueue>();
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(queue->tryPush(makeFrame(i * kFrameSamples, 1)));
+        }
+        const int64_t seekSample = 5 * kRate;
+        REQUIRE(queue->tryPush(makeFrame(seekSample, 2, true)));
+        REQUIRE(queue->tryPush(makeFrame(seekSample + kFrameSamples, 2)));
+        queue->close();
+
+        output.setFrameSource(queue, nullptr);
+        REQUIRE(output.flushForSeek(5000));
+        REQUIRE(output.getCurrentPositionMs() == 5000);
+        REQUIRE(output.start());
+        REQUIRE(output.waitForDrain(2000ms));
+        REQUIRE(output.framesConsumed() == 2u * kFrameSamples);
+        REQUIRE(output.getCurrentPositionMs() == 5020);
+    }
+}
+
+TEST_CASE("NullAudioOutput push mode", "[NullAudioOutput]") {
+    NullAudioOutput output;
+    REQUIRE_FALSE(output.initialize(kRate, kChannels, 24));
+    REQUIRE(output.initialize(kRate, kChannels, 16));
+
+    auto frame = makeFrame(0, 1);
+    // Not started yet: nothing is consumed
+    output.playAudioData(frame->data.data(), static_cast<int>(frame->data.size()), frame->pts_samples);
+    REQUIRE(output.framesConsumed() == 0);
+
+    REQUIRE(output.start());
+    REQUIRE(output.getAvailableCacheBytes() >= static_cast<int>(frame->data.size()));
+    output.setPositionOffsetMs(1000);
+    output.playAudioData(frame->data.data(), static_cast<int>(frame->data.size()));
+    REQUIRE(output.framesConsumed() == static_cast<uint64_t>(kFrameSamples));
+    REQUIRE(output.getCurrentPositionMs() == 1010);
+}
+
+TEST_CASE("WavFileAudioOutput writes a playable WAV file", "[WavFileAudioOutput]") {
+    const auto path = (std::filesystem::temp_directory_path() / "bp_wav_sink_test.wav").string();
+    {
+        WavFileAudioOutput output(path);
+        REQUIRE(output.initialize(kRate, kChannels, 16, IAudioOutput::RenderMode::EventDriven));
+        output.setFrameSource(makeClosedQueue(25, 1234), nullptr);
+        REQUIRE(output.start());
+        REQUIRE(output.waitForDrain(2000ms));
+        REQUIRE(output.stop());
+        REQUIRE(output.dataBytes() == 25u * kFrameSamples * kChannels * sizeof(int16_t));
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    REQUIRE(in.is_open());
+    std::vector<char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const uint32_t dataBytes = 25u * kFrameSamples * kChannels * sizeof(int16_t);
+    REQUIRE(file.size() == 44 + dataBytes);
+    REQUIRE(std::memcmp(file.data(), "RIFF", 4) == 0);
+    REQUIRE(std::memcmp(file.data() + 8, "WAVE", 4) == 0);
+
+    uint16_t formatTag = 0, channels = 0, bits = 0;
+    uint32_t rate = 0, dataSize = 0;
+    std::memcpy(&formatTag, file.data() + 20, 2);
+    std::memcpy(&channels, file.data() + 22, 2);
+    std::memcpy(&rate, file.data() + 24, 4);
+    std::memcpy(&bits, file.data() + 34, 2);
+    std::memcpy(&dataSize, file.data() + 40, 4);
+    REQUIRE(formatTag == 1);
+    REQUIRE(channels == kChannels);
+    REQUIRE(rate == static_cast<uint32_t>(kRate));
+    REQUIRE(bits == 16);
+    REQUIRE(dataSize == dataBytes);
+
+    int16_t firstSample = 0;
+    std::memcpy(&firstSample, file.data() + 44, 2);
+    REQUIRE(firstSample == 1234);
+    std::filesystem::remove(path);
+}
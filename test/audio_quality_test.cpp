@@ -0,0 +1,65 @@
+/**
+ * Audio Quality Selection Unit Tests
+ *
+ * Tests picking a track's audio stream by preference and measured
+ * throughput, and the settings names of the preferences.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/audio_quality.h>
+
+using namespace network;
+
+namespace {
+    // Bilibili's usual DASH qualities plus a FLAC track, deliberately out of order
+    const std::vector<AudioStreamOption> STREAMS = {
+        { "192k", 192000, false },
+        { "flac", 1000000, true },
+        { "64k", 64000, false },
+        { "132k", 132000, false },
+    };
+
+    std::string pick(AudioQuality quality, uint64_t bytesPerSecond) {
+        const size_t index = selectAudioStream(STREAMS, quality, bytesPerSecond);
+        return index < STREAMS.size() ? STREAMS[index].url : std::string();
+    }
+}
+
+TEST_CASE("selectAudioStream", "[AudioQuality]") {
+    SECTION("fixed preferences ignore the throughput") {
+        REQUIRE(pick(AudioQuality::DataSaver, 0) == "64k");
+        REQUIRE(pick(AudioQuality::DataSaver, 10'000'000) == "64k");
+        REQUIRE(pick(AudioQuality::Best, 0) == "flac");
+        REQUIRE(pick(AudioQuality::Best, 1000) == "flac");
+    }
+
+    SECTION("auto follows the measured throughput with headroom") {
+        // 192 kbps needs 288 kbps = 36000 B/s
+        REQUIRE(pick(AudioQuality::Auto, 36000) == "192k");
+        REQUIRE(pick(AudioQuality::Auto, 35999) == "132k");
+        REQUIRE(pick(AudioQuality::Auto, 12000) == "64k");
+        // Nothing fits: the lowest still beats not playing
+        REQUIRE(pick(AudioQuality::Auto, 1000) == "64k");
+        // Lossless once the link carries 1.5 Mbps
+        REQUIRE(pick(AudioQuality::Auto, 187500) == "flac");
+    }
+
+    SECTION("auto without a measurement stays lossy") {
+        REQUIRE(pick(AudioQuality::Auto, 0) == "192k");
+        const std::vector<AudioStreamOption> onlyLossless = { { "flac", 1000000, true } };
+        REQUIRE(selectAudioStream(onlyLossless, AudioQuality::Auto, 0) == 0);
+    }
+
+    SECTION("no streams") {
+        REQUIRE(selectAudioStream({}, AudioQuality::Best, 0) == std::string::npos);
+    }
+}
+
+TEST_CASE("AudioQuality settings names", "[AudioQuality]") {
+    for (AudioQuality quality : { AudioQuality::Auto, AudioQuality::DataSaver, AudioQuality::Best }) {
+        REQUIRE(audioQualityFromString(audioQualityToString(quality)) == quality);
+    }
+    REQUIRE(audioQualityToString(AudioQuality::DataSaver) == "data_saver");
+    REQUIRE(audioQualityFromString("unknown") == AudioQuality::Auto);
+    REQUIRE(audioQualityFromString("") == AudioQuality::Auto);
+}
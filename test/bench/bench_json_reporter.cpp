@@ -0,0 +1,87 @@
+/**
+ * Catch2 reporter writing benchmark results as JSON, for comparing commits:
+ *
+ *   BilibiliPlayerBench --reporter benchjson::out=bench.json
+ *
+ * Catch2's own JSON reporter leaves benchmark results out. Times are in nanoseconds.
+ */
+
+#include <catch2/benchmark/detail/catch_benchmark_stats.hpp>
+#include <catch2/catch_test_case_info.hpp>
+#include <catch2/reporters/catch_reporter_registrars.hpp>
+#include <catch2/reporters/catch_reporter_streaming_base.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace {
+std::string jsonString(const std::string& text)
+{
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+class BenchJsonReporter : public Catch::StreamingReporterBase {
+public:
+    using StreamingReporterBase::StreamingReporterBase;
+
+    static std::string getDescription()
+    {
+        return "Benchmark results as JSON (mean, bounds and standard deviation in ns)";
+    }
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override
+    {
+        Result result;
+        result.testCase = currentTestCaseInfo ? currentTestCaseInfo->name : std::string();
+        result.name = stats.info.name;
+        result.samples = stats.samples.size();
+        result.iterations = stats.info.iterations;
+        result.meanNs = stats.mean.point.count();
+        result.meanLowNs = stats.mean.lower_bound.count();
+        result.meanHighNs = stats.mean.upper_bound.count();
+        result.stdDevNs = stats.standardDeviation.point.count();
+        m_results.push_back(std::move(result));
+    }
+
+    void testRunEnded(Catch::TestRunStats const& stats) override
+    {
+        StreamingReporterBase::testRunEnded(stats);
+        m_stream << "{\n  \"benchmarks\": [";
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            const Result& r = m_results[i];
+            m_stream << (i ? ",\n" : "\n")
+                     << "    {\"test_case\": " << jsonString(r.testCase)
+                     << ", \"name\": " << jsonString(r.name)
+                     << ", \"samples\": " << r.samples
+                     << ", \"iterations\": " << r.iterations
+                     << ", \"mean_ns\": " << r.meanNs
+                     << ", \"mean_low_ns\": " << r.meanLowNs
+                     << ", \"mean_high_ns\": " << r.meanHighNs
+                     << ", \"std_dev_ns\": " << r.stdDevNs << "}";
+        }
+        m_stream << "\n  ]\n}\n";
+    }
+
+private:
+    struct Result {
+        std::string testCase;
+        std::string name;
+        size_t samples = 0;
+        int iterations = 0;
+        double meanNs = 0;
+        double meanLowNs = 0;
+        double meanHighNs = 0;
+        double stdDevNs = 0;
+    };
+    std::vector<Result> m_results;
+};
+}
+
+CATCH_REGISTER_REPORTER("benchjson", BenchJsonReporter)
@@ -0,0 +1,147 @@
+/**
+ * Byte and item queue microbenchmarks
+ *
+ * CircularBuffer read/write, RealtimePipe throughput with the writer and reader on
+ * one thread, on two, and with several pipes running at once, and SafeQueue under
+ * producer/consumer contention.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <stream/realtime_pipe.hpp>
+#include <util/circular_buffer.hpp>
+#include <util/safe_queue.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t PIPE_CAPACITY = 64 * 1024;
+constexpr size_t PIPE_BYTES = 4 * 1024 * 1024;      // Moved through a pipe per run
+constexpr size_t CHUNK = 4096;
+
+// Write PIPE_BYTES into the pipe and close it
+void fillPipe(RealtimePipe& pipe)
+{
+    std::vector<char> chunk(CHUNK, 'x');
+    for (size_t sent = 0; sent < PIPE_BYTES; sent += CHUNK) {
+        pipe.write(chunk.data(), chunk.size());
+    }
+    pipe.closeOutput();
+}
+
+size_t drainPipe(RealtimePipe& pipe)
+{
+    std::vector<char> chunk(CHUNK);
+    size_t total = 0;
+    while (size_t got = pipe.read(chunk.data(), chunk.size())) {
+        total += got;
+    }
+    return total;
+}
+}
+
+TEST_CASE("CircularBuffer throughput", "[bench][CircularBuffer]") {
+    BENCHMARK_ADVANCED("CircularBuffer write+read 4 KiB chunks")(Catch::Benchmark::Chronometer meter) {
+        util::CircularBuffer<uint8_t> buffer(PIPE_CAPACITY);
+        std::vector<uint8_t> in(CHUNK, 0x5a);
+        std::vector<uint8_t> out(CHUNK);
+        meter.measure([&]() {
+            buffer.write(in.data(), in.size());
+            return buffer.read(out.data(), out.size());
+        });
+    };
+
+    BENCHMARK_ADVANCED("CircularBuffer push+pop int")(Catch::Benchmark::Chronometer meter) {
+        util::CircularBuffer<int> buffer(1024);
+        meter.measure([&](int i) {
+            buffer.push(i);
+            return buffer.pop();
+        });
+    };
+}
+
+TEST_CASE("RealtimePipe throughput", "[bench][RealtimePipe]") {
+    BENCHMARK("RealtimePipe 4 MiB, 1 thread") {
+        RealtimePipe pipe(PIPE_CAPACITY);
+        std::vector<char> chunk(CHUNK, 'x');
+        size_t total = 0;
+        for (size_t sent = 0; sent < PIPE_BYTES; sent += CHUNK) {
+            pipe.write(chunk.data(), chunk.size());
+            total += pipe.read(chunk.data(), chunk.size());
+        }
+        return total;
+    };
+
+    BENCHMARK("RealtimePipe 4 MiB, 2 threads") {
+        RealtimePipe pipe(PIPE_CAPACITY);
+        std::thread writer([&pipe]() { fillPipe(pipe); });
+        const size_t total = drainPipe(pipe);
+        writer.join();
+        return total;
+    };
+
+    const size_t pairs = std::max(2u, std::thread::hardware_concurrency() / 2);
+    BENCHMARK("RealtimePipe 4 MiB each, N/2 pipes on N threads") {
+        std::vector<RealtimePipe> pipes;
+        pipes.reserve(pairs);
+        std::vector<std::thread> threads;
+        std::vector<size_t> totals(pairs);
+        for (size_t i = 0; i < pairs; ++i) {
+            pipes.emplace_back(PIPE_CAPACITY);
+        }
+        for (size_t i = 0; i < pairs; ++i) {
+            threads.emplace_back([&pipes, i]() { fillPipe(pipes[i]); });
+            threads.emplace_back([&pipes, &totals, i]() { totals[i] = drainPipe(pipes[i]); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return totals.front();
+    };
+}
+
+TEST_CASE("SafeQueue contention", "[bench][SafeQueue]") {
+    constexpr int ITEMS = 100000;
+
+    // producers and consumers each move an equal share of ITEMS
+    auto run = [](int producers, int consumers) {
+        SafeQueue<int> queue;
+        std::vector<std::thread> threads;
+        std::vector<long long> sums(consumers);
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, producers]() {
+                for (int i = 0; i < ITEMS / producers; ++i) {
+                    queue.enqueue(i);
+                }
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&queue, &sums, c, consumers]() {
+                int item = 0;
+                for (int i = 0; i < ITEMS / consumers; ++i) {
+                    queue.waitAndDequeue(item);
+                    sums[c] += item;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return sums.front();
+    };
+
+    BENCHMARK("SafeQueue 100k items, 1 producer 1 consumer") { return run(1, 1); };
+    BENCHMARK("SafeQueue 100k items, 4 producers 4 consumers") { return run(4, 4); };
+
+    BENCHMARK_ADVANCED("SafeQueue enqueue+dequeue uncontended")(Catch::Benchmark::Chronometer meter) {
+        SafeQueue<int> queue;
+        meter.measure([&](int i) {
+            queue.enqueue(i);
+            int item = 0;
+            queue.dequeue(item);
+            return item;
+        });
+    };
+}
@@ -0,0 +1,172 @@
+/**
+ * Network path benchmarks over recorded Bilibili responses
+ *
+ * A search and the start of a stream, served by ReplayServer from
+ * data/replay/bilibili_search.json instead of the live API, at loopback speed and
+ * under shaped latency and bandwidth. Search runs BilibiliPlatform::searchByTitle with
+ * the streaming callback, as NetworkManager's Bilibili search does, timed to the first
+ * batch and to the last. Stream start times playurl resolution, the size probe and the
+ * download until the decoder hands over its first PCM frame.
+ *
+ * These take milliseconds per run; pass --benchmark-samples 20 for quicker numbers.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <audio/audio_frame.h>
+#include <audio/ffmpeg_decoder.h>
+#include <network/cancel_token.h>
+#include <network/platform/bili_network_interface.h>
+#include <stream/realtime_pipe.hpp>
+#include <util/audio_generator.h>
+#include <util/replay_server.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "test_utils.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+const std::string FIXTURE = "data/replay/bilibili_search.json";
+const std::string API_HOST = "https://api.bilibili.com";
+const std::string CDN_HOST = "https://upos-sz-mirrorcos.bilivideo.com";
+const std::string STREAM_PATH = "/upgcxcode/replay/tone.wav";
+
+struct Profile {
+    const char* name;
+    testutils::ReplayServer::Shaping shaping;
+};
+// Loopback, then roughly a home connection to a nearby CDN node
+const Profile PROFILES[] = {
+    { "loopback", {} },
+    { "30 ms, 2 MB/s", { 30ms, 2 * 1024 * 1024 } },
+};
+
+// Replay servers for the API and CDN hosts, and a platform connecting to them
+struct ReplayEnvironment {
+    testutils::ReplayServer api{API_HOST};
+    testutils::ReplayServer cdn{CDN_HOST};
+    std::shared_ptr<network::BilibiliPlatform> platform;
+
+    ReplayEnvironment()
+    {
+        REQUIRE(api.loadFixture(FIXTURE));
+        REQUIRE(api.start());
+        REQUIRE(cdn.start());
+        platform = std::make_shared<network::BilibiliPlatform>();
+        platform->test_redirect_hosts({ { API_HOST, api.origin() }, { CDN_HOST, cdn.origin() } });
+        // Keys as the nav endpoint would hand out; only their presence matters here
+        platform->test_seed_wbi_keys("7cd084941338484aae1ad9425b84077c", "4932caff0ff746eab6f01bf08b70ac45",
+                                     std::chrono::system_clock::now());
+        // Every run looks its pages up again
+        platform->setPageCacheTtl(0s);
+    }
+
+    void shape(const testutils::ReplayServer::Shaping& shaping)
+    {
+        api.setShaping(shaping);
+        cdn.setShaping(shaping);
+    }
+};
+
+// A 2 s stereo tone, long enough that the decoder never reaches the end first
+std::string toneWav()
+{
+    const auto path = std::filesystem::temp_directory_path() / "BilibiliPlayerBench" / "replay_tone.wav";
+    REQUIRE(test_audio::write_sine_wav(QString::fromStdString(path.string()), 440.0, 2.0, 44100, 2));
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream content;
+    content << in.rdbuf();
+    std::filesystem::remove(path);
+    return content.str();
+}
+
+// A stream started by one benchmark run; torn down outside the timed part
+struct StreamRun {
+    std::shared_ptr<RealtimePipe> pipe;
+    std::shared_ptr<AudioFrameQueue> frames;
+    std::unique_ptr<audio::FFmpegStreamDecoder> decoder;
+    std::future<bool> download;
+
+    ~StreamRun()
+    {
+        if (pipe) pipe->close();
+        decoder.reset();
+        if (download.valid()) download.wait();
+    }
+};
+}
+
+TEST_CASE("Bilibili search over replayed responses", "[bench][network][replay]") {
+    ReplayEnvironment env;
+
+    for (const Profile& profile : PROFILES) {
+        env.shape(profile.shaping);
+        const std::string suffix = std::string(", ") + profile.name;
+
+        BENCHMARK("searchByTitle first batch" + suffix) {
+            auto cancel = std::make_shared<network::CancelToken>();
+            size_t received = 0;
+            env.platform->searchByTitle("bad apple", 1, [&](std::vector<network::SearchResult>&& batch) {
+                received = batch.size();
+                cancel->cancel();       // The remaining lookups stop instead of running on
+                return false;
+            }, cancel);
+            return received;
+        };
+
+        BENCHMARK("searchByTitle all results" + suffix) {
+            size_t received = 0;
+            env.platform->searchByTitle("bad apple", 1, [&](std::vector<network::SearchResult>&& batch) {
+                received += batch.size();
+                return true;
+            });
+            return received;
+        };
+    }
+    REQUIRE(env.api.missCount() == 0);
+}
+
+TEST_CASE("Stream to first PCM frame over replayed responses", "[bench][network][replay][ffmpeg]") {
+    testutils::ensureQCoreApplication();
+    ReplayEnvironment env;
+    env.cdn.addResponse(STREAM_PATH, {}, 200, "audio/wav", toneWav());
+    // A fresh cid each run, so playurl is resolved every time rather than cached
+    std::atomic<int64_t> nextCid{1000};
+
+    for (const Profile& profile : PROFILES) {
+        env.shape(profile.shaping);
+        BENCHMARK_ADVANCED(std::string("stream to first PCM frame, ") + profile.name)(Catch::Benchmark::Chronometer meter) {
+            std::vector<StreamRun> runs(meter.runs());
+            meter.measure([&](int i) {
+                StreamRun& run = runs[i];
+                const std::string params = "bvid=BV1xx411c7mD&cid=" + std::to_string(nextCid++);
+                const std::string url = env.platform->getAudioUrlByParams(params);
+                const uint64_t size = env.platform->getStreamInfo(url).size;
+
+                run.pipe = std::make_shared<RealtimePipe>(256 * 1024);
+                run.frames = std::make_shared<AudioFrameQueue>();
+                run.decoder = std::make_unique<audio::FFmpegStreamDecoder>();
+                run.decoder->initialize(run.pipe->getInputStream(), run.frames);
+                run.download = env.platform->asyncDownloadStream(url, [pipe = run.pipe](const char* data, size_t length) {
+                    return pipe->write(data, length) == length;
+                });
+                run.decoder->startDecoding(size);
+
+                std::shared_ptr<AudioFrame> frame;
+                run.frames->waitPop(frame);
+                run.pipe->close();      // Stops the download and the decoder's reader
+                return frame != nullptr;
+            });
+        };
+    }
+    REQUIRE(env.api.missCount() == 0);
+    REQUIRE(env.cdn.missCount() == 0);
+}
@@ -177,6 +177,31 @@ TEST_CASE("BilibiliPlatform: Platform-specific search", "[BilibiliPlatform][Sear
         REQUIRE(page1.size() >= 0);
         REQUIRE(page2.size() >= 0);
     }
+    
+    SECTION("streaming searchByTitle delivers non-empty batches") {
+        size_t batches = 0;
+        size_t received = 0;
+        size_t delivered = netInterface->searchByTitle("Bad Apple", 1,
+            [&](std::vector<SearchResult>&& batch) {
+                REQUIRE_FALSE(batch.empty());
+                ++batches;
+                received += batch.size();
+                return true;
+            });
+        
+        REQUIRE(delivered == received);
+        REQUIRE(batches <= received);
+    }
+    
+    SECTION("streaming searchByTitle stops when the callback declines") {
+        size_t batches = 0;
+        netInterface->searchByTitle("Bad Apple", 1, [&](std::vector<SearchResult>&&) {
+            ++batches;
+            return false;
+        });
+        
+        REQUIRE(batches <= 1);
+    }
 }
 
 // ========== HTTP Stream Operations Tests ==========
@@ -391,6 +416,93 @@ TEST_CASE("BilibiliPlatform: Cookie management (UNIT_TEST)", "[BilibiliPlatform]
         REQUIRE(headers1.size() >= 0);
         REQUIRE(headers2.size() >= 0);
     }
+    
+    SECTION("cookies added later reach headers built before") {
+        auto before = netInterface->test_get_headers_for_url("https://late.example.com/x/api");
+        netInterface->test_add_cookie_from_set_cookie("late=1; Path=/x", "late.example.com");
+        auto after = netInterface->test_get_headers_for_url("https://late.example.com/x/api");
+        auto other = netInterface->test_get_headers_for_url("https://late.example.com/y/api");
+        
+        REQUIRE(before.find("Cookie") == before.end()
+                || before.find("Cookie")->second.find("late=1") == std::string::npos);
+        REQUIRE(after.find("Cookie") != after.end());
+        REQUIRE(after.find("Cookie")->second.find("late=1") != std::string::npos);
+        REQUIRE((other.find("Cookie") == other.end()
+                 || other.find("Cookie")->second.find("late=1") == std::string::npos));
+    }
+}
+
+// ========== Playurl Cache Tests (using UNIT_TEST methods) ==========
+
+TEST_CASE("BilibiliPlatform: Playurl cache (UNIT_TEST)", "[BilibiliPlatform][PlayUrl][UNIT_TEST]") {
+    QtAppFixture::instance();
+    auto netInterface = std::make_shared<BilibiliPlatform>();
+    const std::string params = "bvid=BV1xx411c79H&cid=3724723";
+    const auto deadline = std::chrono::system_clock::to_time_t(
+        std::chrono::system_clock::now() + std::chrono::hours(2));
+    
+    SECTION("a URL before its deadline is served without a request") {
+        std::string url = "https://upos-sz-mirror.bilivideo.com/a.m4s?e=x&deadline=" + std::to_string(deadline) + "&os=cos";
+        netInterface->test_seed_play_url(params, url);
+        
+        REQUIRE(netInterface->getAudioUrlByParams(params) == url);
+        REQUIRE(netInterface->prefetchAudioUrl(params));
+    }
+    
+    SECTION("the cache key ignores parameter order") {
+        std::string url = "https://upos-sz-mirror.bilivideo.com/b.m4s?deadline=" + std::to_string(deadline);
+        netInterface->test_seed_play_url(params, url);
+        
+        REQUIRE(netInterface->getAudioUrlByParams("cid=3724723&bvid=BV1xx411c79H") == url);
+    }
+    
+    SECTION("a URL without a deadline is kept for a default lifetime") {
+        std::string url = "https://upos-sz-mirror.bilivideo.com/c.m4s";
+        netInterface->test_seed_play_url(params, url);
+        
+        REQUIRE(netInterface->getAudioUrlByParams(params) == url);
+    }
+    
+    SECTION("every resolve of a track gets the stream picked first") {
+        const std::string suffix = "?deadline=" + std::to_string(deadline);
+        const std::string lossy = "https://upos-sz-mirror.bilivideo.com/64k.m4s" + suffix;
+        const std::string lossless = "https://upos-sz-mirror.bilivideo.com/flac.m4s" + suffix;
+        netInterface->test_seed_play_streams(params, { { lossy, 64000, false }, { lossless, 1000000, true } });
+        
+        netInterface->setAudioQuality(AudioQuality::DataSaver);
+        REQUIRE(netInterface->getAudioUrlByParams(params) == lossy);
+        // A size probe resolving after the preference changed still matches the download
+        netInterface->setAudioQuality(AudioQuality::Best);
+        REQUIRE(netInterface->getAudioUrlByParams(params) == lossy);
+    }
+}
+
+TEST_CASE("BilibiliPlatform: WBI signing (UNIT_TEST)", "[BilibiliPlatform][Wbi][UNIT_TEST]") {
+    QtAppFixture::instance();
+    auto netInterface = std::make_shared<BilibiliPlatform>();
+    const std::string img_key = "7cd084941338484aae1ad9425b84077c";
+    const std::string sub_key = "4932caff0ff746eab6f01bf08b70ac45";
+    std::unordered_map<std::string, std::string> params = { {"keyword", "test"}, {"page", "1"} };
+    
+    SECTION("no keys and no refresher fails without waiting") {
+        REQUIRE_FALSE(netInterface->test_sign_wbi(params));
+        REQUIRE(params.count("w_rid") == 0);
+    }
+    
+    SECTION("fresh keys add wts and w_rid") {
+        netInterface->test_seed_wbi_keys(img_key, sub_key, std::chrono::system_clock::now());
+        REQUIRE(netInterface->test_sign_wbi(params));
+        REQUIRE(!params["wts"].empty());
+        REQUIRE(params["w_rid"].size() == 32);
+    }
+    
+    SECTION("stale keys keep signing until they are replaced") {
+        netInterface->test_seed_wbi_keys(img_key, sub_key, std::chrono::system_clock::now() - std::chrono::hours(72));
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(netInterface->test_sign_wbi(params));
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+        REQUIRE(params["w_rid"].size() == 32);
+    }
 }
 
 #endif // UNIT_TEST
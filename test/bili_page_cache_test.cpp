@@ -0,0 +1,151 @@
+/**
+ * BiliPageCache Unit Tests
+ *
+ * Tests in-memory hits, TTL expiry, persistence across instances through
+ * the cache file, lazy loading and the memory-only mode.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/platform/bili_page_cache.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using network::BiliPageCache;
+using network::BilibiliPageInfo;
+
+namespace {
+    std::vector<BilibiliPageInfo> samplePages() {
+        return {
+            { 1001, 1, "Part one", 180, "http://i0.hdslb.com/one.jpg" },
+            { 1002, 2, "Part two", 240, "" }
+        };
+    }
+
+    std::filesystem::path freshDirectory() {
+        auto dir = std::filesystem::temp_directory_path() / "BilibiliPlayerTestData" / "page_cache";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+}
+
+TEST_CASE("BiliPageCache stores page lists by bvid", "[BiliPageCache]") {
+    BiliPageCache cache;
+
+    SECTION("a stored list is returned intact") {
+        cache.put("BV1xx411c79H", samplePages());
+        auto pages = cache.get("BV1xx411c79H");
+        REQUIRE(pages.has_value());
+        REQUIRE(pages->size() == 2);
+        REQUIRE((*pages)[0].cid == 1001);
+        REQUIRE((*pages)[1].part == "Part two");
+        REQUIRE((*pages)[1].duration == 240);
+    }
+
+    SECTION("unknown bvids miss") {
+        REQUIRE_FALSE(cache.get("BV1unknown").has_value());
+    }
+
+    SECTION("a zero TTL disables the cache") {
+        cache.setTtl(std::chrono::seconds(0));
+        cache.put("BV1xx411c79H", samplePages());
+        REQUIRE_FALSE(cache.get("BV1xx411c79H").has_value());
+        REQUIRE(cache.size() == 0);
+    }
+
+    SECTION("without a directory save() is a no-op") {
+        cache.put("BV1xx411c79H", samplePages());
+        REQUIRE(cache.save());
+    }
+}
+
+TEST_CASE("BiliPageCache persists to its directory", "[BiliPageCache]") {
+    const auto dir = freshDirectory();
+    const auto file = dir / BiliPageCache::FILE_NAME;
+
+    SECTION("entries survive a new instance") {
+        {
+            BiliPageCache cache;
+            cache.setDirectory(dir.string());
+            cache.put("BV1xx411c79H", samplePages());
+            REQUIRE(cache.save());
+        }
+        REQUIRE(std::filesystem::exists(file));
+
+        BiliPageCache reloaded;
+        reloaded.setDirectory(dir.string());
+        auto pages = reloaded.get("BV1xx411c79H");
+        REQUIRE(pages.has_value());
+        REQUIRE(pages->size() == 2);
+        REQUIRE((*pages)[0].firstFrame == "http://i0.hdslb.com/one.jpg");
+    }
+
+    SECTION("the file is only read on first use") {
+        BiliPageCache cache;
+        cache.setDirectory(dir.string());
+        REQUIRE(cache.size() == 0);
+        {
+            BiliPageCache writer;
+            writer.setDirectory(dir.string());
+            writer.put("BV1late", samplePages());
+            REQUIRE(writer.save());
+        }
+        REQUIRE(cache.get("BV1late").has_value());
+    }
+
+    SECTION("expired entries on disk are dropped") {
+        {
+            // One entry fetched in 1970, one just now
+            std::ofstream out(file);
+            out << R"({"entries":{"BV1old":{"fetched":1000,"pages":[{"cid":1,"page":1,"part":"a","duration":1,"first_frame":""}]},)"
+                << R"("BV1new":{"fetched":)" << std::chrono::system_clock::to_time_t(std::chrono::system_clock::now())
+                << R"(,"pages":[{"cid":2,"page":1,"part":"b","duration":1,"first_frame":""}]}}})";
+        }
+        BiliPageCache cache(std::chrono::hours(1));
+        cache.setDirectory(dir.string());
+        REQUIRE_FALSE(cache.get("BV1old").has_value());
+        auto pages = cache.get("BV1new");
+        REQUIRE(pages.has_value());
+        REQUIRE((*pages)[0].cid == 2);
+        REQUIRE(cache.size() == 1);
+    }
+
+    SECTION("a corrupt file is ignored") {
+        {
+            std::ofstream out(file);
+            out << "{ not json";
+        }
+        BiliPageCache cache;
+        cache.setDirectory(dir.string());
+        REQUIRE_FALSE(cache.get("BV1xx411c79H").has_value());
+        cache.put("BV1xx411c79H", samplePages());
+        REQUIRE(cache.save());
+        BiliPageCache reloaded;
+        reloaded.setDirectory(dir.string());
+        REQUIRE(reloaded.get("BV1xx411c79H").has_value());
+    }
+
+    SECTION("saving keeps entries written by an earlier session") {
+        {
+            BiliPageCache first;
+            first.setDirectory(dir.string());
+            first.put("BV1first", samplePages());
+            REQUIRE(first.save());
+        }
+        {
+            BiliPageCache second;
+            second.setDirectory(dir.string());
+            second.put("BV1second", samplePages());
+            REQUIRE(second.save());
+        }
+        BiliPageCache reloaded;
+        reloaded.setDirectory(dir.string());
+        REQUIRE(reloaded.get("BV1first").has_value());
+        REQUIRE(reloaded.get("BV1second").has_value());
+    }
+
+    std::filesystem::remove_all(dir);
+}
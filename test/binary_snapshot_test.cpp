@@ -0,0 +1,163 @@
+/**
+ * BinarySnapshot Unit Tests
+ *
+ * Tests a library written and read back in place, playlist lookup by uuid,
+ * damaged files rejected, and PlaylistManager compacting into the binary format.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <QDir>
+#include <QFile>
+#include <chrono>
+#include <filesystem>
+
+#include "config/config_manager.h"
+#include "playlist/binary_snapshot.h"
+#include "playlist/playlist_manager.h"
+#include "test_utils.h"
+
+using playlist::BinarySnapshot;
+using testutils::TempDir;
+using testutils::makeSong;
+
+namespace {
+    playlist::PlaylistInfo makePlaylist(const QString& name)
+    {
+        playlist::PlaylistInfo list;
+        list.name = name;
+        list.creator = "me";
+        list.uuid = QUuid::createUuid();
+        return list;
+    }
+
+    QStringList titles(const QList<playlist::SongInfo>& songs)
+    {
+        QStringList result;
+        for (const auto& song : songs) {
+            result << song.title;
+        }
+        return result;
+    }
+}
+
+TEST_CASE("BinarySnapshot reads back what was written", "[BinarySnapshot]") {
+    TempDir dir("binary_snapshot");
+    const std::string path = dir.file("categories.bin");
+
+    playlist::LibraryContents contents;
+    playlist::CategoryInfo first{ "First", QUuid::createUuid() };
+    playlist::CategoryInfo second{ "Second", QUuid::createUuid() };
+    contents.categories << first << second;
+    playlist::PlaylistInfo a = makePlaylist("A");
+    playlist::PlaylistInfo b = makePlaylist("B");
+    playlist::PlaylistInfo c = makePlaylist("C");
+    a.description = QString::fromUtf8("歌单");
+    contents.playlists[first.uuid] << a;
+    contents.playlists[second.uuid] << b << c;
+    playlist::SongInfo loud = makeSong("Loud");
+    loud.loudnessGainDb = -3.5f;
+    loud.loudnessAnalyzed = true;
+    contents.songs[a.uuid] << makeSong("One") << loud;
+    contents.songs[c.uuid] << makeSong("Two");
+    contents.currentPlaylistId = c.uuid;
+    REQUIRE(BinarySnapshot::write(QString::fromStdString(path), contents, 42));
+
+    BinarySnapshot snapshot;
+    REQUIRE(snapshot.open(path));
+    REQUIRE(snapshot.journalSeq() == 42);
+    REQUIRE(snapshot.currentPlaylistId() == c.uuid);
+    REQUIRE(snapshot.categoryCount() == 2);
+    REQUIRE(snapshot.category(1).name == "Second");
+    REQUIRE(snapshot.category(1).uuid == second.uuid);
+
+    // A category's playlists in order
+    const auto [firstIndex, count] = snapshot.categoryPlaylists(1);
+    REQUIRE(count == 2);
+    REQUIRE(snapshot.playlist(firstIndex).name == "B");
+    REQUIRE(snapshot.playlist(firstIndex + 1).uuid == c.uuid);
+    REQUIRE(snapshot.playlist(snapshot.categoryPlaylists(0).first).description == a.description);
+
+    int index = snapshot.findPlaylist(a.uuid);
+    REQUIRE(index >= 0);
+    QList<playlist::SongInfo> songs = snapshot.songs(index);
+    REQUIRE(titles(songs) == QStringList{ "One", "Loud" });
+    REQUIRE(songs[0].uploader == "up");
+    REQUIRE(songs[0].args == "one");
+    REQUIRE_FALSE(songs[0].loudnessAnalyzed);
+    REQUIRE(songs[1].uuid == loud.uuid);
+    REQUIRE(songs[1].loudnessAnalyzed);
+    REQUIRE(songs[1].loudnessGainDb == -3.5f);
+
+    REQUIRE(snapshot.songs(snapshot.findPlaylist(b.uuid)).isEmpty());
+    REQUIRE(snapshot.findPlaylist(QUuid::createUuid()) == -1);
+    REQUIRE(snapshot.songs(-1).isEmpty());
+    REQUIRE(snapshot.category(5).uuid.isNull());
+}
+
+TEST_CASE("BinarySnapshot rejects damaged files", "[BinarySnapshot]") {
+    TempDir dir("binary_snapshot");
+    const std::string path = dir.file("categories.bin");
+    playlist::LibraryContents contents;
+    contents.categories << playlist::CategoryInfo{ "Cat", QUuid::createUuid() };
+    REQUIRE(BinarySnapshot::write(QString::fromStdString(path), contents, 0));
+
+    QFile file(QString::fromStdString(path));
+    REQUIRE(file.open(QIODevice::ReadWrite));
+
+    SECTION("truncated") {
+        REQUIRE(file.resize(40));
+        file.close();
+        BinarySnapshot snapshot;
+        REQUIRE_FALSE(snapshot.open(path));
+        REQUIRE_FALSE(snapshot.isOpen());
+    }
+
+    SECTION("another format") {
+        REQUIRE(file.write("NOTALIB!", 8) == 8);
+        file.close();
+        BinarySnapshot snapshot;
+        REQUIRE_FALSE(snapshot.open(path));
+    }
+
+    SECTION("records beyond the end") {
+        REQUIRE(file.resize(file.size() - 8));
+        file.close();
+        BinarySnapshot snapshot;
+        REQUIRE_FALSE(snapshot.open(path));
+    }
+}
+
+TEST_CASE("PlaylistManager keeps its snapshot in the binary format when configured", "[playlist_manager][BinarySnapshot]") {
+    testutils::ensureQCoreApplication();
+    TempDir dir("binary_snapshot");
+    ConfigManager cfg;
+    cfg.initialize(QString::fromStdString(dir.path.string()));
+
+    playlist::CategoryInfo category{ "Bin Cat", QUuid::createUuid() };
+    playlist::PlaylistInfo list = makePlaylist("Bin Playlist");
+    {
+        // Written as JSON first, then switched over
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        REQUIRE(mgr.addCategory(category));
+        REQUIRE(mgr.addPlaylist(list, category.uuid));
+        REQUIRE(mgr.addSongToPlaylist(makeSong("One"), list.uuid));
+        mgr.saveAllCategories();
+    }
+    cfg.setPlaylistStorage("binary");
+    {
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        REQUIRE(mgr.playlistExists(list.uuid));
+        REQUIRE(mgr.addSongToPlaylist(makeSong("Two"), list.uuid));
+        mgr.saveAllCategories();
+    }
+
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    REQUIRE(mgr.getCategory(category.uuid).has_value());
+    QStringList loaded;
+    mgr.iterateSongsInPlaylist(list.uuid, [&](const playlist::SongInfo& song) { loaded << song.title; return true; });
+    REQUIRE(loaded == QStringList{ "One", "Two" });
+}
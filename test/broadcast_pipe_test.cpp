@@ -0,0 +1,155 @@
+/**
+ * BroadcastPipe Unit Tests
+ *
+ * Tests that every reader sees the full byte stream, that readers progress
+ * independently until the lag limit, detach and close semantics, and the
+ * istream adapter.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <stream/broadcast_pipe.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::vector<char> pattern(size_t size) {
+        std::vector<char> data(size);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<char>((i * 13 + 5) & 0xFF);
+        }
+        return data;
+    }
+
+    std::vector<char> drain(BroadcastPipe::Reader& reader, size_t chunkSize) {
+        std::vector<char> out;
+        std::vector<char> chunk(chunkSize);
+        size_t got = 0;
+        while ((got = reader.read(chunk.data(), chunk.size())) > 0) {
+            out.insert(out.end(), chunk.begin(), chunk.begin() + got);
+        }
+        return out;
+    }
+}
+
+TEST_CASE("BroadcastPipe delivers every byte to every reader", "[BroadcastPipe]") {
+    auto pipe = std::make_shared<BroadcastPipe>(1024);
+    REQUIRE(pipe->lagLimit() == 1024);
+    auto first = pipe->openReader();
+    auto second = pipe->openReader();
+    REQUIRE(pipe->readerCount() == 2);
+
+    const auto data = pattern(64 * 1024);
+    std::thread writer([&]() {
+        CHECK(pipe->write(data.data(), data.size()) == data.size());
+        pipe->closeWriter();
+    });
+
+    std::vector<char> secondData;
+    std::thread secondReader([&]() { secondData = drain(*second, 100); });
+    auto firstData = drain(*first, 333);
+
+    writer.join();
+    secondReader.join();
+    REQUIRE(firstData == data);
+    REQUIRE(secondData == data);
+    REQUIRE_FALSE(pipe->aborted());
+}
+
+TEST_CASE("BroadcastPipe lag limit", "[BroadcastPipe]") {
+    SECTION("Writer runs ahead of a stalled reader up to the limit") {
+        auto pipe = std::make_shared<BroadcastPipe>(256);
+        auto fast = pipe->openReader();
+        auto slow = pipe->openReader();
+        const auto data = pattern(1024);
+
+        std::atomic<size_t> written{0};
+        std::thread writer([&]() {
+            written = pipe->write(data.data(), data.size());
+        });
+
+        // The fast reader keeps up until the stalled one is a full limit behind
+        std::vector<char> chunk(1024);
+        size_t fastRead = 0;
+        while (fastRead < 256) {
+            fastRead += fast->read(chunk.data(), chunk.size());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        REQUIRE(written.load() == 0);
+        REQUIRE(slow->available() == 256);
+        REQUIRE(fast->available() == 0);
+
+        // Detaching the stalled reader releases the writer
+        slow.reset();
+        while (fastRead < data.size()) {
+            fastRead += fast->read(chunk.data(), chunk.size());
+        }
+        writer.join();
+        REQUIRE(written.load() == data.size());
+    }
+
+    SECTION("Writing stops once every reader is gone") {
+        auto pipe = std::make_shared<BroadcastPipe>(64);
+        const auto data = pattern(128);
+        REQUIRE(pipe->write(data.data(), data.size()) == 0);
+
+        auto reader = pipe->openReader();
+        std::thread writer([&]() {
+            CHECK(pipe->write(data.data(), data.size()) == 64);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        reader.reset();
+        writer.join();
+    }
+}
+
+TEST_CASE("BroadcastPipe close and streams", "[BroadcastPipe]") {
+    SECTION("close() wakes blocked readers without EOF data") {
+        auto pipe = std::make_shared<BroadcastPipe>(64);
+        auto reader = pipe->openReader();
+        std::thread blocked([&]() {
+            char c;
+            CHECK(reader->read(&c, 1) == 0);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pipe->close();
+        blocked.join();
+        REQUIRE(pipe->aborted());
+    }
+
+    SECTION("Readers opened later only see later bytes") {
+        auto pipe = std::make_shared<BroadcastPipe>(64);
+        auto early = pipe->openReader();
+        pipe->write("abc", 3);
+        auto late = pipe->openReader();
+        pipe->write("def", 3);
+        pipe->closeWriter();
+
+        auto earlyData = drain(*early, 8);
+        auto lateData = drain(*late, 8);
+        REQUIRE(std::string(earlyData.begin(), earlyData.end()) == "abcdef");
+        REQUIRE(std::string(lateData.begin(), lateData.end()) == "def");
+    }
+
+    SECTION("Input streams read through their own cursor") {
+        auto pipe = std::make_shared<BroadcastPipe>(4096);
+        auto in = pipe->getInputStream();
+        auto raw = pipe->openReader();
+        const std::string message = "broadcast to all readers";
+        pipe->write(message.data(), message.size());
+        pipe->closeWriter();
+
+        std::string word;
+        *in >> word;
+        REQUIRE(word == "broadcast");
+        std::vector<char> rest(64);
+        in->read(rest.data(), static_cast<std::streamsize>(rest.size()));
+        REQUIRE(std::string(rest.data(), static_cast<size_t>(in->gcount())) == " to all readers");
+        REQUIRE(in->eof());
+
+        auto rawData = drain(*raw, 5);
+        REQUIRE(std::string(rawData.begin(), rawData.end()) == message);
+    }
+}
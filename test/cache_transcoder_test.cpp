@@ -0,0 +1,113 @@
+/**
+ * CacheTranscoder Unit Tests
+ *
+ * Tests transcoding a lossless file to Ogg/Opus, leaving Opus files as they are and
+ * compacting an audio cache entry in place. Needs FFmpeg with the libopus encoder.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/cache_transcoder.h>
+#include <util/audio_cache_store.h>
+#include <util/audio_generator.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+using audio::CacheTranscoder;
+using util::AudioCacheStore;
+namespace fs = std::filesystem;
+
+namespace {
+    struct TempDir {
+        fs::path path;
+        TempDir() {
+            std::random_device rd;
+            path = fs::temp_directory_path() / ("cache_transcoder_test_" + std::to_string(rd()));
+            fs::create_directories(path);
+        }
+        ~TempDir() {
+            std::error_code ec;
+            fs::remove_all(path, ec);
+        }
+    };
+
+    // Codec of the first audio stream, AV_CODEC_ID_NONE if the file can't be read
+    AVCodecID audioCodecOf(const std::string& path) {
+        AVFormatContext* format = nullptr;
+        if (avformat_open_input(&format, path.c_str(), nullptr, nullptr) < 0) {
+            return AV_CODEC_ID_NONE;
+        }
+        AVCodecID codec = AV_CODEC_ID_NONE;
+        if (avformat_find_stream_info(format, nullptr) >= 0) {
+            const int stream = av_find_best_stream(format, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+            if (stream >= 0) {
+                codec = format->streams[stream]->codecpar->codec_id;
+            }
+        }
+        avformat_close_input(&format);
+        return codec;
+    }
+}
+
+TEST_CASE("CacheTranscoder transcodes files to Opus", "[CacheTranscoder][ffmpeg]") {
+    if (!CacheTranscoder::encoderAvailable()) {
+        SKIP("FFmpeg was built without libopus");
+    }
+    TempDir dir;
+    std::atomic<bool> stop{false};
+    const std::string wav = (dir.path / "tone.wav").string();
+    REQUIRE(test_audio::write_sine_wav(QString::fromStdString(wav), 440.0, 3.0, 44100, 2, 16));
+    const std::string opus = (dir.path / "tone.opus.tmp").string();
+
+    SECTION("PCM comes out as a smaller Ogg/Opus file") {
+        REQUIRE(CacheTranscoder::transcodeFile(wav, opus, 64, stop) == CacheTranscoder::Result::Transcoded);
+        REQUIRE(audioCodecOf(opus) == AV_CODEC_ID_OPUS);
+        REQUIRE(fs::file_size(opus) < fs::file_size(wav) / 4);
+
+        SECTION("and isn't transcoded again") {
+            const std::string again = (dir.path / "again.tmp").string();
+            REQUIRE(CacheTranscoder::transcodeFile(opus, again, 64, stop) == CacheTranscoder::Result::Skipped);
+            REQUIRE_FALSE(fs::exists(again));
+        }
+    }
+
+    SECTION("a stop request leaves no output") {
+        stop.store(true);
+        REQUIRE(CacheTranscoder::transcodeFile(wav, opus, 64, stop) == CacheTranscoder::Result::Stopped);
+        REQUIRE_FALSE(fs::exists(opus));
+    }
+
+    SECTION("a file that isn't audio fails without output") {
+        const std::string bogus = (dir.path / "bogus.audio").string();
+        std::ofstream(bogus, std::ios::binary) << std::string(4096, 'x');
+        REQUIRE(CacheTranscoder::transcodeFile(bogus, opus, 64, stop) == CacheTranscoder::Result::Failed);
+        REQUIRE_FALSE(fs::exists(opus));
+    }
+}
+
+TEST_CASE("CacheTranscoder compacts cache entries in place", "[CacheTranscoder][ffmpeg]") {
+    if (!CacheTranscoder::encoderAvailable()) {
+        SKIP("FFmpeg was built without libopus");
+    }
+    TempDir dir;
+    std::atomic<bool> stop{false};
+    const std::string cached = (dir.path / "1_tone.audio").string();
+    REQUIRE(test_audio::write_sine_wav(QString::fromStdString(cached), 440.0, 3.0, 44100, 2, 16));
+    // Adopted by the scan without play history, so it's cold
+    AudioCacheStore store(dir.path);
+    const auto entries = store.coldEntries(CacheTranscoder::COLD_AFTER, CacheTranscoder::FILES_PER_PASS);
+    REQUIRE(entries.size() == 1);
+
+    REQUIRE(CacheTranscoder::compactEntry(store, entries.front(), 64, stop) == CacheTranscoder::Result::Transcoded);
+    REQUIRE(audioCodecOf(cached) == AV_CODEC_ID_OPUS);
+    REQUIRE(store.totalBytes() == fs::file_size(cached));
+    REQUIRE(store.totalBytes() < entries.front().size);
+    REQUIRE(store.open(cached));
+    REQUIRE(store.coldEntries(CacheTranscoder::COLD_AFTER, CacheTranscoder::FILES_PER_PASS).empty());
+    REQUIRE_FALSE(fs::exists(cached + ".opus.tmp"));
+}
@@ -0,0 +1,89 @@
+/**
+ * CancelToken Unit Tests
+ *
+ * Tests that cancel() runs the registered aborts exactly once, that a
+ * released registration never fires, and that registering on a cancelled
+ * token aborts at once.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/cancel_token.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using network::CancelToken;
+
+TEST_CASE("CancelToken runs registered aborts", "[CancelToken]") {
+    CancelToken token;
+    int aborted = 0;
+
+    SECTION("cancel aborts live registrations once") {
+        auto first = token.onCancel([&]() { ++aborted; });
+        auto second = token.onCancel([&]() { ++aborted; });
+        REQUIRE_FALSE(token.cancelled());
+        token.cancel();
+        REQUIRE(token.cancelled());
+        REQUIRE(aborted == 2);
+        token.cancel();
+        REQUIRE(aborted == 2);
+    }
+
+    SECTION("released registrations do not fire") {
+        auto kept = token.onCancel([&]() { ++aborted; });
+        {
+            auto scoped = token.onCancel([&]() { aborted += 10; });
+        }
+        auto reset = token.onCancel([&]() { aborted += 100; });
+        reset.reset();
+        token.cancel();
+        REQUIRE(aborted == 1);
+    }
+
+    SECTION("moved registrations stay registered once") {
+        CancelToken::Registration outer;
+        {
+            auto inner = token.onCancel([&]() { ++aborted; });
+            outer = std::move(inner);
+        }
+        token.cancel();
+        REQUIRE(aborted == 1);
+    }
+
+    SECTION("registering on a cancelled token aborts at once") {
+        token.cancel();
+        auto late = token.onCancel([&]() { ++aborted; });
+        REQUIRE(aborted == 1);
+    }
+}
+
+TEST_CASE("CancelToken wakes a blocked worker", "[CancelToken]") {
+    // Stands in for a request blocked in a read that only stop() can end
+    CancelToken token;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopped = false;
+    std::atomic<bool> registered{false};
+
+    std::thread worker([&]() {
+        auto abort = token.onCancel([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+            cv.notify_all();
+        });
+        registered = true;
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(10), [&]() { return stopped; });
+    });
+    while (!registered.load()) {
+        std::this_thread::yield();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    token.cancel();
+    worker.join();
+    REQUIRE(stopped);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
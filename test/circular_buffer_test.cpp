@@ -1,11 +1,16 @@
 /**
  * CircularBuffer Utility Unit Tests
  * 
- * Tests circular buffer operations, state management, and data integrity.
+ * Tests circular buffer operations, state management, and data integrity,
+ * plus the power-of-two RingBuffer variant and its overflow policies.
  */
 
 #include <catch2/catch_test_macros.hpp>
 #include <util/circular_buffer.hpp>
+#include <util/ring_buffer.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
 #include <vector>
 #include <stdexcept>
 
@@ -272,3 +277,217 @@ TEST_CASE("CircularBuffer data integrity", "[CircularBuffer]") {
         REQUIRE(buffer.size() == 2); // 2 remaining
     }
 }
+
+TEST_CASE("CircularBuffer discard/clear", "[CircularBuffer]") {
+    SECTION("Discard skips the oldest elements across the wrap point") {
+        CircularBuffer<uint8_t> buffer(5);
+        uint8_t data[] = {1, 2, 3, 4};
+        buffer.write(data, 4);
+        buffer.discard(3);
+        uint8_t more[] = {5, 6, 7};
+        buffer.write(more, 3);
+
+        REQUIRE(buffer.discard(2) == 2);
+        uint8_t result[2];
+        REQUIRE(buffer.read(result, 2) == 2);
+        REQUIRE(result[0] == 6);
+        REQUIRE(result[1] == 7);
+    }
+
+    SECTION("Discard is bounded by the current size") {
+        CircularBuffer<uint8_t> buffer(4);
+        uint8_t data[] = {1, 2};
+        buffer.write(data, 2);
+        REQUIRE(buffer.discard(10) == 2);
+        REQUIRE(buffer.empty());
+    }
+
+    SECTION("Clear empties a full buffer") {
+        CircularBuffer<uint8_t> buffer(3);
+        uint8_t data[] = {1, 2, 3};
+        buffer.write(data, 3);
+        REQUIRE(buffer.full());
+        buffer.clear();
+        REQUIRE(buffer.empty());
+        REQUIRE(buffer.size() == 0);
+    }
+}
+
+TEST_CASE("CircularBuffer in-place writes", "[CircularBuffer]") {
+    SECTION("Writable span covers free space up to the end of storage") {
+        CircularBuffer<uint8_t> buffer(8);
+        auto span = buffer.writableSpan();
+        REQUIRE(span.second == 8);
+        span.first[0] = 10;
+        span.first[1] = 11;
+        buffer.commit(2);
+        REQUIRE(buffer.size() == 2);
+
+        uint8_t result[2];
+        REQUIRE(buffer.read(result, 2) == 2);
+        REQUIRE(result[0] == 10);
+        REQUIRE(result[1] == 11);
+        // Free space now wraps; only the part before the end is contiguous
+        REQUIRE(buffer.writableSpan().second == 6);
+    }
+
+    SECTION("Span stops at the read position after wrapping") {
+        CircularBuffer<uint8_t> buffer(4);
+        uint8_t data[] = {1, 2, 3, 4};
+        buffer.write(data, 4);
+        REQUIRE(buffer.writableSpan().second == 0);
+        buffer.discard(3);
+
+        auto span = buffer.writableSpan();
+        REQUIRE(span.second == 3);
+        span.first[0] = 5;
+        span.first[1] = 6;
+        span.first[2] = 7;
+        buffer.commit(3);
+        REQUIRE(buffer.full());
+
+        uint8_t result[4];
+        REQUIRE(buffer.read(result, 4) == 4);
+        REQUIRE(result[0] == 4);
+        REQUIRE(result[3] == 7);
+    }
+
+    SECTION("Commit never exceeds free space") {
+        CircularBuffer<uint8_t> buffer(4);
+        buffer.commit(10);
+        REQUIRE(buffer.full());
+        REQUIRE(buffer.size() == 4);
+    }
+}
+
+TEST_CASE("RingBuffer construction and basics", "[RingBuffer]") {
+    SECTION("Capacity is rounded up to a power of two") {
+        RingBuffer<int> buffer(10);
+        REQUIRE(buffer.capacity() == 16);
+        REQUIRE(buffer.empty());
+        REQUIRE_THROWS_AS(RingBuffer<int>(0), std::invalid_argument);
+    }
+
+    SECTION("FIFO order across the wrap point") {
+        RingBuffer<int> buffer(4);
+        for (int round = 0; round < 3; ++round) {
+            for (int i = 0; i < 3; ++i) buffer.push(round * 10 + i);
+            for (int i = 0; i < 3; ++i) REQUIRE(buffer.pop() == round * 10 + i);
+        }
+        REQUIRE(buffer.empty());
+        REQUIRE_THROWS_AS(buffer.pop(), std::runtime_error);
+    }
+
+    SECTION("Non-trivially copyable elements take the element-wise path") {
+        RingBuffer<std::string> buffer(4);
+        std::string in[] = {"a", "bb", "ccc"};
+        buffer.write(in, 3);
+        std::string out[3];
+        REQUIRE(buffer.read(out, 3) == 3);
+        REQUIRE(out[2] == "ccc");
+    }
+}
+
+TEST_CASE("RingBuffer overflow policies", "[RingBuffer]") {
+    const int data[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+    SECTION("Overwrite drops the oldest elements") {
+        RingBuffer<int, OverflowPolicy::Overwrite> buffer(4);
+        REQUIRE(buffer.write(data, 6) == 6);
+        REQUIRE(buffer.full());
+        int out[4];
+        REQUIRE(buffer.read(out, 4) == 4);
+        REQUIRE(out[0] == 3);
+        REQUIRE(out[3] == 6);
+
+        // A single write larger than the buffer keeps its own tail
+        buffer.push(0);
+        REQUIRE(buffer.write(data, 10) == 10);
+        REQUIRE(buffer.read(out, 4) == 4);
+        REQUIRE(out[0] == 7);
+        REQUIRE(out[3] == 10);
+    }
+
+    SECTION("Reject stores only what fits") {
+        RingBuffer<int, OverflowPolicy::Reject> buffer(4);
+        REQUIRE(buffer.write(data, 3) == 3);
+        REQUIRE(buffer.write(data + 3, 3) == 1);
+        REQUIRE_FALSE(buffer.push(99));
+        int out[4];
+        REQUIRE(buffer.read(out, 4) == 4);
+        REQUIRE(out[0] == 1);
+        REQUIRE(out[3] == 4);
+    }
+
+    SECTION("Block waits for the consumer") {
+        RingBuffer<int, OverflowPolicy::Block> buffer(4);
+        std::vector<int> received;
+        std::thread consumer([&]() {
+            int out[3];
+            while (received.size() < 10) {
+                size_t got = buffer.read(out, 3);
+                received.insert(received.end(), out, out + got);
+                if (got == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        REQUIRE(buffer.write(data, 10) == 10);
+        consumer.join();
+        REQUIRE(received == std::vector<int>(data, data + 10));
+    }
+
+    SECTION("Block writer gives up on close") {
+        RingBuffer<int, OverflowPolicy::Block> buffer(2);
+        size_t written = 0;
+        std::thread writer([&]() { written = buffer.write(data, 5); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer.close();
+        writer.join();
+        REQUIRE(written == 2);
+        REQUIRE_FALSE(buffer.push(1));
+    }
+}
+
+TEST_CASE("RingBuffer spans", "[RingBuffer]") {
+    SECTION("Readable spans split at the end of storage") {
+        RingBuffer<uint8_t> buffer(8);
+        uint8_t data[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        buffer.write(data, 6);
+        buffer.discard(5);
+        buffer.write(data + 6, 4);
+
+        auto spans = buffer.readableSpans();
+        REQUIRE(spans[0].second == 3);
+        REQUIRE(spans[1].second == 2);
+        REQUIRE(spans[0].first[0] == 6);
+        REQUIRE(spans[1].first[1] == 10);
+    }
+
+    SECTION("Writable spans cover all free space") {
+        RingBuffer<uint8_t, OverflowPolicy::Reject> buffer(8);
+        uint8_t data[] = {1, 2, 3, 4, 5, 6};
+        buffer.write(data, 6);
+        buffer.discard(4);
+
+        auto spans = buffer.writableSpans();
+        REQUIRE(spans[0].second == 2);
+        REQUIRE(spans[1].second == 4);
+        REQUIRE(buffer.writableSpan().second == 2);
+        spans[0].first[0] = 7;
+        spans[0].first[1] = 8;
+        spans[1].first[0] = 9;
+        buffer.commit(3);
+        REQUIRE(buffer.size() == 5);
+
+        uint8_t out[5];
+        REQUIRE(buffer.read(out, 5) == 5);
+        REQUIRE(out[0] == 5);
+        REQUIRE(out[4] == 9);
+    }
+
+    SECTION("Commit never exceeds free space") {
+        RingBuffer<uint8_t, OverflowPolicy::Reject> buffer(4);
+        buffer.commit(10);
+        REQUIRE(buffer.full());
+        REQUIRE(buffer.size() == 4);
+    }
+}
@@ -138,6 +138,41 @@ TEST_CASE("ConfigManager: getters/setters and signals", "[ConfigManager]") {
     REQUIRE(cfg.getAudioCacheDirectory().size() > 0);
 }
 
+TEST_CASE("ConfigManager: setters apply at once and reach the file in batches", "[ConfigManager]") {
+    testutils::ensureQCoreApplication();
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    QString workspace = QDir::toNativeSeparators(tmp.path());
+
+    ConfigManager cfg(nullptr);
+    cfg.initialize(workspace);
+    QString configFile = QDir(workspace).filePath(cfg.getConfigFilePath());
+
+    QSignalSpy networkSpy(&cfg, &ConfigManager::networkSettingsChanged);
+    cfg.setVolumeLevel(73);
+    cfg.setNetworkTimeout(1234);
+    cfg.setCoverCacheDirectory("covers2");
+
+    // Readers see the new values before anything is written
+    REQUIRE(cfg.getVolumeLevel() == 73);
+    REQUIRE(cfg.snapshot()->networkTimeout == 1234);
+    REQUIRE(cfg.getCoverCacheDirectory() == QDir(workspace).absoluteFilePath("covers2"));
+    REQUIRE(networkSpy.count() == 1);
+    REQUIRE(QSettings(configFile, QSettings::IniFormat).value("audio/volume_level").isNull());
+
+    cfg.saveToFile();
+    QSettings onDisk(configFile, QSettings::IniFormat);
+    REQUIRE(onDisk.value("audio/volume_level").toInt() == 73);
+    REQUIRE(onDisk.value("network/timeout").toInt() == 1234);
+    REQUIRE(onDisk.value("directories/cover_cache").toString() == "covers2");
+
+    // A fresh manager reads them back
+    ConfigManager reloaded(nullptr);
+    reloaded.initialize(workspace);
+    REQUIRE(reloaded.getVolumeLevel() == 73);
+    REQUIRE(reloaded.getCoverCacheDirectory() == cfg.getCoverCacheDirectory());
+}
+
 // Note: more detailed behavior tests (e.g., validateRelativePath, sanitizeRelativePath,
 // buildSafeFilePath) can be added similarly by creating files and directories
 
@@ -0,0 +1,152 @@
+/**
+ * CoverCache Unit Tests
+ *
+ * Covers lookups through the in-memory index, picking up covers already on disk,
+ * least recently used eviction over the budget, covers deleted behind its back, and
+ * covers saved under the MD5 names of earlier versions.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <config/config_manager.h>
+#include <util/cover_cache.h>
+#include <util/hash.h>
+#include <util/md5.h>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include "test_utils.h"
+
+namespace {
+    // JPEG magic followed by `size - 3` filler bytes
+    QByteArray jpeg(int size, char fill = 'x') {
+        QByteArray data("\xFF\xD8\xFF", 3);
+        data.append(QByteArray(size - 3, fill));
+        return data;
+    }
+
+    QString coverFile(const ConfigManager& config, const QString& source, const QString& extension) {
+        QString key = QString::fromStdString(util::hashHex(source.toStdString()));
+        return QDir(config.getCoverCacheDirectory()).filePath(key + "." + extension);
+    }
+
+    QString legacyCoverFile(const ConfigManager& config, const QString& source, const QString& extension) {
+        QString key = QString::fromStdString(util::md5Hash(source.toStdString()));
+        return QDir(config.getCoverCacheDirectory()).filePath(key + "." + extension);
+    }
+
+    bool writeFile(const QString& path, const QByteArray& data) {
+        QFile file(path);
+        return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+    }
+}
+
+TEST_CASE("CoverCache finds saved covers through its index", "[CoverCache]") {
+    testutils::ensureQCoreApplication();
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    ConfigManager config(nullptr);
+    config.initialize(tmp.path());
+    util::CoverCache cache(&config);
+
+    REQUIRE_FALSE(cache.hasCachedCover("https://i0.hdslb.com/a.jpg"));
+    REQUIRE(cache.getCacheSizeBytes() == 0);
+
+    auto saved = cache.saveCover("https://i0.hdslb.com/a.jpg", jpeg(1000));
+    REQUIRE(saved);
+    REQUIRE(*saved == coverFile(config, "https://i0.hdslb.com/a.jpg", "jpg"));
+    REQUIRE(cache.hasCachedCover("https://i0.hdslb.com/a.jpg"));
+    REQUIRE(cache.findCachedCover("https://i0.hdslb.com/a.jpg") == saved);
+    REQUIRE(cache.getCachedCover("https://i0.hdslb.com/a.jpg") == jpeg(1000));
+    REQUIRE(cache.getCacheSizeBytes() == 1000);
+
+    // Saving again in another format replaces the file
+    QByteArray png("\x89PNG", 4);
+    png.append(QByteArray(496, 'p'));
+    saved = cache.saveCover("https://i0.hdslb.com/a.jpg", png);
+    REQUIRE(saved);
+    REQUIRE(saved->endsWith(".png"));
+    REQUIRE_FALSE(QFile::exists(coverFile(config, "https://i0.hdslb.com/a.jpg", "jpg")));
+    REQUIRE(cache.getCacheSizeBytes() == 500);
+
+    REQUIRE(cache.removeCachedCover("https://i0.hdslb.com/a.jpg"));
+    REQUIRE_FALSE(cache.hasCachedCover("https://i0.hdslb.com/a.jpg"));
+    REQUIRE_FALSE(QFile::exists(*saved));
+    REQUIRE(cache.getCacheSizeBytes() == 0);
+    REQUIRE_FALSE(cache.removeCachedCover("https://i0.hdslb.com/a.jpg"));
+}
+
+TEST_CASE("CoverCache indexes covers already on disk", "[CoverCache]") {
+    testutils::ensureQCoreApplication();
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    ConfigManager config(nullptr);
+    config.initialize(tmp.path());
+    REQUIRE(QDir().mkpath(config.getCoverCacheDirectory()));
+    REQUIRE(writeFile(coverFile(config, "/music/a.flac", "jpg"), jpeg(300)));
+    REQUIRE(writeFile(coverFile(config, "/music/b.flac", "png"), jpeg(200)));
+
+    util::CoverCache cache(&config);
+    REQUIRE(cache.getCacheSizeBytes() == 500);
+    REQUIRE(cache.findCachedCover("/music/b.flac") == coverFile(config, "/music/b.flac", "png"));
+
+    // A cover deleted by hand is dropped at the next lookup
+    REQUIRE(QFile::remove(coverFile(config, "/music/a.flac", "jpg")));
+    REQUIRE_FALSE(cache.findCachedCover("/music/a.flac"));
+    REQUIRE(cache.getCacheSizeBytes() == 200);
+
+    REQUIRE(cache.clearCache() == 1);
+    REQUIRE(cache.getCacheSizeBytes() == 0);
+    REQUIRE_FALSE(cache.hasCachedCover("/music/b.flac"));
+}
+
+TEST_CASE("CoverCache still finds covers under their MD5 names", "[CoverCache]") {
+    testutils::ensureQCoreApplication();
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    ConfigManager config(nullptr);
+    config.initialize(tmp.path());
+    REQUIRE(QDir().mkpath(config.getCoverCacheDirectory()));
+    const QString legacy = legacyCoverFile(config, "https://i0.hdslb.com/old.jpg", "png");
+    REQUIRE(writeFile(legacy, jpeg(400)));
+
+    util::CoverCache cache(&config);
+    REQUIRE(cache.hasCachedCover("https://i0.hdslb.com/old.jpg"));
+    REQUIRE(cache.findCachedCover("https://i0.hdslb.com/old.jpg") == legacy);
+    // Playlists refer to covers by file name, so the old name is the one handed out
+    REQUIRE(cache.getCoverCachePath("https://i0.hdslb.com/old.jpg") == legacy);
+
+    // New covers get the new names
+    REQUIRE(cache.getCoverCachePath("https://i0.hdslb.com/new.jpg") == coverFile(config, "https://i0.hdslb.com/new.jpg", "jpg"));
+    REQUIRE(cache.saveCover("https://i0.hdslb.com/new.jpg", jpeg(100)) == coverFile(config, "https://i0.hdslb.com/new.jpg", "jpg"));
+
+    REQUIRE(cache.removeCachedCover("https://i0.hdslb.com/old.jpg"));
+    REQUIRE_FALSE(QFile::exists(legacy));
+}
+
+TEST_CASE("CoverCache evicts the least recently used covers over its budget", "[CoverCache]") {
+    testutils::ensureQCoreApplication();
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    ConfigManager config(nullptr);
+    config.initialize(tmp.path());
+    util::CoverCache cache(&config);
+    cache.setBudgetBytes(3000);
+
+    REQUIRE(cache.saveCover("a", jpeg(1000)));
+    REQUIRE(cache.saveCover("b", jpeg(1000)));
+    REQUIRE(cache.saveCover("c", jpeg(1000)));
+    REQUIRE(cache.findCachedCover("a"));         // "b" is now the oldest
+    REQUIRE(cache.saveCover("d", jpeg(1000)));
+
+    REQUIRE_FALSE(cache.hasCachedCover("b"));
+    REQUIRE_FALSE(QFile::exists(coverFile(config, "b", "jpg")));
+    REQUIRE(cache.hasCachedCover("a"));
+    REQUIRE(cache.hasCachedCover("c"));
+    REQUIRE(cache.hasCachedCover("d"));
+    REQUIRE(cache.getCacheSizeBytes() == 3000);
+
+    // Shrinking the budget evicts right away
+    cache.setBudgetBytes(1500);
+    REQUIRE(cache.getCacheSizeBytes() == 1000);
+    REQUIRE(cache.hasCachedCover("d"));
+}
@@ -0,0 +1,193 @@
+/**
+ * CoverFetcher Unit Tests
+ *
+ * Tests deduplication of in-flight URLs, batching, cache lookups before
+ * fetching, failure handling, shutdown and the CDN thumbnail URL rewrite.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/cover_fetcher.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using network::CoverFetcher;
+
+namespace {
+    // Fake CDN: serves "body:<url>" for every URL and records each batch. While closed
+    // it holds every batch back, so requests can pile up meanwhile
+    struct FakeCdn {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool open = true;
+        std::vector<std::vector<std::string>> batches;
+        std::set<std::string> failing;
+        std::map<std::string, std::string> stored;
+        std::set<std::string> cached;
+
+        CoverFetcher::BatchFetch fetch() {
+            return [this](const std::vector<std::string>& urls, const CoverFetcher::BodySink& sink) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    batches.push_back(urls);
+                    cv.wait(lock, [this]() { return open; });
+                }
+                for (size_t i = 0; i < urls.size(); ++i) {
+                    if (!failing.count(urls[i])) {
+                        sink(i, "body:" + urls[i]);
+                    }
+                }
+            };
+        }
+        CoverFetcher::Store store() {
+            return [this](const std::string& url, std::string&& body) -> CoverFetcher::Path {
+                std::lock_guard<std::mutex> lock(mutex);
+                stored[url] = body;
+                return "/covers/" + url;
+            };
+        }
+        CoverFetcher::Lookup lookup() {
+            return [this](const std::string& url) -> CoverFetcher::Path {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (cached.count(url)) return "/cached/" + url;
+                return std::nullopt;
+            };
+        }
+        void setOpen(bool value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            open = value;
+            cv.notify_all();
+        }
+        size_t batchCount() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return batches.size();
+        }
+        size_t fetchedCount(const std::string& url) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t count = 0;
+            for (const auto& batch : batches) {
+                for (const auto& u : batch) count += u == url;
+            }
+            return count;
+        }
+    };
+
+    bool waitFor(const std::function<bool()>& condition) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+TEST_CASE("CoverFetcher fetches each cover once", "[CoverFetcher]") {
+    FakeCdn cdn;
+
+    SECTION("repeated requests share one transfer") {
+        cdn.setOpen(false);
+        CoverFetcher fetcher(cdn.fetch(), cdn.store(), cdn.lookup(), { 8, 1 });
+        auto first = fetcher.request("a");
+        REQUIRE(waitFor([&]() { return cdn.batchCount() == 1; }));
+        // "a" is downloading, "b" queued behind it; repeats of both join them
+        auto second = fetcher.request("a");
+        auto third = fetcher.request("b");
+        auto fourth = fetcher.request("b");
+        REQUIRE(fetcher.pendingCount() == 2);
+        cdn.setOpen(true);
+
+        REQUIRE(first.get() == std::optional<std::string>("/covers/a"));
+        REQUIRE(second.get() == first.get());
+        REQUIRE(third.get() == std::optional<std::string>("/covers/b"));
+        REQUIRE(fourth.get() == third.get());
+        REQUIRE(cdn.fetchedCount("a") == 1);
+        REQUIRE(cdn.fetchedCount("b") == 1);
+        REQUIRE(cdn.stored["b"] == "body:b");
+        REQUIRE(fetcher.pendingCount() == 0);
+    }
+
+    SECTION("queued covers are fetched in batches") {
+        cdn.setOpen(false);
+        CoverFetcher fetcher(cdn.fetch(), cdn.store(), cdn.lookup(), { 3, 1 });
+        std::vector<std::shared_future<CoverFetcher::Path>> futures;
+        futures.push_back(fetcher.request("u0"));
+        REQUIRE(waitFor([&]() { return cdn.batchCount() == 1; }));
+        for (int i = 1; i <= 7; ++i) {
+            futures.push_back(fetcher.request("u" + std::to_string(i)));
+        }
+        cdn.setOpen(true);
+        for (auto& future : futures) {
+            REQUIRE(future.get().has_value());
+        }
+        // u0 alone, then the seven queued meanwhile three at a time
+        std::lock_guard<std::mutex> lock(cdn.mutex);
+        REQUIRE(cdn.batches.size() == 4);
+        REQUIRE(cdn.batches[1] == std::vector<std::string>{ "u1", "u2", "u3" });
+        REQUIRE(cdn.batches[3] == std::vector<std::string>{ "u7" });
+    }
+
+    SECTION("cached covers skip the network") {
+        cdn.cached.insert("hit");
+        CoverFetcher fetcher(cdn.fetch(), cdn.store(), cdn.lookup());
+        REQUIRE(fetcher.request("hit").get() == std::optional<std::string>("/cached/hit"));
+        REQUIRE(cdn.batchCount() == 0);
+    }
+
+    SECTION("failed covers resolve empty and can be retried") {
+        cdn.failing.insert("bad");
+        CoverFetcher fetcher(cdn.fetch(), cdn.store(), cdn.lookup());
+        auto bad = fetcher.request("bad");
+        auto good = fetcher.request("good");
+        REQUIRE_FALSE(bad.get().has_value());
+        REQUIRE(good.get().has_value());
+        cdn.failing.clear();
+        REQUIRE(fetcher.request("bad").get().has_value());
+        REQUIRE(cdn.fetchedCount("bad") == 2);
+    }
+}
+
+TEST_CASE("CoverFetcher shutdown", "[CoverFetcher]") {
+    FakeCdn cdn;
+    cdn.setOpen(false);
+    CoverFetcher fetcher(cdn.fetch(), cdn.store(), cdn.lookup(), { 1, 1 });
+    auto running = fetcher.request("running");
+    REQUIRE(waitFor([&]() { return cdn.batchCount() == 1; }));
+    auto queued = fetcher.request("queued");
+
+    std::thread opener([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cdn.setOpen(true);
+    });
+    fetcher.shutdown();
+    opener.join();
+
+    // The running batch finishes, the queued cover is dropped
+    REQUIRE(running.get().has_value());
+    REQUIRE_FALSE(queued.get().has_value());
+    REQUIRE_FALSE(fetcher.request("later").get().has_value());
+    REQUIRE(cdn.batchCount() == 1);
+}
+
+TEST_CASE("CoverFetcher thumbnail URLs", "[CoverFetcher]") {
+    REQUIRE(CoverFetcher::thumbnailUrl("https://i0.hdslb.com/bfs/archive/abc.jpg", 320, 200)
+            == "https://i0.hdslb.com/bfs/archive/abc.jpg@320w_200h_1c.jpg");
+    REQUIRE(CoverFetcher::thumbnailUrl("http://i2.hdslb.com/bfs/archive/abc.png", 64, 64)
+            == "http://i2.hdslb.com/bfs/archive/abc.png@64w_64h_1c.jpg");
+    // Already a variant, another host, or no size
+    REQUIRE(CoverFetcher::thumbnailUrl("https://i0.hdslb.com/bfs/a.jpg@100w_100h.webp", 320, 200)
+            == "https://i0.hdslb.com/bfs/a.jpg@100w_100h.webp");
+    REQUIRE(CoverFetcher::thumbnailUrl("https://example.com/bfs/a.jpg", 320, 200)
+            == "https://example.com/bfs/a.jpg");
+    REQUIRE(CoverFetcher::thumbnailUrl("https://fakehdslb.com/a.jpg", 320, 200)
+            == "https://fakehdslb.com/a.jpg");
+    REQUIRE(CoverFetcher::thumbnailUrl("https://i0.hdslb.com/bfs/a.jpg", 0, 200)
+            == "https://i0.hdslb.com/bfs/a.jpg");
+}
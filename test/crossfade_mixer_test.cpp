@@ -0,0 +1,191 @@
+/**
+ * CrossfadeMixer Unit Tests
+ *
+ * Drives the mixer the way an output's render thread does: frames are popped from a
+ * closed outgoing queue and passed through process() while an incoming queue is
+ * pending. Checks when the fade starts, the shape of the ramp, the carry-over handed
+ * to the switch, cancellation, and a full transition through NullAudioOutput.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/crossfade_mixer.h>
+#include <audio/null_audio_output.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace audio;
+using namespace std::chrono_literals;
+
+namespace {
+    constexpr int kRate = 48000;
+    constexpr int kChannels = 2;
+    constexpr int kFrameSamples = 480;  // 10 ms
+
+    std::shared_ptr<AudioFrame> makeFloatFrame(int64_t ptsSamples, float value) {
+        auto frame = std::make_shared<AudioFrame>(kFrameSamples * kChannels * sizeof(float));
+        frame->sample_rate = kRate;
+        frame->channels = kChannels;
+        frame->bits_per_sample = 32;
+        frame->pts = ptsSamples;
+        frame->pts_samples = ptsSamples;
+        auto* samples = reinterpret_cast<float*>(frame->data.data());
+        for (int i = 0; i < kFrameSamples * kChannels; ++i) samples[i] = value;
+        return frame;
+    }
+
+    std::shared_ptr<AudioFrame> makeS16Frame(int64_t ptsSamples, int16_t value) {
+        auto frame = std::make_shared<AudioFrame>(kFrameSamples * kChannels * sizeof(int16_t));
+        frame->sample_rate = kRate;
+        frame->channels = kChannels;
+        frame->bits_per_sample = 16;
+        frame->pts = ptsSamples;
+        frame->pts_samples = ptsSamples;
+        auto* samples = reinterpret_cast<int16_t*>(frame->data.data());
+        for (int i = 0; i < kFrameSamples * kChannels; ++i) samples[i] = value;
+        return frame;
+    }
+
+    std::shared_ptr<AudioFrameQueue> makeFloatQueue(int frames, float value, bool close) {
+        auto queue = std::make_shared<AudioFrameQueue>();
+        for (int i = 0; i < frames; ++i) {
+            REQUIRE(queue->tryPush(makeFloatFrame(static_cast<int64_t>(i) * kFrameSamples, value)));
+        }
+        if (close) queue->close();
+        return queue;
+    }
+
+    float firstSample(const AudioFrame& frame) {
+        float v;
+        std::memcpy(&v, frame.data.data(), sizeof(v));
+        return v;
+    }
+
+    float lastSample(const AudioFrame& frame) {
+        float v;
+        std::memcpy(&v, frame.data.data() + frame.data.size() - sizeof(v), sizeof(v));
+        return v;
+    }
+}
+
+TEST_CASE("CrossfadeMixer fades the incoming source in over the outgoing tail", "[CrossfadeMixer]") {
+    CrossfadeMixer mixer;
+    mixer.configure(kRate, kChannels, 32);
+    mixer.setDurationMs(100);  // the last 10 frames
+
+    auto outgoing = makeFloatQueue(50, 1.0f, true);
+    auto incoming = makeFloatQueue(50, 0.0f, false);
+
+    SECTION("Frames before the tail pass untouched, the tail ramps down") {
+        std::vector<std::shared_ptr<AudioFrame>> played;
+        std::shared_ptr<AudioFrame> frame;
+        while (outgoing->tryPop(frame)) {
+            mixer.process(*frame, *outgoing, incoming.get());
+            played.push_back(frame);
+        }
+        REQUIRE(played.size() == 50);
+        REQUIRE(firstSample(*played[39]) == 1.0f);
+        REQUIRE(lastSample(*played[39]) == 1.0f);
+        REQUIRE(mixer.active());
+        // The ramp starts at full outgoing level and falls monotonically
+        REQUIRE(firstSample(*played[40]) == 1.0f);
+        for (size_t i = 40; i < played.size(); ++i) {
+            REQUIRE(lastSample(*played[i]) < firstSample(*played[i]));
+            if (i > 40) {
+                REQUIRE(firstSample(*played[i]) < lastSample(*played[i - 1]) + 1e-6f);
+            }
+        }
+        REQUIRE(lastSample(*played.back()) < 0.001f);
+
+        // Exactly the overlapped part of the incoming source was used
+        size_t offset = 0;
+        auto carry = mixer.takeCarryOver(offset);
+        REQUIRE(carry == nullptr);
+        REQUIRE_FALSE(mixer.active());
+        REQUIRE(incoming->size() == 40);
+    }
+
+    SECTION("A cleared next source cancels the transition") {
+        std::shared_ptr<AudioFrame> frame;
+        for (int i = 0; i < 45; ++i) {
+            REQUIRE(outgoing->tryPop(frame));
+            mixer.process(*frame, *outgoing, incoming.get());
+        }
+        REQUIRE(mixer.active());
+        REQUIRE(outgoing->tryPop(frame));
+        REQUIRE_FALSE(mixer.process(*frame, *outgoing, nullptr));
+        REQUIRE_FALSE(mixer.active());
+        REQUIRE(firstSample(*frame) == 1.0f);
+    }
+
+    SECTION("An open outgoing source never starts a fade") {
+        auto open = makeFloatQueue(5, 1.0f, false);
+        std::shared_ptr<AudioFrame> frame;
+        while (open->tryPop(frame)) {
+            REQUIRE_FALSE(mixer.process(*frame, *open, incoming.get()));
+        }
+        REQUIRE(incoming->size() == 50);
+    }
+
+    SECTION("A disabled mixer leaves frames alone") {
+        mixer.setDurationMs(0);
+        std::shared_ptr<AudioFrame> frame;
+        while (outgoing->tryPop(frame)) {
+            REQUIRE_FALSE(mixer.process(*frame, *outgoing, incoming.get()));
+        }
+        REQUIRE(incoming->size() == 50);
+    }
+}
+
+TEST_CASE("CrossfadeMixer hands the partly mixed incoming frame over", "[CrossfadeMixer]") {
+    CrossfadeMixer mixer;
+    mixer.configure(kRate, kChannels, 32);
+    mixer.setDurationMs(100);
+
+    auto outgoing = makeFloatQueue(20, 1.0f, false);
+    // A short last frame leaves the ramp ending in the middle of an incoming frame
+    auto tail = makeFloatFrame(20 * kFrameSamples, 1.0f);
+    tail->data.resize(tail->data.size() / 2);
+    REQUIRE(outgoing->tryPush(tail));
+    outgoing->close();
+    auto incoming = makeFloatQueue(20, 0.0f, false);
+
+    std::shared_ptr<AudioFrame> frame;
+    while (outgoing->tryPop(frame)) {
+        mixer.process(*frame, *outgoing, incoming.get());
+    }
+    size_t offset = 0;
+    auto carry = mixer.takeCarryOver(offset);
+    REQUIRE(carry != nullptr);
+    REQUIRE(offset == carry->data.size() / 2);
+    REQUIRE(carry->pts_samples == 9 * kFrameSamples);
+}
+
+TEST_CASE("CrossfadeMixer mixes 16-bit PCM through NullAudioOutput", "[CrossfadeMixer][NullAudioOutput]") {
+    NullAudioOutput output;
+    REQUIRE(output.initialize(kRate, kChannels, 16, IAudioOutput::RenderMode::EventDriven));
+    output.setCrossfadeDuration(100);
+
+    auto outgoing = std::make_shared<AudioFrameQueue>();
+    auto incoming = std::make_shared<AudioFrameQueue>();
+    for (int i = 0; i < 50; ++i) {
+        REQUIRE(outgoing->tryPush(makeS16Frame(static_cast<int64_t>(i) * kFrameSamples, 10000)));
+        REQUIRE(incoming->tryPush(makeS16Frame(static_cast<int64_t>(i) * kFrameSamples, -10000)));
+    }
+    outgoing->close();
+    incoming->close();
+
+    int started = 0;
+    output.setFrameSource(outgoing, nullptr);
+    output.setNextFrameSource(incoming, nullptr, [&started]() { started++; });
+    REQUIRE(output.start());
+    REQUIRE(output.waitForDrain(2000ms));
+    output.stop();
+
+    REQUIRE(started == 1);
+    // 100 ms of the two tracks overlapped
+    REQUIRE(output.framesConsumed() == static_cast<uint64_t>(90 * kFrameSamples));
+    // The position follows the incoming track's own timestamps
+    REQUIRE(output.getCurrentPositionMs() == 500);
+}
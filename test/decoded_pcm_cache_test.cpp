@@ -0,0 +1,123 @@
+/**
+ * DecodedPcmCache Unit Tests
+ *
+ * Covers lookup and LRU promotion, eviction down to the memory budget, rejection of
+ * tracks larger than the budget, that evicted tracks stay valid for readers still
+ * holding them, and trimming on behalf of the shared MemoryBudget.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/decoded_pcm_cache.h>
+#include <memory>
+#include <string>
+
+using namespace audio;
+
+namespace {
+    // 16-bit stereo track of `frames` sample-frames, filled with `value`
+    std::shared_ptr<const DecodedTrack> makeTrack(size_t frames, uint8_t value = 0) {
+        auto track = std::make_shared<DecodedTrack>();
+        track->format = AudioFormat{48000, 2, 16};
+        track->pcm.assign(frames * 4, value);
+        return track;
+    }
+}
+
+TEST_CASE("DecodedTrack derives length from its format", "[DecodedPcmCache]") {
+    auto track = makeTrack(48000);
+    REQUIRE(track->bytesPerFrame() == 4);
+    REQUIRE(track->frames() == 48000);
+    REQUIRE(track->durationSeconds() == 1.0);
+
+    DecodedTrack empty;
+    REQUIRE(empty.frames() == 0);
+    REQUIRE(empty.durationSeconds() == 0.0);
+}
+
+TEST_CASE("DecodedPcmCache keeps recent tracks within budget", "[DecodedPcmCache]") {
+    // Room for exactly three 4000-byte tracks
+    DecodedPcmCache cache(12000);
+
+    SECTION("Find returns what was inserted") {
+        auto track = makeTrack(1000, 7);
+        REQUIRE(cache.insert("a", track));
+        REQUIRE(cache.find("a") == track);
+        REQUIRE(cache.find("b") == nullptr);
+        REQUIRE(cache.usedBytes() == 4000);
+        REQUIRE(cache.size() == 1);
+    }
+
+    SECTION("Least recently used tracks are evicted first") {
+        REQUIRE(cache.insert("a", makeTrack(1000)));
+        REQUIRE(cache.insert("b", makeTrack(1000)));
+        REQUIRE(cache.insert("c", makeTrack(1000)));
+        REQUIRE(cache.find("a"));                  // "b" is now the oldest
+        REQUIRE(cache.insert("d", makeTrack(1000)));
+        REQUIRE(cache.find("b") == nullptr);
+        REQUIRE(cache.find("a"));
+        REQUIRE(cache.find("c"));
+        REQUIRE(cache.find("d"));
+        REQUIRE(cache.usedBytes() == 12000);
+    }
+
+    SECTION("Replacing a key updates the accounting") {
+        REQUIRE(cache.insert("a", makeTrack(1000)));
+        REQUIRE(cache.insert("a", makeTrack(2000)));
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.usedBytes() == 8000);
+        REQUIRE(cache.find("a")->frames() == 2000);
+    }
+
+    SECTION("Tracks over budget are rejected") {
+        REQUIRE(cache.insert("a", makeTrack(1000)));
+        REQUIRE_FALSE(cache.insert("huge", makeTrack(4000)));
+        REQUIRE(cache.find("huge") == nullptr);
+        REQUIRE(cache.find("a"));
+        REQUIRE_FALSE(cache.insert("empty", makeTrack(0)));
+        REQUIRE_FALSE(cache.insert("null", nullptr));
+    }
+
+    SECTION("Shrinking the budget evicts, zero disables") {
+        REQUIRE(cache.insert("a", makeTrack(1000)));
+        REQUIRE(cache.insert("b", makeTrack(1000)));
+        cache.setBudgetBytes(5000);
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.find("b"));
+        cache.setBudgetBytes(0);
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.usedBytes() == 0);
+        REQUIRE_FALSE(cache.insert("a", makeTrack(1)));
+    }
+
+    SECTION("Evicted tracks stay valid for their readers") {
+        REQUIRE(cache.insert("a", makeTrack(1000, 42)));
+        auto reader = cache.find("a");
+        cache.erase("a");
+        REQUIRE(cache.find("a") == nullptr);
+        REQUIRE(cache.usedBytes() == 0);
+        REQUIRE(reader->pcm.size() == 4000);
+        REQUIRE(reader->pcm.back() == 42);
+        cache.insert("b", makeTrack(1000));
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+    }
+}
+
+TEST_CASE("DecodedPcmCache gives tracks back to the shared memory budget", "[DecodedPcmCache][MemoryBudget]") {
+    util::MemoryBudget budget(10000);
+    DecodedPcmCache cache(100000);
+    cache.attachBudget(budget);
+
+    REQUIRE(cache.insert("a", makeTrack(1000)));
+    REQUIRE(cache.insert("b", makeTrack(1000)));
+    REQUIRE(budget.used() == 8000);
+    // Within its own budget but not the shared one: the oldest track goes
+    REQUIRE(cache.insert("c", makeTrack(1000)));
+    REQUIRE(cache.find("a") == nullptr);
+    REQUIRE(cache.find("b"));
+    REQUIRE(cache.find("c"));
+    REQUIRE(budget.used() == 8000);
+
+    REQUIRE(cache.trim(1) == 4000);
+    REQUIRE(cache.size() == 1);
+}
@@ -4,6 +4,9 @@
 #include <fmt/format.h>
 #include <memory>
 #include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #ifdef CXX11
 using namespace std::placeholders;
@@ -177,4 +180,282 @@ TEST_CASE("EventHandler Test", "[EventHandler]")
         event.data = 0;
         REQUIRE(eventBus->Post(event));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("EventBus finds a type's dispatcher in its slot, whatever other buses hold", "[EventHandler]")
+{
+    shared_ptr<EventBus> bus = EventBus::Create();
+    shared_ptr<BenchmarkSubscriber> subscriber = make_shared<BenchmarkSubscriber>();
+    subscriber->id = 4;
+    bus->Subscribe<IntEvent>(subscriber, bind(&BenchmarkSubscriber::OnDemoEvent, subscriber.get(), _1));
+
+    // Other buses with dispatchers of the same type, created after this one
+    std::vector<shared_ptr<EventBus> > others;
+    std::vector<shared_ptr<BenchmarkSubscriber> > otherSubscribers;
+    for (int i = 0; i < 1000; ++i)
+    {
+        shared_ptr<EventBus> other = EventBus::Create();
+        shared_ptr<BenchmarkSubscriber> otherSubscriber = make_shared<BenchmarkSubscriber>();
+        otherSubscriber->id = 5;
+        other->Subscribe<IntEvent>(otherSubscriber, bind(&BenchmarkSubscriber::OnDemoEvent, otherSubscriber.get(), _1));
+        others.push_back(other);
+        otherSubscribers.push_back(otherSubscriber);
+    }
+    // One id per type for every bus, within the slots rather than the overflow list
+    const size_t slots = EventBus::MAX_SLOTTED_TYPES;
+    REQUIRE(EventBus::TypeId<IntEvent>() < slots);
+
+    IntEvent event;
+    event.data = 6;
+    REQUIRE(bus->Post(event));
+    REQUIRE(subscriber->iCheck == 12);
+    for (const auto& other : otherSubscribers)
+    {
+        REQUIRE(other->iCheck == 0);
+    }
+}
+
+TEST_CASE("EventBus posts from many threads", "[EventHandler][benchmark]")
+{
+    const int threadCount = 4;
+    const int posts = 200000;
+    std::vector<shared_ptr<EventBus> > buses;
+    std::vector<shared_ptr<PrintSubscriber> > subscribers;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        buses.push_back(EventBus::Create());
+        subscribers.push_back(make_shared<PrintSubscriber>());
+        buses.back()->Subscribe<IntEvent>(subscribers.back(), bind(&PrintSubscriber::OnDemoEvent, subscribers.back().get(), _1));
+    }
+
+    // Each thread posts to its own bus; nothing process-wide is shared between them
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back([&buses, i, posts]() {
+            IntEvent event;
+            for (int n = 1; n <= posts; ++n)
+            {
+                event.data = n;
+                buses[i]->Post(event);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << threadCount * posts << " posts from " << threadCount << " threads in " << elapsed << " s" << std::endl;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        REQUIRE(subscribers[i]->check == posts);
+    }
+
+    SECTION("a type's dispatcher is shared by threads racing to create it")
+    {
+        shared_ptr<EventBus> bus = EventBus::Create();
+        shared_ptr<PrintSubscriber> subscriber = make_shared<PrintSubscriber>();
+        std::vector<std::thread> racers;
+        for (int i = 0; i < threadCount; ++i)
+        {
+            racers.emplace_back([bus, subscriber]() {
+                bus->Subscribe<IntEvent>(subscriber, bind(&PrintSubscriber::OnDemoEvent, subscriber.get(), _1));
+            });
+        }
+        for (std::thread& racer : racers)
+        {
+            racer.join();
+        }
+        IntEvent event;
+        event.data = 42;
+        REQUIRE(bus->Post(event));
+        REQUIRE(subscriber->check == 42);
+        REQUIRE(bus->Unsubscribe<IntEvent>(subscriber));
+    }
+}
+
+class OrderSubscriber : public enable_shared_from_this<OrderSubscriber>
+{
+public:
+    std::mutex mtx;
+    std::vector<int> seen;
+    bool OnEvent(const IntEvent& event)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        seen.push_back(event.data);
+        return true;
+    }
+    size_t Count()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return seen.size();
+    }
+};
+
+namespace {
+    bool waitFor(const std::function<bool()>& done)
+    {
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!done())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+TEST_CASE("EventBus PostAsync", "[EventHandler]")
+{
+    shared_ptr<EventBus> bus = EventBus::Create();
+    shared_ptr<OrderSubscriber> subscriber = make_shared<OrderSubscriber>();
+    bus->Subscribe<IntEvent>(subscriber, bind(&OrderSubscriber::OnEvent, subscriber.get(), _1));
+
+    SECTION("events of a type arrive in order")
+    {
+        const int posts = 5000;
+        int accepted = 0;
+        for (int i = 0; i < posts; ++i)
+        {
+            IntEvent event;
+            event.data = i;
+            while (!bus->PostAsync(event))
+            {
+                std::this_thread::yield();     // Full; let the workers catch up
+            }
+            ++accepted;
+        }
+        REQUIRE(accepted == posts);
+        REQUIRE(waitFor([&]() { return subscriber->Count() == static_cast<size_t>(posts); }));
+        for (int i = 0; i < posts; ++i)
+        {
+            REQUIRE(subscriber->seen[i] == i);
+        }
+    }
+
+    SECTION("a slow handler doesn't hold up the poster, and the queue is bounded")
+    {
+        std::mutex gate;
+        std::unique_lock<std::mutex> closed(gate);
+        shared_ptr<int> slow = make_shared<int>(0);
+        bus->Subscribe<IntEvent>(slow, [&gate](const IntEvent&) {
+            std::lock_guard<std::mutex> wait(gate);
+            return true;
+        });
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        size_t accepted = 0;
+        IntEvent event;
+        event.data = 1;
+        while (bus->PostAsync(event))
+        {
+            ++accepted;
+        }
+        REQUIRE(std::chrono::steady_clock::now() - begin < std::chrono::seconds(5));
+        // One batch is out with the stuck worker, the rest wait
+        REQUIRE(accepted <= EventBus::MAX_PENDING_EVENTS + EventBus::ASYNC_DRAIN_BATCH);
+        REQUIRE(accepted >= EventBus::MAX_PENDING_EVENTS);
+        closed.unlock();
+        REQUIRE(waitFor([&]() { return subscriber->Count() == accepted; }));
+    }
+
+    SECTION("a handler with an executor runs there")
+    {
+        std::mutex tasksMtx;
+        std::vector<function<void()> > tasks;
+        shared_ptr<OrderSubscriber> deferred = make_shared<OrderSubscriber>();
+        bus->Subscribe<IntEvent>(deferred, bind(&OrderSubscriber::OnEvent, deferred.get(), _1),
+            [&](function<void()> task) {
+                std::lock_guard<std::mutex> lock(tasksMtx);
+                tasks.push_back(task);
+            });
+        IntEvent event;
+        event.data = 7;
+        REQUIRE(bus->PostAsync(event));
+        REQUIRE(waitFor([&]() { return subscriber->Count() == 1; }));
+        REQUIRE(waitFor([&]() { std::lock_guard<std::mutex> lock(tasksMtx); return tasks.size() == 1; }));
+        REQUIRE(deferred->Count() == 0);
+        tasks.front()();
+        REQUIRE(deferred->seen == std::vector<int>{ 7 });
+        // Post runs every handler inline whatever its executor
+        event.data = 8;
+        REQUIRE(bus->Post(event));
+        REQUIRE(deferred->Count() == 2);
+    }
+}
+
+TEST_CASE("EventBus handlers run without the dispatcher locked", "[EventHandler]")
+{
+    shared_ptr<EventBus> bus = EventBus::Create();
+
+    SECTION("a handler may subscribe and unsubscribe while being posted to")
+    {
+        shared_ptr<OrderSubscriber> late = make_shared<OrderSubscriber>();
+        shared_ptr<int> once = make_shared<int>(0);
+        bus->Subscribe<IntEvent>(once, [&](const IntEvent&) {
+            REQUIRE(bus->Unsubscribe<IntEvent>(once));
+            bus->Subscribe<IntEvent>(late, bind(&OrderSubscriber::OnEvent, late.get(), _1));
+            ++*once;
+            return true;
+        });
+        IntEvent event;
+        event.data = 1;
+        REQUIRE(bus->Post(event));
+        // The post that changed the list still ran on the list it started with
+        REQUIRE(*once == 1);
+        REQUIRE(late->Count() == 0);
+        event.data = 2;
+        REQUIRE(bus->Post(event));
+        REQUIRE(*once == 1);
+        REQUIRE(late->seen == std::vector<int>{ 2 });
+    }
+
+    SECTION("expired subscribers are skipped until cleaned")
+    {
+        shared_ptr<PrintSubscriber> kept = make_shared<PrintSubscriber>();
+        bus->Subscribe<IntEvent>(kept, bind(&PrintSubscriber::OnDemoEvent, kept.get(), _1));
+        for (int i = 0; i < 3; ++i)
+        {
+            shared_ptr<PrintSubscriber> gone = make_shared<PrintSubscriber>();
+            bus->Subscribe<IntEvent>(gone, bind(&PrintSubscriber::OnDemoEvent, gone.get(), _1));
+        }
+        IntEvent event;
+        event.data = 5;
+        REQUIRE(bus->Post(event));
+        REQUIRE(kept->check == 5);
+        REQUIRE(bus->CleanExpiredSubscriber() == 3);
+        REQUIRE(bus->CleanExpiredSubscriber() == 0);
+        REQUIRE(bus->Unsubscribe<IntEvent>(kept));
+    }
+
+    SECTION("posts run while others subscribe and unsubscribe")
+    {
+        shared_ptr<OrderSubscriber> steady = make_shared<OrderSubscriber>();
+        bus->Subscribe<IntEvent>(steady, bind(&OrderSubscriber::OnEvent, steady.get(), _1));
+        const int rounds = 2000;
+        std::thread churn([bus]() {
+            for (int i = 0; i < rounds; ++i)
+            {
+                shared_ptr<PrintSubscriber> passing = make_shared<PrintSubscriber>();
+                bus->Subscribe<IntEvent>(passing, bind(&PrintSubscriber::OnDemoEvent, passing.get(), _1));
+                if (i % 2 == 0)
+                {
+                    bus->Unsubscribe<IntEvent>(passing);
+                }
+            }
+        });
+        IntEvent event;
+        for (int i = 0; i < rounds; ++i)
+        {
+            event.data = i;
+            REQUIRE(bus->Post(event));
+        }
+        churn.join();
+        REQUIRE(steady->Count() == static_cast<size_t>(rounds));
+        REQUIRE(bus->CleanExpiredSubscriber() == static_cast<size_t>(rounds / 2));
+    }
+}
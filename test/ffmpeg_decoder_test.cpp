@@ -405,7 +405,7 @@ TEST_CASE("FFmpegDecoder format conversion and output format", "[FFmpegDecoder][
     std::shared_ptr<AudioFrame> frame;
     for (int i = 0; i < 20; ++i) {
         if (frameQueue->size() > 0) {
-            frameQueue->dequeue(frame);
+            frameQueue->tryPop(frame);
             gotFrame = true;
             break;
         }
@@ -704,7 +704,7 @@ TEST_CASE("FFmpegDecoder FLAC conversion to S16", "[ffmpeg][format][conversion][
     bool got = false;
     for (int i = 0; i < 30; ++i) {
         if (frameQueue->size() > 0) {
-            frameQueue->dequeue(frame);
+            frameQueue->tryPop(frame);
             got = true;
             break;
         }
@@ -760,7 +760,7 @@ TEST_CASE("FFmpegDecoder Opus conversion to S16", "[ffmpeg][format][conversion][
     bool got = false;
     for (int i = 0; i < 30; ++i) {
         if (frameQueue->size() > 0) {
-            frameQueue->dequeue(frame);
+            frameQueue->tryPop(frame);
             got = true;
             break;
         }
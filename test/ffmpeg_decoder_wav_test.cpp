@@ -1,10 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <audio/ffmpeg_decoder.h>
 #include <audio/audio_frame.h>
+#include <audio/null_audio_output.h>
+#include <util/audio_generator.h>
 #include <filesystem>
 #include <fstream>
 #include <chrono>
 #include <future>
+#include <iostream>
 #include <thread>
 
 using namespace audio;
@@ -103,7 +106,7 @@ TEST_CASE("FFmpegDecoder deterministic WAV decode", "[ffmpeg][wav][integration]"
     // Wait for at least one decoded frame with timeout using async
     std::shared_ptr<AudioFrame> frameOut;
     auto popTask = std::async(std::launch::async, [&frameQueue, &frameOut]() {
-        frameQueue->waitAndDequeue(frameOut);
+        frameQueue->waitPop(frameOut);
         return true;
     });
     std::cout<<"Waiting for decoded frame..."<<std::endl;
@@ -126,3 +129,183 @@ TEST_CASE("FFmpegDecoder deterministic WAV decode", "[ffmpeg][wav][integration]"
     file->close();
     std::filesystem::remove(wavPath);
 }
+
+TEST_CASE("FFmpegDecoder converts to a requested output format", "[ffmpeg][wav][integration]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "BilibiliPlayerTestData";
+    std::string wavPath = write_test_wav(temp_dir);
+    REQUIRE(!wavPath.empty());
+
+    auto file = std::make_shared<std::ifstream>(wavPath, std::ios::binary);
+    REQUIRE(file->is_open());
+    file->seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(file->tellg());
+    file->seekg(0, std::ios::beg);
+
+    // Source is 48 kHz stereo s16; ask for a typical float mix format with a different rate
+    const AudioFormat requested{44100, 1, 32};
+    FFmpegStreamDecoder decoder;
+    auto frameQueue = std::make_shared<AudioFrameQueue>();
+    REQUIRE(decoder.initialize(file, frameQueue) == true);
+    decoder.setOutputFormat(requested);
+    REQUIRE(decoder.startDecoding(fileSize) == true);
+
+    AudioFormat fmt = decoder.getAudioFormatAsync().get();
+    REQUIRE(fmt.sample_rate == requested.sample_rate);
+    REQUIRE(fmt.channels == requested.channels);
+    REQUIRE(fmt.bits_per_sample == requested.bits_per_sample);
+
+    std::shared_ptr<AudioFrame> frameOut;
+    auto popTask = std::async(std::launch::async, [&frameQueue, &frameOut]() {
+        return frameQueue->waitPop(frameOut);
+    });
+    using namespace std::chrono_literals;
+    REQUIRE(popTask.wait_for(2000ms) != std::future_status::timeout);
+    REQUIRE(frameOut != nullptr);
+    REQUIRE(frameOut->sample_rate == 44100);
+    REQUIRE(frameOut->channels == 1);
+    REQUIRE(frameOut->bits_per_sample == 32);
+    REQUIRE(frameOut->data.size() % sizeof(float) == 0);
+
+    decoder.pauseDecoding();
+    std::this_thread::sleep_for(50ms);
+    file->close();
+    std::filesystem::remove(wavPath);
+}
+
+TEST_CASE("FFmpegDecoder stamps frames with sample positions", "[ffmpeg][wav][integration]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "BilibiliPlayerTestData";
+    std::string wavPath = write_test_wav(temp_dir);
+    REQUIRE(!wavPath.empty());
+    uint64_t fileSize = std::filesystem::file_size(wavPath);
+
+    FFmpegStreamDecoder decoder;
+    auto frameQueue = std::make_shared<AudioFrameQueue>();
+    REQUIRE(decoder.initializeFromFile(wavPath, frameQueue) == true);
+    REQUIRE(decoder.startDecoding(fileSize) == true);
+
+    // PCM frames must continue each other exactly: pts_samples of the next frame is the
+    // previous one plus its sample count
+    auto collectTask = std::async(std::launch::async, [&frameQueue]() {
+        std::vector<std::pair<int64_t, int64_t>> stamps;  // pts_samples, samples in frame
+        std::shared_ptr<AudioFrame> frame;
+        while (frameQueue->waitPop(frame)) {
+            int64_t samples = static_cast<int64_t>(frame->data.size())
+                / (frame->channels * (frame->bits_per_sample / 8));
+            stamps.emplace_back(frame->pts_samples, samples);
+        }
+        return stamps;
+    });
+    using namespace std::chrono_literals;
+    REQUIRE(collectTask.wait_for(5000ms) != std::future_status::timeout);
+    auto stamps = collectTask.get();
+    REQUIRE(!stamps.empty());
+    REQUIRE(stamps.front().first == 0);
+    for (size_t i = 1; i < stamps.size(); ++i) {
+        REQUIRE(stamps[i].first == stamps[i - 1].first + stamps[i - 1].second);
+    }
+
+    std::filesystem::remove(wavPath);
+}
+
+TEST_CASE("FFmpegDecoder records and replays decoded PCM", "[ffmpeg][wav][integration]") {
+    auto temp_dir = std::filesystem::temp_directory_path() / "BilibiliPlayerTestData";
+    std::string wavPath = write_test_wav(temp_dir);
+    REQUIRE(!wavPath.empty());
+    uint64_t fileSize = std::filesystem::file_size(wavPath);
+    using namespace std::chrono_literals;
+
+    auto drain = [](const std::shared_ptr<AudioFrameQueue>& queue) {
+        std::vector<uint8_t> pcm;
+        std::shared_ptr<AudioFrame> frame;
+        while (queue->waitPop(frame)) {
+            pcm.insert(pcm.end(), frame->data.begin(), frame->data.end());
+        }
+        return pcm;
+    };
+
+    // First pass decodes the file and hands the whole track over at EOF
+    std::promise<std::shared_ptr<const DecodedTrack>> recorded;
+    std::vector<uint8_t> decodedPcm;
+    {
+        FFmpegStreamDecoder decoder;
+        auto frameQueue = std::make_shared<AudioFrameQueue>();
+        REQUIRE(decoder.initializeFromFile(wavPath, frameQueue) == true);
+        decoder.recordDecodedPcm(64 * 1024 * 1024, [&recorded](std::shared_ptr<const DecodedTrack> track) {
+            recorded.set_value(std::move(track));
+        });
+        REQUIRE(decoder.startDecoding(fileSize) == true);
+        auto task = std::async(std::launch::async, drain, frameQueue);
+        REQUIRE(task.wait_for(5000ms) != std::future_status::timeout);
+        decodedPcm = task.get();
+    }
+    auto trackFuture = recorded.get_future();
+    REQUIRE(trackFuture.wait_for(0ms) == std::future_status::ready);
+    auto track = trackFuture.get();
+    REQUIRE(track);
+    REQUIRE(track->pcm == decodedPcm);
+
+    SECTION("Replay delivers the recorded samples with positions") {
+        FFmpegStreamDecoder replay;
+        auto frameQueue = std::make_shared<AudioFrameQueue>();
+        REQUIRE(replay.initializeFromPcm(track, frameQueue) == true);
+        AudioFormat fmt = replay.getAudioFormatAsync(0ms).get();
+        REQUIRE(fmt == track->format);
+        REQUIRE(replay.getDurationAsync().get() == track->durationSeconds());
+        REQUIRE(replay.startDecoding(track->pcm.size()) == true);
+        auto task = std::async(std::launch::async, drain, frameQueue);
+        REQUIRE(task.wait_for(5000ms) != std::future_status::timeout);
+        REQUIRE(task.get() == track->pcm);
+        REQUIRE(replay.isCompleted());
+    }
+
+    SECTION("Replay seeks by offset and flags the discontinuity") {
+        FFmpegStreamDecoder replay;
+        auto frameQueue = std::make_shared<AudioFrameQueue>();
+        REQUIRE(replay.initializeFromPcm(track, frameQueue) == true);
+        REQUIRE(replay.seek(0.1));
+        REQUIRE(replay.startDecoding(track->pcm.size()) == true);
+        std::shared_ptr<AudioFrame> first;
+        REQUIRE(frameQueue->waitPop(first));
+        REQUIRE(first->discontinuity);
+        REQUIRE(first->pts_samples == track->format.sample_rate / 10);
+    }
+
+    std::filesystem::remove(wavPath);
+}
+
+TEST_CASE("FFmpegDecoder pipeline throughput into a null sink", "[ffmpeg][wav][benchmark]") {
+    // Long enough that thread start-up doesn't dominate the measurement
+    const double durationSeconds = 60.0;
+    auto temp_dir = std::filesystem::temp_directory_path() / "BilibiliPlayerTestData";
+    std::filesystem::create_directories(temp_dir);
+    std::string wavPath = (temp_dir / "throughput_tone.wav").string();
+    REQUIRE(test_audio::write_sine_wav(QString::fromStdString(wavPath), 440.0, durationSeconds, 48000, 2, 16));
+    uint64_t fileSize = std::filesystem::file_size(wavPath);
+
+    const AudioFormat outputFormat{48000, 2, 32};
+    FFmpegStreamDecoder decoder;
+    auto frameQueue = std::make_shared<AudioFrameQueue>();
+    REQUIRE(decoder.initializeFromFile(wavPath, frameQueue) == true);
+    decoder.setOutputFormat(outputFormat);
+
+    NullAudioOutput output;
+    REQUIRE(output.initialize(outputFormat.sample_rate, outputFormat.channels, outputFormat.bits_per_sample,
+                              IAudioOutput::RenderMode::EventDriven));
+    output.setFrameSource(frameQueue, nullptr);
+
+    auto begin = std::chrono::steady_clock::now();
+    REQUIRE(decoder.startDecoding(fileSize) == true);
+    REQUIRE(output.start());
+    using namespace std::chrono_literals;
+    REQUIRE(output.waitForDrain(30000ms));
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    output.stop();
+
+    double realtimeFactor = output.secondsConsumed() / elapsed;
+    std::cout << "Decoded " << output.secondsConsumed() << " s of audio in " << elapsed
+              << " s: " << realtimeFactor << "x realtime" << std::endl;
+    // Only reported: wall-clock speed depends on the build and the machine's load
+    REQUIRE(output.secondsConsumed() >= durationSeconds - 0.1);
+
+    std::filesystem::remove(wavPath);
+}
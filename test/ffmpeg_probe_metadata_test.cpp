@@ -3,6 +3,11 @@
 #include <QString>
 #include <QStandardPaths>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <fstream>
+#include <vector>
 
 /**
  * @brief Tests for FFmpegProbe::probeMetadata() functionality
@@ -163,3 +168,74 @@ TEST_CASE("AudioMetadata use cases", "[audio][ffmpeg_probe][struct]") {
         REQUIRE(display.contains("240"));
     }
 }
+
+namespace {
+    // A silent 16-bit PCM WAV file
+    void writeWav(const QString& path, uint32_t sampleRate, uint16_t channels, uint32_t dataBytes)
+    {
+        const uint16_t format = 1;
+        const uint16_t bitsPerSample = 16;
+        const uint16_t blockAlign = channels * bitsPerSample / 8;
+        const uint32_t byteRate = sampleRate * blockAlign;
+        const uint32_t chunkSize = 36 + dataBytes;
+        const uint32_t fmtSize = 16;
+        std::ofstream ofs(path.toStdString(), std::ios::binary);
+        ofs.write("RIFF", 4);
+        ofs.write(reinterpret_cast<const char*>(&chunkSize), 4);
+        ofs.write("WAVEfmt ", 8);
+        ofs.write(reinterpret_cast<const char*>(&fmtSize), 4);
+        ofs.write(reinterpret_cast<const char*>(&format), 2);
+        ofs.write(reinterpret_cast<const char*>(&channels), 2);
+        ofs.write(reinterpret_cast<const char*>(&sampleRate), 4);
+        ofs.write(reinterpret_cast<const char*>(&byteRate), 4);
+        ofs.write(reinterpret_cast<const char*>(&blockAlign), 2);
+        ofs.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
+        ofs.write("data", 4);
+        ofs.write(reinterpret_cast<const char*>(&dataBytes), 4);
+        const std::vector<char> silence(dataBytes, 0);
+        ofs.write(silence.data(), static_cast<std::streamsize>(silence.size()));
+    }
+
+    void setModified(const QString& path, const QDateTime& time)
+    {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        REQUIRE(file.setFileTime(time, QFileDevice::FileModificationTime));
+    }
+}
+
+TEST_CASE("FFmpegProbe caches results until the file changes", "[audio][ffmpeg_probe][cache]") {
+    using namespace audio;
+    const QString path = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+        .filePath(QString("BilibiliPlayerTest_probe_%1.wav").arg(QDateTime::currentMSecsSinceEpoch()));
+    FFmpegProbe::clearCache();
+
+    writeWav(path, 8000, 1, 16000);
+    const QDateTime modified = QDateTime::currentDateTime().addSecs(-60);
+    setModified(path, modified);
+    AudioMetadata metadata = FFmpegProbe::probeMetadata(path);
+    REQUIRE(metadata.sampleRate == 8000);
+    REQUIRE(metadata.channels == 1);
+    REQUIRE(metadata.durationMs == 1000);
+    REQUIRE(FFmpegProbe::probeSampleRate(path) == 8000);
+    REQUIRE(FFmpegProbe::probeChannelCount(path) == 1);
+    REQUIRE(FFmpegProbe::probeDuration(path) == 1000);
+
+    // Rewritten to the same size and mtime, the file isn't opened again
+    writeWav(path, 16000, 1, 16000);
+    setModified(path, modified);
+    REQUIRE(FFmpegProbe::probeSampleRate(path) == 8000);
+
+    SECTION("a new mtime is a new probe") {
+        setModified(path, modified.addSecs(10));
+        REQUIRE(FFmpegProbe::probeSampleRate(path) == 16000);
+        REQUIRE(FFmpegProbe::probeDuration(path) == 500);
+    }
+
+    SECTION("so is a cleared cache") {
+        FFmpegProbe::clearCache();
+        REQUIRE(FFmpegProbe::probeSampleRate(path) == 16000);
+    }
+
+    QFile::remove(path);
+}
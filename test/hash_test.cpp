@@ -0,0 +1,67 @@
+/**
+ * Hash Unit Tests
+ *
+ * Checks the XXH3 digests against reference values, that ContentHasher gives the
+ * one-shot digest however the input is split, and hashing a file.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/hash.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST_CASE("hash64 and hash128 match the XXH3 reference values", "[Hash]") {
+    REQUIRE(util::hash64("") == 0x2D06800538D394C2ull);
+    REQUIRE(util::hash64("abc") == 0x78AF5F94892F3950ull);
+    REQUIRE(util::hash64("abc", 1) != util::hash64("abc"));
+
+    const util::Hash128 empty = util::hash128("");
+    REQUIRE(empty.high == 0x99AA06D3014798D8ull);
+    REQUIRE(empty.low == 0x6001C324468D497Full);
+    REQUIRE(empty.hex() == "99aa06d3014798d86001c324468d497f");
+    REQUIRE(util::hashHex("abc") == "06b05ab6733a618578af5f94892f3950");
+    REQUIRE(util::hash128("abc") != empty);
+}
+
+TEST_CASE("ContentHasher matches hash128 however the data is split", "[Hash]") {
+    std::string data;
+    for (int i = 0; i < 10000; ++i) {
+        data.push_back(static_cast<char>(i * 31 + i / 7));
+    }
+    const util::Hash128 expected = util::hash128(data);
+
+    for (size_t chunk : { size_t(1), size_t(63), size_t(64), size_t(1000), data.size() }) {
+        util::ContentHasher hasher;
+        for (size_t offset = 0; offset < data.size(); offset += chunk) {
+            hasher.update(std::string_view(data).substr(offset, chunk));
+        }
+        REQUIRE(hasher.digest() == expected);
+        REQUIRE(hasher.bytes() == data.size());
+    }
+
+    util::ContentHasher hasher;
+    REQUIRE(hasher.digest() == util::hash128(""));
+    hasher.update("ab");
+    REQUIRE(hasher.digest() == util::hash128("ab"));
+    hasher.update("c");     // Continues after a digest
+    REQUIRE(hasher.digest() == util::hash128("abc"));
+    hasher.reset();
+    REQUIRE(hasher.bytes() == 0);
+    REQUIRE(hasher.digest() == util::hash128(""));
+}
+
+TEST_CASE("hashFile hashes a file's contents", "[Hash]") {
+    const auto path = std::filesystem::temp_directory_path() / "BilibiliPlayerTest_hash_file.bin";
+    std::string content(600 * 1024, '\0');
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>(i % 251);
+    }
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    REQUIRE(util::hashFile(path) == util::hash128(content));
+    std::filesystem::remove(path);
+    REQUIRE_FALSE(util::hashFile(path));
+}
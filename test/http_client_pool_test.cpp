@@ -0,0 +1,210 @@
+/**
+ * HttpClientPool Unit Tests
+ *
+ * Tests client reuse per host, the idle cap, the in-flight limit, warm-up
+ * and shutdown. No request is sent; constructing a client does not connect.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/http_client_pool.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using network::HttpClientPool;
+
+TEST_CASE("HttpClientPool lends and reuses clients", "[HttpClientPool]") {
+    HttpClientPool::Options options;
+    options.maxIdlePerHost = 2;
+    options.maxInFlightPerHost = 4;
+    HttpClientPool pool(options);
+    const std::string host = "https://api.example.com";
+
+    SECTION("a returned client is lent again") {
+        httplib::Client* first = nullptr;
+        {
+            auto lease = pool.acquire(host);
+            REQUIRE(lease);
+            first = &*lease;
+            REQUIRE(pool.idleCount(host) == 0);
+            REQUIRE(pool.clientCount(host) == 1);
+        }
+        REQUIRE(pool.idleCount(host) == 1);
+        auto again = pool.acquire(host);
+        REQUIRE(&*again == first);
+        REQUIRE(pool.clientCount(host) == 1);
+    }
+
+    SECTION("hosts have separate buckets") {
+        auto a = pool.acquire(host);
+        auto b = pool.acquire("https://cdn.example.com");
+        REQUIRE(pool.clientCount(host) == 1);
+        REQUIRE(pool.clientCount("https://cdn.example.com") == 1);
+        REQUIRE(pool.clientCount("https://unknown.example.com") == 0);
+    }
+
+    SECTION("clients beyond the idle cap are closed on return") {
+        {
+            std::vector<HttpClientPool::Lease> leases;
+            for (int i = 0; i < 4; ++i) leases.push_back(pool.acquire(host));
+            REQUIRE(pool.clientCount(host) == 4);
+        }
+        REQUIRE(pool.idleCount(host) == 2);
+        REQUIRE(pool.clientCount(host) == 2);
+    }
+
+    SECTION("release returns the client early") {
+        auto lease = pool.acquire(host);
+        lease.release();
+        REQUIRE_FALSE(lease);
+        REQUIRE(pool.idleCount(host) == 1);
+    }
+
+    SECTION("moved leases return once") {
+        auto lease = pool.acquire(host);
+        HttpClientPool::Lease moved = std::move(lease);
+        REQUIRE(moved);
+        moved = HttpClientPool::Lease();
+        REQUIRE(pool.idleCount(host) == 1);
+        REQUIRE(pool.clientCount(host) == 1);
+    }
+}
+
+TEST_CASE("HttpClientPool enforces the in-flight limit", "[HttpClientPool]") {
+    HttpClientPool::Options options;
+    options.maxIdlePerHost = 1;
+    options.maxInFlightPerHost = 2;
+    HttpClientPool pool(options);
+    const std::string host = "https://api.example.com";
+
+    SECTION("acquire waits until a client comes back") {
+        auto a = pool.acquire(host);
+        auto b = pool.acquire(host);
+        std::atomic<bool> acquired{false};
+        std::thread waiter([&]() {
+            auto c = pool.acquire(host);
+            acquired.store(static_cast<bool>(c));
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE_FALSE(acquired.load());
+        a.release();
+        waiter.join();
+        REQUIRE(acquired.load());
+    }
+
+    SECTION("other hosts are not held back") {
+        auto a = pool.acquire(host);
+        auto b = pool.acquire(host);
+        auto other = pool.acquire("https://cdn.example.com");
+        REQUIRE(other);
+    }
+
+    SECTION("concurrent borrowers never exceed the limit") {
+        std::atomic<int> inFlight{0};
+        std::atomic<int> peak{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 20; ++i) {
+                    auto lease = pool.acquire(host);
+                    int now = ++inFlight;
+                    int seen = peak.load();
+                    while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    --inFlight;
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        REQUIRE(peak.load() <= 2);
+        REQUIRE(pool.clientCount(host) <= 1);
+    }
+}
+
+TEST_CASE("HttpClientPool warmUp", "[HttpClientPool]") {
+    HttpClientPool::Options options;
+    options.maxIdlePerHost = 3;
+    options.maxInFlightPerHost = 4;
+    HttpClientPool pool(options);
+    const std::string host = "https://api.example.com";
+
+    std::mutex seenMutex;
+    std::set<httplib::Client*> seen;
+    auto record = [&](httplib::Client& client) {
+        std::lock_guard<std::mutex> lock(seenMutex);
+        seen.insert(&client);
+    };
+
+    SECTION("probes distinct clients and leaves them idle") {
+        size_t connected = pool.warmUp(host, 2, [&](httplib::Client& client) {
+            record(client);
+            return true;
+        });
+        REQUIRE(connected == 2);
+        REQUIRE(seen.size() == 2);
+        REQUIRE(pool.idleCount(host) == 2);
+        auto lease = pool.acquire(host);
+        REQUIRE(seen.count(&*lease) == 1);
+    }
+
+    SECTION("capped at the idle limit") {
+        REQUIRE(pool.warmUp(host, 10, [&](httplib::Client& client) {
+            record(client);
+            return true;
+        }) == 3);
+        REQUIRE(seen.size() == 3);
+        REQUIRE(pool.clientCount(host) == 3);
+    }
+
+    SECTION("counts only successful probes") {
+        std::atomic<int> calls{0};
+        size_t connected = pool.warmUp(host, 3, [&](httplib::Client&) {
+            int call = ++calls;
+            if (call == 1) throw std::runtime_error("refused");
+            return call == 2;
+        });
+        REQUIRE(calls.load() == 3);
+        REQUIRE(connected == 1);
+        REQUIRE(pool.idleCount(host) == 3);
+    }
+
+    SECTION("does nothing after shutdown") {
+        pool.shutdown();
+        REQUIRE(pool.warmUp(host, 2, [](httplib::Client&) { return true; }) == 0);
+    }
+}
+
+TEST_CASE("HttpClientPool shutdown", "[HttpClientPool]") {
+    HttpClientPool::Options options;
+    options.maxInFlightPerHost = 1;
+    HttpClientPool pool(options);
+    const std::string host = "https://api.example.com";
+
+    SECTION("wakes a waiting borrower with an empty lease") {
+        auto a = pool.acquire(host);
+        std::atomic<bool> done{false};
+        std::atomic<bool> got{true};
+        std::thread waiter([&]() {
+            auto b = pool.acquire(host);
+            got.store(static_cast<bool>(b));
+            done.store(true);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pool.shutdown();
+        waiter.join();
+        REQUIRE(done.load());
+        REQUIRE_FALSE(got.load());
+    }
+
+    SECTION("later acquires fail and returned clients are not kept") {
+        auto a = pool.acquire(host);
+        pool.shutdown();
+        REQUIRE_FALSE(pool.acquire(host));
+        a.release();
+        REQUIRE(pool.idleCount(host) == 0);
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * HTTP Content-Encoding Unit Tests
+ *
+ * Tests identity pass-through, gzip/deflate/br decoding when the httplib
+ * build supports them, stacked codings and rejection of corrupt or
+ * unsupported bodies.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/http_compression.h>
+#include <string>
+#include <vector>
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+#include <zlib.h>
+#endif
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+#include <brotli/encode.h>
+#endif
+
+using network::acceptedContentEncodings;
+using network::decodeContent;
+
+namespace {
+    std::string sampleJson() {
+        std::string json = R"({"code":0,"data":{"result":[)";
+        for (int i = 0; i < 200; ++i) {
+            json += R"({"bvid":"BV1xx411c7)" + std::to_string(i) + R"(","title":"song"},)";
+        }
+        json += "{}]}}";
+        return json;
+    }
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+    // windowBits 15 + 16 writes gzip, 15 zlib, -15 raw deflate
+    std::string deflateWith(const std::string& in, int windowBits) {
+        z_stream stream{};
+        deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+        std::vector<char> out(deflateBound(&stream, static_cast<uLong>(in.size())) + 32);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+        stream.avail_in = static_cast<uInt>(in.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return std::string(out.begin(), out.end());
+    }
+#endif
+}
+
+TEST_CASE("decodeContent passes identity bodies through", "[HttpCompression]") {
+    const std::string body = sampleJson();
+    std::string decoded;
+
+    SECTION("no Content-Encoding") {
+        REQUIRE(decodeContent("", body, decoded));
+        REQUIRE(decoded == body);
+    }
+
+    SECTION("explicit identity") {
+        REQUIRE(decodeContent(" Identity ", body, decoded));
+        REQUIRE(decoded == body);
+    }
+
+    SECTION("unknown codings are rejected") {
+        REQUIRE_FALSE(decodeContent("compress", body, decoded));
+    }
+
+    SECTION("Accept-Encoding is never empty") {
+        REQUIRE_FALSE(acceptedContentEncodings().empty());
+    }
+}
+
+#ifdef CPPHTTPLIB_ZLIB_SUPPORT
+TEST_CASE("decodeContent inflates gzip and deflate", "[HttpCompression]") {
+    const std::string body = sampleJson();
+    std::string decoded;
+
+    SECTION("gzip shrinks the JSON and round-trips") {
+        const std::string gzip = deflateWith(body, 15 + 16);
+        REQUIRE(gzip.size() < body.size() / 4);
+        REQUIRE(decodeContent("gzip", gzip, decoded));
+        REQUIRE(decoded == body);
+        REQUIRE(acceptedContentEncodings().find("gzip") != std::string::npos);
+    }
+
+    SECTION("deflate, zlib-wrapped or raw") {
+        REQUIRE(decodeContent("deflate", deflateWith(body, 15), decoded));
+        REQUIRE(decoded == body);
+        decoded.clear();
+        REQUIRE(decodeContent("DEFLATE", deflateWith(body, -15), decoded));
+        REQUIRE(decoded == body);
+    }
+
+    SECTION("stacked codings are undone last to first") {
+        const std::string twice = deflateWith(deflateWith(body, 15), 15 + 16);
+        REQUIRE(decodeContent("deflate, gzip", twice, decoded));
+        REQUIRE(decoded == body);
+    }
+
+    SECTION("truncated and corrupt bodies fail") {
+        const std::string gzip = deflateWith(body, 15 + 16);
+        REQUIRE_FALSE(decodeContent("gzip", gzip.substr(0, gzip.size() / 2), decoded));
+        REQUIRE_FALSE(decodeContent("gzip", body, decoded));
+    }
+}
+#endif
+
+#ifdef CPPHTTPLIB_BROTLI_SUPPORT
+TEST_CASE("decodeContent decodes brotli", "[HttpCompression]") {
+    const std::string body = sampleJson();
+    std::vector<uint8_t> encoded(BrotliEncoderMaxCompressedSize(body.size()));
+    size_t encodedSize = encoded.size();
+    REQUIRE(BrotliEncoderCompress(BROTLI_DEFAULT_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                                  body.size(), reinterpret_cast<const uint8_t*>(body.data()),
+                                  &encodedSize, encoded.data()));
+    const std::string br(reinterpret_cast<const char*>(encoded.data()), encodedSize);
+
+    std::string decoded;
+    REQUIRE(decodeContent("br", br, decoded));
+    REQUIRE(decoded == body);
+    REQUIRE_FALSE(decodeContent("br", br.substr(0, br.size() / 2), decoded));
+    REQUIRE(acceptedContentEncodings().rfind("br", 0) == 0);
+}
+#endif
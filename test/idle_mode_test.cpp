@@ -0,0 +1,76 @@
+/**
+ * IdleMode Unit Tests
+ *
+ * Tests that idle mode needs both inactive playback and a hidden window, that the
+ * handler only runs on changes, and the wake-up count and rate.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/idle_mode.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using util::IdleMode;
+
+TEST_CASE("IdleMode is idle with playback inactive and the window hidden", "[IdleMode]") {
+    std::vector<bool> changes;
+    IdleMode mode([&changes](bool idle) { changes.push_back(idle); });
+    REQUIRE_FALSE(mode.idle());
+
+    SECTION("hiding the window while paused") {
+        mode.setPlaybackActive(false);
+        REQUIRE_FALSE(mode.idle());
+        mode.setWindowVisible(false);
+        REQUIRE(mode.idle());
+        mode.setWindowVisible(true);
+        REQUIRE_FALSE(mode.idle());
+        REQUIRE(changes == std::vector<bool>{ true, false });
+    }
+
+    SECTION("playing in the background is not idle") {
+        mode.setPlaybackActive(true);
+        mode.setWindowVisible(false);
+        REQUIRE_FALSE(mode.idle());
+        REQUIRE(changes.empty());
+
+        // Pausing from the tray or a media key enters it, playing again leaves it
+        mode.setPlaybackActive(false);
+        REQUIRE(mode.idle());
+        mode.setPlaybackActive(true);
+        REQUIRE(changes == std::vector<bool>{ true, false });
+    }
+
+    SECTION("repeated inputs don't call the handler again") {
+        mode.setWindowVisible(false);
+        mode.setWindowVisible(false);
+        mode.setPlaybackActive(false);
+        REQUIRE(changes == std::vector<bool>{ true });
+    }
+}
+
+TEST_CASE("IdleMode counts wake-ups and averages them per second", "[IdleMode]") {
+    const uint64_t before = IdleMode::wakeups();
+    const double rateBefore = IdleMode::wakeupsPerSecond();
+
+    // From several threads at once, as the timers and pollers do
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([]() {
+            for (int i = 0; i < 50; ++i) {
+                IdleMode::recordWakeup();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(IdleMode::wakeups() - before == 200);
+
+    // Counted once their second is over: 200 over the window, unless the window already
+    // drops the wake-ups seen before
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    const double rate = IdleMode::wakeupsPerSecond();
+    REQUIRE(rate >= 200.0 / IdleMode::RATE_WINDOW_SECONDS);
+    REQUIRE(rate <= rateBefore + 200.0 / IdleMode::RATE_WINDOW_SECONDS);
+}
@@ -0,0 +1,217 @@
+/**
+ * JsonScanner Unit Tests
+ *
+ * Tests walking objects and arrays, pulling typed values, skipping unused
+ * members of every type, string escapes and rejection of malformed input.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/json_scanner.h>
+#include <string>
+#include <vector>
+
+using util::JsonScanner;
+
+namespace {
+    struct Item {
+        std::string bvid;
+        int64_t cid = 0;
+    };
+
+    // {"data":{"result":[{...}, ...]}} the way the search parser walks it
+    std::vector<Item> readResults(const std::string& text, bool& ok) {
+        std::vector<Item> items;
+        JsonScanner json(text);
+        std::string_view key;
+        if (json.enterObject()) {
+            while (json.nextKey(key)) {
+                if (key != "data" || !json.enterObject()) {
+                    json.skipValue();
+                    continue;
+                }
+                while (json.nextKey(key)) {
+                    if (key != "result" || !json.enterArray()) {
+                        json.skipValue();
+                        continue;
+                    }
+                    while (json.nextElement()) {
+                        if (!json.enterObject()) {
+                            json.skipValue();
+                            continue;
+                        }
+                        Item item;
+                        while (json.nextKey(key)) {
+                            const bool taken = (key == "bvid" && json.readString(item.bvid))
+                                || (key == "cid" && json.readInt(item.cid));
+                            if (!taken) json.skipValue();
+                        }
+                        items.push_back(item);
+                    }
+                }
+            }
+        }
+        ok = json.ok();
+        return items;
+    }
+}
+
+TEST_CASE("JsonScanner pulls fields and skips the rest", "[JsonScanner]") {
+    bool ok = false;
+
+    SECTION("nested members of every type are skipped") {
+        const std::string text = R"( {
+            "code": 0, "message": "0", "ttl": 1.5e3,
+            "data": {
+                "seid": "123", "flag": true, "none": null,
+                "nested": {"a": [1, {"b": "]}"}, []], "c": {}},
+                "result": [
+                    {"type": "video", "bvid": "BV1a", "tags": ["x", "y"], "cid": 42},
+                    {"cid": -7, "bvid": "BV1b", "extra": {"deep": [[[]]]}}
+                ],
+                "after": [1, 2, 3]
+            }
+        } )";
+        auto items = readResults(text, ok);
+        REQUIRE(ok);
+        REQUIRE(items.size() == 2);
+        REQUIRE(items[0].bvid == "BV1a");
+        REQUIRE(items[0].cid == 42);
+        REQUIRE(items[1].bvid == "BV1b");
+        REQUIRE(items[1].cid == -7);
+    }
+
+    SECTION("empty containers and missing parts") {
+        REQUIRE(readResults(R"({"data":{"result":[]}})", ok).empty());
+        REQUIRE(ok);
+        REQUIRE(readResults(R"({"data":null})", ok).empty());
+        REQUIRE(ok);
+        REQUIRE(readResults(R"({"data":{"result":"none"}})", ok).empty());
+        REQUIRE(ok);
+        REQUIRE(readResults(R"({})", ok).empty());
+        REQUIRE(ok);
+    }
+
+    SECTION("values of another type stay in place") {
+        JsonScanner json(R"({"cid": "12", "page": 3})");
+        std::string_view key;
+        REQUIRE(json.enterObject());
+        REQUIRE(json.nextKey(key));
+        REQUIRE(key == "cid");
+        int64_t cid = 0;
+        REQUIRE_FALSE(json.readInt(cid));
+        REQUIRE_FALSE(json.enterArray());
+        std::string text;
+        REQUIRE(json.readString(text));
+        REQUIRE(text == "12");
+        REQUIRE(json.nextKey(key));
+        int page = 0;
+        bool flag = false;
+        REQUIRE_FALSE(json.readBool(flag));
+        REQUIRE(json.readInt(page));
+        REQUIRE(page == 3);
+        REQUIRE_FALSE(json.nextKey(key));
+        REQUIRE(json.ok());
+    }
+
+    SECTION("numbers keep their integral part") {
+        JsonScanner json(R"([12.75, 3e2, 0, true, false])");
+        REQUIRE(json.enterArray());
+        int64_t value = -1;
+        REQUIRE(json.nextElement());
+        REQUIRE(json.readInt(value));
+        REQUIRE(value == 12);
+        REQUIRE(json.nextElement());
+        REQUIRE(json.readInt(value));
+        REQUIRE(value == 3);
+        REQUIRE(json.nextElement());
+        REQUIRE(json.readInt(value));
+        REQUIRE(value == 0);
+        bool flag = false;
+        REQUIRE(json.nextElement());
+        REQUIRE(json.readBool(flag));
+        REQUIRE(flag);
+        REQUIRE(json.nextElement());
+        REQUIRE(json.readBool(flag));
+        REQUIRE_FALSE(flag);
+        REQUIRE_FALSE(json.nextElement());
+        REQUIRE(json.ok());
+    }
+
+    SECTION("captured values keep their text") {
+        JsonScanner json(R"({"songs": [ {"t": "a]"}, 2 ] , "n": "x", "k": -1})");
+        std::string_view key;
+        std::string_view raw;
+        REQUIRE(json.enterObject());
+        REQUIRE(json.nextKey(key));
+        REQUIRE(json.captureValue(raw));
+        REQUIRE(raw == R"([ {"t": "a]"}, 2 ])");
+        REQUIRE(json.nextKey(key));
+        REQUIRE(json.captureValue(raw));
+        REQUIRE(raw == R"("x")");
+        REQUIRE(json.nextKey(key));
+        REQUIRE(json.captureValue(raw));
+        REQUIRE(raw == "-1");
+        REQUIRE_FALSE(json.nextKey(key));
+        REQUIRE(json.ok());
+    }
+}
+
+TEST_CASE("JsonScanner decodes string escapes", "[JsonScanner]") {
+    std::string out = "previous content";
+
+    SECTION("simple escapes") {
+        JsonScanner json(R"("a\"b\\c\/d\n\t<em class=\"keyword\">")");
+        REQUIRE(json.readString(out));
+        REQUIRE(out == "a\"b\\c/d\n\t<em class=\"keyword\">");
+    }
+
+    SECTION("unicode escapes become UTF-8") {
+        // U+4E2D, U+00E9 and U+1F3B5 as a surrogate pair
+        JsonScanner json(R"("\u4e2d\u00E9\ud83c\udfb5!")");
+        REQUIRE(json.readString(out));
+        REQUIRE(out == "\xE4\xB8\xAD\xC3\xA9\xF0\x9F\x8E\xB5!");
+    }
+
+    SECTION("raw UTF-8 passes through") {
+        JsonScanner json("\"\xE6\xAD\x8C\xE6\x9B\xB2\"");
+        REQUIRE(json.readString(out));
+        REQUIRE(out == "\xE6\xAD\x8C\xE6\x9B\xB2");
+    }
+
+    SECTION("broken escapes fail") {
+        JsonScanner lone(R"("\udc00")");
+        REQUIRE_FALSE(lone.readString(out));
+        REQUIRE_FALSE(lone.ok());
+        JsonScanner unknown(R"("\q")");
+        REQUIRE_FALSE(unknown.readString(out));
+        REQUIRE_FALSE(unknown.ok());
+    }
+}
+
+TEST_CASE("JsonScanner rejects malformed input", "[JsonScanner]") {
+    bool ok = true;
+
+    SECTION("truncated documents") {
+        readResults(R"({"data":{"result":[{"bvid":"BV1a"},{"bvid":"BV)", ok);
+        REQUIRE_FALSE(ok);
+        readResults(R"({"data":{"result":[{"bvid":"BV1a"})", ok);
+        REQUIRE_FALSE(ok);
+    }
+
+    SECTION("missing separators") {
+        readResults(R"({"data" {"result":[]}})", ok);
+        REQUIRE_FALSE(ok);
+        readResults(R"({"data":{"result":[{"bvid":"a"} {"bvid":"b"}]}})", ok);
+        REQUIRE_FALSE(ok);
+    }
+
+    SECTION("every call fails after an error") {
+        JsonScanner json(R"({"a" 1, "b": 2})");
+        std::string_view key;
+        REQUIRE(json.enterObject());
+        REQUIRE_FALSE(json.nextKey(key));
+        REQUIRE_FALSE(json.ok());
+        REQUIRE_FALSE(json.nextKey(key));
+        REQUIRE_FALSE(json.skipValue());
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * LocalMetadataCache Unit Tests
+ *
+ * Tests entries going stale as files change on disk, saving and loading, and
+ * PlaylistManager rescanning an imported folder without probing unchanged files again.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+#include "config/config_manager.h"
+#include "playlist/local_metadata_cache.h"
+#include "playlist/playlist_manager.h"
+#include "test_utils.h"
+
+using playlist::LocalFileMetadata;
+using playlist::LocalMetadataCache;
+
+namespace {
+    QDir makeTempDir(const std::string& name)
+    {
+        auto stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+        auto dir = std::filesystem::temp_directory_path() / ("BilibiliPlayerTest_" + name + "_" + stamp);
+        std::filesystem::create_directories(dir);
+        return QDir(QString::fromStdString(dir.string()));
+    }
+
+    void writeFile(const QString& path, const QByteArray& data)
+    {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+    }
+
+    bool waitForImport(const PlaylistManager& mgr)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (mgr.isImportingLocalFolder() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return !mgr.isImportingLocalFolder();
+    }
+}
+
+TEST_CASE("LocalMetadataCache forgets files changed on disk", "[LocalMetadataCache]") {
+    QDir dir = makeTempDir("local_metadata");
+    const QString path = dir.filePath("song.mp3");
+    writeFile(path, "dummy data");
+
+    LocalMetadataCache cache;
+    REQUIRE_FALSE(cache.lookup(QFileInfo(path)).has_value());
+
+    LocalFileMetadata entry;
+    entry.metadata.durationMs = 181000;
+    entry.metadata.artist = "Artist";
+    entry.coverName = "cover.jpg";
+    cache.store(QFileInfo(path), entry);
+    auto found = cache.lookup(QFileInfo(path));
+    REQUIRE(found.has_value());
+    REQUIRE(found->metadata.durationMs == 181000);
+    REQUIRE(found->metadata.artist == "Artist");
+    REQUIRE(found->coverName == "cover.jpg");
+
+    SECTION("rewritten with another size") {
+        writeFile(path, "other, longer dummy data");
+        REQUIRE_FALSE(cache.lookup(QFileInfo(path)).has_value());
+        // Still known as probed once, which folder rescans go by
+        REQUIRE(cache.contains(QFileInfo(path).absoluteFilePath()));
+    }
+
+    SECTION("touched") {
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadWrite));
+        REQUIRE(file.setFileTime(QDateTime::currentDateTime().addSecs(-3600), QFileDevice::FileModificationTime));
+        file.close();
+        REQUIRE_FALSE(cache.lookup(QFileInfo(path)).has_value());
+    }
+
+    SECTION("saved and loaded") {
+        cache.addFolder(dir.absolutePath(), QUuid::createUuid());
+        const QString cacheFile = dir.filePath("local.json");
+        REQUIRE(cache.save(cacheFile));
+
+        LocalMetadataCache loaded;
+        REQUIRE(loaded.load(cacheFile));
+        REQUIRE(loaded.size() == 1);
+        REQUIRE(loaded.folders() == cache.folders());
+        auto reloaded = loaded.lookup(QFileInfo(path));
+        REQUIRE(reloaded.has_value());
+        REQUIRE(reloaded->metadata.durationMs == 181000);
+        REQUIRE(reloaded->coverName == "cover.jpg");
+    }
+
+    dir.removeRecursively();
+}
+
+TEST_CASE("PlaylistManager rescans an imported folder", "[playlist_manager][LocalMetadataCache]") {
+    testutils::ensureQCoreApplication();
+    QDir dir = makeTempDir("rescan");
+    QDir().mkpath(dir.filePath("music"));
+    for (const char* name : { "a.mp3", "b.mp3", "c.mp3" }) {
+        writeFile(dir.filePath("music/") + name, "dummy data");
+    }
+    {
+        ConfigManager cfg;
+        cfg.initialize(dir.absolutePath());
+        QList<playlist::SongInfo> imported;
+        int before = 0;
+        {
+            PlaylistManager mgr(&cfg);
+            mgr.initialize();
+            const QUuid current = mgr.getCurrentPlaylist();
+            before = mgr.songsSnapshot(current).size();
+
+            REQUIRE(mgr.importLocalFolder(dir.filePath("music"), current));
+            REQUIRE(waitForImport(mgr));
+            imported = mgr.songsSnapshot(current);
+            REQUIRE(imported.size() == before + 3);
+
+            // Nothing changed: the songs stay as they are
+            REQUIRE(mgr.importLocalFolder(dir.filePath("music"), current));
+            REQUIRE(waitForImport(mgr));
+            REQUIRE(mgr.songsSnapshot(current) == imported);
+            mgr.saveAllCategories();
+        }
+
+        // The probes outlive the session
+        const QFileInfo categories(QDir(cfg.getWorkspaceDirectory()).absoluteFilePath(cfg.getCategoriesFilePath()));
+        LocalMetadataCache cache;
+        REQUIRE(cache.load(categories.absoluteDir().filePath(categories.completeBaseName() + ".local.json")));
+        REQUIRE(cache.size() == 3);
+        REQUIRE(cache.folders().size() == 1);
+
+        // One file added, one deleted, while the player was closed
+        writeFile(dir.filePath("music/d.mp3"), "dummy data");
+        REQUIRE(QFile::remove(dir.filePath("music/a.mp3")));
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        const QUuid current = mgr.getCurrentPlaylist();
+        REQUIRE(mgr.importLocalFolder(dir.filePath("music"), current));
+        REQUIRE(waitForImport(mgr));
+        const QList<playlist::SongInfo> rescanned = mgr.songsSnapshot(current);
+        QStringList titles;
+        for (const playlist::SongInfo& song : rescanned.mid(before)) {
+            titles << song.title;
+        }
+        REQUIRE(titles == QStringList({ "b", "c", "d" }));
+        REQUIRE(rescanned[before].uuid == imported[before + 1].uuid);
+    }
+    dir.removeRecursively();
+}
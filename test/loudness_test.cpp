@@ -0,0 +1,159 @@
+/**
+ * LoudnessMeter / LoudnessAnalyzer Unit Tests
+ *
+ * Checks the BS.1770 meter against EBU Tech 3341 style signals (1 kHz stereo sines
+ * of known level), that gating ignores silence, the clipping-safe gain, and that the
+ * background analyzer reports results for tracks handed to it from memory.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/loudness_meter.h>
+#include <audio/loudness_analyzer.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace audio;
+
+namespace {
+    constexpr int kRate = 48000;
+
+    // Interleaved stereo 1 kHz sine with the given peak level in dBFS
+    std::vector<float> sine(double levelDb, double seconds) {
+        const size_t frames = static_cast<size_t>(seconds * kRate);
+        const double amplitude = std::pow(10.0, levelDb / 20.0);
+        std::vector<float> pcm(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            float v = static_cast<float>(amplitude * std::sin(2.0 * 3.14159265358979323846 * 1000.0 * i / kRate));
+            pcm[i * 2] = v;
+            pcm[i * 2 + 1] = v;
+        }
+        return pcm;
+    }
+
+    bool near(double value, double expected, double tolerance) {
+        return std::fabs(value - expected) <= tolerance;
+    }
+}
+
+TEST_CASE("LoudnessMeter measures integrated loudness", "[LoudnessMeter]") {
+    SECTION("-23 dBFS sine reads -23 LUFS") {
+        auto pcm = sine(-23.0, 20.0);
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(pcm.data(), pcm.size() / 2);
+        REQUIRE(near(meter.integratedLoudness(), -23.0, 0.1));
+        REQUIRE(near(meter.samplePeak(), std::pow(10.0, -23.0 / 20.0), 1e-4));
+    }
+
+    SECTION("-33 dBFS sine reads -33 LUFS") {
+        auto pcm = sine(-33.0, 20.0);
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(pcm.data(), pcm.size() / 2);
+        REQUIRE(near(meter.integratedLoudness(), -33.0, 0.1));
+    }
+
+    SECTION("Silence around the tone is gated out") {
+        auto tone = sine(-23.0, 10.0);
+        std::vector<float> silence(static_cast<size_t>(kRate) * 2 * 10, 0.0f);
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(silence.data(), silence.size() / 2);
+        meter.addFloat(tone.data(), tone.size() / 2);
+        meter.addFloat(silence.data(), silence.size() / 2);
+        // Ungated this would read about -27.8 LUFS; only blocks straddling the tone edges count
+        REQUIRE(near(meter.integratedLoudness(), -23.0, 0.2));
+    }
+
+    SECTION("16-bit input matches float input") {
+        auto pcm = sine(-20.0, 5.0);
+        std::vector<int16_t> s16(pcm.size());
+        for (size_t i = 0; i < pcm.size(); ++i) {
+            s16[i] = static_cast<int16_t>(std::lrint(pcm[i] * 32768.0f));
+        }
+        LoudnessMeter floatMeter(kRate, 2);
+        LoudnessMeter intMeter(kRate, 2);
+        floatMeter.addFloat(pcm.data(), pcm.size() / 2);
+        intMeter.addS16(s16.data(), s16.size() / 2);
+        REQUIRE(near(intMeter.integratedLoudness(), floatMeter.integratedLoudness(), 0.01));
+    }
+
+    SECTION("Silent tracks report the gate floor and no gain") {
+        std::vector<float> silence(static_cast<size_t>(kRate) * 2 * 2, 0.0f);
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(silence.data(), silence.size() / 2);
+        REQUIRE(meter.integratedLoudness() == LoudnessMeter::SILENCE_LUFS);
+        REQUIRE(meter.gainDb() == 0.0);
+    }
+}
+
+TEST_CASE("LoudnessMeter gain never clips", "[LoudnessMeter]") {
+    SECTION("Quiet track is raised to the reference level") {
+        auto pcm = sine(-28.0, 5.0);
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(pcm.data(), pcm.size() / 2);
+        REQUIRE(near(meter.gainDb(), LoudnessMeter::REFERENCE_LUFS + 28.0, 0.1));
+    }
+
+    SECTION("Loud track is attenuated") {
+        auto pcm = sine(-6.0, 5.0);
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(pcm.data(), pcm.size() / 2);
+        REQUIRE(near(meter.gainDb(), LoudnessMeter::REFERENCE_LUFS + 6.0, 0.1));
+    }
+
+    SECTION("Gain is limited by the sample peak") {
+        auto pcm = sine(-30.0, 5.0);
+        pcm[1000] = 0.5f;  // a single transient at -6 dBFS
+        LoudnessMeter meter(kRate, 2);
+        meter.addFloat(pcm.data(), pcm.size() / 2);
+        REQUIRE(near(meter.gainDb(), -20.0 * std::log10(0.5), 1e-6));
+        REQUIRE(meter.gainDb() < LoudnessMeter::REFERENCE_LUFS + 30.0);
+    }
+}
+
+TEST_CASE("LoudnessAnalyzer measures tracks in the background", "[LoudnessAnalyzer]") {
+    auto pcm = sine(-23.0, 5.0);
+    auto track = std::make_shared<DecodedTrack>();
+    track->format = AudioFormat{kRate, 2, 32};
+    track->pcm.resize(pcm.size() * sizeof(float));
+    std::memcpy(track->pcm.data(), pcm.data(), track->pcm.size());
+
+    SECTION("Synchronous measurement of a decoded track") {
+        double gainDb = 0.0;
+        REQUIRE(LoudnessAnalyzer::measureTrack(*track, gainDb));
+        REQUIRE(near(gainDb, LoudnessMeter::REFERENCE_LUFS + 23.0, 0.1));
+
+        DecodedTrack empty;
+        REQUIRE_FALSE(LoudnessAnalyzer::measureTrack(empty, gainDb));
+    }
+
+    SECTION("Queued track is reported through the callback") {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::string resultKey;
+        double resultGain = 0.0;
+        LoudnessAnalyzer analyzer([&](const std::string& key, double gainDb) {
+            std::lock_guard<std::mutex> lock(mutex);
+            resultKey = key;
+            resultGain = gainDb;
+            done.notify_all();
+        });
+        analyzer.analyzeTrack("song-1", track);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        REQUIRE(done.wait_for(lock, std::chrono::seconds(10), [&]() { return !resultKey.empty(); }));
+        REQUIRE(resultKey == "song-1");
+        REQUIRE(near(resultGain, LoudnessMeter::REFERENCE_LUFS + 23.0, 0.1));
+    }
+
+    SECTION("Missing files produce no result") {
+        double gainDb = 0.0;
+        std::atomic<bool> stop{false};
+        REQUIRE_FALSE(LoudnessAnalyzer::measureFile("does/not/exist.m4a", gainDb, stop));
+    }
+}
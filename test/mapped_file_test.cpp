@@ -0,0 +1,51 @@
+/**
+ * MappedFile Unit Tests
+ *
+ * Tests read-only memory mapping of local files used by the decoder's local-file path.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/mapped_file.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace util;
+
+TEST_CASE("MappedFile maps local files", "[MappedFile]") {
+    const auto path = (std::filesystem::temp_directory_path() / "bp_mapped_file_test.bin").string();
+
+    SECTION("Mapped bytes match the file contents") {
+        std::string content(10000, '\0');
+        for (size_t i = 0; i < content.size(); ++i) {
+            content[i] = static_cast<char>(i % 251);
+        }
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        }
+
+        MappedFile file;
+        REQUIRE(file.open(path));
+        REQUIRE(file.isOpen());
+        REQUIRE(file.size() == content.size());
+        REQUIRE(std::memcmp(file.data(), content.data(), content.size()) == 0);
+
+        file.close();
+        REQUIRE_FALSE(file.isOpen());
+        REQUIRE(file.size() == 0);
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Missing and empty files are rejected") {
+        std::filesystem::remove(path);
+        MappedFile file;
+        REQUIRE_FALSE(file.open(path));
+
+        { std::ofstream out(path, std::ios::binary | std::ios::trunc); }
+        REQUIRE_FALSE(file.open(path));
+        REQUIRE_FALSE(file.isOpen());
+        std::filesystem::remove(path);
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * MemoryBudget Unit Tests
+ *
+ * Covers the trim order (lowest priority, then largest first), enforcement when a
+ * consumer grows, relief on low system memory, unregistering, and an unlimited cap.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/memory_budget.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using util::MemoryBudget;
+
+namespace {
+    // A consumer whose size the test sets, recording the trims it gets
+    struct FakeConsumer {
+        size_t bytes = 0;
+        std::vector<size_t> trims;
+
+        MemoryBudget::Registration attach(MemoryBudget& budget, const std::string& name,
+                                          MemoryBudget::Priority priority, bool trimmable = true) {
+            MemoryBudget::TrimFunction trim;
+            if (trimmable) {
+                trim = [this](size_t request) {
+                    trims.push_back(request);
+                    const size_t freed = std::min(request, bytes);
+                    bytes -= freed;
+                    return freed;
+                };
+            }
+            return budget.add(name, priority, [this]() { return bytes; }, trim);
+        }
+    };
+}
+
+TEST_CASE("MemoryBudget trims low priority and large consumers first", "[MemoryBudget]") {
+    MemoryBudget budget(1000);
+    FakeConsumer lowSmall, lowLarge, normal, fixed;
+    auto r1 = lowSmall.attach(budget, "low small", MemoryBudget::Priority::Low);
+    auto r2 = lowLarge.attach(budget, "low large", MemoryBudget::Priority::Low);
+    auto r3 = normal.attach(budget, "normal", MemoryBudget::Priority::Normal);
+    auto r4 = fixed.attach(budget, "fixed", MemoryBudget::Priority::High, false);
+
+    lowSmall.bytes = 200;
+    lowLarge.bytes = 300;
+    normal.bytes = 400;
+    fixed.bytes = 300;
+    REQUIRE(budget.used() == 1200);
+
+    // 200 over: the largest Low consumer covers it alone
+    REQUIRE(budget.enforce() == 200);
+    REQUIRE(lowLarge.trims == std::vector<size_t>{ 200 });
+    REQUIRE(lowSmall.trims.empty());
+    REQUIRE(normal.trims.empty());
+    REQUIRE(budget.used() == 1000);
+
+    // 600 over: both Low consumers empty out, Normal gives the rest
+    fixed.bytes = 900;
+    REQUIRE(budget.enforce() == 600);
+    REQUIRE(lowSmall.bytes == 0);
+    REQUIRE(lowLarge.bytes == 0);
+    REQUIRE(normal.bytes == 100);
+    REQUIRE(budget.used() == 1000);
+
+    auto usage = budget.usage();
+    REQUIRE(usage.size() == 4);
+    REQUIRE(usage.back().name == "fixed");
+    REQUIRE(usage.back().bytes == 900);
+}
+
+TEST_CASE("MemoryBudget enforces the cap when a consumer grows", "[MemoryBudget]") {
+    MemoryBudget budget(1000);
+    FakeConsumer cache, buffers;
+    auto cacheRegistration = cache.attach(budget, "cache", MemoryBudget::Priority::Normal);
+    auto bufferRegistration = buffers.attach(budget, "buffers", MemoryBudget::Priority::High, false);
+
+    cache.bytes = 800;
+    cacheRegistration.grew();
+    REQUIRE(cache.trims.empty());
+
+    buffers.bytes = 500;
+    bufferRegistration.grew();
+    REQUIRE(cache.trims == std::vector<size_t>{ 300 });
+    REQUIRE(cache.bytes == 500);
+
+    // Lowering the cap trims right away, removing it never does
+    budget.setCap(600);
+    REQUIRE(cache.bytes == 100);
+    budget.setCap(0);
+    cache.bytes = 5000;
+    cacheRegistration.grew();
+    REQUIRE(budget.enforce() == 0);
+    REQUIRE(cache.bytes == 5000);
+}
+
+TEST_CASE("MemoryBudget relieve frees memory whatever the cap", "[MemoryBudget]") {
+    MemoryBudget budget(0);
+    FakeConsumer low, normal, high;
+    auto r1 = low.attach(budget, "low", MemoryBudget::Priority::Low);
+    auto r2 = normal.attach(budget, "normal", MemoryBudget::Priority::Normal);
+    auto r3 = high.attach(budget, "high", MemoryBudget::Priority::High);
+    low.bytes = 400;
+    normal.bytes = 400;
+    high.bytes = 400;
+
+    REQUIRE(budget.relieve() == 600);
+    REQUIRE(low.bytes == 0);
+    REQUIRE(normal.bytes == 200);
+    REQUIRE(high.bytes == 400);
+    REQUIRE(high.trims.empty());
+}
+
+TEST_CASE("MemoryBudget forgets consumers whose registration is gone", "[MemoryBudget]") {
+    MemoryBudget budget(100);
+    FakeConsumer consumer;
+    consumer.bytes = 500;
+    {
+        auto registration = consumer.attach(budget, "scoped", MemoryBudget::Priority::Low);
+        MemoryBudget::Registration moved = std::move(registration);
+        REQUIRE_FALSE(registration);
+        REQUIRE(moved);
+        REQUIRE(budget.used() == 500);
+    }
+    REQUIRE(budget.used() == 0);
+    REQUIRE(budget.usage().empty());
+    REQUIRE(budget.enforce() == 0);
+    REQUIRE(consumer.trims.empty());
+}
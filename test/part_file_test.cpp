@@ -0,0 +1,109 @@
+/**
+ * Part File Resume Unit Tests
+ *
+ * Tests that a .part is reused only for the same stream (size, ETag,
+ * Last-Modified) and layout, and that stale or unvalidated ones are removed.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/part_file.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using network::StreamInfo;
+using network::preparePartFile;
+using network::removePartFile;
+using network::sameStream;
+
+namespace {
+    std::string freshPartPath() {
+        auto dir = std::filesystem::temp_directory_path() / "BilibiliPlayerTestData" / "part_file";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        return (dir / "song.m4a.part").string();
+    }
+
+    void writeBytes(const std::string& path, size_t count) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << std::string(count, 'x');
+    }
+
+    StreamInfo stream(uint64_t size, const std::string& etag = "\"abc\"") {
+        StreamInfo info;
+        info.size = size;
+        info.etag = etag;
+        info.lastModified = "Tue, 01 Oct 2024 10:00:00 GMT";
+        return info;
+    }
+}
+
+TEST_CASE("sameStream compares size and validators", "[PartFile]") {
+    REQUIRE(sameStream(stream(100), stream(100)));
+    REQUIRE_FALSE(sameStream(stream(100), stream(101)));
+    REQUIRE_FALSE(sameStream(stream(100, "\"abc\""), stream(100, "\"def\"")));
+    // A validator only one side has can't disagree
+    REQUIRE(sameStream(stream(100, ""), stream(100, "\"def\"")));
+}
+
+TEST_CASE("preparePartFile keeps only matching partial downloads", "[PartFile]") {
+    const std::string part = freshPartPath();
+
+    SECTION("nothing on disk starts from zero and records the stream") {
+        REQUIRE(preparePartFile(part, stream(1000), false) == 0);
+        REQUIRE(std::filesystem::exists(part + ".meta"));
+    }
+
+    SECTION("an interrupted download of the same stream resumes") {
+        REQUIRE(preparePartFile(part, stream(1000), false) == 0);
+        writeBytes(part, 400);
+        REQUIRE(preparePartFile(part, stream(1000), false) == 400);
+        REQUIRE(std::filesystem::file_size(part) == 400);
+    }
+
+    SECTION("a changed ETag discards the data") {
+        preparePartFile(part, stream(1000), false);
+        writeBytes(part, 400);
+        REQUIRE(preparePartFile(part, stream(1000, "\"new\""), false) == 0);
+        REQUIRE_FALSE(std::filesystem::exists(part));
+    }
+
+    SECTION("a changed size discards the data") {
+        preparePartFile(part, stream(1000), false);
+        writeBytes(part, 400);
+        REQUIRE(preparePartFile(part, stream(2000), false) == 0);
+        REQUIRE_FALSE(std::filesystem::exists(part));
+    }
+
+    SECTION("a .part without .meta is not trusted") {
+        writeBytes(part, 400);
+        REQUIRE(preparePartFile(part, stream(1000), false) == 0);
+        REQUIRE_FALSE(std::filesystem::exists(part));
+    }
+
+    SECTION("a sparse cache is never resumed as a plain prefix") {
+        preparePartFile(part, stream(1000), true);
+        writeBytes(part, 1000);
+        writeBytes(part + ".idx", 16);
+        REQUIRE(preparePartFile(part, stream(1000), false) == 0);
+        REQUIRE_FALSE(std::filesystem::exists(part + ".idx"));
+    }
+
+    SECTION("an unknown size can't be validated") {
+        preparePartFile(part, stream(1000), false);
+        writeBytes(part, 400);
+        REQUIRE(preparePartFile(part, stream(0), false) == 0);
+        REQUIRE_FALSE(std::filesystem::exists(part));
+        REQUIRE_FALSE(std::filesystem::exists(part + ".meta"));
+    }
+
+    SECTION("removePartFile deletes the sidecars too") {
+        preparePartFile(part, stream(1000), true);
+        writeBytes(part, 1000);
+        writeBytes(part + ".idx", 16);
+        removePartFile(part);
+        REQUIRE_FALSE(std::filesystem::exists(part));
+        REQUIRE_FALSE(std::filesystem::exists(part + ".idx"));
+        REQUIRE_FALSE(std::filesystem::exists(part + ".meta"));
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * PlaybackTelemetry Unit Tests
+ *
+ * Tests classification of device writes into underruns and late writes,
+ * max queue depth tracking, wait-time accumulation and reset.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/playback_telemetry.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using audio::PlaybackTelemetry;
+
+TEST_CASE("PlaybackTelemetry device writes", "[PlaybackTelemetry]") {
+    PlaybackTelemetry telemetry;
+
+    SECTION("First write after start is not a glitch") {
+        telemetry.recordDeviceWrite(0, 1000, 1000, false);
+        auto s = telemetry.snapshot();
+        REQUIRE(s.bufferUnderruns == 0);
+        REQUIRE(s.lateWrites == 0);
+        REQUIRE(s.framesQueued == 1000);
+    }
+
+    SECTION("Empty buffer is an underrun, nearly empty a late write") {
+        telemetry.recordDeviceWrite(0, 1000, 480, true);
+        telemetry.recordDeviceWrite(100, 1000, 480, true);
+        telemetry.recordDeviceWrite(600, 1000, 400, true);
+        auto s = telemetry.snapshot();
+        REQUIRE(s.bufferUnderruns == 1);
+        REQUIRE(s.lateWrites == 1);
+        REQUIRE(s.framesQueued == 1360);
+    }
+}
+
+TEST_CASE("PlaybackTelemetry depth and wait times", "[PlaybackTelemetry]") {
+    PlaybackTelemetry telemetry;
+
+    SECTION("Queue depth keeps the maximum") {
+        telemetry.recordQueueDepth(10, 200);
+        telemetry.recordQueueDepth(40, 900);
+        telemetry.recordQueueDepth(5, 100);
+        auto s = telemetry.snapshot();
+        REQUIRE(s.maxQueueDepthFrames == 40);
+        REQUIRE(s.maxQueueDepthMs == 900);
+    }
+
+    SECTION("Wait times accumulate in microseconds") {
+        telemetry.addDecoderStall(std::chrono::milliseconds(3));
+        telemetry.addDecoderStall(std::chrono::microseconds(500));
+        telemetry.addNetworkWait(std::chrono::milliseconds(7));
+        telemetry.addNetworkWait(std::chrono::microseconds(-5));  // clock hiccup, ignored
+        auto s = telemetry.snapshot();
+        REQUIRE(s.decoderStallUs == 3500);
+        REQUIRE(s.networkWaitUs == 7000);
+    }
+
+    SECTION("Concurrent recorders don't lose updates") {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&telemetry, t]() {
+                for (int i = 0; i < 1000; ++i) {
+                    telemetry.recordDeviceWrite(0, 100, 1, true);
+                    telemetry.recordQueueDepth(static_cast<uint64_t>(t * 1000 + i), t * 1000 + i);
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        auto s = telemetry.snapshot();
+        REQUIRE(s.bufferUnderruns == 4000);
+        REQUIRE(s.framesQueued == 4000);
+        REQUIRE(s.maxQueueDepthFrames == 3999);
+        REQUIRE(s.maxQueueDepthMs == 3999);
+    }
+
+    SECTION("reset clears every counter") {
+        telemetry.recordDeviceWrite(0, 100, 10, true);
+        telemetry.recordQueueDepth(3, 30);
+        telemetry.addNetworkWait(std::chrono::milliseconds(1));
+        telemetry.reset();
+        auto s = telemetry.snapshot();
+        REQUIRE(s.bufferUnderruns == 0);
+        REQUIRE(s.framesQueued == 0);
+        REQUIRE(s.maxQueueDepthFrames == 0);
+        REQUIRE(s.networkWaitUs == 0);
+    }
+}
@@ -3,12 +3,15 @@
 #include "test_utils.h"
 #include <filesystem>
 #include <iostream>
+#include <chrono>
+#include <thread>
 #include <QUrl>
 #include <QFile>
 #include <QIODevice>
 
 #include "config/config_manager.h"
 #include "playlist/playlist_manager.h"
+#include <network/platform/i_platform.h>
 
 using namespace playlist;
 
@@ -107,3 +110,50 @@ TEST_CASE("PlaylistManager adds local media to playlist", "[playlist][local]") {
     QDir d(QString::fromStdString(folder));
     d.removeRecursively();
 }
+
+TEST_CASE("PlaylistManager imports a local folder", "[playlist][local]") {
+    testutils::ensureQCoreApplication();
+
+    auto tmp = std::filesystem::temp_directory_path();
+    auto stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    QDir root(QString::fromStdString((tmp / (std::string("BilibiliPlayerTest_folder_") + stamp)).string()));
+    QDir().mkpath(root.filePath("music/album"));
+
+    // Five audio files, two of them a level down, and a file that isn't audio
+    const QStringList names = { "music/a.mp3", "music/b.flac", "music/c.ogg", "music/album/d.mp3", "music/album/e.wav", "music/notes.txt" };
+    for (const QString& name : names) {
+        QFile file(root.filePath(name));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write("dummy data");
+    }
+
+    ConfigManager cfg;
+    cfg.initialize(root.absolutePath());
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    auto current = mgr.getCurrentPlaylist();
+    REQUIRE(current.isNull() == false);
+    const int before = mgr.songsSnapshot(current).size();
+
+    REQUIRE(mgr.importLocalFolder(root.filePath("music"), current));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (mgr.isImportingLocalFolder() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    REQUIRE_FALSE(mgr.isImportingLocalFolder());
+
+    const QList<SongInfo> songs = mgr.songsSnapshot(current);
+    REQUIRE(songs.size() == before + 5);
+    QStringList titles;
+    for (const SongInfo& song : songs.mid(before)) {
+        titles << song.title;
+        REQUIRE(song.platform == static_cast<int>(network::PlatformType::Local));
+    }
+    REQUIRE(titles == QStringList({ "a", "d", "e", "b", "c" }));     // In path order
+
+    SECTION("an unknown playlist is refused") {
+        REQUIRE_FALSE(mgr.importLocalFolder(root.filePath("music"), QUuid::createUuid()));
+    }
+
+    root.removeRecursively();
+}
@@ -209,6 +209,260 @@ TEST_CASE("PlaylistManager: save and load JSON roundtrip", "[playlist_manager][j
     REQUIRE(found == true);
 }
 
+TEST_CASE("PlaylistManager: saves append changes to a journal", "[playlist_manager][json]") {
+    TempWorkspace tw("pm_journal_test");
+    QString ws = tw.path();
+    ConfigManager cfg;
+    cfg.initialize(ws);
+    const QString snapshotPath = QDir(ws).absoluteFilePath(cfg.getCategoriesFilePath());
+    const QString journalPath = snapshotPath + ".journal";
+    auto readAll = [](const QString& path) {
+        QFile f(path);
+        return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+    };
+    auto titles = [](PlaylistManager& m, const QUuid& playlistId) {
+        QStringList result;
+        m.iterateSongsInPlaylist(playlistId, [&](const playlist::SongInfo& song) { result << song.title; return true; });
+        return result;
+    };
+
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    const QUuid defaultPlaylist = mgr.getCurrentPlaylist();
+
+    // The first save writes the snapshot
+    mgr.saveAllCategories();
+    const QByteArray snapshot = readAll(snapshotPath);
+    REQUIRE_FALSE(snapshot.isEmpty());
+    REQUIRE_FALSE(QFile::exists(journalPath));
+
+    playlist::CategoryInfo cat;
+    cat.name = "Journal Cat";
+    cat.uuid = QUuid::createUuid();
+    REQUIRE(mgr.addCategory(cat));
+    playlist::PlaylistInfo pl;
+    pl.name = "Journal Playlist";
+    pl.uuid = QUuid::createUuid();
+    REQUIRE(mgr.addPlaylist(pl, cat.uuid));
+
+    playlist::SongInfo a;
+    a.title = "A";
+    a.platform = 1;
+    a.args = "a";
+    a.uuid = QUuid::createUuid();
+    playlist::SongInfo b = a;
+    b.title = "B";
+    b.args = "b";
+    b.uuid = QUuid::createUuid();
+    REQUIRE(mgr.addSongToPlaylist(a, pl.uuid));
+    REQUIRE(mgr.addSongToPlaylist(b, pl.uuid));
+    a.title = "A renamed";
+    REQUIRE(mgr.updateSongInPlaylist(a, pl.uuid));
+    REQUIRE(mgr.removeSongFromPlaylist(b, pl.uuid));
+    mgr.setCurrentPlaylist(pl.uuid);
+
+    // Later saves leave the snapshot alone and append the changes
+    mgr.saveAllCategories();
+    REQUIRE(readAll(snapshotPath) == snapshot);
+    REQUIRE(QFile::exists(journalPath));
+
+    SECTION("a new manager replays the journal") {
+        PlaylistManager mgr2(&cfg);
+        REQUIRE(mgr2.loadCategoriesFromFile());
+        REQUIRE(mgr2.getCategory(cat.uuid).has_value());
+        REQUIRE(mgr2.getPlaylist(pl.uuid).has_value());
+        REQUIRE(mgr2.getPlaylist(defaultPlaylist).has_value());
+        REQUIRE(titles(mgr2, pl.uuid) == QStringList{ "A renamed" });
+    }
+
+    SECTION("a record cut short is skipped") {
+        {
+            QFile f(journalPath);
+            REQUIRE(f.open(QIODevice::Append));
+            f.write("{\"op\":\"addSo");
+        }
+        playlist::SongInfo c = a;
+        c.title = "C";
+        c.args = "c";
+        c.uuid = QUuid::createUuid();
+        REQUIRE(mgr.addSongToPlaylist(c, pl.uuid));
+        mgr.saveAllCategories();
+
+        PlaylistManager mgr2(&cfg);
+        REQUIRE(mgr2.loadCategoriesFromFile());
+        REQUIRE(titles(mgr2, pl.uuid) == QStringList{ "A renamed", "C" });
+    }
+}
+
+TEST_CASE("PlaylistManager: loads songs when a playlist is first used", "[playlist_manager][json]") {
+    TempWorkspace tw("pm_lazy_test");
+    QString ws = tw.path();
+    ConfigManager cfg;
+    cfg.initialize(ws);
+    auto titles = [](PlaylistManager& m, const QUuid& playlistId) {
+        QStringList result;
+        m.iterateSongsInPlaylist(playlistId, [&](const playlist::SongInfo& song) { result << song.title; return true; });
+        return result;
+    };
+    auto makeSong = [](const QString& title) {
+        playlist::SongInfo song;
+        song.title = title;
+        song.platform = 1;
+        song.args = title.toLower();
+        song.uuid = QUuid::createUuid();
+        return song;
+    };
+
+    playlist::PlaylistInfo first;
+    first.name = "First";
+    first.uuid = QUuid::createUuid();
+    playlist::PlaylistInfo second = first;
+    second.name = "Second";
+    second.uuid = QUuid::createUuid();
+    const playlist::SongInfo a = makeSong("A");
+    const playlist::SongInfo b = makeSong("B");
+    {
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        const QUuid categoryId = mgr.iterateCategories([](const playlist::CategoryInfo&) { return true; }).first().uuid;
+        REQUIRE(mgr.addPlaylist(first, categoryId));
+        REQUIRE(mgr.addPlaylist(second, categoryId));
+        REQUIRE(mgr.addSongToPlaylist(a, first.uuid));
+        REQUIRE(mgr.addSongToPlaylist(b, second.uuid));
+        mgr.saveAllCategories();    // Snapshot with the songs
+        // Journal records for songs in the snapshot
+        REQUIRE(mgr.addSongToPlaylist(makeSong("C"), second.uuid));
+        REQUIRE(mgr.setSongLoudness(b.uuid, -3.5f));
+        mgr.saveAllCategories();
+    }
+
+    // Songs still in the snapshot get the journal records replayed for them once read
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    REQUIRE(mgr.getPlaylist(second.uuid).has_value());
+    REQUIRE(titles(mgr, second.uuid) == QStringList{ "B", "C" });
+    auto analyzed = mgr.iterateSongsInPlaylist(second.uuid, [](const playlist::SongInfo& song) { return song.loudnessAnalyzed; });
+    REQUIRE(analyzed.size() == 1);
+    REQUIRE(analyzed.first().uuid == b.uuid);
+    REQUIRE(analyzed.first().loudnessGainDb == -3.5f);
+    REQUIRE(mgr.getNextSong(a.uuid, first.uuid, playlist::PlayMode::PlaylistLoop) == a.uuid);
+
+
+    SECTION("rewriting the snapshot reads the songs not used yet") {
+        PlaylistManager mgr2(&cfg);
+        mgr2.initialize();
+        REQUIRE(QFile::remove(QDir(ws).absoluteFilePath(cfg.getCategoriesFilePath())));
+        mgr2.saveAllCategories();
+
+        PlaylistManager mgr3(&cfg);
+        REQUIRE(mgr3.loadCategoriesFromFile());
+        REQUIRE(titles(mgr3, first.uuid) == QStringList{ "A" });
+        REQUIRE(titles(mgr3, second.uuid) == QStringList{ "B", "C" });
+    }
+}
+
+TEST_CASE("PlaylistManager: adds and removes songs in batches", "[playlist_manager][songs]") {
+    TempWorkspace tw("pm_batch_test");
+    ConfigManager cfg;
+    cfg.initialize(tw.path());
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    const QUuid playlistId = mgr.getCurrentPlaylist();
+    REQUIRE_FALSE(playlistId.isNull());
+
+    int batchSignals = 0;
+    int songSignals = 0;
+    int firstAdded = -1;
+    QList<playlist::SongInfo> removedSongs;
+    QObject::connect(&mgr, &PlaylistManager::songsAdded, [&](const QList<playlist::SongInfo>&, const QUuid&, int first) {
+        ++batchSignals;
+        firstAdded = first;
+    });
+    QObject::connect(&mgr, &PlaylistManager::songsRemoved, [&](const QList<playlist::SongInfo>& songs, const QUuid&) {
+        ++batchSignals;
+        removedSongs = songs;
+    });
+    QObject::connect(&mgr, &PlaylistManager::songAdded, [&](const playlist::SongInfo&, const QUuid&) { ++songSignals; });
+    QObject::connect(&mgr, &PlaylistManager::songRemoved, [&](const playlist::SongInfo&, const QUuid&) { ++songSignals; });
+
+    QList<playlist::SongInfo> songs;
+    for (int i = 0; i < 5; ++i) {
+        playlist::SongInfo song;
+        song.title = QString("Batch %1").arg(i);
+        song.platform = 1;
+        song.args = QString("bv%1").arg(i);
+        song.uuid = QUuid::createUuid();
+        songs << song;
+    }
+    playlist::SongInfo noArgs = songs[0];
+    noArgs.args.clear();
+    noArgs.uuid = QUuid::createUuid();
+
+    // Songs that can't be added are left out of the batch
+    REQUIRE(mgr.addSongsToPlaylist(QList<playlist::SongInfo>(songs) << noArgs, playlistId) == 5);
+    REQUIRE(batchSignals == 1);
+    REQUIRE(songSignals == 0);
+    REQUIRE(firstAdded == 0);
+    REQUIRE(mgr.getSongFromPlaylist(songs[3].uuid, playlistId).has_value());
+    REQUIRE(mgr.getNextSong(songs[3].uuid, playlistId, playlist::PlayMode::PlaylistLoop) == songs[4].uuid);
+
+    // Removal keeps the order of the rest and the index in step
+    REQUIRE(mgr.removeSongsFromPlaylist({ songs[1], songs[3], noArgs }, playlistId) == 2);
+    REQUIRE(batchSignals == 2);
+    REQUIRE(songSignals == 0);
+    REQUIRE(removedSongs.size() == 2);
+    QStringList titles;
+    mgr.iterateSongsInPlaylist(playlistId, [&](const playlist::SongInfo& song) { titles << song.title; return true; });
+    REQUIRE(titles == QStringList{ "Batch 0", "Batch 2", "Batch 4" });
+    REQUIRE(mgr.getNextSong(songs[2].uuid, playlistId, playlist::PlayMode::PlaylistLoop) == songs[4].uuid);
+    REQUIRE_FALSE(mgr.getSongFromPlaylist(songs[3].uuid, playlistId).has_value());
+
+    // Both batches reach the journal
+    mgr.saveAllCategories();
+    PlaylistManager reloaded(&cfg);
+    REQUIRE(reloaded.loadCategoriesFromFile());
+    QStringList reloadedTitles;
+    reloaded.iterateSongsInPlaylist(playlistId, [&](const playlist::SongInfo& song) { reloadedTitles << song.title; return true; });
+    REQUIRE(reloadedTitles == titles);
+}
+
+TEST_CASE("PlaylistManager: song snapshots stay as they were taken", "[playlist_manager][songs]") {
+    TempWorkspace tw("pm_snapshot_test");
+    ConfigManager cfg;
+    cfg.initialize(tw.path());
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    const QUuid playlistId = mgr.getCurrentPlaylist();
+
+    playlist::SongInfo song;
+    song.title = "First";
+    song.platform = 1;
+    song.args = "first";
+    song.uuid = QUuid::createUuid();
+    REQUIRE(mgr.addSongToPlaylist(song, playlistId));
+    const QList<playlist::SongInfo> before = mgr.songsSnapshot(playlistId);
+    REQUIRE(before.size() == 1);
+
+    // Changes show in later snapshots only
+    song.title = "Renamed";
+    REQUIRE(mgr.updateSongInPlaylist(song, playlistId));
+    playlist::SongInfo second = song;
+    second.title = "Second";
+    second.uuid = QUuid::createUuid();
+    REQUIRE(mgr.addSongToPlaylist(second, playlistId));
+    REQUIRE(before.size() == 1);
+    REQUIRE(before[0].title == "First");
+
+    const QList<playlist::SongInfo> after = mgr.songsSnapshot(playlistId);
+    REQUIRE(after.size() == 2);
+    REQUIRE(after[0].title == "Renamed");
+    REQUIRE(mgr.songsSnapshot(QUuid::createUuid()).isEmpty());
+
+    REQUIRE(mgr.removePlaylist(playlistId));
+    REQUIRE(mgr.songsSnapshot(playlistId).isEmpty());
+    REQUIRE(after.size() == 2);
+}
+
 TEST_CASE("PlaylistManager basic CRUD", "[playlist]") {
     int argc = 1;
     char arg0[] = "test";
@@ -0,0 +1,183 @@
+/**
+ * PrefetchScheduler Unit Tests
+ *
+ * Tests plan order, waiting for an idle network, interrupted jobs resuming,
+ * plan changes and release() stopping a running job, and the disk budget.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/prefetch_scheduler.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using network::PrefetchScheduler;
+using Outcome = PrefetchScheduler::Outcome;
+using namespace std::chrono_literals;
+
+namespace {
+    PrefetchScheduler::Item item(const std::string& path) {
+        PrefetchScheduler::Item result;
+        result.params = path;
+        result.savepath = path;
+        return result;
+    }
+
+    bool waitUntil(const std::function<bool()>& condition) {
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(5ms);
+        }
+        return true;
+    }
+
+    // Records the jobs it runs; each one "downloads" until done or stopped
+    struct FakeNetwork {
+        std::mutex mutex;
+        std::vector<std::string> started;
+        std::vector<std::string> finished;
+        std::atomic<bool> idle{true};
+        std::atomic<bool> hold{false};      // Keep jobs running until cleared or stopped
+        uint64_t size = 100;
+
+        PrefetchScheduler::Job job() {
+            return [this](const PrefetchScheduler::Item& it, uint64_t budgetLeft, const PrefetchScheduler::StopCheck& stop) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    started.push_back(it.savepath);
+                }
+                if (size > budgetLeft) {
+                    return PrefetchScheduler::Result{ Outcome::Skipped, 0 };
+                }
+                while (hold.load()) {
+                    if (stop()) {
+                        return PrefetchScheduler::Result{ Outcome::Interrupted, 0 };
+                    }
+                    std::this_thread::sleep_for(1ms);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(it.savepath);
+                return PrefetchScheduler::Result{ Outcome::Done, size };
+            };
+        }
+        PrefetchScheduler::IdleCheck idleCheck() {
+            return [this]() { return idle.load(); };
+        }
+        std::vector<std::string> startedCopy() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return started;
+        }
+        std::vector<std::string> finishedCopy() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return finished;
+        }
+    };
+}
+
+TEST_CASE("PrefetchScheduler fetches the plan in order", "[PrefetchScheduler]") {
+    FakeNetwork net;
+    PrefetchScheduler scheduler(net.job(), net.idleCheck());
+    scheduler.setPlan({ item("a"), item("b"), item("a"), item("c") });
+
+    REQUIRE(waitUntil([&]() { return net.finishedCopy().size() == 3; }));
+    REQUIRE(net.finishedCopy() == std::vector<std::string>{ "a", "b", "c" });
+    REQUIRE(scheduler.prefetchedBytes() == 300);
+
+    SECTION("prefetched items are not fetched again") {
+        scheduler.setPlan({ item("b"), item("c"), item("d") });
+        REQUIRE(waitUntil([&]() { return net.finishedCopy().size() == 4; }));
+        REQUIRE(net.finishedCopy().back() == "d");
+        // "a" fell out of the plan and no longer counts
+        REQUIRE(scheduler.prefetchedBytes() == 300);
+    }
+
+    SECTION("release() frees the budget") {
+        scheduler.release("a");
+        REQUIRE(scheduler.prefetchedBytes() == 200);
+    }
+}
+
+TEST_CASE("PrefetchScheduler waits for an idle network", "[PrefetchScheduler]") {
+    FakeNetwork net;
+    net.idle = false;
+    PrefetchScheduler scheduler(net.job(), net.idleCheck());
+    scheduler.setPlan({ item("a") });
+    std::this_thread::sleep_for(100ms);
+    REQUIRE(net.startedCopy().empty());
+    REQUIRE(scheduler.pendingCount() == 1);
+
+    net.idle = true;
+    REQUIRE(waitUntil([&]() { return net.finishedCopy().size() == 1; }));
+
+    SECTION("a busy network interrupts and the item resumes later") {
+        net.hold = true;
+        scheduler.setPlan({ item("b") });
+        REQUIRE(waitUntil([&]() { return scheduler.running() == "b"; }));
+        net.idle = false;
+        REQUIRE(waitUntil([&]() { return scheduler.running().empty(); }));
+        REQUIRE(scheduler.pendingCount() == 1);
+
+        net.hold = false;
+        net.idle = true;
+        REQUIRE(waitUntil([&]() { return net.finishedCopy().size() == 2; }));
+        REQUIRE(net.startedCopy() == std::vector<std::string>{ "a", "b", "b" });
+    }
+}
+
+TEST_CASE("PrefetchScheduler stops jobs that are no longer wanted", "[PrefetchScheduler]") {
+    FakeNetwork net;
+    net.hold = true;
+    PrefetchScheduler scheduler(net.job(), net.idleCheck());
+    scheduler.setPlan({ item("a"), item("b") });
+    REQUIRE(waitUntil([&]() { return scheduler.running() == "a"; }));
+
+    SECTION("release() returns once the job has stopped") {
+        scheduler.release("a");
+        REQUIRE(scheduler.running() != "a");
+        REQUIRE(waitUntil([&]() { return scheduler.running() == "b"; }));
+        REQUIRE(scheduler.prefetchedBytes() == 0);
+    }
+
+    SECTION("a new plan without the running item stops it") {
+        scheduler.setPlan({ item("c") });
+        REQUIRE(waitUntil([&]() { return scheduler.running() == "c"; }));
+        REQUIRE(scheduler.pendingCount() == 0);
+    }
+
+    SECTION("a new plan with the running item keeps it going") {
+        scheduler.setPlan({ item("a"), item("c") });
+        std::this_thread::sleep_for(50ms);
+        REQUIRE(scheduler.running() == "a");
+        REQUIRE(scheduler.pendingCount() == 1);
+        net.hold = false;
+        REQUIRE(waitUntil([&]() { return net.finishedCopy().size() == 2; }));
+        REQUIRE(net.finishedCopy() == std::vector<std::string>{ "a", "c" });
+    }
+
+    SECTION("shutdown() stops the running job") {
+        scheduler.shutdown();
+        REQUIRE(scheduler.running().empty());
+        REQUIRE(net.finishedCopy().empty());
+    }
+}
+
+TEST_CASE("PrefetchScheduler keeps to its disk budget", "[PrefetchScheduler]") {
+    FakeNetwork net;
+    PrefetchScheduler scheduler(net.job(), net.idleCheck());
+    scheduler.setDiskBudget(250);
+    scheduler.setPlan({ item("a"), item("b"), item("c"), item("d") });
+
+    REQUIRE(waitUntil([&]() { return scheduler.pendingCount() == 0 && scheduler.running().empty(); }));
+    REQUIRE(net.finishedCopy() == std::vector<std::string>{ "a", "b" });
+    REQUIRE(scheduler.prefetchedBytes() == 200);
+
+    // Playing "a" frees room for the next one
+    scheduler.release("a");
+    scheduler.setPlan({ item("b"), item("c") });
+    REQUIRE(waitUntil([&]() { return net.finishedCopy().size() == 3; }));
+    REQUIRE(net.finishedCopy().back() == "c");
+}
@@ -4,6 +4,9 @@
 #include <chrono>
 #include <algorithm>
 #include <cstdlib>
+#include <atomic>
+#include <filesystem>
+#include <string>
 #include <stream/realtime_pipe.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
@@ -257,4 +260,120 @@ TEST_CASE("RealtimePipe with random data patterns", "[RealtimePipe]") {
         }
     }
     CHECK(dataMatches);
-}
\ No newline at end of file
+}
+TEST_CASE("RealtimePipe direct write/read bypasses iostreams", "[RealtimePipe]") {
+    const size_t capacity = 1024;
+    RealtimePipe pipe(capacity);
+
+    std::vector<char> data(capacity * 8);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>((i * 7) & 0xFF);
+    }
+
+    std::thread writer([&]() {
+        // Larger than the ring: write() blocks until the reader makes room
+        CHECK(pipe.write(data.data(), data.size()) == data.size());
+        pipe.closeOutput();
+    });
+
+    std::vector<char> received;
+    char chunk[300];
+    size_t got = 0;
+    while ((got = pipe.read(chunk, sizeof(chunk))) > 0) {
+        CHECK(got <= sizeof(chunk));
+        received.insert(received.end(), chunk, chunk + got);
+    }
+    writer.join();
+
+    CHECK(received == data);
+    CHECK(pipe.available() == 0);
+}
+
+TEST_CASE("RealtimePipe character reads and writes", "[RealtimePipe]") {
+    RealtimePipe pipe(64);
+    auto in = pipe.getInputStream();
+    auto out = pipe.getOutputStream();
+
+    out->put('a');
+    *out << "bc";
+    out.reset();
+
+    CHECK(in->get() == 'a');
+    CHECK(in->peek() == 'b');
+    std::string rest;
+    *in >> rest;
+    CHECK(rest == "bc");
+    CHECK(in->eof());
+}
+
+TEST_CASE("RealtimePipe spills to a temporary file when the ring is full", "[RealtimePipe]") {
+    const size_t capacity = 1024;
+    const std::string tempDir = std::filesystem::temp_directory_path().string();
+
+    std::vector<char> data(capacity * 16);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>((i * 11 + 3) & 0xFF);
+    }
+
+    SECTION("Writer never blocks and the reader sees one ordered stream") {
+        RealtimePipe pipe(capacity);
+        REQUIRE(pipe.enableSpill(tempDir, 1024 * 1024));
+
+        // No reader yet: everything beyond the ring lands in the spill file
+        REQUIRE(pipe.write(data.data(), data.size()) == data.size());
+        REQUIRE(pipe.available() == data.size());
+        REQUIRE(pipe.spilledBytes() == data.size() - capacity);
+
+        std::vector<char> received(data.size());
+        size_t total = 0;
+        while (total < data.size() / 2) {
+            total += pipe.read(received.data() + total, 700);
+        }
+        // More data while the spill is still being drained goes behind it
+        REQUIRE(pipe.write(data.data(), capacity) == capacity);
+        pipe.closeOutput();
+
+        received.resize(data.size() + capacity);
+        size_t got = 0;
+        while ((got = pipe.read(received.data() + total, 700)) > 0) {
+            total += got;
+        }
+        REQUIRE(total == data.size() + capacity);
+        REQUIRE(std::equal(data.begin(), data.end(), received.begin()));
+        REQUIRE(std::equal(data.begin(), data.begin() + capacity, received.begin() + data.size()));
+        REQUIRE(pipe.spilledBytes() == 0);
+    }
+
+    SECTION("Writer blocks once the spill limit is reached") {
+        RealtimePipe pipe(capacity);
+        REQUIRE(pipe.enableSpill(tempDir, capacity * 2));
+
+        std::atomic<size_t> written{0};
+        std::thread writer([&]() {
+            written = pipe.write(data.data(), data.size());
+            pipe.closeOutput();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        REQUIRE(written.load() == 0);
+        REQUIRE(pipe.spilledBytes() == capacity * 2);
+
+        auto in = pipe.getInputStream();
+        std::vector<char> received(data.size());
+        in->read(received.data(), static_cast<std::streamsize>(received.size()));
+        writer.join();
+        REQUIRE(in->gcount() == static_cast<std::streamsize>(data.size()));
+        REQUIRE(written.load() == data.size());
+        REQUIRE(received == data);
+    }
+
+    SECTION("Closing the reader releases a writer waiting on a full spill") {
+        RealtimePipe pipe(capacity);
+        REQUIRE(pipe.enableSpill(tempDir, capacity));
+        std::thread writer([&]() {
+            CHECK(pipe.write(data.data(), data.size()) == capacity * 2);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        pipe.close();
+        writer.join();
+    }
+}
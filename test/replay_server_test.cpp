@@ -0,0 +1,136 @@
+/**
+ * ReplayServer Unit Tests
+ *
+ * Tests that recorded responses are picked by their query parameters, that ranges and
+ * shaping apply, and that BilibiliPlatform redirected to it searches and resolves audio
+ * offline from data/replay/bilibili_search.json, expanding a result into all parts of
+ * its video as well.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/platform/bili_network_interface.h>
+#include <util/replay_server.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using testutils::ReplayServer;
+using namespace std::chrono_literals;
+
+TEST_CASE("ReplayServer answers with the most specific recorded response", "[ReplayServer]") {
+    ReplayServer server("https://api.example.com");
+    server.addResponse("/x/list", {}, 200, "text/plain", "any");
+    server.addResponse("/x/list", { { "id", "1" } }, 200, "text/plain", "one");
+    server.addResponse("/x/list", { { "id", "1" }, { "page", "2" } }, 200, "text/plain", "one, page 2");
+    server.addResponse("/x/body", {}, 200, "application/octet-stream", "0123456789");
+    REQUIRE(server.start());
+    httplib::Client client(server.origin());
+
+    auto get = [&client](const std::string& path) {
+        auto res = client.Get(path);
+        REQUIRE(res);
+        return res->status == 200 ? res->body : std::to_string(res->status);
+    };
+    REQUIRE(get("/x/list?other=3") == "any");
+    REQUIRE(get("/x/list?id=1&wts=1700000000&w_rid=abc") == "one");
+    REQUIRE(get("/x/list?page=2&id=1") == "one, page 2");
+    REQUIRE(get("/x/missing") == "404");
+    REQUIRE(server.requestCount() == 4);
+    REQUIRE(server.missCount() == 1);
+
+    const httplib::Headers range = { { "Range", "bytes=2-5" } };
+    auto ranged = client.Get("/x/body", range);
+    REQUIRE(ranged);
+    REQUIRE(ranged->status == 206);
+    REQUIRE(ranged->body == "2345");
+}
+
+TEST_CASE("ReplayServer delays and paces responses", "[ReplayServer]") {
+    ReplayServer server("https://cdn.example.com");
+    server.addResponse("/blob", {}, 200, "application/octet-stream", std::string(64 * 1024, 'x'));
+    REQUIRE(server.start());
+    // 50 ms before the response, then 64 KiB at 256 KiB/s takes about 250 ms more
+    server.setShaping({ 50ms, 256 * 1024 });
+    httplib::Client client(server.origin());
+
+    const auto start = std::chrono::steady_clock::now();
+    auto res = client.Get("/blob");
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(res);
+    REQUIRE(res->body.size() == 64 * 1024);
+    REQUIRE(elapsed >= 250ms);
+    REQUIRE(elapsed < 5s);
+}
+
+TEST_CASE("BilibiliPlatform searches and resolves audio from replayed responses", "[ReplayServer][BilibiliPlatform]") {
+    ReplayServer api("https://api.bilibili.com");
+    REQUIRE(api.loadFixture("data/replay/bilibili_search.json"));
+    REQUIRE(api.start());
+    auto platform = std::make_shared<network::BilibiliPlatform>();
+    platform->test_redirect_hosts({ { "https://api.bilibili.com", api.origin() } });
+    platform->test_seed_wbi_keys("7cd084941338484aae1ad9425b84077c", "4932caff0ff746eab6f01bf08b70ac45",
+                                 std::chrono::system_clock::now());
+
+    std::vector<network::SearchResult> results;
+    const size_t delivered = platform->searchByTitle("bad apple", 1, [&results](std::vector<network::SearchResult>&& batch) {
+        for (auto& result : batch) {
+            results.push_back(std::move(result));
+        }
+        return true;
+    });
+    // Four videos, one of them with three parts, in rank order
+    REQUIRE(delivered == 6);
+    REQUIRE(results.size() == 6);
+    REQUIRE(results.front().title == "Bad Apple!! PV - Bad Apple!!");
+    REQUIRE(results.front().interfaceData == "bvid=BV1xx411c7mD&cid=3724723");
+    REQUIRE(results[2].interfaceData == "bvid=BV1GJ411x7h7&cid=1176840");
+    REQUIRE(results.back().interfaceData == "bvid=BV1Wx411d7Mq&cid=8837201");
+
+    const std::string url = platform->getAudioUrlByParams(results.front().interfaceData.toStdString());
+    REQUIRE(url == "https://upos-sz-mirrorcos.bilivideo.com/upgcxcode/replay/tone.wav?deadline=4102444800");
+    REQUIRE(api.missCount() == 0);
+}
+
+TEST_CASE("BilibiliPlatform expands a result into all parts of its video", "[ReplayServer][BilibiliPlatform]") {
+    ReplayServer api("https://api.bilibili.com");
+    REQUIRE(api.loadFixture("data/replay/bilibili_search.json"));
+    REQUIRE(api.start());
+    auto platform = std::make_shared<network::BilibiliPlatform>();
+    platform->test_redirect_hosts({ { "https://api.bilibili.com", api.origin() } });
+    platform->test_seed_wbi_keys("7cd084941338484aae1ad9425b84077c", "4932caff0ff746eab6f01bf08b70ac45",
+                                 std::chrono::system_clock::now());
+
+    const network::SearchResult second{
+        .title = "Bad Apple!! full album - part 2",
+        .uploader = "replay_uploader_3",
+        .platform = network::PlatformType::Bilibili,
+        .duration = 245000,
+        .coverUrl = "https://i0.hdslb.com/bfs/archive/replay_3.jpg",
+        .description = "All parts",
+        .interfaceData = "bvid=BV1GJ411x7h7&cid=1176841"
+    };
+    const auto parts = platform->videoParts(second, 2);
+    REQUIRE(parts.size() == 3);
+    REQUIRE(parts.front().title == "Bad Apple!! full album - part 1");
+    REQUIRE(parts.front().interfaceData == "bvid=BV1GJ411x7h7&cid=1176840");
+    REQUIRE(parts.back().title == "Bad Apple!! full album - part 3");
+    REQUIRE(parts.back().duration == 242000);
+    REQUIRE(parts.back().uploader == second.uploader);
+    // One page list lookup and a playurl for each of the first two parts
+    REQUIRE(api.requestCount() == 3);
+
+    // The prewarmed parts start without another round-trip
+    const std::string album = "https://upos-sz-mirrorcos.bilivideo.com/upgcxcode/replay/album.wav?deadline=4102444800";
+    REQUIRE(platform->getAudioUrlByParams(parts[1].interfaceData.toStdString()) == album);
+    REQUIRE(api.requestCount() == 3);
+    REQUIRE(platform->getAudioUrlByParams(parts[2].interfaceData.toStdString()) == album);
+    REQUIRE(api.requestCount() == 4);
+    REQUIRE(api.missCount() == 0);
+
+    SECTION("a result that isn't a Bilibili part gives nothing") {
+        network::SearchResult local = second;
+        local.interfaceData = "/music/song.flac";
+        REQUIRE(platform->videoParts(local, 2).empty());
+    }
+}
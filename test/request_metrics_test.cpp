@@ -0,0 +1,136 @@
+/**
+ * RequestMetrics Unit Tests
+ *
+ * Tests the histogram's precision and percentiles, and that the Timer files
+ * its phases, failures and new connections under the right endpoint.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/request_metrics.h>
+#include <chrono>
+#include <thread>
+
+using network::LatencyHistogram;
+using network::RequestMetrics;
+using namespace std::chrono_literals;
+
+TEST_CASE("LatencyHistogram records values", "[RequestMetrics]") {
+    LatencyHistogram histogram;
+
+    SECTION("empty") {
+        REQUIRE(histogram.count() == 0);
+        REQUIRE(histogram.percentile(50) == 0);
+        REQUIRE(histogram.min() == 0);
+        REQUIRE(histogram.mean() == 0.0);
+    }
+
+    SECTION("small values are exact") {
+        for (uint64_t v = 0; v < 8; ++v) {
+            histogram.record(v);
+        }
+        REQUIRE(histogram.count() == 8);
+        REQUIRE(histogram.percentile(50) == 3);
+        REQUIRE(histogram.percentile(100) == 7);
+        REQUIRE(histogram.min() == 0);
+        REQUIRE(histogram.max() == 7);
+    }
+
+    SECTION("large values stay within an eighth") {
+        const uint64_t values[] = { 9, 100, 1'000, 123'456, 10'000'000'000ull };
+        for (uint64_t v : values) {
+            LatencyHistogram single;
+            single.record(v);
+            single.record(v * 2);   // So percentile(50) isn't clamped to max()
+            const uint64_t reported = single.percentile(50);
+            REQUIRE(reported >= v);
+            REQUIRE(reported - v <= v / 8);
+        }
+    }
+
+    SECTION("percentiles follow the distribution") {
+        for (uint64_t v = 1; v <= 1000; ++v) {
+            histogram.record(v);
+        }
+        REQUIRE(histogram.percentile(50) >= 500);
+        REQUIRE(histogram.percentile(50) <= 500 + 500 / 8);
+        REQUIRE(histogram.percentile(99) >= 990);
+        REQUIRE(histogram.percentile(100) == 1000);
+        REQUIRE(histogram.mean() == 500.5);
+    }
+
+    SECTION("merge adds counts") {
+        LatencyHistogram other;
+        histogram.record(10);
+        other.record(1000);
+        other.record(2);
+        histogram.merge(other);
+        REQUIRE(histogram.count() == 3);
+        REQUIRE(histogram.min() == 2);
+        REQUIRE(histogram.max() == 1000);
+    }
+
+    SECTION("the largest values fit") {
+        histogram.record(UINT64_MAX);
+        REQUIRE(histogram.percentile(50) == UINT64_MAX);
+    }
+}
+
+TEST_CASE("RequestMetrics aggregates by endpoint", "[RequestMetrics]") {
+    RequestMetrics metrics;
+
+    SECTION("a timer records its phases") {
+        {
+            RequestMetrics::Timer timer(metrics, "https://api.example.com/x");
+            std::this_thread::sleep_for(2ms);
+            timer.leased(true);
+            std::this_thread::sleep_for(2ms);
+            timer.firstByte();
+            timer.received(100);
+            timer.received(50);
+            timer.succeeded();
+        }
+        const auto stats = metrics.snapshot();
+        REQUIRE(stats.size() == 1);
+        REQUIRE(stats[0].endpoint == "https://api.example.com/x");
+        REQUIRE(stats[0].requests == 1);
+        REQUIRE(stats[0].failures == 0);
+        REQUIRE(stats[0].newConnections == 1);
+        REQUIRE(stats[0].bytes == 150);
+        REQUIRE(stats[0].wait.min() >= 2000);
+        REQUIRE(stats[0].firstByte.count() == 0);
+        REQUIRE(stats[0].firstByteNewConnection.min() >= 2000);
+        REQUIRE(stats[0].total.min() >= 4000);
+    }
+
+    SECTION("unfinished timers count as failures") {
+        {
+            RequestMetrics::Timer timer(metrics, "a");
+            timer.leased(false);
+            timer.retried();
+        }
+        {
+            RequestMetrics::Timer timer(metrics, "a");
+            timer.leased(false);
+            timer.firstByte();
+            timer.succeeded();
+        }
+        const auto stats = metrics.snapshot();
+        REQUIRE(stats[0].requests == 2);
+        REQUIRE(stats[0].failures == 1);
+        REQUIRE(stats[0].retries == 1);
+        REQUIRE(stats[0].newConnections == 0);
+        REQUIRE(stats[0].firstByte.count() == 1);
+    }
+
+    SECTION("endpoints are kept apart and sorted") {
+        { RequestMetrics::Timer timer(metrics, "b"); }
+        { RequestMetrics::Timer timer(metrics, "a"); }
+        { RequestMetrics::Timer timer(metrics, "b"); }
+        const auto stats = metrics.snapshot();
+        REQUIRE(stats.size() == 2);
+        REQUIRE(stats[0].endpoint == "a");
+        REQUIRE(stats[1].requests == 2);
+        metrics.reset();
+        REQUIRE(metrics.snapshot().empty());
+    }
+}
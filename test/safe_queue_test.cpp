@@ -1,7 +1,8 @@
 /**
  * SafeQueue Utility Unit Tests
  * 
- * Tests thread-safe queue operations and concurrent access.
+ * Tests thread-safe queue operations and concurrent access, move-only items,
+ * batch draining, timed waits and closing.
  */
 
 #include <catch2/catch_test_macros.hpp>
@@ -10,6 +11,8 @@
 #include <vector>
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <string>
 
 TEST_CASE("SafeQueue basic operations", "[SafeQueue]") {
     SECTION("Enqueue and dequeue single item") {
@@ -284,3 +287,88 @@ TEST_CASE("SafeQueue with custom types", "[SafeQueue]") {
         REQUIRE(retrieved == data);
     }
 }
+
+TEST_CASE("SafeQueue moves items in and out", "[SafeQueue]") {
+    SafeQueue<std::unique_ptr<int>> queue;
+
+    REQUIRE(queue.enqueue(std::make_unique<int>(1)));
+    REQUIRE(queue.emplace(new int(2)));
+
+    std::unique_ptr<int> value;
+    REQUIRE(queue.dequeue(value));
+    REQUIRE(*value == 1);
+    REQUIRE(queue.waitAndDequeue(value));
+    REQUIRE(*value == 2);
+}
+
+TEST_CASE("SafeQueue drains batches", "[SafeQueue]") {
+    SafeQueue<std::string> queue;
+    for (int i = 0; i < 5; ++i) {
+        queue.enqueue(std::to_string(i));
+    }
+
+    std::vector<std::string> batch;
+    REQUIRE(queue.drainTo(batch, 3) == 3);
+    REQUIRE(batch == std::vector<std::string>{ "0", "1", "2" });
+    REQUIRE(queue.size() == 2);
+
+    // Appends to what the container holds
+    REQUIRE(queue.drainTo(batch) == 2);
+    REQUIRE(batch.size() == 5);
+    REQUIRE(batch.back() == "4");
+    REQUIRE(queue.drainTo(batch) == 0);
+}
+
+TEST_CASE("SafeQueue timed wait", "[SafeQueue]") {
+    SafeQueue<int> queue;
+    int value = 0;
+
+    SECTION("times out on an empty queue") {
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE_FALSE(queue.waitFor(value, std::chrono::milliseconds(30)));
+        REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(25));
+    }
+
+    SECTION("returns an item enqueued meanwhile") {
+        std::thread producer([&queue]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            queue.enqueue(7);
+        });
+        REQUIRE(queue.waitFor(value, std::chrono::seconds(5)));
+        REQUIRE(value == 7);
+        producer.join();
+    }
+}
+
+TEST_CASE("SafeQueue close wakes waiters and refuses items", "[SafeQueue]") {
+    SafeQueue<int> queue;
+    queue.enqueue(1);
+
+    std::atomic<int> woken{0};
+    std::vector<std::thread> consumers;
+    std::vector<int> taken(3, 0);
+    for (int t = 0; t < 3; ++t) {
+        consumers.emplace_back([&queue, &woken, &taken, t]() {
+            int value;
+            while (queue.waitAndDequeue(value)) {
+                taken[t] += value;
+            }
+            woken++;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    // The item queued before close() was still handed out
+    REQUIRE(woken == 3);
+    REQUIRE(taken[0] + taken[1] + taken[2] == 1);
+    REQUIRE(queue.isClosed());
+    REQUIRE_FALSE(queue.enqueue(2));
+    REQUIRE(queue.empty());
+
+    int value;
+    REQUIRE_FALSE(queue.waitFor(value, std::chrono::hours(1)));
+}
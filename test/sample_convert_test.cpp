@@ -0,0 +1,199 @@
+/**
+ * SampleConverter Unit Tests
+ *
+ * Tests PCM conversion kernels against known values and checks that every
+ * vectorized variant produces the same output as the scalar reference.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/sample_convert.h>
+#include <cstdint>
+#include <vector>
+
+using audio::SampleConverter;
+
+namespace {
+    const SampleConverter::Isa kAllIsas[] = {
+        SampleConverter::Isa::Scalar,
+        SampleConverter::Isa::SSE2,
+        SampleConverter::Isa::AVX2
+    };
+
+    // Odd length so every variant also exercises its scalar tail
+    constexpr size_t kSamples = 1003;
+
+    std::vector<int16_t> makeS16Input() {
+        std::vector<int16_t> in(kSamples);
+        for (size_t i = 0; i < kSamples; ++i) {
+            in[i] = static_cast<int16_t>(static_cast<int32_t>(i * 2654435761u) & 0xFFFF);
+        }
+        in[0] = -32768;
+        in[1] = 32767;
+        return in;
+    }
+
+    std::vector<float> makeF32Input() {
+        std::vector<float> in(kSamples);
+        for (size_t i = 0; i < kSamples; ++i) {
+            in[i] = static_cast<float>(static_cast<int>(i % 401) - 200) / 150.0f;  // includes |x| > 1
+        }
+        return in;
+    }
+}
+
+TEST_CASE("SampleConverter reference values", "[SampleConverter]") {
+    SampleConverter::setIsa(SampleConverter::Isa::Scalar);
+
+    SECTION("s16 to f32 maps full scale to [-1, 1)") {
+        int16_t in[] = { -32768, 0, 16384, 32767 };
+        float out[4];
+        SampleConverter::s16ToF32(in, out, 4);
+
+        REQUIRE(out[0] == -1.0f);
+        REQUIRE(out[1] == 0.0f);
+        REQUIRE(out[2] == 0.5f);
+        REQUIRE(out[3] < 1.0f);
+    }
+
+    SECTION("f32 to s16 saturates out-of-range input") {
+        float in[] = { -2.0f, -1.0f, 0.0f, 0.5f, 1.0f, 3.0f };
+        int16_t out[6];
+        SampleConverter::f32ToS16(in, out, 6);
+
+        REQUIRE(out[0] == -32768);
+        REQUIRE(out[1] == -32768);
+        REQUIRE(out[2] == 0);
+        REQUIRE(out[3] == 16384);
+        REQUIRE(out[4] == 32767);
+        REQUIRE(out[5] == 32767);
+    }
+
+    SECTION("Mono to stereo duplicates samples") {
+        float in[] = { 0.1f, 0.2f, 0.3f };
+        float out[6];
+        SampleConverter::monoToStereoF32(in, out, 3);
+
+        REQUIRE(out[0] == 0.1f);
+        REQUIRE(out[1] == 0.1f);
+        REQUIRE(out[4] == 0.3f);
+        REQUIRE(out[5] == 0.3f);
+    }
+
+    SECTION("Stereo to mono averages pairs") {
+        float in[] = { 1.0f, 0.0f, -0.5f, -0.5f };
+        float out[2];
+        SampleConverter::stereoToMonoF32(in, out, 2);
+
+        REQUIRE(out[0] == 0.5f);
+        REQUIRE(out[1] == -0.5f);
+    }
+
+    SECTION("Crossfade ramps from one signal to the other") {
+        float from[] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+        float to[] = { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+        float out[5];
+        SampleConverter::crossfadeF32(from, to, out, 5, 0.0f, 0.25f);
+
+        REQUIRE(out[0] == 1.0f);
+        REQUIRE(out[2] == 0.0f);
+        REQUIRE(out[4] == -1.0f);
+
+        SampleConverter::crossfadeF32(from, nullptr, from, 5, 0.5f, 0.0f);
+        REQUIRE(from[0] == 0.5f);
+        REQUIRE(from[4] == 0.5f);
+    }
+
+    SECTION("Gain scales and saturates 16-bit samples") {
+        int16_t in[] = { 1000, -1000, 20000, -20000, 3 };
+        SampleConverter::applyGainS16(in, 5, 2.0f);
+
+        REQUIRE(in[0] == 2000);
+        REQUIRE(in[1] == -2000);
+        REQUIRE(in[2] == 32767);
+        REQUIRE(in[3] == -32768);
+        REQUIRE(in[4] == 6);
+    }
+}
+
+TEST_CASE("SampleConverter channel map", "[SampleConverter]") {
+    SECTION("Matching layouts map 1:1") {
+        auto map = SampleConverter::buildChannelMap(2, 2);
+        REQUIRE(map == std::vector<int>{ 0, 1 });
+    }
+
+    SECTION("Mono source feeds every output channel") {
+        auto map = SampleConverter::buildChannelMap(1, 4);
+        REQUIRE(map == std::vector<int>{ 0, 0, 0, 0 });
+    }
+
+    SECTION("Extra output channels of a stereo source are silent") {
+        auto map = SampleConverter::buildChannelMap(2, 6);
+        REQUIRE(map == std::vector<int>{ 0, 1, -1, -1, -1, -1 });
+
+        float in[] = { 0.25f, -0.25f };
+        float out[6];
+        SampleConverter::remapChannelsF32(in, 2, out, map, 1);
+        REQUIRE(out[0] == 0.25f);
+        REQUIRE(out[1] == -0.25f);
+        REQUIRE(out[2] == 0.0f);
+        REQUIRE(out[5] == 0.0f);
+    }
+}
+
+TEST_CASE("SampleConverter variants match scalar", "[SampleConverter]") {
+    auto s16 = makeS16Input();
+    auto f32 = makeF32Input();
+
+    SampleConverter::setIsa(SampleConverter::Isa::Scalar);
+    std::vector<float> refF32(kSamples);
+    std::vector<int16_t> refS16(kSamples);
+    std::vector<float> refStereo(kSamples * 2);
+    std::vector<float> refMono(kSamples / 2);
+    SampleConverter::s16ToF32(s16.data(), refF32.data(), kSamples);
+    SampleConverter::f32ToS16(f32.data(), refS16.data(), kSamples);
+    SampleConverter::monoToStereoF32(f32.data(), refStereo.data(), kSamples);
+    SampleConverter::stereoToMonoF32(f32.data(), refMono.data(), kSamples / 2);
+    std::vector<float> refFade(kSamples);
+    std::vector<float> refFadeOut(kSamples);
+    SampleConverter::crossfadeF32(f32.data(), refF32.data(), refFade.data(), kSamples, 0.25f, 1.0f / 2048.0f);
+    SampleConverter::crossfadeF32(f32.data(), nullptr, refFadeOut.data(), kSamples, 0.0f, 1.0f / kSamples);
+    std::vector<float> refGainF32(f32);
+    std::vector<int16_t> refGainS16(s16);
+    SampleConverter::applyGainF32(refGainF32.data(), kSamples, 0.7f);
+    SampleConverter::applyGainS16(refGainS16.data(), kSamples, 1.9f);
+
+    for (auto isa : kAllIsas) {
+        SampleConverter::setIsa(isa);
+        INFO("isa = " << static_cast<int>(SampleConverter::activeIsa()));
+
+        std::vector<float> outF32(kSamples);
+        std::vector<int16_t> outS16(kSamples);
+        std::vector<float> outStereo(kSamples * 2);
+        std::vector<float> outMono(kSamples / 2);
+        SampleConverter::s16ToF32(s16.data(), outF32.data(), kSamples);
+        SampleConverter::f32ToS16(f32.data(), outS16.data(), kSamples);
+        SampleConverter::monoToStereoF32(f32.data(), outStereo.data(), kSamples);
+        SampleConverter::stereoToMonoF32(f32.data(), outMono.data(), kSamples / 2);
+        std::vector<float> outFade(kSamples);
+        std::vector<float> outFadeOut(f32);
+        SampleConverter::crossfadeF32(f32.data(), refF32.data(), outFade.data(), kSamples, 0.25f, 1.0f / 2048.0f);
+        // In place, as the crossfade mixer uses it
+        SampleConverter::crossfadeF32(outFadeOut.data(), nullptr, outFadeOut.data(), kSamples, 0.0f, 1.0f / kSamples);
+
+        std::vector<float> outGainF32(f32);
+        std::vector<int16_t> outGainS16(s16);
+        SampleConverter::applyGainF32(outGainF32.data(), kSamples, 0.7f);
+        SampleConverter::applyGainS16(outGainS16.data(), kSamples, 1.9f);
+
+        REQUIRE(outGainF32 == refGainF32);
+        REQUIRE(outGainS16 == refGainS16);
+        REQUIRE(outFade == refFade);
+        REQUIRE(outFadeOut == refFadeOut);
+        REQUIRE(outF32 == refF32);
+        REQUIRE(outS16 == refS16);
+        REQUIRE(outStereo == refStereo);
+        REQUIRE(outMono == refMono);
+    }
+
+    SampleConverter::setIsa(SampleConverter::Isa::AVX2);  // restore best supported
+}
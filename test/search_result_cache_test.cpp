@@ -0,0 +1,125 @@
+/**
+ * SearchResultCache Unit Tests
+ *
+ * Tests hits and misses by (keyword, page, platform), keyword normalization,
+ * result-limit handling, TTL expiry and LRU eviction.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/search_result_cache.h>
+#include <chrono>
+
+using network::PlatformType;
+using network::SearchResult;
+using network::SearchResultCache;
+
+namespace {
+    QList<SearchResult> makeResults(int count) {
+        QList<SearchResult> results;
+        for (int i = 0; i < count; ++i) {
+            SearchResult item;
+            item.title = QString("Song %1").arg(i);
+            item.uploader = "uploader";
+            item.platform = PlatformType::Bilibili;
+            item.duration = 180;
+            item.interfaceData = QString("BV%1").arg(i);
+            results.append(item);
+        }
+        return results;
+    }
+}
+
+TEST_CASE("SearchResultCache keys by keyword, page and platform", "[SearchResultCache]") {
+    SearchResultCache cache;
+    cache.insert("lemon", 1, PlatformType::Bilibili, 20, makeResults(20));
+
+    SECTION("the same search hits") {
+        auto results = cache.find("lemon", 1, PlatformType::Bilibili, 20);
+        REQUIRE(results.has_value());
+        REQUIRE(results->size() == 20);
+        REQUIRE(results->front().title == "Song 0");
+    }
+
+    SECTION("keywords are compared trimmed and case-insensitively") {
+        REQUIRE(cache.find("  LEMON ", 1, PlatformType::Bilibili, 20).has_value());
+    }
+
+    SECTION("other pages, platforms and keywords miss") {
+        REQUIRE_FALSE(cache.find("lemon", 2, PlatformType::Bilibili, 20).has_value());
+        REQUIRE_FALSE(cache.find("lemon", 1, PlatformType::YouTube, 20).has_value());
+        REQUIRE_FALSE(cache.find("lime", 1, PlatformType::Bilibili, 20).has_value());
+    }
+
+    SECTION("inserting the same search again replaces the entry") {
+        cache.insert("lemon", 1, PlatformType::Bilibili, 20, makeResults(5));
+        REQUIRE(cache.size() == 1);
+        REQUIRE(cache.find("lemon", 1, PlatformType::Bilibili, 20)->size() == 5);
+    }
+
+    SECTION("clear drops everything") {
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+        REQUIRE_FALSE(cache.find("lemon", 1, PlatformType::Bilibili, 20).has_value());
+    }
+}
+
+TEST_CASE("SearchResultCache keys identify a search page", "[SearchResultCache]") {
+    const auto key = SearchResultCache::makeKey("lemon", 2, PlatformType::Bilibili);
+    REQUIRE(SearchResultCache::makeKey(" Lemon  ", 2, PlatformType::Bilibili) == key);
+    REQUIRE(SearchResultCache::makeKey("lemon", 3, PlatformType::Bilibili) != key);
+    REQUIRE(SearchResultCache::makeKey("lemon", 2, PlatformType::YouTube) != key);
+}
+
+TEST_CASE("SearchResultCache honours the result limit", "[SearchResultCache]") {
+    SearchResultCache cache;
+
+    SECTION("smaller requests are truncated") {
+        cache.insert("lemon", 1, PlatformType::Bilibili, 20, makeResults(20));
+        auto results = cache.find("lemon", 1, PlatformType::Bilibili, 5);
+        REQUIRE(results.has_value());
+        REQUIRE(results->size() == 5);
+        REQUIRE(results->back().title == "Song 4");
+    }
+
+    SECTION("a search cut off at its limit cannot answer a larger one") {
+        cache.insert("lemon", 1, PlatformType::Bilibili, 20, makeResults(20));
+        REQUIRE_FALSE(cache.find("lemon", 1, PlatformType::Bilibili, 50).has_value());
+    }
+
+    SECTION("a search that ran out of results answers any limit") {
+        cache.insert("lemon", 1, PlatformType::Bilibili, 20, makeResults(7));
+        auto results = cache.find("lemon", 1, PlatformType::Bilibili, 50);
+        REQUIRE(results.has_value());
+        REQUIRE(results->size() == 7);
+    }
+}
+
+TEST_CASE("SearchResultCache bounds its entries", "[SearchResultCache]") {
+    SECTION("expired entries miss and are dropped") {
+        SearchResultCache cache(8, std::chrono::seconds(0));
+        cache.insert("lemon", 1, PlatformType::Bilibili, 20, makeResults(3));
+        // A zero TTL expires as soon as any time has passed
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+        while (std::chrono::steady_clock::now() <= deadline) {}
+        REQUIRE_FALSE(cache.find("lemon", 1, PlatformType::Bilibili, 20).has_value());
+        REQUIRE(cache.size() == 0);
+    }
+
+    SECTION("the least recently used entry is evicted") {
+        SearchResultCache cache(2);
+        cache.insert("a", 1, PlatformType::Bilibili, 20, makeResults(1));
+        cache.insert("b", 1, PlatformType::Bilibili, 20, makeResults(1));
+        REQUIRE(cache.find("a", 1, PlatformType::Bilibili, 20).has_value());   // b is now oldest
+        cache.insert("c", 1, PlatformType::Bilibili, 20, makeResults(1));
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.find("a", 1, PlatformType::Bilibili, 20).has_value());
+        REQUIRE_FALSE(cache.find("b", 1, PlatformType::Bilibili, 20).has_value());
+        REQUIRE(cache.find("c", 1, PlatformType::Bilibili, 20).has_value());
+    }
+
+    SECTION("a zero capacity stores nothing") {
+        SearchResultCache cache(0);
+        cache.insert("a", 1, PlatformType::Bilibili, 20, makeResults(1));
+        REQUIRE(cache.size() == 0);
+    }
+}
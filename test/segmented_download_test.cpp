@@ -0,0 +1,174 @@
+/**
+ * SegmentedDownload Unit Tests
+ *
+ * Drives the downloader with an in-memory range fetcher to check in-order
+ * reassembly across connections, the look-ahead window, resuming failed
+ * segments and cancellation.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <stream/segmented_download.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::vector<char> pattern(size_t size) {
+        std::vector<char> data(size);
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<char>((i * 17 + i / 251) & 0xFF);
+        }
+        return data;
+    }
+
+    // Serves ranges of `data` in small chunks; `failAfter` > 0 drops every first request
+    // of a range after that many bytes
+    struct FakeServer {
+        const std::vector<char>& data;
+        size_t failAfter = 0;
+        std::atomic<int> requests{0};
+        std::atomic<int> active{0};
+        std::atomic<int> peakActive{0};
+        std::mutex mutex;
+        std::vector<uint64_t> failedOffsets;
+
+        SegmentedDownload::RangeFetcher fetcher() {
+            return [this](uint64_t offset, uint64_t length, SegmentedDownload::ContentReceiver receiver) {
+                return std::async(std::launch::async, [this, offset, length, receiver]() {
+                    ++requests;
+                    int now = ++active;
+                    int peak = peakActive.load();
+                    while (now > peak && !peakActive.compare_exchange_weak(peak, now)) {
+                    }
+                    bool fail = false;
+                    if (failAfter > 0) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (std::find(failedOffsets.begin(), failedOffsets.end(), offset) == failedOffsets.end()) {
+                            failedOffsets.push_back(offset);
+                            fail = length > failAfter;
+                        }
+                    }
+                    const uint64_t limit = fail ? failAfter : length;
+                    bool ok = true;
+                    for (uint64_t sent = 0; sent < limit && ok;) {
+                        size_t chunk = static_cast<size_t>(std::min<uint64_t>(1000, limit - sent));
+                        ok = receiver(data.data() + offset + sent, chunk);
+                        sent += chunk;
+                    }
+                    --active;
+                    return ok && !fail;
+                });
+            };
+        }
+    };
+}
+
+TEST_CASE("SegmentedDownload reassembles segments in order", "[SegmentedDownload]") {
+    const auto data = pattern(200 * 1024 + 123);
+
+    SECTION("Several connections deliver one ordered stream") {
+        FakeServer server{data};
+        SegmentedDownload::Options options;
+        options.connections = 4;
+        options.segmentSize = 16 * 1024;
+        SegmentedDownload download(data.size(), server.fetcher(), options);
+        REQUIRE(download.segmentCount() == 13);
+
+        std::vector<char> received;
+        REQUIRE(download.run([&](const char* bytes, size_t size) {
+            received.insert(received.end(), bytes, bytes + size);
+            return true;
+        }));
+        REQUIRE(received == data);
+        REQUIRE(server.peakActive.load() <= 4);
+    }
+
+    SECTION("A slow receiver bounds how far workers run ahead") {
+        FakeServer server{data};
+        SegmentedDownload::Options options;
+        options.connections = 2;
+        options.segmentSize = 8 * 1024;
+        options.window = 3;
+        SegmentedDownload download(data.size(), server.fetcher(), options);
+
+        std::vector<char> received;
+        bool withinWindow = true;
+        REQUIRE(download.run([&](const char* bytes, size_t size) {
+            received.insert(received.end(), bytes, bytes + size);
+            // Requests started so far never exceed delivered segments plus the window
+            size_t headSegment = received.size() / options.segmentSize;
+            withinWindow = withinWindow && static_cast<size_t>(server.requests.load()) <= headSegment + 1 + options.window;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            return true;
+        }));
+        REQUIRE(received == data);
+        REQUIRE(withinWindow);
+    }
+
+    SECTION("Interrupted segments resume where they stopped") {
+        FakeServer server{data};
+        server.failAfter = 5000;
+        SegmentedDownload::Options options;
+        options.connections = 3;
+        options.segmentSize = 32 * 1024;
+        SegmentedDownload download(data.size(), server.fetcher(), options);
+
+        std::vector<char> received;
+        REQUIRE(download.run([&](const char* bytes, size_t size) {
+            received.insert(received.end(), bytes, bytes + size);
+            return true;
+        }));
+        REQUIRE(received == data);
+        REQUIRE(server.requests.load() > static_cast<int>(download.segmentCount()));
+    }
+}
+
+TEST_CASE("SegmentedDownload failure and cancel", "[SegmentedDownload]") {
+    const auto data = pattern(64 * 1024);
+    SegmentedDownload::Options options;
+    options.connections = 2;
+    options.segmentSize = 8 * 1024;
+
+    SECTION("A range that never arrives fails the download") {
+        auto fetcher = [](uint64_t, uint64_t, SegmentedDownload::ContentReceiver) {
+            return std::async(std::launch::async, []() { return false; });
+        };
+        SegmentedDownload download(data.size(), fetcher, options);
+        REQUIRE_FALSE(download.run([](const char*, size_t) { return true; }));
+    }
+
+    SECTION("Receiver returning false stops the download") {
+        FakeServer server{data};
+        SegmentedDownload download(data.size(), server.fetcher(), options);
+        size_t received = 0;
+        REQUIRE_FALSE(download.run([&](const char*, size_t size) {
+            received += size;
+            return received < 10000;
+        }));
+        REQUIRE(received < data.size());
+    }
+
+    SECTION("cancel() from another thread") {
+        FakeServer server{data};
+        SegmentedDownload download(data.size(), server.fetcher(), options);
+        std::thread canceller([&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            download.cancel();
+        });
+        REQUIRE_FALSE(download.run([](const char*, size_t) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            return true;
+        }));
+        canceller.join();
+    }
+
+    SECTION("Empty resources complete immediately") {
+        FakeServer server{data};
+        SegmentedDownload download(0, server.fetcher(), options);
+        REQUIRE(download.run([](const char*, size_t) { return true; }));
+        REQUIRE(server.requests.load() == 0);
+    }
+}
@@ -0,0 +1,203 @@
+/**
+ * ShuffleBag Unit Tests
+ *
+ * Tests rounds playing every song once, history when stepping back, songs added and
+ * removed mid-round, and PlaylistManager keeping the order across restarts.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <QSet>
+#include <chrono>
+#include <filesystem>
+
+#include "config/config_manager.h"
+#include "playlist/playlist_manager.h"
+#include "playlist/shuffle_bag.h"
+#include "test_utils.h"
+
+using playlist::ShuffleBag;
+
+namespace {
+    QList<QUuid> makeIds(int count)
+    {
+        QList<QUuid> ids;
+        for (int i = 0; i < count; ++i) {
+            ids << QUuid::createUuid();
+        }
+        return ids;
+    }
+
+    // The songs following current, count of them
+    QList<QUuid> play(ShuffleBag& bag, QUuid& current, int count)
+    {
+        QList<QUuid> played;
+        for (int i = 0; i < count; ++i) {
+            current = *bag.next(current);
+            played << current;
+        }
+        return played;
+    }
+}
+
+TEST_CASE("ShuffleBag plays every song once a round", "[ShuffleBag]") {
+    const QList<QUuid> ids = makeIds(20);
+    ShuffleBag bag(ids, 7);
+    REQUIRE(bag.size() == 20);
+
+    QUuid current;
+    const QList<QUuid> round = play(bag, current, 20);
+    REQUIRE(QSet<QUuid>(round.cbegin(), round.cend()).size() == 20);
+
+    // The next round starts from the last song, so it doesn't play twice in a row
+    const QUuid last = current;
+    const QList<QUuid> nextRound = play(bag, current, 19);
+    REQUIRE_FALSE(nextRound.contains(last));
+    REQUIRE(QSet<QUuid>(nextRound.cbegin(), nextRound.cend()).size() == 19);
+
+    SECTION("asking again gives the same song") {
+        const QUuid upcoming = *bag.next(current);
+        REQUIRE(*bag.next(current) == upcoming);
+    }
+
+    SECTION("a single song follows itself") {
+        ShuffleBag single({ ids[0] });
+        REQUIRE(*single.next(ids[0]) == ids[0]);
+        REQUIRE(*single.previous(ids[0]) == ids[0]);
+        REQUIRE_FALSE(ShuffleBag(QList<QUuid>{}).next(ids[0]).has_value());
+    }
+}
+
+TEST_CASE("ShuffleBag steps back through what was played", "[ShuffleBag]") {
+    const QList<QUuid> ids = makeIds(10);
+    ShuffleBag bag(ids, 11);
+    QUuid current;
+    const QList<QUuid> played = play(bag, current, 5);
+
+    REQUIRE(*bag.previous(played[4]) == played[3]);
+    REQUIRE(*bag.previous(played[3]) == played[2]);
+    // And forward again the same way
+    REQUIRE(*bag.next(played[2]) == played[3]);
+    REQUIRE(*bag.next(played[3]) == played[4]);
+
+    SECTION("a song picked out of turn plays next, the rest still to come") {
+        bag.next(played[4]);    // Back at the latest song
+        QSet<QUuid> rest(ids.cbegin(), ids.cend());
+        for (const QUuid& songId : played) {
+            rest.remove(songId);
+        }
+        const QUuid picked = *rest.cbegin();
+        current = picked;
+        const QList<QUuid> after = play(bag, current, 4);
+        rest.remove(picked);
+        REQUIRE(QSet<QUuid>(after.cbegin(), after.cend()) == rest);
+        REQUIRE(*bag.previous(picked) == played[4]);
+    }
+}
+
+TEST_CASE("ShuffleBag keeps its order as songs come and go", "[ShuffleBag]") {
+    const QList<QUuid> ids = makeIds(50);
+    ShuffleBag bag(ids, 3);
+    QUuid current;
+    const QList<QUuid> played = play(bag, current, 10);
+    const QList<QUuid> before = bag.order();
+
+    SECTION("added songs join the rest of the round") {
+        const QList<QUuid> added = makeIds(5);
+        for (const QUuid& songId : added) {
+            bag.insert(songId);
+        }
+        bag.insert(ids[0]);
+        REQUIRE(bag.size() == 55);
+        const QList<QUuid> rest = play(bag, current, 45);
+        for (const QUuid& songId : added) {
+            REQUIRE(rest.contains(songId));
+        }
+        for (const QUuid& songId : played) {
+            REQUIRE_FALSE(rest.contains(songId));
+        }
+        // History stays as it was
+        REQUIRE(bag.order().mid(0, 10) == before.mid(0, 10));
+    }
+
+    SECTION("removed songs leave the others in place") {
+        QList<QUuid> expected = before;
+        for (int i = 0; i < 40; i += 2) {
+            bag.remove(before[i]);
+            expected.removeOne(before[i]);
+        }
+        bag.remove(QUuid::createUuid());
+        REQUIRE(bag.size() == 30);
+        REQUIRE(bag.order() == expected);
+        // The current song removed too: play goes on after it
+        bag.remove(current);
+        const int at = expected.indexOf(current);
+        expected.removeAt(at);
+        REQUIRE(*bag.next(current) == expected[at]);
+    }
+
+    SECTION("restored, it carries on where it was") {
+        ShuffleBag restored = ShuffleBag::restore(before, bag.current(), ids);
+        REQUIRE(restored.order() == before);
+        REQUIRE(restored.current() == bag.current());
+        QUuid restoredCurrent = current;
+        REQUIRE(play(restored, restoredCurrent, 30) == play(bag, current, 30));
+
+        // Against a changed playlist: gone songs dropped, new ones dealt in
+        QList<QUuid> songs = ids.mid(1);
+        songs << QUuid::createUuid();
+        ShuffleBag changed = ShuffleBag::restore(before, bag.current(), songs);
+        REQUIRE(changed.size() == 50);
+        REQUIRE_FALSE(changed.contains(ids[0]));
+        REQUIRE(changed.contains(songs.last()));
+    }
+}
+
+TEST_CASE("PlaylistManager keeps the shuffle order across restarts", "[playlist_manager][ShuffleBag]") {
+    testutils::ensureQCoreApplication();
+    auto stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    auto dir = std::filesystem::temp_directory_path() / ("BilibiliPlayerTest_shuffle_" + stamp);
+    std::filesystem::create_directories(dir);
+    {
+        ConfigManager cfg;
+        cfg.initialize(QString::fromStdString(dir.string()));
+        playlist::CategoryInfo category{ "Shuffle Cat", QUuid::createUuid() };
+        playlist::PlaylistInfo list;
+        list.name = "Shuffle Playlist";
+        list.uuid = QUuid::createUuid();
+
+        QUuid current;
+        QList<QUuid> expected;
+        {
+            PlaylistManager mgr(&cfg);
+            mgr.initialize();
+            REQUIRE(mgr.addCategory(category));
+            REQUIRE(mgr.addPlaylist(list, category.uuid));
+            QList<playlist::SongInfo> songs;
+            for (int i = 0; i < 12; ++i) {
+                playlist::SongInfo song;
+                song.title = QString("Song %1").arg(i);
+                song.platform = 1;
+                song.args = QString("BV%1").arg(i);
+                song.uuid = QUuid::createUuid();
+                songs << song;
+            }
+            REQUIRE(mgr.addSongsToPlaylist(songs, list.uuid) == 12);
+
+            current = songs[0].uuid;
+            for (int i = 0; i < 4; ++i) {
+                current = *mgr.getNextSong(current, list.uuid, playlist::PlayMode::Random);
+            }
+            // Where the round goes from here, asked twice: the answer doesn't change
+            expected << *mgr.getNextSong(current, list.uuid, playlist::PlayMode::Random);
+            REQUIRE(*mgr.getNextSong(current, list.uuid, playlist::PlayMode::Random) == expected[0]);
+            mgr.saveAllCategories();
+        }
+
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        REQUIRE(*mgr.getNextSong(current, list.uuid, playlist::PlayMode::Random) == expected[0]);
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
@@ -0,0 +1,126 @@
+/**
+ * SongIdentityTable Unit Tests
+ *
+ * Tests songs being told apart by what they play, and PlaylistManager sharing the cache
+ * file, cover and loudness of one song between the playlists holding it.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+
+#include "config/config_manager.h"
+#include "playlist/playlist_manager.h"
+#include "playlist/song_identity_table.h"
+#include "test_utils.h"
+
+using playlist::SongIdentityTable;
+using playlist::SongInfo;
+
+namespace {
+    SongInfo networkSong(const QString& title, const QString& args)
+    {
+        SongInfo song;
+        song.title = title;
+        song.uploader = "Uploader";
+        song.platform = 1;
+        song.duration = 0;
+        song.args = args;
+        song.uuid = QUuid::createUuid();
+        return song;
+    }
+}
+
+TEST_CASE("SongIdentityTable knows songs by what they play", "[SongIdentityTable]") {
+    const QUuid first = QUuid::createUuid();
+    const QUuid second = QUuid::createUuid();
+    SongInfo song = networkSong("Song", "BV1xx411c7mD:1");
+    SongInfo renamed = networkSong("Same song, renamed", "BV1xx411c7mD:1");
+    SongInfo other = networkSong("Song", "BV1xx411c7mD:2");
+    REQUIRE(SongIdentityTable::identityOf(song) == SongIdentityTable::identityOf(renamed));
+    REQUIRE(SongIdentityTable::identityOf(song) != SongIdentityTable::identityOf(other));
+    REQUIRE(SongIdentityTable::identityOf(networkSong("No args", "")).isEmpty());
+
+    SongIdentityTable table;
+    song.filepath = "/cache/1_abc.audio";
+    song.duration = 200;
+    table.addSong(song, first);
+    table.addSong(renamed, second);
+    table.addSong(other, second);
+    REQUIRE(table.size() == 2);
+    REQUIRE(table.songCount() == 3);
+    REQUIRE(table.copiesOf(renamed.uuid, second) == QList<SongIdentityTable::SongRef>{ { first, song.uuid } });
+    REQUIRE(table.copiesOf(other.uuid, second).isEmpty());
+
+    // What one copy knows stays known while any copy is left
+    auto shared = table.find(SongIdentityTable::identityOf(renamed));
+    REQUIRE(shared.has_value());
+    REQUIRE(shared->filepath == song.filepath);
+    REQUIRE(shared->duration == 200);
+    SongInfo added = networkSong("Added", "BV1xx411c7mD:1");
+    REQUIRE(SongIdentityTable::differs(*shared, added));
+    SongIdentityTable::share(*shared, added);
+    REQUIRE(added.filepath == song.filepath);
+    REQUIRE(added.title == "Added");
+    REQUIRE_FALSE(SongIdentityTable::differs(*shared, added));
+
+    SECTION("removed songs and playlists leave the rest") {
+        table.removeSong(song.uuid, first);
+        REQUIRE(table.copiesOf(renamed.uuid, second).isEmpty());
+        REQUIRE(table.find(SongIdentityTable::identityOf(song)).has_value());
+        table.removePlaylist(second);
+        REQUIRE(table.size() == 0);
+        REQUIRE(table.songCount() == 0);
+    }
+}
+
+TEST_CASE("PlaylistManager shares media between copies of a song", "[playlist_manager][SongIdentityTable]") {
+    testutils::ensureQCoreApplication();
+    auto stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    auto dir = std::filesystem::temp_directory_path() / ("BilibiliPlayerTest_identity_" + stamp);
+    std::filesystem::create_directories(dir);
+    {
+        ConfigManager cfg;
+        cfg.initialize(QString::fromStdString(dir.string()));
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        playlist::CategoryInfo category{ "Identity Cat", QUuid::createUuid() };
+        playlist::PlaylistInfo first{ "First" };
+        first.uuid = QUuid::createUuid();
+        playlist::PlaylistInfo second{ "Second" };
+        second.uuid = QUuid::createUuid();
+        REQUIRE(mgr.addCategory(category));
+        REQUIRE(mgr.addPlaylist(first, category.uuid));
+        REQUIRE(mgr.addPlaylist(second, category.uuid));
+
+        const SongInfo original = networkSong("Original title", "BV1xx411c7mD:1");
+        REQUIRE(mgr.addSongToPlaylist(original, first.uuid));
+        SongInfo stored = *mgr.getSongFromPlaylist(original.uuid, first.uuid);
+        stored.coverName = "cover.jpg";
+        stored.duration = 215;
+        REQUIRE(mgr.updateSongInPlaylist(stored, first.uuid));
+
+        // Added elsewhere under another title, it plays from the same cache file
+        const SongInfo copy = networkSong("My title", "BV1xx411c7mD:1");
+        REQUIRE(mgr.addSongsToPlaylist({ copy }, second.uuid) == 1);
+        SongInfo storedCopy = *mgr.getSongFromPlaylist(copy.uuid, second.uuid);
+        REQUIRE(storedCopy.title == "My title");
+        REQUIRE(storedCopy.filepath == stored.filepath);
+        REQUIRE(storedCopy.coverName == "cover.jpg");
+        REQUIRE(storedCopy.duration == 215);
+        REQUIRE(mgr.songCopies(copy.uuid, second.uuid) == QList<SongIdentityTable::SongRef>{ { first.uuid, original.uuid } });
+
+        // Analysed through one copy, both have it
+        REQUIRE(mgr.setSongLoudness(copy.uuid, -3.5f));
+        const SongInfo analysed = *mgr.getSongFromPlaylist(original.uuid, first.uuid);
+        REQUIRE(analysed.loudnessAnalyzed);
+        REQUIRE(analysed.loudnessGainDb == -3.5f);
+        REQUIRE(analysed.title == "Original title");
+
+        REQUIRE(mgr.removePlaylist(first.uuid));
+        REQUIRE(mgr.songCopies(copy.uuid, second.uuid).isEmpty());
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
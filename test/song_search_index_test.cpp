@@ -0,0 +1,165 @@
+/**
+ * SongSearchIndex Unit Tests
+ *
+ * Tests prefix and CJK matching, ranking, incremental updates, and
+ * PlaylistManager keeping its index in step with song changes.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <QDir>
+#include <chrono>
+#include <filesystem>
+
+#include "config/config_manager.h"
+#include "playlist/playlist_manager.h"
+#include "playlist/song_search_index.h"
+#include "test_utils.h"
+
+using playlist::SongSearchIndex;
+
+namespace {
+    playlist::SongInfo makeSong(const QString& title, const QString& uploader)
+    {
+        playlist::SongInfo song;
+        song.title = title;
+        song.uploader = uploader;
+        song.platform = 1;
+        song.duration = 100;
+        song.args = "BV" + QString::number(qHash(title));
+        song.uuid = QUuid::createUuid();
+        return song;
+    }
+
+    QList<QUuid> songIds(const QList<playlist::SongSearchHit>& hits)
+    {
+        QList<QUuid> ids;
+        for (const auto& hit : hits) {
+            ids << hit.songId;
+        }
+        return ids;
+    }
+}
+
+TEST_CASE("SongSearchIndex matches words by prefix", "[SongSearchIndex]") {
+    SongSearchIndex index;
+    const QUuid list = QUuid::createUuid();
+    const auto bohemian = makeSong("Bohemian Rhapsody", "Queen");
+    const auto rhapsody = makeSong("Rhapsody in Blue", "Gershwin");
+    const auto queenie = makeSong("Queenie Eye", "Paul McCartney");
+    index.addSong(bohemian, list);
+    index.addSong(rhapsody, list);
+    index.addSong(queenie, list);
+    REQUIRE(index.size() == 3);
+
+    SECTION("any word, any case, as a prefix") {
+        REQUIRE(songIds(index.search("rhap", 10)).size() == 2);
+        REQUIRE(songIds(index.search("BOHEM", 10)) == QList<QUuid>{ bohemian.uuid });
+        REQUIRE(index.search("hapsody", 10).isEmpty());
+    }
+
+    SECTION("every word must match, in title or uploader") {
+        REQUIRE(songIds(index.search("rhapsody queen", 10)) == QList<QUuid>{ bohemian.uuid });
+        REQUIRE(index.search("rhapsody paul", 10).isEmpty());
+    }
+
+    SECTION("title matches rank over uploader matches, whole words over prefixes") {
+        // "Queen" is bohemian's uploader; "Queenie" a prefix match in queenie's title
+        const auto hits = index.search("queen", 10);
+        REQUIRE(songIds(hits) == QList<QUuid>{ queenie.uuid, bohemian.uuid });
+        REQUIRE(hits[0].score > hits[1].score);
+        REQUIRE(hits[0].playlistId == list);
+    }
+
+    SECTION("limit keeps the best") {
+        REQUIRE(index.search("r", 1).size() == 1);
+        REQUIRE(index.search("", 10).isEmpty());
+        REQUIRE(index.search("   ", 10).isEmpty());
+    }
+}
+
+TEST_CASE("SongSearchIndex matches CJK text by characters", "[SongSearchIndex]") {
+    SongSearchIndex index;
+    const QUuid list = QUuid::createUuid();
+    const auto song = makeSong(QString::fromUtf8("晴天 (Live)"), QString::fromUtf8("周杰伦"));
+    const auto other = makeSong(QString::fromUtf8("夜曲"), QString::fromUtf8("周深"));
+    index.addSong(song, list);
+    index.addSong(other, list);
+
+    REQUIRE(songIds(index.search(QString::fromUtf8("杰伦"), 10)) == QList<QUuid>{ song.uuid });
+    REQUIRE(songIds(index.search(QString::fromUtf8("周杰伦 晴天"), 10)) == QList<QUuid>{ song.uuid });
+    REQUIRE(index.search(QString::fromUtf8("周"), 10).size() == 2);
+    REQUIRE(songIds(index.search(QString::fromUtf8("天"), 10)) == QList<QUuid>{ song.uuid });
+    REQUIRE(songIds(index.search(QString::fromUtf8("晴天 live"), 10)) == QList<QUuid>{ song.uuid });
+    REQUIRE(index.search(QString::fromUtf8("天晴"), 10).isEmpty());
+}
+
+TEST_CASE("SongSearchIndex updates incrementally", "[SongSearchIndex]") {
+    SongSearchIndex index;
+    const QUuid first = QUuid::createUuid();
+    const QUuid second = QUuid::createUuid();
+    auto song = makeSong("Clair de Lune", "Debussy");
+    index.addSong(song, first);
+    index.addSong(song, second);
+    REQUIRE(index.search("lune", 10).size() == 2);
+
+    SECTION("re-adding replaces the song's terms") {
+        song.title = "Arabesque";
+        index.addSong(song, first);
+        REQUIRE(index.size() == 2);
+        REQUIRE(index.search("lune", 10).size() == 1);
+        REQUIRE(index.search("arabesque", 10).size() == 1);
+    }
+
+    SECTION("removing a song leaves its other playlists") {
+        index.removeSong(song.uuid, first);
+        const auto hits = index.search("debussy", 10);
+        REQUIRE(hits.size() == 1);
+        REQUIRE(hits[0].playlistId == second);
+    }
+
+    SECTION("removing a playlist removes its songs") {
+        index.removePlaylist(second);
+        REQUIRE(index.size() == 1);
+        index.clear();
+        REQUIRE(index.search("lune", 10).isEmpty());
+    }
+}
+
+TEST_CASE("PlaylistManager searches songs across playlists", "[playlist_manager][SongSearchIndex]") {
+    testutils::ensureQCoreApplication();
+    auto stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    auto dir = std::filesystem::temp_directory_path() / ("BilibiliPlayerTest_song_search_" + stamp);
+    std::filesystem::create_directories(dir);
+    {
+        ConfigManager cfg;
+        cfg.initialize(QString::fromStdString(dir.string()));
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+
+        playlist::CategoryInfo category{ "Search Cat", QUuid::createUuid() };
+        playlist::PlaylistInfo list;
+        list.name = "Search Playlist";
+        list.uuid = QUuid::createUuid();
+        REQUIRE(mgr.addCategory(category));
+        REQUIRE(mgr.addPlaylist(list, category.uuid));
+        const auto first = makeSong("Nocturne", "Chopin");
+        REQUIRE(mgr.addSongToPlaylist(first, list.uuid));
+        REQUIRE(mgr.searchSongs("noct").size() == 1);
+
+        // Changes after the first search reach the index through the signals
+        auto second = makeSong("Etude", "Chopin");
+        REQUIRE(mgr.addSongToPlaylist(second, list.uuid));
+        REQUIRE(mgr.searchSongs("chopin").size() == 2);
+        second.title = "Ballade";
+        REQUIRE(mgr.updateSongInPlaylist(second, list.uuid));
+        REQUIRE(mgr.searchSongs("etude").isEmpty());
+        REQUIRE(mgr.searchSongs("ballade").size() == 1);
+        REQUIRE(mgr.removeSongFromPlaylist(first, list.uuid));
+        REQUIRE(mgr.searchSongs("noct").isEmpty());
+        REQUIRE(mgr.removePlaylist(list.uuid, category.uuid));
+        REQUIRE(mgr.searchSongs("chopin").isEmpty());
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+}
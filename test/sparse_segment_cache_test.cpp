@@ -0,0 +1,206 @@
+/**
+ * SparseSegmentCache / SeekableRangeStream Unit Tests
+ *
+ * Covers out-of-order segment filling, index persistence and finalization of the
+ * on-disk cache, and seeking through a SeekableRangeStream backed by a fake range
+ * fetcher that records which byte ranges were requested.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <stream/sparse_segment_cache.hpp>
+#include <stream/seekable_range_stream.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr uint64_t kSegment = 4096;
+
+    std::string makeResource(size_t size) {
+        std::string data(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>((i * 31 + 7) & 0xFF);
+        }
+        return data;
+    }
+
+    std::string tempPath(const std::string& name) {
+        auto path = std::filesystem::temp_directory_path() / name;
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        std::filesystem::remove(path.string() + ".idx", ec);
+        return path.string();
+    }
+
+    // Serves `resource` from the requested offset in small chunks, like a ranged HTTP GET
+    struct FakeFetcher {
+        std::string resource;
+        std::mutex mutex;
+        std::vector<uint64_t> offsets;               // start offset of every request
+        std::atomic<uint64_t> bytesServed{0};
+
+        SeekableRangeStream::RangeFetcher fetcher() {
+            return [this](uint64_t offset, SeekableRangeStream::ContentReceiver receiver) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    offsets.push_back(offset);
+                }
+                return std::async(std::launch::async, [this, offset, receiver]() {
+                    const size_t chunk = 1024;
+                    for (uint64_t pos = offset; pos < resource.size(); pos += chunk) {
+                        size_t n = static_cast<size_t>(std::min<uint64_t>(chunk, resource.size() - pos));
+                        bytesServed += n;
+                        if (!receiver(resource.data() + pos, n)) return false;
+                    }
+                    return true;
+                });
+            };
+        }
+    };
+}
+
+TEST_CASE("SparseSegmentCache stores and serves segments", "[SparseSegmentCache]") {
+    const std::string resource = makeResource(kSegment * 3 + 100);
+    const std::string path = tempPath("bp_sparse_cache_test.part");
+
+    SECTION("Out-of-order writes are tracked per segment") {
+        SparseSegmentCache cache(resource.size(), kSegment);
+        REQUIRE(cache.open(path));
+        REQUIRE(cache.firstMissing(0) == 0);
+
+        // Fill segment 2 first, as after a seek
+        REQUIRE(cache.write(kSegment * 2, resource.data() + kSegment * 2, kSegment) == kSegment);
+        REQUIRE(cache.segmentComplete(kSegment * 2));
+        REQUIRE_FALSE(cache.segmentComplete(0));
+        REQUIRE(cache.firstMissing(kSegment * 2) == kSegment * 3);
+
+        char buf[64];
+        REQUIRE(cache.read(0, buf, sizeof(buf)) == 0);
+        REQUIRE(cache.read(kSegment * 2 + 10, buf, sizeof(buf)) == sizeof(buf));
+        REQUIRE(std::string(buf, sizeof(buf)) == resource.substr(kSegment * 2 + 10, sizeof(buf)));
+    }
+
+    SECTION("Writes must be contiguous within a segment") {
+        SparseSegmentCache cache(resource.size(), kSegment);
+        REQUIRE(cache.open(path));
+        REQUIRE(cache.write(100, resource.data() + 100, 10) == 0);  // leaves a hole
+        REQUIRE(cache.write(0, resource.data(), 200) == 200);
+        REQUIRE(cache.write(150, resource.data() + 150, 100) == 100);  // overlap is skipped
+        REQUIRE(cache.firstMissing(0) == 250);
+        REQUIRE(cache.cachedBytes() == 250);
+    }
+
+    SECTION("Index survives reopening and a complete cache finalizes") {
+        {
+            SparseSegmentCache cache(resource.size(), kSegment);
+            REQUIRE(cache.open(path));
+            REQUIRE(cache.write(0, resource.data(), kSegment * 2) == kSegment * 2);
+        }
+        SparseSegmentCache cache(resource.size(), kSegment);
+        REQUIRE(cache.open(path));
+        REQUIRE(cache.cachedBytes() == kSegment * 2);
+        REQUIRE(cache.firstMissing(0) == kSegment * 2);
+
+        const std::string finalPath = tempPath("bp_sparse_cache_test.m4a");
+        REQUIRE_FALSE(cache.finalize(finalPath));
+        REQUIRE(cache.write(kSegment * 2, resource.data() + kSegment * 2, resource.size() - kSegment * 2)
+                == resource.size() - kSegment * 2);
+        REQUIRE(cache.complete());
+        REQUIRE(cache.finalize(finalPath));
+        REQUIRE(std::filesystem::exists(finalPath));
+        REQUIRE_FALSE(std::filesystem::exists(path));
+        REQUIRE_FALSE(std::filesystem::exists(path + ".idx"));
+
+        std::vector<char> all(resource.size());
+        REQUIRE(cache.read(0, all.data(), all.size()) == resource.size());
+        REQUIRE(std::string(all.data(), all.size()) == resource);
+        std::filesystem::remove(finalPath);
+    }
+}
+
+TEST_CASE("SeekableRangeStream seeks without refetching", "[SeekableRangeStream]") {
+    const std::string resource = makeResource(kSegment * 64);
+    const std::string path = tempPath("bp_range_stream_test.part");
+
+    SECTION("Sequential read delivers the whole resource") {
+        FakeFetcher fake;
+        fake.resource = resource;
+        auto cache = std::make_shared<SparseSegmentCache>(resource.size(), kSegment);
+        REQUIRE(cache->open(path));
+        auto stream = std::make_shared<SeekableRangeStream>(cache, fake.fetcher());
+        stream->start();
+        auto in = stream->getInputStream();
+
+        std::string received;
+        char buf[3000];
+        while (in->read(buf, sizeof(buf)), in->gcount() > 0) {
+            received.append(buf, static_cast<size_t>(in->gcount()));
+        }
+        REQUIRE(received == resource);
+        REQUIRE(stream->wait());
+        REQUIRE(fake.bytesServed.load() == resource.size());
+    }
+
+    SECTION("Seeking far ahead starts a ranged fetch and gaps are filled once") {
+        FakeFetcher fake;
+        fake.resource = resource;
+        auto cache = std::make_shared<SparseSegmentCache>(resource.size(), kSegment);
+        REQUIRE(cache->open(path));
+        // Pre-cache the head, as if playback had already started
+        REQUIRE(cache->write(0, resource.data(), kSegment * 2) == kSegment * 2);
+
+        auto stream = std::make_shared<SeekableRangeStream>(cache, fake.fetcher());
+        auto in = stream->getInputStream();
+        const uint64_t target = kSegment * 40 + 123;
+        in->seekg(static_cast<std::streamoff>(target));
+        REQUIRE(static_cast<uint64_t>(in->tellg()) == target);
+        stream->start();
+
+        char buf[256];
+        in->read(buf, sizeof(buf));
+        REQUIRE(in->gcount() == sizeof(buf));
+        REQUIRE(std::string(buf, sizeof(buf)) == resource.substr(target, sizeof(buf)));
+
+        // Seeking back into the pre-cached head is served locally
+        in->seekg(100);
+        in->read(buf, sizeof(buf));
+        REQUIRE(std::string(buf, sizeof(buf)) == resource.substr(100, sizeof(buf)));
+
+        REQUIRE(stream->wait());
+        REQUIRE(cache->complete());
+        // No byte was downloaded twice, and the head was never fetched
+        REQUIRE(fake.bytesServed.load() <= resource.size() - kSegment * 2 + kSegment);
+        std::lock_guard<std::mutex> lock(fake.mutex);
+        REQUIRE(std::find(fake.offsets.begin(), fake.offsets.end(), 0) == fake.offsets.end());
+    }
+
+    SECTION("Closing unblocks readers with EOF") {
+        auto cache = std::make_shared<SparseSegmentCache>(resource.size(), kSegment);
+        REQUIRE(cache->open(path));
+        // A fetcher that never delivers anything
+        std::promise<bool> never;
+        auto pending = never.get_future().share();
+        auto stream = std::make_shared<SeekableRangeStream>(cache,
+            [pending](uint64_t, SeekableRangeStream::ContentReceiver) {
+                return std::async(std::launch::async, [pending]() {
+                    pending.wait_for(std::chrono::milliseconds(200));
+                    return false;
+                });
+            });
+        stream->start();
+        auto in = stream->getInputStream();
+        auto reader = std::async(std::launch::async, [in]() {
+            char c;
+            in->read(&c, 1);
+            return in->eof();
+        });
+        stream->close();
+        REQUIRE(reader.get());
+        REQUIRE_FALSE(stream->wait());
+    }
+}
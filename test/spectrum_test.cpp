@@ -0,0 +1,133 @@
+/**
+ * SpectrumTap / SpectrumAnalyzer Unit Tests
+ *
+ * Covers the tap's mono mixdown and drop-on-full behaviour, that a disabled tap
+ * ignores writes, that the analyzer places a sine in the right band, and that a
+ * suspended analyzer stops waking up.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/spectrum_tap.h>
+#include <audio/spectrum_analyzer.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace audio;
+
+namespace {
+    constexpr int kRate = 48000;
+
+    // Interleaved 16-bit stereo sine at the given frequency and peak amplitude
+    std::vector<int16_t> stereoSine(double hz, double amplitude, size_t frames) {
+        std::vector<int16_t> pcm(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            auto v = static_cast<int16_t>(std::lrint(amplitude * 32767.0
+                * std::sin(2.0 * 3.14159265358979323846 * hz * i / kRate)));
+            pcm[i * 2] = v;
+            pcm[i * 2 + 1] = v;
+        }
+        return pcm;
+    }
+
+    void writeS16(SpectrumTap& tap, const std::vector<int16_t>& pcm) {
+        tap.write(reinterpret_cast<const uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t), 2, 16, kRate);
+    }
+
+    // Poll until done() holds, for at most a few seconds
+    template <typename Predicate>
+    bool waitFor(Predicate done) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return done();
+    }
+}
+
+TEST_CASE("SpectrumTap buffers a mono mixdown", "[SpectrumTap]") {
+    SpectrumTap tap;
+
+    SECTION("Disabled tap ignores writes") {
+        float stereo[] = { 0.5f, 0.5f };
+        tap.write(reinterpret_cast<const uint8_t*>(stereo), sizeof(stereo), 2, 32, kRate);
+        REQUIRE(tap.available() == 0);
+        REQUIRE(tap.sampleRate() == 0);
+    }
+
+    SECTION("Channels are averaged") {
+        tap.setEnabled(true);
+        float stereo[] = { 1.0f, 0.0f, -0.5f, -0.5f };
+        tap.write(reinterpret_cast<const uint8_t*>(stereo), sizeof(stereo), 2, 32, kRate);
+        int16_t s16[] = { 16384, 16384 };
+        tap.write(reinterpret_cast<const uint8_t*>(s16), sizeof(s16), 2, 16, kRate);
+
+        float out[8];
+        REQUIRE(tap.read(out, 8) == 3);
+        REQUIRE(out[0] == 0.5f);
+        REQUIRE(out[1] == -0.5f);
+        REQUIRE(out[2] == 0.5f);
+        REQUIRE(tap.sampleRate() == kRate);
+    }
+
+    SECTION("A full tap drops instead of blocking") {
+        tap.setEnabled(true);
+        writeS16(tap, stereoSine(1000.0, 0.5, SpectrumTap::CAPACITY + 100));
+        REQUIRE(tap.available() == SpectrumTap::CAPACITY);
+        REQUIRE(tap.droppedSamples() == 100);
+
+        std::vector<float> out(SpectrumTap::CAPACITY);
+        REQUIRE(tap.read(out.data(), 1000) == 1000);
+        writeS16(tap, stereoSine(1000.0, 0.5, 10));
+        REQUIRE(tap.available() == SpectrumTap::CAPACITY - 990);
+    }
+}
+
+TEST_CASE("SpectrumAnalyzer finds a tone in its band", "[SpectrumAnalyzer]") {
+    auto tap = std::make_shared<SpectrumTap>();
+    tap->setEnabled(true);
+    SpectrumAnalyzer analyzer(tap);
+
+    std::vector<float> bands;
+    REQUIRE_FALSE(analyzer.update(bands));
+
+    writeS16(*tap, stereoSine(1000.0, 1.0, SpectrumAnalyzer::FFT_SIZE));
+    REQUIRE(analyzer.update(bands));
+    REQUIRE(bands.size() == static_cast<size_t>(SpectrumAnalyzer::BAND_COUNT));
+
+    int loudest = 0;
+    for (int band = 1; band < SpectrumAnalyzer::BAND_COUNT; ++band) {
+        if (bands[band] > bands[loudest]) loudest = band;
+    }
+    const double center = SpectrumAnalyzer::bandCenterHz(loudest, kRate);
+    REQUIRE(center > 1000.0 / 1.25);
+    REQUIRE(center < 1000.0 * 1.25);
+    // Full scale reads close to the top of the range; far-away bands stay low
+    REQUIRE(bands[loudest] > 0.95f);
+    REQUIRE(bands[0] < 0.5f);
+    REQUIRE(bands[SpectrumAnalyzer::BAND_COUNT - 1] < 0.5f);
+}
+
+TEST_CASE("SpectrumAnalyzer stops waking up while suspended", "[SpectrumAnalyzer]") {
+    auto tap = std::make_shared<SpectrumTap>();
+    SpectrumAnalyzer analyzer(tap);
+    analyzer.start();
+    REQUIRE(analyzer.isRunning());
+
+    // Nothing feeds the tap, so the bands are at zero and the worker parks after one update
+    analyzer.setSuspended(true);
+    REQUIRE(waitFor([&analyzer]() { return analyzer.isParked(); }));
+
+    analyzer.setSuspended(false);
+    REQUIRE(waitFor([&analyzer]() { return !analyzer.isParked(); }));
+
+    // Stopping wakes a parked worker too
+    analyzer.setSuspended(true);
+    REQUIRE(waitFor([&analyzer]() { return analyzer.isParked(); }));
+    analyzer.stop();
+    REQUIRE_FALSE(analyzer.isRunning());
+    REQUIRE_FALSE(analyzer.isParked());
+}
@@ -0,0 +1,117 @@
+/**
+ * SpscByteRing Utility Unit Tests
+ *
+ * Tests span acquisition and commit around the wrap point, the copying
+ * helpers, close semantics and a threaded producer/consumer hand-off.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/spsc_byte_ring.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SpscByteRing spans", "[SpscByteRing]") {
+    SECTION("Capacity is rounded up to a power of two") {
+        util::SpscByteRing ring(100);
+        REQUIRE(ring.capacity() == 128);
+        REQUIRE(ring.empty());
+        REQUIRE_THROWS_AS(util::SpscByteRing(0), std::invalid_argument);
+    }
+
+    SECTION("Committed bytes become readable in order") {
+        util::SpscByteRing ring(16);
+        auto w = ring.acquireWrite();
+        REQUIRE(w.second == 16);
+        std::memcpy(w.first, "abcdef", 6);
+        ring.commitWrite(6);
+        REQUIRE(ring.size() == 6);
+
+        auto r = ring.acquireRead();
+        REQUIRE(r.second == 6);
+        REQUIRE(std::string(r.first, 6) == "abcdef");
+        ring.commitRead(4);
+        REQUIRE(ring.size() == 2);
+        REQUIRE(std::string(ring.acquireRead().first, 2) == "ef");
+    }
+
+    SECTION("Spans stop at the end of the storage") {
+        util::SpscByteRing ring(8);
+        REQUIRE(ring.tryWrite("123456", 6) == 6);
+        char out[8];
+        REQUIRE(ring.tryRead(out, 5) == 5);
+
+        // Free space is 7 bytes, split 2 before and 5 after the wrap
+        auto w = ring.acquireWrite();
+        REQUIRE(w.second == 2);
+        REQUIRE(ring.tryWrite("abcdefgh", 8) == 7);
+        REQUIRE(ring.acquireWrite().second == 0);
+
+        auto r = ring.acquireRead();
+        REQUIRE(r.second == 3);
+        REQUIRE(ring.tryRead(out, 8) == 8);
+        REQUIRE(std::string(out, 8) == "6abcdefg");
+        REQUIRE(ring.empty());
+    }
+}
+
+TEST_CASE("SpscByteRing close semantics", "[SpscByteRing]") {
+    SECTION("Reader drains remaining bytes after the writer closes") {
+        util::SpscByteRing ring(16);
+        ring.tryWrite("xyz", 3);
+        ring.closeWriter();
+        REQUIRE(ring.waitReadable());
+        char out[4];
+        REQUIRE(ring.tryRead(out, 4) == 3);
+        REQUIRE_FALSE(ring.waitReadable());
+    }
+
+    SECTION("Closing the reader wakes a blocked writer") {
+        util::SpscByteRing ring(4);
+        ring.tryWrite("full", 4);
+        std::thread writer([&]() {
+            REQUIRE_FALSE(ring.waitWritable());
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ring.closeReader();
+        writer.join();
+    }
+}
+
+TEST_CASE("SpscByteRing threaded transfer", "[SpscByteRing]") {
+    util::SpscByteRing ring(256);
+    std::vector<char> data(64 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>((i * 31) & 0xFF);
+    }
+
+    std::thread producer([&]() {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            auto span = ring.acquireWrite();
+            if (span.second == 0) {
+                ring.waitWritable();
+                continue;
+            }
+            // Odd chunk sizes so commits land at every offset around the wrap
+            size_t chunk = std::min({ span.second, data.size() - sent, size_t(37) });
+            std::memcpy(span.first, data.data() + sent, chunk);
+            ring.commitWrite(chunk);
+            sent += chunk;
+        }
+        ring.closeWriter();
+    });
+
+    std::vector<char> received;
+    while (ring.waitReadable()) {
+        auto span = ring.acquireRead();
+        received.insert(received.end(), span.first, span.first + span.second);
+        ring.commitRead(span.second);
+    }
+    producer.join();
+
+    REQUIRE(received == data);
+}
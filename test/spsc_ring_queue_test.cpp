@@ -0,0 +1,224 @@
+/**
+ * SpscRingQueue Utility Unit Tests
+ *
+ * Tests bounded single-producer/single-consumer queue operations,
+ * watermark backpressure and close semantics.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/spsc_ring_queue.hpp>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <memory>
+
+TEST_CASE("SpscRingQueue basic operations", "[SpscRingQueue]") {
+    SECTION("Capacity is rounded up to a power of two") {
+        util::SpscRingQueue<int> queue(5);
+
+        REQUIRE(queue.capacity() == 8);
+        REQUIRE(queue.empty() == true);
+        REQUIRE(queue.size() == 0);
+    }
+
+    SECTION("Zero capacity throws") {
+        REQUIRE_THROWS_AS(util::SpscRingQueue<int>(0), std::invalid_argument);
+    }
+
+    SECTION("FIFO order") {
+        util::SpscRingQueue<int> queue(16);
+
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(queue.tryPush(i) == true);
+        }
+        REQUIRE(queue.size() == 10);
+
+        for (int i = 0; i < 10; ++i) {
+            int value = -1;
+            REQUIRE(queue.tryPop(value) == true);
+            REQUIRE(value == i);
+        }
+        REQUIRE(queue.empty() == true);
+    }
+
+    SECTION("tryPush fails when full, tryPop fails when empty") {
+        util::SpscRingQueue<int> queue(4);
+
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(queue.tryPush(i) == true);
+        }
+        REQUIRE(queue.tryPush(99) == false);
+
+        int value;
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(queue.tryPop(value) == true);
+        }
+        REQUIRE(queue.tryPop(value) == false);
+    }
+
+    SECTION("Wrap-around keeps order") {
+        util::SpscRingQueue<int> queue(4);
+        int next = 0;
+        int expected = 0;
+        for (int round = 0; round < 10; ++round) {
+            REQUIRE(queue.tryPush(next++) == true);
+            REQUIRE(queue.tryPush(next++) == true);
+            int value;
+            REQUIRE(queue.tryPop(value) == true);
+            REQUIRE(value == expected++);
+            REQUIRE(queue.tryPop(value) == true);
+            REQUIRE(value == expected++);
+        }
+    }
+
+    SECTION("Popped slots release their payload") {
+        util::SpscRingQueue<std::shared_ptr<int>> queue(4);
+        auto item = std::make_shared<int>(7);
+        std::weak_ptr<int> weak = item;
+
+        REQUIRE(queue.tryPush(std::move(item)) == true);
+        std::shared_ptr<int> out;
+        REQUIRE(queue.tryPop(out) == true);
+        out.reset();
+
+        REQUIRE(weak.expired() == true);
+    }
+
+    SECTION("Clean drops queued items") {
+        util::SpscRingQueue<int> queue(8);
+        queue.tryPush(1);
+        queue.tryPush(2);
+
+        queue.clean();
+
+        REQUIRE(queue.empty() == true);
+    }
+}
+
+TEST_CASE("SpscRingQueue watermarks", "[SpscRingQueue]") {
+    SECTION("Default watermarks are 3/4 and 1/4 of capacity") {
+        util::SpscRingQueue<int> queue(16);
+
+        REQUIRE(queue.highWatermark() == 12);
+        REQUIRE(queue.lowWatermark() == 4);
+    }
+
+    SECTION("push blocks at high watermark until drained to low watermark") {
+        util::SpscRingQueue<int> queue(8, 4, 1);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(queue.push(i) == true);
+        }
+
+        std::atomic<bool> pushed{false};
+        std::thread producer([&]() {
+            queue.push(4);
+            pushed.store(true);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(pushed.load() == false);
+
+        int value;
+        REQUIRE(queue.tryPop(value) == true);
+        REQUIRE(queue.tryPop(value) == true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // Still above the low watermark (2 > 1)
+        REQUIRE(pushed.load() == false);
+
+        REQUIRE(queue.tryPop(value) == true);
+        producer.join();
+        REQUIRE(pushed.load() == true);
+        REQUIRE(queue.size() == 2);
+    }
+}
+
+TEST_CASE("SpscRingQueue blocking and close", "[SpscRingQueue]") {
+    SECTION("waitPop blocks until data available") {
+        util::SpscRingQueue<int> queue(8);
+
+        std::thread producer([&queue]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            queue.push(42);
+        });
+
+        int value = 0;
+        REQUIRE(queue.waitPop(value) == true);
+        REQUIRE(value == 42);
+
+        producer.join();
+    }
+
+    SECTION("close wakes a waiting consumer") {
+        util::SpscRingQueue<int> queue(8);
+
+        std::thread closer([&queue]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            queue.close();
+        });
+
+        int value;
+        REQUIRE(queue.waitPop(value) == false);
+
+        closer.join();
+    }
+
+    SECTION("close wakes a producer blocked on backpressure") {
+        util::SpscRingQueue<int> queue(4, 2, 1);
+        queue.push(1);
+        queue.push(2);
+
+        std::atomic<int> result{-1};
+        std::thread producer([&]() {
+            result.store(queue.push(3) ? 1 : 0);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        queue.close();
+        producer.join();
+
+        REQUIRE(result.load() == 0);
+    }
+
+    SECTION("Items queued before close can still be drained") {
+        util::SpscRingQueue<int> queue(8);
+        queue.push(1);
+        queue.push(2);
+        queue.close();
+
+        REQUIRE(queue.tryPush(3) == false);
+
+        int value;
+        REQUIRE(queue.waitPop(value) == true);
+        REQUIRE(value == 1);
+        REQUIRE(queue.waitPop(value) == true);
+        REQUIRE(value == 2);
+        REQUIRE(queue.waitPop(value) == false);
+    }
+}
+
+TEST_CASE("SpscRingQueue producer/consumer stress", "[SpscRingQueue]") {
+    util::SpscRingQueue<int> queue(64);
+    constexpr int total_items = 100000;
+
+    std::thread producer([&queue]() {
+        for (int i = 0; i < total_items; ++i) {
+            queue.push(i);
+        }
+        queue.close();
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    int value;
+    while (queue.waitPop(value)) {
+        if (value != expected) {
+            ordered = false;
+        }
+        ++expected;
+    }
+    producer.join();
+
+    REQUIRE(ordered == true);
+    REQUIRE(expected == total_items);
+}
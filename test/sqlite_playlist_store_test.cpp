@@ -0,0 +1,195 @@
+/**
+ * SqlitePlaylistStore Unit Tests
+ *
+ * Tests change records applied in order, loading headers and songs apart,
+ * replaceAll, removals cascading to songs, and PlaylistManager running on the
+ * database backend.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <QDir>
+#include <QFile>
+#include <chrono>
+#include <filesystem>
+#include <json/json.h>
+
+#include "config/config_manager.h"
+#include "playlist/playlist_json.h"
+#include "playlist/playlist_manager.h"
+#include "playlist/sqlite_playlist_store.h"
+#include "test_utils.h"
+
+using playlist::SqlitePlaylistStore;
+using testutils::TempDir;
+using testutils::makeSong;
+
+namespace {
+    Json::Value record(const char* op, const char* key, Json::Value value)
+    {
+        Json::Value change(Json::objectValue);
+        change["op"] = op;
+        change[key] = std::move(value);
+        return change;
+    }
+
+    Json::Value songRecord(const char* op, const playlist::SongInfo& song, const QUuid& playlistId)
+    {
+        Json::Value change = record(op, "song", playlist::songToJson(song));
+        change["playlistId"] = playlistId.toString().toStdString();
+        return change;
+    }
+
+    QStringList titles(const QList<playlist::SongInfo>& songs)
+    {
+        QStringList result;
+        for (const auto& song : songs) {
+            result << song.title;
+        }
+        return result;
+    }
+}
+
+TEST_CASE("SqlitePlaylistStore applies change records", "[SqlitePlaylistStore]") {
+    TempDir dir("sqlite_store");
+    const std::string path = dir.file("playlists.db");
+
+    playlist::CategoryInfo category{ "Music", QUuid::createUuid() };
+    playlist::PlaylistInfo list;
+    list.name = "Favourites";
+    list.uuid = QUuid::createUuid();
+    playlist::SongInfo a = makeSong("A");
+    playlist::SongInfo b = makeSong("B");
+    playlist::SongInfo c = makeSong("C");
+
+    {
+        SqlitePlaylistStore store;
+        REQUIRE(store.open(path));
+        REQUIRE(store.isEmpty());
+
+        Json::Value addList = record("addPlaylist", "playlist", playlist::playlistToJson(list));
+        addList["categoryId"] = category.uuid.toString().toStdString();
+        REQUIRE(store.apply({
+            record("addCategory", "category", playlist::categoryToJson(category)),
+            addList,
+            songRecord("addSong", a, list.uuid),
+            songRecord("addSong", b, list.uuid),
+            songRecord("addSong", c, list.uuid),
+            record("setCurrentPlaylist", "playlistId", list.uuid.toString().toStdString()),
+        }));
+
+        a.title = "A renamed";
+        Json::Value removeB = record("removeSong", "songId", b.uuid.toString().toStdString());
+        removeB["playlistId"] = list.uuid.toString().toStdString();
+        REQUIRE(store.apply({ songRecord("updateSong", a, list.uuid), removeB }));
+        REQUIRE_FALSE(store.isEmpty());
+    }
+
+    // Reopened, it reads back what was applied, in order
+    SqlitePlaylistStore store;
+    REQUIRE(store.open(path));
+    SqlitePlaylistStore::Contents contents;
+    REQUIRE(store.load(contents));
+    REQUIRE(contents.categories.size() == 1);
+    REQUIRE(contents.categories[0].name == "Music");
+    REQUIRE(contents.playlists.value(category.uuid).size() == 1);
+    REQUIRE(contents.playlists.value(category.uuid)[0].name == "Favourites");
+    REQUIRE(titles(contents.songs.value(list.uuid)) == QStringList{ "A renamed", "C" });
+    REQUIRE(contents.songs.value(list.uuid)[1].uuid == c.uuid);
+    REQUIRE(contents.currentPlaylistId == list.uuid);
+
+    SECTION("headers and songs load separately") {
+        SqlitePlaylistStore::Contents headers;
+        REQUIRE(store.loadHeaders(headers));
+        REQUIRE(headers.playlists.value(category.uuid).size() == 1);
+        REQUIRE(headers.songs.isEmpty());
+
+        Json::Value loudness = record("setSongLoudness", "songId", c.uuid.toString().toStdString());
+        loudness["gainDb"] = -2.5;
+        REQUIRE(store.apply({ loudness }));
+        QList<playlist::SongInfo> songs;
+        REQUIRE(store.loadSongs(list.uuid, songs));
+        REQUIRE(titles(songs) == QStringList{ "A renamed", "C" });
+        REQUIRE_FALSE(songs[0].loudnessAnalyzed);
+        REQUIRE(songs[1].loudnessAnalyzed);
+        REQUIRE(songs[1].loudnessGainDb == -2.5f);
+    }
+
+    SECTION("removing a category removes its playlists and songs") {
+        REQUIRE(store.apply({ record("removeCategory", "categoryId", category.uuid.toString().toStdString()) }));
+        SqlitePlaylistStore::Contents after;
+        REQUIRE(store.load(after));
+        REQUIRE(after.categories.isEmpty());
+        REQUIRE(after.playlists.isEmpty());
+        REQUIRE(after.songs.isEmpty());
+        REQUIRE(store.isEmpty());
+    }
+
+    SECTION("an unknown record rolls back the whole batch") {
+        Json::Value unknown(Json::objectValue);
+        unknown["op"] = "noSuchOp";
+        REQUIRE_FALSE(store.apply({ songRecord("addSong", makeSong("D"), list.uuid), unknown }));
+        SqlitePlaylistStore::Contents after;
+        REQUIRE(store.load(after));
+        REQUIRE(titles(after.songs.value(list.uuid)) == QStringList{ "A renamed", "C" });
+    }
+}
+
+TEST_CASE("SqlitePlaylistStore replaceAll", "[SqlitePlaylistStore]") {
+    TempDir dir("sqlite_store");
+    SqlitePlaylistStore store;
+    REQUIRE(store.open(dir.file("playlists.db")));
+
+    SqlitePlaylistStore::Contents contents;
+    playlist::CategoryInfo first{ "First", QUuid::createUuid() };
+    playlist::CategoryInfo second{ "Second", QUuid::createUuid() };
+    contents.categories << first << second;
+    playlist::PlaylistInfo list;
+    list.name = "List";
+    list.uuid = QUuid::createUuid();
+    contents.playlists[second.uuid] << list;
+    contents.songs[list.uuid] << makeSong("Z") << makeSong("Y") << makeSong("X");
+    contents.currentPlaylistId = list.uuid;
+    REQUIRE(store.replaceAll(contents));
+
+    // Replacing again drops what was there before
+    REQUIRE(store.replaceAll(contents));
+    SqlitePlaylistStore::Contents loaded;
+    REQUIRE(store.load(loaded));
+    REQUIRE(loaded.categories.size() == 2);
+    REQUIRE(loaded.categories[0].uuid == first.uuid);
+    REQUIRE(loaded.categories[1].uuid == second.uuid);
+    REQUIRE(loaded.playlists.value(first.uuid).isEmpty());
+    REQUIRE(titles(loaded.songs.value(list.uuid)) == QStringList{ "Z", "Y", "X" });
+    REQUIRE(loaded.currentPlaylistId == list.uuid);
+}
+
+TEST_CASE("PlaylistManager stores playlists in SQLite when configured", "[playlist_manager][SqlitePlaylistStore]") {
+    testutils::ensureQCoreApplication();
+    TempDir dir("sqlite_store");
+    ConfigManager cfg;
+    cfg.initialize(QString::fromStdString(dir.path.string()));
+    cfg.setPlaylistStorage("sqlite");
+
+    playlist::CategoryInfo category{ "Db Cat", QUuid::createUuid() };
+    playlist::PlaylistInfo list;
+    list.name = "Db Playlist";
+    list.uuid = QUuid::createUuid();
+    {
+        PlaylistManager mgr(&cfg);
+        mgr.initialize();
+        REQUIRE(mgr.addCategory(category));
+        REQUIRE(mgr.addPlaylist(list, category.uuid));
+        REQUIRE(mgr.addSongToPlaylist(makeSong("One"), list.uuid));
+        REQUIRE(mgr.addSongToPlaylist(makeSong("Two"), list.uuid));
+        mgr.saveAllCategories();
+    }
+
+    PlaylistManager mgr(&cfg);
+    mgr.initialize();
+    REQUIRE(mgr.getCategory(category.uuid).has_value());
+    REQUIRE(mgr.getPlaylist(list.uuid).has_value());
+    QStringList loaded;
+    mgr.iterateSongsInPlaylist(list.uuid, [&](const playlist::SongInfo& song) { loaded << song.title; return true; });
+    REQUIRE(loaded == QStringList{ "One", "Two" });
+}
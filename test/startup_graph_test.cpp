@@ -0,0 +1,145 @@
+/**
+ * StartupGraph Unit Tests
+ *
+ * Tests ordering by dependencies, Caller steps staying on the calling thread,
+ * independent steps overlapping, run() returning while background Worker
+ * steps finish, and failures skipping what comes after them.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <manager/startup_graph.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Affinity = StartupGraph::Affinity;
+
+TEST_CASE("StartupGraph runs steps after the ones they need", "[StartupGraph]") {
+    StartupGraph graph(2);
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& name) {
+        return [&, name]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+        };
+    };
+    const std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> callerStepsOnCaller{true};
+    auto onCaller = [&](const std::string& name) {
+        return [&, name, step = record(name)]() {
+            callerStepsOnCaller = callerStepsOnCaller && std::this_thread::get_id() == caller;
+            step();
+        };
+    };
+
+    graph.add("config", {}, Affinity::Caller, onCaller("config"));
+    graph.add("cache", {"config"}, Affinity::Worker, record("cache"));
+    graph.add("network", {"config"}, Affinity::Worker, record("network"));
+    graph.add("playlist", {"config", "cache"}, Affinity::Caller, onCaller("playlist"));
+    graph.add("audio", {"playlist", "network"}, Affinity::Caller, onCaller("audio"));
+    graph.run();
+
+    auto position = [&](const std::string& name) {
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    };
+    REQUIRE(order.size() == 5);
+    REQUIRE(position("config") == 0);
+    REQUIRE(position("cache") < position("playlist"));
+    REQUIRE(position("network") < position("audio"));
+    REQUIRE(position("playlist") < position("audio"));
+    REQUIRE(callerStepsOnCaller);
+    REQUIRE(graph.isDone("audio"));
+}
+
+TEST_CASE("StartupGraph overlaps independent steps", "[StartupGraph]") {
+    StartupGraph graph(2);
+    std::promise<void> workerStarted;
+    std::promise<void> callerStarted;
+    auto callerStartedFuture = callerStarted.get_future();
+    std::atomic<bool> workerSawCaller{false};
+    bool callerSawWorker = false;
+
+    // Each waits for the other to have started, which only works if they overlap
+    graph.add("worker", {}, Affinity::Worker, [&]() {
+        workerStarted.set_value();
+        workerSawCaller = callerStartedFuture.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    });
+    graph.add("caller", {}, Affinity::Caller, [&]() {
+        callerStarted.set_value();
+        callerSawWorker = workerStarted.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+    });
+    graph.run();
+    graph.wait();
+    REQUIRE(callerSawWorker);
+    REQUIRE(workerSawCaller);
+}
+
+TEST_CASE("StartupGraph leaves background steps running after run()", "[StartupGraph]") {
+    StartupGraph graph(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> followUpRan{false};
+
+    graph.add("ui", {}, Affinity::Caller, []() {});
+    graph.add("slow", {}, Affinity::Worker, [released]() { released.wait(); });
+    graph.add("after slow", {"slow"}, Affinity::Worker, [&]() { followUpRan = true; });
+    graph.run();
+
+    REQUIRE(graph.isDone("ui"));
+    REQUIRE_FALSE(graph.isDone("slow"));
+    release.set_value();
+    graph.wait();
+    REQUIRE(graph.isDone("slow"));
+    REQUIRE(followUpRan);
+}
+
+TEST_CASE("StartupGraph failures skip the steps after them", "[StartupGraph]") {
+    std::mutex mutex;
+    std::vector<std::string> failed;
+    std::atomic<bool> dependentRan{false};
+
+    SECTION("a failure a Caller step needs is rethrown by run()") {
+        StartupGraph graph(1);
+        graph.setFailureHandler([&](const std::string& step, std::exception_ptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed.push_back(step);
+        });
+        graph.add("network", {}, Affinity::Worker, []() { throw std::runtime_error("no platform config"); });
+        graph.add("independent", {}, Affinity::Caller, []() {});
+        graph.add("search", {"network"}, Affinity::Caller, [&]() { dependentRan = true; });
+        REQUIRE_THROWS_AS(graph.run(), std::runtime_error);
+        REQUIRE_FALSE(dependentRan);
+        REQUIRE(graph.isDone("independent"));
+        REQUIRE(failed == std::vector<std::string>{"network"});
+    }
+
+    SECTION("a background failure only reaches the handler") {
+        StartupGraph graph(1);
+        graph.setFailureHandler([&](const std::string& step, std::exception_ptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed.push_back(step);
+        });
+        graph.add("ui", {}, Affinity::Caller, []() {});
+        graph.add("cache", {}, Affinity::Worker, []() { throw std::runtime_error("unreadable index"); });
+        graph.add("attach", {"cache"}, Affinity::Worker, [&]() { dependentRan = true; });
+        REQUIRE_NOTHROW(graph.run());
+        graph.wait();
+        REQUIRE_FALSE(dependentRan);
+        REQUIRE_FALSE(graph.isDone("attach"));
+        REQUIRE(failed == std::vector<std::string>{"cache"});
+    }
+}
+
+TEST_CASE("StartupGraph rejects unknown and duplicate steps", "[StartupGraph]") {
+    StartupGraph graph;
+    graph.add("config", {}, Affinity::Caller, []() {});
+    REQUIRE_THROWS_AS(graph.add("config", {}, Affinity::Caller, []() {}), std::invalid_argument);
+    REQUIRE_THROWS_AS(graph.add("theme", {"missing"}, Affinity::Caller, []() {}), std::invalid_argument);
+}
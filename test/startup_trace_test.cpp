@@ -0,0 +1,74 @@
+/**
+ * StartupTrace Unit Tests
+ *
+ * Tests span timing relative to the origin, marks counting once, and the
+ * summary's ordering and nesting.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/startup_trace.h>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+using util::StartupTrace;
+using namespace std::chrono_literals;
+
+TEST_CASE("StartupTrace records spans and marks from its origin", "[StartupTrace]") {
+    StartupTrace& trace = StartupTrace::instance();
+    const StartupTrace::Clock::time_point origin = StartupTrace::Clock::now();
+    trace.start(origin);
+
+    trace.record("config", origin, origin + 20ms);
+    {
+        StartupTrace::Scope scope("scoped");
+        std::this_thread::sleep_for(2ms);
+    }
+    REQUIRE(trace.mark("first window paint"));
+    REQUIRE_FALSE(trace.mark("first window paint"));
+    REQUIRE(trace.hasMark("first window paint"));
+    REQUIRE_FALSE(trace.hasMark("ui ready"));
+
+    const auto spans = trace.spans();
+    REQUIRE(spans.size() == 3);
+    REQUIRE(spans[0].name == "config");
+    REQUIRE(spans[0].startMs == 0.0);
+    REQUIRE(spans[0].durationMs == 20.0);
+    REQUIRE(spans[1].name == "scoped");
+    REQUIRE(spans[1].durationMs >= 2.0);
+    REQUIRE(spans[2].name == "first window paint");
+    REQUIRE(spans[2].startMs >= spans[1].startMs + spans[1].durationMs);
+    REQUIRE(spans[2].durationMs == 0);
+
+    SECTION("start() clears the trace") {
+        trace.start();
+        REQUIRE(trace.spans().empty());
+        REQUIRE_FALSE(trace.hasMark("first window paint"));
+    }
+}
+
+TEST_CASE("StartupTrace summary indents spans inside others", "[StartupTrace]") {
+    StartupTrace& trace = StartupTrace::instance();
+    const StartupTrace::Clock::time_point origin = StartupTrace::Clock::now();
+    trace.start(origin);
+
+    trace.record("initialize", origin + 0ms, origin + 100ms);
+    trace.record("ConfigManager", origin + 0ms, origin + 20ms);
+    trace.record("PlaylistManager", origin + 20ms, origin + 90ms);
+    // Overlaps initialize without lying within it, e.g. a background step
+    trace.record("AudioCacheStore (worker)", origin + 50ms, origin + 150ms);
+
+    const std::string summary = trace.summary();
+    // The times take the same width on every line, so the name's column is its indent
+    const auto indentOf = [&](const std::string& name) {
+        const size_t at = summary.find(name);
+        REQUIRE(at != std::string::npos);
+        const size_t lineStart = summary.rfind('\n', at);
+        return at - (lineStart == std::string::npos ? 0 : lineStart + 1);
+    };
+    REQUIRE(summary.find("initialize") < summary.find("ConfigManager"));
+    REQUIRE(indentOf("ConfigManager") == indentOf("initialize") + 2);
+    REQUIRE(indentOf("PlaylistManager") == indentOf("initialize") + 2);
+    REQUIRE(indentOf("AudioCacheStore (worker)") == indentOf("initialize"));
+}
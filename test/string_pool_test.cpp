@@ -0,0 +1,108 @@
+/**
+ * StringPool Unit Tests
+ *
+ * Tests equal strings sharing one buffer, pruning, and the memory a library of
+ * songs with repeated uploaders and cover names saves.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <QList>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+#include "playlist/playlist.h"
+#include "util/string_pool.h"
+
+using util::StringPool;
+
+namespace {
+    // Heap bytes of the distinct string buffers, however many strings refer to each
+    size_t bufferBytes(const QList<playlist::SongInfo>& songs)
+    {
+        std::unordered_set<const QChar*> seen;
+        size_t bytes = 0;
+        auto count = [&](const QString& text) {
+            if (!text.isEmpty() && seen.insert(text.constData()).second) {
+                bytes += 16 + (static_cast<size_t>(text.capacity()) + 1) * sizeof(QChar);
+            }
+        };
+        for (const auto& song : songs) {
+            count(song.uploader);
+            count(song.filepath);
+            count(song.coverName);
+        }
+        return bytes;
+    }
+}
+
+TEST_CASE("StringPool shares equal strings", "[StringPool]") {
+    StringPool pool;
+    // Built separately, as a loader would, so the two start with their own buffers
+    QString first = QString::fromStdString(std::string("uploader"));
+    QString second = QString::fromStdString(std::string("uploader"));
+    REQUIRE(first.constData() != second.constData());
+
+    pool.internInPlace(first);
+    pool.internInPlace(second);
+    REQUIRE(first == "uploader");
+    REQUIRE(first.constData() == second.constData());
+    REQUIRE(pool.size() == 1);
+
+    QString empty;
+    pool.internInPlace(empty);
+    REQUIRE(pool.size() == 1);
+    REQUIRE(pool.intern("other") == "other");
+    REQUIRE(pool.size() == 2);
+
+    SECTION("prune keeps strings still in use") {
+        pool.prune();
+        REQUIRE(pool.size() == 1);
+        first.clear();
+        pool.prune();
+        REQUIRE(pool.size() == 1);
+        second.clear();
+        pool.prune();
+        REQUIRE(pool.size() == 0);
+    }
+
+    SECTION("a changed copy leaves the pooled string alone") {
+        first.append("!");
+        REQUIRE(second == "uploader");
+        REQUIRE(pool.intern(QString::fromStdString(std::string("uploader"))).constData() == second.constData());
+    }
+}
+
+TEST_CASE("StringPool memory saved on a large library", "[StringPool][benchmark]") {
+    // 100k songs by 500 uploaders, ten songs to an album cover, each song in two playlists
+    const int songCount = 100000;
+    QList<playlist::SongInfo> songs;
+    songs.reserve(songCount * 2);
+    for (int copy = 0; copy < 2; ++copy) {
+        for (int i = 0; i < songCount; ++i) {
+            playlist::SongInfo song;
+            song.platform = 1;
+            song.duration = 200;
+            song.uploader = QString::fromStdString("Uploader number " + std::to_string(i % 500));
+            song.filepath = QString::fromStdString("/home/user/.cache/BilibiliPlayer/audio/" + std::to_string(i) + ".audio");
+            song.coverName = QString::fromStdString("cover_" + std::to_string(i / 10) + "_0123456789abcdef.jpg");
+            songs.append(song);
+        }
+    }
+    const size_t before = bufferBytes(songs);
+
+    StringPool pool;
+    for (auto& song : songs) {
+        pool.internInPlace(song.uploader);
+        pool.internInPlace(song.filepath);
+        pool.internInPlace(song.coverName);
+    }
+    const size_t after = bufferBytes(songs);
+
+    std::cout << "Interned " << songs.size() << " songs into " << pool.size() << " strings: "
+              << before / 1024 << " KiB of string data down to " << after / 1024 << " KiB ("
+              << static_cast<double>(before) / static_cast<double>(after) << "x)" << std::endl;
+    REQUIRE(pool.size() == 500 + songCount + songCount / 10);
+    REQUIRE(after * 2 < before);
+}
@@ -0,0 +1,134 @@
+/**
+ * TagLibCoverExtractor Unit Tests
+ *
+ * Extracts the picture of an ID3v2 tag written by the test, and checks that covers
+ * are scaled down to the thumbnail size once: re-encoded as JPEG, or PNG when they
+ * have transparency, and left alone when they already fit.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/taglib_cover.h>
+#include <QBuffer>
+#include <QColor>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTemporaryDir>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "test_utils.h"
+
+using audio::TagLibCoverExtractor;
+
+namespace {
+    std::vector<uint8_t> encode(const QImage& image, const char* format) {
+        QByteArray bytes;
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        REQUIRE(image.save(&buffer, format));
+        return std::vector<uint8_t>(bytes.begin(), bytes.end());
+    }
+
+    QImage decode(const std::vector<uint8_t>& data) {
+        return QImage::fromData(QByteArray(reinterpret_cast<const char*>(data.data()), static_cast<qsizetype>(data.size())));
+    }
+
+    QImage gradient(int width, int height, QImage::Format format) {
+        QImage image(width, height, format);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                image.setPixelColor(x, y, QColor(x % 256, y % 256, (x + y) % 256));
+            }
+        }
+        return image;
+    }
+
+    void appendBigEndian(std::string& out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    // An .mp3: an ID3v2.3 tag with one front cover APIC frame, then a few silent frames
+    bool writeTaggedMp3(const QString& path, const std::vector<uint8_t>& picture) {
+        std::string frameBody;
+        frameBody.push_back('\0');                          // Latin-1
+        frameBody.append("image/png").push_back('\0');
+        frameBody.push_back('\x03');                        // Front cover
+        frameBody.push_back('\0');                          // Empty description
+        frameBody.append(reinterpret_cast<const char*>(picture.data()), picture.size());
+
+        std::string frame = "APIC";
+        appendBigEndian(frame, static_cast<uint32_t>(frameBody.size()));
+        frame.append(2, '\0');                              // Flags
+        frame += frameBody;
+
+        std::string content = "ID3";
+        content.push_back('\x03');
+        content.append(2, '\0');                            // Revision, flags
+        const uint32_t size = static_cast<uint32_t>(frame.size());
+        for (int shift = 21; shift >= 0; shift -= 7) {      // Syncsafe
+            content.push_back(static_cast<char>((size >> shift) & 0x7F));
+        }
+        content += frame;
+
+        for (int i = 0; i < 4; ++i) {
+            // MPEG-1 Layer III, 128 kbit/s, 44.1 kHz: 417 bytes per frame
+            std::string audioFrame("\xFF\xFB\x90\x64", 4);
+            audioFrame.resize(417, '\0');
+            content += audioFrame;
+        }
+
+        QFile file(path);
+        return file.open(QIODevice::WriteOnly) && file.write(content.data(), static_cast<qint64>(content.size())) == static_cast<qint64>(content.size());
+    }
+}
+
+TEST_CASE("TagLibCoverExtractor reads the picture from the tag", "[TagLibCover]") {
+    testutils::ensureQCoreApplication();
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const std::vector<uint8_t> png = encode(gradient(1000, 500, QImage::Format_RGB32), "png");
+    const QString path = QDir(tmp.path()).filePath("tagged.mp3");
+    REQUIRE(writeTaggedMp3(path, png));
+
+    REQUIRE(TagLibCoverExtractor::extractCover(path) == png);
+
+    const std::vector<uint8_t> thumbnail = TagLibCoverExtractor::extractThumbnail(path, 320);
+    REQUIRE(TagLibCoverExtractor::detectImageFormat(thumbnail) == "jpeg");
+    REQUIRE(decode(thumbnail).size() == QSize(320, 160));
+    REQUIRE(thumbnail.size() < png.size());
+
+    REQUIRE(TagLibCoverExtractor::extractCover(QDir(tmp.path()).filePath("missing.mp3")).empty());
+}
+
+TEST_CASE("TagLibCoverExtractor scales covers down to the thumbnail size", "[TagLibCover]") {
+    testutils::ensureQCoreApplication();
+
+    SECTION("Large opaque covers become JPEG thumbnails") {
+        const std::vector<uint8_t> original = encode(gradient(600, 1200, QImage::Format_RGB32), "png");
+        const std::vector<uint8_t> scaled = TagLibCoverExtractor::scaleCover(original, 300);
+        REQUIRE(TagLibCoverExtractor::detectImageFormat(scaled) == "jpeg");
+        REQUIRE(decode(scaled).size() == QSize(150, 300));
+    }
+
+    SECTION("Transparent covers stay PNG") {
+        QImage transparent = gradient(800, 800, QImage::Format_ARGB32);
+        transparent.setPixelColor(0, 0, QColor(0, 0, 0, 0));
+        const std::vector<uint8_t> scaled = TagLibCoverExtractor::scaleCover(encode(transparent, "png"), 200);
+        REQUIRE(TagLibCoverExtractor::detectImageFormat(scaled) == "png");
+        REQUIRE(decode(scaled).size() == QSize(200, 200));
+    }
+
+    SECTION("Covers that fit, size 0 and undecodable data are returned as they are") {
+        const std::vector<uint8_t> small = encode(gradient(200, 100, QImage::Format_RGB32), "png");
+        REQUIRE(TagLibCoverExtractor::scaleCover(small, 320) == small);
+
+        const std::vector<uint8_t> large = encode(gradient(1000, 1000, QImage::Format_RGB32), "jpeg");
+        REQUIRE(TagLibCoverExtractor::scaleCover(large, 0) == large);
+
+        const std::vector<uint8_t> garbage(100, 0x42);
+        REQUIRE(TagLibCoverExtractor::scaleCover(garbage, 320) == garbage);
+    }
+}
@@ -5,7 +5,12 @@
 #include <QByteArray>
 #include <QString>
 #include <QCoreApplication>
+#include <QUuid>
+#include <chrono>
+#include <filesystem>
 #include <memory>
+#include <string>
+#include "playlist/playlist.h"
 
 namespace testutils {
 
@@ -42,4 +47,35 @@ inline void ensureQCoreApplication()
     (void)s_app;
 }
 
+// A fresh directory under the system temp directory, removed with its contents when
+// the test is done; name tells the tests' directories apart
+struct TempDir {
+    explicit TempDir(const std::string& name) {
+        auto stamp = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+        path = std::filesystem::temp_directory_path() / ("BilibiliPlayerTest_" + name + "_" + stamp);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+    std::string file(const char* name) const { return (path / name).string(); }
+    std::filesystem::path path;
+};
+
+// A song with every stored field set, its args derived from the title
+inline playlist::SongInfo makeSong(const QString& title)
+{
+    playlist::SongInfo song;
+    song.title = title;
+    song.uploader = "up";
+    song.platform = 1;
+    song.duration = 100;
+    song.args = title.toLower();
+    song.uuid = QUuid::createUuid();
+    return song;
+}
+
 } // namespace testutils
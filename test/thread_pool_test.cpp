@@ -0,0 +1,178 @@
+/**
+ * ThreadPool Unit Tests
+ *
+ * Tests results and exceptions through futures, priority order, the Low
+ * task limit, nested waits on a saturated pool, queue metrics and draining
+ * on destruction.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/thread_pool.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using util::ThreadPool;
+using Priority = util::ThreadPool::Priority;
+
+namespace {
+    // Occupies a worker until released
+    struct Gate {
+        std::promise<void> open;
+        std::shared_future<void> opened = open.get_future().share();
+    };
+}
+
+TEST_CASE("ThreadPool delivers results through futures", "[ThreadPool]") {
+    ThreadPool pool(2);
+
+    SECTION("values") {
+        auto future = pool.submit(Priority::Normal, []() { return 42; });
+        REQUIRE(future.get() == 42);
+    }
+
+    SECTION("exceptions") {
+        auto future = pool.submit(Priority::High, []() -> int { throw std::runtime_error("boom"); });
+        REQUIRE_THROWS_AS(future.get(), std::runtime_error);
+    }
+
+    SECTION("move-only captures") {
+        auto value = std::make_unique<int>(7);
+        auto future = pool.submit(Priority::Low, [value = std::move(value)]() { return *value; });
+        REQUIRE(future.get() == 7);
+    }
+}
+
+TEST_CASE("ThreadPool runs queued tasks by priority", "[ThreadPool]") {
+    ThreadPool pool(1);
+    Gate gate;
+    std::promise<void> started;
+    auto blocker = pool.submit(Priority::Normal, [&started, opened = gate.opened]() {
+        started.set_value();
+        opened.wait();
+    });
+    started.get_future().wait();
+
+    std::mutex orderMutex;
+    std::vector<int> order;
+    auto record = [&](int id) {
+        return [&, id]() {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(id);
+        };
+    };
+    std::vector<std::future<void>> futures;
+    futures.push_back(pool.submit(Priority::Low, record(3)));
+    futures.push_back(pool.submit(Priority::Normal, record(2)));
+    futures.push_back(pool.submit(Priority::High, record(1)));
+    futures.push_back(pool.submit(Priority::Normal, record(22)));
+
+    auto stats = pool.stats();
+    REQUIRE(stats.queued[0] == 1);
+    REQUIRE(stats.queued[1] == 2);
+    REQUIRE(stats.queued[2] == 1);
+    REQUIRE(stats.peakQueued == 4);
+    REQUIRE(stats.active == 1);
+
+    gate.open.set_value();
+    for (auto& future : futures) future.get();
+    blocker.get();
+    REQUIRE(order == std::vector<int>{ 1, 2, 22, 3 });
+
+    // Futures become ready just before the worker updates its counters
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    do {
+        stats = pool.stats();
+    } while (stats.completed < 5 && std::chrono::steady_clock::now() < deadline);
+    REQUIRE(stats.submitted == 5);
+    REQUIRE(stats.completed == 5);
+    REQUIRE(stats.active == 0);
+}
+
+TEST_CASE("ThreadPool keeps reserved workers free of Low tasks", "[ThreadPool]") {
+    ThreadPool pool(2, 1);
+    Gate gate;
+    std::atomic<int> lowRunning{0};
+    std::atomic<int> lowPeak{0};
+    std::vector<std::future<void>> lows;
+    for (int i = 0; i < 3; ++i) {
+        lows.push_back(pool.submit(Priority::Low, [&, opened = gate.opened]() {
+            int now = ++lowRunning;
+            int peak = lowPeak.load();
+            while (now > peak && !lowPeak.compare_exchange_weak(peak, now)) {}
+            opened.wait();
+            --lowRunning;
+        }));
+    }
+
+    // The reserved worker still serves a High task while Low ones block
+    auto high = pool.submit(Priority::High, []() { return true; });
+    REQUIRE(high.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(high.get());
+
+    gate.open.set_value();
+    for (auto& low : lows) low.get();
+    REQUIRE(lowPeak.load() == 1);
+}
+
+TEST_CASE("ThreadPool wait() helps instead of deadlocking", "[ThreadPool]") {
+    ThreadPool pool(2);
+
+    SECTION("every worker waits on tasks it submitted") {
+        std::vector<std::future<int>> outers;
+        for (int i = 0; i < 4; ++i) {
+            outers.push_back(pool.submit(Priority::Normal, [&pool]() {
+                std::vector<std::future<int>> inner;
+                for (int j = 0; j < 8; ++j) {
+                    inner.push_back(pool.submit(Priority::Normal, [j]() { return j; }));
+                }
+                int sum = 0;
+                for (auto& future : inner) {
+                    pool.wait(future);
+                    sum += future.get();
+                }
+                return sum;
+            }));
+        }
+        for (auto& outer : outers) {
+            REQUIRE(outer.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+            REQUIRE(outer.get() == 28);
+        }
+    }
+
+    SECTION("futures completed outside the pool") {
+        std::promise<int> promise;
+        auto external = promise.get_future().share();
+        auto waiter = pool.submit(Priority::Normal, [&pool, external]() {
+            pool.wait(external);
+            return external.get();
+        });
+        std::thread setter([&promise]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            promise.set_value(5);
+        });
+        REQUIRE(waiter.get() == 5);
+        setter.join();
+    }
+
+    SECTION("off the pool it simply blocks") {
+        auto future = pool.submit(Priority::Normal, []() { return 1; });
+        REQUIRE_FALSE(pool.onWorkerThread());
+        pool.wait(future);
+        REQUIRE(future.get() == 1);
+    }
+}
+
+TEST_CASE("ThreadPool runs queued tasks before it is destroyed", "[ThreadPool]") {
+    std::atomic<int> ran{0};
+    {
+        ThreadPool pool(1);
+        for (int i = 0; i < 16; ++i) {
+            pool.submit(i % 2 ? Priority::Low : Priority::Normal, [&ran]() { ++ran; });
+        }
+    }
+    REQUIRE(ran.load() == 16);
+}
@@ -0,0 +1,88 @@
+/**
+ * ThroughputEstimator Unit Tests
+ *
+ * Tests smoothing of samples, staleness, and that the Sampler leaves out
+ * the time a transfer's receiver spends.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/throughput_estimator.h>
+#include <chrono>
+#include <thread>
+
+using network::ThroughputEstimator;
+using namespace std::chrono_literals;
+
+TEST_CASE("ThroughputEstimator smooths samples", "[ThroughputEstimator]") {
+    ThroughputEstimator estimator;
+    const auto now = ThroughputEstimator::Clock::now();
+
+    SECTION("unknown until the first sample") {
+        REQUIRE(estimator.bytesPerSecond(now) == 0);
+        estimator.addSample(1'000'000, 1s, now);
+        REQUIRE(estimator.bytesPerSecond(now) == 1'000'000);
+    }
+
+    SECTION("later samples are blended in") {
+        estimator.addSample(1'000'000, 1s, now);
+        estimator.addSample(2'000'000, 1s, now);
+        // 0.3 * 2 MB/s + 0.7 * 1 MB/s
+        REQUIRE(estimator.bytesPerSecond(now) == 1'300'000);
+    }
+
+    SECTION("degenerate samples are ignored") {
+        estimator.addSample(0, 1s, now);
+        estimator.addSample(1'000'000, 0s, now);
+        REQUIRE(estimator.bytesPerSecond(now) == 0);
+    }
+
+    SECTION("an old estimate is forgotten") {
+        estimator.addSample(1'000'000, 1s, now);
+        const auto later = now + ThroughputEstimator::STALE_AFTER;
+        REQUIRE(estimator.bytesPerSecond(later) == 0);
+        // And is not blended into the next sample either
+        estimator.addSample(4'000'000, 1s, later);
+        REQUIRE(estimator.bytesPerSecond(later) == 4'000'000);
+    }
+
+    SECTION("reset") {
+        estimator.addSample(1'000'000, 1s, now);
+        estimator.reset();
+        REQUIRE(estimator.bytesPerSecond(now) == 0);
+    }
+}
+
+TEST_CASE("ThroughputEstimator::Sampler leaves receiver time out", "[ThroughputEstimator]") {
+    ThroughputEstimator estimator;
+    constexpr uint64_t CHUNK = 64 * 1024;
+    {
+        ThroughputEstimator::Sampler sampler(estimator);
+        // First chunk: its wait is time to first byte and doesn't count
+        std::this_thread::sleep_for(50ms);
+        sampler.received(CHUNK);
+        sampler.resumed();
+        for (int i = 0; i < 4; ++i) {
+            std::this_thread::sleep_for(5ms);    // Network
+            sampler.received(CHUNK);
+            std::this_thread::sleep_for(50ms);   // A slow consumer
+            sampler.resumed();
+        }
+    }
+    // 256 KiB over ~20 ms of waiting; counting the consumer would give under 1.3 MB/s
+    const uint64_t rate = estimator.bytesPerSecond();
+    REQUIRE(rate > 2'000'000);
+    REQUIRE(rate < 60'000'000);
+}
+
+TEST_CASE("ThroughputEstimator::Sampler skips tiny transfers", "[ThroughputEstimator]") {
+    ThroughputEstimator estimator;
+    {
+        ThroughputEstimator::Sampler sampler(estimator);
+        sampler.received(1024);
+        sampler.resumed();
+        std::this_thread::sleep_for(2ms);
+        sampler.received(1024);
+        sampler.resumed();
+    }
+    REQUIRE(estimator.bytesPerSecond() == 0);
+}
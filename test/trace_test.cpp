@@ -0,0 +1,121 @@
+/**
+ * Tracer Unit Tests
+ *
+ * Tests that nothing is recorded while stopped, and that spans from several
+ * threads (including ones that exited) reach a well-formed Chrome trace file
+ * with their thread names.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/trace.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using util::Tracer;
+
+namespace {
+std::string readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+size_t count(const std::string& text, const std::string& needle)
+{
+    size_t found = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        ++found;
+    }
+    return found;
+}
+}
+
+TEST_CASE("Tracer writes spans from every thread as a Chrome trace", "[Tracer]") {
+    const std::string path = (std::filesystem::temp_directory_path() / "bp_trace_test.json").string();
+    Tracer& tracer = Tracer::instance();
+
+    { TRACE_SCOPE("test", "before start"); }
+    REQUIRE(tracer.start(path));
+    REQUIRE(Tracer::enabled());
+    REQUIRE(tracer.path() == path);
+
+    {
+        TRACE_SCOPE("test", "outer");
+        TRACE_SCOPE("test", "inner");
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([]() {
+            Tracer::setThreadName("worker");
+            for (int n = 0; n < 10; ++n) {
+                TRACE_SCOPE("test", "work \"quoted\"");
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();      // Exited before the writer collected their buffers
+    }
+    tracer.stop();
+    REQUIRE_FALSE(Tracer::enabled());
+    { TRACE_SCOPE("test", "after stop"); }
+
+    const std::string trace = readFile(path);
+    REQUIRE(trace.rfind("[\n", 0) == 0);
+    REQUIRE(trace.size() > 3);
+    REQUIRE(trace.compare(trace.size() - 3, 3, "\n]\n") == 0);
+    REQUIRE(count(trace, "\"name\":\"outer\"") == 1);
+    REQUIRE(count(trace, "\"name\":\"inner\"") == 1);
+    REQUIRE(count(trace, "\"name\":\"work \\\"quoted\\\"\"") == 30);
+    REQUIRE(count(trace, "\"ph\":\"X\"") == 32);
+    REQUIRE(count(trace, "\"name\":\"thread_name\"") == 3);
+    REQUIRE(count(trace, "\"args\":{\"name\":\"worker\"}") == 3);
+    REQUIRE(count(trace, "before start") == 0);
+    REQUIRE(count(trace, "after stop") == 0);
+    REQUIRE(tracer.droppedEvents() == 0);
+
+    // Each object on a line of its own, separated by commas
+    std::istringstream lines(trace);
+    std::string line;
+    std::vector<std::string> objects;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.front() == '{') {
+            objects.push_back(line);
+        }
+    }
+    REQUIRE(objects.size() == 35);
+    for (size_t i = 0; i + 1 < objects.size(); ++i) {
+        REQUIRE(objects[i].back() == ',');
+    }
+    REQUIRE(objects.back().back() == '}');
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Tracer drops spans beyond a full buffer", "[Tracer]") {
+    const std::string path = (std::filesystem::temp_directory_path() / "bp_trace_drop_test.json").string();
+    Tracer& tracer = Tracer::instance();
+    REQUIRE(tracer.start(path));
+    // Far more than fits between two flushes
+    for (size_t n = 0; n < Tracer::BUFFER_EVENTS * 4; ++n) {
+        TRACE_SCOPE("test", "burst");
+    }
+    tracer.stop();
+
+    const std::string trace = readFile(path);
+    const size_t written = count(trace, "\"name\":\"burst\"");
+    REQUIRE(written + tracer.droppedEvents() == Tracer::BUFFER_EVENTS * 4);
+    REQUIRE(written >= Tracer::BUFFER_EVENTS);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Tracer fails to start on an unwritable path", "[Tracer]") {
+    const std::string path = (std::filesystem::temp_directory_path() / "bp_no_such_dir" / "trace.json").string();
+    REQUIRE_FALSE(Tracer::instance().start(path));
+    REQUIRE_FALSE(Tracer::enabled());
+}
@@ -0,0 +1,120 @@
+/**
+ * TransferScheduler Unit Tests
+ *
+ * Tests per-class concurrency limits, slot ownership, which classes are
+ * preempted by which, yield() pausing until the higher class is done, and
+ * cancellation while waiting.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <network/transfer_scheduler.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using network::TransferClass;
+using network::TransferScheduler;
+using namespace std::chrono_literals;
+
+TEST_CASE("TransferScheduler limits each class separately", "[TransferScheduler]") {
+    TransferScheduler scheduler;
+    scheduler.setLimit(TransferClass::Background, 1);
+
+    auto first = scheduler.acquire(TransferClass::Background);
+    REQUIRE(first);
+    REQUIRE(scheduler.activeCount(TransferClass::Background) == 1);
+    REQUIRE_FALSE(scheduler.tryAcquire(TransferClass::Background));
+    // Other classes are unaffected
+    REQUIRE(scheduler.tryAcquire(TransferClass::Cover));
+
+    SECTION("a waiter gets the slot once it is released") {
+        std::atomic<bool> acquired{false};
+        std::thread waiter([&]() {
+            auto slot = scheduler.acquire(TransferClass::Background);
+            acquired = static_cast<bool>(slot);
+        });
+        std::this_thread::sleep_for(50ms);
+        REQUIRE_FALSE(acquired.load());
+        first.release();
+        waiter.join();
+        REQUIRE(acquired.load());
+        REQUIRE(scheduler.activeCount(TransferClass::Background) == 0);
+    }
+
+    SECTION("a cancelled waiter gives up") {
+        std::atomic<bool> cancel{false};
+        std::thread canceller([&]() {
+            std::this_thread::sleep_for(50ms);
+            cancel = true;
+        });
+        auto slot = scheduler.acquire(TransferClass::Background, [&]() { return cancel.load(); });
+        canceller.join();
+        REQUIRE_FALSE(slot);
+        REQUIRE(scheduler.activeCount(TransferClass::Background) == 1);
+    }
+
+    SECTION("moved slots are released once") {
+        TransferScheduler::Slot moved = std::move(first);
+        REQUIRE(moved);
+        REQUIRE_FALSE(first);
+        moved = TransferScheduler::Slot();
+        REQUIRE(scheduler.activeCount(TransferClass::Background) == 0);
+    }
+
+    SECTION("a limit of 0 is unlimited") {
+        scheduler.setLimit(TransferClass::Background, 0);
+        auto second = scheduler.tryAcquire(TransferClass::Background);
+        REQUIRE(second);
+        REQUIRE(scheduler.activeCount(TransferClass::Background) == 2);
+    }
+}
+
+TEST_CASE("TransferScheduler preempts lower classes", "[TransferScheduler]") {
+    TransferScheduler scheduler;
+    REQUIRE_FALSE(scheduler.isPreempted(TransferClass::Background));
+
+    SECTION("playback pauses covers and background work, not searches") {
+        auto playback = scheduler.acquire(TransferClass::Playback);
+        REQUIRE(scheduler.isPreempted(TransferClass::Background));
+        REQUIRE(scheduler.isPreempted(TransferClass::Cover));
+        REQUIRE_FALSE(scheduler.isPreempted(TransferClass::Search));
+        REQUIRE_FALSE(scheduler.isPreempted(TransferClass::Playback));
+    }
+
+    SECTION("covers pause only background work") {
+        auto cover = scheduler.acquire(TransferClass::Cover);
+        REQUIRE(scheduler.isPreempted(TransferClass::Background));
+        REQUIRE_FALSE(scheduler.isPreempted(TransferClass::Cover));
+    }
+
+    SECTION("yield() waits for the higher class to finish") {
+        auto playback = scheduler.acquire(TransferClass::Playback);
+        std::thread finisher([&]() {
+            std::this_thread::sleep_for(100ms);
+            playback.release();
+        });
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(scheduler.yield(TransferClass::Background));
+        REQUIRE(std::chrono::steady_clock::now() - start >= 80ms);
+        finisher.join();
+        REQUIRE_FALSE(scheduler.isPreempted(TransferClass::Background));
+    }
+
+    SECTION("yield() returns false when cancelled while paused") {
+        auto playback = scheduler.acquire(TransferClass::Playback);
+        std::atomic<bool> cancel{false};
+        std::thread canceller([&]() {
+            std::this_thread::sleep_for(50ms);
+            cancel = true;
+        });
+        REQUIRE_FALSE(scheduler.yield(TransferClass::Cover, [&]() { return cancel.load(); }));
+        canceller.join();
+    }
+
+    SECTION("yield() doesn't pause classes that aren't preempted") {
+        auto playback = scheduler.acquire(TransferClass::Playback);
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(scheduler.yield(TransferClass::Search));
+        REQUIRE(std::chrono::steady_clock::now() - start < 50ms);
+    }
+}
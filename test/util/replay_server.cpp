@@ -0,0 +1,274 @@
+#include "replay_server.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+// Added by encWbi() on every signed request, different each time
+bool isSignatureParam(const std::string& name)
+{
+    return name == "wts" || name == "w_rid";
+}
+
+// Request headers that affect what the upstream answers
+const char* const FORWARDED_HEADERS[] = { "User-Agent", "Referer", "Origin", "Cookie", "Accept" };
+
+bool readFile(const std::filesystem::path& path, std::string& out)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    std::stringstream content;
+    content << in.rdbuf();
+    out = content.str();
+    return true;
+}
+}
+
+namespace testutils {
+
+ReplayServer::ReplayServer(std::string upstreamHost)
+    : upstream_(std::move(upstreamHost))
+{
+    server_.set_keep_alive_max_count(1000);
+    server_.Get(".*", [this](const httplib::Request& req, httplib::Response& res) {
+        handle(req, res);
+    });
+}
+
+ReplayServer::~ReplayServer()
+{
+    stop();
+}
+
+bool ReplayServer::start()
+{
+    if (thread_.joinable()) return true;
+    port_ = server_.bind_to_any_port("127.0.0.1");
+    if (port_ < 0) return false;
+    thread_ = std::thread([this]() { server_.listen_after_bind(); });
+    while (!server_.is_running()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void ReplayServer::stop()
+{
+    if (!thread_.joinable()) return;
+    server_.stop();
+    thread_.join();
+}
+
+std::string ReplayServer::origin() const
+{
+    return "http://127.0.0.1:" + std::to_string(port_);
+}
+
+bool ReplayServer::loadFixture(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+    Json::Value root;
+    Json::CharReaderBuilder builder;
+    std::string errors;
+    if (!Json::parseFromStream(builder, in, &root, &errors) || !root["responses"].isArray()) {
+        return false;
+    }
+
+    const std::filesystem::path dir = std::filesystem::path(path).parent_path();
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "";
+    for (const auto& entry : root["responses"]) {
+        if (entry["host"].asString() != upstream_) continue;
+        std::map<std::string, std::string> match;
+        for (const auto& name : entry["match"].getMemberNames()) {
+            match[name] = entry["match"][name].asString();
+        }
+        std::string body;
+        if (entry.isMember("body_file")) {
+            if (!readFile(dir / entry["body_file"].asString(), body)) return false;
+        } else if (entry["body"].isString()) {
+            body = entry["body"].asString();
+        } else if (!entry["body"].isNull()) {
+            body = Json::writeString(writer, entry["body"]);
+        }
+        addResponse(entry["path"].asString(), std::move(match), entry.get("status", 200).asInt(),
+                    entry.get("content_type", "application/json").asString(), std::move(body));
+    }
+    return true;
+}
+
+bool ReplayServer::saveFixture(const std::string& path) const
+{
+    // Keep what the file holds for other hosts, so several servers can record into one
+    Json::Value root;
+    {
+        std::ifstream in(path, std::ios::binary);
+        Json::CharReaderBuilder builder;
+        std::string errors;
+        if (!in.is_open() || !Json::parseFromStream(builder, in, &root, &errors)) {
+            root = Json::Value(Json::objectValue);
+        }
+    }
+    Json::Value responses(Json::arrayValue);
+    for (const auto& entry : root["responses"]) {
+        if (entry["host"].asString() != upstream_) responses.append(entry);
+    }
+
+    const std::filesystem::path fixture(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < responses_.size(); ++i) {
+        const Response& response = *responses_[i];
+        Json::Value entry;
+        entry["host"] = upstream_;
+        entry["path"] = response.path;
+        for (const auto& [name, value] : response.match) {
+            entry["match"][name] = value;
+        }
+        entry["status"] = response.status;
+        entry["content_type"] = response.contentType;
+        Json::Value json;
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        const char* begin = response.body.data();
+        if (response.contentType.find("json") != std::string::npos
+            && reader->parse(begin, begin + response.body.size(), &json, nullptr)) {
+            entry["body"] = json;
+        } else if (response.contentType.rfind("text/", 0) == 0) {
+            entry["body"] = response.body;
+        } else {
+            const std::string file = fixture.stem().string() + "-" + std::to_string(i) + ".bin";
+            std::ofstream out(fixture.parent_path() / file, std::ios::binary);
+            out.write(response.body.data(), static_cast<std::streamsize>(response.body.size()));
+            if (!out) return false;
+            entry["body_file"] = file;
+        }
+        responses.append(entry);
+    }
+    root["responses"] = responses;
+
+    std::ofstream out(path, std::ios::binary);
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "  ";
+    out << Json::writeString(writer, root) << '\n';
+    return static_cast<bool>(out);
+}
+
+void ReplayServer::addResponse(const std::string& path, std::map<std::string, std::string> match,
+                               int status, std::string contentType, std::string body)
+{
+    auto response = std::make_shared<Response>();
+    response->path = path;
+    response->match = std::move(match);
+    response->status = status;
+    response->contentType = std::move(contentType);
+    response->body = std::move(body);
+    std::lock_guard<std::mutex> lock(mutex_);
+    responses_.push_back(std::move(response));
+}
+
+void ReplayServer::setShaping(Shaping shaping)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    shaping_ = shaping;
+}
+
+void ReplayServer::setRecordMode(bool record)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    record_ = record;
+}
+
+/*************** Private Methods ***************/
+void ReplayServer::handle(const httplib::Request& req, httplib::Response& res)
+{
+    ++requests_;
+    std::shared_ptr<const Response> response;
+    Shaping shaping;
+    bool recording = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        response = findResponse_unsafe(req);
+        shaping = shaping_;
+        recording = record_;
+    }
+    if (!response) {
+        ++misses_;
+        if (recording) {
+            response = record(req);
+        }
+        if (!response) {
+            res.status = 404;
+            res.set_content("No recorded response for " + req.path, "text/plain");
+            return;
+        }
+    }
+    serve(response, shaping, res);
+}
+
+std::shared_ptr<const ReplayServer::Response> ReplayServer::findResponse_unsafe(const httplib::Request& req) const
+{
+    std::shared_ptr<const Response> best;
+    for (const auto& response : responses_) {
+        if (response->path != req.path) continue;
+        const bool matches = std::all_of(response->match.begin(), response->match.end(), [&req](const auto& param) {
+            return req.has_param(param.first) && req.get_param_value(param.first) == param.second;
+        });
+        if (matches && (!best || response->match.size() > best->match.size())) {
+            best = response;
+        }
+    }
+    return best;
+}
+
+std::shared_ptr<const ReplayServer::Response> ReplayServer::record(const httplib::Request& req)
+{
+    httplib::Client client(upstream_);
+    client.set_follow_location(true);
+    httplib::Headers headers;
+    for (const char* name : FORWARDED_HEADERS) {
+        if (req.has_header(name)) headers.emplace(name, req.get_header_value(name));
+    }
+    // Always the whole body, uncompressed; ranges are cut from it when replaying
+    headers.emplace("Accept-Encoding", "identity");
+    auto res = client.Get(req.path, req.params, headers);
+    if (!res) return nullptr;
+
+    auto recorded = std::make_shared<Response>();
+    recorded->path = req.path;
+    for (const auto& [name, value] : req.params) {
+        if (!isSignatureParam(name)) recorded->match[name] = value;
+    }
+    recorded->status = res->status;
+    recorded->contentType = res->get_header_value("Content-Type");
+    recorded->body = std::move(res->body);
+    std::lock_guard<std::mutex> lock(mutex_);
+    responses_.push_back(recorded);
+    return recorded;
+}
+
+void ReplayServer::serve(const std::shared_ptr<const Response>& response, const Shaping& shaping,
+                         httplib::Response& res) const
+{
+    if (shaping.latency.count() > 0) {
+        std::this_thread::sleep_for(shaping.latency);
+    }
+    res.status = response->status;
+    if (shaping.bytesPerSecond == 0) {
+        res.set_content(response->body, response->contentType);
+        return;
+    }
+    // Paced in slices of 20 ms worth of bytes
+    const uint64_t rate = shaping.bytesPerSecond;
+    const size_t slice = static_cast<size_t>(std::max<uint64_t>(1024, rate / 50));
+    res.set_content_provider(response->body.size(), response->contentType,
+        [response, rate, slice](size_t offset, size_t length, httplib::DataSink& sink) {
+            const size_t count = std::min(length, slice);
+            if (!sink.write(response->body.data() + offset, count)) return false;
+            std::this_thread::sleep_for(std::chrono::microseconds(count * 1000000 / rate));
+            return true;
+        });
+}
+
+} // namespace testutils
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <httplib.h>
+#include <json/json.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace testutils {
+
+/**
+ * @brief Serve recorded responses of one upstream host (e.g. https://api.bilibili.com)
+ * from 127.0.0.1, for tests and benchmarks that must not depend on the live API.
+ *
+ * Point a BilibiliPlatform at it with test_redirect_hosts({{upstream, origin()}}).
+ * A request is answered by the recorded response for its path whose "match" query
+ * parameters all equal the request's; the one matching the most parameters wins,
+ * other parameters (WBI signatures, timestamps) are ignored. Range and HEAD requests
+ * are handled by httplib.
+ *
+ * Fixture files hold the responses of any number of hosts:
+ *
+ *   {"responses": [
+ *     {"host": "https://api.bilibili.com", "path": "/x/player/pagelist",
+ *      "match": {"bvid": "BV1xx411c7mD"}, "status": 200,
+ *      "content_type": "application/json", "body": {"code": 0, "data": [...]}},
+ *     {"host": "https://upos-sz-mirrorcos.bilivideo.com", "path": "/a.m4s",
+ *      "content_type": "audio/mp4", "body_file": "a.m4s"}
+ *   ]}
+ *
+ * "body" is a JSON value sent as is, or a string; "body_file" is read relative to the
+ * fixture. In record mode requests without a recorded response are forwarded to the
+ * upstream host and what it returns is kept, to be written out with saveFixture().
+ */
+class ReplayServer
+{
+public:
+    // Network conditions applied to every response
+    struct Shaping {
+        std::chrono::milliseconds latency{0};  // Before the response starts
+        uint64_t bytesPerSecond = 0;            // Body pace, 0 for unlimited
+    };
+
+    explicit ReplayServer(std::string upstreamHost);
+    ~ReplayServer();
+
+    ReplayServer(const ReplayServer&) = delete;
+    ReplayServer& operator=(const ReplayServer&) = delete;
+
+    // Start listening on an ephemeral port; false if the server can't bind
+    bool start();
+    void stop();
+    // http://127.0.0.1:<port>, valid after start()
+    std::string origin() const;
+    const std::string& upstreamHost() const { return upstream_; }
+
+    // Add this host's responses from a fixture file; false if it can't be read
+    bool loadFixture(const std::string& path);
+    // Write every response (recorded ones included) to a fixture; binary bodies go to
+    // files next to it
+    bool saveFixture(const std::string& path) const;
+    void addResponse(const std::string& path, std::map<std::string, std::string> match,
+                     int status, std::string contentType, std::string body);
+
+    void setShaping(Shaping shaping);
+    void setRecordMode(bool record);
+
+    // Requests received, and those that had no recorded response
+    size_t requestCount() const { return requests_.load(); }
+    size_t missCount() const { return misses_.load(); }
+
+private:
+    struct Response {
+        std::string path;
+        std::map<std::string, std::string> match;
+        int status = 200;
+        std::string contentType;
+        std::string body;
+    };
+
+    void handle(const httplib::Request& req, httplib::Response& res);
+    std::shared_ptr<const Response> findResponse_unsafe(const httplib::Request& req) const;
+    // Fetch req from the upstream host and keep the response; nullptr if that fails
+    std::shared_ptr<const Response> record(const httplib::Request& req);
+    void serve(const std::shared_ptr<const Response>& response, const Shaping& shaping,
+               httplib::Response& res) const;
+
+    std::string upstream_;
+    httplib::Server server_;
+    std::thread thread_;
+    int port_ = -1;
+
+    mutable std::mutex mutex_;      // Guards responses_, shaping_ and record_
+    std::vector<std::shared_ptr<const Response>> responses_;
+    Shaping shaping_;
+    bool record_ = false;
+    std::atomic<size_t> requests_{0};
+    std::atomic<size_t> misses_{0};
+};
+
+} // namespace testutils
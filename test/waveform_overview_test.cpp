@@ -0,0 +1,135 @@
+/**
+ * WaveformOverview Unit Tests
+ *
+ * Tests building the seek bar outline from PCM of known levels, bounded block counts for
+ * long tracks, and the file format round trip.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <audio/waveform_overview.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using audio::WaveformBuilder;
+using audio::WaveformOverview;
+namespace fs = std::filesystem;
+
+namespace {
+    // Interleaved stereo: `frames` of a square wave at `level`, both channels
+    std::vector<float> square(size_t frames, float level) {
+        std::vector<float> samples(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            const float value = (i / 50) % 2 ? level : -level;
+            samples[2 * i] = value;
+            samples[2 * i + 1] = value;
+        }
+        return samples;
+    }
+}
+
+TEST_CASE("WaveformBuilder outlines the levels it is fed", "[WaveformOverview]") {
+    SECTION("nothing added gives an empty overview") {
+        WaveformBuilder builder(2);
+        REQUIRE(builder.finish().empty());
+    }
+
+    SECTION("loud and silent halves show up in their buckets") {
+        WaveformBuilder builder(2);
+        const size_t half = WaveformOverview::BUCKETS * WaveformBuilder::INITIAL_BLOCK_FRAMES * 2;
+        const auto loud = square(half, 0.5f);
+        const std::vector<float> silence(half * 2, 0.0f);
+        builder.addFloat(loud.data(), half);
+        builder.addFloat(silence.data(), half);
+
+        const WaveformOverview overview = builder.finish();
+        REQUIRE(overview.peaks.size() == WaveformOverview::BUCKETS);
+        REQUIRE(overview.rms.size() == WaveformOverview::BUCKETS);
+        // A square wave's RMS equals its peak
+        REQUIRE(overview.peaks.front() == 128);
+        REQUIRE(overview.rms.front() == 128);
+        REQUIRE(overview.peaks[WaveformOverview::BUCKETS / 2 - 1] == 128);
+        REQUIRE(overview.peaks[WaveformOverview::BUCKETS / 2] == 0);
+        REQUIRE(overview.peaks.back() == 0);
+        REQUIRE(overview.rms.back() == 0);
+    }
+
+    SECTION("16-bit samples are scaled to full scale") {
+        WaveformBuilder builder(1);
+        std::vector<int16_t> samples(WaveformBuilder::INITIAL_BLOCK_FRAMES * 4);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = i % 2 ? 32767 : -32768;
+        }
+        builder.addS16(samples.data(), samples.size());
+        const WaveformOverview overview = builder.finish();
+        REQUIRE(overview.peaks.size() == 4);
+        REQUIRE(overview.peaks.front() == 255);
+        REQUIRE(overview.rms.front() == 255);
+    }
+
+    SECTION("short tracks get one bucket per block, the last one partial") {
+        WaveformBuilder builder(2);
+        const auto samples = square(WaveformBuilder::INITIAL_BLOCK_FRAMES * 10 + 1, 1.0f);
+        builder.addFloat(samples.data(), samples.size() / 2);
+        REQUIRE(builder.finish().peaks.size() == 11);
+    }
+
+    SECTION("long tracks keep a bounded number of blocks") {
+        WaveformBuilder builder(1);
+        const std::vector<float> chunk(48000 * 60, 0.25f);
+        // Three hours at 48 kHz
+        for (int minute = 0; minute < 180; ++minute) {
+            builder.addFloat(chunk.data(), chunk.size());
+        }
+        REQUIRE(builder.frames() == 48000ull * 60 * 180);
+        REQUIRE(builder.frames() / builder.blockFrames() < WaveformBuilder::MAX_BLOCKS);
+
+        const WaveformOverview overview = builder.finish();
+        REQUIRE(overview.peaks.size() == WaveformOverview::BUCKETS);
+        REQUIRE(overview.peaks.front() == 64);
+        REQUIRE(overview.rms.back() == 64);
+    }
+}
+
+TEST_CASE("WaveformOverview round-trips through its file format", "[WaveformOverview]") {
+    WaveformOverview overview;
+    for (size_t i = 0; i < WaveformOverview::BUCKETS; ++i) {
+        overview.peaks.push_back(static_cast<uint8_t>(i));
+        overview.rms.push_back(static_cast<uint8_t>(i / 2));
+    }
+    const std::vector<uint8_t> data = overview.serialize();
+
+    SECTION("parse restores the buckets") {
+        const auto parsed = WaveformOverview::parse(data.data(), data.size());
+        REQUIRE(parsed);
+        REQUIRE(parsed->peaks == overview.peaks);
+        REQUIRE(parsed->rms == overview.rms);
+    }
+
+    SECTION("truncated or foreign data is rejected") {
+        REQUIRE_FALSE(WaveformOverview::parse(data.data(), data.size() - 1));
+        REQUIRE_FALSE(WaveformOverview::parse(data.data(), 3));
+        std::vector<uint8_t> foreign = data;
+        foreign[0] = 'X';
+        REQUIRE_FALSE(WaveformOverview::parse(foreign.data(), foreign.size()));
+        const auto empty = WaveformOverview().serialize();
+        REQUIRE_FALSE(WaveformOverview::parse(empty.data(), empty.size()));
+    }
+
+    SECTION("save and load through a new directory") {
+        std::random_device rd;
+        const fs::path dir = fs::temp_directory_path() / ("waveform_overview_test_" + std::to_string(rd()));
+        const fs::path file = dir / "waveforms" / (std::string("song") + WaveformOverview::FILE_EXTENSION);
+        REQUIRE(overview.save(file.string()));
+        REQUIRE_FALSE(fs::exists(file.string() + ".tmp"));
+
+        const auto loaded = WaveformOverview::load(file.string());
+        REQUIRE(loaded);
+        REQUIRE(loaded->peaks == overview.peaks);
+        REQUIRE_FALSE(WaveformOverview::load((dir / "missing.wave").string()));
+
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * WorkerThreads Unit Tests
+ *
+ * Tests that jobs run concurrently without a queue, that finished threads are
+ * reused instead of started again, waiting on jobs and joining on destruction.
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <util/worker_threads.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <set>
+#include <thread>
+#include <vector>
+
+using util::WorkerThreads;
+
+TEST_CASE("WorkerThreads starts every job right away", "[WorkerThreads]") {
+    WorkerThreads workers;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> running{0};
+
+    // Each job blocks until all of them run, which a queue with fewer threads would never reach
+    std::vector<WorkerThreads::Job> jobs;
+    for (int i = 0; i < 4; ++i) {
+        jobs.push_back(workers.run([&running, released]() {
+            running.fetch_add(1);
+            released.wait();
+        }));
+    }
+    while (running.load() < 4) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(workers.stats().busy == 4);
+    REQUIRE_FALSE(jobs.front().done());
+
+    release.set_value();
+    for (auto& job : jobs) {
+        job.wait();
+        REQUIRE(job.done());
+    }
+    REQUIRE(workers.stats().threads == 4);
+}
+
+TEST_CASE("WorkerThreads reuses idle threads for later jobs", "[WorkerThreads]") {
+    WorkerThreads workers;
+    std::set<std::thread::id> seen;
+
+    // A track change: the previous pair of jobs finishes, then the next pair starts
+    for (int track = 0; track < 20; ++track) {
+        std::thread::id ids[2];
+        WorkerThreads::Job reader = workers.run([&ids]() { ids[0] = std::this_thread::get_id(); });
+        WorkerThreads::Job decoder = workers.run([&ids]() { ids[1] = std::this_thread::get_id(); });
+        reader.wait();
+        decoder.wait();
+        seen.insert(ids[0]);
+        seen.insert(ids[1]);
+    }
+
+    const auto stats = workers.stats();
+    REQUIRE(stats.jobs == 40);
+    REQUIRE(stats.started <= 2);
+    REQUIRE(stats.threads == stats.started);
+    REQUIRE(seen.size() <= 2);
+    REQUIRE(stats.busy == 0);
+}
+
+TEST_CASE("WorkerThreads jobs can be waited on and reset", "[WorkerThreads]") {
+    WorkerThreads workers;
+
+    SECTION("an empty job is done") {
+        WorkerThreads::Job job;
+        REQUIRE_FALSE(job.valid());
+        REQUIRE(job.done());
+        job.wait();
+    }
+
+    SECTION("wait returns after the job and its captures are gone") {
+        auto captured = std::make_shared<int>(1);
+        std::weak_ptr<int> watch = captured;
+        WorkerThreads::Job job = workers.run([captured = std::move(captured)]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+        REQUIRE(job.valid());
+        job.wait();
+        REQUIRE(job.done());
+        REQUIRE(watch.expired());
+        job.reset();
+        REQUIRE_FALSE(job.valid());
+    }
+}
+
+TEST_CASE("WorkerThreads destructor waits for running jobs", "[WorkerThreads]") {
+    std::atomic<bool> finished{false};
+    {
+        WorkerThreads workers;
+        workers.run([&finished]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            finished.store(true);
+        });
+    }
+    REQUIRE(finished.load());
+}
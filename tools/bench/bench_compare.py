@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Compare two BilibiliPlayerBench JSON results (--reporter benchjson::out=FILE).
+
+Usage: bench_compare.py baseline.json candidate.json [--threshold PERCENT]
+
+Prints each benchmark's mean in both runs and the change. A change is flagged
+only when it exceeds the threshold and the mean confidence intervals don't
+overlap. The exit status is 1 if any benchmark got slower that way.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        return {b["name"]: b for b in json.load(f)["benchmarks"]}
+
+
+def fmt_ns(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return f"{ns / scale:.3f} {unit}"
+    return f"{ns:.1f} ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0, help="percent change to flag (default 5)")
+    args = parser.parse_args()
+
+    old, new = load(args.baseline), load(args.candidate)
+    regressed = False
+    width = max([len("benchmark")] + [len(name) for name in old.keys() | new.keys()])
+    print(f"{'benchmark':<{width}}  {'baseline':>12}  {'candidate':>12}  change")
+    for name in sorted(old.keys() | new.keys()):
+        if name not in old or name not in new:
+            where = "candidate" if name in new else "baseline"
+            print(f"{name:<{width}}  only in {where}")
+            continue
+        a, b = old[name], new[name]
+        change = (b["mean_ns"] - a["mean_ns"]) / a["mean_ns"] * 100 if a["mean_ns"] else 0.0
+        separated = b["mean_low_ns"] > a["mean_high_ns"] or b["mean_high_ns"] < a["mean_low_ns"]
+        flag = ""
+        if separated and abs(change) >= args.threshold:
+            flag = "  SLOWER" if change > 0 else "  faster"
+            regressed = regressed or change > 0
+        print(f"{name:<{width}}  {fmt_ns(a['mean_ns']):>12}  {fmt_ns(b['mean_ns']):>12}  {change:+6.1f}%{flag}")
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,9 +4,9 @@ param(
 
     [string] $ExePath = "${PWD}\build\debug\src\BilibiliPlayer.exe",
 
-    [int] $RunSeconds = 3,
+    [int] $Runs = 1,
 
-    [int] $ReadyTimeoutSeconds = 10
+    [int] $ReadyTimeoutSeconds = 30
 )
 
 # Resolve candidate paths if default used
@@ -22,34 +22,38 @@ if (-not (Test-Path $ExePath)) {
     exit 2
 }
 
-Add-Type -AssemblyName System
-
-# Prepare process start info to capture stdout
-# Start the process and measure spawn time (TimeToLaunchMs). This is a
-# lightweight, non-invasive measurement suitable for local bench runs.
-$sw = [System.Diagnostics.Stopwatch]::StartNew()
-$proc = Start-Process -FilePath $ExePath -PassThru
-$sw.Stop()
-Write-Host "TimeToLaunchMs: $($sw.Elapsed.TotalMilliseconds)"
-
-# Allow the app to run for a few seconds so subsystems initialize further
-Write-Host "Allowing app to run for $RunSeconds seconds..."
-Start-Sleep -Seconds $RunSeconds
-
-# Attempt graceful close
-try {
-    if ($proc -and -not $proc.HasExited) {
-        Write-Host "Stopping process (CloseMainWindow)..."
-        $closed = $proc.CloseMainWindow()
-        Start-Sleep -Seconds 1
-        if (-not $proc.HasExited) {
-            Write-Host "Process did not exit; killing..."
-            $proc.Kill()
-        }
+# With --bench the app prints its startup trace, then "BENCH_READY <ms>" once the
+# window is painted and every manager is initialized, and exits by itself.
+$readyTimes = @()
+for ($run = 1; $run -le $Runs; $run++) {
+    $stdout = [System.IO.Path]::GetTempFileName()
+    $sw = [System.Diagnostics.Stopwatch]::StartNew()
+    $proc = Start-Process -FilePath $ExePath -ArgumentList '--bench' -PassThru -RedirectStandardOutput $stdout
+    $exited = $proc.WaitForExit($ReadyTimeoutSeconds * 1000)
+    $sw.Stop()
+
+    if (-not $exited) {
+        Write-Host "Run ${run}: no readiness within $ReadyTimeoutSeconds s; killing"
+        $proc.Kill()
+        Remove-Item $stdout -ErrorAction SilentlyContinue
+        exit 3
     }
-}
-catch {
-    Write-Host "Warning: failed to close process gracefully: $_"
+
+    $output = Get-Content $stdout
+    Remove-Item $stdout -ErrorAction SilentlyContinue
+    $ready = $output | Where-Object { $_ -match '^BENCH_READY\s+([\d.]+)' } | Select-Object -Last 1
+    if (-not $ready) {
+        Write-Host "Run ${run}: exited with code $($proc.ExitCode) before reporting readiness"
+        exit 4
+    }
+    $readyMs = [double]($ready -replace '^BENCH_READY\s+', '')
+    $readyTimes += $readyMs
+
+    Write-Host "Run ${run}: ready in $readyMs ms (process lifetime $($sw.Elapsed.TotalMilliseconds) ms)"
+    $output | Where-Object { $_ -notmatch '^BENCH_READY' } | ForEach-Object { Write-Host "  $_" }
 }
 
-Write-Host "Done. Note: refine this harness to wait for a readiness signal or log message for more accurate measurements."
+if ($Runs -gt 1) {
+    $sorted = $readyTimes | Sort-Object
+    Write-Host "ReadyMs min: $($sorted[0])  median: $($sorted[[int][math]::Floor($Runs / 2)])  max: $($sorted[-1])"
+}